@@ -42,12 +42,18 @@ typedef struct ConcurrentList {
 	extern boost::thread*            ConnManagerThr;
 	extern boost::mutex*             ConnManagerLock;
 	extern boost::condition_variable ConnManagerCond;
+	extern boost::mutex*             StreamJobLock;
+	extern boost::condition_variable StreamJobCond;
+	extern boost::mutex*             DirCacheLock;
 #else
 	#include <pthread.h>
 	extern pthread_mutex_t PathCacheLock;
 	extern pthread_t ConnManagerThr;
 	extern pthread_mutex_t ConnManagerLock;
 	extern pthread_cond_t ConnManagerCond;
+	extern pthread_mutex_t StreamJobLock;
+	extern pthread_cond_t StreamJobCond;
+	extern pthread_mutex_t DirCacheLock;
 #endif
 
 #ifdef USE_BOOST
@@ -195,6 +201,29 @@ int setAndMkFileCacheDir ();
 int ifuseFileCacheWrite (fileCache_t *fileCache, char *buf, size_t size, off_t offset);
 int ifuseFileCacheRead (fileCache_t *fileCache, char *buf, size_t size, off_t offset);
 
+int initFileStream ();
+int ifuseStreamEnabled (fileCache_t *fileCache, int forWrite);
+/* precond: lock fileCache */
+int _ifuseStreamRead (fileCache_t *fileCache, char *buf, size_t size, off_t offset);
+int _ifuseStreamWrite (fileCache_t *fileCache, char *buf, size_t size, off_t offset);
+int _ifuseStreamFlush (fileCache_t *fileCache);
+void _ifuseStreamDrop (fileCache_t *fileCache);
+void _ifuseStreamWait (fileCache_t *fileCache);
+void freeFileStream (fileCache_t *fileCache);
+int ifuseStreamFlush (fileCache_t *fileCache);
+void streamWorker ();
+
+int initDirCache ();
+dirCache_t *newDirCache (char *localPath);
+int addDirCacheEnt (dirCache_t *dirCache, char *name, struct stat *stbuf);
+int putDirCache (dirCache_t *dirCache);
+void freeDirCache (dirCache_t *dirCache);
+int fillDirFromCache (char *localPath, void *buf, fuse_fill_dir_t filler);
+int lookupDirCacheStat (char *localPath, struct stat *stbuf);
+int invalidateDirCache (char *localPath);
+int isDirCacheStatPath (const char *localPath);
+int getDirCacheStatStr (char *outStr, int maxLen);
+
 void _ifuseDisconnect(iFuseConn_t *tmpIFuseConn);
 
 int _ifuseRead(iFuseDesc_t *desc, char *buf, size_t size, off_t offset);
@@ -26,6 +26,36 @@
 
 #define FUSE_CACHE_DIR	"/tmp/fuseCache"
 
+/* read-ahead and write-behind of files read and written on the server.
+ * The sizes can be set with the env variables FuseReadAheadSize and
+ * FuseWriteBehindSize (0 turns it off), the number of background threads
+ * with FuseStreamThreads */
+#define DEF_READ_AHEAD_SIZE	(4*1024*1024)	/* 4 mb */
+#define DEF_WRITE_BEHIND_SIZE	(4*1024*1024)	/* 4 mb */
+#define DEF_NUM_STREAM_THR	2
+#define MAX_NUM_STREAM_THR	16
+#define MAX_WRITE_BEHIND_BUF	2	/* queued buffers before writes block */
+#define STREAM_WORKER_SLEEP_TIME 1
+
+/* the directory listing cache. The listing of a collection and the stat
+ * of its children are kept for FuseDirCacheTime secs (0 turns it off).
+ * At most FuseDirCacheSize listings are kept and a collection with more
+ * than FuseDirCacheMaxEntries children is not cached */
+#define DEF_DIR_CACHE_TIME	30	/* in sec */
+#define DEF_DIR_CACHE_SIZE	1024
+#define DEF_DIR_CACHE_MAX_ENTRIES	10000
+#define NUM_DIR_HASH_SLOT	1031
+#define DIR_CACHE_STAT_PATH	"/.irodsFsStat"	/* read for the hit rates */
+
+#define PREFETCH_NONE		0
+#define PREFETCH_PENDING	1	/* a worker will fill fileCache->prefetch */
+#define PREFETCH_DONE		2
+
+/* what a stream worker is doing on the server fd of a fileCache */
+#define STREAM_IO_NONE		0
+#define STREAM_IO_READ		1	/* filling fileCache->prefetch */
+#define STREAM_IO_WRITE		2	/* writing the write-behind queue */
+
 #define IRODS_FREE		0
 #define IRODS_INUSE	1 
 
@@ -43,6 +73,15 @@ typedef struct BufCache {
     void *buf;
 } bufCache_t;
 
+/* a window of file data held by the read-ahead or write-behind */
+typedef struct StreamBuf {
+    rodsLong_t offset;	/* file offset of buf[0] */
+    int len;		/* bytes of data in buf */
+    int size;		/* bytes allocated */
+    char *buf;
+    struct StreamBuf *next;
+} streamBuf_t;
+
 typedef enum { 
     NO_FILE_CACHE, /* no cache, file has already been deleted */
     HAVE_READ_CACHE, /* has cache, same as server copy */
@@ -96,6 +135,24 @@ typedef struct PathCache {
 #endif
 } pathCache_t;
 
+typedef struct DirCacheEnt {
+    char *name;
+    struct stat stbuf;
+} dirCacheEnt_t;
+
+typedef struct DirCache {
+    char *localPath;
+    dirCacheEnt_t *entries;	/* sorted by name */
+    int numEntries;
+    int maxEntries;
+    int notExist;		/* the collection does not exist */
+    int overflow;		/* too many entries to be cached */
+    int gen;			/* DirCacheGen when the listing started */
+    uint cachedTime;
+    struct DirCache *prev;	/* the LRU list, most recent first */
+    struct DirCache *next;
+} dirCache_t;
+
 typedef struct PathCacheQue {
     pathCache_t *top;
     pathCache_t *bottom;
@@ -118,6 +175,20 @@ typedef struct newlyCreatedFile {
     char *localPath;
     char *objPath;
     int mode;
+    /* read-ahead and write-behind when state is NO_FILE_CACHE. see
+     * iFuseLib.Stream.c */
+    streamBuf_t *readAhead;	/* the window reads are served from */
+    streamBuf_t *prefetch;	/* the next window */
+    int prefetchState;
+    int readAheadGen;		/* bumped to drop a pending prefetch */
+    rodsLong_t lastReadEnd;	/* to tell sequential reads */
+    streamBuf_t *writeBehind;	/* full buffers to be written, oldest first */
+    streamBuf_t *writeFill;	/* the buffer being filled */
+    int numWriteBehind;
+    int streamStatus;		/* error of a background write, not yet
+				 * returned to the user */
+    int streamIo;		/* a worker does i/o on iFd without the lock.
+				 * iFd and offset are its until STREAM_IO_NONE */
 #ifdef USE_BOOST
     boost::mutex* mutex;
 #else
@@ -163,7 +163,7 @@ _ifuseFlush (iFuseDesc_t *desc)
 
 	}
 
-	return 0;
+	return status;
 
 }
 
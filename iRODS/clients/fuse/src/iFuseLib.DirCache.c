@@ -0,0 +1,385 @@
+/*** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* iFuseLib.DirCache.c - the directory listing cache.
+ *
+ * The listing read by irodsReaddir is kept, with the stat of each child,
+ * keyed by the local path of the collection. A readdir of the same path
+ * within DirCacheTime secs is served from the cache and so is the getattr
+ * of a child, which is how "ls -l" and build tools stat a directory. A
+ * name that is not in a cached listing does not exist (a negative entry)
+ * and neither does anything under a collection whose listing failed.
+ *
+ * At most DirCacheSize listings are kept, the least recently used one is
+ * dropped first. mkdir, rmdir, create, unlink, rename and the writes done
+ * through this mount invalidate the listings they change. DirCacheGen is
+ * bumped on every invalidation so that a listing read while a change was
+ * made is not cached.
+ *
+ * The hit and miss counts can be read from DIR_CACHE_STAT_PATH under the
+ * mount.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <assert.h>
+#include "irodsFs.h"
+#include "iFuseLib.h"
+#include "iFuseOper.h"
+#include "hashtable.h"
+#include "list.h"
+#include "iFuseLib.Lock.h"
+
+typedef struct DirCacheStat {
+    rodsLong_t readdirHit;
+    rodsLong_t readdirMiss;
+    rodsLong_t statHit;
+    rodsLong_t statNegHit;
+    rodsLong_t statMiss;
+    rodsLong_t expired;
+    rodsLong_t evicted;
+    rodsLong_t invalidated;
+    rodsLong_t overflow;
+} dirCacheStat_t;
+
+static int DirCacheTime = DEF_DIR_CACHE_TIME;
+static int DirCacheSize = DEF_DIR_CACHE_SIZE;
+static int DirCacheMaxEntries = DEF_DIR_CACHE_MAX_ENTRIES;
+static int DirCacheGen = 0;
+static int NumDirCache = 0;
+static Hashtable *DirCacheTable;
+static dirCache_t *DirCacheHead = NULL;		/* most recently used */
+static dirCache_t *DirCacheTail = NULL;
+static dirCacheStat_t DirCacheStat;
+
+static int
+getDirCacheEnv (char *envName, int defValue)
+{
+    char *tmpStr;
+    int value;
+
+    if ((tmpStr = getenv (envName)) == NULL || strlen (tmpStr) == 0)
+        return defValue;
+    value = atoi (tmpStr);
+    if (value <= 0) return 0;
+    return value;
+}
+
+int
+initDirCache ()
+{
+    DirCacheTime = getDirCacheEnv ("FuseDirCacheTime", DEF_DIR_CACHE_TIME);
+    DirCacheSize = getDirCacheEnv ("FuseDirCacheSize", DEF_DIR_CACHE_SIZE);
+    DirCacheMaxEntries = getDirCacheEnv ("FuseDirCacheMaxEntries",
+      DEF_DIR_CACHE_MAX_ENTRIES);
+#ifndef USE_BOOST
+    pthread_mutex_init (&DirCacheLock, NULL);
+#endif
+    DirCacheTable = newHashTable (NUM_DIR_HASH_SLOT);
+    bzero (&DirCacheStat, sizeof (DirCacheStat));
+    return 0;
+}
+
+static int
+cmpDirCacheEnt (const void *ptr1, const void *ptr2)
+{
+    return strcmp (((dirCacheEnt_t *) ptr1)->name,
+      ((dirCacheEnt_t *) ptr2)->name);
+}
+
+/* newDirCache - start a listing of localPath. The entries are added with
+ * addDirCacheEnt and the listing is cached with putDirCache */
+dirCache_t *
+newDirCache (char *localPath)
+{
+    dirCache_t *dirCache;
+
+    if (DirCacheTime <= 0 || DirCacheSize <= 0) return NULL;
+    dirCache = (dirCache_t *) malloc (sizeof (dirCache_t));
+    if (dirCache == NULL) return NULL;
+    bzero (dirCache, sizeof (dirCache_t));
+    dirCache->localPath = strdup (localPath);
+    LOCK (DirCacheLock);
+    dirCache->gen = DirCacheGen;
+    UNLOCK (DirCacheLock);
+    return dirCache;
+}
+
+int
+addDirCacheEnt (dirCache_t *dirCache, char *name, struct stat *stbuf)
+{
+    dirCacheEnt_t *newEntries;
+    int newMax;
+
+    if (dirCache == NULL || dirCache->overflow) return 0;
+    if (dirCache->numEntries >= DirCacheMaxEntries) {
+        dirCache->overflow = 1;
+        return 0;
+    }
+    if (dirCache->numEntries >= dirCache->maxEntries) {
+        newMax = dirCache->maxEntries > 0 ? dirCache->maxEntries * 2 : 64;
+        newEntries = (dirCacheEnt_t *) realloc (dirCache->entries,
+          newMax * sizeof (dirCacheEnt_t));
+        if (newEntries == NULL) {
+            dirCache->overflow = 1;
+            return SYS_MALLOC_ERR;
+        }
+        dirCache->entries = newEntries;
+        dirCache->maxEntries = newMax;
+    }
+    dirCache->entries[dirCache->numEntries].name = strdup (name);
+    dirCache->entries[dirCache->numEntries].stbuf = *stbuf;
+    dirCache->numEntries++;
+    return 0;
+}
+
+void
+freeDirCache (dirCache_t *dirCache)
+{
+    int i;
+
+    if (dirCache == NULL) return;
+    for (i = 0; i < dirCache->numEntries; i++) {
+        free (dirCache->entries[i].name);
+    }
+    if (dirCache->entries != NULL) free (dirCache->entries);
+    free (dirCache->localPath);
+    free (dirCache);
+}
+
+static void
+_unlinkDirCache (dirCache_t *dirCache)
+{
+    if (dirCache->prev != NULL) {
+        dirCache->prev->next = dirCache->next;
+    } else {
+        DirCacheHead = dirCache->next;
+    }
+    if (dirCache->next != NULL) {
+        dirCache->next->prev = dirCache->prev;
+    } else {
+        DirCacheTail = dirCache->prev;
+    }
+    dirCache->prev = dirCache->next = NULL;
+}
+
+static void
+_linkDirCacheHead (dirCache_t *dirCache)
+{
+    dirCache->prev = NULL;
+    dirCache->next = DirCacheHead;
+    if (DirCacheHead != NULL) {
+        DirCacheHead->prev = dirCache;
+    } else {
+        DirCacheTail = dirCache;
+    }
+    DirCacheHead = dirCache;
+}
+
+/* precond: lock DirCacheLock */
+static void
+_rmDirCache (dirCache_t *dirCache)
+{
+    deleteFromHashTable (DirCacheTable, dirCache->localPath);
+    _unlinkDirCache (dirCache);
+    NumDirCache--;
+    freeDirCache (dirCache);
+}
+
+/* _lookupDirCache - the cached listing of localPath if it has not
+ * expired. precond: lock DirCacheLock */
+static dirCache_t *
+_lookupDirCache (char *localPath)
+{
+    dirCache_t *dirCache;
+
+    dirCache = (dirCache_t *) lookupFromHashTable (DirCacheTable, localPath);
+    if (dirCache == NULL) return NULL;
+    if (time (0) - dirCache->cachedTime >= (uint) DirCacheTime) {
+        DirCacheStat.expired++;
+        _rmDirCache (dirCache);
+        return NULL;
+    }
+    _unlinkDirCache (dirCache);
+    _linkDirCacheHead (dirCache);
+    return dirCache;
+}
+
+/* putDirCache - cache a listing made with newDirCache. dirCache is
+ * owned by the cache afterward */
+int
+putDirCache (dirCache_t *dirCache)
+{
+    dirCache_t *oldDirCache;
+
+    if (dirCache == NULL) return 0;
+    if (dirCache->overflow) {
+        LOCK (DirCacheLock);
+        DirCacheStat.overflow++;
+        UNLOCK (DirCacheLock);
+        freeDirCache (dirCache);
+        return 0;
+    }
+    if (dirCache->numEntries > 1) {
+        qsort (dirCache->entries, dirCache->numEntries,
+          sizeof (dirCacheEnt_t), cmpDirCacheEnt);
+    }
+    dirCache->cachedTime = time (0);
+
+    LOCK (DirCacheLock);
+    if (dirCache->gen != DirCacheGen) {
+        /* something changed while the listing was read */
+        UNLOCK (DirCacheLock);
+        freeDirCache (dirCache);
+        return 0;
+    }
+    oldDirCache = (dirCache_t *) lookupFromHashTable (DirCacheTable,
+      dirCache->localPath);
+    if (oldDirCache != NULL) _rmDirCache (oldDirCache);
+    while (NumDirCache >= DirCacheSize && DirCacheTail != NULL) {
+        DirCacheStat.evicted++;
+        _rmDirCache (DirCacheTail);
+    }
+    insertIntoHashTable (DirCacheTable, dirCache->localPath, dirCache);
+    _linkDirCacheHead (dirCache);
+    NumDirCache++;
+    UNLOCK (DirCacheLock);
+    return 0;
+}
+
+/* fillDirFromCache - fill a readdir from the cache. Returns 1 if filled,
+ * 0 if not cached and -ENOENT if the collection is known not to exist */
+int
+fillDirFromCache (char *localPath, void *buf, fuse_fill_dir_t filler)
+{
+    dirCache_t *dirCache;
+    int i;
+
+    if (DirCacheTime <= 0) return 0;
+    LOCK (DirCacheLock);
+    if ((dirCache = _lookupDirCache (localPath)) == NULL) {
+        DirCacheStat.readdirMiss++;
+        UNLOCK (DirCacheLock);
+        return 0;
+    }
+    DirCacheStat.readdirHit++;
+    if (dirCache->notExist) {
+        UNLOCK (DirCacheLock);
+        return -ENOENT;
+    }
+    for (i = 0; i < dirCache->numEntries; i++) {
+        filler (buf, dirCache->entries[i].name, NULL, 0);
+    }
+    UNLOCK (DirCacheLock);
+    return 1;
+}
+
+/* lookupDirCacheStat - the stat of localPath from the cached listing of
+ * its parent. Returns 1 if found, 0 if not cached and -ENOENT if it is
+ * known not to exist */
+int
+lookupDirCacheStat (char *localPath, struct stat *stbuf)
+{
+    char parentPath[MAX_NAME_LEN], childName[MAX_NAME_LEN];
+    dirCache_t *dirCache;
+    dirCacheEnt_t myEnt, *dirCacheEnt;
+
+    if (DirCacheTime <= 0 || strcmp (localPath, "/") == 0) return 0;
+    if (splitPathByKey (localPath, parentPath, childName, '/') < 0)
+        return 0;
+    if (*parentPath == '\0') rstrcpy (parentPath, "/", MAX_NAME_LEN);
+
+    LOCK (DirCacheLock);
+    if ((dirCache = _lookupDirCache (parentPath)) == NULL) {
+        DirCacheStat.statMiss++;
+        UNLOCK (DirCacheLock);
+        return 0;
+    }
+    if (dirCache->notExist) {
+        DirCacheStat.statNegHit++;
+        UNLOCK (DirCacheLock);
+        return -ENOENT;
+    }
+    myEnt.name = childName;
+    dirCacheEnt = (dirCacheEnt_t *) bsearch (&myEnt, dirCache->entries,
+      dirCache->numEntries, sizeof (dirCacheEnt_t), cmpDirCacheEnt);
+    if (dirCacheEnt == NULL) {
+        DirCacheStat.statNegHit++;
+        UNLOCK (DirCacheLock);
+        return -ENOENT;
+    }
+    *stbuf = dirCacheEnt->stbuf;
+    DirCacheStat.statHit++;
+    UNLOCK (DirCacheLock);
+    return 1;
+}
+
+/* invalidateDirCache - drop the listings changed by a change of
+ * localPath: the listing of its parent and, in case it is a collection,
+ * its own listing and those under it */
+int
+invalidateDirCache (char *localPath)
+{
+    char parentPath[MAX_NAME_LEN], childName[MAX_NAME_LEN];
+    dirCache_t *dirCache, *nextDirCache;
+    int len = strlen (localPath);
+
+    if (splitPathByKey (localPath, parentPath, childName, '/') < 0)
+        *parentPath = '\0';
+    if (*parentPath == '\0') rstrcpy (parentPath, "/", MAX_NAME_LEN);
+
+    LOCK (DirCacheLock);
+    DirCacheGen++;
+    for (dirCache = DirCacheHead; dirCache != NULL;
+      dirCache = nextDirCache) {
+        char *cachedPath = dirCache->localPath;
+
+        nextDirCache = dirCache->next;
+        if (strcmp (cachedPath, parentPath) == 0 ||
+          (strncmp (cachedPath, localPath, len) == 0 &&
+          (cachedPath[len] == '\0' || cachedPath[len] == '/'))) {
+            DirCacheStat.invalidated++;
+            _rmDirCache (dirCache);
+        }
+    }
+    UNLOCK (DirCacheLock);
+    return 0;
+}
+
+int
+isDirCacheStatPath (const char *localPath)
+{
+    return (localPath != NULL && strcmp (localPath, DIR_CACHE_STAT_PATH) == 0);
+}
+
+/* getDirCacheStatStr - the content of DIR_CACHE_STAT_PATH */
+int
+getDirCacheStatStr (char *outStr, int maxLen)
+{
+    int len;
+
+    LOCK (DirCacheLock);
+    len = snprintf (outStr, maxLen,
+      "dirCacheTime %d\n"
+      "dirCacheSize %d\n"
+      "dirCacheMaxEntries %d\n"
+      "cachedDirs %d\n"
+      "readdirHit %lld\n"
+      "readdirMiss %lld\n"
+      "statHit %lld\n"
+      "statNegHit %lld\n"
+      "statMiss %lld\n"
+      "expired %lld\n"
+      "evicted %lld\n"
+      "invalidated %lld\n"
+      "overflow %lld\n",
+      DirCacheTime, DirCacheSize, DirCacheMaxEntries, NumDirCache,
+      DirCacheStat.readdirHit, DirCacheStat.readdirMiss,
+      DirCacheStat.statHit, DirCacheStat.statNegHit, DirCacheStat.statMiss,
+      DirCacheStat.expired, DirCacheStat.evicted, DirCacheStat.invalidated,
+      DirCacheStat.overflow);
+    UNLOCK (DirCacheLock);
+    if (len >= maxLen) len = maxLen - 1;
+    return len;
+}
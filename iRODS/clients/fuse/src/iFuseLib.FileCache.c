@@ -23,6 +23,7 @@ int initFileCache() {
 }
 int iFuseFileCacheLseek(fileCache_t *fileCache, off_t offset) {
 	LOCK_STRUCT(*fileCache);
+	_ifuseStreamWait (fileCache);
 	int status = _iFuseFileCacheLseek(fileCache, offset);
 	UNLOCK_STRUCT(*fileCache);
 	return status;
@@ -75,9 +76,12 @@ int iFuseFileCacheFlush(fileCache_t *fileCache) {
 int _iFuseFileCacheFlush(fileCache_t *fileCache) {
     int status = 0;
     int objFd;
+    if (fileCache->state == NO_FILE_CACHE) {
+        /* send what the write-behind still holds */
+        return _ifuseStreamFlush (fileCache);
+    }
 	/* simply return if no file cache or the file cache hasn't been updated */
     if (fileCache->state != HAVE_NEWLY_CREATED_CACHE) {
-    	UNLOCK_STRUCT(*fileCache);
     	return 0;
     }
 
@@ -223,6 +227,16 @@ int ifuseFileCacheClose(fileCache_t *fileCache) {
 	int status;
 	LOCK_STRUCT(*fileCache);
 	if(fileCache->state == NO_FILE_CACHE) {
+		/* nothing may be left behind once the fd is closed */
+		status = _ifuseStreamFlush (fileCache);
+		if (status < 0) {
+			rodsLog (LOG_ERROR,
+			  "ifuseFileCacheClose: write-behind of %s error, status = %d",
+			  fileCache->localPath, status);
+		}
+		_ifuseStreamDrop (fileCache);
+		_ifuseStreamWait (fileCache);
+		fileCache->lastReadEnd = 0;
     		/* close remote file */
     		iFuseConn_t *conn = getAndUseConnByPath(fileCache->localPath, &MyRodsEnv, &status);
 		status = closeIrodsFd (conn->conn, fileCache->iFd);
@@ -324,7 +338,13 @@ int _ifuseFileCacheWrite (fileCache_t *fileCache, char *buf, size_t size, off_t
     bytesBuf_t dataObjWriteInpBBuf;
     iFuseConn_t *conn;
 
+    if (ifuseStreamEnabled (fileCache, 1)) {
+        return _ifuseStreamWrite (fileCache, buf, size, offset);
+    }
+
     bzero (&dataObjWriteInp, sizeof (dataObjWriteInp));
+    /* a stream worker may still be prefetching on the fd */
+    _ifuseStreamWait (fileCache);
     /* lseek to the right offset in case this cache is share by multiple descs */
     status = _iFuseFileCacheLseek(fileCache, offset);
     if (status < 0) {
@@ -387,6 +407,16 @@ int _ifuseFileCacheRead (fileCache_t *fileCache, char *buf, size_t size, off_t o
 {
     int status, myError;
 
+    if (ifuseStreamEnabled (fileCache, 0)) {
+        return _ifuseStreamRead (fileCache, buf, size, offset);
+    }
+    /* writes may have been held back before read-ahead was turned off */
+    if (fileCache->state == NO_FILE_CACHE &&
+      (status = _ifuseStreamFlush (fileCache)) < 0) {
+        return status;
+    }
+    _ifuseStreamWait (fileCache);
+
     status = _iFuseFileCacheLseek(fileCache, offset);
     if (status < 0) {
         if ((myError = getErrno (status)) > 0) {
@@ -20,6 +20,9 @@
 	boost::thread*            ConnManagerThr;
 	boost::mutex*             ConnManagerLock = new boost::mutex();
 	boost::condition_variable ConnManagerCond;
+	boost::mutex*             StreamJobLock = new boost::mutex();
+	boost::condition_variable StreamJobCond;
+	boost::mutex*             DirCacheLock = new boost::mutex();
 #else
 	/*pthread_mutex_t DescLock;*/
 	/*pthread_mutex_t ConnLock;*/
@@ -28,6 +31,9 @@
 	pthread_t ConnManagerThr;
 	pthread_mutex_t ConnManagerLock;
 	pthread_cond_t ConnManagerCond;
+	pthread_mutex_t StreamJobLock;
+	pthread_cond_t StreamJobCond;
+	pthread_mutex_t DirCacheLock;
 #endif
 
 #ifdef USE_BOOST
@@ -0,0 +1,673 @@
+/*** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* iFuseLib.Stream.c - read-ahead and write-behind for the files that are
+ * read and written directly on the server (state NO_FILE_CACHE).
+ *
+ * Sequential reads are served from a window of ReadAheadSize bytes that
+ * is fetched with a single rcDataObjRead. Once half of the window has
+ * been read, a stream worker fetches the next window in the background.
+ * Contiguous writes are collected into buffers of WriteBehindSize bytes
+ * and the full buffers are written by the stream workers in order. Up to
+ * MAX_WRITE_BEHIND_BUF buffers may be queued before a write has to wait.
+ *
+ * Reads, flush, fsync and release send the queued writes first. An error
+ * of a background write is returned by the next write, flush or fsync of
+ * the file.
+ *
+ * The workers do their i/o without the fileCache lock, into buffers that
+ * are taken off the fileCache first and put back when done, so that a
+ * read served from the read-ahead window does not wait for the network.
+ * While a worker does i/o, fileCache->streamIo is set and the worker
+ * owns the server fd and fileCache->offset. The fuse threads call
+ * _ifuseStreamWait before any i/o on the fd.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <assert.h>
+#include "irodsFs.h"
+#include "iFuseLib.h"
+#include "iFuseOper.h"
+#include "hashtable.h"
+#include "list.h"
+#include "iFuseLib.Lock.h"
+
+#define STREAM_READ_JOB		0
+#define STREAM_WRITE_JOB	1
+
+typedef struct StreamJob {
+    int type;
+    int gen;		/* readAheadGen when a prefetch was asked for */
+    rodsLong_t offset;
+    fileCache_t *fileCache;
+} streamJob_t;
+
+static int ReadAheadSize = DEF_READ_AHEAD_SIZE;
+static int WriteBehindSize = DEF_WRITE_BEHIND_SIZE;
+static int NumStreamThr = DEF_NUM_STREAM_THR;
+static int StreamThrStarted = 0;
+concurrentList_t *StreamJobQue;
+/* signalled when a worker is done with the fd of a fileCache */
+#ifdef USE_BOOST
+static boost::mutex StreamIdleLock;
+static boost::condition_variable StreamIdleCond;
+#else
+static pthread_mutex_t StreamIdleLock;
+static pthread_cond_t StreamIdleCond;
+#endif
+
+static int
+getStreamSizeEnv (char *envName, int defSize)
+{
+    char *tmpStr;
+    int size;
+
+    if ((tmpStr = getenv (envName)) == NULL || strlen (tmpStr) == 0)
+        return defSize;
+    size = atoi (tmpStr);
+    if (size <= 0) return 0;
+    if (size > MAX_SZ_FOR_SINGLE_BUF) size = MAX_SZ_FOR_SINGLE_BUF;
+    return size;
+}
+
+int
+initFileStream ()
+{
+    ReadAheadSize = getStreamSizeEnv ("FuseReadAheadSize",
+      DEF_READ_AHEAD_SIZE);
+    WriteBehindSize = getStreamSizeEnv ("FuseWriteBehindSize",
+      DEF_WRITE_BEHIND_SIZE);
+    NumStreamThr = getStreamSizeEnv ("FuseStreamThreads", DEF_NUM_STREAM_THR);
+    if (NumStreamThr > MAX_NUM_STREAM_THR) NumStreamThr = MAX_NUM_STREAM_THR;
+#ifndef USE_BOOST
+    pthread_mutex_init (&StreamJobLock, NULL);
+    pthread_cond_init (&StreamJobCond, NULL);
+    pthread_mutex_init (&StreamIdleLock, NULL);
+    pthread_cond_init (&StreamIdleCond, NULL);
+#endif
+    StreamJobQue = newConcurrentList();
+    return 0;
+}
+
+/* ifuseStreamEnabled - whether reads (forWrite == 0) or writes of
+ * fileCache go through the read-ahead or write-behind */
+int
+ifuseStreamEnabled (fileCache_t *fileCache, int forWrite)
+{
+    if (fileCache->state != NO_FILE_CACHE) return 0;
+    if (forWrite) {
+        return WriteBehindSize > 0;
+    } else {
+        return ReadAheadSize > 0;
+    }
+}
+
+static int
+streamErrno (int status)
+{
+    int myError;
+
+    if ((myError = getErrno (status)) > 0) {
+        return (-myError);
+    } else {
+        return -ENOENT;
+    }
+}
+
+static streamBuf_t *
+newStreamBuf (int size)
+{
+    streamBuf_t *streamBuf;
+
+    streamBuf = (streamBuf_t *) malloc (sizeof (streamBuf_t));
+    if (streamBuf == NULL) return NULL;
+    bzero (streamBuf, sizeof (streamBuf_t));
+    if ((streamBuf->buf = (char *) malloc (size)) == NULL) {
+        free (streamBuf);
+        return NULL;
+    }
+    streamBuf->size = size;
+    return streamBuf;
+}
+
+static void
+freeStreamBuf (streamBuf_t *streamBuf)
+{
+    if (streamBuf == NULL) return;
+    free (streamBuf->buf);
+    free (streamBuf);
+}
+
+static void
+startStreamWorkers ()
+{
+    int i, status = 0;
+
+    LOCK_STRUCT (*StreamJobQue);
+    if (StreamThrStarted) {
+        UNLOCK_STRUCT (*StreamJobQue);
+        return;
+    }
+    /* started on first use since fuse_main forks to go to background */
+    StreamThrStarted = 1;
+    UNLOCK_STRUCT (*StreamJobQue);
+
+    for (i = 0; i < NumStreamThr; i++) {
+#ifdef USE_BOOST
+        new boost::thread (streamWorker);
+#else
+        pthread_t streamThr;
+        status = pthread_create (&streamThr, pthread_attr_default,
+          (void *(*)(void *)) streamWorker, (void *) NULL);
+        if (status == 0) pthread_detach (streamThr);
+#endif
+        if (status != 0) {
+            rodsLog (LOG_ERROR,
+              "startStreamWorkers: pthread_create failure, status = %d",
+              status);
+            break;
+        }
+    }
+}
+
+/* precond: lock fileCache */
+static int
+_postStreamJob (fileCache_t *fileCache, int type, rodsLong_t offset)
+{
+    streamJob_t *job;
+
+    if (NumStreamThr <= 0) return 0;	/* all done in the foreground */
+    job = (streamJob_t *) malloc (sizeof (streamJob_t));
+    if (job == NULL) return SYS_MALLOC_ERR;
+    job->type = type;
+    job->gen = fileCache->readAheadGen;
+    job->offset = offset;
+    /* keep fileCache around until the job is done */
+    REF_NO_LOCK(job->fileCache, fileCache);
+
+    startStreamWorkers ();
+    addToConcurrentList (StreamJobQue, job);
+    notifyTimeoutWait (&StreamJobLock, &StreamJobCond);
+    return 0;
+}
+
+/* precond: lock fileCache with no streamIo, or be the worker doing the
+ * streamIo. read up to len bytes at offset from the server. Returns the
+ * bytes read or an iRODS error */
+static int
+_streamReadAt (fileCache_t *fileCache, char *buf, int len, rodsLong_t offset)
+{
+    int status;
+    iFuseConn_t *conn;
+    openedDataObjInp_t dataObjReadInp;
+    bytesBuf_t dataObjReadOutBBuf;
+
+    status = _iFuseFileCacheLseek (fileCache, offset);
+    if (status < 0) return status;
+
+    bzero (&dataObjReadInp, sizeof (dataObjReadInp));
+    dataObjReadOutBBuf.buf = buf;
+    dataObjReadOutBBuf.len = len;
+    dataObjReadInp.l1descInx = fileCache->iFd;
+    dataObjReadInp.len = len;
+
+    conn = getAndUseConnByPath (fileCache->localPath, &MyRodsEnv, &status);
+    if (status < 0) return status;
+    status = rcDataObjRead (conn->conn, &dataObjReadInp, &dataObjReadOutBBuf);
+    unuseIFuseConn (conn);
+    if (status > 0) fileCache->offset += status;
+    return status;
+}
+
+/* precond: as for _streamReadAt. write len bytes at offset to the server */
+static int
+_streamWriteAt (fileCache_t *fileCache, char *buf, int len, rodsLong_t offset)
+{
+    int status;
+    iFuseConn_t *conn;
+    openedDataObjInp_t dataObjWriteInp;
+    bytesBuf_t dataObjWriteInpBBuf;
+
+    status = _iFuseFileCacheLseek (fileCache, offset);
+    if (status < 0) return status;
+
+    bzero (&dataObjWriteInp, sizeof (dataObjWriteInp));
+    dataObjWriteInpBBuf.buf = buf;
+    dataObjWriteInpBBuf.len = len;
+    dataObjWriteInp.l1descInx = fileCache->iFd;
+    dataObjWriteInp.len = len;
+
+    conn = getAndUseConnByPath (fileCache->localPath, &MyRodsEnv, &status);
+    if (status < 0) return status;
+    status = rcDataObjWrite (conn->conn, &dataObjWriteInp,
+      &dataObjWriteInpBBuf);
+    unuseIFuseConn (conn);
+    if (status > 0) fileCache->offset += status;
+    if (status >= 0 && status != len) {
+        rodsLog (LOG_ERROR,
+          "_streamWriteAt: wrote %d of %d bytes of %s", status, len,
+          fileCache->localPath);
+        status = SYS_COPY_LEN_ERR;
+    }
+    return status;
+}
+
+/* precond: as for _streamReadAt. fill streamBuf with the window at offset */
+static int
+_fillStreamBuf (fileCache_t *fileCache, streamBuf_t **streamBuf,
+rodsLong_t offset)
+{
+    int status;
+
+    if (*streamBuf != NULL && (*streamBuf)->size != ReadAheadSize) {
+        freeStreamBuf (*streamBuf);
+        *streamBuf = NULL;
+    }
+    if (*streamBuf == NULL &&
+      (*streamBuf = newStreamBuf (ReadAheadSize)) == NULL) {
+        return SYS_MALLOC_ERR;
+    }
+    (*streamBuf)->offset = offset;
+    (*streamBuf)->len = 0;
+    status = _streamReadAt (fileCache, (*streamBuf)->buf, (*streamBuf)->size,
+      offset);
+    if (status > 0) (*streamBuf)->len = status;
+    return status;
+}
+
+/* precond: lock fileCache. take the oldest buffer off the queue */
+static streamBuf_t *
+_takeStreamHead (fileCache_t *fileCache)
+{
+    streamBuf_t *wb;
+
+    if ((wb = fileCache->writeBehind) == NULL) return NULL;
+    fileCache->writeBehind = wb->next;
+    fileCache->numWriteBehind--;
+    wb->next = NULL;
+    return wb;
+}
+
+/* precond: lock fileCache. keep the error of the write of wb for the
+ * user and free it */
+static int
+_doneStreamWrite (fileCache_t *fileCache, streamBuf_t *wb, int status)
+{
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "_doneStreamWrite: write of %lld bytes at %lld of %s error",
+          (rodsLong_t) wb->len, wb->offset, fileCache->localPath);
+        if (fileCache->streamStatus >= 0) fileCache->streamStatus = status;
+    }
+    freeStreamBuf (wb);
+    return status;
+}
+
+/* precond: lock fileCache with no streamIo. write out the oldest queued
+ * buffer */
+static int
+_writeStreamHead (fileCache_t *fileCache)
+{
+    streamBuf_t *wb;
+    int status;
+
+    if ((wb = _takeStreamHead (fileCache)) == NULL) return 0;
+    status = _streamWriteAt (fileCache, wb->buf, wb->len, wb->offset);
+    return _doneStreamWrite (fileCache, wb, status);
+}
+
+/* precond: lock fileCache. wait until no worker does i/o on the fd of
+ * fileCache. The lock is released while waiting */
+void
+_ifuseStreamWait (fileCache_t *fileCache)
+{
+    while (fileCache->streamIo != STREAM_IO_NONE) {
+        /* take StreamIdleLock before letting go of fileCache so that
+         * the signal of _endStreamIo cannot be missed */
+#ifdef USE_BOOST
+        boost::unique_lock<boost::mutex> idleLock (StreamIdleLock);
+        UNLOCK_STRUCT(*fileCache);
+        StreamIdleCond.wait (idleLock);
+        idleLock.unlock ();
+#else
+        pthread_mutex_lock (&StreamIdleLock);
+        UNLOCK_STRUCT(*fileCache);
+        pthread_cond_wait (&StreamIdleCond, &StreamIdleLock);
+        pthread_mutex_unlock (&StreamIdleLock);
+#endif
+        LOCK_STRUCT(*fileCache);
+    }
+}
+
+/* precond: lock fileCache. the worker is done with the fd */
+static void
+_endStreamIo (fileCache_t *fileCache)
+{
+    fileCache->streamIo = STREAM_IO_NONE;
+#ifdef USE_BOOST
+    StreamIdleLock.lock ();
+    StreamIdleCond.notify_all ();
+    StreamIdleLock.unlock ();
+#else
+    pthread_mutex_lock (&StreamIdleLock);
+    pthread_cond_broadcast (&StreamIdleCond);
+    pthread_mutex_unlock (&StreamIdleLock);
+#endif
+}
+
+/* precond: lock fileCache. move the buffer being filled to the end of
+ * the queue and have a worker write it */
+static int
+_queueWriteFill (fileCache_t *fileCache, int postJob)
+{
+    streamBuf_t *wb, *tmpWb;
+    rodsLong_t offset;
+
+    if ((wb = fileCache->writeFill) == NULL) return 0;
+    fileCache->writeFill = NULL;
+    if (wb->len == 0) {
+        freeStreamBuf (wb);
+        return 0;
+    }
+    if (fileCache->writeBehind == NULL) {
+        fileCache->writeBehind = wb;
+    } else {
+        tmpWb = fileCache->writeBehind;
+        while (tmpWb->next != NULL) tmpWb = tmpWb->next;
+        tmpWb->next = wb;
+    }
+    fileCache->numWriteBehind++;
+    offset = wb->offset;
+
+    /* too far behind. catch up here unless a worker is at it already.
+     * _ifuseStreamWrite waits for it when the queue is full */
+    while (fileCache->numWriteBehind > MAX_WRITE_BEHIND_BUF &&
+      fileCache->streamIo == STREAM_IO_NONE) {
+        _writeStreamHead (fileCache);
+    }
+    if (postJob && fileCache->numWriteBehind > 0) {
+        return _postStreamJob (fileCache, STREAM_WRITE_JOB, offset);
+    }
+    return 0;
+}
+
+/* precond: lock fileCache. returns and clears the error of an earlier
+ * background write */
+static int
+_getStreamStatus (fileCache_t *fileCache)
+{
+    int status = fileCache->streamStatus;
+
+    if (status < 0) {
+        fileCache->streamStatus = 0;
+        return streamErrno (status);
+    }
+    return 0;
+}
+
+/* precond: lock fileCache. write out all the data held back by the
+ * write-behind, including what a worker is writing */
+int
+_ifuseStreamFlush (fileCache_t *fileCache)
+{
+    _queueWriteFill (fileCache, 0);
+    while (fileCache->writeBehind != NULL ||
+      fileCache->streamIo == STREAM_IO_WRITE) {
+        if (fileCache->streamIo != STREAM_IO_NONE) {
+            _ifuseStreamWait (fileCache);
+            continue;
+        }
+        _writeStreamHead (fileCache);
+    }
+    return _getStreamStatus (fileCache);
+}
+
+int
+ifuseStreamFlush (fileCache_t *fileCache)
+{
+    int status = 0;
+
+    if (fileCache == NULL) return 0;
+    LOCK_STRUCT(*fileCache);
+    if (fileCache->state == NO_FILE_CACHE) {
+        status = _ifuseStreamFlush (fileCache);
+    }
+    UNLOCK_STRUCT(*fileCache);
+    return status;
+}
+
+/* precond: lock fileCache. forget the read-ahead data */
+void
+_ifuseStreamDrop (fileCache_t *fileCache)
+{
+    if (fileCache->readAhead != NULL) fileCache->readAhead->len = 0;
+    if (fileCache->prefetch != NULL) fileCache->prefetch->len = 0;
+    fileCache->prefetchState = PREFETCH_NONE;
+    fileCache->readAheadGen++;
+}
+
+/* precond: lock fileCache */
+int
+_ifuseStreamRead (fileCache_t *fileCache, char *buf, size_t size, off_t offset)
+{
+    streamBuf_t *ra, *tmpBuf;
+    int status, len;
+    int total = 0;
+    rodsLong_t raEnd;
+
+    /* see what has been written */
+    if ((status = _ifuseStreamFlush (fileCache)) < 0) return status;
+
+    while (total < (int) size) {
+        ra = fileCache->readAhead;
+        if (ra != NULL && ra->len == 0) ra = NULL;	/* dropped */
+        raEnd = ra != NULL ? ra->offset + ra->len : -1;
+        if (ra != NULL && offset >= ra->offset && offset < raEnd) {
+            len = raEnd - offset;
+            if (len > (int) size - total) len = (int) size - total;
+            memcpy (buf + total, ra->buf + (offset - ra->offset), len);
+            total += len;
+            offset += len;
+            continue;
+        }
+        if (ra != NULL && offset == raEnd && ra->len < ra->size) {
+            /* the window ended short. end of file */
+            break;
+        }
+        if (fileCache->streamIo != STREAM_IO_NONE) {
+            /* a worker has the fd. It may be fetching this very window */
+            _ifuseStreamWait (fileCache);
+            continue;
+        }
+        if (total == 0 && offset != fileCache->lastReadEnd &&
+          offset != raEnd) {
+            /* not sequential. just read what is asked for */
+            status = _streamReadAt (fileCache, buf, (int) size, offset);
+            if (status < 0) return streamErrno (status);
+            fileCache->lastReadEnd = offset + status;
+            return status;
+        }
+        if (fileCache->prefetchState == PREFETCH_DONE &&
+          fileCache->prefetch->offset == offset) {
+            /* the worker got it */
+            tmpBuf = fileCache->readAhead;
+            fileCache->readAhead = fileCache->prefetch;
+            fileCache->prefetch = tmpBuf;
+            fileCache->prefetchState = PREFETCH_NONE;
+        } else {
+            /* a pending prefetch would be too late now */
+            if (fileCache->prefetchState != PREFETCH_NONE) {
+                fileCache->prefetchState = PREFETCH_NONE;
+                fileCache->readAheadGen++;
+            }
+            status = _fillStreamBuf (fileCache, &fileCache->readAhead, offset);
+            if (status < 0) {
+                if (total > 0) break;
+                return streamErrno (status);
+            }
+            if (status == 0) break;
+        }
+    }
+    fileCache->lastReadEnd = offset;
+
+    /* half way through the window. have the next one fetched */
+    ra = fileCache->readAhead;
+    if (ra != NULL && ra->len == ra->size &&
+      fileCache->prefetchState == PREFETCH_NONE &&
+      offset >= ra->offset + ra->len / 2) {
+        fileCache->prefetchState = PREFETCH_PENDING;
+        if (_postStreamJob (fileCache, STREAM_READ_JOB,
+          ra->offset + ra->len) < 0 || NumStreamThr <= 0) {
+            fileCache->prefetchState = PREFETCH_NONE;
+        }
+    }
+
+    return total;
+}
+
+/* precond: lock fileCache */
+int
+_ifuseStreamWrite (fileCache_t *fileCache, char *buf, size_t size, off_t offset)
+{
+    streamBuf_t *wb;
+    int status;
+
+    if ((status = _getStreamStatus (fileCache)) < 0) return status;
+    if (fileCache->numWriteBehind >= MAX_WRITE_BEHIND_BUF) {
+        /* let the worker catch up. Past this point the lock is kept
+         * unless this write goes out directly */
+        _ifuseStreamWait (fileCache);
+    }
+    _ifuseStreamDrop (fileCache);
+
+    wb = fileCache->writeFill;
+    if (wb != NULL && (offset != wb->offset + wb->len ||
+      wb->len + (int) size > wb->size)) {
+        /* not contiguous or does not fit. send it on */
+        _queueWriteFill (fileCache, 1);
+        wb = NULL;
+    }
+    if ((int) size >= WriteBehindSize) {
+        /* as big as a buffer. write it now, after what is queued */
+        if ((status = _ifuseStreamFlush (fileCache)) < 0) return status;
+        _ifuseStreamWait (fileCache);
+        status = _streamWriteAt (fileCache, buf, (int) size, offset);
+        if (status < 0) return streamErrno (status);
+    } else {
+        if (wb == NULL) {
+            if ((wb = newStreamBuf (WriteBehindSize)) == NULL) {
+                return -ENOMEM;
+            }
+            wb->offset = offset;
+            fileCache->writeFill = wb;
+        }
+        memcpy (wb->buf + wb->len, buf, size);
+        wb->len += size;
+        if (wb->len == wb->size) {
+            _queueWriteFill (fileCache, 1);
+        }
+    }
+    if (offset + (rodsLong_t) size > fileCache->fileSize) {
+        fileCache->fileSize = offset + size;
+    }
+    return (int) size;
+}
+
+/* precond: lock fileCache or single thread use */
+void
+freeFileStream (fileCache_t *fileCache)
+{
+    streamBuf_t *wb;
+
+    while ((wb = fileCache->writeBehind) != NULL) {
+        fileCache->writeBehind = wb->next;
+        freeStreamBuf (wb);
+    }
+    freeStreamBuf (fileCache->writeFill);
+    freeStreamBuf (fileCache->readAhead);
+    freeStreamBuf (fileCache->prefetch);
+    fileCache->writeFill = fileCache->readAhead = fileCache->prefetch = NULL;
+}
+
+/* the network i/o of a job is done without the fileCache lock. The
+ * buffer is taken off fileCache first and the result put back after */
+static void
+runStreamJob (streamJob_t *job)
+{
+    fileCache_t *fileCache = job->fileCache;
+    streamBuf_t *sb;
+    int status;
+
+    LOCK_STRUCT(*fileCache);
+    if (fileCache->state != NO_FILE_CACHE) {
+        /* nothing to do */
+    } else if (fileCache->streamIo != STREAM_IO_NONE) {
+        /* the worker with the fd writes what is queued when done. A
+         * prefetch would only be late. The reader fetches it */
+        if (job->type == STREAM_READ_JOB &&
+          job->gen == fileCache->readAheadGen &&
+          fileCache->prefetchState == PREFETCH_PENDING) {
+            fileCache->prefetchState = PREFETCH_NONE;
+        }
+    } else {
+        if (job->type == STREAM_READ_JOB &&
+          job->gen == fileCache->readAheadGen &&
+          fileCache->prefetchState == PREFETCH_PENDING) {
+            sb = fileCache->prefetch;
+            fileCache->prefetch = NULL;
+            fileCache->streamIo = STREAM_IO_READ;
+            UNLOCK_STRUCT(*fileCache);
+            status = _fillStreamBuf (fileCache, &sb, job->offset);
+            LOCK_STRUCT(*fileCache);
+            if (job->gen == fileCache->readAheadGen &&
+              fileCache->prefetchState == PREFETCH_PENDING) {
+                fileCache->prefetchState = PREFETCH_NONE;
+                if (status > 0 && fileCache->prefetch == NULL) {
+                    fileCache->prefetch = sb;
+                    fileCache->prefetchState = PREFETCH_DONE;
+                    sb = NULL;
+                }
+            }
+            if (sb != NULL) {
+                /* dropped while being read. keep the buffer for reuse */
+                sb->len = 0;
+                if (fileCache->prefetch == NULL) {
+                    fileCache->prefetch = sb;
+                } else {
+                    freeStreamBuf (sb);
+                }
+            }
+        }
+        /* write what is queued, in order. It may have been written by
+         * the fuse thread already */
+        while ((sb = _takeStreamHead (fileCache)) != NULL) {
+            fileCache->streamIo = STREAM_IO_WRITE;
+            UNLOCK_STRUCT(*fileCache);
+            status = _streamWriteAt (fileCache, sb->buf, sb->len, sb->offset);
+            LOCK_STRUCT(*fileCache);
+            _doneStreamWrite (fileCache, sb, status);
+        }
+        if (fileCache->streamIo != STREAM_IO_NONE) _endStreamIo (fileCache);
+    }
+    UNLOCK_STRUCT(*fileCache);
+    UNREF(job->fileCache, FileCache);
+    free (job);
+}
+
+void
+streamWorker ()
+{
+    streamJob_t *job;
+
+    while (1) {
+        job = (streamJob_t *) removeFirstElementOfConcurrentList (StreamJobQue);
+        if (job == NULL) {
+            timeoutWait (&StreamJobLock, &StreamJobCond,
+              STREAM_WORKER_SLEEP_TIME);
+            continue;
+        }
+        runStreamJob (job);
+    }
+}
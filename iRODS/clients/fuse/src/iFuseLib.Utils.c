@@ -24,6 +24,14 @@ fileCache_t *newFileCache(int iFd, char *objPath, char *localPath, char *cacheFi
 	fileCache->state = state;
 	fileCache->status = 0;
 fileCache->offset = 0;
+    fileCache->readAhead = fileCache->prefetch = NULL;
+    fileCache->prefetchState = PREFETCH_NONE;
+    fileCache->readAheadGen = 0;
+    fileCache->lastReadEnd = 0;
+    fileCache->writeBehind = fileCache->writeFill = NULL;
+    fileCache->numWriteBehind = 0;
+    fileCache->streamStatus = 0;
+    fileCache->streamIo = STREAM_IO_NONE;
     INIT_STRUCT_LOCK(*fileCache);
     return fileCache;
 }
@@ -95,6 +103,7 @@ iFuseDesc_t *newIFuseDesc (char *objPath, char *localPath, fileCache_t *fileCach
 }
 
 int _freeFileCache(fileCache_t *fileCache) {
+	freeFileStream(fileCache);
 	free(fileCache->fileCachePath);
 	free(fileCache->localPath);
 	free(fileCache->objPath);
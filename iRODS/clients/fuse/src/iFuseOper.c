@@ -16,6 +16,16 @@ irodsGetattr (const char *path, struct stat *stbuf)
     int status;
     iFuseConn_t *iFuseConn = NULL;
 
+    if (isDirCacheStatPath (path)) {
+        char statStr[MAX_NAME_LEN];
+        uint mytime = time (0);
+
+        memset (stbuf, 0, sizeof (struct stat));
+        fillFileStat (stbuf, S_IFREG | 0444,
+          getDirCacheStatStr (statStr, MAX_NAME_LEN), mytime, mytime, mytime);
+        return 0;
+    }
+
     iFuseConn = getAndUseConnByPath ((char *) path, &MyRodsEnv, &status);
     status = _irodsGetattr (iFuseConn, path, stbuf);
     unuseIFuseConn (iFuseConn);
@@ -30,6 +40,7 @@ _irodsGetattr (iFuseConn_t *iFuseConn, const char *path, struct stat *stbuf)
     rodsObjStat_t *rodsObjStatOut = NULL;
 #ifdef CACHE_FUSE_PATH
     pathCache_t *tmpPathCache;
+    int haveFileCache = 0;
 #endif
 
     rodsLog (LOG_DEBUG, "_irodsGetattr: %s", path);
@@ -44,6 +55,7 @@ _irodsGetattr (iFuseConn_t *iFuseConn, const char *path, struct stat *stbuf)
     if (matchAndLockPathCache ((char *) path, &tmpPathCache) == 1) {
         rodsLog (LOG_DEBUG, "irodsGetattr: a match for path %s", path);
         if (tmpPathCache->fileCache != NULL) {
+            haveFileCache = 1;
         	LOCK_STRUCT(*(tmpPathCache->fileCache));
         	if(tmpPathCache->fileCache->state == HAVE_NEWLY_CREATED_CACHE) {
         		status = _updatePathCacheStatFromFileCache (tmpPathCache);
@@ -63,6 +75,16 @@ _irodsGetattr (iFuseConn_t *iFuseConn, const char *path, struct stat *stbuf)
 	        UNLOCK_STRUCT(*tmpPathCache);
 		}
     }
+
+    /* the size of an opened file may not be that of the listing */
+    if (haveFileCache == 0) {
+        status = lookupDirCacheStat ((char *) path, stbuf);
+        if (status > 0) {
+            return (0);
+        } else if (status < 0) {
+            return (status);
+        }
+    }
 #endif
 
     memset (stbuf, 0, sizeof (struct stat));
@@ -191,6 +213,7 @@ off_t offset, struct fuse_file_info *fi)
 #ifdef CACHE_FUSE_PATH
     struct stat stbuf;
     pathCache_t *tmpPathCache;
+    dirCache_t *dirCache;
 #endif
     /* don't know why we need this. the example have them */
     (void) offset;
@@ -210,6 +233,17 @@ off_t offset, struct fuse_file_info *fi)
         return -ENOTDIR;
     }
 
+#ifdef CACHE_FUSE_PATH
+    status = fillDirFromCache ((char *) path, buf, filler);
+    if (status > 0) {
+        return (0);
+    } else if (status < 0) {
+        return (status);
+    }
+    /* the listing and the stat of the children are cached together */
+    dirCache = newDirCache ((char *) path);
+#endif
+
     iFuseConn = getAndUseConnByPath ((char *) path, &MyRodsEnv, &status);
     status = rclOpenCollection (iFuseConn->conn, collPath, 0, &collHandle);
 
@@ -224,6 +258,15 @@ off_t offset, struct fuse_file_info *fi)
               "irodsReaddir: rclOpenCollection of %s error. status = %d",
               collPath, status);
             unuseIFuseConn (iFuseConn);
+#ifdef CACHE_FUSE_PATH
+            if (dirCache != NULL && (status == USER_FILE_DOES_NOT_EXIST ||
+              status == CAT_UNKNOWN_COLLECTION)) {
+                dirCache->notExist = 1;
+                putDirCache (dirCache);
+            } else {
+                freeDirCache (dirCache);
+            }
+#endif
             return -ENOENT;
     }
     }
@@ -244,10 +287,11 @@ off_t offset, struct fuse_file_info *fi)
             snprintf (childPath, MAX_NAME_LEN, "%s/%s",
           path, collEnt.dataName);
         }
+        fillFileStat (&stbuf, collEnt.dataMode, collEnt.dataSize,
+          atoi (collEnt.createTime), atoi (collEnt.modifyTime),
+          atoi (collEnt.modifyTime));
+        addDirCacheEnt (dirCache, collEnt.dataName, &stbuf);
         if (lookupPathExist ((char *) childPath, &tmpPathCache) != 1) {
-            fillFileStat (&stbuf, collEnt.dataMode, collEnt.dataSize,
-              atoi (collEnt.createTime), atoi (collEnt.modifyTime),
-              atoi (collEnt.modifyTime));
             pathExist (childPath, NULL, &stbuf, &tmpPathCache);
         }
 #endif
@@ -261,10 +305,11 @@ off_t offset, struct fuse_file_info *fi)
             } else {
             snprintf (childPath, MAX_NAME_LEN, "%s/%s", path, mySubDir);
         }
+        fillDirStat (&stbuf,
+          atoi (collEnt.createTime), atoi (collEnt.modifyTime),
+          atoi (collEnt.modifyTime));
+        addDirCacheEnt (dirCache, mySubDir, &stbuf);
         if (lookupPathExist ((char *) childPath, &tmpPathCache) != 1) {
-            fillDirStat (&stbuf,
-              atoi (collEnt.createTime), atoi (collEnt.modifyTime),
-              atoi (collEnt.modifyTime));
             pathExist (childPath, NULL, &stbuf, &tmpPathCache);
         }
 #endif
@@ -273,6 +318,9 @@ off_t offset, struct fuse_file_info *fi)
     }
     rclCloseCollection (&collHandle);
     unuseIFuseConn (iFuseConn);
+#ifdef CACHE_FUSE_PATH
+    putDirCache (dirCache);
+#endif
 
     return (0);
 }
@@ -326,6 +374,7 @@ irodsMknod (const char *path, mode_t mode, dev_t rdev)
     }
     fileCache = addFileCache(localFd, objPath, (char *) path, cachePath, mode, 0, HAVE_NEWLY_CREATED_CACHE);
     stbuf.st_mode = mode;
+    invalidateDirCache ((char *) path);
     pathExist ((char *) path, fileCache, &stbuf, &tmpPathCache);
     /* desc = newIFuseDesc (objPath, (char *) path, fileCache, &status); */
 
@@ -385,6 +434,7 @@ irodsMkdir (const char *path, mode_t mode)
     bzero (&stbuf, sizeof (struct stat));
         fillDirStat (&stbuf, mytime, mytime, mytime);
         pathExist ((char *) path, NULL, &stbuf, NULL);
+        invalidateDirCache ((char *) path);
 #endif
         unuseIFuseConn (iFuseConn);
     }
@@ -419,6 +469,7 @@ irodsUnlink (const char *path)
     if (status >= 0) {
 #ifdef CACHE_FUSE_PATH
     pathNotExist ((char *) path);
+    invalidateDirCache ((char *) path);
 #endif
     status = 0;
     } else {
@@ -466,6 +517,7 @@ irodsRmdir (const char *path)
     if (status >= 0) {
 #ifdef CACHE_FUSE_PATH
         pathNotExist ((char *) path);
+        invalidateDirCache ((char *) path);
 #endif
         status = 0;
     } else {
@@ -537,6 +589,9 @@ irodsSymlink (const char *to, const char *from)
     }
 
     l1descInx = status;
+#ifdef CACHE_FUSE_PATH
+    invalidateDirCache ((char *) from);
+#endif
 
     memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
     memset(&dataObjWriteOutBBuf, 0, sizeof (bytesBuf_t));
@@ -613,6 +668,8 @@ irodsRename (const char *from, const char *to)
 
     if (status >= 0) {
 #ifdef CACHE_FUSE_PATH
+        invalidateDirCache ((char *) from);
+        invalidateDirCache ((char *) to);
         status = renmeLocalPath ((char *) from, (char *) to, (char *) toIrodsPath);
 #endif
     } else {
@@ -700,6 +757,7 @@ irodsChmod (const char *path, mode_t mode)
 #ifdef CACHE_FUSE_PATH
         pathCache_t *tmpPathCache;
 
+        invalidateDirCache ((char *) path);
         if (matchAndLockPathCache ((char *) path, &tmpPathCache) == 1) {
             tmpPathCache->stbuf.st_mode &= 0xfffffe00;
             tmpPathCache->stbuf.st_mode |= (mode & 0777);
@@ -747,6 +805,16 @@ irodsTruncate (const char *path, off_t size)
                     UNLOCK_STRUCT(*tmpPathCache);
                     return (0);
                 }
+            } else if (tmpPathCache->fileCache->state == NO_FILE_CACHE) {
+                /* the held back writes go before the truncate and the
+                 * read-ahead data may be past the new end */
+                status = _ifuseStreamFlush (tmpPathCache->fileCache);
+                _ifuseStreamDrop (tmpPathCache->fileCache);
+                if (status < 0) {
+                    UNLOCK_STRUCT(*(tmpPathCache->fileCache));
+                    UNLOCK_STRUCT(*tmpPathCache);
+                    return (status);
+                }
             }
             UNLOCK_STRUCT(*(tmpPathCache->fileCache));
         }
@@ -770,8 +838,18 @@ irodsTruncate (const char *path, off_t size)
     if (status >= 0) {
         pathCache_t *tmpPathCache;
 
+        invalidateDirCache ((char *) path);
         if (matchAndLockPathCache ((char *) path, &tmpPathCache) == 1) {
             tmpPathCache->stbuf.st_size = size;
+            if (tmpPathCache->fileCache != NULL) {
+                LOCK_STRUCT(*tmpPathCache->fileCache);
+                if (tmpPathCache->fileCache->state == NO_FILE_CACHE) {
+                    /* a read may have come in before the truncate */
+                    _ifuseStreamDrop (tmpPathCache->fileCache);
+                    tmpPathCache->fileCache->fileSize = size;
+                }
+                UNLOCK_STRUCT(*(tmpPathCache->fileCache));
+            }
         }
         UNLOCK_STRUCT(*tmpPathCache);
         status = 0;
@@ -788,8 +866,20 @@ irodsTruncate (const char *path, off_t size)
 int
 irodsFlush (const char *path, struct fuse_file_info *fi)
 {
+    int descInx;
+
     rodsLog (LOG_DEBUG, "irodsFlush: %s", path);
-    return (0);
+
+    if (isDirCacheStatPath (path)) return (0);
+
+    descInx = fi->fh;
+
+    if (checkFuseDesc (descInx) < 0) {
+        return -EBADF;
+    }
+
+    /* close() gets the errors of the write-behind */
+    return (ifuseStreamFlush (IFuseDesc[descInx].fileCache));
 }
 
 int
@@ -815,6 +905,16 @@ irodsOpen (const char *path, struct fuse_file_info *fi)
 
     rodsLog (LOG_DEBUG, "irodsOpen: %s, flags = %d", path, fi->flags);
 
+    if (isDirCacheStatPath (path)) {
+        if ((flags & (O_WRONLY | O_RDWR)) != 0) return -EACCES;
+        fi->fh = 0;
+        return (0);
+    }
+    if ((flags & (O_WRONLY | O_RDWR)) != 0) {
+        /* the size in the listing will change */
+        invalidateDirCache ((char *) path);
+    }
+
     matchAndLockPathCache((char *) path, &tmpPathCache);
     if(tmpPathCache!= NULL) {
         if(tmpPathCache->fileCache != NULL) {
@@ -932,6 +1032,16 @@ struct fuse_file_info *fi)
 
     rodsLog (LOG_DEBUG, "irodsRead: %s", path);
 
+    if (isDirCacheStatPath (path)) {
+        char statStr[MAX_NAME_LEN];
+        int len = getDirCacheStatStr (statStr, MAX_NAME_LEN);
+
+        if (offset >= len) return (0);
+        if (size > len - offset) size = len - offset;
+        memcpy (buf, statStr + offset, size);
+        return (size);
+    }
+
     descInx = fi->fh;
 
     if (checkFuseDesc (descInx) < 0) {
@@ -997,6 +1107,8 @@ irodsRelease (const char *path, struct fuse_file_info *fi)
 
     rodsLog (LOG_DEBUG, "irodsRelease: %s", path);
 
+    if (isDirCacheStatPath (path)) return (0);
+
     descInx = fi->fh;
 
     /* if (checkFuseDesc (descInx) < 0) {
@@ -1004,6 +1116,10 @@ irodsRelease (const char *path, struct fuse_file_info *fi)
     } */
 
     status = ifuseClose (&IFuseDesc[descInx]);
+    if ((fi->flags & (O_WRONLY | O_RDWR)) != 0) {
+        /* the data is on the server now */
+        invalidateDirCache ((char *) path);
+    }
 
     if (status < 0) {
         if ((myError = getErrno (status)) > 0) {
@@ -1019,8 +1135,23 @@ irodsRelease (const char *path, struct fuse_file_info *fi)
 int
 irodsFsync (const char *path, int isdatasync, struct fuse_file_info *fi)
 {
+    int descInx;
+    int status;
+
     rodsLog (LOG_DEBUG, "irodsFsync: %s", path);
-    return (0);
+
+    descInx = fi->fh;
+
+    if (checkFuseDesc (descInx) < 0) {
+        return -EBADF;
+    }
+
+    status = ifuseFlush (descInx);
+    if (status < 0) {
+        return status;
+    } else {
+        return (0);
+    }
 }
 
 
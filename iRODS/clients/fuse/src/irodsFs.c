@@ -170,6 +170,8 @@ irodsOper.flush = irodsFlush;
     initIFuseDesc ();
     initConn();
     initFileCache();
+    initFileStream();
+    initDirCache();
 
     status = fuse_main (argc, argv, &irodsOper, NULL);
 
@@ -192,6 +194,11 @@ usage ()
 " -h  this help",
 " -d  FUSE debug mode",
 " -o  opt,[opt...]  FUSE mount options",
+" ",
+"The listing of a directory is cached for FuseDirCacheTime secs (default 30,",
+"0 turns it off). At most FuseDirCacheSize (default 1024) listings of up to",
+"FuseDirCacheMaxEntries (default 10000) entries are kept. The cache hit",
+"counts can be read from the file .irodsFsStat under the mount point.",
 ""};
     int i;
     for (i=0;;i++) {
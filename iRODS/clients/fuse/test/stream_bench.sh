@@ -0,0 +1,57 @@
+# $1 = fuse mount point of the home collection $2 = (optional) size in MB
+# compares the read and write throughput of the mount with iget and iput.
+# Run with different FuseReadAheadSize and FuseWriteBehindSize settings
+# of irodsFs to see what the read-ahead and write-behind give.
+dir=$1
+size=${2:-256}
+name=stream_bench.$$
+local=/tmp/$name
+
+if [ ! -d "$dir" ]
+then
+	echo usage: $0 mountPoint [sizeInMB]
+	exit 1
+fi
+
+report () {
+	# $1 = label $2 = start time $3 = end time
+	awk -v l="$1" -v s=$2 -v e=$3 -v sz=$size 'BEGIN {
+	  t = e - s; if (t <= 0) t = 0.001;
+	  printf "%-12s %8.2f s %8.1f MB/s\n", l, t, sz / t }'
+}
+
+dd if=/dev/urandom of=$local bs=1048576 count=$size 2> /dev/null
+
+t0=`date +%s.%N`
+iput -f $local $name || exit 2
+t1=`date +%s.%N`
+report iput $t0 $t1
+
+t0=`date +%s.%N`
+iget -f $name $local.iget || exit 2
+t1=`date +%s.%N`
+report iget $t0 $t1
+
+t0=`date +%s.%N`
+dd if=$dir/$name of=$local.fuse bs=131072 2> /dev/null || exit 2
+t1=`date +%s.%N`
+report "fuse read" $t0 $t1
+
+t0=`date +%s.%N`
+dd if=$local of=$dir/$name.w bs=131072 conv=fsync 2> /dev/null || exit 2
+t1=`date +%s.%N`
+report "fuse write" $t0 $t1
+
+status=0
+for f in $local.iget $local.fuse $dir/$name.w
+do
+	if ! cmp -s $local $f
+	then
+		echo [error] $f differs from $local
+		status=3
+	fi
+done
+
+irm -f $name $name.w
+rm -f $local $local.iget $local.fuse
+exit $status
@@ -22,7 +22,7 @@ main(int argc, char **argv) {
     int reconnFlag;
     
 
-    optStr = "hfIKN:n:PQrt:vVX:R:TZ";
+    optStr = "hfIj:KN:n:PQrt:vVX:R:TZ";
    
     status = parseCmdLineOpt (argc, argv, optStr, 1, &myRodsArgs);
 
@@ -95,7 +95,7 @@ usage () {
    char *msgs[]={
 "Usage: iget [-fIKPQrUvVT] [-n replNumber] [-N numThreads] [-X restartFile]",
 "[-R resource] [--lfrestart lfRestartFile] [--retries count] [--purgec]",
-"[--rlock]  srcDataObj|srcCollection ... destLocalFile|destLocalDir",
+"[--rlock] [-j numConn]  srcDataObj|srcCollection ... destLocalFile|destLocalDir",
 "Usage : iget [-fIKPQUvVT] [-n replNumber] [-N numThreads] [-X restartFile]",
 "[-R resource] [--lfrestart lfRestartFile] [--retries count] [--purgec]",
 "[--rlock]  srcDataObj|srcCollection",
@@ -142,12 +142,21 @@ usage () {
 "server after 10 minutes of connection. This gets around the problem of",
 "sockets getting timed out by the firewall as reported by some users.",
 " ",
+"The -j option downloads a collection with a pool of numConn connections",
+"(default 4, max 16). The collection is listed while the files are being",
+"received. Data objects larger than 32 Mbytes are received one per",
+"connection, each with its own parallel transfer. The smaller ones of a",
+"collection are handed to a connection in batches of up to 50. With -v,",
+"the throughput of each file and of the whole download is shown. The -X",
+"option works with -j. The -I option is not used with -j.",
+" ",
 "Options are:",
 
 " -f  force - write local files even it they exist already (overwrite them)",
 " -I  redirect connection - redirect the connection to connect directly",
 "       to the best (determiined by the first 10 data objects in the input",
 "       collection) resource server.",
+" -j  numConn - download a collection with a pool of numConn connections",
 " -K  verify the checksum",
 " -n  replNumber - retrieve the copy with the specified replica number ",
 " -N  numThreads - the number of thread to use for the transfer. A value of",
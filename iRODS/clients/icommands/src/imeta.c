@@ -27,6 +27,7 @@ int lastCommandStatus=0;
 int printCount=0;
 
 int usage(char *subOpt);
+int parseInputLine(char *ttybuf, char *cmdToken[], int maxTokens);
 
 /* 
  print the results of a general query.
@@ -1098,6 +1099,31 @@ modCopyAVUMetadata(char *arg0, char *arg1, char *arg2, char *arg3,
    return(status);
 }
 
+/*
+ Get the full name of the object of an AVU command; the names of
+ dataObjs and collections are relative to the cwd.
+ */
+void
+getAVUObjName(char *type, char *name, char *fullName) {
+   strncpy(fullName, cwd, MAX_NAME_LEN);
+   if (strcmp(type,"-R")==0 || strcmp(type,"-r")==0 || 
+       strcmp(type,"-G")==0 || strcmp(type,"-g")==0 || 
+       strcmp(type,"-u")==0) {
+      strncpy(fullName, name, MAX_NAME_LEN);
+   }
+   else {
+      if (strlen(name)>0) {
+	 if (*name=='/') {
+	    strncpy(fullName, name, MAX_NAME_LEN);
+	 }
+	 else {
+	    rstrcat(fullName, "/", MAX_NAME_LEN);
+	    rstrcat(fullName, name, MAX_NAME_LEN);
+	 }
+      }
+   }
+}
+
 /*
  Modify (add or remove) AVUs
  */
@@ -1110,23 +1136,7 @@ modAVUMetadata(char *arg0, char *arg1, char *arg2, char *arg3,
    char *myName;
    char fullName[MAX_NAME_LEN];
 
-   strncpy(fullName, cwd, MAX_NAME_LEN);
-   if (strcmp(arg1,"-R")==0 || strcmp(arg1,"-r")==0 || 
-       strcmp(arg1,"-G")==0 || strcmp(arg1,"-g")==0 || 
-       strcmp(arg1,"-u")==0) {
-      strncpy(fullName, arg2, MAX_NAME_LEN);
-   }
-   else {
-      if (strlen(arg2)>0) {
-	 if (*arg2=='/') {
-	    strncpy(fullName, arg2, MAX_NAME_LEN);
-	 }
-	 else {
-	    rstrcat(fullName, "/", MAX_NAME_LEN);
-	    rstrcat(fullName, arg2, MAX_NAME_LEN);
-	 }
-      }
-   }
+   getAVUObjName(arg1, arg2, fullName);
 
    modAVUMetadataInp.arg0 = arg0;
    modAVUMetadataInp.arg1 = arg1;
@@ -1161,27 +1171,143 @@ modAVUMetadata(char *arg0, char *arg1, char *arg2, char *arg3,
    return(status);
 }
 
+/*
+ Send the operations of a batch and report any error.
+ Return code is error or the number of AVUs added.
+ */
+int
+sendBulkAVUMetadata(bulkAVUMetadataInp_t *bulkAVUMetadataInp) {
+   int status;
+   char *mySubName;
+   char *myName;
+
+   status = rcBulkAVUMetadata(Conn, bulkAVUMetadataInp);
+   lastCommandStatus = status;
+
+   if (status < 0 ) {
+      if (Conn->rError) {
+	 rError_t *Err;
+         rErrMsg_t *ErrMsg;
+	 int i, len;
+	 Err = Conn->rError;
+	 len = Err->len;
+	 for (i=0;i<len;i++) {
+	    ErrMsg = Err->errMsg[i];
+	    rodsLog(LOG_ERROR, "Level %d: %s",i, ErrMsg->msg);
+	 }
+      }
+      myName = rodsErrorName(status, &mySubName);
+      rodsLog (LOG_ERROR, "rcBulkAVUMetadata failed with error %d %s %s",
+	       status, myName, mySubName);
+   }
+   else {
+      lastCommandStatus = 0;
+   }
+   return(status);
+}
+
+/*
+ Add and remove AVUs as listed in a file (or stdin), one 'add' or
+ 'rm' command per line, sending up to MAX_BULK_AVU_OPS of them per
+ call.
+ */
+int
+batchAVUMetadata(char *fileName) {
+   FILE *fd;
+   char lineBuf[BIG_STR+2];
+   char *lineToken[10];
+   char fullName[MAX_NAME_LEN];
+   bulkAVUMetadataInp_t bulkAVUMetadataInp;
+   int status, len, lineNum, numOps, numAdded;
+
+   if (*fileName=='\0') {
+      fd = stdin;
+   }
+   else {
+      fd = fopen(fileName, "r");
+      if (fd==NULL) {
+	 printf("Unable to open file %s\n", fileName);
+	 lastCommandStatus = UNIX_FILE_OPEN_ERR;
+	 return(-2);
+      }
+   }
+
+   memset(&bulkAVUMetadataInp, 0, sizeof(bulkAVUMetadataInp));
+   status=0;
+   lineNum=0;
+   numOps=0;
+   numAdded=0;
+   while (fgets(lineBuf, BIG_STR, fd)!=NULL) {
+      lineNum++;
+      len = strlen(lineBuf);
+      if (len==0 || lineBuf[len-1]!='\n') {
+	 if (len>=BIG_STR-1) {
+	    printf("Line %d is too long\n", lineNum);
+	    status=-2;
+	    break;
+	 }
+	 lineBuf[len++]='\n';
+	 lineBuf[len]='\0';
+      }
+      if (parseInputLine(lineBuf, lineToken, 10) < 0) {
+	 status=-2;
+	 break;
+      }
+      if (*lineToken[0]=='\0' || *lineToken[0]=='#') continue;
+      if ((strcmp(lineToken[0],"add")!=0 && strcmp(lineToken[0],"rm")!=0) ||
+	  *lineToken[4]=='\0' || *lineToken[6]!='\0') {
+	 printf("Line %d is not an add or rm command\n", lineNum);
+	 status=-2;
+	 break;
+      }
+      getAVUObjName(lineToken[1], lineToken[2], fullName);
+      status = addBulkAVUMetadataOp(&bulkAVUMetadataInp, lineToken[0],
+				    lineToken[1], fullName, lineToken[3],
+				    lineToken[4], lineToken[5]);
+      if (status < 0) break;
+      if (bulkAVUMetadataInp.numOps >= MAX_BULK_AVU_OPS) {
+	 status = sendBulkAVUMetadata(&bulkAVUMetadataInp);
+	 if (status < 0) break;
+	 numAdded += status;
+	 numOps += bulkAVUMetadataInp.numOps;
+	 clearBulkAVUMetadataInp(&bulkAVUMetadataInp);
+      }
+   }
+   if (status >= 0 && bulkAVUMetadataInp.numOps > 0) {
+      status = sendBulkAVUMetadata(&bulkAVUMetadataInp);
+      if (status >= 0) {
+	 numAdded += status;
+	 numOps += bulkAVUMetadataInp.numOps;
+      }
+   }
+   clearBulkAVUMetadataInp(&bulkAVUMetadataInp);
+   if (fd != stdin) fclose(fd);
+
+   if (status == -2) {
+      lastCommandStatus = -1;
+      if (numOps > 0) {
+	 printf("%d operations done before line %d\n", numOps, lineNum);
+      }
+      return(-2);
+   }
+   if (status < 0) {
+      lastCommandStatus = status;
+      return(status);
+   }
+   printf("%d operations done, %d AVUs added\n", numOps, numAdded);
+   return(0);
+}
+
 /* 
- Prompt for input and parse into tokens
+ Parse a newline terminated input line into tokens (in place)
 */
 int
-getInput(char *cmdToken[], int maxTokens) {
+parseInputLine(char *ttybuf, char *cmdToken[], int maxTokens) {
    int lenstr, i;
-   static char ttybuf[BIG_STR];
    int nTokens;
    int tokenFlag; /* 1: start reg, 2: start ", 3: start ' */
    char *cpTokenStart;
-   char *stat;
 
-   memset(ttybuf, 0, BIG_STR);
-   fputs("imeta>",stdout);
-   stat = fgets(ttybuf, BIG_STR, stdin);
-   if (stat==0) {
-      printf("\n");
-      rcDisconnect(Conn);
-      if (lastCommandStatus != 0) exit(4);
-      exit(0);
-   }
    lenstr=strlen(ttybuf);
    for (i=0;i<maxTokens;i++) {
       cmdToken[i]="";
@@ -1243,6 +1369,26 @@ getInput(char *cmdToken[], int maxTokens) {
    return(0);
 }
 
+/* 
+ Prompt for input and parse into tokens
+*/
+int
+getInput(char *cmdToken[], int maxTokens) {
+   static char ttybuf[BIG_STR];
+   char *stat;
+
+   memset(ttybuf, 0, BIG_STR);
+   fputs("imeta>",stdout);
+   stat = fgets(ttybuf, BIG_STR, stdin);
+   if (stat==0) {
+      printf("\n");
+      rcDisconnect(Conn);
+      if (lastCommandStatus != 0) exit(4);
+      exit(0);
+   }
+   return(parseInputLine(ttybuf, cmdToken, maxTokens));
+}
+
 /*
  Detect a 'l' in a '-' option and if present, set a mode flag and
  remove it from the string (to simplify other processing).
@@ -1415,6 +1561,13 @@ doCommand(char *cmdToken[]) {
       }
    }
 
+   if (strcmp(cmdToken[0],"batch") == 0) {
+      int myStat;
+      myStat = batchAVUMetadata(cmdToken[1]);
+      if (myStat == -2) return(-2);
+      return(0);
+   }
+
    if (strcmp(cmdToken[0],"cp") == 0) {
       modCopyAVUMetadata("cp", cmdToken[1], cmdToken[2], 
 		     cmdToken[3], cmdToken[4], cmdToken[5],
@@ -1661,6 +1814,7 @@ void usageMain()
 " lsw -[l]d|C|R|G|u Name [AttName] (List existing AVUs, use Wildcards)", 
 " qu -d|C|R|G|u AttName Op AttVal [...] (Query objects with matching AVUs)", 
 " cp -d|C|R|G|u -d|C|R|G|u Name1 Name2 (Copy AVUs from item Name1 to Name2)", 
+" batch [File] (Do many add and rm commands, from File or stdin, at once)",
 " upper (Toggle between upper case mode for queries (qu)",
 " ", 
 "Metadata attribute-value-units triplets (AVUs) consist of an Attribute-Name,", 
@@ -1892,6 +2046,26 @@ usage(char *subOpt)
 "returns data-objects with attribute 'a' with a value that starts with 'b'.",
 " qu -d a like %",
 "returns data-objects with attribute 'a' defined (with any value).",
+""};
+	 for (i=0;;i++) {
+	    if (strlen(msgs[i])==0) return(0);
+	    printf("%s\n",msgs[i]);
+	 }
+      }
+      if (strcmp(subOpt,"batch")==0) {
+	 char *msgs[]={
+" batch [File] (Do many add and rm commands at once)", 
+"Read add and rm commands, one per line, from File (or stdin if no",
+"File is given) and send them to the server together, which is much",
+"faster than one command at a time when loading the AVUs of many",
+"objects.  The lines are as for add and rm, for example:",
+"  add -d file1 distance 12 miles",
+"  add -C /tempZone/home/rods/coll1 project x",
+"  rm -d file1 distance 10 miles",
+"Empty lines and lines starting with # are skipped.",
+"Up to 10000 lines are done in one catalog transaction; within it the",
+"removals are done first.  Adding an AVU an object already has is not",
+"an error.",
 ""};
 	 for (i=0;;i++) {
 	    if (strlen(msgs[i])==0) return(0);
@@ -93,6 +93,7 @@ printProcStat (rodsArguments_t *myRodsArgs, genQueryOut_t *procStatOut)
     int i, rowCnt;
     sqlResult_t *pid, *startTime, *clientName, *clientZone, *proxyName,
       *proxyZone, *remoteAddr, *serverAddr, *progName;
+    sqlResult_t *l1descHwm, *l3descHwm;
     uint curTime;
 
     if (myRodsArgs == NULL || procStatOut == NULL) return USER__NULL_INPUT_ERR;
@@ -148,6 +149,10 @@ printProcStat (rodsArguments_t *myRodsArgs, genQueryOut_t *procStatOut)
           "printProcStat: getSqlResultByInx for PROG_NAME_INX failed");
         return (UNMATCHED_KEY_OR_INDEX);
     }
+    /* servers before the descriptor high water marks were added don't
+     * return them */
+    l1descHwm = getSqlResultByInx (procStatOut, L1DESC_HWM_INX);
+    l3descHwm = getSqlResultByInx (procStatOut, L3DESC_HWM_INX);
     rowCnt = procStatOut->rowCnt;
 
     for (i = 0; i < rowCnt; i++) {
@@ -177,7 +182,14 @@ printProcStat (rodsArguments_t *myRodsArgs, genQueryOut_t *procStatOut)
 	    continue;	/* no connection for this server */
 	}
 	getUptimeStr (startTimeVal, curTime, uptimeStr);
-	if (myRodsArgs->verbose == True) {
+	if (myRodsArgs->verbose == True && l1descHwm != NULL && 
+	  l3descHwm != NULL) {
+	    printf ("   %6s %s#%s  %s#%s  %s  %s  %s  %s/%s\n",
+	      pidVal, clientNameVal, clientZoneVal, proxyNameVal, proxyZoneVal,
+	      uptimeStr, progNameVal, remoteAddrVal,
+	      l1descHwm->value + l1descHwm->len * i,
+	      l3descHwm->value + l3descHwm->len * i);
+	} else if (myRodsArgs->verbose == True) {
 	    printf ("   %6s %s#%s  %s#%s  %s  %s  %s\n",
 	      pidVal, clientNameVal, clientZoneVal, proxyNameVal, proxyZoneVal,
 	      uptimeStr, progNameVal, remoteAddrVal);
@@ -280,7 +292,8 @@ usage () {
 "   - the 'from' address of the connection",
 " ",
 "If the -v option is specified, the proxy user of the connection is added",
-"following the client user.",
+"following the client user, and the maximum number of L1 and L3 descriptors",
+"the agent has had open is added at the end (as L1/L3).",
 " ",
 "Options are:",
 " ",
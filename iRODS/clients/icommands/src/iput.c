@@ -22,7 +22,7 @@ main(int argc, char **argv) {
     int reconnFlag;
     
 
-    optStr = "abD:fhIkKn:N:p:Prt:R:QTvVX:Z";
+    optStr = "abD:fhIj:kKn:N:p:Prt:R:QTvVX:Z";
    
     status = parseCmdLineOpt (argc, argv, optStr, 1, &myRodsArgs);
 
@@ -94,6 +94,7 @@ usage ()
    char *msgs[]={
 "Usage : iput [-abfIkKPQrtTUvV] [-D dataType] [-N numThreads] [-n replNum]",
 "             [-p physicalPath] [-R resource] [-X restartFile] [--link]", 
+"             [-j numConn]",
 "             [--lfrestart lfRestartFile] [--retries count] [--wlock]",
 "             [--purgec]",
 "               localSrcFile|localSrcDir ...  destDataObj|destColl",
@@ -162,6 +163,15 @@ usage ()
 "The bulk option does work for mounted collections which may represent the",
 "quickest way to upload a large number of small files.",
 " ",
+"The -j option uploads a directory with a pool of numConn connections",
+"(default 4, max 16). The directory is walked while the files are being",
+"sent. Files larger than 32 Mbytes are sent one per connection, each with",
+"its own parallel transfer. The smaller files of a collection are handed",
+"to a connection in batches of up to 50, which are bulk uploaded if the",
+"-b option is also used. With -v, the throughput of each file and of",
+"the whole upload is shown. The -X option works with -j. The -I option",
+"is not used with -j.",
+" ",
 "Options are:",
 " -a  all - update all existing copies",
 " -b  bulk upload to reduce overhead",
@@ -169,6 +179,7 @@ usage ()
 " -f  force - write data-object even it exists already; overwrite it",
 " -I  redirect connection - redirect the connection to connect directly",
 "       to the resource server.",
+" -j  numConn - upload a directory with a pool of numConn connections",
 " -k  checksum - calculate a checksum on the data",
 " -K  verify checksum - calculate and verify the checksum on the data",
 " --link - ignore symlink.",
@@ -142,6 +142,41 @@ printBasicGenQueryOut(genQueryOut_t *genQueryOut, char *format) {
    }
 }
 
+/*
+ Run the query with rcGenQueryStreamOpen, so that the rows are sent
+ without a round trip per page, and show them a page at a time.
+ */
+int
+queryAndShowStream(rcComm_t *conn, char *hint, char *format,
+		   genQueryInp_t *genQueryInp, int noPageFlag)
+{
+  genQueryStream_t *genQueryStream = NULL;
+  genQueryOut_t *genQueryOut = NULL;
+  int i;
+
+  i = rcGenQueryStreamOpen (conn, genQueryInp, &genQueryStream);
+  if (i < 0)
+    return(i);
+
+  while ((i = rcGenQueryStreamNextPage (genQueryStream, MAX_SQL_ROWS,
+	 &genQueryOut)) >= 0) {
+     i = printGenQueryOut(stdout, format, hint, genQueryOut);
+     if (i == 0 && genQueryOut->continueInx > 0 && noPageFlag==0) {
+	char inbuf[100];
+	printf("Continue? [Y/n]");
+	fgets(inbuf, 90, stdin);
+	if (strncmp(inbuf, "n", 1)==0) i = 1;
+     }
+     freeGenQueryOut (&genQueryOut);
+     if (i != 0) break;
+  }
+  rcGenQueryStreamClose (genQueryStream);
+
+  if (i < 0 && i != CAT_NO_ROWS_FOUND)
+    return(i);
+  return(0);
+}
+
 int
 queryAndShowStrCond(rcComm_t *conn, char *hint, char *format, 
 		    char *selectConditionString, int noDistinctFlag,
@@ -175,6 +210,11 @@ queryAndShowStrCond(rcComm_t *conn, char *hint, char *format,
 
   genQueryInp.maxRows= MAX_SQL_ROWS;
   genQueryInp.continueInx=0;
+  i = queryAndShowStream(conn, hint, format, &genQueryInp, noPageFlag);
+  if (i != SYS_UNMATCHED_API_NUM)
+    return(i);
+
+  /* an older server. page through the rows */
   i = rcGenQuery (conn, &genQueryInp, &genQueryOut);
   if (i < 0)
     return(i);
@@ -24,7 +24,7 @@ main(int argc, char **argv) {
     int i;
     
 
-    optStr = "ahKlN:rR:svVZ";
+    optStr = "ahj:KlN:rR:svVZ";
    
     status = parseCmdLineOpt (argc, argv, optStr, 1, &myRodsArgs);
 
@@ -122,6 +122,7 @@ usage ()
 {
    char *msgs[]={
 "Usage : irsync [-rahKsvV] [-N numThreads] [-R resource] [--link] [--age age_in_minutes]",
+"          [--manifest [-j numConn] [--chksumcache file]]",
 "          sourceFile|sourceDirectory [....] targetFile|targetDirectory",
 " ",
 "Synchronize the data between a  local  copy  (local file  system)  and",
@@ -198,6 +199,16 @@ usage ()
 "      synchronization.",
 " --age age_in_minutes - The maximum age of the source copy in minutes for sync.",
 "      i.e., age larger than age_in_minutes will not be synced.",
+" --manifest - for a local directory to collection sync, get the size and",
+"      checksum of everything in the target collection with a few queries",
+"      and compare them with a walk of the local directory, instead of",
+"      checking each file with the server. Only the files that differ are",
+"      checksummed or sent, over several connections.",
+" -j  numConn - the number of connections used with --manifest. Default is 4",
+"      and the maximum is 16.",
+" --chksumcache file - keep the checksums of the local files in this file",
+"      with --manifest. A checksum is reused while the inode, size and",
+"      modify time of the file are unchanged.",
 " --hash md5|sha256 - use the specified file hash type (checksum) instead of",
 ""};
    char *msgs2[]={
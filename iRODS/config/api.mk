@@ -123,6 +123,9 @@ LIB_API_OBJS += $(libApiObjDir)/rcChkNVPathPerm.o
 SVR_API_OBJS += $(svrApiObjDir)/rsGenQuery.o
 LIB_API_OBJS += $(libApiObjDir)/rcGenQuery.o
 
+SVR_API_OBJS += $(svrApiObjDir)/rsGenQueryStream.o
+LIB_API_OBJS += $(libApiObjDir)/rcGenQueryStream.o
+
 SVR_API_OBJS += $(svrApiObjDir)/rsAuthRequest.o
 LIB_API_OBJS += $(libApiObjDir)/rcAuthRequest.o
 
@@ -153,6 +156,9 @@ LIB_API_OBJS += $(libApiObjDir)/rcModDataObjMeta.o
 SVR_API_OBJS += $(svrApiObjDir)/rsModAVUMetadata.o
 LIB_API_OBJS += $(libApiObjDir)/rcModAVUMetadata.o
 
+SVR_API_OBJS += $(svrApiObjDir)/rsBulkAVUMetadata.o
+LIB_API_OBJS += $(libApiObjDir)/rcBulkAVUMetadata.o
+
 SVR_API_OBJS += $(svrApiObjDir)/rsFileRename.o
 LIB_API_OBJS += $(libApiObjDir)/rcFileRename.o
 
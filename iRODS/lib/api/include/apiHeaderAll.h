@@ -47,6 +47,7 @@
 #include "fileChksum.h"
 #include "chkNVPathPerm.h"
 #include "genQuery.h"
+#include "genQueryStream.h"
 #include "authRequest.h"
 #include "authResponse.h"
 #include "authCheck.h"
@@ -57,6 +58,7 @@
 #include "regReplica.h"
 #include "modDataObjMeta.h"
 #include "modAVUMetadata.h"
+#include "bulkAVUMetadata.h"
 #include "fileRename.h"
 #include "modAccessControl.h"
 #include "ruleExecSubmit.h"
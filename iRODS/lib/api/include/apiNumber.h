@@ -154,6 +154,8 @@
 #define GET_TEMP_PASSWORD_FOR_OTHER_AN		724
 #define PAM_AUTH_REQUEST_AN 			725
 #define GET_LIMITED_PASSWORD_AN			726
+#define BULK_AVU_METADATA_AN			727
+#define GEN_QUERY_STREAM_AN			728
 
 #define EXEC_CMD241_AN 			634
 #ifdef COMPAT_201
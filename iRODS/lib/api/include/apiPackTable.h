@@ -66,6 +66,7 @@ packInstructArray_t ApiPackTable[] = {
         {"authCheckOut_PI", authCheckOut_PI},
 	{"modAccessControlInp_PI", modAccessControlInp_PI},
         {"ModAVUMetadataInp_PI", ModAVUMetadataInp_PI},
+        {"BulkAVUMetadataInp_PI", BulkAVUMetadataInp_PI},
         {"RULE_EXEC_MOD_INP_PI", RULE_EXEC_MOD_INP_PI},
         {"RULE_EXEC_DEL_INP_PI", RULE_EXEC_DEL_INP_PI},
         {"RULE_EXEC_SUBMIT_INP_PI", RULE_EXEC_SUBMIT_INP_PI},
@@ -140,6 +140,13 @@ apidef_t RcApiTable[] = {
       REMOTE_USER_AUTH, REMOTE_USER_AUTH,
 #endif
       "GenQueryInp_PI", 0, "GenQueryOut_PI", 0, (funcPtr) RS_GEN_QUERY},
+    {GEN_QUERY_STREAM_AN, RODS_API_VERSION,
+#ifdef STORAGE_ADMIN_ROLE
+      REMOTE_USER_AUTH|STORAGE_ADMIN_USER, REMOTE_USER_AUTH|STORAGE_ADMIN_USER,
+#else
+      REMOTE_USER_AUTH, REMOTE_USER_AUTH,
+#endif
+      "GenQueryInp_PI", 0, NULL, 1, (funcPtr) RS_GEN_QUERY_STREAM},
     {AUTH_REQUEST_AN, RODS_API_VERSION, NO_USER_AUTH|XMSG_SVR_ALSO, 
       NO_USER_AUTH|XMSG_SVR_ALSO,
       NULL, 0,  "authRequestOut_PI", 0, (funcPtr) RS_AUTH_REQUEST},
@@ -214,6 +221,8 @@ apidef_t RcApiTable[] = {
 #endif
     {MOD_AVU_METADATA_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
       "ModAVUMetadataInp_PI", 0, NULL, 0, (funcPtr) RS_MOD_AVU_METADATA},
+    {BULK_AVU_METADATA_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
+      "BulkAVUMetadataInp_PI", 0, NULL, 0, (funcPtr) RS_BULK_AVU_METADATA},
     {MOD_ACCESS_CONTROL_AN, RODS_API_VERSION, REMOTE_USER_AUTH, REMOTE_USER_AUTH, 
       "modAccessControlInp_PI", 0, NULL, 0, (funcPtr) RS_MOD_ACCESS_CONTROL},
     {RULE_EXEC_MOD_AN, RODS_API_VERSION, LOCAL_PRIV_USER_AUTH, LOCAL_PRIV_USER_AUTH, 
@@ -0,0 +1,97 @@
+/**
+ * @file  bulkAVUMetadata.h
+ *
+ */
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* bulkAVUMetadata.h  */
+
+#ifndef BULK_AVU_METADATA_H
+#define BULK_AVU_METADATA_H
+
+/* This is a metadata type API call */
+
+/* 
+   This call adds and removes many Attribute-Value-Units (AVU)
+   metadata items, on any number of objects, in one call and one
+   catalog transaction.  It is much faster than a modAVUMetadata
+   call per AVU when loading the metadata of many files.  The imeta
+   batch command uses it.
+*/
+
+#include "rods.h"
+#include "rcMisc.h"
+#include "procApiRequest.h"
+#include "apiNumber.h"
+#include "initServer.h"
+
+#define MAX_BULK_AVU_OPS	10000	/* per call */
+
+/* options of bulkAVUMetadataInp_t */
+#define BULK_AVU_ADMIN_MODE	0x1	/* like imeta adda; admin only */
+
+/**
+ * \var bulkAVUMetadataInp_t
+ * \brief Input struct for bulkAVUMetadata operations.  
+ * \since 3.3.1
+ *
+ * \remark none
+ *
+ * \note calls chlBulkAVUMetadata
+ * \li int numOps - the number of operations (at most MAX_BULK_AVU_OPS)
+ * \li int options - BULK_AVU_ADMIN_MODE or 0
+ * \li char **op - add or rm
+ * \li char **objType - -d, -C, -R, -u or -G, as for imeta
+ * \li char **objName - the object name
+ * \li char **attribute - the attribute name
+ * \li char **value - the attribute value
+ * \li char **units - the units, may be empty
+ *
+ * \sa none
+ * \bug  no known bugs
+ */
+typedef struct {
+   int numOps;
+   int options;
+   char **op;
+   char **objType;
+   char **objName;
+   char **attribute;
+   char **value;
+   char **units;
+} bulkAVUMetadataInp_t;
+    
+#define BulkAVUMetadataInp_PI "int numOps; int options; str *op[numOps]; str *objType[numOps]; str *objName[numOps]; str *attribute[numOps]; str *value[numOps]; str *units[numOps];"
+
+#if defined(RODS_SERVER)
+#define RS_BULK_AVU_METADATA rsBulkAVUMetadata
+/* prototype for the server handler */
+int
+rsBulkAVUMetadata (rsComm_t *rsComm, bulkAVUMetadataInp_t *bulkAVUMetadataInp);
+
+int
+_rsBulkAVUMetadata (rsComm_t *rsComm, bulkAVUMetadataInp_t *bulkAVUMetadataInp);
+#else
+#define RS_BULK_AVU_METADATA NULL
+#endif
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/* prototype for the client call */
+int
+rcBulkAVUMetadata (rcComm_t *conn, bulkAVUMetadataInp_t *bulkAVUMetadataInp);
+
+int
+addBulkAVUMetadataOp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, char *op,
+char *objType, char *objName, char *attribute, char *value, char *units);
+
+int
+clearBulkAVUMetadataInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* BULK_AVU_METADATA_H */
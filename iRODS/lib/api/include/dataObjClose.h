@@ -42,6 +42,8 @@ int
 l3Stat (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, rodsStat_t **myStat);
 int
 procChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr);
+int
+chksumKwWithNoValue (int l1descInx);
 #else
 #define RS_DATA_OBJ_CLOSE NULL
 #endif
@@ -15,6 +15,7 @@
 #include "initServer.h"
 #include "dataObjWrite.h"
 #include "dataObjClose.h"
+#include "md5Checksum.h"
 
 #if defined(RODS_SERVER)
 #define RS_DATA_OBJ_GET rsDataObjGet
@@ -64,6 +65,9 @@ rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath);
 int
 _rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp,
 portalOprOut_t **portalOprOut, bytesBuf_t *dataObjOutBBuf);
+inlineChksum_t *
+startInlineChksumOfGet (rcComm_t *conn, dataObjInp_t *dataObjInp,
+portalOprOut_t *portalOprOut, rodsLong_t includedLen);
 
 #ifdef  __cplusplus
 }
@@ -225,6 +225,9 @@ typedef struct PortalOpr {
     int oprType;
     dataOprInp_t dataOprInp;
     portList_t portList;
+    int adaptiveFlag;	/* numThreads and window from the transfer history */
+    int rttUsec;	/* rtt of the client connection at setup */
+    struct InlineChksum *inlineChksum;	/* chksum the put data into this */
 } portalOpr_t;
 
 /* definition for flags */
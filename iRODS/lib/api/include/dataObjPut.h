@@ -15,6 +15,7 @@
 #include "initServer.h"
 #include "dataObjWrite.h"
 #include "dataObjClose.h"
+#include "md5Checksum.h"
 
 #if defined(RODS_SERVER)
 #define RS_DATA_OBJ_PUT rsDataObjPut
@@ -72,6 +73,13 @@ char *locFilePath);
 int
 _rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp,
 bytesBuf_t *dataObjInpBBuf, portalOprOut_t **portalOprOut);
+char *
+getInlineChksumFlag (keyValPair_t *condInput);
+int
+chksumBBuf (bytesBuf_t *myBBuf, char *chksumFlag, keyValPair_t *condInput);
+int
+chkInlineChksumOfPut (rcComm_t *conn, dataObjInp_t *dataObjInp,
+char *locFilePath, inlineChksum_t *inlineChksum);
 #ifdef  __cplusplus
 }
 #endif
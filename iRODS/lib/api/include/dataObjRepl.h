@@ -17,6 +17,24 @@
 #include "dataObjClose.h"
 #include "dataCopy.h"
 
+/* The values of REPL_FAN_OUT_KW. When ALL_KW replicates a large object to
+ * more than one resource, the src is read once and each block is written
+ * to all the dests (fan-out). */
+#define REPL_FAN_OUT_CONTINUE	"continue"	/* default. a failed dest is
+						 * dropped, the rest go on */
+#define REPL_FAN_OUT_ABORT	"abort"		/* a failed dest fails all */
+#define REPL_FAN_OUT_OFF	"off"		/* one dest at a time */
+#define MAX_REPL_FAN_OUT	16		/* max dests of one fan-out */
+
+/* one dest of a fan-out copy */
+typedef struct {
+    int l1descInx;		/* opened by dataObjOpenForRepl */
+    int status;			/* < 0 once the dest has failed */
+    int hostInx;		/* the dests on a host share its conn and
+				 * are written in turn by one thread */
+    dataObjInfo_t *destDataObjInfo;	/* the copy updated. NULL if new */
+} replFanOutDest_t;
+
 #if defined(RODS_SERVER)
 #define RS_DATA_OBJ_REPL250 rsDataObjRepl250
 #define RS_DATA_OBJ_REPL rsDataObjRepl
@@ -55,6 +73,23 @@ dataObjOpenForRepl (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
 dataObjInfo_t *srcDataObjInfo, rescInfo_t *destRescInfo, 
 char *rescGroupName, dataObjInfo_t *destDataObjInfo, int updateFlag);
 int
+chkReplFanOut (dataObjInp_t *dataObjInp, dataObjInfo_t *srcDataObjInfoHead,
+rescGrpInfo_t *destRescGrpInfo, dataObjInfo_t *destDataObjInfoHead);
+int
+_rsDataObjReplFanOut (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+dataObjInfo_t *srcDataObjInfo, rescGrpInfo_t *destRescGrpInfo,
+dataObjInfo_t *destDataObjInfoHead, transferStat_t *transStat,
+dataObjInfo_t *outDataObjInfo);
+dataObjInfo_t *
+nextFanOutSrc (dataObjInfo_t *srcDataObjInfo);
+int
+regFanOutCopy (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+dataObjInfo_t *srcDataObjInfo, dataObjInfo_t *destDataObjInfo,
+int updateFlag);
+int
+l3DataCopyFanOut (rsComm_t *rsComm, replFanOutDest_t *fanOutDest,
+int numDest, int abortFlag);
+int
 dataObjCopy (rsComm_t *rsComm, int l1descInx);
 int
 l3DataCopySingleBuf (rsComm_t *rsComm, int l1descInx);
@@ -20,7 +20,7 @@ typedef struct FileChksumInp {
     fileDriverType_t fileType;
     rodsHostAddr_t addr;
     char fileName[MAX_NAME_LEN];
-    int flag;	/* not used for now */
+    int flag;	/* > 1 - the composite chksum of flag segments */
 } fileChksumInp_t;
     
 #define fileChksumInp_PI "int fileType; struct RHostAddr_PI; str fileName[MAX_NAME_LEN]; int flags;"
@@ -41,6 +41,9 @@ remoteFileChksum (rsComm_t *rsComm, fileChksumInp_t *fileChksumInp,
 char **chksumStr, rodsServerHost_t *rodsServerHost);
 int
 fileChksum (int fileType, rsComm_t *rsComm, char *fileName, char *chksumStr, int use_sha256);
+int
+fileCompositeChksum (int fileType, rsComm_t *rsComm, char *fileName,
+int numSeg, char *chksumStr);
 #else
 #define RS_FILE_CHKSUM NULL
 #endif
@@ -29,6 +29,8 @@ genQueryOut_t **genQueryOut);
 int
 _rsGenQuery (rsComm_t *rsComm, genQueryInp_t *genQueryInp,
 genQueryOut_t **genQueryOut);
+int
+resetGenQueryAclPolicy ();
 #else
 #define RS_GEN_QUERY NULL
 #endif
@@ -0,0 +1,111 @@
+/**
+ * @file  genQueryStream.h
+ *
+ */
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* genQueryStream.h
+   Streamed General Query
+ */
+
+#ifndef GEN_QUERY_STREAM_H
+#define GEN_QUERY_STREAM_H
+
+/* This is a metadata type API call */
+
+/*
+   This call runs a general query and streams all of its rows back,
+   instead of returning MAX_SQL_ROWS rows per call and waiting for
+   a continueInx call for the next page.  The server sends the rows
+   in batches of about GEN_QUERY_STREAM_BATCH_SZ bytes, up to
+   GEN_QUERY_STREAM_WINDOW batches ahead of the client, until the
+   query is done or the client cancels it.  In a batch, each value is
+   its length (7 bits per byte, low bits first, high bit set if more
+   bytes follow) followed by the value and a NULL, instead of being
+   padded to the longest value of the column.  A batch starts with the
+   row count, the attriCnt, the totalRowCount and the attriInx of the
+   columns, as ints in network byte order (see appendGenQueryBatch).
+
+   The client reads the rows with rcGenQueryStreamNextRow or a page at
+   a time with rcGenQueryStreamNextPage.  No other call can be made on
+   the connection until the stream is read to the end or closed with
+   rcGenQueryStreamClose.
+*/
+
+#include "rods.h"
+#include "rcMisc.h"
+#include "procApiRequest.h"
+#include "apiNumber.h"
+#include "initServer.h"
+#include "icatDefines.h"
+
+#define GEN_QUERY_STREAM_BATCH_SZ	(256*1024) /* send a batch at this size */
+#define GEN_QUERY_STREAM_WINDOW		4	/* batches sent ahead of the acks */
+
+/**
+ * \var genQueryStream_t
+ * \brief The client side handle of a streamed general query.
+ * \since 3.3.1
+ *
+ * \remark none
+ *
+ * \note Elements of genQueryStream_t:
+ * \li int status - SYS_SVR_TO_CLI_GEN_QUERY_BATCH while more batches
+ *        are to come, then the status of the query
+ * \li int attriCnt, attriInx - the columns
+ * \li int totalRowCount - as in genQueryOut_t
+ * \li int rowCnt - the number of rows read so far
+ * \li char *value[], int valueLen[] - the values of the current row. They
+ *        point into the current batch and are valid until the next call
+ *
+ * \sa none
+ * \bug  no known bugs
+ */
+typedef struct GenQueryStream {
+    rcComm_t *conn;
+    int status;
+    int cancelled;
+    int attriCnt;
+    int attriInx[MAX_SQL_ATTR];
+    int totalRowCount;
+    int rowCnt;
+    bytesBuf_t batch;		/* the current batch */
+    char *nextRow;		/* in batch */
+    int batchRowsLeft;
+    char *value[MAX_SQL_ATTR];	/* the current row */
+    int valueLen[MAX_SQL_ATTR];
+} genQueryStream_t;
+
+#if defined(RODS_SERVER)
+#define RS_GEN_QUERY_STREAM rsGenQueryStream
+/* prototype for the server handler */
+int
+rsGenQueryStream (rsComm_t *rsComm, genQueryInp_t *genQueryInp,
+bytesBuf_t *genQueryBatchBBuf);
+#else
+#define RS_GEN_QUERY_STREAM NULL
+#endif
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/* prototype for the client call */
+int
+rcGenQueryStreamOpen (rcComm_t *conn, genQueryInp_t *genQueryInp,
+genQueryStream_t **genQueryStream);
+int
+rcGenQueryStreamNextRow (genQueryStream_t *genQueryStream);
+int
+rcGenQueryStreamNextPage (genQueryStream_t *genQueryStream, int maxRows,
+genQueryOut_t **genQueryOut);
+int
+rcGenQueryStreamClose (genQueryStream_t *genQueryStream);
+int
+_rcGenQueryStreamRead (genQueryStream_t *genQueryStream);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* GEN_QUERY_STREAM_H */
@@ -28,6 +28,8 @@
 #define REMOTE_ADDR_INX         1000007
 #define PROG_NAME_INX           1000008
 #define SERVER_ADDR_INX         1000009
+#define L1DESC_HWM_INX          1000010
+#define L3DESC_HWM_INX          1000011
 
 /**
  * \var procStatInp_t
@@ -58,6 +60,7 @@ typedef struct ProcStatInp {
 #define ProcStatInp_PI "str addr[LONG_NAME_LEN];str rodsZone[NAME_LEN];struct KeyValPair_PI;"
 
 #define MAX_PROC_STAT_CNT	2000
+#define PROC_STAT_ATTRI_CNT	11	/* PID_INX thru L3DESC_HWM_INX */
 
 #if defined(RODS_SERVER)
 #define RS_PROC_STAT rsProcStat
@@ -81,6 +84,8 @@ int
 initProcStatOut (genQueryOut_t **procStatOut, int numProc);
 int
 addProcToProcStatOut (procLog_t *procLog, genQueryOut_t *procStatOut);
+int
+normProcStatOut (genQueryOut_t **procStatOut);
 #else
 #define RS_PROC_STAT NULL
 #endif
@@ -109,7 +114,7 @@ extern "C" {
  *	     fedration.  
  * Output - 
  *   genQueryOut_t **procStatOut
- *	The procStatOut contains 9 attributes and value arrays with the
+ *	The procStatOut contains 11 attributes and value arrays with the
  *      attriInx defined above. i.e.:
  * 		PID_INX - pid of the agent process
  *		STARTTIME_INX - The connection start time in secs since Epoch.
@@ -120,6 +125,8 @@ extern "C" {
  *		REMOTE_ADDR_INX - the from address of the connection
  *		SERVER_ADDR_INX - the server address of the connection
  * 		PROG_NAME_INX - the client program name
+ * 		L1DESC_HWM_INX - max number of L1 descriptors the agent had open
+ * 		L3DESC_HWM_INX - max number of L3 descriptors the agent had open
  *
  *	A row will be given for each running irods agent. If a server is 
  *	completely idle, one row will still be given with all the attribute
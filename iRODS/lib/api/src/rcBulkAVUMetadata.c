@@ -0,0 +1,68 @@
+/**
+ * @file  rcBulkAVUMetadata.c
+ *
+ */
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* See bulkAVUMetadata.h for a description of this API call.*/
+
+
+/**
+ * \fn rcBulkAVUMetadata (rcComm_t *conn, bulkAVUMetadataInp_t *bulkAVUMetadataInp)
+ *
+ * \brief Add and remove many Attribute-Value-Unit metadata items, on
+ * \n     any number of objects, in one call.
+ *
+ * \user clients, in the 'C' code this is used by 'imeta batch'
+ *
+ * \category metadata operations
+ *
+ * \since 3.3.1
+ *
+ * \remark none
+ *
+ * \note The operations are done in one catalog transaction; if one
+ * \n of them fails, none are done.  The removals are done before the
+ * \n additions.  Adding an AVU an object already has is not an error.
+ *
+ * \usage
+ * Add two AVUs to a data object and one to a collection:
+ * \n bulkAVUMetadataInp_t bulkAVUMetadataInp;
+ * \n memset (&bulkAVUMetadataInp, 0, sizeof (bulkAVUMetadataInp));
+ * \n addBulkAVUMetadataOp (&bulkAVUMetadataInp, "add", "-d",
+ * \n     "/tempZone/home/rods/f1", "attrName", "attrValue", "");
+ * \n addBulkAVUMetadataOp (&bulkAVUMetadataInp, "add", "-d",
+ * \n     "/tempZone/home/rods/f1", "size", "12", "MB");
+ * \n addBulkAVUMetadataOp (&bulkAVUMetadataInp, "add", "-C",
+ * \n     "/tempZone/home/rods", "project", "x", "");
+ * \n status = rcBulkAVUMetadata(conn, &bulkAVUMetadataInp);
+ * \n clearBulkAVUMetadataInp (&bulkAVUMetadataInp);
+ * \n if (status < 0) {
+ * \n .... handle the error
+ * \n }
+ *
+ * \param[in] conn - A rcComm_t connection handle to the server.
+ * \param[in] bulkAVUMetadataInp - the operations
+ * \return integer
+ * \retval the number of AVUs added (not counting those the objects
+ * \n already had) on success
+ *
+ * \sideeffect none
+ * \pre none
+ * \post none
+ * \sa rcModAVUMetadata
+ * \bug  no known bugs
+**/
+
+#include "bulkAVUMetadata.h"
+
+int
+rcBulkAVUMetadata (rcComm_t *conn, bulkAVUMetadataInp_t *bulkAVUMetadataInp)
+{
+    int status;
+    status = procApiRequest (conn, BULK_AVU_METADATA_AN, bulkAVUMetadataInp,
+			     NULL, (void **) NULL, NULL);
+
+    return (status);
+}
@@ -59,7 +59,9 @@
  *    \n REPL_NUM_KW - the replica number of the copy to open.
  *    \n FORCE_FLAG_KW - overwrite existing local copy. This keyWd has no value.
  *    \n VERIFY_CHKSUM_KW - verify the checksum value of the local file after 
- *	     the download. This keyWd has no value.
+ *	     the download. This keyWd has no value. The checksum is taken
+ *	     from the data as they arrive where it can be compared with
+ *	     the registered one, and from the local file otherwise.
  *    \n RBUDP_TRANSFER_KW - use RBUDP for data transfer. This keyWd has no
  *             value
  *    \n RBUDP_SEND_RATE_KW - the number of RBUDP packet to send per second
@@ -85,6 +87,8 @@ rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
     int status;
     portalOprOut_t *portalOprOut = NULL;
     bytesBuf_t dataObjOutBBuf;
+    inlineChksum_t *inlineChksum = NULL;
+    char chksumStr[CHKSUM_LEN];
 #ifndef windows_platform
     struct stat statbuf;
 #else
@@ -114,6 +118,12 @@ rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
         return (status);
     }
 
+    if (getValByKey (&dataObjInp->condInput, VERIFY_CHKSUM_KW) != NULL &&
+      portalOprOut != NULL && strlen (portalOprOut->chksum) > 0) {
+	inlineChksum = startInlineChksumOfGet (conn, dataObjInp, portalOprOut,
+	  status == 0 || dataObjOutBBuf.len > 0 ? dataObjOutBBuf.len : -1);
+    }
+
     if (status == 0 || dataObjOutBBuf.len > 0) {
 	/* data included */
       /**** Removed by Raja as this can cause problems when the data sizes are different - say when post processing is done....Dec 2 2010
@@ -188,11 +198,26 @@ rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
     if (status >= 0 && conn->fileRestart.info.numSeg > 0) {   /* file restart */
         clearLfRestartFile (&conn->fileRestart);
     }
+    conn->inlineChksum = NULL;
 
     if (getValByKey (&dataObjInp->condInput, VERIFY_CHKSUM_KW) != NULL) {
 	if (portalOprOut == NULL || strlen (portalOprOut->chksum) == 0) {
 	    rodsLog (LOG_ERROR, 
 	      "rcDataObjGet: VERIFY_CHKSUM_KW set but no chksum from server");
+	} else if (status >= 0 && inlineChksum != NULL &&
+	  finalInlineChksum (inlineChksum, inlineChksum->numSeg > 1 ?
+	  inlineChksum->dataSize : inlineChksum->segCtx[0].offset,
+	  chksumStr) >= 0) {
+	    free (inlineChksum);
+	    inlineChksum = NULL;
+	    if (strcmp (chksumStr, portalOprOut->chksum) != 0) {
+		status = USER_CHKSUM_MISMATCH;
+	        rodsLogError (LOG_ERROR, status,
+                  "rcDataObjGet: chksum mismatch error for %s, status = %d",
+                  locFilePath, status);
+		free (portalOprOut);
+                return (status);
+	    }
 	} else {
             status = verifyChksumLocFile (locFilePath, portalOprOut->chksum, NULL);
 
@@ -214,6 +239,7 @@ rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
  
 	}
     }
+    if (inlineChksum != NULL) free (inlineChksum);
     if (portalOprOut != NULL) {
         free (portalOprOut);
     }
@@ -221,6 +247,43 @@ rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
     return (status);
 }
 
+/* startInlineChksumOfGet - set up conn->inlineChksum so the data of the
+ * get are chksummed as they arrive, if the result can be compared with the
+ * registered chksum in portalOprOut. includedLen is the length of the
+ * data that came with the reply, or -1 if they come through a portal or
+ * rcDataObjRead. Returns the inlineChksum_t or NULL.
+ */
+inlineChksum_t *
+startInlineChksumOfGet (rcComm_t *conn, dataObjInp_t *dataObjInp,
+portalOprOut_t *portalOprOut, rodsLong_t includedLen)
+{
+    inlineChksum_t *inlineChksum;
+    int numSeg = 1;
+    int use_sha256;
+    rodsLong_t dataSize = includedLen;
+
+    if ((use_sha256 = extractHashFunction2 (portalOprOut->chksum)) < 0)
+        return (NULL);
+    if (includedLen < 0) {
+        if (getUdpPortFromPortList (&portalOprOut->portList) != 0)
+            return (NULL);
+        if (portalOprOut->numThreads > 1) {
+            /* the composite needs the exact size */
+            if (dataObjInp->dataSize <= 0) return (NULL);
+            numSeg = portalOprOut->numThreads;
+        }
+        dataSize = dataObjInp->dataSize;
+    }
+    inlineChksum = (inlineChksum_t *) malloc (sizeof (inlineChksum_t));
+    if (initInlineChksum (inlineChksum, numSeg, dataSize, use_sha256) < 0 ||
+      matchInlineChksum (inlineChksum, portalOprOut->chksum) == 0) {
+        free (inlineChksum);
+        return (NULL);
+    }
+    conn->inlineChksum = inlineChksum;
+    return (inlineChksum);
+}
+
 int
 _rcDataObjGet (rcComm_t *conn, dataObjInp_t *dataObjInp, 
 portalOprOut_t **portalOprOut, bytesBuf_t *dataObjOutBBuf)
@@ -11,6 +11,8 @@
 #include "dataObjPut.h"
 #include "rcPortalOpr.h"
 #include "oprComplete.h"
+#include "dataObjChksum.h"
+#include "md5Checksum.h"
 
 /**
  * \fn rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, 
@@ -70,9 +72,11 @@
  *            of the copy to overwrite.
  *    \n REG_CHKSUM_KW -  register the target checksum value after the copy.
  *            The value is the md5 checksum value of the local file.
+ *            If the value is empty, the checksum is taken from the data
+ *            as they are sent and is checked against the registered one.
  *    \n VERIFY_CHKSUM_KW - verify and register the target checksum value
  *            after the copy. The value is the md5 checksum value of the 
- *	      local file.
+ *	      local file. An empty value works as for REG_CHKSUM_KW.
  *    \n RBUDP_TRANSFER_KW - use RBUDP for data transfer. This keyWd has no
  *             value.
  *    \n RBUDP_SEND_RATE_KW - the number of RBUDP packet to send per second
@@ -98,6 +102,8 @@ rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
     int status;
     portalOprOut_t *portalOprOut = NULL;
     bytesBuf_t dataObjInpBBuf;
+    char *chksumFlag;
+    inlineChksum_t *inlineChksum = NULL;
 
     if (dataObjInp->dataSize <= 0) {
 	dataObjInp->dataSize = getFileSize (locFilePath);
@@ -109,6 +115,9 @@ rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
     memset (&conn->transStat, 0, sizeof (transStat_t));
     memset (&dataObjInpBBuf, 0, sizeof (dataObjInpBBuf));
 
+    /* a chksum keyword with no value - chksum the data on the way */
+    chksumFlag = getInlineChksumFlag (&dataObjInp->condInput);
+
     if (getValByKey (&dataObjInp->condInput, DATA_INCLUDED_KW) != NULL) {
 	if (dataObjInp->dataSize > MAX_SZ_FOR_SINGLE_BUF) {
 	    rmKeyVal (&dataObjInp->condInput, DATA_INCLUDED_KW);
@@ -131,6 +140,17 @@ rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
             return (status);
 	}
     }
+    if (chksumFlag != NULL && dataObjInpBBuf.buf != NULL) {
+	/* the whole file is in the buffer. chksum it there and send the
+	 * value along as before */
+	status = chksumBBuf (&dataObjInpBBuf, chksumFlag, 
+	  &dataObjInp->condInput);
+	if (status < 0) {
+	    clearBBuf (&dataObjInpBBuf);
+	    return (status);
+	}
+	chksumFlag = NULL;
+    }
     
     dataObjInp->oprType = PUT_OPR;
 
@@ -149,6 +169,16 @@ rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
 	return (status);
     }
 
+    if (chksumFlag != NULL && getUdpPortFromPortList 
+      (&portalOprOut->portList) == 0) {
+	inlineChksum = (inlineChksum_t *) malloc (sizeof (inlineChksum_t));
+	if (initInlineChksum (inlineChksum, portalOprOut->numThreads > 1 ?
+	  portalOprOut->numThreads : 1, dataObjInp->dataSize, 
+	  extractHashFunction (&dataObjInp->condInput)) >= 0) {
+	    conn->inlineChksum = inlineChksum;
+	}
+    }
+
     if (portalOprOut->numThreads <= 0) { 
 	status = putFile (conn, portalOprOut->l1descInx, 
 	  locFilePath, dataObjInp->objPath, dataObjInp->dataSize);
@@ -191,6 +221,8 @@ rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
 	  dataObjInp->objPath, dataObjInp->dataSize);
     }
 
+    conn->inlineChksum = NULL;
+
     /* just send a complete msg */
     if (status < 0) {
 	rcOprComplete (conn, status);
@@ -199,6 +231,12 @@ rcDataObjPut (rcComm_t *conn, dataObjInp_t *dataObjInp, char *locFilePath)
     }
     free (portalOprOut);
 
+    if (status >= 0 && chksumFlag != NULL) {
+	status = chkInlineChksumOfPut (conn, dataObjInp, locFilePath,
+	  inlineChksum);
+    }
+    if (inlineChksum != NULL) free (inlineChksum);
+
     if (status >= 0 && conn->fileRestart.info.numSeg > 0) {   /* file restart */
         clearLfRestartFile (&conn->fileRestart);
     }
@@ -221,3 +259,85 @@ bytesBuf_t *dataObjInpBBuf, portalOprOut_t **portalOprOut)
     return status;
 }
 
+
+/* getInlineChksumFlag - returns the chksum keyword in condInput if it has
+ * no value, i.e. the chksum is to be taken from the data as they are
+ * sent. Otherwise returns NULL. */
+char *
+getInlineChksumFlag (keyValPair_t *condInput)
+{
+    char *tmpStr;
+
+    if ((tmpStr = getValByKey (condInput, VERIFY_CHKSUM_KW)) != NULL) {
+        return (strlen (tmpStr) == 0 ? VERIFY_CHKSUM_KW : NULL);
+    }
+    if ((tmpStr = getValByKey (condInput, REG_CHKSUM_KW)) != NULL) {
+        return (strlen (tmpStr) == 0 ? REG_CHKSUM_KW : NULL);
+    }
+    return (NULL);
+}
+
+/* chksumBBuf - chksum the data in myBBuf and put the value in condInput
+ * with the keyword chksumFlag */
+int
+chksumBBuf (bytesBuf_t *myBBuf, char *chksumFlag, keyValPair_t *condInput)
+{
+    inlineChksum_t inlineChksum;
+    char chksumStr[CHKSUM_LEN];
+    int status;
+
+    status = initInlineChksum (&inlineChksum, 1, myBBuf->len,
+      extractHashFunction (condInput));
+    if (status < 0) return (status);
+    updateInlineChksum (&inlineChksum, 0, (unsigned char *) myBBuf->buf,
+      myBBuf->len);
+    status = finalInlineChksum (&inlineChksum, myBBuf->len, chksumStr);
+    if (status < 0) return (status);
+    addKeyVal (condInput, chksumFlag, chksumStr);
+    return (0);
+}
+
+/* chkInlineChksumOfPut - check the chksum registered for the uploaded
+ * object against the one taken while sending it. If the two can't be
+ * compared (e.g. the transfer restarted, or the server did the chksum its
+ * own way), the local file is read again to verify. */
+int
+chkInlineChksumOfPut (rcComm_t *conn, dataObjInp_t *dataObjInp,
+char *locFilePath, inlineChksum_t *inlineChksum)
+{
+    dataObjInp_t chksumInp;
+    char *regChksum = NULL;
+    char myChksum[CHKSUM_LEN];
+    char *tmpStr;
+    int status;
+
+    myChksum[0] = '\0';
+    memset (&chksumInp, 0, sizeof (chksumInp));
+    rstrcpy (chksumInp.objPath, dataObjInp->objPath, MAX_NAME_LEN);
+    if ((tmpStr = getValByKey (&dataObjInp->condInput, HASH_KW)) != NULL) {
+        addKeyVal (&chksumInp.condInput, HASH_KW, tmpStr);
+    }
+    /* no force. This gets what the server registered at close */
+    status = rcDataObjChksum (conn, &chksumInp, &regChksum);
+    clearKeyVal (&chksumInp.condInput);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "chkInlineChksumOfPut: rcDataObjChksum error for %s",
+          dataObjInp->objPath);
+        return (status);
+    }
+
+    if (matchInlineChksum (inlineChksum, regChksum) &&
+      finalInlineChksum (inlineChksum, dataObjInp->dataSize, myChksum) >= 0) {
+        status = strcmp (myChksum, regChksum) == 0 ? 0 : USER_CHKSUM_MISMATCH;
+    } else {
+        status = verifyChksumLocFile (locFilePath, regChksum, myChksum);
+    }
+    if (status == USER_CHKSUM_MISMATCH) {
+        rodsLogError (LOG_ERROR, status,
+          "chkInlineChksumOfPut: chksum %s of %s != registered %s for %s",
+          myChksum, locFilePath, regChksum, dataObjInp->objPath);
+    }
+    free (regChksum);
+    return (status);
+}
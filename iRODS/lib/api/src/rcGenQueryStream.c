@@ -0,0 +1,294 @@
+/**
+ * @file  rcGenQueryStream.c
+ *
+ */
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* See genQueryStream.h for a description of this API call.*/
+
+#include "genQueryStream.h"
+
+static int
+procGenQueryBatch (genQueryStream_t *genQueryStream, int status);
+static int
+chkGenQueryBatch (genQueryStream_t *genQueryStream);
+
+/**
+ * \fn rcGenQueryStreamOpen (rcComm_t *conn, genQueryInp_t *genQueryInp, genQueryStream_t **genQueryStream)
+ *
+ * \brief Start a streamed general-query.
+ *
+ * \user client
+ *
+ * \category metadata operations
+ *
+ * \since 3.3.1
+ *
+ * \remark
+ * Start a general-query whose rows are streamed back by the server:
+ * \n The query is the same as for rcGenQuery, but instead of one call
+ * \n per MAX_SQL_ROWS rows, the server sends all the rows in batches,
+ * \n without waiting for the client to ask for them.  The rows are read
+ * \n with rcGenQueryStreamNextRow or rcGenQueryStreamNextPage.
+ *
+ * \note No other call can be made on conn until the rows are read to
+ * \n the end or rcGenQueryStreamClose is called.  Servers older than
+ * \n 3.3.1 return SYS_UNMATCHED_API_NUM; use rcGenQuery with them.
+ *
+ * \usage
+ * Print the names of the data objects in a collection:
+ * \n genQueryStream_t *genQueryStream = NULL;
+ * \n addInxIval (&genQueryInp.selectInp, COL_DATA_NAME, 1);
+ * \n addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, "='/tempZone/home/rods'");
+ * \n status = rcGenQueryStreamOpen (conn, &genQueryInp, &genQueryStream);
+ * \n if (status < 0) {
+ * \n .... handle the error
+ * \n }
+ * \n while ((status = rcGenQueryStreamNextRow (genQueryStream)) >= 0) {
+ * \n     printf ("%s\n", genQueryStream->value[0]);
+ * \n }
+ * \n rcGenQueryStreamClose (genQueryStream);
+ *
+ * \param[in] conn - A rcComm_t connection handle to the server
+ * \param[in] genQueryInp - input general-query structure. maxRows and
+ * \n            continueInx are not used
+ * \param[out] genQueryStream - the handle of the stream
+ * \return integer
+ * \retval 0 on success, CAT_NO_ROWS_FOUND if the query has no rows
+ *
+ * \sideeffect none
+ * \pre none
+ * \post none
+ * \sa rcGenQuery
+ * \bug  no known bugs
+**/
+
+int
+rcGenQueryStreamOpen (rcComm_t *conn, genQueryInp_t *genQueryInp,
+genQueryStream_t **genQueryStream)
+{
+    int status;
+    genQueryStream_t *myGenQueryStream;
+
+    *genQueryStream = NULL;
+    myGenQueryStream = (genQueryStream_t *)
+      calloc (1, sizeof (genQueryStream_t));
+    if (myGenQueryStream == NULL) return (SYS_MALLOC_ERR);
+    myGenQueryStream->conn = conn;
+
+    status = procApiRequest (conn, GEN_QUERY_STREAM_AN, genQueryInp, NULL,
+      NULL, &myGenQueryStream->batch);
+
+    status = procGenQueryBatch (myGenQueryStream, status);
+    if (status >= 0 && myGenQueryStream->batchRowsLeft <= 0 &&
+      myGenQueryStream->status != SYS_SVR_TO_CLI_GEN_QUERY_BATCH) {
+	status = CAT_NO_ROWS_FOUND;
+    }
+    if (status < 0) {
+	clearBBuf (&myGenQueryStream->batch);
+	free (myGenQueryStream);
+	return (status);
+    }
+    *genQueryStream = myGenQueryStream;
+    return (0);
+}
+
+/* rcGenQueryStreamNextRow - read the next row of the stream into
+ * genQueryStream->value and valueLen. Returns CAT_NO_ROWS_FOUND at
+ * the end.
+ */
+
+int
+rcGenQueryStreamNextRow (genQueryStream_t *genQueryStream)
+{
+    int status;
+    bytesBuf_t *batch = &genQueryStream->batch;
+
+    if ((status = chkGenQueryBatch (genQueryStream)) < 0) return status;
+
+    status = getGenQueryBatchRow (&genQueryStream->nextRow,
+      (char *) batch->buf + batch->len, genQueryStream->attriCnt,
+      genQueryStream->value, genQueryStream->valueLen);
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "rcGenQueryStreamNextRow: bad row %d in the stream",
+	  genQueryStream->rowCnt);
+	genQueryStream->batchRowsLeft = 0;
+	return status;
+    }
+    genQueryStream->batchRowsLeft--;
+    genQueryStream->rowCnt++;
+    return (0);
+}
+
+/* rcGenQueryStreamNextPage - read up to maxRows rows of the stream into a
+ * genQueryOut_t, as returned by rcGenQuery, for the code that works on
+ * pages. The columns are as wide as the longest value in the page.
+ * continueInx is 1 if more rows may follow. Returns CAT_NO_ROWS_FOUND
+ * at the end.
+ */
+
+int
+rcGenQueryStreamNextPage (genQueryStream_t *genQueryStream, int maxRows,
+genQueryOut_t **genQueryOut)
+{
+    int status;
+    int i, j, rowCnt;
+    int len[MAX_SQL_ATTR];
+    char *rowPtr, *endPtr;
+    genQueryOut_t *myGenQueryOut;
+    bytesBuf_t *batch = &genQueryStream->batch;
+
+    *genQueryOut = NULL;
+    if ((status = chkGenQueryBatch (genQueryStream)) < 0) return status;
+
+    rowCnt = genQueryStream->batchRowsLeft;
+    if (maxRows > 0 && rowCnt > maxRows) rowCnt = maxRows;
+
+    /* size the columns first. A page never spans two batches */
+    rowPtr = genQueryStream->nextRow;
+    endPtr = (char *) batch->buf + batch->len;
+    for (j = 0; j < genQueryStream->attriCnt; j++) {
+	len[j] = 1;
+    }
+    for (i = 0; i < rowCnt; i++) {
+	status = getGenQueryBatchRow (&rowPtr, endPtr,
+	  genQueryStream->attriCnt, genQueryStream->value,
+	  genQueryStream->valueLen);
+	if (status < 0) {
+            rodsLog (LOG_ERROR,
+              "rcGenQueryStreamNextPage: bad row %d in the stream",
+	      genQueryStream->rowCnt + i);
+	    genQueryStream->batchRowsLeft = 0;
+	    return status;
+	}
+	for (j = 0; j < genQueryStream->attriCnt; j++) {
+	    if (genQueryStream->valueLen[j] >= len[j])
+		len[j] = genQueryStream->valueLen[j] + 1;
+	}
+    }
+
+    myGenQueryOut = (genQueryOut_t *) calloc (1, sizeof (genQueryOut_t));
+    myGenQueryOut->rowCnt = rowCnt;
+    myGenQueryOut->attriCnt = genQueryStream->attriCnt;
+    myGenQueryOut->totalRowCount = genQueryStream->totalRowCount;
+    for (j = 0; j < genQueryStream->attriCnt; j++) {
+	myGenQueryOut->sqlResult[j].attriInx = genQueryStream->attriInx[j];
+	myGenQueryOut->sqlResult[j].len = len[j];
+	myGenQueryOut->sqlResult[j].value = (char *) calloc (rowCnt, len[j]);
+    }
+    for (i = 0; i < rowCnt; i++) {
+	rcGenQueryStreamNextRow (genQueryStream);
+	for (j = 0; j < genQueryStream->attriCnt; j++) {
+	    memcpy (&myGenQueryOut->sqlResult[j].value[len[j] * i],
+	      genQueryStream->value[j], genQueryStream->valueLen[j] + 1);
+	}
+    }
+    if (genQueryStream->batchRowsLeft > 0 ||
+      genQueryStream->status == SYS_SVR_TO_CLI_GEN_QUERY_BATCH) {
+	myGenQueryOut->continueInx = 1;
+    }
+    *genQueryOut = myGenQueryOut;
+    return (0);
+}
+
+/* rcGenQueryStreamClose - cancel the query if it is not done, read
+ * the batches the server sent ahead and free the stream.
+ */
+
+int
+rcGenQueryStreamClose (genQueryStream_t *genQueryStream)
+{
+    int status = 0;
+
+    if (genQueryStream == NULL) return (0);
+
+    genQueryStream->cancelled = 1;
+    while (genQueryStream->status == SYS_SVR_TO_CLI_GEN_QUERY_BATCH) {
+	status = _rcGenQueryStreamRead (genQueryStream);
+    }
+    clearBBuf (&genQueryStream->batch);
+    free (genQueryStream);
+
+    if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+	return (status);
+    } else {
+        return (0);
+    }
+}
+
+/* _rcGenQueryStreamRead - ack the current batch and read the next one */
+
+int
+_rcGenQueryStreamRead (genQueryStream_t *genQueryStream)
+{
+    int myBuf;
+    int status;
+    rcComm_t *conn = genQueryStream->conn;
+
+    if (genQueryStream->cancelled != 0) {
+	myBuf = htonl (SYS_CLI_TO_SVR_GEN_QUERY_CANCEL);
+    } else {
+	myBuf = htonl (SYS_CLI_TO_SVR_GEN_QUERY_ACK);
+    }
+    status = myWrite (conn->sock, (void *) &myBuf, 4, SOCK_TYPE, NULL);
+    if (status < 0) {
+	genQueryStream->status = status;
+	genQueryStream->batchRowsLeft = 0;
+	return (status);
+    }
+
+    /* readMsgBody keeps the old len if the reply has no rows */
+    clearBBuf (&genQueryStream->batch);
+    status = readAndProcApiReply (conn, conn->apiInx, NULL,
+      &genQueryStream->batch);
+
+    return (procGenQueryBatch (genQueryStream, status));
+}
+
+/* procGenQueryBatch - set up the stream for the batch of a reply with
+ * the given status */
+
+static int
+procGenQueryBatch (genQueryStream_t *genQueryStream, int status)
+{
+    int hdrLen, rowCnt;
+    bytesBuf_t *batch = &genQueryStream->batch;
+
+    genQueryStream->status = status;
+    genQueryStream->batchRowsLeft = 0;
+    if (status < 0) return (status);
+    if (batch->buf == NULL || batch->len <= 0) return (0);
+
+    hdrLen = getGenQueryBatchHeader (batch, &rowCnt,
+      &genQueryStream->attriCnt, &genQueryStream->totalRowCount,
+      genQueryStream->attriInx);
+    if (hdrLen < 0) {
+	genQueryStream->status = hdrLen;
+	return (hdrLen);
+    }
+    genQueryStream->nextRow = (char *) batch->buf + hdrLen;
+    genQueryStream->batchRowsLeft = rowCnt;
+    return (0);
+}
+
+/* chkGenQueryBatch - make sure the current batch has rows left, reading
+ * the next ones if needed */
+
+static int
+chkGenQueryBatch (genQueryStream_t *genQueryStream)
+{
+    int status;
+
+    while (genQueryStream->batchRowsLeft <= 0) {
+	if (genQueryStream->status < 0) {
+	    return (genQueryStream->status);
+	} else if (genQueryStream->status != SYS_SVR_TO_CLI_GEN_QUERY_BATCH) {
+	    return (CAT_NO_ROWS_FOUND);
+	}
+	status = _rcGenQueryStreamRead (genQueryStream);
+	if (status < 0) return (status);
+    }
+    return (0);
+}
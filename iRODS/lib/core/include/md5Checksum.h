@@ -13,7 +13,35 @@
 #include "md5.h"
 #include "sha1.h"
 #include "parseCommandLine.h"
+#ifdef SHA256_FILE_HASH
+#include "sha.h"
+#endif
 #define SHA256_CHKSUM_PREFIX "sha2:"
+/* the composite chksum of a transfer done in numSeg parallel segments is
+ * COMPOSITE_CHKSUM_PREFIX numSeg:md5 where the md5 is taken over the md5
+ * digests of the segments in offset order. Segment i starts at
+ * i * (dataSize / numSeg) and the last one takes the rest, the same as
+ * the portal threads. */
+#define COMPOSITE_CHKSUM_PREFIX "md5c:"
+
+/* the running digest of the data of one stream. offset is where the next
+ * update must start. It is set to -1 once the data comes out of order
+ * and the digest is no good */
+typedef struct ChksumCtx {
+    int useSha256;
+    rodsLong_t offset;
+    MD5_CTX md5Ctx;
+#ifdef SHA256_FILE_HASH
+    SHA256_CTX sha256Ctx;
+#endif
+} chksumCtx_t;
+
+/* the digests taken while a file is transferred in numSeg segments */
+typedef struct InlineChksum {
+    int numSeg;		/* 0 means not started yet */
+    rodsLong_t dataSize;
+    chksumCtx_t segCtx[MAX_NUM_CONFIG_TRAN_THR];
+} inlineChksum_t;
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -31,6 +59,28 @@ int extractHashFunction(keyValPair_t *condInput);
 int extractHashFunction2(char *myChksum);
 int extractHashFunction3(rodsArguments_t *rodsArgs);
 int verifyHashUse(char *chksumStr);
+int
+initChksumCtx (chksumCtx_t *chksumCtx, int use_sha256, rodsLong_t offset);
+int
+updateChksumCtx (chksumCtx_t *chksumCtx, rodsLong_t offset,
+unsigned char *buf, int len);
+int
+finalChksumCtx (chksumCtx_t *chksumCtx, unsigned char *digest);
+int
+initInlineChksum (inlineChksum_t *inlineChksum, int numSeg,
+rodsLong_t dataSize, int use_sha256);
+int
+updateInlineChksum (inlineChksum_t *inlineChksum, rodsLong_t offset,
+unsigned char *buf, int len);
+int
+finalInlineChksum (inlineChksum_t *inlineChksum, rodsLong_t dataSize,
+char *chksumStr);
+int
+getCompositeNumSeg (char *chksum);
+int
+matchInlineChksum (inlineChksum_t *inlineChksum, char *chksum);
+int
+compositeChksumLocFile (char *fileName, int numSeg, char *chksumStr);
 #ifdef SHA256_FILE_HASH
 void sha256ToStr (unsigned char *hash, char chksumStr[CHKSUM_LEN]);
 #endif
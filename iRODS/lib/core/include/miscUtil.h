@@ -13,6 +13,7 @@
 #include "rodsPath.h"
 #include "parseCommandLine.h"
 #include "irodsGuiProgressCallback.h"
+#include "genQueryStream.h"
 
 #define	INIT_UMASK_VAL	99999999
 typedef struct CollSqlResult {
@@ -98,6 +99,9 @@ typedef struct QueryHandle {
 #define NO_TRIM_REPL_FG       0x10     /* don't trim the replica */
 #define INCLUDE_CONDINPUT_IN_QUERY       0x20  /* include the cond in condInput
 					        * in the query */
+#define STREAM_QUERY_FG       0x40     /* stream the dataObj query. No other
+					* call can be made on the conn until
+					* the dataObj are read. client only */
 
 typedef struct CollHandle {
     collState_t state;
@@ -110,6 +114,7 @@ typedef struct CollHandle {
     dataObjInp_t dataObjInp;
     dataObjSqlResult_t dataObjSqlResult;
     collSqlResult_t collSqlResult;
+    genQueryStream_t *genQueryStream;	/* STREAM_QUERY_FG */
     char linkedObjPath[MAX_NAME_LEN];
     char prevdataId[NAME_LEN];
 } collHandle_t;
@@ -200,6 +205,9 @@ queryDataObjInColl (queryHandle_t *queryHandle, char *collection,
 int flags, genQueryInp_t *genQueryInp,
 genQueryOut_t **genQueryOut, keyValPair_t *condInput);
 int
+setQueryInpForDataInColl (char *collection, int flags,
+genQueryInp_t *genQueryInp, keyValPair_t *condInput);
+int
 setQueryInpForData (int flags, genQueryInp_t *genQueryInp);
 
 int
@@ -181,7 +181,8 @@ typedef struct KeyValPair {
 } keyValPair_t;
 
 /* definition for flags in dataObjInfo_t */
-#define NO_COMMIT_FLAG	0x1  /* used in chlModDataObjMeta and chlRegDataObj */
+#define NO_COMMIT_FLAG	0x1  /* used in chlModDataObjMeta, chlRegDataObj and
+			      * chlRegReplica */
 
 typedef struct DataObjInfo {
     char objPath[MAX_NAME_LEN];
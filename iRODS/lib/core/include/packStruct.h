@@ -16,6 +16,14 @@ struct */
 #define MAX_PACKED_OUT_ALLOC_SZ (1024*1024)
 #define NULL_PTR_PACK_STR "%@#ANULLSTR$%"
 
+/* definition for the compiled pack plan cache. A pack instruction is
+ * parsed once into a template item list and copied for each use.
+ */
+#define PACK_INX_HASH_SZ	512	/* hash size of the pack table index */
+#define PACK_PLAN_HASH_SZ	512	/* hash size of the pack plan cache */
+#define MAX_PACK_PLAN_CNT	2048	/* max number of cached pack plans */
+#define MAX_CALLER_PACK_TABLE	16	/* max num of indexed caller tables */
+
 /* definition for the flag in packXmlTag() */
 #define START_TAG_FL	0
 #define END_TAG_FL	1
@@ -93,11 +101,32 @@ typedef struct packItem {
     int dimSize[MAX_PACK_DIM];	/* the size of each dimension */
     int hintDim;		/* the Hint dimension */
     int hintDimSize[MAX_PACK_DIM];	/* the size of each Hint dimension */
+    int resolved;	/* dim and hintDim already resolved by the plan */
     struct packItem *parent;
     struct packItem *prev;
     struct packItem *next;
 } packItem_t;
 
+/* hashed name index of a packInstructArray_t or PackConstantTable */
+typedef struct packNameInx {
+    char *name;
+    int inx;		/* index of the entry in the table */
+    struct packNameInx *next;
+} packNameInx_t;
+
+typedef struct packTableInx {
+    void *table;		/* the table being indexed */
+    packNameInx_t *bucket[PACK_INX_HASH_SZ];
+} packTableInx_t;
+
+/* a compiled pack instruction */
+typedef struct packPlan {
+    char *packInstruct;		/* the instruction string, strdup'ed */
+    unsigned int hashVal;
+    packItem_t *itemHead;	/* template items. Copied, never modified */
+    struct packPlan *next;
+} packPlan_t;
+
 typedef struct {
     int numBuf;
     bytesBuf_t *bBufArray;	/* pointer to an array of bytesBuf_t */
@@ -119,6 +148,18 @@ packInstructArray_t *myPackTable, irodsProt_t irodsProt);
 int
 parsePackInstruct (char *packInstruct, packItem_t **packItemHead);
 int
+getPackPlan (char *packInstruct, packItem_t **packItemHead);
+int
+compilePackPlan (packItem_t *packItemHead);
+int
+copyPackItemList (packItem_t *srcItemHead, packItem_t **packItemHead);
+int
+enablePackPlan (int flag);
+int
+getPackPlanStat (int *planCnt, int *hitCnt, int *missCnt);
+int
+lookupPackConstant (char *name, int *value);
+int
 copyStrFromPiBuf (char **inBuf, char *outBuf, int dependentFlag);
 int
 packTypeLookup (char *typeName);
@@ -55,13 +55,18 @@ typedef struct {
    int hostAddr;
    char *hostAddrString;
    int input;
+   int jobs;
+   int jobsValue;
    int redirectConn;
    int checksum;
    int verifyChecksum;
+   int chksumCache;
+   char *chksumCacheString;
    int dataType;
    char *dataTypeString; 
    int longOption;
    int link;
+   int manifest;
    int rlock;
    int wlock;
    int veryLongOption;
@@ -24,6 +24,15 @@ int
 sendApiRequest (rcComm_t *conn, int apiInx, void *inputStruct,
 bytesBuf_t *inputBsBBuf);
 int
+_sendApiRequest (rcComm_t *conn, int apiInx, void *inputStruct,
+bytesBuf_t *inputBsBBuf, char *msgType, int *reqLen);
+int
+rcSubmitApiRequest (rcComm_t *conn, int apiNumber, void *inputStruct,
+bytesBuf_t *inputBsBBuf);
+int
+rcCompleteApiRequest (rcComm_t *conn, int reqId, void **outStruct,
+bytesBuf_t *outBsBBuf);
+int
 procApiReply (rcComm_t *conn, int apiInx, void **outStruct,
 bytesBuf_t *outBsBBuf,
 msgHeader_t *myHeader, bytesBuf_t *outStructBBuf, bytesBuf_t *myOutBsBBuf,
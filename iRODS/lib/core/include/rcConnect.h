@@ -94,6 +94,26 @@ typedef enum {
     PROC_LOG_DONE       /* the proc logging in log/proc is done */
 } procLogFlag_t;
 
+/* the requests in flight on a connection in the pipelined mode, oldest 
+ * first. The client does not read the replies while it is sending, so
+ * the requests in flight must fit in the socket buffers or the client
+ * and the agent both block on send. MAX_REQ_PIPE_BYTES is kept well 
+ * below MIN_SOCK_WINDOW_SIZE. A request longer than that can only be
+ * sent when no other one is in flight. */
+#define MAX_REQ_PIPE_DEPTH	32
+#define MAX_REQ_PIPE_BYTES	(8*1024)	/* max request bytes in flight */
+
+typedef struct ReqPipe {
+    int nextReqId;
+    int head;		/* inx of the oldest request in flight */
+    int numPending;
+    int curReqId;	/* the request whose reply is being read */
+    int bytesPending;	/* total length of the requests in flight */
+    int reqId[MAX_REQ_PIPE_DEPTH];
+    int apiInx[MAX_REQ_PIPE_DEPTH];
+    int reqLen[MAX_REQ_PIPE_DEPTH];
+} reqPipe_t;
+
 /* The client connection handle */
 
 typedef struct {
@@ -110,6 +130,13 @@ typedef struct {
     rError_t *rError;
     int flag;
     transferStat_t transStat;
+    rodsLong_t zeroCopyBytes;	/* bytes of transStat moved by sendfile or
+				 * splice in portal transfers */
+    rodsLong_t bufferedBytes;	/* bytes moved through a user buffer */
+    struct InlineChksum *inlineChksum;	/* if not NULL, the data of the
+					 * transfer are chksummed in it */
+    int reqPipeline;	/* the server accepted the pipelined mode */
+    reqPipe_t *reqPipe;	/* requests submitted by rcSubmitApiRequest */
     int apiInx;
     int status;
     int windowSize;
@@ -174,6 +201,10 @@ typedef struct {
     int reconnectedSock;
     char *reconnAddr;
     int cookie;
+    int reqPipeline;	/* the client asked for the pipelined mode */
+    int curReqId;	/* ID of the pipelined request being handled or -1 */
+    int reqPipeCorked;	/* TCP_CORK is on for the replies */
+    int reqPipeNoCork;	/* TCP_CORK failed on the socket. don't try again */
 
 #ifdef USE_BOOST
     boost::thread*              reconnThr;
@@ -116,6 +116,15 @@ int
 catGenQueryOut (genQueryOut_t *targGenQueryOut, genQueryOut_t *genQueryOut,
 int maxRowCnt);
 int
+appendGenQueryBatch (bytesBuf_t *batch, int *batchCap,
+genQueryOut_t *genQueryOut);
+int
+getGenQueryBatchHeader (bytesBuf_t *batch, int *rowCnt, int *attriCnt,
+int *totalRowCount, int *attriInx);
+int
+getGenQueryBatchRow (char **rowPtr, char *endPtr, int attriCnt,
+char **value, int *valueLen);
+int
 clearBulkOprInp (bulkOprInp_t *bulkOprInp);
 int
 getUnixUid (char *userName);
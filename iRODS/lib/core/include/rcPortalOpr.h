@@ -31,6 +31,8 @@ typedef struct RcPortalTransferInp {
     int threadNum;
     int status;
     rodsLong_t	bytesWritten;
+    rodsLong_t	zeroCopyBytes;	/* moved with sendfile/splice */
+    rodsLong_t	bufferedBytes;	/* moved with myRead/myWrite */
 } rcPortalTransferInp_t;
     
 typedef enum {
@@ -42,6 +44,8 @@ int
 fillRcPortalTransferInp (rcComm_t *conn, rcPortalTransferInp_t *myInput, 
 int destFd, int srcFd, int threadNum);
 int
+addPortalTransStat (rcComm_t *conn, rcPortalTransferInp_t *myInput);
+int
 putFileToPortal (rcComm_t *conn, portalOprOut_t *portalOprOut, 
 char *locFilePath, char *objPath, rodsLong_t dataSize);
 int
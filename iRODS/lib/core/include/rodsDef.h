@@ -138,6 +138,11 @@
 #define SYS_SVR_TO_CLI_PUT_ACTION 99999990
 #define SYS_SVR_TO_CLI_GET_ACTION 99999991
 #define SYS_RSYNC_TARGET_MODIFIED 99999992	/* target modified */
+/* a batch of rows of a streamed genQuery. The client answers each with
+ * SYS_CLI_TO_SVR_GEN_QUERY_ACK, or SYS_CLI_TO_SVR_GEN_QUERY_CANCEL to stop */
+#define SYS_SVR_TO_CLI_GEN_QUERY_BATCH 99999993
+#define SYS_CLI_TO_SVR_GEN_QUERY_ACK 99999994
+#define SYS_CLI_TO_SVR_GEN_QUERY_CANCEL 99999989
 
 /* definition for iRODS server to client action request from a microservice. 
  * these definitions are put in the "label" field of MsParam */  
@@ -256,6 +261,10 @@ typedef struct msgHeader {
 #define RODS_RECONNECT_T    "RODS_RECONNECT"
 #define RODS_REAUTH_T     "RODS_REAUTH"
 #define RODS_API_REPLY_T    "RODS_API_REPLY"
+/* pipelined API request and reply. The msg type is followed by a blank
+ * and the request ID. Only used when negotiated at startup */
+#define RODS_API_PREQ_T    "RODS_API_PREQ"
+#define RODS_API_PREPLY_T    "RODS_API_PREPLY"
 
 /* The strct sent with RODS_CONNECT type by client */
 typedef struct startupPack {
@@ -273,6 +282,13 @@ typedef struct startupPack {
 
 /* env variable for the client protocol */
 #define IRODS_PROT	"irodsProt"
+/* env variable for asking the server for the pipelined request mode */
+#define IRODS_REQ_PIPELINE	"irodsReqPipeline"
+/* appended to the startupPack option to ask for the pipelined mode */
+#define REQ_PIPELINE_OPT	"+reqPipeline"
+/* set in the status of the version sent by the agent if it accepted
+ * the pipelined mode */
+#define VERSION_REQ_PIPELINE	0x1
  
 /* env variable for the startup pack */
 
@@ -291,6 +307,7 @@ typedef struct startupPack {
 #define SP_LOG_SQL	"spLogSql"
 #define SP_LOG_LEVEL	"spLogLevel"
 #define SERVER_BOOT_TIME "serverBootTime"
+#define SP_AGENT_POOL_SOCK "spAgentPoolSock"	/* set for a pre-forked agent */
 
 /* Definition for resource status. If it is empty (strlen == 0), it is
  * assumed to be up */
@@ -398,6 +415,8 @@ typedef struct {
     char remoteAddr[NAME_LEN];
     char serverAddr[NAME_LEN];
     char progName[NAME_LEN];
+    int l1descHwm;		/* max number of L1desc in use */
+    int l3descHwm;		/* max number of FileDesc (L3) in use */
 } procLog_t;
 
 #endif	/* RODS_DEF_H */
@@ -159,6 +159,8 @@
 #define SYS_MSSO_EXTRACT_ALL_ERR         -134000
 #define SYS_MSSO_OPEN_ERR                -135000
 #define SYS_MSSO_CLOSE_ERR               -136000
+#define SYS_RESC_CACHE_STALE             -137000
+#define SYS_THREAD_CREATE_ERR            -138000
 
 
 
@@ -215,6 +217,8 @@
 #define SYMLINKED_BUNFILE_NOT_ALLOWED	-359000
 #define USER_INPUT_STRING_ERR           -360000
 #define USER_NOT_ALLOWED_TO_EXEC_CMD    -370000
+#define USER_REQ_PIPELINE_ERR		-371000
+#define USER_REQ_PIPELINE_FULL		-372000
 
 
 /* 500,000 to 800,000 - file driver error */
@@ -108,6 +108,9 @@
 #define TICKET_KW               "ticket"        /* for ticket-based-access */
 #define PURGE_CACHE_KW		"purgeCache"	/* purge the cache copy right
 						 * after the operation */
+#define REPL_FAN_OUT_KW		"replFanOut"	/* the fan-out policy of a
+						 * multi-dest repl. See
+						 * dataObjRepl.h */
 #define EMPTY_BUNDLE_ONLY_KW	"emptyBundleOnly" /* delete emptyBundleOnly */
 #define LOCK_TYPE_KW	"lockType"	/* valid values are READ_LOCK_TYPE
 					 * WRITE_LOCK_TYPE and UNLOCK_TYPE */
@@ -0,0 +1,114 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* rsyncManifest.h - Header for for rsyncManifest.c */
+
+#ifndef RSYNC_MANIFEST_H
+#define RSYNC_MANIFEST_H
+
+#include "rodsClient.h"
+#include "parseCommandLine.h"
+#include "rodsPath.h"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define DEF_RSYNC_NUM_CONN	4
+#define MAX_RSYNC_NUM_CONN	16
+#define CHKSUM_CACHE_MAGIC	"iRODS irsync chksum cache 1"
+
+/* flags of a manifestEntry_t */
+#define MANIFEST_MIXED_REPL	0x1	/* the replicas differ in size/chksum */
+
+/* what has to be done with a local file */
+#define RSYNC_ACT_NONE		0
+#define RSYNC_ACT_PUT		1	/* new or the size differs */
+#define RSYNC_ACT_CHKSUM	2	/* same size. compare the chksum */
+#define RSYNC_ACT_RSYNC		3	/* no chksum in iCat. the server compares */
+#define RSYNC_ACT_OBJSTAT	4	/* mixed replicas. sync it the old way */
+
+/* a data object under the target collection */
+typedef struct {
+    char *objPath;
+    char *chksum;		/* NULL if none */
+    rodsLong_t size;
+    int flags;
+} manifestEntry_t;
+
+/* the content of the target collection, sorted by path */
+typedef struct {
+    manifestEntry_t *entries;
+    int numEntries;
+    int maxEntries;
+    char **colls;
+    int numColls;
+    int maxColls;
+} rsyncManifest_t;
+
+/* a file of the local source directory */
+typedef struct {
+    char *relPath;		/* relative to the source dir */
+    rodsLong_t size;
+    rodsLong_t inode;
+    int mtime;
+    int mode;
+    int action;
+    manifestEntry_t *manifestEntry;
+} localFileEnt_t;
+
+typedef struct {
+    localFileEnt_t *files;
+    int numFiles;
+    int maxFiles;
+    char **dirs;		/* relative to the source dir */
+    int numDirs;
+    int maxDirs;
+} localTree_t;
+
+/* the local chksum cache. A chksum is reused as long as the inode,
+ * mtime, size and the hash type of the file are the same */
+typedef struct {
+    rodsLong_t inode;
+    rodsLong_t size;
+    int mtime;
+    int hashType;
+    char chksum[CHKSUM_LEN];
+} chksumCacheEntry_t;
+
+typedef struct {
+    char *fileName;
+    chksumCacheEntry_t *entries;
+    int numEntries;
+    int maxEntries;
+    int sortedCnt;		/* entries loaded from the file, sorted */
+} chksumCache_t;
+
+int
+rsyncDirToCollByManifest (rcComm_t *conn, rodsPath_t *srcPath,
+rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
+dataObjInp_t *dataObjOprInp);
+int
+getRsyncManifest (rcComm_t *conn, char *targColl, rsyncManifest_t *manifest);
+manifestEntry_t *
+findManifestEntry (rsyncManifest_t *manifest, char *objPath);
+int
+findManifestColl (rsyncManifest_t *manifest, char *collPath);
+int
+clearRsyncManifest (rsyncManifest_t *manifest);
+int
+walkLocalTree (char *srcDir, rodsArguments_t *rodsArgs, int numThr,
+localTree_t *localTree);
+int
+clearLocalTree (localTree_t *localTree);
+int
+loadChksumCache (char *fileName, chksumCache_t *chksumCache);
+int
+saveChksumCache (chksumCache_t *chksumCache);
+int
+clearChksumCache (chksumCache_t *chksumCache);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* RSYNC_MANIFEST_H */
@@ -48,6 +48,9 @@ int
 rsyncCollToCollUtil (rcComm_t *conn, rodsPath_t *srcPath,
 rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
 dataObjCopyInp_t *dataObjCopyInp);
+int
+ageExceeded (int ageLimit, int myTime, int verbose, char *objPath,
+rodsLong_t fileSize);
 
 #ifdef  __cplusplus
 }
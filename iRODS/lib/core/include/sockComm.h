@@ -39,6 +39,11 @@
 						 * RECONN_TIMEOUT if this
 						 * env is set */
 
+#define NO_ZERO_COPY_KW "irodsNoZeroCopy"	/* don't use sendfile/splice
+						 * for portal transfers if
+						 * this env is set */
+#define ZERO_COPY_PIPE_SZ	(1024*1024)	/* pipe size for splice */
+
 /* definition for socket close function */
 #define READING_FROM_CLI	0
 #define PROCESSING_API		1
@@ -62,6 +67,9 @@ int myRead (int sock, void *buf, int len, irodsDescType_t irodsDescType,
 int *bytesRead, struct timeval *tv);
 int myWrite (int sock, void *buf, int len, irodsDescType_t irodsDescType,
 int *bytesWritten);
+int zeroCopyEnabled ();
+int mySendfile (int sock, int fd, int len, int *bytesWritten);
+int mySpliceToFile (int sock, int fd, int len, int *bytesWritten);
 int connectToRhost (rcComm_t *conn, int connectCnt, int reconnFlag);
 int connectToRhostWithRaddr (struct sockaddr_in *remoteAddr, int windowSize,
 int timeoutFlag);
@@ -78,6 +86,10 @@ int
 sendVersion (int sock, int versionStatus, int reconnPort, 
 char *reconnAddr, int cookie);
 int
+setReqPipeMsgType (char *msgType, char *baseType, int reqId);
+int
+getReqPipeMsgId (char *msgType, char *baseType);
+int
 readMsgBody (int sock, msgHeader_t *myHeader, bytesBuf_t *inputStructBBuf,
 bytesBuf_t *bsBBuf, bytesBuf_t *errorBBuf, irodsProt_t irodsProt,
 struct timeval *tv);
@@ -0,0 +1,39 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* xferQue.h - Header for for xferQue.c */
+
+#ifndef XFER_QUE_H
+#define XFER_QUE_H
+
+#include "rodsClient.h"
+#include "parseCommandLine.h"
+#include "rodsPath.h"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define DEF_XFER_QUE_NUM_CONN	4
+#define MAX_XFER_QUE_NUM_CONN	16
+#define XFER_QUE_ITEMS_PER_CONN	4	/* the walker waits when this many
+					 * items per conn are queued */
+#define XFER_QUE_MAX_AHEAD	64	/* with -X, max items not yet in the
+					 * restart file */
+/* the small files of a collection are queued together, up to
+ * MAX_NUM_BULK_OPR_FILES files or XFER_QUE_BATCH_SIZE bytes per item */
+#define XFER_QUE_BATCH_SIZE	(BULK_OPR_BUF_SIZE - MAX_BULK_OPR_FILE_SIZE)
+
+int
+putDirUtilByQue (rcComm_t **myConn, char *srcDir, char *targColl,
+rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart);
+int
+getCollUtilByQue (rcComm_t **myConn, char *srcColl, char *targDir,
+rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+rodsRestart_t *rodsRestart);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif	/* XFER_QUE_H */
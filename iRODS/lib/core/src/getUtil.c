@@ -10,24 +10,7 @@
 #include "getUtil.h"
 #include "miscUtil.h"
 #include "rcPortalOpr.h"
-
-int
-setSessionTicket(rcComm_t *myConn, char *ticket) {
-   ticketAdminInp_t ticketAdminInp;
-   int status;
-
-   ticketAdminInp.arg1 = "session";
-   ticketAdminInp.arg2 = ticket;
-   ticketAdminInp.arg3 = "";
-   ticketAdminInp.arg4 = "";
-   ticketAdminInp.arg5 = "";
-   ticketAdminInp.arg6 = "";
-   status = rcTicketAdmin(myConn, &ticketAdminInp);
-   if (status != 0) {
-      printf("set ticket error %d \n", status);
-   }
-   return(status);
-}
+#include "xferQue.h"
 
 int
 getUtil (rcComm_t **myConn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
@@ -127,9 +110,15 @@ rodsPathInp_t *rodsPathInp)
             /* The path given by collEnt.collName from rclReadCollection 
              * has already been translated */
 	    addKeyVal (&dataObjOprInp.condInput, TRANSLATED_PATH_KW, "");
-	    status = getCollUtil (myConn, rodsPathInp->srcPath[i].outPath,
-              targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
-	      &rodsRestart);
+	    if (myRodsArgs->jobs == True) {
+	        status = getCollUtilByQue (myConn,
+		  rodsPathInp->srcPath[i].outPath, targPath->outPath,
+		  myRodsEnv, myRodsArgs, &dataObjOprInp, &rodsRestart);
+	    } else {
+	        status = getCollUtil (myConn, rodsPathInp->srcPath[i].outPath,
+                  targPath->outPath, myRodsEnv, myRodsArgs, &dataObjOprInp,
+	          &rodsRestart);
+	    }
 #if 0
             if (rodsRestart.fd > 0 && status < 0) {
                 close (rodsRestart.fd);
@@ -6,6 +6,24 @@
 
 char zoneHint[MAX_NAME_LEN];
 
+int
+setSessionTicket(rcComm_t *myConn, char *ticket) {
+   ticketAdminInp_t ticketAdminInp;
+   int status;
+
+   ticketAdminInp.arg1 = "session";
+   ticketAdminInp.arg2 = ticket;
+   ticketAdminInp.arg3 = "";
+   ticketAdminInp.arg4 = "";
+   ticketAdminInp.arg5 = "";
+   ticketAdminInp.arg6 = "";
+   status = rcTicketAdmin(myConn, &ticketAdminInp);
+   if (status != 0) {
+      printf("set ticket error %d \n", status);
+   }
+   return(status);
+}
+
 int
 lsUtil (rcComm_t *conn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
 rodsPathInp_t *rodsPathInp)
@@ -418,6 +436,10 @@ rodsArguments_t *rodsArgs)
     } else if (rodsArgs->longOption == True) { 
 	queryFlags |= LONG_METADATA_FG | NO_TRIM_REPL_FG;;
     }
+    if (rodsArgs->accessControl != True && rodsArgs->bundle != True) {
+	/* no other call is made while the dataObj are listed */
+	queryFlags |= STREAM_QUERY_FG;
+    }
 
     status = rclOpenCollection (conn, srcColl, queryFlags,
       &collHandle);
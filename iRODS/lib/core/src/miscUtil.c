@@ -14,6 +14,10 @@
 
 static uint Myumask = INIT_UMASK_VAL;
 
+static int
+streamDataObjInColl (queryHandle_t *queryHandle, collHandle_t *collHandle,
+genQueryOut_t **genQueryOut);
+
 int
 mkColl (rcComm_t *conn, char *collection)
 {
@@ -369,14 +373,37 @@ queryDataObjInColl (queryHandle_t *queryHandle, char *collection,
 int flags, genQueryInp_t *genQueryInp,
 genQueryOut_t **genQueryOut, keyValPair_t *condInput)
 {
-    char collQCond[MAX_NAME_LEN];
     int status;
-    char *rescName = NULL;
 
     if (collection == NULL || genQueryOut == NULL) {
         return (USER__NULL_INPUT_ERR);
     }
 
+    status = setQueryInpForDataInColl (collection, flags, genQueryInp,
+      condInput);
+    if (status < 0) return status;
+
+    status = (*queryHandle->genQuery) (
+      (rcComm_t *) queryHandle->conn, genQueryInp, genQueryOut);
+
+    return (status);
+
+}
+
+/* setQueryInpForDataInColl - set up genQueryInp for the query of the
+ * DataObj in a collection.
+ */
+int
+setQueryInpForDataInColl (char *collection, int flags,
+genQueryInp_t *genQueryInp, keyValPair_t *condInput)
+{
+    char collQCond[MAX_NAME_LEN];
+    char *rescName = NULL;
+
+    if (collection == NULL || genQueryInp == NULL) {
+        return (USER__NULL_INPUT_ERR);
+    }
+
     memset (genQueryInp, 0, sizeof (genQueryInp_t));
 
     if ((flags & RECUR_QUERY_FG) != 0) {
@@ -406,11 +433,7 @@ genQueryOut_t **genQueryOut, keyValPair_t *condInput)
     genQueryInp->maxRows = MAX_SQL_ROWS;
     genQueryInp->options = RETURN_TOTAL_ROW_COUNT;
 
-    status = (*queryHandle->genQuery) (
-      (rcComm_t *) queryHandle->conn, genQueryInp, genQueryOut);
-
-    return (status);
-
+    return (0);
 }
 
 int
@@ -1241,6 +1264,10 @@ readCollection (collHandle_t *collHandle, collEnt_t *collEnt)
                       collHandle->dataObjInp.objPath, status);
                 }
                 /* cleanup */
+                if (collHandle->genQueryStream != NULL) {
+                    rcGenQueryStreamClose (collHandle->genQueryStream);
+                    collHandle->genQueryStream = NULL;
+                }
                 if (collHandle->dataObjInp.specColl == NULL) {
                     clearGenQueryInp (&collHandle->genQueryInp);
                 }
@@ -1269,6 +1296,10 @@ readCollection (collHandle_t *collHandle, collEnt_t *collEnt)
                       collHandle->dataObjInp.objPath, status);
                 }
                 /* cleanup */
+                if (collHandle->genQueryStream != NULL) {
+                    rcGenQueryStreamClose (collHandle->genQueryStream);
+                    collHandle->genQueryStream = NULL;
+                }
                 if (collHandle->dataObjInp.specColl == NULL) {
                     clearGenQueryInp (&collHandle->genQueryInp);
                 }
@@ -1376,6 +1407,9 @@ genDataResInColl (queryHandle_t *queryHandle, collHandle_t *collHandle)
 	      ((rcComm_t *) queryHandle->conn,
 	      &collHandle->dataObjInp, &genQueryOut);
 	}
+    } else if ((collHandle->flags & STREAM_QUERY_FG) != 0 &&
+      queryHandle->connType == RC_COMM) {
+	status = streamDataObjInColl (queryHandle, collHandle, &genQueryOut);
     } else {
         memset (&collHandle->genQueryInp, 0, sizeof (genQueryInp_t));
         status = queryDataObjInColl (queryHandle,
@@ -1397,6 +1431,36 @@ genDataResInColl (queryHandle_t *queryHandle, collHandle_t *collHandle)
     return status;
 }
 
+/* streamDataObjInColl - query the DataObj in a collection with
+ * rcGenQueryStreamOpen and return the first page. The rest is read by
+ * getNextDataObjMetaInfo. Servers without the call get the paged query.
+ */
+static int
+streamDataObjInColl (queryHandle_t *queryHandle, collHandle_t *collHandle,
+genQueryOut_t **genQueryOut)
+{
+    int status;
+    genQueryInp_t *genQueryInp = &collHandle->genQueryInp;
+
+    status = setQueryInpForDataInColl (collHandle->dataObjInp.objPath,
+      collHandle->flags, genQueryInp, &collHandle->dataObjInp.condInput);
+    if (status < 0) return status;
+
+    status = rcGenQueryStreamOpen ((rcComm_t *) queryHandle->conn,
+      genQueryInp, &collHandle->genQueryStream);
+    if (status == SYS_UNMATCHED_API_NUM) {
+	/* an older server */
+	collHandle->flags &= ~STREAM_QUERY_FG;
+        return ((*queryHandle->genQuery) (
+          (rcComm_t *) queryHandle->conn, genQueryInp, genQueryOut));
+    } else if (status < 0) {
+	return status;
+    }
+
+    return (rcGenQueryStreamNextPage (collHandle->genQueryStream,
+      MAX_SQL_ROWS, genQueryOut));
+}
+
 int
 rclCloseCollection (collHandle_t *collHandle)
 {
@@ -1407,6 +1471,10 @@ int
 clearCollHandle (collHandle_t *collHandle, int freeSpecColl)
 {
     if (collHandle == NULL) return 0;
+    if (collHandle->genQueryStream != NULL) {
+	rcGenQueryStreamClose (collHandle->genQueryStream);
+	collHandle->genQueryStream = NULL;
+    }
     if (collHandle->dataObjInp.specColl == NULL) {
         clearGenQueryInp (&collHandle->genQueryInp);
     }
@@ -1559,7 +1627,10 @@ getNextDataObjMetaInfo (collHandle_t *collHandle, collEnt_t *outCollEnt)
         if (continueInx > 0) {
             /* More to come */
 
-            if (dataObjInp->specColl != NULL) {
+            if (collHandle->genQueryStream != NULL) {
+                status = rcGenQueryStreamNextPage (
+		  collHandle->genQueryStream, MAX_SQL_ROWS, &genQueryOut);
+            } else if (dataObjInp->specColl != NULL) {
                 dataObjInp->openFlags = continueInx;
                 status = (*queryHandle->querySpecColl) (
 		  (rcComm_t *) queryHandle->conn, dataObjInp, &genQueryOut);
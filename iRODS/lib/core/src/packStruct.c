@@ -10,6 +10,56 @@
 #include "rcGlobalExtern.h"
 #include "base64.h"
 #include "rcMisc.h"
+#ifdef USE_BOOST
+#include <boost/thread/mutex.hpp>
+#else
+#ifndef windows_platform
+#include <pthread.h>
+#endif
+#endif
+
+/* The compiled pack plan cache and the hashed indexes of the pack tables.
+ * They are shared by all threads of a process and guarded by PackPlanLock.
+ */
+static int PackPlanFlag = 1;		/* 0 - parse every instruction */
+static packPlan_t *PackPlanHash[PACK_PLAN_HASH_SZ];
+static int PackPlanCnt = 0;
+static int PackPlanHitCnt = 0;
+static int PackPlanMissCnt = 0;
+static packTableInx_t *RodsPackTableInx = NULL;	/* RodsPackTable+ApiPackTable */
+static packTableInx_t *PackConstantInx = NULL;
+static packTableInx_t *CallerPackTableInx[MAX_CALLER_PACK_TABLE];
+#ifdef USE_BOOST
+static boost::mutex PackPlanLock;
+#else
+#ifndef windows_platform
+static pthread_mutex_t PackPlanLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
+static void
+lockPackPlan ()
+{
+#ifdef USE_BOOST
+    PackPlanLock.lock ();
+#else
+#ifndef windows_platform
+    pthread_mutex_lock (&PackPlanLock);
+#endif
+#endif
+}
+
+static void
+unlockPackPlan ()
+{
+#ifdef USE_BOOST
+    PackPlanLock.unlock ();
+#else
+#ifndef windows_platform
+    pthread_mutex_unlock (&PackPlanLock);
+#endif
+#endif
+}
 
 int 
 packStruct (void *inStruct, bytesBuf_t **packedResult, char *packInstName,
@@ -417,10 +467,11 @@ packInstructArray_t *myPackTable, packOpr_t packOpr)
         return status;
     }
 
-    status = resolveDepInArray (myPackedItem, myPackTable);
-
-    if (status < 0) {
-        return status;
+    if (myPackedItem->resolved == 0) {
+        status = resolveDepInArray (myPackedItem, myPackTable);
+        if (status < 0) {
+            return status;
+        }
     }
 
     /* set up the pointer */
@@ -572,7 +623,7 @@ resolveIntDepItem (packItem_t *myPackedItem, packInstructArray_t *myPackTable)
     }
 
     newPackedItem = NULL;
-    status = parsePackInstruct (myPI, &newPackedItem);
+    status = getPackPlan (myPI, &newPackedItem);
 
     if (status < 0) {
 	rodsLog (LOG_ERROR,
@@ -648,13 +699,8 @@ packInstructArray_t *myPackTable)
 
     /* Try the Rods Global table */
 
-    i = 0;
-    while (strcmp (PackConstantTable[i].name, PACK_TABLE_END_PI) != 0) {
-        /* not the end */
-        if (strcmp (PackConstantTable[i].name, name) == 0) {
-            return (PackConstantTable[i].value);
-        }
-        i++;
+    if (lookupPackConstant (name, &i) >= 0) {
+        return (i);
     }
 
     return (SYS_PACK_INSTRUCT_FORMAT_ERR);
@@ -701,8 +747,106 @@ resolveStrInItem (packItem_t *myPackedItem, packInstructArray_t *myPackTable)
     return (0);
 }
 
-void *
-matchPackInstruct (char *name, packInstructArray_t *myPackTable)
+static unsigned int
+hashPackName (char *name)
+{
+    unsigned int hashVal = 5381;
+    int c;
+
+    while ((c = *name) != '\0') {
+        hashVal = ((hashVal << 5) + hashVal) + c;
+        name++;
+    }
+    return (hashVal);
+}
+
+/* addPackTableInx - add the names of a packInstructArray_t or
+ * packConstantArray_t table to a name index. An already indexed name
+ * is not replaced so that the first table added takes precedence,
+ * the same as the order of the linear search.
+ */
+static int
+addPackTableInx (packTableInx_t *tableInx, void *table, int isConstant)
+{
+    int i = 0;
+    char *name;
+    unsigned int hashInx;
+    packNameInx_t *tmpInx;
+
+    while (1) {
+        if (isConstant > 0) {
+            name = ((packConstantArray_t *) table)[i].name;
+        } else {
+            name = ((packInstructArray_t *) table)[i].name;
+        }
+        if (strcmp (name, PACK_TABLE_END_PI) == 0) break;
+
+        hashInx = hashPackName (name) % PACK_INX_HASH_SZ;
+        tmpInx = tableInx->bucket[hashInx];
+        while (tmpInx != NULL) {
+            if (strcmp (tmpInx->name, name) == 0) break;
+            tmpInx = tmpInx->next;
+        }
+        if (tmpInx == NULL) {
+            tmpInx = (packNameInx_t *) malloc (sizeof (packNameInx_t));
+            tmpInx->name = name;
+            tmpInx->inx = i;
+            tmpInx->next = tableInx->bucket[hashInx];
+            tableInx->bucket[hashInx] = tmpInx;
+        }
+        i++;
+    }
+    return (0);
+}
+
+static packTableInx_t *
+newPackTableInx (void *table)
+{
+    packTableInx_t *tableInx;
+
+    tableInx = (packTableInx_t *) malloc (sizeof (packTableInx_t));
+    memset (tableInx, 0, sizeof (packTableInx_t));
+    tableInx->table = table;
+    return (tableInx);
+}
+
+static packNameInx_t *
+lookupPackTableInx (packTableInx_t *tableInx, char *name)
+{
+    packNameInx_t *tmpInx;
+
+    tmpInx = tableInx->bucket[hashPackName (name) % PACK_INX_HASH_SZ];
+    while (tmpInx != NULL) {
+        if (strcmp (tmpInx->name, name) == 0) return (tmpInx);
+        tmpInx = tmpInx->next;
+    }
+    return (NULL);
+}
+
+/* getCallerPackTableInx - get the index of a caller supplied pack table.
+ * Must be called with PackPlanLock held. Returns NULL if too many
+ * different tables have been used, in which case the caller falls back
+ * to a linear search.
+ */
+static packTableInx_t *
+getCallerPackTableInx (packInstructArray_t *myPackTable)
+{
+    int i;
+
+    for (i = 0; i < MAX_CALLER_PACK_TABLE; i++) {
+        if (CallerPackTableInx[i] == NULL) {
+            CallerPackTableInx[i] = newPackTableInx (myPackTable);
+            addPackTableInx (CallerPackTableInx[i], myPackTable, 0);
+            return (CallerPackTableInx[i]);
+        } else if (CallerPackTableInx[i]->table == myPackTable) {
+            return (CallerPackTableInx[i]);
+        }
+    }
+    return (NULL);
+}
+
+static void *
+_matchPackInstruct (char *name, packInstructArray_t *myPackTable)
 {
     int i;
 
@@ -739,13 +883,298 @@ matchPackInstruct (char *name, packInstructArray_t *myPackTable)
         i++;
     }
 
-    rodsLog (LOG_ERROR, 
-      "matchPackInstruct: Cannot resolve %s", 
-      name);
-
     return (NULL);
 }
 
+void *
+matchPackInstruct (char *name, packInstructArray_t *myPackTable)
+{
+    packTableInx_t *tableInx;
+    packNameInx_t *nameInx;
+    void *packInstruct = NULL;
+    int i;
+
+    if (PackPlanFlag == 0) {
+        packInstruct = _matchPackInstruct (name, myPackTable);
+    } else {
+        lockPackPlan ();
+        if (RodsPackTableInx == NULL) {
+            /* RodsPackTable first, then the API table */
+            RodsPackTableInx = newPackTableInx (RodsPackTable);
+            addPackTableInx (RodsPackTableInx, RodsPackTable, 0);
+            addPackTableInx (RodsPackTableInx, ApiPackTable, 0);
+        }
+        /* the global tables are searched after the caller's table anyway */
+        if (myPackTable != NULL && myPackTable != RodsPackTable &&
+          myPackTable != ApiPackTable) {
+            tableInx = getCallerPackTableInx (myPackTable);
+            if (tableInx == NULL) {
+                i = 0;
+                while (strcmp (myPackTable[i].name, PACK_TABLE_END_PI) != 0) {
+                    if (strcmp (myPackTable[i].name, name) == 0) {
+                        packInstruct = myPackTable[i].packInstruct;
+                        break;
+                    }
+                    i++;
+                }
+            } else if ((nameInx = lookupPackTableInx (tableInx, name)) !=
+              NULL) {
+                packInstruct = myPackTable[nameInx->inx].packInstruct;
+            }
+        }
+        if (packInstruct == NULL &&
+          (nameInx = lookupPackTableInx (RodsPackTableInx, name)) != NULL) {
+            /* the name is either from RodsPackTable or ApiPackTable */
+            if (nameInx->name == RodsPackTable[nameInx->inx].name) {
+                packInstruct = RodsPackTable[nameInx->inx].packInstruct;
+            } else {
+                packInstruct = ApiPackTable[nameInx->inx].packInstruct;
+            }
+        }
+        unlockPackPlan ();
+    }
+
+    if (packInstruct == NULL) {
+        rodsLog (LOG_ERROR,
+          "matchPackInstruct: Cannot resolve %s",
+          name);
+    }
+
+    return (packInstruct);
+}
+
+/* lookupPackConstant - look up name in PackConstantTable. Returns 0 and
+ * sets *value if found, SYS_PACK_INSTRUCT_FORMAT_ERR otherwise.
+ */
+int
+lookupPackConstant (char *name, int *value)
+{
+    packNameInx_t *nameInx;
+    int i;
+
+    if (PackPlanFlag == 0) {
+        i = 0;
+        while (strcmp (PackConstantTable[i].name, PACK_TABLE_END_PI) != 0) {
+            if (strcmp (PackConstantTable[i].name, name) == 0) {
+                *value = PackConstantTable[i].value;
+                return (0);
+            }
+            i++;
+        }
+        return (SYS_PACK_INSTRUCT_FORMAT_ERR);
+    }
+
+    lockPackPlan ();
+    if (PackConstantInx == NULL) {
+        PackConstantInx = newPackTableInx (PackConstantTable);
+        addPackTableInx (PackConstantInx, PackConstantTable, 1);
+    }
+    nameInx = lookupPackTableInx (PackConstantInx, name);
+    unlockPackPlan ();
+
+    if (nameInx == NULL) {
+        return (SYS_PACK_INSTRUCT_FORMAT_ERR);
+    }
+    *value = PackConstantTable[nameInx->inx].value;
+    return (0);
+}
+
+/* getPackPlan - same as parsePackInstruct but the parsed item list is
+ * cached by instruction string, so an instruction is only parsed and
+ * compiled once per process. *packItemHead is a private copy which the
+ * caller frees with freePackedItem as before.
+ */
+int
+getPackPlan (char *packInstruct, packItem_t **packItemHead)
+{
+    packPlan_t *tmpPlan;
+    packItem_t *itemHead = NULL;
+    unsigned int hashVal;
+    int status;
+
+    if (PackPlanFlag == 0) {
+        return (parsePackInstruct (packInstruct, packItemHead));
+    }
+
+    hashVal = hashPackName (packInstruct);
+    lockPackPlan ();
+    tmpPlan = PackPlanHash[hashVal % PACK_PLAN_HASH_SZ];
+    while (tmpPlan != NULL) {
+        if (tmpPlan->hashVal == hashVal &&
+          strcmp (tmpPlan->packInstruct, packInstruct) == 0) {
+            break;
+        }
+        tmpPlan = tmpPlan->next;
+    }
+    if (tmpPlan != NULL) {
+        PackPlanHitCnt++;
+    } else {
+        PackPlanMissCnt++;
+    }
+    unlockPackPlan ();
+
+    if (tmpPlan != NULL) {
+        /* a plan is never modified or freed once queued */
+        return (copyPackItemList (tmpPlan->itemHead, packItemHead));
+    }
+
+    status = parsePackInstruct (packInstruct, &itemHead);
+    if (status < 0) {
+        freePackedItem (itemHead);
+        return (status);
+    }
+    compilePackPlan (itemHead);
+
+    status = copyPackItemList (itemHead, packItemHead);
+    if (status < 0) {
+        freePackedItem (itemHead);
+        return (status);
+    }
+
+    lockPackPlan ();
+    if (PackPlanCnt >= MAX_PACK_PLAN_CNT) {
+        /* instructions built on the fly. Don't cache any more */
+        unlockPackPlan ();
+        freePackedItem (itemHead);
+        return (0);
+    }
+    /* another thread may have queued the same plan. Harmless */
+    tmpPlan = (packPlan_t *) malloc (sizeof (packPlan_t));
+    tmpPlan->packInstruct = strdup (packInstruct);
+    tmpPlan->hashVal = hashVal;
+    tmpPlan->itemHead = itemHead;
+    tmpPlan->next = PackPlanHash[hashVal % PACK_PLAN_HASH_SZ];
+    PackPlanHash[hashVal % PACK_PLAN_HASH_SZ] = tmpPlan;
+    PackPlanCnt++;
+    unlockPackPlan ();
+
+    return (0);
+}
+
+/* compilePackPlan - resolve the array and hint dimensions of items that
+ * do not depend on the value of another item, i.e. the dimensions are
+ * numbers or PackConstantTable names. Those items are marked resolved
+ * so that resolveDepInArray is skipped at pack time. Int items are
+ * named in camel case and constants in upper case, so a constant name
+ * cannot be shadowed by an item in the parent struct.
+ */
+int
+compilePackPlan (packItem_t *packItemHead)
+{
+    packItem_t *tmpItem, *prevItem, *savedPrev;
+    char buf[MAX_PI_LEN];
+    char *inPtr, *bufPtr;
+    int c, value, isStatic;
+
+    tmpItem = packItemHead;
+    while (tmpItem != NULL) {
+        if (tmpItem->typeInx == PACK_DEPENDENT_TYPE ||
+          tmpItem->typeInx == PACK_INT_DEPENDENT_TYPE ||
+          tmpItem->name == NULL) {
+            tmpItem = tmpItem->next;
+            continue;
+        }
+        /* check each [] and () term */
+        isStatic = 1;
+        bufPtr = NULL;
+        inPtr = tmpItem->name;
+        while ((c = *inPtr) != '\0' && isStatic > 0) {
+            if (c == '[' || c == '(') {
+                bufPtr = buf;
+            } else if (c == ']' || c == ')') {
+                if (bufPtr == NULL) {
+                    isStatic = 0;
+                    break;
+                }
+                *bufPtr = '\0';
+                if (isAllDigit (buf) == 0) {
+                    if (lookupPackConstant (buf, &value) < 0) {
+                        isStatic = 0;
+                    }
+                    /* an item of the same instruction shadows constants */
+                    prevItem = tmpItem->prev;
+                    while (prevItem != NULL && isStatic > 0) {
+                        if (prevItem->name != NULL &&
+                          strcmp (prevItem->name, buf) == 0) isStatic = 0;
+                        prevItem = prevItem->prev;
+                    }
+                }
+                bufPtr = NULL;
+            } else if (bufPtr != NULL) {
+                if (bufPtr - buf >= MAX_PI_LEN - 1) {
+                    isStatic = 0;
+                    break;
+                }
+                *bufPtr = c;
+                bufPtr++;
+            }
+            inPtr++;
+        }
+        if (isStatic > 0 && bufPtr == NULL) {
+            /* resolve with no item chain so that only numbers and
+             * constants are looked at */
+            savedPrev = tmpItem->prev;
+            tmpItem->prev = NULL;
+            if (resolveDepInArray (tmpItem, NULL) >= 0) {
+                tmpItem->resolved = 1;
+            }
+            tmpItem->prev = savedPrev;
+        }
+        tmpItem = tmpItem->next;
+    }
+    return (0);
+}
+
+int
+copyPackItemList (packItem_t *srcItemHead, packItem_t **packItemHead)
+{
+    packItem_t *srcItem, *myItem, *prevItem = NULL;
+
+    *packItemHead = NULL;
+    srcItem = srcItemHead;
+    while (srcItem != NULL) {
+        myItem = (packItem_t *) malloc (sizeof (packItem_t));
+        *myItem = *srcItem;
+        if (srcItem->name != NULL) {
+            myItem->name = strdup (srcItem->name);
+        }
+        myItem->parent = NULL;
+        myItem->next = NULL;
+        myItem->prev = prevItem;
+        if (prevItem == NULL) {
+            *packItemHead = myItem;
+        } else {
+            prevItem->next = myItem;
+        }
+        prevItem = myItem;
+        srcItem = srcItem->next;
+    }
+    return (0);
+}
+
+/* enablePackPlan - turn the pack plan cache and table indexes on (1) or
+ * off (0). Returns the previous setting. Mainly for benchmarking.
+ */
+int
+enablePackPlan (int flag)
+{
+    int prevFlag = PackPlanFlag;
+
+    PackPlanFlag = flag;
+    return (prevFlag);
+}
+
+int
+getPackPlanStat (int *planCnt, int *hitCnt, int *missCnt)
+{
+    lockPackPlan ();
+    if (planCnt != NULL) *planCnt = PackPlanCnt;
+    if (hitCnt != NULL) *hitCnt = PackPlanHitCnt;
+    if (missCnt != NULL) *missCnt = PackPlanMissCnt;
+    unlockPackPlan ();
+    return (0);
+}
+
 int 
 resolveDepInArray (packItem_t *myPackedItem, packInstructArray_t *myPackTable)
 {
@@ -1841,7 +2270,7 @@ int packFlag, irodsProt_t irodsProt, char *packInstructInp)
 	int doubleInStruct;
 	packItemHead = NULL;
 
-	status = parsePackInstruct ((char*)packInstruct, &packItemHead);
+	status = getPackPlan ((char*)packInstruct, &packItemHead);
         if (status < 0) {
             return (status);
         }
@@ -2747,7 +3176,7 @@ irodsProt_t irodsProt, char *packInstructInp)
     for (i = 0; i < numElement; i++) {
         unpackItemHead = NULL;
 
-        status = parsePackInstruct ((char*)packInstruct, &unpackItemHead);
+        status = getPackPlan ((char*)packInstruct, &unpackItemHead);
         if (status < 0) {
             return (status);
         }
@@ -68,7 +68,7 @@ parseCmdLineOpt (int argc, char **argv, char *optString, int includeLong,
 
    int i;
 
-   char fullOpts[]="aAbc:C:dD:efFghH:ikK:lm:n:N:p:P:qrR:s:S:t:Tu:vVzZxWY:";
+   char fullOpts[]="aAbc:C:dD:efFghH:ij:kK:lm:n:N:p:P:qrR:s:S:t:Tu:vVzZxWY:";
    char *opts;
    int VCount=0;
    int status;
@@ -221,6 +221,23 @@ parseCmdLineOpt (int argc, char **argv, char *optString, int includeLong,
                 argv[i+1]="-Z";
         }
      }
+         if (strcmp("--manifest", argv[i])==0) {
+            rodsArgs->manifest=True;
+            argv[i]="-Z";
+         }
+         if (strcmp("--chksumcache", argv[i])==0) {
+            rodsArgs->chksumCache=True;
+            argv[i]="-Z";
+            if (argc >= i + 2) {
+               if (*argv[i+1] == '-') {
+                   rodsLog (LOG_ERROR,
+                    "--chksumcache option needs a file name");
+                    return USER_INPUT_OPTION_ERR;
+               }
+               rodsArgs->chksumCacheString=strdup(argv[i+1]);
+               argv[i+1]="-Z";
+            }
+         }
          if (strcmp("--dryrun", argv[i])==0) {
             rodsArgs->dryrun=True;
             argv[i]="-Z";
@@ -445,6 +462,10 @@ parseCmdLineOpt (int argc, char **argv, char *optString, int includeLong,
       case 'I':
          rodsArgs->redirectConn=True;	/* connect directly to resc server */
          break;
+      case 'j':
+         rodsArgs->jobs=True;
+         rodsArgs->jobsValue = atoi(optarg);
+         break;
       case 'k':
          rodsArgs->checksum=True;
          break;
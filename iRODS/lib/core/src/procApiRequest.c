@@ -43,6 +43,13 @@ bytesBuf_t *inputBsBBuf, void **outStruct, bytesBuf_t *outBsBBuf)
 	return (USER__NULL_INPUT_ERR);
     }
 
+    if (conn->reqPipe != NULL && conn->reqPipe->numPending > 0) {
+        rodsLog (LOG_ERROR,
+          "procApiRequest: %d submitted requests not completed", 
+	  conn->reqPipe->numPending);
+	return (USER_REQ_PIPELINE_ERR);
+    }
+
     freeRError (conn->rError);
     conn->rError = NULL;
     
@@ -71,6 +78,150 @@ bytesBuf_t *inputBsBBuf, void **outStruct, bytesBuf_t *outBsBBuf)
     return (status);
 }
 
+/* rcSubmitApiRequest - send an API request without waiting for its reply,
+ * so that several small requests (stat, open/read/close, queries) can be
+ * in flight on one connection. The agent handles them in the order
+ * submitted and each reply is picked up with rcCompleteApiRequest, also
+ * in the order submitted. If the server accepted the pipelined mode
+ * (conn->reqPipeline, asked for with the irodsReqPipeline env variable),
+ * the requests and replies are tagged with the request ID and checked.
+ * Otherwise plain requests are sent, which an agent handles in order too.
+ *
+ * Only calls that are a single request and reply can be submitted, not
+ * the ones with portal transfers or further msgs on the connection,
+ * such as rcDataObjPut/Get or the ones returning collection status.
+ * No procApiRequest call can be made until all submitted requests are
+ * completed.
+ *
+ * The replies are not read while submitting, so at most 
+ * MAX_REQ_PIPE_BYTES of requests are kept in flight. Past that, nothing
+ * is sent and USER_REQ_PIPELINE_FULL is returned; the caller completes 
+ * the oldest request and submits again.
+ *
+ * Returns the request ID (>= 0) to be passed to rcCompleteApiRequest.
+ */
+
+int
+rcSubmitApiRequest (rcComm_t *conn, int apiNumber, void *inputStruct,
+bytesBuf_t *inputBsBBuf)
+{
+    int status;
+    int apiInx;
+    int inx;
+    int reqLen;
+    reqPipe_t *reqPipe;
+    char msgType[HEADER_TYPE_LEN];
+
+    if (conn == NULL) {
+	return (USER__NULL_INPUT_ERR);
+    }
+
+    if (conn->reqPipe == NULL) {
+	conn->reqPipe = (reqPipe_t *) calloc (1, sizeof (reqPipe_t));
+	if (conn->reqPipe == NULL) return (SYS_MALLOC_ERR);
+    }
+    reqPipe = conn->reqPipe;
+
+    if (reqPipe->numPending >= MAX_REQ_PIPE_DEPTH) {
+	return (USER_REQ_PIPELINE_FULL);
+    }
+
+    apiInx = apiTableLookup (apiNumber);
+    if (apiInx < 0) {
+        rodsLog (LOG_ERROR,
+          "rcSubmitApiRequest: apiTableLookup of apiNumber %d failed", 
+	  apiNumber);
+        return (apiInx);
+    }
+
+    if (conn->reqPipeline > 0) {
+	setReqPipeMsgType (msgType, RODS_API_PREQ_T, reqPipe->nextReqId);
+    } else {
+	rstrcpy (msgType, RODS_API_REQ_T, HEADER_TYPE_LEN);
+    }
+
+    /* a request alone in flight cannot block */
+    if (reqPipe->numPending > 0) {
+	reqLen = MAX_REQ_PIPE_BYTES - reqPipe->bytesPending;
+	if (reqLen <= 0) return (USER_REQ_PIPELINE_FULL);
+    } else {
+	reqLen = 0;
+    }
+
+    status = _sendApiRequest (conn, apiInx, inputStruct, inputBsBBuf, 
+      msgType, &reqLen);
+    if (status == USER_REQ_PIPELINE_FULL) {
+	return (status);
+    } else if (status < 0) {
+        rodsLogError (LOG_DEBUG, status,
+          "rcSubmitApiRequest: sendApiRequest failed. status = %d", status);
+        return (status);
+    }
+
+    inx = (reqPipe->head + reqPipe->numPending) % MAX_REQ_PIPE_DEPTH;
+    reqPipe->reqId[inx] = reqPipe->nextReqId;
+    reqPipe->apiInx[inx] = apiInx;
+    reqPipe->reqLen[inx] = reqLen;
+    reqPipe->bytesPending += reqLen;
+    reqPipe->numPending++;
+    reqPipe->nextReqId++;
+    if (reqPipe->nextReqId < 0) reqPipe->nextReqId = 0;
+
+    return (reqPipe->reqId[inx]);
+}
+
+/* rcCompleteApiRequest - read the reply of a request sent by 
+ * rcSubmitApiRequest. reqId must be the oldest request in flight.
+ * outStruct and outBsBBuf are as for procApiRequest. The return value
+ * is that of the API call.
+ */
+
+int
+rcCompleteApiRequest (rcComm_t *conn, int reqId, void **outStruct,
+bytesBuf_t *outBsBBuf)
+{
+    int status;
+    int apiInx;
+    reqPipe_t *reqPipe;
+
+    if (conn == NULL) {
+	return (USER__NULL_INPUT_ERR);
+    }
+
+    reqPipe = conn->reqPipe;
+    if (reqPipe == NULL || reqPipe->numPending <= 0) {
+        rodsLog (LOG_ERROR,
+          "rcCompleteApiRequest: no request in flight for reqId %d", reqId);
+	return (USER_REQ_PIPELINE_ERR);
+    }
+
+    if (reqPipe->reqId[reqPipe->head] != reqId) {
+        rodsLog (LOG_ERROR,
+          "rcCompleteApiRequest: reqId %d is not the oldest request %d",
+	  reqId, reqPipe->reqId[reqPipe->head]);
+	return (USER_REQ_PIPELINE_ERR);
+    }
+
+    apiInx = reqPipe->apiInx[reqPipe->head];
+    reqPipe->bytesPending -= reqPipe->reqLen[reqPipe->head];
+    reqPipe->curReqId = reqId;
+    reqPipe->head = (reqPipe->head + 1) % MAX_REQ_PIPE_DEPTH;
+    reqPipe->numPending--;
+
+    freeRError (conn->rError);
+    conn->rError = NULL;
+    conn->apiInx = apiInx;
+
+    status = readAndProcApiReply (conn, apiInx, outStruct, outBsBBuf);
+    if (status < 0) {
+        rodsLogError (LOG_DEBUG, status,
+          "rcCompleteApiRequest: readAndProcApiReply failed. status = %d", 
+	  status);
+    }
+
+    return (status);
+}
+
 int
 branchReadAndProcApiReply (rcComm_t *conn, int apiNumber,
 void **outStruct, bytesBuf_t *outBsBBuf)
@@ -104,8 +255,23 @@ void **outStruct, bytesBuf_t *outBsBBuf)
 int
 sendApiRequest (rcComm_t *conn, int apiInx, void *inputStruct,
 bytesBuf_t *inputBsBBuf)
+{
+    return (_sendApiRequest (conn, apiInx, inputStruct, inputBsBBuf,
+      RODS_API_REQ_T, NULL));
+}
+
+/* _sendApiRequest - send an API request with the msg type msgType which
+ * is RODS_API_REQ_T or a pipelined request type from setReqPipeMsgType.
+ * If reqLen is not NULL, it is set to the length of the request. If it
+ * was > 0, the request is not sent if longer than that and 
+ * USER_REQ_PIPELINE_FULL is returned.
+ */
+int
+_sendApiRequest (rcComm_t *conn, int apiInx, void *inputStruct,
+bytesBuf_t *inputBsBBuf, char *msgType, int *reqLen)
 {
     int status;
+    int myLen;
     bytesBuf_t *inputStructBBuf = NULL;
     bytesBuf_t *myInputStructBBuf;
 
@@ -142,14 +308,28 @@ bytesBuf_t *inputBsBBuf)
         inputBsBBuf = NULL;
     }
 
+    if (reqLen != NULL) {
+	myLen = sizeof (msgHeader_t);
+	if (myInputStructBBuf != NULL) myLen += myInputStructBBuf->len;
+	if (inputBsBBuf != NULL) myLen += inputBsBBuf->len;
+	if (*reqLen > 0 && myLen > *reqLen) {
+	    freeBBuf (inputStructBBuf);
+//#ifndef windows_platform
+            cliChkReconnAtSendEnd (conn);
+//#endif
+	    return (USER_REQ_PIPELINE_FULL);
+	}
+	*reqLen = myLen;
+    }
+
 #ifdef USE_SSL
     if (conn->ssl_on)
-        status = sslSendRodsMsg (conn->sock, RODS_API_REQ_T, myInputStructBBuf,
+        status = sslSendRodsMsg (conn->sock, msgType, myInputStructBBuf,
                               inputBsBBuf, NULL, RcApiTable[apiInx].apiNumber, 
                               conn->irodsProt, conn->ssl);
     else
 #endif
-        status = sendRodsMsg (conn->sock, RODS_API_REQ_T, myInputStructBBuf,
+        status = sendRodsMsg (conn->sock, msgType, myInputStructBBuf,
                               inputBsBBuf, NULL, RcApiTable[apiInx].apiNumber, conn->irodsProt);
 
     if (status < 0) {
@@ -179,13 +359,13 @@ bytesBuf_t *inputBsBBuf)
                   "sendApiRequest: Switch connection and retry sendRodsMsg");
 #ifdef USE_SSL
                 if (conn->ssl_on) 
-                    status = sslSendRodsMsg (conn->sock, RODS_API_REQ_T, 
+                    status = sslSendRodsMsg (conn->sock, msgType, 
                                           myInputStructBBuf, inputBsBBuf, NULL, 
                                              RcApiTable[apiInx].apiNumber, conn->irodsProt,
                                              conn->ssl);
                 else
 #endif
-                    status = sendRodsMsg (conn->sock, RODS_API_REQ_T, 
+                    status = sendRodsMsg (conn->sock, msgType, 
                                           myInputStructBBuf, inputBsBBuf, NULL, 
                                           RcApiTable[apiInx].apiNumber, conn->irodsProt);
                 if (status >= 0) {
@@ -210,6 +390,7 @@ readAndProcApiReply (rcComm_t *conn, int apiInx, void **outStruct,
 bytesBuf_t *outBsBBuf)
 {
     int status;
+    int reqId;
     msgHeader_t myHeader;
     /* bytesBuf_t outStructBBuf, errorBBuf, myOutBsBBuf; */
     bytesBuf_t outStructBBuf, errorBBuf;
@@ -317,6 +498,17 @@ bytesBuf_t *outBsBBuf)
     if (strcmp (myHeader.type, RODS_API_REPLY_T) == 0) {
 	status = procApiReply (conn, apiInx, outStruct, outBsBBuf,
 	 &myHeader, &outStructBBuf, NULL, &errorBBuf); 
+    } else if ((reqId = getReqPipeMsgId (myHeader.type, RODS_API_PREPLY_T))
+      >= 0) {
+	if (conn->reqPipe == NULL || reqId != conn->reqPipe->curReqId) {
+            rodsLog (LOG_ERROR,
+              "readAndProcApiReply: got the reply of request %d, expect %d",
+	      reqId, conn->reqPipe == NULL ? -1 : conn->reqPipe->curReqId);
+	    status = USER_REQ_PIPELINE_ERR;
+	} else {
+	    status = procApiReply (conn, apiInx, outStruct, outBsBBuf,
+	     &myHeader, &outStructBBuf, NULL, &errorBBuf); 
+	}
     }
 
     clearBBuf (&outStructBBuf);
@@ -6,27 +6,11 @@
 #include "rodsPath.h"
 #include "rodsErrorTable.h"
 #include "rodsLog.h"
+#include "lsUtil.h"
 #include "putUtil.h"
 #include "miscUtil.h"
 #include "rcPortalOpr.h"
-
-int
-setSessionTicket(rcComm_t *myConn, char *ticket) {
-   ticketAdminInp_t ticketAdminInp;
-   int status;
-
-   ticketAdminInp.arg1 = "session";
-   ticketAdminInp.arg2 = ticket;
-   ticketAdminInp.arg3 = "";
-   ticketAdminInp.arg4 = "";
-   ticketAdminInp.arg5 = "";
-   ticketAdminInp.arg6 = "";
-   status = rcTicketAdmin(myConn, &ticketAdminInp);
-   if (status != 0) {
-      printf("set ticket error %d \n", status);
-   }
-   return(status);
-}
+#include "xferQue.h"
 
 int
 putUtil (rcComm_t **myConn, rodsEnv *myRodsEnv, 
@@ -121,7 +105,12 @@ rodsArguments_t *myRodsArgs, rodsPathInp_t *rodsPathInp)
 	       myRodsArgs, &dataObjOprInp);
 	} else if (targPath->objType == COLL_OBJ_T) {
 	    setStateForRestart (conn, &rodsRestart, targPath, myRodsArgs);
-	    if (myRodsArgs->bulk == True) {
+	    if (myRodsArgs->jobs == True) {
+		status = putDirUtilByQue (myConn,
+		  rodsPathInp->srcPath[i].outPath, targPath->outPath,
+		  myRodsEnv, myRodsArgs, &dataObjOprInp, &bulkOprInp,
+		  &rodsRestart);
+	    } else if (myRodsArgs->bulk == True) {
 		status = bulkPutDirUtil (myConn, 
 		  rodsPathInp->srcPath[i].outPath, targPath->outPath, 
 		  myRodsEnv, myRodsArgs, &dataObjOprInp, &bulkOprInp,
@@ -222,25 +211,15 @@ rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp)
         gGuiProgressCB (&conn->operProgress);
     }
 
-    /* have to take care of checksum here since it needs to be recalcuated */ 
+    /* no value - rcDataObjPut chksums the file while sending it */
     if (rodsArgs->checksum == True) {
-        status = rcChksumLocFile (srcPath, REG_CHKSUM_KW,
-          &dataObjOprInp->condInput, extractHashFunction3(rodsArgs));
-        if (status < 0) {
-            rodsLogError (LOG_ERROR, status,
-              "putFileUtil: rcChksumLocFile error for %s, status = %d", 
-              srcPath, status);
-            return (status);
-        }
+        addKeyVal (&dataObjOprInp->condInput, REG_CHKSUM_KW, "");
     } else if (rodsArgs->verifyChecksum == True) {
-        status = rcChksumLocFile (srcPath, VERIFY_CHKSUM_KW,
-          &dataObjOprInp->condInput, extractHashFunction3(rodsArgs));
-        if (status < 0) {
-            rodsLogError (LOG_ERROR, status,
-              "putFileUtil: rcChksumLocFile error for %s, status = %d",
-              srcPath, status);
-            return (status);
-        }
+        addKeyVal (&dataObjOprInp->condInput, VERIFY_CHKSUM_KW, "");
+    }
+    if (rodsArgs->checksum == True || rodsArgs->verifyChecksum == True) {
+        addKeyVal (&dataObjOprInp->condInput, HASH_KW,
+          extractHashFunction3 (rodsArgs) ? "sha2" : "md5");
     }
     if (strlen(targPath)>=MAX_PATH_ALLOWED-1) return(USER_PATH_EXCEEDS_MAX);
     rstrcpy (dataObjOprInp->objPath, targPath, MAX_NAME_LEN);
@@ -337,6 +337,11 @@ cleanRcComm (rcComm_t *conn)
 	conn->svrVersion = NULL;
     }
 
+    if (conn->reqPipe != NULL) {
+	free (conn->reqPipe);
+	conn->reqPipe = NULL;
+    }
+
     return (0);
 }
 void rcPipSigHandler ()
@@ -1378,6 +1378,136 @@ int maxRowCnt)
     return (0);
 }
 
+/* appendGenQueryBatch - Append the rows of genQueryOut to a batch of a
+ * streamed genQuery (see genQueryStream.h). batch->buf is grown as needed 
+ * and *batchCap is its size. An empty batch is started with the header: 
+ * the rowCnt, attriCnt and totalRowCount, then the attriInx of each
+ * column, all in network byte order. Each value is its length in 7 bit
+ * groups, the value and a NULL.
+ */
+int
+appendGenQueryBatch (bytesBuf_t *batch, int *batchCap,
+genQueryOut_t *genQueryOut)
+{
+    int i, j, k, len, hdrLen, need;
+    int *header;
+    char *value;
+    unsigned char *ptr;
+
+    if (batch == NULL || batchCap == NULL || genQueryOut == NULL)
+        return USER__NULL_INPUT_ERR;
+
+    hdrLen = (3 + genQueryOut->attriCnt) * sizeof (int);
+    /* the values are at most len - 1 long and 4 bytes do for the length */
+    need = batch->len > 0 ? batch->len : hdrLen;
+    for (j = 0; j < genQueryOut->attriCnt; j++) {
+	need += genQueryOut->rowCnt * (genQueryOut->sqlResult[j].len + 4);
+    }
+    if (need > *batchCap) {
+	char *tmpBuf;
+	if ((tmpBuf = (char *) realloc (batch->buf, need)) == NULL)
+	    return (SYS_MALLOC_ERR - errno);
+	batch->buf = tmpBuf;
+	*batchCap = need;
+    }
+    header = (int *) batch->buf;
+    if (batch->len == 0) {
+	header[0] = 0;
+	header[1] = htonl (genQueryOut->attriCnt);
+	header[2] = htonl (genQueryOut->totalRowCount);
+	for (j = 0; j < genQueryOut->attriCnt; j++) {
+	    header[3 + j] = htonl (genQueryOut->sqlResult[j].attriInx);
+	}
+	batch->len = hdrLen;
+    } else if ((int) ntohl (header[1]) != genQueryOut->attriCnt) {
+        rodsLog (LOG_ERROR,
+          "appendGenQueryBatch: attriCnt mismatch %d != %d",
+	  ntohl (header[1]), genQueryOut->attriCnt);
+	return SYS_STRUCT_ELEMENT_MISMATCH;
+    }
+
+    ptr = (unsigned char *) batch->buf + batch->len;
+    for (i = 0; i < genQueryOut->rowCnt; i++) {
+	for (j = 0; j < genQueryOut->attriCnt; j++) {
+	    value = &genQueryOut->sqlResult[j].value
+	      [genQueryOut->sqlResult[j].len * i];
+	    len = strlen (value);
+	    for (k = len; k >= 0x80; k >>= 7) {
+		*ptr++ = (k & 0x7f) | 0x80;
+	    }
+	    *ptr++ = k;
+	    memcpy (ptr, value, len + 1);
+	    ptr += len + 1;
+	}
+    }
+    batch->len = (char *) ptr - (char *) batch->buf;
+    header[0] = htonl (ntohl (header[0]) + genQueryOut->rowCnt);
+
+    return (0);
+}
+
+/* getGenQueryBatchHeader - Parse the header of a batch made by
+ * appendGenQueryBatch. attriInx must hold MAX_SQL_ATTR. Returns the
+ * offset of the first row.
+ */
+int
+getGenQueryBatchHeader (bytesBuf_t *batch, int *rowCnt, int *attriCnt,
+int *totalRowCount, int *attriInx)
+{
+    int j, hdrLen;
+    int *header;
+
+    if (batch == NULL || batch->len < (int) (3 * sizeof (int))) 
+	return SYS_STRUCT_ELEMENT_MISMATCH;
+
+    header = (int *) batch->buf;
+    *rowCnt = ntohl (header[0]);
+    *attriCnt = ntohl (header[1]);
+    *totalRowCount = ntohl (header[2]);
+    hdrLen = (3 + *attriCnt) * sizeof (int);
+    if (*rowCnt < 0 || *attriCnt < 0 || *attriCnt > MAX_SQL_ATTR ||
+      batch->len < hdrLen) {
+        rodsLog (LOG_ERROR,
+          "getGenQueryBatchHeader: bad header, rowCnt %d, attriCnt %d",
+	  *rowCnt, *attriCnt);
+	return SYS_STRUCT_ELEMENT_MISMATCH;
+    }
+    for (j = 0; j < *attriCnt; j++) {
+	attriInx[j] = ntohl (header[3 + j]);
+    }
+    return (hdrLen);
+}
+
+/* getGenQueryBatchRow - Parse the row of a batch at *rowPtr into the 
+ * value and valueLen arrays and move *rowPtr to the next row. The values
+ * point into the batch. endPtr is the end of the batch.
+ */
+int
+getGenQueryBatchRow (char **rowPtr, char *endPtr, int attriCnt,
+char **value, int *valueLen)
+{
+    int j, len, shift;
+    unsigned char *ptr = (unsigned char *) *rowPtr;
+
+    for (j = 0; j < attriCnt; j++) {
+	len = 0;
+	shift = 0;
+	do {
+	    if ((char *) ptr >= endPtr || shift > 28) 
+		return SYS_STRUCT_ELEMENT_MISMATCH;
+	    len |= (*ptr & 0x7f) << shift;
+	    shift += 7;
+	} while ((*ptr++ & 0x80) != 0);
+	if (len < 0 || len >= endPtr - (char *) ptr || ptr[len] != '\0')
+	    return SYS_STRUCT_ELEMENT_MISMATCH;
+	value[j] = (char *) ptr;
+	valueLen[j] = len;
+	ptr += len + 1;
+    }
+    *rowPtr = (char *) ptr;
+    return (0);
+}
+
 int
 clearBulkOprInp (bulkOprInp_t *bulkOprInp)
 {
@@ -3803,6 +3933,85 @@ clearModAVUMetadataInp (modAVUMetadataInp_t *modAVUMetadataInp)
    return(0);
 }
 
+/* addBulkAVUMetadataOp - append an operation to a bulkAVUMetadataInp_t.
+ * A NULL units is sent as an empty one. At most MAX_BULK_AVU_OPS can be
+ * added.
+ */
+int
+addBulkAVUMetadataOp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, char *op,
+char *objType, char *objName, char *attribute, char *value, char *units)
+{
+    char ***arrays[6];
+    char *strs[6];
+    char **newArray;
+    int newLen, i, n;
+
+    if (bulkAVUMetadataInp == NULL || op == NULL || objType == NULL || 
+      objName == NULL || attribute == NULL || value == NULL) {
+	return (SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+    if (bulkAVUMetadataInp->numOps >= MAX_BULK_AVU_OPS) {
+	return (SYS_INVALID_INPUT_PARAM);
+    }
+
+    arrays[0] = &bulkAVUMetadataInp->op;
+    arrays[1] = &bulkAVUMetadataInp->objType;
+    arrays[2] = &bulkAVUMetadataInp->objName;
+    arrays[3] = &bulkAVUMetadataInp->attribute;
+    arrays[4] = &bulkAVUMetadataInp->value;
+    arrays[5] = &bulkAVUMetadataInp->units;
+    strs[0] = op;
+    strs[1] = objType;
+    strs[2] = objName;
+    strs[3] = attribute;
+    strs[4] = value;
+    strs[5] = units != NULL ? units : (char *) "";
+
+    /* the arrays are PTR_ARRAY_MALLOC_LEN long at first and double
+     * in size each time they are full */
+    n = bulkAVUMetadataInp->numOps;
+    newLen = PTR_ARRAY_MALLOC_LEN;
+    while (newLen < n) newLen *= 2;
+    if (n == 0 || n == newLen) {
+	if (n > 0) newLen *= 2;
+	for (i = 0; i < 6; i++) {
+	    newArray = (char **) realloc (*arrays[i], newLen * sizeof (char *));
+	    if (newArray == NULL) return (SYS_MALLOC_ERR);
+	    *arrays[i] = newArray;
+	}
+    }
+    for (i = 0; i < 6; i++) {
+	(*arrays[i])[n] = strdup (strs[i]);
+    }
+    bulkAVUMetadataInp->numOps++;
+    return (0);
+}
+
+int
+clearBulkAVUMetadataInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp)
+{
+    int i;
+
+    if (bulkAVUMetadataInp == NULL) return (0);
+    for (i = 0; i < bulkAVUMetadataInp->numOps; i++) {
+	freeStringIfNotNull (bulkAVUMetadataInp->op[i]);
+	freeStringIfNotNull (bulkAVUMetadataInp->objType[i]);
+	freeStringIfNotNull (bulkAVUMetadataInp->objName[i]);
+	freeStringIfNotNull (bulkAVUMetadataInp->attribute[i]);
+	freeStringIfNotNull (bulkAVUMetadataInp->value[i]);
+	freeStringIfNotNull (bulkAVUMetadataInp->units[i]);
+    }
+    if (bulkAVUMetadataInp->op != NULL) free (bulkAVUMetadataInp->op);
+    if (bulkAVUMetadataInp->objType != NULL) free (bulkAVUMetadataInp->objType);
+    if (bulkAVUMetadataInp->objName != NULL) free (bulkAVUMetadataInp->objName);
+    if (bulkAVUMetadataInp->attribute != NULL) 
+	free (bulkAVUMetadataInp->attribute);
+    if (bulkAVUMetadataInp->value != NULL) free (bulkAVUMetadataInp->value);
+    if (bulkAVUMetadataInp->units != NULL) free (bulkAVUMetadataInp->units);
+    memset (bulkAVUMetadataInp, 0, sizeof (bulkAVUMetadataInp_t));
+    return(0);
+}
+
 /* freeRodsObjStat - free a rodsObjStat_t. Note that this should only
  * be used by the client because specColl also is freed which is cached
  * on the server
@@ -9,6 +9,7 @@
 #include "dataObjOpr.h"
 #include "rodsLog.h"
 #include "rcGlobalExtern.h"
+#include "md5Checksum.h"
 
 #ifdef USE_BOOST
 #include <boost/thread/thread.hpp>
@@ -182,6 +183,7 @@ char *locFilePath, char *objPath, rodsLong_t dataSize)
         }
 	fillRcPortalTransferInp (conn, &myInput[0], sock, in_fd, 0);
 	rcPartialDataPut (&myInput[0]);
+	addPortalTransStat (conn, &myInput[0]);
 	if (myInput[0].status < 0) {
 	    return (myInput[0].status);
 	} else {
@@ -237,6 +239,7 @@ char *locFilePath, char *objPath, rodsLong_t dataSize)
 #endif
 	    }
 	    totalWritten += myInput[i].bytesWritten;
+	    addPortalTransStat (conn, &myInput[i]);
             if (myInput[i].status < 0) {
                 retVal = myInput[i].status;
 	    }
@@ -281,6 +284,25 @@ int destFd, int srcFd, int threadNum)
     return (0);
 }
 
+/* addPortalTransStat - add the bytes a portal thread moved with and
+ * without zero-copy to the conn stats. Called after the thread is done.
+ */
+int
+addPortalTransStat (rcComm_t *conn, rcPortalTransferInp_t *myInput)
+{
+    if (conn == NULL || myInput == NULL)
+        return (SYS_INTERNAL_NULL_INPUT_ERR);
+
+    conn->zeroCopyBytes += myInput->zeroCopyBytes;
+    conn->bufferedBytes += myInput->bufferedBytes;
+    if (myInput->zeroCopyBytes > 0) {
+        rodsLog (LOG_DEBUG,
+          "addPortalTransStat: thread %d zeroCopy %lld buffered %lld bytes",
+          myInput->threadNum, myInput->zeroCopyBytes, myInput->bufferedBytes);
+    }
+    return (0);
+}
+
 void
 rcPartialDataPut (rcPortalTransferInp_t *myInput)
 {
@@ -293,6 +315,7 @@ rcPartialDataPut (rcPortalTransferInp_t *myInput)
     rcComm_t *conn;
     fileRestartInfo_t *info;
     int threadNum;
+    int zeroCopy;
 
 #ifdef PARA_DEBUG
     printf ("rcPartialDataPut: thread %d at start\n", myInput->threadNum);
@@ -311,7 +334,10 @@ rcPartialDataPut (rcPortalTransferInp_t *myInput)
     destFd = myInput->destFd;
     srcFd = myInput->srcFd;
 
-    buf = malloc (TRANS_BUF_SZ);
+    /* the buffer is only needed if sendfile can't be used. The data
+     * have to go through it to be chksummed */
+    buf = NULL;
+    zeroCopy = zeroCopyEnabled () && conn->inlineChksum == NULL;
 
     myInput->bytesWritten = 0;
 
@@ -359,24 +385,54 @@ rcPartialDataPut (rcPortalTransferInp_t *myInput)
 		toRead = toPut;
 	    } 
 
-	    bytesRead = myRead (srcFd, buf, toRead, FILE_DESC_TYPE, 
-	      &bytesRead, NULL);
-	    if (bytesRead != toRead) {
-		myInput->status = SYS_COPY_LEN_ERR - errno;
-		rodsLogError (LOG_ERROR, myInput->status,
-		  "rcPartialDataPut: toPut %lld, bytesRead %d",
-		  toPut, bytesRead);   
-		break;
-	    }
-	    bytesWritten = myWrite (destFd, buf, bytesRead, SOCK_TYPE,
-	      &bytesWritten);
-
-	    if (bytesWritten != bytesRead) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-		rodsLogError (LOG_ERROR, myInput->status,
-                  "rcPartialDataPut: toWrite %d, bytesWritten %d, errno = %d",
-                  bytesRead, bytesWritten, errno);
-                break;
+	    if (zeroCopy) {
+		bytesWritten = mySendfile (destFd, srcFd, toRead, NULL);
+		if (bytesWritten == SYS_NOT_SUPPORTED) {
+		    /* fall back to read/write for the rest */
+		    zeroCopy = 0;
+		    continue;
+		}
+		if (bytesWritten != toRead) {
+		    if (bytesWritten < 0) {
+		        myInput->status = bytesWritten;
+		    } else {
+		        myInput->status = SYS_COPY_LEN_ERR;
+		    }
+		    rodsLogError (LOG_ERROR, myInput->status,
+		      "rcPartialDataPut: toPut %lld, sendfile %d",
+		      toPut, bytesWritten);
+		    break;
+		}
+		myInput->zeroCopyBytes += bytesWritten;
+	    } else {
+		if (buf == NULL) {
+		    buf = malloc (TRANS_BUF_SZ);
+		}
+	        bytesRead = myRead (srcFd, buf, toRead, FILE_DESC_TYPE, 
+	          &bytesRead, NULL);
+	        if (bytesRead != toRead) {
+		    myInput->status = SYS_COPY_LEN_ERR - errno;
+		    rodsLogError (LOG_ERROR, myInput->status,
+		      "rcPartialDataPut: toPut %lld, bytesRead %d",
+		      toPut, bytesRead);   
+		    break;
+	        }
+	        bytesWritten = myWrite (destFd, buf, bytesRead, SOCK_TYPE,
+	          &bytesWritten);
+
+	        if (bytesWritten != bytesRead) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+		    rodsLogError (LOG_ERROR, myInput->status,
+                      "rcPartialDataPut: toWrite %d, bytesWritten %d, errno = %d",
+                      bytesRead, bytesWritten, errno);
+                    break;
+	        }
+		if (conn->inlineChksum != NULL) {
+		    updateInlineChksum (conn->inlineChksum,
+		      curOffset + myHeader.length - toPut,
+		      (unsigned char *) buf, bytesRead);
+		}
+		myInput->bufferedBytes += bytesWritten;
 	    }
 	    toPut -= bytesWritten;
 	    if (info->numSeg > 0) {     /* file restart */
@@ -408,7 +464,7 @@ rcPartialDataPut (rcPortalTransferInp_t *myInput)
         }
     }
 
-    free (buf);
+    if (buf != NULL) free (buf);
     close (srcFd);
     mySockClose (destFd);
 }
@@ -464,6 +520,10 @@ rodsLong_t dataSize)
 	    close (in_fd);
 	    return (SYS_COPY_LEN_ERR);
         } else {
+	    if (conn->inlineChksum != NULL) {
+		updateInlineChksum (conn->inlineChksum, totalWritten,
+		  (unsigned char *) dataObjWriteInpBBuf.buf, bytesWritten);
+	    }
             totalWritten += bytesWritten;
 	    conn->transStat.bytesWritten = totalWritten;
 	    if (info->numSeg > 0) {	/* file restart */
@@ -560,6 +620,10 @@ getIncludeFile (rcComm_t *conn, bytesBuf_t *dataObjOutBBuf, char *locFilePath)
         dataObjOutBBuf->len, bytesWritten, errno);
         return (SYS_COPY_LEN_ERR);
     } else {
+	if (conn->inlineChksum != NULL) {
+	    updateInlineChksum (conn->inlineChksum, 0,
+	      (unsigned char *) dataObjOutBBuf->buf, bytesWritten);
+	}
 	conn->transStat.bytesWritten = bytesWritten;
         return (0);
     }
@@ -626,6 +690,10 @@ rodsLong_t dataSize)
                 close (out_fd);
             return (SYS_COPY_LEN_ERR);
         } else {
+	    if (conn->inlineChksum != NULL) {
+		updateInlineChksum (conn->inlineChksum, totalWritten,
+		  (unsigned char *) dataObjReadInpBBuf.buf, bytesWritten);
+	    }
             totalWritten += bytesWritten;
 	    conn->transStat.bytesWritten = totalWritten;
             if (info->numSeg > 0) {     /* file restart */
@@ -758,6 +826,7 @@ char *locFilePath, char *objPath, rodsLong_t dataSize)
         }
         fillRcPortalTransferInp (conn, &myInput[0], out_fd, sock, 0640);
         rcPartialDataGet (&myInput[0]);
+        addPortalTransStat (conn, &myInput[0]);
         if (myInput[0].status < 0) {
             return (myInput[0].status);
         } else {
@@ -819,6 +888,7 @@ char *locFilePath, char *objPath, rodsLong_t dataSize)
 #endif
             }
             totalWritten += myInput[i].bytesWritten;
+            addPortalTransStat (conn, &myInput[i]);
             if (myInput[i].status < 0) {
                 retVal = myInput[i].status;
             }
@@ -860,6 +930,7 @@ rcPartialDataGet (rcPortalTransferInp_t *myInput)
     rcComm_t *conn;
     fileRestartInfo_t *info;
     int threadNum;
+    int zeroCopy;
 
 #ifdef PARA_DEBUG
     printf ("rcPartialDataGet: thread %d at start\n", myInput->threadNum);
@@ -878,7 +949,10 @@ rcPartialDataGet (rcPortalTransferInp_t *myInput)
     destFd = myInput->destFd;
     srcFd = myInput->srcFd;
 
-    buf = malloc (TRANS_BUF_SZ);
+    /* the buffer is only needed if splice can't be used. The data
+     * have to go through it to be chksummed */
+    buf = NULL;
+    zeroCopy = zeroCopyEnabled () && conn->inlineChksum == NULL;
 
     myInput->bytesWritten = 0;
 
@@ -927,24 +1001,54 @@ rcPartialDataGet (rcPortalTransferInp_t *myInput)
                 toRead = toGet;
             }
 
-            bytesRead = myRead (srcFd, buf, toRead, SOCK_TYPE, &bytesRead, 
-	      NULL);
-            if (bytesRead != toRead) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-                rodsLogError (LOG_ERROR, myInput->status,
-                  "rcPartialDataGet: toGet %lld, bytesRead %d",
-                  toGet, bytesRead);
-                break;
-            }
-            bytesWritten = myWrite (destFd, buf, bytesRead, FILE_DESC_TYPE,
-	      &bytesWritten);
-
-            if (bytesWritten != bytesRead) {
-                myInput->status = SYS_COPY_LEN_ERR - errno;
-                rodsLogError (LOG_ERROR, myInput->status,
-                  "rcPartialDataGet: toWrite %d, bytesWritten %d",
-                  bytesRead, bytesWritten);
-                break;
+            if (zeroCopy) {
+                bytesWritten = mySpliceToFile (srcFd, destFd, toRead, NULL);
+                if (bytesWritten == SYS_NOT_SUPPORTED) {
+                    /* fall back to read/write for the rest */
+                    zeroCopy = 0;
+                    continue;
+                }
+                if (bytesWritten != toRead) {
+                    if (bytesWritten < 0) {
+                        myInput->status = bytesWritten;
+                    } else {
+                        myInput->status = SYS_COPY_LEN_ERR;
+                    }
+                    rodsLogError (LOG_ERROR, myInput->status,
+                      "rcPartialDataGet: toGet %lld, splice %d",
+                      toGet, bytesWritten);
+                    break;
+                }
+                myInput->zeroCopyBytes += bytesWritten;
+            } else {
+                if (buf == NULL) {
+                    buf = malloc (TRANS_BUF_SZ);
+                }
+                bytesRead = myRead (srcFd, buf, toRead, SOCK_TYPE, 
+                  &bytesRead, NULL);
+                if (bytesRead != toRead) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+                    rodsLogError (LOG_ERROR, myInput->status,
+                      "rcPartialDataGet: toGet %lld, bytesRead %d",
+                      toGet, bytesRead);
+                    break;
+                }
+                bytesWritten = myWrite (destFd, buf, bytesRead, 
+                  FILE_DESC_TYPE, &bytesWritten);
+
+                if (bytesWritten != bytesRead) {
+                    myInput->status = SYS_COPY_LEN_ERR - errno;
+                    rodsLogError (LOG_ERROR, myInput->status,
+                      "rcPartialDataGet: toWrite %d, bytesWritten %d",
+                      bytesRead, bytesWritten);
+                    break;
+                }
+                if (conn->inlineChksum != NULL) {
+                    updateInlineChksum (conn->inlineChksum,
+                      curOffset + myHeader.length - toGet,
+                      (unsigned char *) buf, bytesRead);
+                }
+                myInput->bufferedBytes += bytesWritten;
             }
             toGet -= bytesWritten;
             if (info->numSeg > 0) {     /* file restart */
@@ -976,7 +1080,7 @@ rcPartialDataGet (rcPortalTransferInp_t *myInput)
 	}
     }
 
-    free (buf);
+    if (buf != NULL) free (buf);
     close (destFd);
     CLOSE_SOCK (srcFd);
 }
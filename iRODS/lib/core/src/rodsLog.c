@@ -165,6 +165,8 @@
     SYS_MSSO_EXTRACT_ALL_ERR, 
     SYS_MSSO_OPEN_ERR, 
     SYS_MSSO_CLOSE_ERR, 
+    SYS_RESC_CACHE_STALE, 
+    SYS_THREAD_CREATE_ERR, 
     USER_AUTH_SCHEME_ERR, 
     USER_AUTH_STRING_EMPTY, 
     USER_RODS_HOST_EMPTY, 
@@ -217,6 +219,8 @@
     SYMLINKED_BUNFILE_NOT_ALLOWED, 
     USER_INPUT_STRING_ERR, 
     USER_NOT_ALLOWED_TO_EXEC_CMD, 
+    USER_REQ_PIPELINE_ERR, 
+    USER_REQ_PIPELINE_FULL, 
     FILE_INDEX_LOOKUP_ERR, 
     UNIX_FILE_OPEN_ERR, 
     UNIX_FILE_CREATE_ERR, 
@@ -793,6 +797,8 @@
     "SYS_MSSO_EXTRACT_ALL_ERR", 
     "SYS_MSSO_OPEN_ERR", 
     "SYS_MSSO_CLOSE_ERR", 
+    "SYS_RESC_CACHE_STALE", 
+    "SYS_THREAD_CREATE_ERR", 
     "USER_AUTH_SCHEME_ERR", 
     "USER_AUTH_STRING_EMPTY", 
     "USER_RODS_HOST_EMPTY", 
@@ -845,6 +851,8 @@
     "SYMLINKED_BUNFILE_NOT_ALLOWED", 
     "USER_INPUT_STRING_ERR", 
     "USER_NOT_ALLOWED_TO_EXEC_CMD", 
+    "USER_REQ_PIPELINE_ERR", 
+    "USER_REQ_PIPELINE_FULL", 
     "FILE_INDEX_LOOKUP_ERR", 
     "UNIX_FILE_OPEN_ERR", 
     "UNIX_FILE_CREATE_ERR", 
@@ -0,0 +1,1009 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* rsyncManifest.c - the manifest mode of irsync from a local directory to
+ * a collection (irsync -r --manifest). Instead of a stat and a chksum
+ * round trip per file, the size and chksum of everything under the
+ * target collection are fetched with a few paged queries and compared
+ * with a walk of the local directory. Only the files that differ are
+ * then checked or sent, with a pool of connections.
+ */
+
+#ifndef windows_platform
+#include <sys/time.h>
+#include <pthread.h>
+#endif
+#include "rodsPath.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "rsyncUtil.h"
+#include "rsyncManifest.h"
+#include "miscUtil.h"
+
+/* the state shared by the threads of a manifest rsync */
+typedef struct {
+    rodsArguments_t *rodsArgs;
+    dataObjInp_t *dataObjOprInp;
+    char *srcDir;
+    char *targColl;
+    localTree_t *localTree;
+    chksumCache_t *chksumCache;
+    int hashType;
+    int nextInx;
+    int putCnt;
+    int syncCnt;
+    int matchCnt;
+    int status;
+#ifndef windows_platform
+    pthread_mutex_t lock;
+#endif
+} rsyncCtx_t;
+
+typedef struct {
+    rsyncCtx_t *rsyncCtx;
+    rcComm_t *conn;
+} rsyncThrInp_t;
+
+/* the state shared by the threads of the local walk */
+typedef struct {
+    char *srcDir;
+    rodsArguments_t *rodsArgs;
+    localTree_t *localTree;
+    char **dirStack;
+    int numStack;
+    int maxStack;
+    int busyCnt;
+    int status;
+#ifndef windows_platform
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} walkCtx_t;
+
+static void
+rsyncLock (rsyncCtx_t *rsyncCtx)
+{
+#ifndef windows_platform
+    pthread_mutex_lock (&rsyncCtx->lock);
+#endif
+}
+
+static void
+rsyncUnlock (rsyncCtx_t *rsyncCtx)
+{
+#ifndef windows_platform
+    pthread_mutex_unlock (&rsyncCtx->lock);
+#endif
+}
+
+static int
+growArray (void **array, int *maxCnt, int cnt, int entrySize)
+{
+    void *newArray;
+    int newMax;
+
+    if (cnt < *maxCnt) return 0;
+    newMax = *maxCnt > 0 ? *maxCnt * 2 : MAX_SQL_ROWS;
+    newArray = realloc (*array, (size_t) newMax * entrySize);
+    if (newArray == NULL) return (SYS_MALLOC_ERR);
+    *array = newArray;
+    *maxCnt = newMax;
+    return 0;
+}
+
+static int
+cmpManifestEntry (const void *ptr1, const void *ptr2)
+{
+    return (strcmp (((manifestEntry_t *) ptr1)->objPath,
+      ((manifestEntry_t *) ptr2)->objPath));
+}
+
+static int
+cmpStrPtr (const void *ptr1, const void *ptr2)
+{
+    return (strcmp (*(char **) ptr1, *(char **) ptr2));
+}
+
+/* getRsyncManifest - get the path, size and chksum of all the data objects
+ * and the paths of all the collections under targColl. One entry per path;
+ * if the replicas of a path differ, it is flagged MANIFEST_MIXED_REPL */
+
+int
+getRsyncManifest (rcComm_t *conn, char *targColl, rsyncManifest_t *manifest)
+{
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *collName, *dataName, *dataSize, *chksum;
+    char collQCond[MAX_NAME_LEN * 2];
+    char objPath[MAX_NAME_LEN];
+    manifestEntry_t *entry;
+    int i, j, status;
+
+    memset (manifest, 0, sizeof (rsyncManifest_t));
+    genAllInCollQCond (targColl, collQCond);
+
+    /* the data objects */
+    memset (&genQueryInp, 0, sizeof (genQueryInp));
+    addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
+    addInxIval (&genQueryInp.selectInp, COL_DATA_NAME, 1);
+    addInxIval (&genQueryInp.selectInp, COL_DATA_SIZE, 1);
+    addInxIval (&genQueryInp.selectInp, COL_D_DATA_CHECKSUM, 1);
+    addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, collQCond);
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    while (status >= 0 && genQueryOut != NULL) {
+        collName = getSqlResultByInx (genQueryOut, COL_COLL_NAME);
+        dataName = getSqlResultByInx (genQueryOut, COL_DATA_NAME);
+        dataSize = getSqlResultByInx (genQueryOut, COL_DATA_SIZE);
+        chksum = getSqlResultByInx (genQueryOut, COL_D_DATA_CHECKSUM);
+        if (collName == NULL || dataName == NULL || dataSize == NULL ||
+          chksum == NULL) {
+            status = UNMATCHED_KEY_OR_INDEX;
+            break;
+        }
+        for (i = 0; i < genQueryOut->rowCnt; i++) {
+            char *chksumStr = &chksum->value[chksum->len * i];
+            if ((status = growArray ((void **) &manifest->entries,
+              &manifest->maxEntries, manifest->numEntries,
+              sizeof (manifestEntry_t))) < 0) break;
+            snprintf (objPath, MAX_NAME_LEN, "%s/%s",
+              &collName->value[collName->len * i],
+              &dataName->value[dataName->len * i]);
+            entry = &manifest->entries[manifest->numEntries++];
+            entry->objPath = strdup (objPath);
+            entry->chksum = *chksumStr != '\0' ? strdup (chksumStr) : NULL;
+            entry->size = strtoll (&dataSize->value[dataSize->len * i], 0, 0);
+            entry->flags = 0;
+        }
+        if (status < 0 || genQueryOut->continueInx <= 0) break;
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut (&genQueryOut);
+        status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    }
+    if (genQueryOut != NULL && genQueryOut->continueInx > 0) {
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        genQueryInp.maxRows = 0;
+        freeGenQueryOut (&genQueryOut);
+        rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    }
+    if (genQueryOut != NULL) freeGenQueryOut (&genQueryOut);
+    clearGenQueryInp (&genQueryInp);
+    if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+        rodsLogError (LOG_ERROR, status,
+          "getRsyncManifest: query of data in %s error", targColl);
+        clearRsyncManifest (manifest);
+        return (status);
+    }
+
+    /* one entry per path */
+    if (manifest->numEntries > 0) {
+        qsort (manifest->entries, manifest->numEntries,
+          sizeof (manifestEntry_t), cmpManifestEntry);
+        for (i = 0, j = 1; j < manifest->numEntries; j++) {
+            manifestEntry_t *prev = &manifest->entries[i];
+            entry = &manifest->entries[j];
+            if (strcmp (prev->objPath, entry->objPath) == 0) {
+                if (prev->size != entry->size ||
+                  (prev->chksum == NULL) != (entry->chksum == NULL) ||
+                  (prev->chksum != NULL &&
+                  strcmp (prev->chksum, entry->chksum) != 0)) {
+                    prev->flags |= MANIFEST_MIXED_REPL;
+                }
+                free (entry->objPath);
+                if (entry->chksum != NULL) free (entry->chksum);
+            } else {
+                manifest->entries[++i] = *entry;
+            }
+        }
+        manifest->numEntries = i + 1;
+    }
+
+    /* the collections */
+    memset (&genQueryInp, 0, sizeof (genQueryInp));
+    addInxIval (&genQueryInp.selectInp, COL_COLL_NAME, 1);
+    addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, collQCond);
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    while (status >= 0 && genQueryOut != NULL) {
+        if ((collName = getSqlResultByInx (genQueryOut, COL_COLL_NAME)) ==
+          NULL) {
+            status = UNMATCHED_KEY_OR_INDEX;
+            break;
+        }
+        for (i = 0; i < genQueryOut->rowCnt; i++) {
+            if ((status = growArray ((void **) &manifest->colls,
+              &manifest->maxColls, manifest->numColls,
+              sizeof (char *))) < 0) break;
+            manifest->colls[manifest->numColls++] =
+              strdup (&collName->value[collName->len * i]);
+        }
+        if (status < 0 || genQueryOut->continueInx <= 0) break;
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut (&genQueryOut);
+        status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    }
+    if (genQueryOut != NULL && genQueryOut->continueInx > 0) {
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        genQueryInp.maxRows = 0;
+        freeGenQueryOut (&genQueryOut);
+        rcGenQuery (conn, &genQueryInp, &genQueryOut);
+    }
+    if (genQueryOut != NULL) freeGenQueryOut (&genQueryOut);
+    clearGenQueryInp (&genQueryInp);
+    if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+        rodsLogError (LOG_ERROR, status,
+          "getRsyncManifest: query of colls in %s error", targColl);
+        clearRsyncManifest (manifest);
+        return (status);
+    }
+    if (manifest->numColls > 0) {
+        qsort (manifest->colls, manifest->numColls, sizeof (char *),
+          cmpStrPtr);
+    }
+
+    return (0);
+}
+
+manifestEntry_t *
+findManifestEntry (rsyncManifest_t *manifest, char *objPath)
+{
+    manifestEntry_t key;
+
+    if (manifest->numEntries <= 0) return (NULL);
+    key.objPath = objPath;
+    return ((manifestEntry_t *) bsearch (&key, manifest->entries,
+      manifest->numEntries, sizeof (manifestEntry_t), cmpManifestEntry));
+}
+
+int
+findManifestColl (rsyncManifest_t *manifest, char *collPath)
+{
+    if (manifest->numColls <= 0) return (0);
+    return (bsearch (&collPath, manifest->colls, manifest->numColls,
+      sizeof (char *), cmpStrPtr) != NULL);
+}
+
+int
+clearRsyncManifest (rsyncManifest_t *manifest)
+{
+    int i;
+
+    for (i = 0; i < manifest->numEntries; i++) {
+        free (manifest->entries[i].objPath);
+        if (manifest->entries[i].chksum != NULL)
+            free (manifest->entries[i].chksum);
+    }
+    if (manifest->entries != NULL) free (manifest->entries);
+    for (i = 0; i < manifest->numColls; i++) {
+        free (manifest->colls[i]);
+    }
+    if (manifest->colls != NULL) free (manifest->colls);
+    memset (manifest, 0, sizeof (rsyncManifest_t));
+    return (0);
+}
+
+#ifndef windows_platform
+/* walkDir - scan one directory of the walk. The files and subdirs found
+ * are added to the tree and the subdirs pushed on the stack */
+
+static int
+walkDir (walkCtx_t *walkCtx, char *relDir)
+{
+    char dirPath[MAX_NAME_LEN], myPath[MAX_NAME_LEN], relPath[MAX_NAME_LEN];
+    localTree_t *localTree = walkCtx->localTree;
+    rodsArguments_t *rodsArgs = walkCtx->rodsArgs;
+    DIR *dirPtr;
+    struct dirent *myDirent;
+    struct stat statbuf;
+    localFileEnt_t *fileEnt;
+    int status = 0;
+
+    if (*relDir == '\0') {
+        rstrcpy (dirPath, walkCtx->srcDir, MAX_NAME_LEN);
+    } else {
+        snprintf (dirPath, MAX_NAME_LEN, "%s/%s", walkCtx->srcDir, relDir);
+    }
+
+    if ((dirPtr = opendir (dirPath)) == NULL) {
+        rodsLog (LOG_ERROR,
+          "walkDir: opendir local dir error for %s, errno = %d\n",
+          dirPath, errno);
+        return (USER_INPUT_PATH_ERR);
+    }
+
+    while ((myDirent = readdir (dirPtr)) != NULL) {
+        if (strcmp (myDirent->d_name, ".") == 0 ||
+          strcmp (myDirent->d_name, "..") == 0) {
+            continue;
+        }
+        if (snprintf (myPath, MAX_NAME_LEN, "%s/%s", dirPath,
+          myDirent->d_name) >= MAX_NAME_LEN) {
+            rodsLog (LOG_ERROR,
+              "walkDir: path of %s in %s is too long", myDirent->d_name,
+              dirPath);
+            status = USER_PATH_EXCEEDS_MAX;
+            continue;
+        }
+        if (*relDir == '\0') {
+            rstrcpy (relPath, myDirent->d_name, MAX_NAME_LEN);
+        } else {
+            snprintf (relPath, MAX_NAME_LEN, "%s/%s", relDir,
+              myDirent->d_name);
+        }
+        if (isPathSymlink (rodsArgs, myPath) > 0) continue;
+        if (stat (myPath, &statbuf) != 0) {
+            rodsLog (LOG_ERROR,
+              "walkDir: stat error for %s, errno = %d\n", myPath, errno);
+            status = USER_INPUT_PATH_ERR;
+            continue;
+        }
+
+        if ((statbuf.st_mode & S_IFREG) != 0) {
+            if (rodsArgs->age == True && ageExceeded (rodsArgs->agevalue,
+              statbuf.st_mtime, rodsArgs->verbose, myPath, statbuf.st_size))
+                continue;
+            pthread_mutex_lock (&walkCtx->lock);
+            if (growArray ((void **) &localTree->files, &localTree->maxFiles,
+              localTree->numFiles, sizeof (localFileEnt_t)) < 0) {
+                pthread_mutex_unlock (&walkCtx->lock);
+                status = SYS_MALLOC_ERR;
+                break;
+            }
+            fileEnt = &localTree->files[localTree->numFiles++];
+            memset (fileEnt, 0, sizeof (localFileEnt_t));
+            fileEnt->relPath = strdup (relPath);
+            fileEnt->size = statbuf.st_size;
+            fileEnt->inode = statbuf.st_ino;
+            fileEnt->mtime = statbuf.st_mtime;
+            fileEnt->mode = statbuf.st_mode;
+            pthread_mutex_unlock (&walkCtx->lock);
+        } else if ((statbuf.st_mode & S_IFDIR) != 0) {
+            pthread_mutex_lock (&walkCtx->lock);
+            if (growArray ((void **) &localTree->dirs, &localTree->maxDirs,
+              localTree->numDirs, sizeof (char *)) < 0 ||
+              growArray ((void **) &walkCtx->dirStack, &walkCtx->maxStack,
+              walkCtx->numStack, sizeof (char *)) < 0) {
+                pthread_mutex_unlock (&walkCtx->lock);
+                status = SYS_MALLOC_ERR;
+                break;
+            }
+            localTree->dirs[localTree->numDirs++] = strdup (relPath);
+            walkCtx->dirStack[walkCtx->numStack++] = strdup (relPath);
+            pthread_cond_signal (&walkCtx->cond);
+            pthread_mutex_unlock (&walkCtx->lock);
+        } else {
+            rodsLog (LOG_ERROR,
+              "walkDir: unknown local path type %d for %s",
+              statbuf.st_mode, myPath);
+            status = USER_INPUT_PATH_ERR;
+        }
+    }
+    closedir (dirPtr);
+    return (status);
+}
+
+static void *
+walkThr (void *arg)
+{
+    walkCtx_t *walkCtx = (walkCtx_t *) arg;
+    char *relDir;
+    int status;
+
+    pthread_mutex_lock (&walkCtx->lock);
+    while (1) {
+        while (walkCtx->numStack == 0 && walkCtx->busyCnt > 0) {
+            pthread_cond_wait (&walkCtx->cond, &walkCtx->lock);
+        }
+        if (walkCtx->numStack == 0) {
+            /* nothing queued and nobody can queue more. done */
+            pthread_cond_broadcast (&walkCtx->cond);
+            break;
+        }
+        relDir = walkCtx->dirStack[--walkCtx->numStack];
+        walkCtx->busyCnt++;
+        pthread_mutex_unlock (&walkCtx->lock);
+
+        status = walkDir (walkCtx, relDir);
+        free (relDir);
+
+        pthread_mutex_lock (&walkCtx->lock);
+        if (status < 0) walkCtx->status = status;
+        walkCtx->busyCnt--;
+        if (walkCtx->busyCnt == 0) pthread_cond_broadcast (&walkCtx->cond);
+    }
+    pthread_mutex_unlock (&walkCtx->lock);
+    return (NULL);
+}
+#endif	/* windows_platform */
+
+/* walkLocalTree - list the files and dirs under srcDir with numThr
+ * threads, each scanning a directory at a time */
+
+int
+walkLocalTree (char *srcDir, rodsArguments_t *rodsArgs, int numThr,
+localTree_t *localTree)
+{
+#ifndef windows_platform
+    walkCtx_t walkCtx;
+    pthread_t tid[MAX_RSYNC_NUM_CONN];
+    int i, numStarted = 0;
+
+    memset (localTree, 0, sizeof (localTree_t));
+    memset (&walkCtx, 0, sizeof (walkCtx));
+    walkCtx.srcDir = srcDir;
+    walkCtx.rodsArgs = rodsArgs;
+    walkCtx.localTree = localTree;
+    pthread_mutex_init (&walkCtx.lock, NULL);
+    pthread_cond_init (&walkCtx.cond, NULL);
+    growArray ((void **) &walkCtx.dirStack, &walkCtx.maxStack, 0,
+      sizeof (char *));
+    walkCtx.dirStack[walkCtx.numStack++] = strdup ("");
+
+    if (numThr > MAX_RSYNC_NUM_CONN) numThr = MAX_RSYNC_NUM_CONN;
+    for (i = 1; i < numThr; i++) {
+        if (pthread_create (&tid[numStarted], NULL, walkThr, &walkCtx) == 0)
+            numStarted++;
+    }
+    walkThr (&walkCtx);
+    for (i = 0; i < numStarted; i++) {
+        pthread_join (tid[i], NULL);
+    }
+
+    free (walkCtx.dirStack);
+    pthread_mutex_destroy (&walkCtx.lock);
+    pthread_cond_destroy (&walkCtx.cond);
+
+    if (localTree->numDirs > 0) {
+        qsort (localTree->dirs, localTree->numDirs, sizeof (char *),
+          cmpStrPtr);
+    }
+    return (walkCtx.status);
+#else
+    return (SYS_NOT_SUPPORTED);
+#endif
+}
+
+int
+clearLocalTree (localTree_t *localTree)
+{
+    int i;
+
+    for (i = 0; i < localTree->numFiles; i++) {
+        free (localTree->files[i].relPath);
+    }
+    if (localTree->files != NULL) free (localTree->files);
+    for (i = 0; i < localTree->numDirs; i++) {
+        free (localTree->dirs[i]);
+    }
+    if (localTree->dirs != NULL) free (localTree->dirs);
+    memset (localTree, 0, sizeof (localTree_t));
+    return (0);
+}
+
+/* the cache is sorted by inode and hash type first so that all the
+ * entries of a file are together */
+
+static int
+cmpChksumCacheInode (const void *ptr1, const void *ptr2)
+{
+    chksumCacheEntry_t *entry1 = (chksumCacheEntry_t *) ptr1;
+    chksumCacheEntry_t *entry2 = (chksumCacheEntry_t *) ptr2;
+
+    if (entry1->inode != entry2->inode)
+        return (entry1->inode < entry2->inode ? -1 : 1);
+    return (entry1->hashType - entry2->hashType);
+}
+
+static int
+cmpChksumCacheEntry (const void *ptr1, const void *ptr2)
+{
+    chksumCacheEntry_t *entry1 = (chksumCacheEntry_t *) ptr1;
+    chksumCacheEntry_t *entry2 = (chksumCacheEntry_t *) ptr2;
+    int status;
+
+    if ((status = cmpChksumCacheInode (ptr1, ptr2)) != 0) return (status);
+    if (entry1->mtime != entry2->mtime)
+        return (entry1->mtime < entry2->mtime ? -1 : 1);
+    if (entry1->size != entry2->size)
+        return (entry1->size < entry2->size ? -1 : 1);
+    return (0);
+}
+
+/* loadChksumCache - load the chksum cache file. A missing file is an
+ * empty cache. The file is a header line followed by one
+ * "inode size mtime hashType chksum" line per file */
+
+int
+loadChksumCache (char *fileName, chksumCache_t *chksumCache)
+{
+    FILE *fptr;
+    char buf[MAX_NAME_LEN];
+    chksumCacheEntry_t myEntry;
+
+    memset (chksumCache, 0, sizeof (chksumCache_t));
+    chksumCache->fileName = fileName;
+
+    if ((fptr = fopen (fileName, "r")) == NULL) return (0);
+
+    if (fgets (buf, MAX_NAME_LEN, fptr) == NULL ||
+      strncmp (buf, CHKSUM_CACHE_MAGIC, strlen (CHKSUM_CACHE_MAGIC)) != 0) {
+        rodsLog (LOG_NOTICE,
+          "loadChksumCache: %s is not a chksum cache. Starting over",
+          fileName);
+        fclose (fptr);
+        return (0);
+    }
+    while (fgets (buf, MAX_NAME_LEN, fptr) != NULL) {
+        memset (&myEntry, 0, sizeof (myEntry));
+        if (sscanf (buf, "%lld %lld %d %d %63s", &myEntry.inode,
+          &myEntry.size, &myEntry.mtime, &myEntry.hashType,
+          myEntry.chksum) != 5) continue;
+        if (growArray ((void **) &chksumCache->entries,
+          &chksumCache->maxEntries, chksumCache->numEntries,
+          sizeof (chksumCacheEntry_t)) < 0) break;
+        chksumCache->entries[chksumCache->numEntries++] = myEntry;
+    }
+    fclose (fptr);
+
+    if (chksumCache->numEntries > 0) {
+        qsort (chksumCache->entries, chksumCache->numEntries,
+          sizeof (chksumCacheEntry_t), cmpChksumCacheEntry);
+    }
+    chksumCache->sortedCnt = chksumCache->numEntries;
+
+    return (chksumCache->numEntries);
+}
+
+/* saveChksumCache - write the cache back. A loaded entry is dropped if
+ * a chksum of the same inode was computed in this run since the file has
+ * changed */
+
+int
+saveChksumCache (chksumCache_t *chksumCache)
+{
+    char tmpPath[MAX_NAME_LEN];
+    chksumCacheEntry_t *entry, *newEntries;
+    FILE *fptr;
+    int i, numNew, status = 0;
+
+    if (chksumCache->fileName == NULL ||
+      chksumCache->numEntries == chksumCache->sortedCnt) {
+        /* nothing new */
+        return (0);
+    }
+
+    newEntries = &chksumCache->entries[chksumCache->sortedCnt];
+    numNew = chksumCache->numEntries - chksumCache->sortedCnt;
+    qsort (newEntries, numNew, sizeof (chksumCacheEntry_t),
+      cmpChksumCacheEntry);
+
+    snprintf (tmpPath, MAX_NAME_LEN, "%s.%d", chksumCache->fileName,
+      getpid ());
+    if ((fptr = fopen (tmpPath, "w")) == NULL) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_ERROR, status,
+          "saveChksumCache: fopen error for %s", tmpPath);
+        return (status);
+    }
+    fprintf (fptr, "%s\n", CHKSUM_CACHE_MAGIC);
+    for (i = 0; i < chksumCache->sortedCnt; i++) {
+        entry = &chksumCache->entries[i];
+        if (bsearch (entry, newEntries, numNew, sizeof (chksumCacheEntry_t),
+          cmpChksumCacheInode) != NULL) continue;
+        fprintf (fptr, "%lld %lld %d %d %s\n", entry->inode, entry->size,
+          entry->mtime, entry->hashType, entry->chksum);
+    }
+    for (i = 0; i < numNew; i++) {
+        entry = &newEntries[i];
+        /* the same file may be seen more than once. keep the last */
+        if (i + 1 < numNew &&
+          cmpChksumCacheInode (entry, &newEntries[i + 1]) == 0) continue;
+        fprintf (fptr, "%lld %lld %d %d %s\n", entry->inode, entry->size,
+          entry->mtime, entry->hashType, entry->chksum);
+    }
+    if (fclose (fptr) != 0 || rename (tmpPath, chksumCache->fileName) < 0) {
+        status = UNIX_FILE_WRITE_ERR - errno;
+        rodsLogError (LOG_ERROR, status,
+          "saveChksumCache: write of %s error", chksumCache->fileName);
+        unlink (tmpPath);
+    }
+    return (status);
+}
+
+int
+clearChksumCache (chksumCache_t *chksumCache)
+{
+    if (chksumCache->entries != NULL) free (chksumCache->entries);
+    memset (chksumCache, 0, sizeof (chksumCache_t));
+    return (0);
+}
+
+/* getLocalChksum - the chksum of a local file, from the cache if the file
+ * has not changed since it was cached */
+
+static int
+getLocalChksum (rsyncCtx_t *rsyncCtx, localFileEnt_t *fileEnt, char *filePath,
+char *chksumStr)
+{
+    chksumCache_t *chksumCache = rsyncCtx->chksumCache;
+    chksumCacheEntry_t myEntry, *entry = NULL;
+    int status;
+
+    memset (&myEntry, 0, sizeof (myEntry));
+    myEntry.inode = fileEnt->inode;
+    myEntry.size = fileEnt->size;
+    myEntry.mtime = fileEnt->mtime;
+    myEntry.hashType = rsyncCtx->hashType;
+
+    if (chksumCache != NULL) {
+        /* the loaded part is not changed, but another thread may move
+         * the entries when it adds one */
+        rsyncLock (rsyncCtx);
+        if (chksumCache->sortedCnt > 0) {
+            entry = (chksumCacheEntry_t *) bsearch (&myEntry,
+              chksumCache->entries, chksumCache->sortedCnt,
+              sizeof (chksumCacheEntry_t), cmpChksumCacheEntry);
+            if (entry != NULL) rstrcpy (chksumStr, entry->chksum, CHKSUM_LEN);
+        }
+        rsyncUnlock (rsyncCtx);
+        if (entry != NULL) return (0);
+    }
+
+    status = chksumLocFile (filePath, chksumStr, rsyncCtx->hashType);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "getLocalChksum: chksumLocFile error for %s", filePath);
+        return (status);
+    }
+
+    if (chksumCache != NULL) {
+        rstrcpy (myEntry.chksum, chksumStr, CHKSUM_LEN);
+        rsyncLock (rsyncCtx);
+        if (growArray ((void **) &chksumCache->entries,
+          &chksumCache->maxEntries, chksumCache->numEntries,
+          sizeof (chksumCacheEntry_t)) >= 0) {
+            chksumCache->entries[chksumCache->numEntries++] = myEntry;
+        }
+        rsyncUnlock (rsyncCtx);
+    }
+    return (0);
+}
+
+/* rsyncManifestFile - check and send one local file according to its
+ * action */
+
+static int
+rsyncManifestFile (rcComm_t *conn, rsyncCtx_t *rsyncCtx,
+localFileEnt_t *fileEnt, dataObjInp_t *dataObjOprInp)
+{
+    rodsArguments_t *rodsArgs = rsyncCtx->rodsArgs;
+    char srcFile[MAX_NAME_LEN], objPath[MAX_NAME_LEN];
+    char chksumStr[CHKSUM_LEN];
+    struct timeval startTime, endTime;
+    int action = fileEnt->action;
+    int status = 0;
+
+    snprintf (srcFile, MAX_NAME_LEN, "%s/%s", rsyncCtx->srcDir,
+      fileEnt->relPath);
+    snprintf (objPath, MAX_NAME_LEN, "%s/%s", rsyncCtx->targColl,
+      fileEnt->relPath);
+
+    if (action == RSYNC_ACT_OBJSTAT) {
+        /* the replicas differ. Do what rsyncDirToCollUtil does */
+        rodsPath_t mySrcPath, myTargPath;
+
+        memset (&mySrcPath, 0, sizeof (mySrcPath));
+        memset (&myTargPath, 0, sizeof (myTargPath));
+        rstrcpy (mySrcPath.outPath, srcFile, MAX_NAME_LEN);
+        mySrcPath.objType = LOCAL_FILE_T;
+        mySrcPath.objState = EXIST_ST;
+        mySrcPath.size = fileEnt->size;
+        rstrcpy (myTargPath.outPath, objPath, MAX_NAME_LEN);
+        myTargPath.objType = DATA_OBJ_T;
+        dataObjOprInp->createMode = fileEnt->mode;
+        getRodsObjType (conn, &myTargPath);
+        status = rsyncFileToDataUtil (conn, &mySrcPath, &myTargPath,
+          NULL, rodsArgs, dataObjOprInp);
+        if (myTargPath.rodsObjStat != NULL) {
+            freeRodsObjStat (myTargPath.rodsObjStat);
+            myTargPath.rodsObjStat = NULL;
+        }
+        return (status);
+    }
+
+    if (rodsArgs->verbose == True) {
+        (void) gettimeofday(&startTime, (struct timezone *)0);
+        bzero (&conn->transStat, sizeof (transStat_t));
+    }
+
+    if (action == RSYNC_ACT_CHKSUM || action == RSYNC_ACT_RSYNC) {
+        if ((status = getLocalChksum (rsyncCtx, fileEnt, srcFile,
+          chksumStr)) < 0) return (status);
+        if (action == RSYNC_ACT_CHKSUM) {
+            if (strcmp (chksumStr, fileEnt->manifestEntry->chksum) == 0) {
+                rsyncLock (rsyncCtx);
+                rsyncCtx->matchCnt++;
+                rsyncUnlock (rsyncCtx);
+                if (rodsArgs->verbose == True)
+                    printNoSync (srcFile, fileEnt->size, "a match");
+                return (0);
+            }
+            action = RSYNC_ACT_PUT;
+        }
+        if (rodsArgs->verifyChecksum == True) {
+            addKeyVal (&dataObjOprInp->condInput, VERIFY_CHKSUM_KW,
+              chksumStr);
+        }
+    }
+
+    rstrcpy (dataObjOprInp->objPath, objPath, MAX_NAME_LEN);
+    dataObjOprInp->dataSize = fileEnt->size;
+    dataObjOprInp->openFlags = O_WRONLY;
+    dataObjOprInp->createMode = fileEnt->mode;
+#ifdef FILESYSTEM_META
+    getFileMetaFromPath (srcFile, &dataObjOprInp->condInput);
+#endif
+
+    if (rodsArgs->longOption == True) {
+        /* only list what would be synced */
+        printf ("%s   %lld   N\n", srcFile, fileEnt->size);
+    } else if (action == RSYNC_ACT_PUT) {
+        status = rcDataObjPut (conn, dataObjOprInp, srcFile);
+    } else {
+        addKeyVal (&dataObjOprInp->condInput, RSYNC_CHKSUM_KW, chksumStr);
+        addKeyVal (&dataObjOprInp->condInput, RSYNC_DEST_PATH_KW, srcFile);
+        addKeyVal (&dataObjOprInp->condInput, RSYNC_MODE_KW, IRODS_TO_LOCAL);
+        status = rcDataObjRsync (conn, dataObjOprInp);
+        rmKeyVal (&dataObjOprInp->condInput, RSYNC_CHKSUM_KW);
+        rmKeyVal (&dataObjOprInp->condInput, RSYNC_DEST_PATH_KW);
+        rmKeyVal (&dataObjOprInp->condInput, RSYNC_MODE_KW);
+    }
+    rmKeyVal (&dataObjOprInp->condInput, VERIFY_CHKSUM_KW);
+
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "rsyncManifestFile: sync of %s to %s failed", srcFile, objPath);
+        return (status);
+    }
+
+    rsyncLock (rsyncCtx);
+    if (action == RSYNC_ACT_PUT) {
+        rsyncCtx->putCnt++;
+    } else {
+        rsyncCtx->syncCnt++;
+    }
+    rsyncUnlock (rsyncCtx);
+
+    if (rodsArgs->verbose == True) {
+        if (action == RSYNC_ACT_PUT || status == SYS_RSYNC_TARGET_MODIFIED) {
+            (void) gettimeofday(&endTime, (struct timezone *)0);
+            printTiming (conn, srcFile, fileEnt->size, objPath,
+              &startTime, &endTime);
+        } else {
+            printNoSync (srcFile, fileEnt->size, "a match");
+        }
+    }
+    return (status);
+}
+
+/* rsyncManifestThr - process the files with an action, one at a time,
+ * until none is left */
+
+static void *
+rsyncManifestThr (void *arg)
+{
+    rsyncThrInp_t *rsyncThrInp = (rsyncThrInp_t *) arg;
+    rsyncCtx_t *rsyncCtx = rsyncThrInp->rsyncCtx;
+    localTree_t *localTree = rsyncCtx->localTree;
+    dataObjInp_t myDataObjInp;
+    int inx, status;
+
+    /* the condInput gets changed per file */
+    myDataObjInp = *rsyncCtx->dataObjOprInp;
+    memset (&myDataObjInp.condInput, 0, sizeof (keyValPair_t));
+    replKeyVal (&rsyncCtx->dataObjOprInp->condInput, &myDataObjInp.condInput);
+
+    while (1) {
+        rsyncLock (rsyncCtx);
+        while (rsyncCtx->nextInx < localTree->numFiles &&
+          localTree->files[rsyncCtx->nextInx].action == RSYNC_ACT_NONE)
+            rsyncCtx->nextInx++;
+        inx = rsyncCtx->nextInx++;
+        rsyncUnlock (rsyncCtx);
+        if (inx >= localTree->numFiles) break;
+
+        status = rsyncManifestFile (rsyncThrInp->conn, rsyncCtx,
+          &localTree->files[inx], &myDataObjInp);
+        if (status < 0) {
+            rsyncLock (rsyncCtx);
+            rsyncCtx->status = status;
+            rsyncUnlock (rsyncCtx);
+        }
+    }
+    clearKeyVal (&myDataObjInp.condInput);
+    return (NULL);
+}
+
+/* rsyncDirToCollByManifest - irsync a local dir to a collection in the
+ * manifest mode */
+
+int
+rsyncDirToCollByManifest (rcComm_t *conn, rodsPath_t *srcPath,
+rodsPath_t *targPath, rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs,
+dataObjInp_t *dataObjOprInp)
+{
+    rsyncManifest_t manifest;
+    localTree_t localTree;
+    chksumCache_t chksumCache;
+    rsyncCtx_t rsyncCtx;
+    rsyncThrInp_t rsyncThrInp[MAX_RSYNC_NUM_CONN];
+    char objPath[MAX_NAME_LEN], dirPath[MAX_NAME_LEN];
+    manifestEntry_t *entry;
+    localFileEnt_t *fileEnt;
+    int numConn, i, status;
+    int savedStatus = 0;
+    int todoCnt = 0;
+#ifndef windows_platform
+    pthread_t tid[MAX_RSYNC_NUM_CONN];
+    int numStarted = 0;
+#endif
+
+    if (srcPath == NULL || targPath == NULL) {
+       rodsLog (LOG_ERROR,
+          "rsyncDirToCollByManifest: NULL srcPath or targPath input");
+        return (USER__NULL_INPUT_ERR);
+    }
+    if (rodsArgs->recursive != True) {
+        rodsLog (LOG_ERROR,
+        "rsyncDirToCollByManifest: -r option must be used for putting %s directory",
+         srcPath->outPath);
+        return (USER_INPUT_OPTION_ERR);
+    }
+    if (isPathSymlink (rodsArgs, srcPath->outPath) > 0) return 0;
+
+    numConn = DEF_RSYNC_NUM_CONN;
+    if (rodsArgs->jobs == True && rodsArgs->jobsValue > 0)
+        numConn = rodsArgs->jobsValue;
+    if (numConn > MAX_RSYNC_NUM_CONN) numConn = MAX_RSYNC_NUM_CONN;
+
+    if ((status = getRsyncManifest (conn, targPath->outPath, &manifest)) < 0)
+        return (status);
+    status = walkLocalTree (srcPath->outPath, rodsArgs, numConn, &localTree);
+    if (status < 0) savedStatus = status;
+    if (rodsArgs->verbose == True) {
+        fprintf (stdout,
+          "C- %s: %d data objects, %d collections. %s: %d files, %d dirs\n",
+          targPath->outPath, manifest.numEntries, manifest.numColls,
+          srcPath->outPath, localTree.numFiles, localTree.numDirs);
+    }
+
+    /* make the missing collections. parents sort before children */
+    for (i = 0; i < localTree.numDirs; i++) {
+        if (snprintf (objPath, MAX_NAME_LEN, "%s/%s", targPath->outPath,
+          localTree.dirs[i]) >= MAX_NAME_LEN) {
+            rodsLog (LOG_ERROR,
+              "rsyncDirToCollByManifest: coll path for %s is too long",
+              localTree.dirs[i]);
+            savedStatus = USER_PATH_EXCEEDS_MAX;
+            continue;
+        }
+        if (findManifestColl (&manifest, objPath) ||
+          rodsArgs->longOption == True) continue;
+#ifdef FILESYSTEM_META
+        snprintf (dirPath, MAX_NAME_LEN, "%s/%s", srcPath->outPath,
+          localTree.dirs[i]);
+        status = mkCollWithDirMeta (conn, objPath, dirPath);
+#else
+        status = mkColl (conn, objPath);
+#endif
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status,
+              "rsyncDirToCollByManifest: mkColl error for %s", objPath);
+            savedStatus = status;
+        }
+    }
+
+    /* what has to be done for each file */
+    for (i = 0; i < localTree.numFiles; i++) {
+        fileEnt = &localTree.files[i];
+        if (snprintf (objPath, MAX_NAME_LEN, "%s/%s", targPath->outPath,
+          fileEnt->relPath) >= MAX_NAME_LEN) {
+            rodsLog (LOG_ERROR,
+              "rsyncDirToCollByManifest: obj path for %s is too long",
+              fileEnt->relPath);
+            savedStatus = USER_PATH_EXCEEDS_MAX;
+            fileEnt->action = RSYNC_ACT_NONE;
+            continue;
+        }
+        entry = findManifestEntry (&manifest, objPath);
+        fileEnt->manifestEntry = entry;
+        if (entry == NULL) {
+            fileEnt->action = RSYNC_ACT_PUT;
+        } else if ((entry->flags & MANIFEST_MIXED_REPL) != 0) {
+            fileEnt->action = RSYNC_ACT_OBJSTAT;
+        } else if (entry->size != fileEnt->size) {
+            fileEnt->action = RSYNC_ACT_PUT;
+        } else if (rodsArgs->sizeFlag == True) {
+            fileEnt->action = RSYNC_ACT_NONE;
+            /* walkDir checked the length of the local path */
+            if (rodsArgs->verbose == True &&
+              snprintf (dirPath, MAX_NAME_LEN, "%s/%s", srcPath->outPath,
+              fileEnt->relPath) < MAX_NAME_LEN) {
+                printNoSync (dirPath, fileEnt->size, "a match");
+            }
+        } else if (entry->chksum != NULL) {
+            fileEnt->action = RSYNC_ACT_CHKSUM;
+        } else {
+            fileEnt->action = RSYNC_ACT_RSYNC;
+        }
+        if (fileEnt->action != RSYNC_ACT_NONE) todoCnt++;
+    }
+
+    memset (&chksumCache, 0, sizeof (chksumCache));
+    if (rodsArgs->chksumCache == True && rodsArgs->chksumCacheString != NULL)
+        loadChksumCache (rodsArgs->chksumCacheString, &chksumCache);
+
+    memset (&rsyncCtx, 0, sizeof (rsyncCtx));
+    rsyncCtx.rodsArgs = rodsArgs;
+    rsyncCtx.dataObjOprInp = dataObjOprInp;
+    rsyncCtx.srcDir = srcPath->outPath;
+    rsyncCtx.targColl = targPath->outPath;
+    rsyncCtx.localTree = &localTree;
+    rsyncCtx.chksumCache = rodsArgs->chksumCache == True ? &chksumCache : NULL;
+    rsyncCtx.hashType = extractHashFunction3 (rodsArgs);
+
+    /* no more connections than there is work */
+    if (numConn > todoCnt) numConn = todoCnt > 0 ? todoCnt : 1;
+    rsyncThrInp[0].rsyncCtx = &rsyncCtx;
+    rsyncThrInp[0].conn = conn;
+#ifndef windows_platform
+    pthread_mutex_init (&rsyncCtx.lock, NULL);
+    for (i = 1; i < numConn; i++) {
+        rErrMsg_t errMsg;
+        rcComm_t *myConn;
+
+        myConn = rcConnect (myRodsEnv->rodsHost, myRodsEnv->rodsPort,
+          myRodsEnv->rodsUserName, myRodsEnv->rodsZone, 0, &errMsg);
+        if (myConn == NULL) break;
+        if (clientLogin (myConn) != 0) {
+            rcDisconnect (myConn);
+            break;
+        }
+        rsyncThrInp[numStarted + 1].rsyncCtx = &rsyncCtx;
+        rsyncThrInp[numStarted + 1].conn = myConn;
+        if (pthread_create (&tid[numStarted], NULL, rsyncManifestThr,
+          &rsyncThrInp[numStarted + 1]) != 0) {
+            rcDisconnect (myConn);
+            break;
+        }
+        numStarted++;
+    }
+#endif
+    rsyncManifestThr (&rsyncThrInp[0]);
+#ifndef windows_platform
+    for (i = 0; i < numStarted; i++) {
+        pthread_join (tid[i], NULL);
+        printErrorStack (rsyncThrInp[i + 1].conn->rError);
+        rcDisconnect (rsyncThrInp[i + 1].conn);
+    }
+    pthread_mutex_destroy (&rsyncCtx.lock);
+#endif
+    if (rsyncCtx.status < 0) savedStatus = rsyncCtx.status;
+
+    if (rodsArgs->verbose == True) {
+        fprintf (stdout,
+          "C- %s: %d sent, %d synced, %d matched by chksum, %d connections\n",
+          targPath->outPath, rsyncCtx.putCnt, rsyncCtx.syncCnt,
+          rsyncCtx.matchCnt, numStarted + 1);
+    }
+
+    if (rsyncCtx.chksumCache != NULL) {
+        saveChksumCache (&chksumCache);
+        clearChksumCache (&chksumCache);
+    }
+    clearLocalTree (&localTree);
+    clearRsyncManifest (&manifest);
+
+    return (savedStatus);
+}
@@ -7,11 +7,9 @@
 #include "rodsErrorTable.h"
 #include "rodsLog.h"
 #include "rsyncUtil.h"
+#include "rsyncManifest.h"
 #include "miscUtil.h"
 static int CurrentTime = 0;
-int
-ageExceeded (int ageLimit, int myTime, int verbose, char *objPath, 
-rodsLong_t fileSize);
 
 int
 rsyncUtil (rcComm_t *conn, rodsEnv *myRodsEnv, rodsArguments_t *myRodsArgs,
@@ -101,8 +99,16 @@ rodsPathInp_t *rodsPathInp)
                   myRodsEnv, myRodsArgs, &dataObjOprInp);
 	    }
         } else if (srcType == LOCAL_DIR_T && targType == COLL_OBJ_T) {
-            status = rsyncDirToCollUtil (conn, srcPath, targPath,
-             myRodsEnv, myRodsArgs, &dataObjOprInp);
+            if (myRodsArgs->manifest == True &&
+              (targPath->rodsObjStat == NULL ||
+              targPath->rodsObjStat->specColl == NULL)) {
+                /* compare against a manifest of the whole collection */
+                status = rsyncDirToCollByManifest (conn, srcPath, targPath,
+                 myRodsEnv, myRodsArgs, &dataObjOprInp);
+            } else {
+                status = rsyncDirToCollUtil (conn, srcPath, targPath,
+                 myRodsEnv, myRodsArgs, &dataObjOprInp);
+            }
         } else if (srcType == COLL_OBJ_T && targType == COLL_OBJ_T) {
             addKeyVal (&dataObjCopyInp.srcDataObjInp.condInput, 
 	      TRANSLATED_PATH_KW, "");
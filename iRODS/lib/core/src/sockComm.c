@@ -3,6 +3,11 @@
 /* sockComm.c - sock communication routines 
  */
 
+#ifdef linux_platform
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE	/* for splice */
+#endif
+#endif
 #include "sockComm.h"
 #include "rcMisc.h"
 #include "rcGlobalExtern.h"
@@ -16,6 +21,10 @@
 #ifdef windows_platform
 #include "irodsntutil.h"
 #endif
+#ifdef linux_platform
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#endif
 
 #ifdef _WIN32
 #include <mmsystem.h>
@@ -527,6 +536,222 @@ int *bytesWritten)
     return (len - toWrite);
 }
 
+/* zeroCopyEnabled - whether mySendfile/mySpliceToFile should be tried
+ * for portal transfers. It can be turned off by setting the
+ * irodsNoZeroCopy env variable.
+ */
+int
+zeroCopyEnabled ()
+{
+#ifdef linux_platform
+    static int zeroCopyFlag = -1;
+
+    if (zeroCopyFlag < 0) {
+        if (getenv (NO_ZERO_COPY_KW) != NULL) {
+            zeroCopyFlag = 0;
+        } else {
+            zeroCopyFlag = 1;
+        }
+    }
+    return (zeroCopyFlag);
+#else
+    return (0);
+#endif
+}
+
+/* mySendfile - send len bytes from the current offset of the file
+ * descriptor fd to sock without copying through user space.
+ * Returns the number of bytes sent. SYS_NOT_SUPPORTED is returned if
+ * nothing was sent because the descriptors do not support sendfile,
+ * so the caller can fall back to myRead/myWrite.
+ */
+int
+mySendfile (int sock, int fd, int len, int *bytesWritten)
+{
+#ifdef linux_platform
+    int nbytes;
+    int toWrite;
+
+    toWrite = len;
+    if (bytesWritten != NULL)
+        *bytesWritten = 0;
+
+    while (toWrite > 0) {
+        nbytes = sendfile (sock, fd, NULL, toWrite);
+        if (nbytes < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                errno = 0;
+                continue;
+            } else if (toWrite == len &&
+              (errno == EINVAL || errno == ENOSYS)) {
+                return (SYS_NOT_SUPPORTED);
+            } else {
+                return (SYS_COPY_LEN_ERR - errno);
+            }
+        } else if (nbytes == 0) {
+            /* EOF on the file */
+            break;
+        }
+        toWrite -= nbytes;
+        if (bytesWritten != NULL)
+            *bytesWritten += nbytes;
+    }
+    return (len - toWrite);
+#else
+    return (SYS_NOT_SUPPORTED);
+#endif
+}
+
+#if defined(linux_platform) && defined(SPLICE_F_MOVE)
+/* spliceCopyRest - the fallback of mySpliceToFile when splicing from the
+ * pipe to the file fails. Copy the inPipe bytes left in the pipe and then
+ * the rest of *toWrite bytes from sock to fd with myRead/myWrite.
+ * *toWrite and *bytesWritten are updated with the bytes written.
+ */
+static int
+spliceCopyRest (int sock, int pipeRd, int fd, int inPipe, int *toWrite,
+int *bytesWritten)
+{
+    char *buf;
+    int srcFd, toRead, nbytes;
+    int status = 0;
+
+    buf = (char *) malloc (TRANS_BUF_SZ);
+    if (buf == NULL) {
+        return (SYS_MALLOC_ERR);
+    }
+    while (*toWrite > 0) {
+        /* empty the pipe first */
+        if (inPipe > 0) {
+            srcFd = pipeRd;
+            toRead = inPipe;
+        } else {
+            srcFd = sock;
+            toRead = *toWrite;
+        }
+        if (toRead > TRANS_BUF_SZ)
+            toRead = TRANS_BUF_SZ;
+        nbytes = myRead (srcFd, buf, toRead,
+          srcFd == sock ? SOCK_TYPE : FILE_DESC_TYPE, NULL, NULL);
+        if (nbytes < 0) {
+            status = nbytes;
+            break;
+        } else if (nbytes == 0) {
+            if (srcFd == sock) {
+                /* the peer closed the socket */
+                break;
+            }
+            status = SYS_COPY_LEN_ERR - errno;
+            break;
+        }
+        if (myWrite (fd, buf, nbytes, FILE_DESC_TYPE, NULL) != nbytes) {
+            status = UNIX_FILE_WRITE_ERR - errno;
+            break;
+        }
+        if (srcFd == pipeRd)
+            inPipe -= nbytes;
+        *toWrite -= nbytes;
+        if (bytesWritten != NULL)
+            *bytesWritten += nbytes;
+        if (srcFd == sock && nbytes < toRead) {
+            /* the peer closed the socket */
+            break;
+        }
+    }
+    free (buf);
+    return (status);
+}
+#endif
+
+/* mySpliceToFile - move len bytes from sock to the current offset of
+ * the file descriptor fd through a pipe using splice(2), without
+ * copying through user space. Returns the number of bytes written.
+ * As with mySendfile, SYS_NOT_SUPPORTED is returned if nothing was
+ * consumed from the socket so that the caller can fall back. If the
+ * file does not take the spliced data, the rest is copied with
+ * read/write by spliceCopyRest.
+ */
+int
+mySpliceToFile (int sock, int fd, int len, int *bytesWritten)
+{
+#if defined(linux_platform) && defined(SPLICE_F_MOVE)
+    int pipeFd[2];
+    int nbytes, inPipe, written;
+    int toWrite;
+    int status = 0;
+
+    if (bytesWritten != NULL)
+        *bytesWritten = 0;
+
+    if (pipe (pipeFd) < 0) {
+        return (SYS_NOT_SUPPORTED);
+    }
+#ifdef F_SETPIPE_SZ
+    /* a larger pipe means fewer splice calls. It is OK if this fails */
+    fcntl (pipeFd[1], F_SETPIPE_SZ, ZERO_COPY_PIPE_SZ);
+#endif
+
+    toWrite = len;
+    while (toWrite > 0) {
+        inPipe = splice (sock, NULL, pipeFd[1], NULL, toWrite,
+          SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (inPipe < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                errno = 0;
+                continue;
+            } else if (toWrite == len && 
+              (errno == EINVAL || errno == ENOSYS)) {
+                status = SYS_NOT_SUPPORTED;
+            } else {
+                status = SYS_SOCK_READ_ERR - errno;
+            }
+            break;
+        } else if (inPipe == 0) {
+            /* the peer closed the socket */
+            break;
+        }
+        /* drain the pipe into the file */
+        while (inPipe > 0) {
+            written = splice (pipeFd[0], NULL, fd, NULL, inPipe,
+              SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (written < 0 && (errno == EINTR || errno == EAGAIN)) {
+                errno = 0;
+                continue;
+            } else if (written <= 0) {
+                /* the data in the pipe has already been taken from the
+                 * socket. Copy it and the rest of len with read/write */
+                rodsLog (LOG_NOTICE,
+                  "mySpliceToFile: splice to file error, errno = %d, using read/write",
+                  errno);
+                status = spliceCopyRest (sock, pipeFd[0], fd, inPipe,
+                  &toWrite, bytesWritten);
+                if (status >= 0) {
+                    /* done, don't go back to splice */
+                    status = 1;
+                }
+                break;
+            }
+            inPipe -= written;
+            toWrite -= written;
+            if (bytesWritten != NULL)
+                *bytesWritten += written;
+        }
+        if (status != 0)
+            break;
+    }
+    close (pipeFd[0]);
+    close (pipeFd[1]);
+
+    if (status < 0) {
+        return (status);
+    }
+    nbytes = len - toWrite;
+    return (nbytes);
+#else
+    return (SYS_NOT_SUPPORTED);
+#endif
+}
+
 int
 readVersion (int sock, version_t **myVersion)
 {
@@ -770,6 +995,12 @@ connectToRhost (rcComm_t *conn, int connectCnt, int reconnFlag)
         return conn->svrVersion->status;
     }
 
+    if ((conn->svrVersion->status & VERSION_REQ_PIPELINE) != 0) {
+	conn->reqPipeline = 1;
+    } else {
+	conn->reqPipeline = 0;
+    }
+
     return 0;
 }
 
@@ -1083,6 +1314,12 @@ sendStartupPack (rcComm_t *conn, int connectCnt, int reconnFlag)
         startupPack.option[0] = '\0';
     }
 
+    /* ask for the pipelined request mode. Not with reconnection since 
+     * the requests in flight would be lost on a socket switch */
+    if (getenv (IRODS_REQ_PIPELINE) != NULL && reconnFlag != RECONN_TIMEOUT) {
+	rstrcat (startupPack.option, REQ_PIPELINE_OPT, NAME_LEN);
+    }
+
     /* always use XML_PROT for the startupPack */
     status = packStruct ((void *) &startupPack, &startupPackBBuf,
       "StartupPack_PI", RodsPackTable, 0, XML_PROT);
@@ -1221,6 +1458,32 @@ irodsProt_t irodsProt)
     return (0);
 }
 
+/* setReqPipeMsgType - make the msg type of a pipelined request or reply,
+ * i.e., baseType (RODS_API_PREQ_T or RODS_API_PREPLY_T) followed by
+ * a blank and the request ID. msgType must be HEADER_TYPE_LEN long.
+ */
+int
+setReqPipeMsgType (char *msgType, char *baseType, int reqId)
+{
+    snprintf (msgType, HEADER_TYPE_LEN, "%s %d", baseType, reqId);
+    return (0);
+}
+
+/* getReqPipeMsgId - return the request ID of a pipelined msg of type
+ * baseType, or -1 if msgType is not one.
+ */
+int
+getReqPipeMsgId (char *msgType, char *baseType)
+{
+    int len = strlen (baseType);
+
+    if (strncmp (msgType, baseType, len) != 0 || msgType[len] != ' ' ||
+      !isdigit (msgType[len + 1])) {
+	return (-1);
+    }
+    return (atoi (&msgType[len + 1]));
+}
+
 int
 rodsSleep (int sec, int microSec)
 {
@@ -0,0 +1,885 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* xferQue.c - the work queue mode (-j) of a recursive iput and iget.
+ * The calling thread walks the tree with its own connection, makes the
+ * collections or local dirs and queues the files for a pool of
+ * connections, each run by a thread. A large file is queued by itself
+ * and keeps the parallel transfer of its connection. The small files of
+ * a collection are queued in batches. With iput -b, a batch is sent with
+ * one rcBulkDataObjPut. Items complete out of order, so with -X the
+ * restart file only advances over the items that are done in the walk
+ * order.
+ */
+
+#ifndef windows_platform
+#include <sys/time.h>
+#include <pthread.h>
+#endif
+#include "rodsPath.h"
+#include "rodsErrorTable.h"
+#include "rodsLog.h"
+#include "lsUtil.h"
+#include "putUtil.h"
+#include "getUtil.h"
+#include "xferQue.h"
+#include "miscUtil.h"
+
+#ifndef windows_platform
+
+typedef struct {
+    char srcPath[MAX_NAME_LEN];
+    char targPath[MAX_NAME_LEN];
+    rodsLong_t size;
+    int mode;
+} xferQueFile_t;
+
+/* an item is one large file or a batch of small files of a collection */
+typedef struct xferQueItem {
+    xferQueFile_t *files;
+    int numFiles;
+    int maxFiles;
+    rodsLong_t size;		/* of all the files */
+    char collPath[MAX_NAME_LEN];	/* the target coll or local dir */
+    specColl_t *specColl;	/* get from a spec coll */
+    int forceFlag;		/* may have been partly done before a restart */
+    int seqCnt;			/* the restart count when it is done */
+    int done;
+    int status;
+    struct xferQueItem *next;		/* the work list */
+    struct xferQueItem *orderNext;	/* the walk order list, with -X */
+} xferQueItem_t;
+
+/* the state shared by the walker and the worker threads */
+typedef struct {
+    int oprType;		/* PUT_OPR or GET_OPR */
+    int bulkFlag;		/* batches go through rcBulkDataObjPut */
+    rcComm_t *conn;		/* the walker's */
+    rodsEnv *myRodsEnv;
+    rodsArguments_t *rodsArgs;
+    dataObjInp_t *dataObjOprInp;
+    bulkOprInp_t *bulkOprInp;
+    rodsRestart_t *rodsRestart;
+    xferQueItem_t *workHead;
+    xferQueItem_t *workTail;
+    int numQueued;
+    int maxQueued;
+    xferQueItem_t *orderHead;
+    xferQueItem_t *orderTail;
+    int numAhead;		/* items in the order list */
+    xferQueItem_t *batch;	/* being filled by the walker */
+    int walkCnt;
+    int resumeCnt;		/* items to force after a restart match */
+    int walkDone;
+    int stopFlag;
+    int status;
+    int numFilesDone;
+    rodsLong_t sizeDone;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} xferQue_t;
+
+typedef struct {
+    xferQue_t *xferQue;
+    rcComm_t *conn;
+} xferQueThrInp_t;
+
+/* the progress of the walker's conn is the total. The callback is
+ * serialized since the workers call it from their threads */
+static pthread_mutex_t ProgressLock = PTHREAD_MUTEX_INITIALIZER;
+static irodsGuiProgressCallbak SavedProgressCB = NULL;
+
+static void
+xferQueProgressCB (operProgress_t *operProgress)
+{
+    pthread_mutex_lock (&ProgressLock);
+    if (SavedProgressCB != NULL) SavedProgressCB (operProgress);
+    pthread_mutex_unlock (&ProgressLock);
+}
+
+/* syncXferQueProgress - add what a worker has done to the total and
+ * refresh the worker's view of it */
+
+static void
+syncXferQueProgress (xferQue_t *xferQue, rcComm_t *conn, int numFiles,
+rodsLong_t size)
+{
+    operProgress_t *total = &xferQue->conn->operProgress;
+
+    if (gGuiProgressCB == NULL) return;
+    pthread_mutex_lock (&ProgressLock);
+    total->totalNumFilesDone += numFiles;
+    total->totalFileSizeDone += size;
+    conn->operProgress.oprType = total->oprType;
+    conn->operProgress.totalNumFiles = total->totalNumFiles;
+    conn->operProgress.totalFileSize = total->totalFileSize;
+    conn->operProgress.totalNumFilesDone = total->totalNumFilesDone;
+    conn->operProgress.totalFileSizeDone = total->totalFileSizeDone;
+    pthread_mutex_unlock (&ProgressLock);
+}
+
+static xferQueItem_t *
+newXferQueItem (xferQue_t *xferQue, char *collPath, specColl_t *specColl,
+int maxFiles)
+{
+    xferQueItem_t *item;
+
+    item = (xferQueItem_t *) calloc (1, sizeof (xferQueItem_t));
+    item->files = (xferQueFile_t *) malloc (maxFiles * sizeof (xferQueFile_t));
+    item->maxFiles = maxFiles;
+    rstrcpy (item->collPath, collPath, MAX_NAME_LEN);
+    if (specColl != NULL) {
+        item->specColl = (specColl_t *) malloc (sizeof (specColl_t));
+        *item->specColl = *specColl;
+    }
+    if (xferQue->resumeCnt > 0) {
+        item->forceFlag = 1;
+        xferQue->resumeCnt--;
+    }
+    return (item);
+}
+
+static void
+freeXferQueItem (xferQueItem_t *item)
+{
+    if (item->specColl != NULL) free (item->specColl);
+    free (item->files);
+    free (item);
+}
+
+/* queXferQueItem - put an item on the work list. Called with the lock */
+
+static void
+queXferQueItem (xferQue_t *xferQue, xferQueItem_t *item)
+{
+    if (xferQue->workTail == NULL) {
+        xferQue->workHead = item;
+    } else {
+        xferQue->workTail->next = item;
+    }
+    xferQue->workTail = item;
+    xferQue->numQueued++;
+
+    if (xferQue->rodsRestart->fd > 0) {
+        if (xferQue->orderTail == NULL) {
+            xferQue->orderHead = item;
+        } else {
+            xferQue->orderTail->orderNext = item;
+        }
+        xferQue->orderTail = item;
+        xferQue->numAhead++;
+    }
+    pthread_cond_broadcast (&xferQue->cond);
+}
+
+static void
+flushXferQueBatch (xferQue_t *xferQue)
+{
+    pthread_mutex_lock (&xferQue->lock);
+    if (xferQue->batch != NULL) {
+        queXferQueItem (xferQue, xferQue->batch);
+        xferQue->batch = NULL;
+    }
+    pthread_mutex_unlock (&xferQue->lock);
+}
+
+/* queXferFile - queue a file found by the walker. A file larger than
+ * MAX_BULK_OPR_FILE_SIZE is an item by itself. The others are added to
+ * the batch of their collection. With -X, the files of a batch must be
+ * contiguous in the walk order, so a large file also ends the batch. */
+
+static int
+queXferFile (xferQue_t *xferQue, char *srcPath, char *targPath,
+char *collPath, specColl_t *specColl, rodsLong_t size, int mode)
+{
+    xferQueItem_t *item;
+    xferQueFile_t *file;
+    int restartFlag = xferQue->rodsRestart->fd > 0;
+    int smallFlag = size <= MAX_BULK_OPR_FILE_SIZE;
+
+    pthread_mutex_lock (&xferQue->lock);
+    while (xferQue->stopFlag == 0 &&
+      (xferQue->numQueued >= xferQue->maxQueued ||
+      (restartFlag && xferQue->numAhead >= XFER_QUE_MAX_AHEAD))) {
+        pthread_cond_wait (&xferQue->cond, &xferQue->lock);
+    }
+    if (xferQue->stopFlag != 0) {
+        pthread_mutex_unlock (&xferQue->lock);
+        return (xferQue->status);
+    }
+
+    item = xferQue->batch;
+    if (item != NULL && ((smallFlag == 0 && restartFlag) ||
+      strcmp (item->collPath, collPath) != 0)) {
+        queXferQueItem (xferQue, item);
+        xferQue->batch = item = NULL;
+    }
+    if (smallFlag == 0) {
+        item = newXferQueItem (xferQue, collPath, specColl, 1);
+    } else if (item == NULL) {
+        item = xferQue->batch = newXferQueItem (xferQue, collPath, specColl,
+          MAX_NUM_BULK_OPR_FILES);
+    }
+
+    file = &item->files[item->numFiles++];
+    rstrcpy (file->srcPath, srcPath, MAX_NAME_LEN);
+    rstrcpy (file->targPath, targPath, MAX_NAME_LEN);
+    file->size = size;
+    file->mode = mode;
+    item->size += size;
+    item->seqCnt = ++xferQue->walkCnt;
+
+    if (smallFlag == 0) {
+        queXferQueItem (xferQue, item);
+    } else if (item->numFiles >= item->maxFiles ||
+      item->size >= XFER_QUE_BATCH_SIZE) {
+        queXferQueItem (xferQue, item);
+        xferQue->batch = NULL;
+    }
+    pthread_mutex_unlock (&xferQue->lock);
+    return (0);
+}
+
+/* chkXferQueResume - chkStateForResume for the walker. The walk count
+ * follows the restart count while files are being skipped */
+
+static int
+chkXferQueResume (xferQue_t *xferQue, char *targPath, objType_t objType)
+{
+    rodsRestart_t *rodsRestart = xferQue->rodsRestart;
+    int matched, status;
+
+    pthread_mutex_lock (&xferQue->lock);
+    matched = rodsRestart->restartState & LAST_PATH_MATCHED;
+    status = chkStateForResume (xferQue->conn, rodsRestart, targPath,
+      xferQue->rodsArgs, objType, &xferQue->dataObjOprInp->condInput, 1);
+    if (status == 0) {
+        xferQue->walkCnt = rodsRestart->curCnt;
+        if (matched == 0 && (rodsRestart->restartState & LAST_PATH_MATCHED)) {
+            /* the last run may have sent anything up to this far ahead */
+            xferQue->resumeCnt = XFER_QUE_MAX_AHEAD;
+        }
+    }
+    pthread_mutex_unlock (&xferQue->lock);
+    return (status);
+}
+
+static xferQueItem_t *
+nextXferQueItem (xferQue_t *xferQue)
+{
+    xferQueItem_t *item;
+
+    pthread_mutex_lock (&xferQue->lock);
+    while (xferQue->workHead == NULL && xferQue->walkDone == 0 &&
+      xferQue->stopFlag == 0) {
+        pthread_cond_wait (&xferQue->cond, &xferQue->lock);
+    }
+    item = xferQue->stopFlag == 0 ? xferQue->workHead : NULL;
+    if (item != NULL) {
+        xferQue->workHead = item->next;
+        if (xferQue->workHead == NULL) xferQue->workTail = NULL;
+        xferQue->numQueued--;
+        /* the walker may be waiting for room */
+        pthread_cond_broadcast (&xferQue->cond);
+    }
+    pthread_mutex_unlock (&xferQue->lock);
+    return (item);
+}
+
+/* doneXferQueItem - record the result of an item. With -X, the restart
+ * file is written for the last of the items done in the walk order and
+ * the first failure stops the dispatch, as the serial walk does */
+
+static void
+doneXferQueItem (xferQue_t *xferQue, xferQueItem_t *item, int status)
+{
+    rodsRestart_t *rodsRestart = xferQue->rodsRestart;
+    xferQueItem_t *head;
+
+    pthread_mutex_lock (&xferQue->lock);
+    item->done = 1;
+    item->status = status;
+    if (status >= 0) {
+        xferQue->numFilesDone += item->numFiles;
+        xferQue->sizeDone += item->size;
+    } else {
+        xferQue->status = status;
+        if (rodsRestart->fd > 0) xferQue->stopFlag = 1;
+    }
+
+    if (rodsRestart->fd <= 0) {
+        freeXferQueItem (item);
+    } else {
+        while ((head = xferQue->orderHead) != NULL && head->done &&
+          head->status >= 0) {
+            rodsRestart->curCnt = head->seqCnt;
+            writeRestartFile (rodsRestart,
+              head->files[head->numFiles - 1].targPath);
+            xferQue->orderHead = head->orderNext;
+            if (xferQue->orderHead == NULL) xferQue->orderTail = NULL;
+            xferQue->numAhead--;
+            freeXferQueItem (head);
+        }
+    }
+    pthread_cond_broadcast (&xferQue->cond);
+    pthread_mutex_unlock (&xferQue->lock);
+}
+
+/* xferBulkPutItem - send a batch of small files with one
+ * rcBulkDataObjPut */
+
+static int
+xferBulkPutItem (xferQue_t *xferQue, rcComm_t *conn, xferQueItem_t *item,
+bulkOprInp_t *bulkOprInp, bulkOprInfo_t *bulkOprInfo)
+{
+    xferQueFile_t *file;
+    int i;
+    int status = 0;
+
+    rstrcpy (bulkOprInp->objPath, item->collPath, MAX_NAME_LEN);
+    if (item->forceFlag) setForceFlagForRestart (bulkOprInp, bulkOprInfo);
+    for (i = 0; i < item->numFiles; i++) {
+        file = &item->files[i];
+        status = bulkPutFileUtil (conn, file->srcPath, file->targPath,
+          file->size, file->mode, xferQue->myRodsEnv, xferQue->rodsArgs,
+          bulkOprInp, bulkOprInfo);
+        if (status < 0) break;
+    }
+    if (status >= 0) {
+        status = sendBulkPut (conn, bulkOprInp, bulkOprInfo,
+          xferQue->rodsArgs);
+    } else {
+        bulkOprInp->attriArray.rowCnt = 0;
+        if (bulkOprInfo->forceFlagAdded == 1) {
+            rmKeyVal (&bulkOprInp->condInput, FORCE_FLAG_KW);
+            bulkOprInfo->forceFlagAdded = 0;
+        }
+    }
+    clearBulkOprInfo (bulkOprInfo);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "xferBulkPutItem: bulk put to %s failed", item->collPath);
+    }
+    return (status);
+}
+
+/* xferQueItem - transfer the files of an item one at a time */
+
+static int
+xferQueItem (xferQue_t *xferQue, rcComm_t *conn, xferQueItem_t *item,
+dataObjInp_t *dataObjInp)
+{
+    rodsArguments_t *rodsArgs = xferQue->rodsArgs;
+    xferQueFile_t *file;
+    int i, status;
+    int savedStatus = 0;
+
+    if (item->forceFlag && rodsArgs->force != True)
+        addKeyVal (&dataObjInp->condInput, FORCE_FLAG_KW, "");
+    for (i = 0; i < item->numFiles; i++) {
+        file = &item->files[i];
+        if (xferQue->oprType == PUT_OPR) {
+            dataObjInp->createMode = file->mode;
+#ifdef FILESYSTEM_META
+            getFileMetaFromPath (file->srcPath, &dataObjInp->condInput);
+#endif
+            status = putFileUtil (conn, file->srcPath, file->targPath,
+              file->size, xferQue->myRodsEnv, rodsArgs, dataObjInp);
+        } else {
+            dataObjInp->specColl = item->specColl;
+            status = getDataObjUtil (conn, file->srcPath, file->targPath,
+              file->size, file->mode, xferQue->myRodsEnv, rodsArgs,
+              dataObjInp);
+        }
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status,
+              "xferQueItem: %s of %s failed. status = %d",
+              xferQue->oprType == PUT_OPR ? "put" : "get",
+              file->srcPath, status);
+            savedStatus = status;
+            if (xferQue->rodsRestart->fd > 0) break;
+        }
+    }
+    if (item->forceFlag && rodsArgs->force != True)
+        rmKeyVal (&dataObjInp->condInput, FORCE_FLAG_KW);
+    return (savedStatus);
+}
+
+/* xferQueThr - a worker. Transfer the queued items with its own
+ * connection until the walk is done and nothing is left */
+
+static void *
+xferQueThr (void *arg)
+{
+    xferQueThrInp_t *thrInp = (xferQueThrInp_t *) arg;
+    xferQue_t *xferQue = thrInp->xferQue;
+    rcComm_t *conn = thrInp->conn;
+    dataObjInp_t myDataObjInp;
+    bulkOprInp_t myBulkOprInp;
+    bulkOprInfo_t *bulkOprInfo = NULL;
+    xferQueItem_t *item;
+    int status;
+
+    /* the condInput gets changed per file */
+    myDataObjInp = *xferQue->dataObjOprInp;
+    memset (&myDataObjInp.condInput, 0, sizeof (keyValPair_t));
+    replKeyVal (&xferQue->dataObjOprInp->condInput, &myDataObjInp.condInput);
+    if (xferQue->bulkFlag) {
+        bzero (&myBulkOprInp, sizeof (myBulkOprInp));
+        replKeyVal (&xferQue->bulkOprInp->condInput, &myBulkOprInp.condInput);
+        initAttriArrayOfBulkOprInp (&myBulkOprInp);
+        bulkOprInfo = (bulkOprInfo_t *) calloc (1, sizeof (bulkOprInfo_t));
+        bulkOprInfo->flags = BULK_OPR_SMALL_FILES;
+        bulkOprInfo->bytesBuf.buf = malloc (BULK_OPR_BUF_SIZE);
+    }
+
+    while ((item = nextXferQueItem (xferQue)) != NULL) {
+        syncXferQueProgress (xferQue, conn, 0, 0);
+        if (bulkOprInfo != NULL && item->maxFiles > 1) {
+            status = xferBulkPutItem (xferQue, conn, item, &myBulkOprInp,
+              bulkOprInfo);
+        } else {
+            status = xferQueItem (xferQue, conn, item, &myDataObjInp);
+        }
+        if (status >= 0)
+            syncXferQueProgress (xferQue, conn, item->numFiles, item->size);
+        doneXferQueItem (xferQue, item, status);
+    }
+
+    clearKeyVal (&myDataObjInp.condInput);
+    if (bulkOprInfo != NULL) {
+        clearBulkOprInp (&myBulkOprInp);
+        free (bulkOprInfo->bytesBuf.buf);
+        free (bulkOprInfo);
+    }
+    return (NULL);
+}
+
+static int
+walkPutDir (xferQue_t *xferQue, char *srcDir, char *targColl, int bulkFlag)
+{
+    rcComm_t *conn = xferQue->conn;
+    rodsArguments_t *rodsArgs = xferQue->rodsArgs;
+    DIR *dirPtr;
+    struct dirent *myDirent;
+    struct stat statbuf;
+    char srcChildPath[MAX_NAME_LEN], targChildPath[MAX_NAME_LEN];
+    objType_t childObjType;
+    int status = 0;
+    int savedStatus = 0;
+
+    if (isPathSymlink (rodsArgs, srcDir) > 0) return 0;
+
+    dirPtr = opendir (srcDir);
+    if (dirPtr == NULL) {
+        rodsLog (LOG_ERROR,
+          "walkPutDir: opendir local dir error for %s, errno = %d\n",
+          srcDir, errno);
+        return (USER_INPUT_PATH_ERR);
+    }
+    if (rodsArgs->verbose == True) {
+        fprintf (stdout, "C- %s:\n", targColl);
+    }
+
+    while ((myDirent = readdir (dirPtr)) != NULL) {
+        if (strcmp (myDirent->d_name, ".") == 0 ||
+          strcmp (myDirent->d_name, "..") == 0) {
+            continue;
+        }
+        snprintf (srcChildPath, MAX_NAME_LEN, "%s/%s",
+          srcDir, myDirent->d_name);
+        if (isPathSymlink (rodsArgs, srcChildPath) > 0) continue;
+        if (stat (srcChildPath, &statbuf) != 0) {
+            closedir (dirPtr);
+            rodsLog (LOG_ERROR,
+              "walkPutDir: stat error for %s, errno = %d\n",
+              srcChildPath, errno);
+            return (USER_INPUT_PATH_ERR);
+        }
+        if (statbuf.st_mode & S_IFREG) {
+            childObjType = DATA_OBJ_T;
+            /* the two passes of a bulk put, as in bulkPutDirUtil */
+            if (bulkFlag == BULK_OPR_SMALL_FILES &&
+              statbuf.st_size > MAX_BULK_OPR_FILE_SIZE) {
+                continue;
+            } else if (bulkFlag == BULK_OPR_LARGE_FILES &&
+              statbuf.st_size <= MAX_BULK_OPR_FILE_SIZE) {
+                continue;
+            }
+        } else if (statbuf.st_mode & S_IFDIR) {
+            childObjType = COLL_OBJ_T;
+        } else {
+            rodsLog (LOG_ERROR,
+              "walkPutDir: unknown local path type %d for %s",
+              statbuf.st_mode, srcChildPath);
+            savedStatus = USER_INPUT_PATH_ERR;
+            continue;
+        }
+        snprintf (targChildPath, MAX_NAME_LEN, "%s/%s",
+          targColl, myDirent->d_name);
+
+        status = chkXferQueResume (xferQue, targChildPath, childObjType);
+        if (status < 0) {
+            closedir (dirPtr);
+            return (status);
+        } else if (status == 0) {
+            continue;
+        }
+
+        if (childObjType == DATA_OBJ_T) {
+            if (conn->fileRestart.info.status == FILE_RESTARTED &&
+              strcmp (conn->fileRestart.info.objPath, targChildPath) == 0) {
+                /* done by the --lfrestart of the walker's conn */
+                conn->fileRestart.info.status = FILE_NOT_RESTART;
+                continue;
+            }
+            status = queXferFile (xferQue, srcChildPath, targChildPath,
+              targColl, NULL, statbuf.st_size, statbuf.st_mode);
+        } else {
+            if (bulkFlag != BULK_OPR_SMALL_FILES) {
+#ifdef FILESYSTEM_META
+                status = mkCollWithDirMeta (conn, targChildPath, srcChildPath);
+#else
+                status = mkColl (conn, targChildPath);
+#endif
+                if (status < 0) {
+                    rodsLogError (LOG_ERROR, status,
+                      "walkPutDir: mkColl error for %s", targChildPath);
+                }
+            }
+            status = walkPutDir (xferQue, srcChildPath, targChildPath,
+              bulkFlag);
+        }
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status,
+              "walkPutDir: put %s failed. status = %d",
+              srcChildPath, status);
+            savedStatus = status;
+            if (xferQue->rodsRestart->fd > 0) break;
+        }
+    }
+    closedir (dirPtr);
+    /* don't hold the last batch of the dir while the walk goes on */
+    flushXferQueBatch (xferQue);
+
+    return (savedStatus);
+}
+
+static int
+walkGetColl (xferQue_t *xferQue, char *srcColl, char *targDir,
+specColl_t *specColl)
+{
+    rcComm_t *conn = xferQue->conn;
+    rodsArguments_t *rodsArgs = xferQue->rodsArgs;
+    char srcChildPath[MAX_NAME_LEN], targChildPath[MAX_NAME_LEN];
+    char parPath[MAX_NAME_LEN], childPath[MAX_NAME_LEN];
+    collHandle_t collHandle;
+    collEnt_t collEnt;
+    int status = 0;
+    int savedStatus = 0;
+
+    printCollOrDir (targDir, LOCAL_DIR_T, rodsArgs, specColl);
+    status = rclOpenCollection (conn, srcColl, 0, &collHandle);
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "walkGetColl: rclOpenCollection of %s error. status = %d",
+          srcColl, status);
+        return status;
+    }
+
+    while ((status = rclReadCollection (conn, &collHandle, &collEnt)) >= 0) {
+        if (collEnt.objType == DATA_OBJ_T) {
+            snprintf (targChildPath, MAX_NAME_LEN, "%s/%s",
+              targDir, collEnt.dataName);
+            snprintf (srcChildPath, MAX_NAME_LEN, "%s/%s",
+              collEnt.collName, collEnt.dataName);
+
+            status = chkXferQueResume (xferQue, targChildPath, LOCAL_FILE_T);
+            if (status < 0) {
+                break;
+            } else if (status == 0) {
+                continue;
+            }
+            if (conn->fileRestart.info.status == FILE_RESTARTED &&
+              strcmp (conn->fileRestart.info.objPath, srcChildPath) == 0) {
+                conn->fileRestart.info.status = FILE_NOT_RESTART;
+                continue;
+            }
+            status = queXferFile (xferQue, srcChildPath, targChildPath,
+              targDir, specColl, collEnt.dataSize, collEnt.dataMode);
+            if (status < 0) {
+                savedStatus = status;
+                break;
+            }
+        } else if (collEnt.objType == COLL_OBJ_T) {
+            if ((status = splitPathByKey (
+              collEnt.collName, parPath, childPath, '/')) < 0) {
+                rodsLogError (LOG_ERROR, status,
+                  "walkGetColl:: splitPathByKey for %s error, status = %d",
+                  collEnt.collName, status);
+                savedStatus = status;
+                break;
+            }
+            if (snprintf (targChildPath, MAX_NAME_LEN, "%s/%s",
+              targDir, childPath) >= MAX_NAME_LEN) {
+                rodsLog (LOG_ERROR,
+                  "walkGetColl: target path for %s in %s is too long",
+                  childPath, targDir);
+                savedStatus = USER_PATH_EXCEEDS_MAX;
+                break;
+            }
+
+            mkdirR (targDir, targChildPath, 0750);
+
+            /* the child is a spec coll. need to drill down */
+            status = walkGetColl (xferQue, collEnt.collName, targChildPath,
+              collEnt.specColl.collClass != NO_SPEC_COLL ?
+              &collEnt.specColl : NULL);
+            if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+                rodsLogError (LOG_ERROR, status,
+                  "walkGetColl: walkGetColl failed for %s. status = %d",
+                  collEnt.collName, status);
+                savedStatus = status;
+                if (xferQue->rodsRestart->fd > 0) break;
+            }
+        }
+    }
+    rclCloseCollection (&collHandle);
+    flushXferQueBatch (xferQue);
+
+    if (savedStatus < 0) {
+        return (savedStatus);
+    } else if (status == CAT_NO_ROWS_FOUND ||
+      status == SYS_SPEC_COLL_OBJ_NOT_EXIST) {
+        return (0);
+    } else {
+        return (status);
+    }
+}
+
+/* runXferQue - start the pool, walk the tree and wait for the pool to
+ * drain. The walk is walkPutDir or walkGetColl */
+
+static int
+runXferQue (xferQue_t *xferQue, char *srcPath, char *targPath,
+specColl_t *specColl)
+{
+    rodsEnv *myRodsEnv = xferQue->myRodsEnv;
+    rodsArguments_t *rodsArgs = xferQue->rodsArgs;
+    xferQueThrInp_t thrInp[MAX_XFER_QUE_NUM_CONN];
+    pthread_t tid[MAX_XFER_QUE_NUM_CONN];
+    struct timeval startTime, endTime;
+    xferQueItem_t *item;
+    rErrMsg_t errMsg;
+    rcComm_t *myConn;
+    float timeInSec, sizeInMb;
+    int numConn, numStarted = 0;
+    int i, status;
+
+    numConn = DEF_XFER_QUE_NUM_CONN;
+    if (rodsArgs->jobsValue > 0) numConn = rodsArgs->jobsValue;
+    if (numConn > MAX_XFER_QUE_NUM_CONN) numConn = MAX_XFER_QUE_NUM_CONN;
+
+    xferQue->maxQueued = numConn * XFER_QUE_ITEMS_PER_CONN;
+    xferQue->walkCnt = xferQue->rodsRestart->curCnt;
+    pthread_mutex_init (&xferQue->lock, NULL);
+    pthread_cond_init (&xferQue->cond, NULL);
+    if (gGuiProgressCB != NULL) {
+        SavedProgressCB = gGuiProgressCB;
+        gGuiProgressCB = xferQueProgressCB;
+    }
+
+    (void) gettimeofday (&startTime, (struct timezone *)0);
+    for (i = 0; i < numConn; i++) {
+        myConn = rcConnect (myRodsEnv->rodsHost, myRodsEnv->rodsPort,
+          myRodsEnv->rodsUserName, myRodsEnv->rodsZone,
+          rodsArgs->reconnect == True ? RECONN_TIMEOUT : NO_RECONN, &errMsg);
+        if (myConn == NULL) {
+            status = errMsg.status;
+            break;
+        }
+        if ((status = clientLogin (myConn)) != 0) {
+            rcDisconnect (myConn);
+            break;
+        }
+        if (rodsArgs->ticket == True)
+            setSessionTicket (myConn, rodsArgs->ticketString);
+        thrInp[numStarted].xferQue = xferQue;
+        thrInp[numStarted].conn = myConn;
+        if (pthread_create (&tid[numStarted], NULL, xferQueThr,
+          &thrInp[numStarted]) != 0) {
+            rcDisconnect (myConn);
+            break;
+        }
+        numStarted++;
+    }
+
+    if (numStarted == 0) {
+        rodsLogError (LOG_ERROR, status,
+          "runXferQue: no connection could be made for %s", srcPath);
+        status = status < 0 ? status : USER_SOCK_CONNECT_ERR;
+    } else {
+        if (xferQue->oprType == PUT_OPR) {
+            if (xferQue->bulkFlag) {
+                /* the large files first, as bulkPutDirUtil does */
+                status = walkPutDir (xferQue, srcPath, targPath,
+                  BULK_OPR_LARGE_FILES);
+                if (status >= 0) {
+                    status = walkPutDir (xferQue, srcPath, targPath,
+                      BULK_OPR_SMALL_FILES);
+                }
+            } else {
+                status = walkPutDir (xferQue, srcPath, targPath,
+                  NON_BULK_OPR);
+            }
+        } else {
+            status = walkGetColl (xferQue, srcPath, targPath, specColl);
+        }
+
+        pthread_mutex_lock (&xferQue->lock);
+        xferQue->walkDone = 1;
+        pthread_cond_broadcast (&xferQue->cond);
+        pthread_mutex_unlock (&xferQue->lock);
+    }
+
+    for (i = 0; i < numStarted; i++) {
+        pthread_join (tid[i], NULL);
+        printErrorStack (thrInp[i].conn->rError);
+        rcDisconnect (thrInp[i].conn);
+    }
+    (void) gettimeofday (&endTime, (struct timezone *)0);
+
+    /* what is left after a stop */
+    if (xferQue->batch != NULL) freeXferQueItem (xferQue->batch);
+    if (xferQue->rodsRestart->fd > 0) {
+        while ((item = xferQue->orderHead) != NULL) {
+            xferQue->orderHead = item->orderNext;
+            freeXferQueItem (item);
+        }
+    } else {
+        while ((item = xferQue->workHead) != NULL) {
+            xferQue->workHead = item->next;
+            freeXferQueItem (item);
+        }
+    }
+    if (SavedProgressCB != NULL) {
+        gGuiProgressCB = SavedProgressCB;
+        SavedProgressCB = NULL;
+    }
+    pthread_mutex_destroy (&xferQue->lock);
+    pthread_cond_destroy (&xferQue->cond);
+
+    if (rodsArgs->verbose == True && numStarted > 0) {
+        timeInSec = (float) (endTime.tv_sec - startTime.tv_sec) +
+          ((float) (endTime.tv_usec - startTime.tv_usec) / 1000000.0);
+        sizeInMb = (float) xferQue->sizeDone / 1048600.0;
+        fprintf (stdout,
+          "C- %s: %d files, %.3f MB | %.3f sec | %d conn | %6.3f MB/s\n",
+          targPath, xferQue->numFilesDone, sizeInMb, timeInSec, numStarted,
+          timeInSec > 0.0 ? sizeInMb / timeInSec : 0.0);
+    }
+
+    if (xferQue->status < 0) {
+        return (xferQue->status);
+    } else if (status == CAT_NO_ROWS_FOUND) {
+        return (0);
+    } else {
+        return (status);
+    }
+}
+#endif	/* windows_platform */
+
+/* putDirUtilByQue - iput -r -j. Falls back to the serial walk where
+ * there are no threads */
+
+int
+putDirUtilByQue (rcComm_t **myConn, char *srcDir, char *targColl,
+rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+bulkOprInp_t *bulkOprInp, rodsRestart_t *rodsRestart)
+{
+#ifndef windows_platform
+    xferQue_t xferQue;
+
+    if (srcDir == NULL || targColl == NULL) {
+       rodsLog (LOG_ERROR,
+          "putDirUtilByQue: NULL srcDir or targColl input");
+        return (USER__NULL_INPUT_ERR);
+    }
+    if (rodsArgs->recursive != True) {
+        rodsLog (LOG_ERROR,
+        "putDirUtilByQue: -r option must be used for putting %s directory",
+         srcDir);
+        return (USER_INPUT_OPTION_ERR);
+    }
+    if (rodsArgs->redirectConn == True) {
+        rodsLog (LOG_NOTICE,
+          "putDirUtilByQue: -I is not used with -j");
+        rodsArgs->redirectConn = 0;
+    }
+
+    memset (&xferQue, 0, sizeof (xferQue));
+    xferQue.oprType = PUT_OPR;
+#ifndef BULK_OPR_WITH_TAR
+    xferQue.bulkFlag = rodsArgs->bulk == True;
+#endif
+    xferQue.conn = *myConn;
+    xferQue.myRodsEnv = myRodsEnv;
+    xferQue.rodsArgs = rodsArgs;
+    xferQue.dataObjOprInp = dataObjOprInp;
+    xferQue.bulkOprInp = bulkOprInp;
+    xferQue.rodsRestart = rodsRestart;
+
+    return (runXferQue (&xferQue, srcDir, targColl, NULL));
+#else
+    if (rodsArgs->bulk == True) {
+        return (bulkPutDirUtil (myConn, srcDir, targColl, myRodsEnv,
+          rodsArgs, dataObjOprInp, bulkOprInp, rodsRestart));
+    } else {
+        return (putDirUtil (myConn, srcDir, targColl, myRodsEnv, rodsArgs,
+          dataObjOprInp, bulkOprInp, rodsRestart, NULL));
+    }
+#endif
+}
+
+/* getCollUtilByQue - iget -r -j. Falls back to the serial walk where
+ * there are no threads */
+
+int
+getCollUtilByQue (rcComm_t **myConn, char *srcColl, char *targDir,
+rodsEnv *myRodsEnv, rodsArguments_t *rodsArgs, dataObjInp_t *dataObjOprInp,
+rodsRestart_t *rodsRestart)
+{
+#ifndef windows_platform
+    xferQue_t xferQue;
+
+    if (srcColl == NULL || targDir == NULL) {
+       rodsLog (LOG_ERROR,
+          "getCollUtilByQue: NULL srcColl or targDir input");
+        return (USER__NULL_INPUT_ERR);
+    }
+    if (rodsArgs->recursive != True) {
+        rodsLog (LOG_ERROR,
+        "getCollUtilByQue: -r option must be used for getting %s collection",
+         targDir);
+        return (USER_INPUT_OPTION_ERR);
+    }
+    if (rodsArgs->redirectConn == True) {
+        rodsLog (LOG_NOTICE,
+          "getCollUtilByQue: -I is not used with -j");
+        rodsArgs->redirectConn = 0;
+    }
+
+    memset (&xferQue, 0, sizeof (xferQue));
+    xferQue.oprType = GET_OPR;
+    xferQue.conn = *myConn;
+    xferQue.myRodsEnv = myRodsEnv;
+    xferQue.rodsArgs = rodsArgs;
+    xferQue.dataObjOprInp = dataObjOprInp;
+    xferQue.rodsRestart = rodsRestart;
+
+    return (runXferQue (&xferQue, srcColl, targDir,
+      dataObjOprInp->specColl));
+#else
+    return (getCollUtil (myConn, srcColl, targDir, myRodsEnv, rodsArgs,
+      dataObjOprInp, rodsRestart));
+#endif
+}
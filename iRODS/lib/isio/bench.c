@@ -0,0 +1,62 @@
+/* Time reading an iRODS file through the isio library, to compare
+  with iget (see bench.sh).  The file is read with fread calls of
+  the given size and discarded. */
+
+#include "isio.h"   /* the irods standard IO emulation library */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+int
+main(int argc, char **argv)
+{
+    FILE *FI;
+    int rval;
+    char *buf;
+    int bufsize = 65536;
+    double total = 0;
+    double secs;
+    struct timeval startTime, endTime;
+
+    if (argc < 2) {
+      printf("bench irods:file-in [buffersize] \n");
+      exit(-1);
+    }
+
+    if (argc >= 3) {
+       bufsize = atoi(argv[2]);
+       if (bufsize <= 0) {
+	  perror("invalid buffer size");
+	  exit(-5);
+       }
+    }
+    buf = (char *)malloc(bufsize);
+    if (buf==NULL) {
+       perror("malloc");
+       exit(-4);
+    }
+
+    gettimeofday(&startTime, NULL);
+    FI = fopen(argv[1],"r");
+    if (FI==0)
+    {
+        fprintf(stderr,"can't open input file %s\n",argv[1]);
+        exit(-2);
+    }
+
+    do {
+      rval = fread(buf, 1, bufsize, FI);
+      if (rval < 0) {
+	fprintf(stderr,"read error %d\n", rval);
+	exit(-3);
+      }
+      total += rval;
+    } while (rval > 0);
+    fclose(FI);
+    gettimeofday(&endTime, NULL);
+
+    secs = (endTime.tv_sec - startTime.tv_sec) +
+           (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+    printf("%.0f bytes in %.3f sec, %.2f MB/sec\n", total, secs,
+	   secs > 0 ? total / secs / (1024*1024) : 0);
+    exit(0);
+}
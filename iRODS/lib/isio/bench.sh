@@ -0,0 +1,31 @@
+#!/bin/bash
+#
+# This script compares reading a file through the isio library
+# (with and without the read-ahead thread) with iget.  It creates
+# and removes a test file in the current directory and in irods.
+#
+# usage: bench.sh [size-in-MB] [fread-size]
+#
+
+SIZE_MB=${1:-100}
+BUFSIZE=${2:-65536}
+
+set -e
+make bench
+
+dd if=/dev/urandom of=isioBench.dat bs=1048576 count=$SIZE_MB 2>/dev/null
+iput -f isioBench.dat
+
+echo "iget:"
+rm -f isioBench.get
+/usr/bin/time -p iget -f isioBench.dat isioBench.get 2>&1 | grep real
+rm -f isioBench.get
+
+echo "isio, synchronous:"
+isioAsync=0 ./bench irods:isioBench.dat $BUFSIZE
+
+echo "isio, read-ahead:"
+./bench irods:isioBench.dat $BUFSIZE
+
+irm -f isioBench.dat
+rm -f isioBench.dat
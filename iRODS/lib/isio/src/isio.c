@@ -1,6 +1,6 @@
-/* 
+/*
    irods standard i/o emulation library  (initial version)
-   
+
    This package converts Unix standard I/O calls (stdio.h: fopen,
    fread, fwrite, etc) to the equivalent irods calls.  To convert an
    application you just need to add an include statement (isio.h) and
@@ -12,6 +12,19 @@
    Like the fopen family, this library does some caching to avoid
    small I/O (network) calls, greatly improving performance.
 
+   Each open iRODS file also has a stream thread.  After a buffer has
+   been filled by a read, the thread reads the next one from the
+   server while the application works on the current one
+   (read-ahead).  A full write buffer is handed to the thread to be
+   written while the application fills the next one (write-behind).
+   An error of a write done by the thread is returned by the next
+   fwrite, fflush or fclose of the file.  Setting the environment
+   variable isioAsync to 0 turns the threads off.
+
+   The open files are spread over up to isioNumConn (environment
+   variable, default 4) connections to the server so that the
+   transfers of different files do not wait on each other.
+
    The user callable functions are defined in the isio.h and are of
    the form irodsNAME, such as irodsfopen.  Internal function names
    begin with 'isio'.
@@ -26,11 +39,15 @@
  */
 
 #include <stdio.h>
+#include <pthread.h>
 #include "rodsClient.h"
 #include "dataObjRead.h"
 
 #define IRODS_PREFIX "irods:"
-#define ISIO_MAX_OPEN_FILES 20
+#define ISIO_INITIAL_OPEN_FILES 20
+/* The FILE pointers returned for iRODS files are the index in the
+   file table, so the table is kept below the first page */
+#define ISIO_MAX_OPEN_FILES 4096
 #define ISIO_MIN_OPEN_FD 5
 
 /* The following two numberic values are also used by the
@@ -38,46 +55,80 @@
 #define ISIO_INITIAL_BUF_SIZE  65536
 #define ISIO_MAX_BUF_SIZE    2097152
 
+#define ISIO_DEF_NUM_CONN 4
+#define ISIO_MAX_NUM_CONN 16
+
+/* the state of a read-ahead or write-behind */
+#define ISIO_ASYNC_NONE 0
+#define ISIO_ASYNC_PENDING 1   /* the stream thread is to do it */
+#define ISIO_ASYNC_DONE 2      /* read-ahead data is ready */
+
 int debug=0;
 
-long openFiles[ISIO_MAX_OPEN_FILES]={0,0,0,0,0,0,0,0,0,0,
-				     0,0,0,0,0,0,0,0,0,0};
+typedef struct {
+   rcComm_t *conn;
+   int numFiles;  /* open files using this connection */
+   pthread_mutex_t lock;
+} isioConn_t;
 
-struct {
-   FILE *fd;
+typedef struct {
+   int l1descInx;
+   isioConn_t *isioConn;
    char *base;
    int bufferSize;
    char *ptr;
    int count;
    char usingUsersBuffer; /* y or n when active */
    int written; /* contains count of bytes written */
-} cacheInfo[ISIO_MAX_OPEN_FILES];
-
 
-
-static setupFlag=0;
+   /* read-ahead and write-behind, done by the stream thread */
+   char *raBuf;
+   int raBufSize;
+   int raReq;     /* bytes asked for */
+   int raLen;     /* bytes read */
+   int raOff;     /* bytes already used */
+   int raStatus;
+   int raState;
+   char *wbBuf;
+   int wbBufSize;
+   int wbLen;
+   int wbStatus;  /* error not returned yet */
+   int wbState;
+   int thrStarted;
+   int stopFlag;
+   pthread_t thr;
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+} isioFile_t;
+
+isioFile_t **isioFiles=NULL;
+int isioFileTableSize=0;
+
+isioConn_t isioConns[ISIO_MAX_NUM_CONN];
+int isioNumConn=0;
+int isioMaxConn=ISIO_DEF_NUM_CONN;
+int isioAsync=1;
+
+static int setupFlag=0;
 char localZone[100]="";
 rcComm_t *Comm;
 rodsEnv myRodsEnv;
 
+int isioFlush(int fileIndex);
+int isioFileSeek(int fileIndex, long offset, int whence);
+
 int
-isioSetup() {
+isioConnect(rcComm_t **conn) {
    int status;
    rErrMsg_t errMsg;
    char *mySubName;
    char *myName;
 
-   if (debug) printf("isioSetup\n");
-
-   status = getRodsEnv (&myRodsEnv);
-   if (status < 0) {
-      rodsLogError(LOG_ERROR, status, "isioSetup: getRodsEnv error.");
-   }
-   Comm = rcConnect (myRodsEnv.rodsHost, myRodsEnv.rodsPort, 
+   *conn = rcConnect (myRodsEnv.rodsHost, myRodsEnv.rodsPort,
 		     myRodsEnv.rodsUserName,
                      myRodsEnv.rodsZone, 0, &errMsg);
 
-   if (Comm == NULL) {
+   if (*conn == NULL) {
       myName = rodsErrorName(errMsg.status, &mySubName);
       rodsLog(LOG_ERROR, "rcConnect failure %s (%s) (%d) %s",
 	      myName,
@@ -88,18 +139,259 @@ isioSetup() {
       return(status);
    }
 
-   status = clientLogin(Comm);
+   status = clientLogin(*conn);
+   if (status != 0) {
+      rcDisconnect(*conn);
+      *conn = NULL;
+   }
+   return(status);
+}
+
+int
+isioSetup() {
+   int status;
+   char *tmpStr;
+
+   if (debug) printf("isioSetup\n");
+
+   status = getRodsEnv (&myRodsEnv);
+   if (status < 0) {
+      rodsLogError(LOG_ERROR, status, "isioSetup: getRodsEnv error.");
+   }
+
+   if ((tmpStr = getenv("isioNumConn")) != NULL && atoi(tmpStr) > 0) {
+      isioMaxConn = atoi(tmpStr);
+      if (isioMaxConn > ISIO_MAX_NUM_CONN) isioMaxConn = ISIO_MAX_NUM_CONN;
+   }
+   if ((tmpStr = getenv("isioAsync")) != NULL && atoi(tmpStr) == 0) {
+      isioAsync = 0;
+   }
+
+   status = isioConnect(&Comm);
    if (status==0) {
+      isioConns[0].conn = Comm;
+      isioConns[0].numFiles = 0;
+      pthread_mutex_init(&isioConns[0].lock, NULL);
+      isioNumConn = 1;
       setupFlag=1;
    }
    return(status);
 }
 
+/* Get the connection for a new open file: the least used one, or a
+   new one if all are in use and there are fewer than isioMaxConn */
+isioConn_t *
+isioGetConn() {
+   int i, minInx=0;
+
+   for (i=1;i<isioNumConn;i++) {
+      if (isioConns[i].numFiles < isioConns[minInx].numFiles) minInx=i;
+   }
+   if (isioConns[minInx].numFiles > 0 && isioNumConn < isioMaxConn) {
+      i = isioNumConn;
+      if (isioConnect(&isioConns[i].conn) == 0) {
+	 isioConns[i].numFiles = 0;
+	 pthread_mutex_init(&isioConns[i].lock, NULL);
+	 isioNumConn++;
+	 minInx = i;
+      }
+      else {
+	 /* keep sharing the ones we have */
+	 isioMaxConn = isioNumConn;
+      }
+   }
+   return(&isioConns[minInx]);
+}
+
+/* Find a free slot in the file table, growing it if needed */
+int
+isioAllocFileIndex() {
+   int i, newSize;
+   isioFile_t **newFiles;
+
+   for (i=ISIO_MIN_OPEN_FD;i<isioFileTableSize;i++) {
+      if (isioFiles[i]==NULL) return(i);
+   }
+   if (isioFileTableSize >= ISIO_MAX_OPEN_FILES) return(-1);
+   newSize = isioFileTableSize > 0 ? 2*isioFileTableSize :
+             ISIO_INITIAL_OPEN_FILES;
+   if (newSize > ISIO_MAX_OPEN_FILES) newSize = ISIO_MAX_OPEN_FILES;
+   newFiles = (isioFile_t **)realloc(isioFiles,
+				     newSize * sizeof(isioFile_t *));
+   if (newFiles==NULL) return(-1);
+   memset(&newFiles[isioFileTableSize], 0,
+	  (newSize - isioFileTableSize) * sizeof(isioFile_t *));
+   i = isioFileTableSize > ISIO_MIN_OPEN_FD ? isioFileTableSize :
+       ISIO_MIN_OPEN_FD;
+   isioFiles = newFiles;
+   isioFileTableSize = newSize;
+   return(i);
+}
+
+/* The file table index of fi_stream or -1 if it is not an iRODS file */
+int
+isioFileIndex(FILE *fi_stream) {
+   long i;
+   i = (long)fi_stream;
+   if (i<isioFileTableSize && i>=ISIO_MIN_OPEN_FD && isioFiles[i]!=NULL) {
+      return((int)i);
+   }
+   return(-1);
+}
+
+/* The server calls of a file.  The connection may be shared with
+   other files and their stream threads */
+int
+isioServerRead(isioFile_t *isioFile, char *buf, int len) {
+   int status;
+   openedDataObjInp_t dataObjReadInp;
+   bytesBuf_t dataObjReadOutBBuf;
+
+   dataObjReadOutBBuf.buf = buf;
+   dataObjReadOutBBuf.len = len;
+
+   memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
+
+   dataObjReadInp.l1descInx = isioFile->l1descInx;
+   dataObjReadInp.len = len;
+
+   pthread_mutex_lock(&isioFile->isioConn->lock);
+   status = rcDataObjRead (isioFile->isioConn->conn, &dataObjReadInp,
+			   &dataObjReadOutBBuf);
+   pthread_mutex_unlock(&isioFile->isioConn->lock);
+   return(status);
+}
+
+int
+isioServerWrite(isioFile_t *isioFile, char *buf, int len) {
+   int status;
+   openedDataObjInp_t dataObjWriteInp;
+   bytesBuf_t dataObjWriteOutBBuf;
+
+   dataObjWriteOutBBuf.buf = buf;
+   dataObjWriteOutBBuf.len = len;
+
+   memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
+
+   dataObjWriteInp.l1descInx = isioFile->l1descInx;
+   dataObjWriteInp.len = len;
+
+   pthread_mutex_lock(&isioFile->isioConn->lock);
+   status = rcDataObjWrite (isioFile->isioConn->conn, &dataObjWriteInp,
+			    &dataObjWriteOutBBuf);
+   pthread_mutex_unlock(&isioFile->isioConn->lock);
+   return(status);
+}
+
+/* The stream thread of a file; does the pending read-ahead or
+   write-behind */
+void *
+isioStreamThr(void *arg) {
+   isioFile_t *isioFile;
+   int status;
+
+   isioFile = (isioFile_t *)arg;
+   pthread_mutex_lock(&isioFile->lock);
+   while (1) {
+      if (isioFile->wbState == ISIO_ASYNC_PENDING) {
+	 pthread_mutex_unlock(&isioFile->lock);
+	 status = isioServerWrite(isioFile, isioFile->wbBuf,
+				  isioFile->wbLen);
+	 if (debug) printf("isioStreamThr: write-behind %d\n", status);
+	 pthread_mutex_lock(&isioFile->lock);
+	 if (status >= 0 && status != isioFile->wbLen) {
+	    status = SYS_COPY_LEN_ERR;
+	 }
+	 if (status < 0) isioFile->wbStatus = status;
+	 isioFile->wbState = ISIO_ASYNC_NONE;
+	 pthread_cond_broadcast(&isioFile->cond);
+      }
+      else if (isioFile->raState == ISIO_ASYNC_PENDING) {
+	 pthread_mutex_unlock(&isioFile->lock);
+	 status = isioServerRead(isioFile, isioFile->raBuf,
+				 isioFile->raReq);
+	 if (debug) printf("isioStreamThr: read-ahead %d\n", status);
+	 pthread_mutex_lock(&isioFile->lock);
+	 isioFile->raStatus = status < 0 ? status : 0;
+	 isioFile->raLen = status < 0 ? 0 : status;
+	 isioFile->raOff = 0;
+	 isioFile->raState = ISIO_ASYNC_DONE;
+	 pthread_cond_broadcast(&isioFile->cond);
+      }
+      else if (isioFile->stopFlag) {
+	 break;
+      }
+      else {
+	 pthread_cond_wait(&isioFile->cond, &isioFile->lock);
+      }
+   }
+   pthread_mutex_unlock(&isioFile->lock);
+   return(NULL);
+}
+
+int
+isioStartStreamThr(isioFile_t *isioFile) {
+   if (isioFile->thrStarted) return(0);
+   if (pthread_create(&isioFile->thr, NULL, isioStreamThr, isioFile)!=0) {
+      /* do it all in the foreground */
+      return(-1);
+   }
+   isioFile->thrStarted=1;
+   return(0);
+}
+
+/* Wait for the stream thread to finish what it was given */
+void
+isioWaitAsync(isioFile_t *isioFile) {
+   pthread_mutex_lock(&isioFile->lock);
+   while (isioFile->raState == ISIO_ASYNC_PENDING ||
+	  isioFile->wbState == ISIO_ASYNC_PENDING) {
+      pthread_cond_wait(&isioFile->cond, &isioFile->lock);
+   }
+   pthread_mutex_unlock(&isioFile->lock);
+}
+
+/* Drop the read-ahead data.  Returns the number of bytes that had been
+   read from the server but not used, i.e. how far the server offset is
+   ahead of the application */
+int
+isioDropReadAhead(isioFile_t *isioFile) {
+   int unused=0;
+
+   isioWaitAsync(isioFile);
+   if (isioFile->raState == ISIO_ASYNC_DONE) {
+      unused = isioFile->raLen - isioFile->raOff;
+   }
+   isioFile->raState = ISIO_ASYNC_NONE;
+   return(unused);
+}
+
+/* Ask the stream thread to read the next len bytes */
+void
+isioStartReadAhead(isioFile_t *isioFile, int len) {
+   char *newBuf;
+
+   if (isioAsync==0 || isioFile->raState != ISIO_ASYNC_NONE) return;
+   if (isioStartStreamThr(isioFile) < 0) return;
+   if (len > isioFile->raBufSize) {
+      newBuf=(char *)realloc(isioFile->raBuf, len);
+      if (newBuf==NULL) return;
+      isioFile->raBuf = newBuf;
+      isioFile->raBufSize = len;
+   }
+   pthread_mutex_lock(&isioFile->lock);
+   isioFile->raReq = len;
+   isioFile->raState = ISIO_ASYNC_PENDING;
+   pthread_cond_signal(&isioFile->cond);
+   pthread_mutex_unlock(&isioFile->lock);
+}
+
 FILE *isioFileOpen(char *filename, char *modes) {
    int i;
    int status;
    dataObjInp_t dataObjInp;
-   char **outPath;
+   isioFile_t *isioFile;
+   isioConn_t *isioConn;
 
    if (debug) printf("isioFileOpen: %s\n", filename);
 
@@ -108,10 +400,8 @@ FILE *isioFileOpen(char *filename, char *modes) {
       if (status) return(NULL);
    }
 
-   for (i=ISIO_MIN_OPEN_FD;i<ISIO_MAX_OPEN_FILES;i++) {
-     if (openFiles[i]==0) break;
-   }
-   if (i>=ISIO_MAX_OPEN_FILES) {
+   i = isioAllocFileIndex();
+   if (i<0) {
      fprintf(stderr,"Too many open files in isioFileOpen\n");
      return(NULL);
    }
@@ -135,32 +425,46 @@ FILE *isioFileOpen(char *filename, char *modes) {
       dataObjInp.openFlags = O_RDWR;
    }
 
-   status = rcDataObjOpen (Comm, &dataObjInp);
+   isioConn = isioGetConn();
+   pthread_mutex_lock(&isioConn->lock);
+   status = rcDataObjOpen (isioConn->conn, &dataObjInp);
 
    if (status==CAT_NO_ROWS_FOUND &&
        dataObjInp.openFlags == O_WRONLY) {
-      status = rcDataObjCreate(Comm, &dataObjInp);
+      status = rcDataObjCreate(isioConn->conn, &dataObjInp);
    }
+   pthread_mutex_unlock(&isioConn->lock);
    if (status < 0) {
       rodsLogError (LOG_ERROR, status, "isioFileOpen");
       return(NULL);
    }
-   openFiles[i]=status;
-   cacheInfo[i].base=(char *)malloc(sizeof(char) * ISIO_INITIAL_BUF_SIZE);
-   if (cacheInfo[i].base==NULL) {
+
+   isioFile=(isioFile_t *)calloc(1, sizeof(isioFile_t));
+   if (isioFile==NULL) {
+      fprintf(stderr,"Memory Allocation error\n");
+      return(NULL);
+   }
+   isioFile->base=(char *)malloc(sizeof(char) * ISIO_INITIAL_BUF_SIZE);
+   if (isioFile->base==NULL) {
       fprintf(stderr,"Memory Allocation error\n");
+      free(isioFile);
       return(NULL);
    }
-   cacheInfo[i].bufferSize = sizeof(char) * ISIO_INITIAL_BUF_SIZE;
-   cacheInfo[i].ptr=cacheInfo[i].base;
-   cacheInfo[i].count = 0;
-   cacheInfo[i].usingUsersBuffer = 'n';
-   cacheInfo[i].written = 0;
-   return((FILE *)i);
+   isioFile->l1descInx = status;
+   isioFile->isioConn = isioConn;
+   isioFile->bufferSize = sizeof(char) * ISIO_INITIAL_BUF_SIZE;
+   isioFile->ptr=isioFile->base;
+   isioFile->count = 0;
+   isioFile->usingUsersBuffer = 'n';
+   isioFile->written = 0;
+   pthread_mutex_init(&isioFile->lock, NULL);
+   pthread_cond_init(&isioFile->cond, NULL);
+   isioConn->numFiles++;
+   isioFiles[i]=isioFile;
+   return((FILE *)(long)i);
 }
 
 FILE *irodsfopen(char *filename, char *modes) {
-   int status;
    int len;
 
    if (debug) printf("irodsfopen: %s\n", filename);
@@ -174,45 +478,68 @@ FILE *irodsfopen(char *filename, char *modes) {
    }
 }
 
+/* Fill the buffer, first from the read-ahead and then from the
+   server, and start reading the next buffer in the background */
 int
 isioFillBuffer(int fileIndex) {
-   int status, i;
-   openedDataObjInp_t dataObjReadInp;
-   bytesBuf_t dataObjReadOutBBuf;
+   int status;
+   isioFile_t *isioFile;
+   int want, got=0;
+   int eof=0;
 
    if (debug) printf("isioFillBuffer: %d\n", fileIndex);
 
-   i = fileIndex;
-   dataObjReadOutBBuf.buf = cacheInfo[i].base;
-   dataObjReadOutBBuf.len = cacheInfo[i].bufferSize;
+   isioFile = isioFiles[fileIndex];
+   want = isioFile->bufferSize;
 
-   memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
-
-   dataObjReadInp.l1descInx = openFiles[fileIndex];
-   dataObjReadInp.len = cacheInfo[i].bufferSize;
+   pthread_mutex_lock(&isioFile->lock);
+   while (isioFile->raState == ISIO_ASYNC_PENDING) {
+      pthread_cond_wait(&isioFile->cond, &isioFile->lock);
+   }
+   if (isioFile->raState == ISIO_ASYNC_DONE) {
+      if (isioFile->raStatus < 0) {
+	 status = isioFile->raStatus;
+	 isioFile->raState = ISIO_ASYNC_NONE;
+	 pthread_mutex_unlock(&isioFile->lock);
+	 return(status);
+      }
+      got = isioFile->raLen - isioFile->raOff;
+      if (got > want) got = want;
+      memcpy(isioFile->base, isioFile->raBuf + isioFile->raOff, got);
+      isioFile->raOff += got;
+      if (isioFile->raOff >= isioFile->raLen) {
+	 /* a short read-ahead means the end of file */
+	 if (isioFile->raLen < isioFile->raReq) eof=1;
+	 isioFile->raState = ISIO_ASYNC_NONE;
+      }
+   }
+   pthread_mutex_unlock(&isioFile->lock);
 
-   status = rcDataObjRead (Comm, &dataObjReadInp,
-			   &dataObjReadOutBBuf);
+   if (got < want && eof==0) {
+      status = isioServerRead(isioFile, isioFile->base + got, want - got);
+      if (debug) printf("isioFillBuffer rcDataObjRead stat: %d\n", status);
+      if (status < 0) return(status);
+      if (status < want - got) eof=1;
+      got += status;
+   }
 
-   if (debug) printf("isioFillBuffer rcDataObjRead stat: %d\n", status);
-   if (status < 0) return(status);
+   isioFile->ptr = isioFile->base;
+   isioFile->count = got;
 
-   cacheInfo[i].ptr = cacheInfo[i].base;
-   cacheInfo[i].count = status;
+   if (eof==0 && got > 0) isioStartReadAhead(isioFile, want);
 
    return(0);
 }
 
 int
 isioFileRead(int fileIndex, void *buffer, int maxToRead) {
-   int status, i;
+   int status;
    int reqSize;
    char *myPtr;
-   openedDataObjInp_t dataObjReadInp;
-   bytesBuf_t dataObjReadOutBBuf;
    int count;
    int toMove;
    int newBufSize;
+   isioFile_t *isioFile;
 
    if (debug) printf("isioFileRead: %d\n", fileIndex);
 
@@ -220,104 +547,90 @@ isioFileRead(int fileIndex, void *buffer, int maxToRead) {
    status = isioFlush(fileIndex);
    if (status<0) return(status);
 
+   isioFile = isioFiles[fileIndex];
    reqSize = maxToRead;
    myPtr = buffer;
-   if (cacheInfo[fileIndex].count > 0) {
-      if (cacheInfo[fileIndex].count >= reqSize) {
-	 memcpy(myPtr,cacheInfo[fileIndex].ptr, reqSize);
-	 cacheInfo[fileIndex].ptr += reqSize;
-	 cacheInfo[fileIndex].count -= reqSize;
+   if (isioFile->count > 0) {
+      if (isioFile->count >= reqSize) {
+	 memcpy(myPtr,isioFile->ptr, reqSize);
+	 isioFile->ptr += reqSize;
+	 isioFile->count -= reqSize;
 	 return(maxToRead);
       }
       else {
-	 memcpy(myPtr,cacheInfo[fileIndex].ptr, cacheInfo[fileIndex].count);
-	 cacheInfo[fileIndex].ptr += cacheInfo[fileIndex].count;
-	 reqSize -=  cacheInfo[fileIndex].count;
-	 myPtr += cacheInfo[fileIndex].count;
-	 cacheInfo[fileIndex].count = 0;
+	 memcpy(myPtr,isioFile->ptr, isioFile->count);
+	 isioFile->ptr += isioFile->count;
+	 reqSize -=  isioFile->count;
+	 myPtr += isioFile->count;
+	 isioFile->count = 0;
       }
    }
 
    newBufSize=(2*maxToRead)+8;
-   i = fileIndex;
 
-   if (cacheInfo[i].usingUsersBuffer == 'y') {
+   if (isioFile->usingUsersBuffer == 'y') {
       /* previous time we used user's buffer, this time either
          allocate a new one or use their's this time too. */
-      cacheInfo[i].bufferSize = 0;
+      isioFile->bufferSize = 0;
    }
 
-   if (newBufSize > cacheInfo[i].bufferSize) {
+   if (newBufSize > isioFile->bufferSize) {
       if (newBufSize<=ISIO_MAX_BUF_SIZE) {
-	 if (cacheInfo[i].usingUsersBuffer=='n') {
+	 if (isioFile->usingUsersBuffer=='n') {
 	    if (debug) printf("isioFileRead calling free\n");
-	    free(cacheInfo[i].base);
+	    free(isioFile->base);
 	 }
 	 if (debug) printf("isioFileRead calling malloc\n");
-	 cacheInfo[i].base=(char *)malloc(newBufSize);
-	 if (cacheInfo[i].base==NULL) {
+	 isioFile->base=(char *)malloc(newBufSize);
+	 if (isioFile->base==NULL) {
 	    fprintf(stderr,"Memory Allocation error\n");
 	    return(0);
 	 }
-	 cacheInfo[i].bufferSize = newBufSize;
-	 cacheInfo[i].usingUsersBuffer = 'n';
+	 isioFile->bufferSize = newBufSize;
+	 isioFile->usingUsersBuffer = 'n';
       }
       else {
          /* Use user's buffer */
-	 cacheInfo[i].base=buffer;
-	 cacheInfo[i].bufferSize = maxToRead;
-	 cacheInfo[i].usingUsersBuffer = 'y';
+	 isioFile->base=myPtr;
+	 isioFile->bufferSize = reqSize;
+	 isioFile->usingUsersBuffer = 'y';
       }
-      cacheInfo[i].ptr=cacheInfo[i].base;
-      cacheInfo[i].count = 0;
+      isioFile->ptr=isioFile->base;
+      isioFile->count = 0;
    }
 
    status = isioFillBuffer(fileIndex);
    if (status<0) return(status);
 
-   if (cacheInfo[i].usingUsersBuffer=='y') {
-      count = cacheInfo[fileIndex].count;
-      cacheInfo[fileIndex].count = 0;
+   if (isioFile->usingUsersBuffer=='y') {
+      count = (myPtr - (char *)buffer) + isioFile->count;
+      isioFile->count = 0;
       if (debug) printf("isioFileRead return1: %d\n", count);
       return(count);
    }
-   if (cacheInfo[fileIndex].count > 0) {
+   if (isioFile->count > 0) {
       toMove = reqSize;
-      if (cacheInfo[fileIndex].count < reqSize) {
-	 toMove=cacheInfo[fileIndex].count;
+      if (isioFile->count < reqSize) {
+	 toMove=isioFile->count;
       }
-      memcpy(myPtr,cacheInfo[fileIndex].ptr, toMove);
-      cacheInfo[fileIndex].ptr += toMove;
-      cacheInfo[fileIndex].count -= toMove;
+      memcpy(myPtr,isioFile->ptr, toMove);
+      isioFile->ptr += toMove;
+      isioFile->count -= toMove;
       myPtr += toMove;
       reqSize -= toMove;
    }
-   count = (void *)myPtr-buffer;
+   count = myPtr-(char *)buffer;
    if (debug) printf("isioFileRead return2: %d\n", count);
    return(count);
-
-#if 0
-   /* equivalent without caching */
-   dataObjReadOutBBuf.buf = buffer;
-   dataObjReadOutBBuf.len = maxToRead;
-
-   memset(&dataObjReadInp, 0, sizeof (dataObjReadInp));
-
-   dataObjReadInp.l1descInx = openFiles[fileIndex];
-   dataObjReadInp.len = maxToRead;
-
-   return(rcDataObjRead (Comm, &dataObjReadInp,
-			 &dataObjReadOutBBuf));
-#endif
 }
 
 size_t irodsfread(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioFileIndex(fi_stream);
 
    if (debug) printf("isiofread: %d\n", i);
 
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileRead(i, buffer, itemsize*nitems));
    }
    else {
@@ -325,58 +638,107 @@ size_t irodsfread(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
    }
 }
 
+/* Hand the write buffer to the stream thread.  Waits if the previous
+   one is still being written */
+int
+isioWriteBehind(int fileIndex) {
+   int status;
+   isioFile_t *isioFile;
+   char *newBuf;
+
+   isioFile = isioFiles[fileIndex];
+   if (isioFile->written <= 0) return(0);
+
+   if (isioAsync==0 || isioStartStreamThr(isioFile) < 0) {
+      status = isioServerWrite(isioFile, isioFile->base,
+			       isioFile->written);
+      if (debug) printf("isioWriteBehind: writing %d %d\n",
+			isioFile->written, status);
+      if (status < 0) return(status);
+      isioFile->ptr = isioFile->base;
+      isioFile->written = 0;
+      return(0);
+   }
+
+   pthread_mutex_lock(&isioFile->lock);
+   while (isioFile->wbState == ISIO_ASYNC_PENDING) {
+      pthread_cond_wait(&isioFile->cond, &isioFile->lock);
+   }
+   if (isioFile->wbStatus < 0) {
+      status = isioFile->wbStatus;
+      isioFile->wbStatus = 0;
+      pthread_mutex_unlock(&isioFile->lock);
+      return(status);
+   }
+   if (isioFile->written > isioFile->wbBufSize) {
+      newBuf = (char *)realloc(isioFile->wbBuf, isioFile->written);
+      if (newBuf==NULL) {
+	 pthread_mutex_unlock(&isioFile->lock);
+	 fprintf(stderr,"Memory Allocation error\n");
+	 return(SYS_MALLOC_ERR);
+      }
+      isioFile->wbBuf = newBuf;
+      isioFile->wbBufSize = isioFile->written;
+   }
+   if (debug) printf("isioWriteBehind: queueing %d\n", isioFile->written);
+   memcpy(isioFile->wbBuf, isioFile->base, isioFile->written);
+   isioFile->wbLen = isioFile->written;
+   isioFile->wbState = ISIO_ASYNC_PENDING;
+   pthread_cond_signal(&isioFile->cond);
+   pthread_mutex_unlock(&isioFile->lock);
+
+   isioFile->ptr = isioFile->base;
+   isioFile->written = 0;
+   return(0);
+}
+
 int
 isioFileWrite(int fileIndex, void *buffer, int countToWrite) {
    int status;
    int spaceInBuffer;
    int newBufSize;
-
-   openedDataObjInp_t dataObjWriteInp;
-   bytesBuf_t dataObjWriteOutBBuf;
+   int unused;
+   isioFile_t *isioFile;
 
    if (debug) printf("isioFileWrite: %d\n", fileIndex);
 
-   if (cacheInfo[fileIndex].count > 0) {
+   isioFile = isioFiles[fileIndex];
+   unused = isioDropReadAhead(isioFile);
+   if (isioFile->count > 0 || unused > 0) {
       /* buffer has read data in it, so seek to where the
          the app thinks the pointer is and disgard the buffered
          read data */
       long offset;
-      offset = - cacheInfo[fileIndex].count;
+      offset = - (isioFile->count + unused);
       status = isioFileSeek(fileIndex, offset, SEEK_CUR);
       if (status) return(status);
-      cacheInfo[fileIndex].ptr=cacheInfo[fileIndex].base;
-      cacheInfo[fileIndex].count = 0;
+      isioFile->ptr=isioFile->base;
+      isioFile->count = 0;
    }
 
-   spaceInBuffer = cacheInfo[fileIndex].bufferSize -
-                   cacheInfo[fileIndex].written;
-                   
+   spaceInBuffer = isioFile->bufferSize -
+                   isioFile->written;
+
    if (debug) printf("isioFileWrite: spaceInBuffer %d\n", spaceInBuffer);
    if (countToWrite < spaceInBuffer) {
       /* Fits in the buffer, just cache it */
-      if (debug) printf("isioFileWrite: caching 1 %x %d\n", 
-			(int) cacheInfo[fileIndex].ptr, countToWrite);
-      memcpy(cacheInfo[fileIndex].ptr, buffer, countToWrite);
-      cacheInfo[fileIndex].ptr += countToWrite;
-      cacheInfo[fileIndex].written += countToWrite;
+      if (debug) printf("isioFileWrite: caching 1 %p %d\n",
+			isioFile->ptr, countToWrite);
+      memcpy(isioFile->ptr, buffer, countToWrite);
+      isioFile->ptr += countToWrite;
+      isioFile->written += countToWrite;
       return(countToWrite);
    }
 
-   status = isioFlush(fileIndex); /* if anything is buffered, flush it */
+   /* if anything is buffered, have it written in the background */
+   status = isioWriteBehind(fileIndex);
    if (status < 0) return(status);
 
    if (countToWrite > ISIO_MAX_BUF_SIZE) {
-      /* Too big to cache, just send it */
-      dataObjWriteOutBBuf.buf = buffer;
-      dataObjWriteOutBBuf.len = countToWrite;
-
-      memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
-
-      dataObjWriteInp.l1descInx = openFiles[fileIndex];
-      dataObjWriteInp.len = countToWrite;
-
-      status = rcDataObjWrite (Comm, &dataObjWriteInp,
-				&dataObjWriteOutBBuf);
+      /* Too big to cache, just send it after what is queued */
+      status = isioFlush(fileIndex);
+      if (status < 0) return(status);
+      status = isioServerWrite(isioFile, buffer, countToWrite);
       if (debug) printf("isioFileWrite: rcDataWrite 2 %d\n", status);
       if (status < 0) return(status);
 
@@ -388,55 +750,39 @@ isioFileWrite(int fileIndex, void *buffer, int countToWrite) {
       newBufSize = ISIO_MAX_BUF_SIZE;
    }
 
-   if (newBufSize > cacheInfo[fileIndex].bufferSize) {
+   if (newBufSize > isioFile->bufferSize) {
        /* free old and make new larger buffer */
-      int i=fileIndex;
-      if (cacheInfo[i].usingUsersBuffer=='n') {
+      if (isioFile->usingUsersBuffer=='n') {
 	 if (debug) printf("isioFilewrite calling free\n");
-	 free(cacheInfo[i].base);
+	 free(isioFile->base);
       }
       if (debug) printf("isioFilewrite calling malloc %d\n",
 			newBufSize);
-      cacheInfo[i].base=(char *)malloc(newBufSize);
-      if (cacheInfo[i].base==NULL) {
+      isioFile->base=(char *)malloc(newBufSize);
+      if (isioFile->base==NULL) {
 	 fprintf(stderr,"Memory Allocation error\n");
 	 return(0);
       }
-      cacheInfo[i].bufferSize = newBufSize;
-      cacheInfo[i].usingUsersBuffer = 'n';
-      cacheInfo[i].ptr=cacheInfo[i].base;
+      isioFile->bufferSize = newBufSize;
+      isioFile->usingUsersBuffer = 'n';
+      isioFile->ptr=isioFile->base;
    }
 
    /* Now it fits in the buffer, so cache it */
-   if (debug) printf("isioFileWrite: caching 2 %x %d\n", 
-		     (int) cacheInfo[fileIndex].ptr, countToWrite);
-   memcpy(cacheInfo[fileIndex].ptr, buffer, countToWrite);
-   cacheInfo[fileIndex].ptr += countToWrite;
-   cacheInfo[fileIndex].count -= countToWrite; //??
-   cacheInfo[fileIndex].written += countToWrite;
+   if (debug) printf("isioFileWrite: caching 2 %p %d\n",
+		     isioFile->ptr, countToWrite);
+   memcpy(isioFile->ptr, buffer, countToWrite);
+   isioFile->ptr += countToWrite;
+   isioFile->written += countToWrite;
    return(countToWrite);
-
-#if 0
-/* non-caching version */
-   dataObjWriteOutBBuf.buf = buffer;
-   dataObjWriteOutBBuf.len = countToWrite;
-
-   memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
-
-   dataObjWriteInp.l1descInx = openFiles[fileIndex];
-   dataObjWriteInp.len = countToWrite;
-
-   return(rcDataObjWrite (Comm, &dataObjWriteInp,
-			 &dataObjWriteOutBBuf));
-#endif
 }
 
-size_t 
+size_t
 irodsfwrite(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioFileIndex(fi_stream);
    if (debug) printf("irodsfwrite: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileWrite(i, buffer, itemsize*nitems));
    }
    else {
@@ -447,36 +793,54 @@ irodsfwrite(void *buffer, size_t itemsize, int nitems, FILE *fi_stream) {
 int
 isioFileClose(int fileIndex) {
    openedDataObjInp_t dataObjCloseInp;
-   int i, status;
+   int status, flushStatus;
+   isioFile_t *isioFile;
 
    if (debug) printf("isioFileClose: %d\n", fileIndex);
 
    /* If the buffer had been used for writing, flush it */
-   status = isioFlush(fileIndex);
-   if (status<0) return(status);
+   flushStatus = isioFlush(fileIndex);
 
+   isioFile = isioFiles[fileIndex];
+   isioDropReadAhead(isioFile);
+   if (isioFile->thrStarted) {
+      pthread_mutex_lock(&isioFile->lock);
+      isioFile->stopFlag = 1;
+      pthread_cond_signal(&isioFile->cond);
+      pthread_mutex_unlock(&isioFile->lock);
+      pthread_join(isioFile->thr, NULL);
+   }
 
    memset (&dataObjCloseInp, 0, sizeof (dataObjCloseInp));
-   dataObjCloseInp.l1descInx = openFiles[fileIndex];
+   dataObjCloseInp.l1descInx = isioFile->l1descInx;
 
-   openFiles[fileIndex]=0;
+   isioFiles[fileIndex]=NULL;
 
-   i = fileIndex;
-   if (cacheInfo[i].usingUsersBuffer == 'n') {
+   if (isioFile->usingUsersBuffer == 'n') {
       if (debug) printf("isioFileClose calling free\n");
-      free(cacheInfo[i].base);
+      free(isioFile->base);
    }
+   if (isioFile->raBuf != NULL) free(isioFile->raBuf);
+   if (isioFile->wbBuf != NULL) free(isioFile->wbBuf);
+
+   pthread_mutex_lock(&isioFile->isioConn->lock);
+   status = rcDataObjClose(isioFile->isioConn->conn, &dataObjCloseInp);
+   pthread_mutex_unlock(&isioFile->isioConn->lock);
+   isioFile->isioConn->numFiles--;
 
-   cacheInfo[i].usingUsersBuffer = ' ';
+   pthread_mutex_destroy(&isioFile->lock);
+   pthread_cond_destroy(&isioFile->cond);
+   free(isioFile);
 
-   return(rcDataObjClose(Comm, &dataObjCloseInp));
+   if (flushStatus<0) return(flushStatus);
+   return(status);
 }
 
 size_t irodsfclose(FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioFileIndex(fi_stream);
    if (debug) printf("isiofclose: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileClose(i));
    }
    else {
@@ -490,24 +854,42 @@ isioFileSeek(int fileIndex, long offset, int whence) {
    openedDataObjInp_t seekParam;
    fileLseekOut_t* seekResult = NULL;
    int status;
+   isioFile_t *isioFile;
+
    if (debug) printf("isioFileSeek: %d\n", fileIndex);
+   isioFile = isioFiles[fileIndex];
    memset( &seekParam,  0, sizeof(openedDataObjInp_t) );
-   seekParam.l1descInx = openFiles[fileIndex];
+   seekParam.l1descInx = isioFile->l1descInx;
    seekParam.offset  = offset;
    seekParam.whence  = whence;
-   status = rcDataObjLseek(Comm, &seekParam, &seekResult );
+   pthread_mutex_lock(&isioFile->isioConn->lock);
+   status = rcDataObjLseek(isioFile->isioConn->conn, &seekParam,
+			   &seekResult );
+   pthread_mutex_unlock(&isioFile->isioConn->lock);
    if ( status < 0 ) {
       rodsLogError (LOG_ERROR, status, "isioFileSeek");
    }
+   if (seekResult != NULL) free(seekResult);
    return(status);
 }
 
 int
 irodsfseek(FILE *fi_stream, long offset, int whence) {
-   int i;
-   i = (int)fi_stream;
+   int i, status, unused;
+   isioFile_t *isioFile;
+
+   i = isioFileIndex(fi_stream);
    if (debug) printf("isiofseek: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
+      /* the server offset is ahead of the application by what has
+         been read but not used */
+      status = isioFlush(i);
+      if (status<0) return(status);
+      isioFile = isioFiles[i];
+      unused = isioDropReadAhead(isioFile);
+      if (whence == SEEK_CUR) offset -= isioFile->count + unused;
+      isioFile->ptr = isioFile->base;
+      isioFile->count = 0;
       return(isioFileSeek(i,offset,whence));
    }
    else {
@@ -515,46 +897,36 @@ irodsfseek(FILE *fi_stream, long offset, int whence) {
    }
 }
 
+/* Write what is buffered and wait for the stream thread to have
+   written it all */
 int
 isioFlush(int fileIndex) {
-   int i;
    int status;
-   openedDataObjInp_t dataObjWriteInp;
-   bytesBuf_t dataObjWriteOutBBuf;
-
-   i = fileIndex;
-   if (debug) printf("isioFlush: %d\n", i);
-   if (cacheInfo[i].written > 0) {
+   isioFile_t *isioFile;
 
-      dataObjWriteOutBBuf.buf = cacheInfo[i].base;
-      dataObjWriteOutBBuf.len = cacheInfo[i].written;
+   if (debug) printf("isioFlush: %d\n", fileIndex);
 
-      memset(&dataObjWriteInp, 0, sizeof (dataObjWriteInp));
-
-      dataObjWriteInp.l1descInx = openFiles[fileIndex];
-      dataObjWriteInp.len = cacheInfo[i].written;
-
-      if (debug) printf("isioFlush: writing %d\n", 
-			cacheInfo[i].written);
-      status = rcDataObjWrite (Comm, &dataObjWriteInp,
-			       &dataObjWriteOutBBuf);
-      if (status >=0) {
-	 cacheInfo[i].ptr = cacheInfo[i].base;
-	 cacheInfo[i].written = 0;
-      }
-      return(status);
+   status = isioWriteBehind(fileIndex);
+   if (status < 0) return(status);
 
+   isioFile = isioFiles[fileIndex];
+   pthread_mutex_lock(&isioFile->lock);
+   while (isioFile->wbState == ISIO_ASYNC_PENDING) {
+      pthread_cond_wait(&isioFile->cond, &isioFile->lock);
    }
-   return(0);
+   status = isioFile->wbStatus;
+   isioFile->wbStatus = 0;
+   pthread_mutex_unlock(&isioFile->lock);
+   return(status);
 }
 
 
 int
 irodsfflush(FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioFileIndex(fi_stream);
    if (debug) printf("isiofflush: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFlush(i));
    }
    else {
@@ -564,7 +936,7 @@ irodsfflush(FILE *fi_stream) {
 
 int
 isioFilePutc(int inchar, int fileIndex) {
-   int mychar;
+   char mychar;
    mychar = inchar;
    return (isioFileWrite(fileIndex, (void*)&mychar, 1));
 }
@@ -572,9 +944,9 @@ isioFilePutc(int inchar, int fileIndex) {
 int
 irodsfputc(int inchar, FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioFileIndex(fi_stream);
    if (debug) printf("isiofputc: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFilePutc(inchar, i));
    }
    else {
@@ -584,7 +956,7 @@ irodsfputc(int inchar, FILE *fi_stream) {
 
 int
 isioFileGetc(int fileIndex) {
-   int mychar=0;
+   unsigned char mychar=0;
    int status;
    status = isioFileRead(fileIndex, (void*)&mychar, 1);
    if (status==0) return(EOF);
@@ -595,9 +967,9 @@ isioFileGetc(int fileIndex) {
 int
 irodsfgetc(FILE *fi_stream) {
    int i;
-   i = (int)fi_stream;
+   i = isioFileIndex(fi_stream);
    if (debug) printf("isiofgetc: %d\n", i);
-   if (i<ISIO_MAX_OPEN_FILES && i>=ISIO_MIN_OPEN_FD && openFiles[i]>0) {
+   if (i>=0) {
       return(isioFileGetc(i));
    }
    else {
@@ -608,10 +980,12 @@ irodsfgetc(FILE *fi_stream) {
 
 int
 irodsexit(int exitValue) {
-   int status;
+   int i;
    if (debug) printf("irodsexit: %d\n", exitValue);
    if (setupFlag>0) {
-      status = rcDisconnect(Comm);
+      for (i=0;i<isioNumConn;i++) {
+	 rcDisconnect(isioConns[i].conn);
+      }
    }
    exit(exitValue);
 }
@@ -127,7 +127,11 @@ int verifyChksumLocFile(char *fileName, char *myChksum, char *chksumStr) {
     use_sha256 = status; 
     
     /* verify the chksum */
+    if ((status = getCompositeNumSeg (myChksum)) > 0) {
+	status = compositeChksumLocFile (fileName, status, chksumStr);
+    } else {
 	status = chksumLocFile (fileName, chksumStr, use_sha256);
+    }
 	if (status < 0) {
 	    return (status);
 	}
@@ -199,6 +203,258 @@ chksumLocFile (char *fileName, char *chksumStr, int use_sha256)
     return (0);
 }
 
+/* compositeChksumLocFile - the composite chksum of a local file as if it
+ * had been transferred in numSeg parallel segments.
+ */
+int
+compositeChksumLocFile (char *fileName, int numSeg, char *chksumStr)
+{
+    FILE *file;
+    struct stat statbuf;
+    inlineChksum_t *inlineChksum;
+    rodsLong_t offset = 0;
+    int len;
+    unsigned char buffer[MD5_BUF_SZ];
+    int status;
+
+    if ((file = fopen (fileName, "rb")) == NULL) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLogError (LOG_NOTICE, status,
+        "compositeChksumLocFile; fopen failed for %s. status = %d",
+          fileName, status);
+        return (status);
+    }
+    if (fstat (fileno (file), &statbuf) < 0) {
+        status = UNIX_FILE_STAT_ERR - errno;
+        fclose (file);
+        return (status);
+    }
+    inlineChksum = (inlineChksum_t *) malloc (sizeof (inlineChksum_t));
+    status = initInlineChksum (inlineChksum, numSeg, statbuf.st_size, 0);
+    if (status < 0) {
+        free (inlineChksum);
+        fclose (file);
+        return (status);
+    }
+    while ((len = fread (buffer, 1, MD5_BUF_SZ, file)) > 0) {
+        updateInlineChksum (inlineChksum, offset, buffer, len);
+        offset += len;
+    }
+    fclose (file);
+
+    status = finalInlineChksum (inlineChksum, offset, chksumStr);
+    free (inlineChksum);
+    return (status);
+}
+
+int
+initChksumCtx (chksumCtx_t *chksumCtx, int use_sha256, rodsLong_t offset)
+{
+    chksumCtx->offset = offset;
+#ifdef SHA256_FILE_HASH
+    chksumCtx->useSha256 = use_sha256;
+    if (use_sha256) {
+        SHA256_Init (&chksumCtx->sha256Ctx);
+        return (0);
+    }
+#else
+    if (use_sha256) return (UNSUPPORTED_HASH_TYPE_USED);
+    chksumCtx->useSha256 = 0;
+#endif
+    MD5Init (&chksumCtx->md5Ctx);
+    return (0);
+}
+
+/* updateChksumCtx - add len bytes of data at offset to the digest. The
+ * digest is given up if the data does not follow the previous update.
+ */
+int
+updateChksumCtx (chksumCtx_t *chksumCtx, rodsLong_t offset,
+unsigned char *buf, int len)
+{
+    if (chksumCtx->offset < 0) return (0);
+    if (offset != chksumCtx->offset) {
+        chksumCtx->offset = -1;
+        return (0);
+    }
+#ifdef SHA256_FILE_HASH
+    if (chksumCtx->useSha256) {
+        SHA256_Update (&chksumCtx->sha256Ctx, buf, len);
+    } else {
+        MD5Update (&chksumCtx->md5Ctx, buf, len);
+    }
+#else
+    MD5Update (&chksumCtx->md5Ctx, buf, len);
+#endif
+    chksumCtx->offset += len;
+    return (0);
+}
+
+/* finalChksumCtx - put the digest so far in digest and return its length.
+ * chksumCtx itself is not finalized so it can be done again.
+ */
+int
+finalChksumCtx (chksumCtx_t *chksumCtx, unsigned char *digest)
+{
+    chksumCtx_t myCtx = *chksumCtx;
+
+#ifdef SHA256_FILE_HASH
+    if (myCtx.useSha256) {
+        SHA256_Final (digest, &myCtx.sha256Ctx);
+        return (SHA256_DIGEST_LENGTH);
+    }
+#endif
+    MD5Final (digest, &myCtx.md5Ctx);
+    return (16);
+}
+
+static rodsLong_t
+getChksumSegEnd (inlineChksum_t *inlineChksum, int segInx)
+{
+    if (segInx >= inlineChksum->numSeg - 1) return (inlineChksum->dataSize);
+    return ((segInx + 1) * (inlineChksum->dataSize / inlineChksum->numSeg));
+}
+
+int
+initInlineChksum (inlineChksum_t *inlineChksum, int numSeg,
+rodsLong_t dataSize, int use_sha256)
+{
+    int i, status;
+
+    memset (inlineChksum, 0, sizeof (inlineChksum_t));
+    if (numSeg <= 0 || numSeg > MAX_NUM_CONFIG_TRAN_THR)
+        return (SYS_INVALID_INPUT_PARAM);
+    /* the composite is md5 only */
+    if (numSeg > 1 && use_sha256) return (UNSUPPORTED_HASH_TYPE_USED);
+
+    inlineChksum->numSeg = numSeg;
+    inlineChksum->dataSize = dataSize;
+    for (i = 0; i < numSeg; i++) {
+        status = initChksumCtx (&inlineChksum->segCtx[i], use_sha256,
+          i * (dataSize / numSeg));
+        if (status < 0) {
+            inlineChksum->numSeg = 0;
+            return (status);
+        }
+    }
+    return (0);
+}
+
+/* updateInlineChksum - add len bytes of data at offset to the digest of
+ * the segment(s) they are in. Each segment takes its data in order, so
+ * different threads may update different segments at the same time.
+ */
+int
+updateInlineChksum (inlineChksum_t *inlineChksum, rodsLong_t offset,
+unsigned char *buf, int len)
+{
+    int segInx, myLen;
+    rodsLong_t size0, segEnd;
+
+    if (inlineChksum == NULL || inlineChksum->numSeg <= 0) return (0);
+    if (inlineChksum->numSeg == 1) {
+        return (updateChksumCtx (&inlineChksum->segCtx[0], offset, buf, len));
+    }
+
+    size0 = inlineChksum->dataSize / inlineChksum->numSeg;
+    while (len > 0) {
+        if (size0 > 0) {
+            segInx = offset / size0;
+        } else {
+            segInx = inlineChksum->numSeg - 1;
+        }
+        if (segInx >= inlineChksum->numSeg)
+            segInx = inlineChksum->numSeg - 1;
+        segEnd = getChksumSegEnd (inlineChksum, segInx);
+        myLen = len;
+        if (segInx < inlineChksum->numSeg - 1 && offset + myLen > segEnd)
+            myLen = segEnd - offset;
+        updateChksumCtx (&inlineChksum->segCtx[segInx], offset, buf, myLen);
+        offset += myLen;
+        buf += myLen;
+        len -= myLen;
+    }
+    return (0);
+}
+
+/* finalInlineChksum - put the chksum of the data in chksumStr. It is the
+ * plain chksum for one segment and the composite chksum otherwise.
+ * Returns SYS_COPY_LEN_ERR if the segments did not get all of the
+ * dataSize bytes in order.
+ */
+int
+finalInlineChksum (inlineChksum_t *inlineChksum, rodsLong_t dataSize,
+char *chksumStr)
+{
+    int i, len;
+    MD5_CTX context;
+    unsigned char digest[64];
+
+    if (inlineChksum == NULL || inlineChksum->numSeg <= 0)
+        return (SYS_INTERNAL_NULL_INPUT_ERR);
+
+    if (inlineChksum->numSeg == 1) {
+        if (dataSize < 0 || inlineChksum->segCtx[0].offset != dataSize)
+            return (SYS_COPY_LEN_ERR);
+        finalChksumCtx (&inlineChksum->segCtx[0], digest);
+#ifdef SHA256_FILE_HASH
+        if (inlineChksum->segCtx[0].useSha256) {
+            sha256ToStr (digest, chksumStr);
+            return (0);
+        }
+#endif
+        md5ToStr (digest, chksumStr);
+        return (0);
+    }
+
+    if (dataSize != inlineChksum->dataSize) return (SYS_COPY_LEN_ERR);
+    MD5Init (&context);
+    for (i = 0; i < inlineChksum->numSeg; i++) {
+        if (inlineChksum->segCtx[i].offset != getChksumSegEnd (inlineChksum, i))
+            return (SYS_COPY_LEN_ERR);
+        len = finalChksumCtx (&inlineChksum->segCtx[i], digest);
+        MD5Update (&context, digest, len);
+    }
+    MD5Final (digest, &context);
+    len = snprintf (chksumStr, CHKSUM_LEN, "%s%d:", COMPOSITE_CHKSUM_PREFIX,
+      inlineChksum->numSeg);
+    md5ToStr (digest, chksumStr + len);
+    return (0);
+}
+
+/* getCompositeNumSeg - returns the number of segments of a composite
+ * chksum, or 0 if chksum is not one */
+int
+getCompositeNumSeg (char *chksum)
+{
+    int numSeg;
+
+    if (chksum == NULL || strncmp (chksum, COMPOSITE_CHKSUM_PREFIX,
+      strlen (COMPOSITE_CHKSUM_PREFIX)) != 0) {
+        return (0);
+    }
+    numSeg = atoi (chksum + strlen (COMPOSITE_CHKSUM_PREFIX));
+    if (numSeg <= 1 || numSeg > MAX_NUM_CONFIG_TRAN_THR) return (0);
+    return (numSeg);
+}
+
+/* matchInlineChksum - returns 1 if the chksum finalInlineChksum gives is
+ * of the same kind as chksum and the two can be compared */
+int
+matchInlineChksum (inlineChksum_t *inlineChksum, char *chksum)
+{
+    int numSeg;
+
+    if (inlineChksum == NULL || inlineChksum->numSeg <= 0 || chksum == NULL)
+        return (0);
+    numSeg = getCompositeNumSeg (chksum);
+    if (numSeg > 0 || inlineChksum->numSeg > 1)
+        return (numSeg == inlineChksum->numSeg);
+    if (extractHashFunction2 (chksum) < 0) return (0);
+    return (extractHashFunction2 (chksum) ==
+      inlineChksum->segCtx[0].useSha256);
+}
+
 int
 md5ToStr (unsigned char *digest, char *chksumStr)
 {
@@ -0,0 +1,35 @@
+#!/bin/bash
+#
+# This script runs genquerybench on a collection of numObjs data
+# objects, with the paged and the streamed query, over an emulated
+# high RTT link (see pipebench.sh).  The collection is created with
+# a bulk iput of empty files if it does not exist yet; this takes a
+# while for a million objects, so keep it for the next runs.  It must
+# be run as root, with irodsHost in .irodsEnv set to localhost.
+#
+# usage: genquerybench.sh [numObjs] [delay-in-ms] [collection]
+#
+
+NUM_OBJS=${1:-1000000}
+DELAY_MS=${2:-25}
+COLL=${3:-genquerybench_$NUM_OBJS}
+
+set -e
+make genquerybench
+
+if ! ils $COLL > /dev/null 2>&1; then
+    TMP_DIR=`mktemp -d`
+    trap "rm -rf $TMP_DIR" EXIT
+    mkdir $TMP_DIR/$COLL
+    (cd $TMP_DIR/$COLL && seq -f "obj%.0f" 1 $NUM_OBJS | xargs touch)
+    iput -bfr $TMP_DIR/$COLL
+    rm -rf $TMP_DIR
+fi
+COLL_PATH=`ipwd`/$COLL
+
+tc qdisc add dev lo root netem delay ${DELAY_MS}ms
+trap "tc qdisc del dev lo root netem" EXIT
+
+echo "RTT $((DELAY_MS * 2)) ms, $NUM_OBJS objects:"
+./genquerybench $COLL_PATH
+./genquerybench -s $COLL_PATH
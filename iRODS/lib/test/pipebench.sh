@@ -0,0 +1,26 @@
+#!/bin/bash
+#
+# This script runs pipebench over an emulated high RTT link, adding
+# a delay to the loopback interface with netem.  It must be run as
+# root, with irodsHost in .irodsEnv set to localhost, and removes
+# the delay when done.
+#
+# usage: pipebench.sh [delay-in-ms] [numOps]
+#
+
+DELAY_MS=${1:-25}
+NUM_OPS=${2:-200}
+
+set -e
+make pipebench
+
+tc qdisc add dev lo root netem delay ${DELAY_MS}ms
+trap "tc qdisc del dev lo root netem" EXIT
+
+echo "RTT $((DELAY_MS * 2)) ms, one request at a time:"
+./pipebench -n $NUM_OPS -d 1
+
+for depth in 4 16 32; do
+    echo "RTT $((DELAY_MS * 2)) ms, pipelined:"
+    ./pipebench -n $NUM_OPS -d $depth -p
+done
@@ -0,0 +1,195 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* bulkavutest.c - test the packing and the limits of bulkAVUMetadataInp_t.
+ * Operations are added with addBulkAVUMetadataOp past the growth of the
+ * arrays, packed and unpacked in NATIVE_PROT and XML_PROT and compared.
+ * The input is then filled up to MAX_BULK_AVU_OPS, which must still pack,
+ * and one more operation must be refused. No server is needed.
+ * Exits with the number of failed checks.
+ */
+
+#include "rodsClient.h"
+
+#define NUM_TEST_OPS	(2 * PTR_ARRAY_MALLOC_LEN + 3)
+
+int
+fillBulkAVUInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, int numOps);
+int
+chkBulkAVUInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, int numOps,
+char *label);
+int
+packBulkAVUInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, int numOps,
+irodsProt_t irodsProt);
+
+int
+main(int argc, char **argv)
+{
+    bulkAVUMetadataInp_t bulkAVUMetadataInp;
+    int errCnt = 0;
+    int status;
+
+    /* empty input */
+    memset (&bulkAVUMetadataInp, 0, sizeof (bulkAVUMetadataInp));
+    errCnt += packBulkAVUInp (&bulkAVUMetadataInp, 0, NATIVE_PROT);
+    errCnt += packBulkAVUInp (&bulkAVUMetadataInp, 0, XML_PROT);
+
+    /* a few grows of the arrays */
+    status = fillBulkAVUInp (&bulkAVUMetadataInp, NUM_TEST_OPS);
+    if (status < 0) {
+        printf ("addBulkAVUMetadataOp failed, status = %d\n", status);
+        errCnt++;
+    } else {
+        errCnt += chkBulkAVUInp (&bulkAVUMetadataInp, NUM_TEST_OPS, "added");
+        errCnt += packBulkAVUInp (&bulkAVUMetadataInp, NUM_TEST_OPS,
+          NATIVE_PROT);
+        errCnt += packBulkAVUInp (&bulkAVUMetadataInp, NUM_TEST_OPS,
+          XML_PROT);
+    }
+    clearBulkAVUMetadataInp (&bulkAVUMetadataInp);
+
+    /* the limit */
+    status = fillBulkAVUInp (&bulkAVUMetadataInp, MAX_BULK_AVU_OPS);
+    if (status < 0) {
+        printf ("addBulkAVUMetadataOp of %d ops failed, status = %d\n",
+          MAX_BULK_AVU_OPS, status);
+        errCnt++;
+    } else {
+        errCnt += packBulkAVUInp (&bulkAVUMetadataInp, MAX_BULK_AVU_OPS,
+          NATIVE_PROT);
+        status = addBulkAVUMetadataOp (&bulkAVUMetadataInp, "add", "-d",
+          "/tempZone/home/rods/over", "attr", "value", NULL);
+        if (status != SYS_INVALID_INPUT_PARAM ||
+          bulkAVUMetadataInp.numOps != MAX_BULK_AVU_OPS) {
+            printf ("op %d past MAX_BULK_AVU_OPS not refused, status = %d\n",
+              bulkAVUMetadataInp.numOps, status);
+            errCnt++;
+        } else {
+            printf ("op past MAX_BULK_AVU_OPS refused ok\n");
+        }
+    }
+    clearBulkAVUMetadataInp (&bulkAVUMetadataInp);
+
+    if (bulkAVUMetadataInp.numOps != 0 || bulkAVUMetadataInp.op != NULL) {
+        printf ("clearBulkAVUMetadataInp did not reset the input\n");
+        errCnt++;
+    }
+
+    printf ("bulkavutest: %d errors\n", errCnt);
+    exit (errCnt);
+}
+
+/* op i is "add" for even i and "rm" for odd i. Every third op has no
+ * units */
+int
+fillBulkAVUInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, int numOps)
+{
+    char objName[MAX_NAME_LEN], attribute[NAME_LEN], value[NAME_LEN];
+    char units[NAME_LEN];
+    int i, status;
+
+    for (i = 0; i < numOps; i++) {
+        snprintf (objName, MAX_NAME_LEN, "/tempZone/home/rods/obj%d", i);
+        snprintf (attribute, NAME_LEN, "attr%d", i);
+        snprintf (value, NAME_LEN, "value%d", i);
+        snprintf (units, NAME_LEN, "units%d", i);
+        status = addBulkAVUMetadataOp (bulkAVUMetadataInp,
+          i % 2 == 0 ? (char *) "add" : (char *) "rm",
+          i % 5 == 0 ? (char *) "-C" : (char *) "-d", objName, attribute,
+          value, i % 3 == 0 ? NULL : units);
+        if (status < 0) return (status);
+    }
+    return (0);
+}
+
+int
+chkBulkAVUInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, int numOps,
+char *label)
+{
+    char str[MAX_NAME_LEN];
+    int i;
+
+    if (bulkAVUMetadataInp->numOps != numOps) {
+        printf ("%s: numOps %d != %d\n", label, bulkAVUMetadataInp->numOps,
+          numOps);
+        return (1);
+    }
+    for (i = 0; i < numOps; i++) {
+        if (bulkAVUMetadataInp->op[i] == NULL ||
+          strcmp (bulkAVUMetadataInp->op[i], i % 2 == 0 ? "add" : "rm") ||
+          bulkAVUMetadataInp->objType[i] == NULL ||
+          strcmp (bulkAVUMetadataInp->objType[i], i % 5 == 0 ? "-C" : "-d")) {
+            printf ("%s: op %d has the wrong op or objType\n", label, i);
+            return (1);
+        }
+        snprintf (str, MAX_NAME_LEN, "/tempZone/home/rods/obj%d", i);
+        if (bulkAVUMetadataInp->objName[i] == NULL ||
+          strcmp (bulkAVUMetadataInp->objName[i], str) != 0) {
+            printf ("%s: op %d has the wrong objName\n", label, i);
+            return (1);
+        }
+        snprintf (str, MAX_NAME_LEN, "attr%d", i);
+        if (bulkAVUMetadataInp->attribute[i] == NULL ||
+          strcmp (bulkAVUMetadataInp->attribute[i], str) != 0) {
+            printf ("%s: op %d has the wrong attribute\n", label, i);
+            return (1);
+        }
+        snprintf (str, MAX_NAME_LEN, "value%d", i);
+        if (bulkAVUMetadataInp->value[i] == NULL ||
+          strcmp (bulkAVUMetadataInp->value[i], str) != 0) {
+            printf ("%s: op %d has the wrong value\n", label, i);
+            return (1);
+        }
+        /* no units is sent as an empty one */
+        if (i % 3 == 0) {
+            str[0] = '\0';
+        } else {
+            snprintf (str, MAX_NAME_LEN, "units%d", i);
+        }
+        if (bulkAVUMetadataInp->units[i] == NULL ||
+          strcmp (bulkAVUMetadataInp->units[i], str) != 0) {
+            printf ("%s: op %d has the wrong units\n", label, i);
+            return (1);
+        }
+    }
+    return (0);
+}
+
+int
+packBulkAVUInp (bulkAVUMetadataInp_t *bulkAVUMetadataInp, int numOps,
+irodsProt_t irodsProt)
+{
+    bytesBuf_t *packedResult = NULL;
+    bulkAVUMetadataInp_t *outBulkAVUMetadataInp = NULL;
+    char *protName = irodsProt == XML_PROT ? (char *) "XML_PROT" :
+      (char *) "NATIVE_PROT";
+    int status, errCnt;
+
+    status = packStruct ((void *) bulkAVUMetadataInp, &packedResult,
+      "BulkAVUMetadataInp_PI", NULL, 0, irodsProt);
+    if (status < 0) {
+        printf ("packStruct of %d ops in %s failed, status = %d\n",
+          numOps, protName, status);
+        return (1);
+    }
+    status = unpackStruct (packedResult->buf,
+      (void **) &outBulkAVUMetadataInp, "BulkAVUMetadataInp_PI", NULL,
+      irodsProt);
+    freeBBuf (packedResult);
+    if (status < 0 || outBulkAVUMetadataInp == NULL) {
+        printf ("unpackStruct of %d ops in %s failed, status = %d\n",
+          numOps, protName, status);
+        return (1);
+    }
+    errCnt = chkBulkAVUInp (outBulkAVUMetadataInp, numOps, protName);
+    if (outBulkAVUMetadataInp->options != bulkAVUMetadataInp->options) {
+        printf ("%s: options %d != %d\n", protName,
+          outBulkAVUMetadataInp->options, bulkAVUMetadataInp->options);
+        errCnt++;
+    }
+    clearBulkAVUMetadataInp (outBulkAVUMetadataInp);
+    free (outBulkAVUMetadataInp);
+    if (errCnt == 0) {
+        printf ("pack/unpack of %d ops in %s ok\n", numOps, protName);
+    }
+    return (errCnt);
+}
@@ -0,0 +1,92 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* connbench.c - measure the connections per second the server can take.
+ * Each iteration does rcConnect, clientLogin, optionally a stat of the
+ * home collection (-s) and rcDisconnect, like a short ils session.
+ * Run it with and without agentPoolMin set in irodsctl to compare
+ * the pre-forked agent pool against fork/execv per connection.
+ */
+
+#include <sys/time.h>
+#include "rodsClient.h"
+
+#define DEF_NUM_CONN	1000
+
+int
+main(int argc, char **argv)
+{
+    rcComm_t *conn;
+    rodsEnv myEnv;
+    rErrMsg_t errMsg;
+    int status;
+    int c;
+    int i;
+    int numConn = DEF_NUM_CONN;
+    int statFlag = 0;
+    int errCnt = 0;
+    struct timeval startTime, endTime;
+    float elapsed;
+    dataObjInp_t dataObjInp;
+    rodsObjStat_t *rodsObjStatOut;
+
+    while ((c = getopt (argc, argv, "n:sh")) != EOF) {
+        switch (c) {
+            case 'n':
+                numConn = atoi (optarg);
+                break;
+            case 's':
+                statFlag = 1;
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-n numConn] [-s]\n", argv[0]);
+                exit (1);
+        }
+    }
+
+    status = getRodsEnv (&myEnv);
+    if (status < 0) {
+	fprintf (stderr, "getRodsEnv error, status = %d\n", status);
+	exit (1);
+    }
+
+    memset (&dataObjInp, 0, sizeof (dataObjInp));
+    rstrcpy (dataObjInp.objPath, myEnv.rodsHome, MAX_NAME_LEN);
+
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    for (i = 0; i < numConn; i++) {
+        memset (&errMsg, 0, sizeof (rErrMsg_t));
+        conn = rcConnect (myEnv.rodsHost, myEnv.rodsPort, myEnv.rodsUserName,
+          myEnv.rodsZone, 0, &errMsg);
+        if (conn == NULL) {
+	    errCnt++;
+	    continue;
+        }
+
+        status = clientLogin (conn);
+        if (status != 0) {
+	    errCnt++;
+            rcDisconnect (conn);
+	    continue;
+        }
+
+	if (statFlag > 0) {
+	    status = rcObjStat (conn, &dataObjInp, &rodsObjStatOut);
+	    if (status < 0) {
+		errCnt++;
+	    } else {
+		freeRodsObjStat (rodsObjStatOut);
+	    }
+	}
+        rcDisconnect (conn);
+    }
+    (void) gettimeofday (&endTime, (struct timezone *) 0);
+
+    elapsed = (endTime.tv_sec - startTime.tv_sec) +
+      (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+    if (elapsed <= 0) elapsed = 0.000001;
+
+    printf ("%d connections, %d errors in %.3f sec, %.1f conn/sec\n",
+      numConn, errCnt, elapsed, (numConn - errCnt) / elapsed);
+
+    exit (errCnt > 0 ? 2 : 0);
+}
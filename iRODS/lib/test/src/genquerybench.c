@@ -0,0 +1,126 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* genquerybench.c - measure the listing of the data objects in a
+ * collection with the paged rcGenQuery (one round trip per MAX_SQL_ROWS
+ * rows, each column padded to its longest value) and with the streamed
+ * rcGenQueryStreamOpen. The query is the one ils -l makes. Run it
+ * through genquerybench.sh to emulate a high RTT link.
+ */
+
+#include <sys/time.h>
+#include "rodsClient.h"
+#include "miscUtil.h"
+
+int
+main(int argc, char **argv)
+{
+    rcComm_t *conn;
+    rodsEnv myEnv;
+    rErrMsg_t errMsg;
+    int status;
+    int c, i;
+    int streamFlag = 0;
+    int rowCnt = 0;
+    int numTrips = 0;
+    rodsLong_t numBytes = 0;
+    struct timeval startTime, endTime;
+    float elapsed;
+    char *collection;
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    genQueryStream_t *genQueryStream = NULL;
+
+    while ((c = getopt (argc, argv, "sh")) != EOF) {
+        switch (c) {
+            case 's':
+                streamFlag = 1;
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-s] collection\n", argv[0]);
+                exit (1);
+        }
+    }
+    if (optind >= argc) {
+        fprintf (stderr, "Usage: %s [-s] collection\n", argv[0]);
+        exit (1);
+    }
+    collection = argv[optind];
+
+    status = getRodsEnv (&myEnv);
+    if (status < 0) {
+	fprintf (stderr, "getRodsEnv error, status = %d\n", status);
+	exit (1);
+    }
+
+    conn = rcConnect (myEnv.rodsHost, myEnv.rodsPort, myEnv.rodsUserName,
+      myEnv.rodsZone, 0, &errMsg);
+    if (conn == NULL) {
+	fprintf (stderr, "rcConnect error, status = %d\n", errMsg.status);
+	exit (1);
+    }
+    status = clientLogin (conn);
+    if (status != 0) {
+	rcDisconnect (conn);
+	exit (1);
+    }
+
+    setQueryInpForDataInColl (collection, LONG_METADATA_FG, &genQueryInp,
+      NULL);
+
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    if (streamFlag == 0) {
+	status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+	while (status >= 0) {
+	    numTrips++;
+	    rowCnt += genQueryOut->rowCnt;
+	    for (i = 0; i < genQueryOut->attriCnt; i++) {
+		numBytes += (rodsLong_t) genQueryOut->rowCnt *
+		  genQueryOut->sqlResult[i].len;
+	    }
+	    genQueryInp.continueInx = genQueryOut->continueInx;
+	    freeGenQueryOut (&genQueryOut);
+	    if (genQueryInp.continueInx == 0) break;
+	    status = rcGenQuery (conn, &genQueryInp, &genQueryOut);
+	}
+    } else {
+	status = rcGenQueryStreamOpen (conn, &genQueryInp, &genQueryStream);
+	if (status >= 0) {
+	    numTrips++;
+	    numBytes += genQueryStream->batch.len;
+	    while (1) {
+		if (genQueryStream->batchRowsLeft <= 0 &&
+		  genQueryStream->status == SYS_SVR_TO_CLI_GEN_QUERY_BATCH) {
+		    /* the next call reads a batch */
+		    numTrips++;
+		    status = rcGenQueryStreamNextRow (genQueryStream);
+		    numBytes += genQueryStream->batch.len;
+		} else {
+		    status = rcGenQueryStreamNextRow (genQueryStream);
+		}
+		if (status < 0) break;
+		rowCnt++;
+	    }
+	    rcGenQueryStreamClose (genQueryStream);
+	}
+    }
+    (void) gettimeofday (&endTime, (struct timezone *) 0);
+
+    rcDisconnect (conn);
+    clearGenQueryInp (&genQueryInp);
+
+    if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+	fprintf (stderr, "%s error, status = %d\n",
+	  streamFlag ? "rcGenQueryStream" : "rcGenQuery", status);
+	exit (2);
+    }
+
+    elapsed = (endTime.tv_sec - startTime.tv_sec) +
+      (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+    if (elapsed <= 0) elapsed = 0.000001;
+
+    printf ("%s: %d rows, %d replies, %lld value bytes in %.3f sec, %.0f rows/sec\n",
+      streamFlag ? "streamed" : "paged", rowCnt, numTrips, numBytes,
+      elapsed, rowCnt / elapsed);
+
+    exit (0);
+}
@@ -0,0 +1,205 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* packbench.c - measure packStruct/unpackStruct with and without the
+ * compiled pack plan cache. DataObjInp_PI, GenQueryOut_PI and
+ * DataObjInfo_PI are packed and unpacked in both NATIVE_PROT and
+ * XML_PROT, and the packed output of the two modes is compared byte
+ * for byte.
+ */
+
+#include <sys/time.h>
+#include "rodsClient.h"
+
+#define DEF_NUM_ITER	20000
+#define BENCH_ROW_CNT	50
+#define BENCH_ATTR_CNT	8
+
+typedef struct {
+    char *piName;
+    void *inStruct;
+} benchItem_t;
+
+int
+initBenchStruct (dataObjInp_t *dataObjInp, genQueryOut_t *genQueryOut,
+dataObjInfo_t *dataObjInfo);
+int
+freeUnpacked (char *piName, void *outStruct);
+float
+runBench (benchItem_t *benchItem, irodsProt_t irodsProt, int numIter,
+bytesBuf_t **packedResult);
+
+int
+main(int argc, char **argv)
+{
+    int c, i, j;
+    int numIter = DEF_NUM_ITER;
+    int errCnt = 0;
+    int planCnt, hitCnt, missCnt;
+    float noPlanTime, planTime;
+    bytesBuf_t *noPlanBuf, *planBuf;
+    dataObjInp_t dataObjInp;
+    genQueryOut_t genQueryOut;
+    dataObjInfo_t dataObjInfo;
+    irodsProt_t protArray[] = {NATIVE_PROT, XML_PROT};
+    benchItem_t benchItem[3];
+
+    while ((c = getopt (argc, argv, "n:h")) != EOF) {
+        switch (c) {
+            case 'n':
+                numIter = atoi (optarg);
+                if (numIter <= 0) numIter = DEF_NUM_ITER;
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-n numIter]\n", argv[0]);
+                exit (1);
+        }
+    }
+
+    initBenchStruct (&dataObjInp, &genQueryOut, &dataObjInfo);
+    benchItem[0].piName = "DataObjInp_PI";
+    benchItem[0].inStruct = &dataObjInp;
+    benchItem[1].piName = "GenQueryOut_PI";
+    benchItem[1].inStruct = &genQueryOut;
+    benchItem[2].piName = "DataObjInfo_PI";
+    benchItem[2].inStruct = &dataObjInfo;
+
+    printf ("%-16s %-7s %12s %12s %8s\n", "struct", "prot", "parse op/s",
+      "plan op/s", "speedup");
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 2; j++) {
+            enablePackPlan (0);
+            noPlanTime = runBench (&benchItem[i], protArray[j], numIter,
+              &noPlanBuf);
+            enablePackPlan (1);
+            planTime = runBench (&benchItem[i], protArray[j], numIter,
+              &planBuf);
+            if (noPlanTime < 0 || planTime < 0) {
+                errCnt++;
+                continue;
+            }
+            if (noPlanBuf->len != planBuf->len ||
+              memcmp (noPlanBuf->buf, planBuf->buf, planBuf->len) != 0) {
+                fprintf (stderr, "%s: packed output differs for prot %d\n",
+                  benchItem[i].piName, protArray[j]);
+                errCnt++;
+            }
+            printf ("%-16s %-7s %12.0f %12.0f %7.2fx\n",
+              benchItem[i].piName, j == 0 ? "native" : "xml",
+              numIter / noPlanTime, numIter / planTime,
+              noPlanTime / planTime);
+            freeBBuf (noPlanBuf);
+            freeBBuf (planBuf);
+        }
+    }
+    getPackPlanStat (&planCnt, &hitCnt, &missCnt);
+    printf ("pack plans: %d cached, %d hits, %d misses\n", planCnt, hitCnt,
+      missCnt);
+
+    exit (errCnt > 0 ? 2 : 0);
+}
+
+int
+initBenchStruct (dataObjInp_t *dataObjInp, genQueryOut_t *genQueryOut,
+dataObjInfo_t *dataObjInfo)
+{
+    int i, j;
+    char *value;
+
+    memset (dataObjInp, 0, sizeof (dataObjInp_t));
+    rstrcpy (dataObjInp->objPath, "/tempZone/home/rods/bench/file1",
+      MAX_NAME_LEN);
+    dataObjInp->dataSize = 123456789;
+    dataObjInp->openFlags = O_RDONLY;
+    addKeyVal (&dataObjInp->condInput, DEST_RESC_NAME_KW, "demoResc");
+    addKeyVal (&dataObjInp->condInput, FORCE_FLAG_KW, "");
+
+    memset (genQueryOut, 0, sizeof (genQueryOut_t));
+    genQueryOut->rowCnt = BENCH_ROW_CNT;
+    genQueryOut->attriCnt = BENCH_ATTR_CNT;
+    for (i = 0; i < BENCH_ATTR_CNT; i++) {
+        genQueryOut->sqlResult[i].attriInx = 401 + i;
+        genQueryOut->sqlResult[i].len = NAME_LEN;
+        value = (char *) malloc (BENCH_ROW_CNT * NAME_LEN);
+        for (j = 0; j < BENCH_ROW_CNT; j++) {
+            snprintf (value + j * NAME_LEN, NAME_LEN, "row%d_attr%d", j, i);
+        }
+        genQueryOut->sqlResult[i].value = value;
+    }
+
+    memset (dataObjInfo, 0, sizeof (dataObjInfo_t));
+    rstrcpy (dataObjInfo->objPath, dataObjInp->objPath, MAX_NAME_LEN);
+    rstrcpy (dataObjInfo->rescName, "demoResc", NAME_LEN);
+    rstrcpy (dataObjInfo->dataType, "generic", NAME_LEN);
+    rstrcpy (dataObjInfo->chksum, "d41d8cd98f00b204e9800998ecf8427e",
+      CHKSUM_LEN);
+    rstrcpy (dataObjInfo->filePath, "/var/lib/irods/Vault/bench/file1",
+      MAX_NAME_LEN);
+    rstrcpy (dataObjInfo->dataOwnerName, "rods", NAME_LEN);
+    rstrcpy (dataObjInfo->dataOwnerZone, "tempZone", NAME_LEN);
+    dataObjInfo->dataSize = 123456789;
+    dataObjInfo->dataId = 10020;
+    dataObjInfo->collId = 10010;
+    addKeyVal (&dataObjInfo->condInput, REPL_NUM_KW, "0");
+
+    return (0);
+}
+
+int
+freeUnpacked (char *piName, void *outStruct)
+{
+    if (strcmp (piName, "DataObjInp_PI") == 0) {
+        clearDataObjInp ((dataObjInp_t *) outStruct);
+        free (outStruct);
+    } else if (strcmp (piName, "GenQueryOut_PI") == 0) {
+        freeGenQueryOut ((genQueryOut_t **) &outStruct);
+    } else {
+        clearKeyVal (&((dataObjInfo_t *) outStruct)->condInput);
+        freeDataObjInfo ((dataObjInfo_t *) outStruct);
+    }
+    return (0);
+}
+
+/* runBench - pack and unpack numIter times. Returns the elapsed time in
+ * sec and the output of the last pack in *packedResult.
+ */
+float
+runBench (benchItem_t *benchItem, irodsProt_t irodsProt, int numIter,
+bytesBuf_t **packedResult)
+{
+    int i, status;
+    bytesBuf_t *packedBuf = NULL;
+    void *outStruct;
+    struct timeval startTime, endTime;
+    float elapsed;
+
+    *packedResult = NULL;
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    for (i = 0; i < numIter; i++) {
+        status = packStruct (benchItem->inStruct, &packedBuf,
+          benchItem->piName, RodsPackTable, 0, irodsProt);
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status, "packStruct of %s error",
+              benchItem->piName);
+            return (-1.0);
+        }
+        status = unpackStruct (packedBuf->buf, &outStruct,
+          benchItem->piName, RodsPackTable, irodsProt);
+        if (status < 0) {
+            rodsLogError (LOG_ERROR, status, "unpackStruct of %s error",
+              benchItem->piName);
+            freeBBuf (packedBuf);
+            return (-1.0);
+        }
+        freeUnpacked (benchItem->piName, outStruct);
+        if (i < numIter - 1) {
+            freeBBuf (packedBuf);
+        }
+    }
+    (void) gettimeofday (&endTime, (struct timezone *) 0);
+
+    *packedResult = packedBuf;
+    elapsed = (endTime.tv_sec - startTime.tv_sec) +
+      (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+    if (elapsed <= 0) elapsed = 0.000001;
+    return (elapsed);
+}
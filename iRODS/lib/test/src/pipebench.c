@@ -0,0 +1,134 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* pipebench.c - measure the latency of small API calls with and without
+ * request pipelining. Each op is a rcObjStat of the home collection.
+ * With -d 1 the calls are made one at a time through procApiRequest;
+ * otherwise up to depth requests are kept in flight with
+ * rcSubmitApiRequest/rcCompleteApiRequest. -p asks the server for the
+ * tagged pipelined mode. Run it through pipebench.sh to emulate a
+ * high RTT link.
+ */
+
+#include <sys/time.h>
+#include "rodsClient.h"
+
+#define DEF_NUM_OPS	1000
+
+int
+main(int argc, char **argv)
+{
+    rcComm_t *conn;
+    rodsEnv myEnv;
+    rErrMsg_t errMsg;
+    int status;
+    int c;
+    int numOps = DEF_NUM_OPS;
+    int depth = 1;
+    int pipeFlag = 0;
+    int errCnt = 0;
+    int numSubmitted = 0;
+    int numCompleted = 0;
+    int reqId[MAX_REQ_PIPE_DEPTH];
+    struct timeval startTime, endTime;
+    float elapsed;
+    dataObjInp_t dataObjInp;
+    rodsObjStat_t *rodsObjStatOut;
+
+    while ((c = getopt (argc, argv, "n:d:ph")) != EOF) {
+        switch (c) {
+            case 'n':
+                numOps = atoi (optarg);
+                break;
+            case 'd':
+                depth = atoi (optarg);
+                break;
+            case 'p':
+                pipeFlag = 1;
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-n numOps] [-d depth] [-p]\n",
+		  argv[0]);
+                exit (1);
+        }
+    }
+    if (depth < 1) depth = 1;
+    if (depth > MAX_REQ_PIPE_DEPTH) depth = MAX_REQ_PIPE_DEPTH;
+
+    status = getRodsEnv (&myEnv);
+    if (status < 0) {
+	fprintf (stderr, "getRodsEnv error, status = %d\n", status);
+	exit (1);
+    }
+
+    if (pipeFlag > 0) setenv (IRODS_REQ_PIPELINE, "1", 1);
+
+    conn = rcConnect (myEnv.rodsHost, myEnv.rodsPort, myEnv.rodsUserName,
+      myEnv.rodsZone, 0, &errMsg);
+    if (conn == NULL) {
+	fprintf (stderr, "rcConnect error, status = %d\n", errMsg.status);
+	exit (1);
+    }
+    status = clientLogin (conn);
+    if (status != 0) {
+	rcDisconnect (conn);
+	exit (1);
+    }
+    if (pipeFlag > 0 && conn->reqPipeline == 0) {
+	fprintf (stderr, "the server did not accept the pipelined mode\n");
+    }
+
+    memset (&dataObjInp, 0, sizeof (dataObjInp));
+    rstrcpy (dataObjInp.objPath, myEnv.rodsHome, MAX_NAME_LEN);
+
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    if (depth == 1) {
+	for (numCompleted = 0; numCompleted < numOps; numCompleted++) {
+	    status = rcObjStat (conn, &dataObjInp, &rodsObjStatOut);
+	    if (status < 0) {
+		errCnt++;
+	    } else {
+		freeRodsObjStat (rodsObjStatOut);
+	    }
+	}
+    } else {
+	while (numCompleted < numOps) {
+	    while (numSubmitted < numOps &&
+	      numSubmitted - numCompleted < depth) {
+		status = rcSubmitApiRequest (conn, OBJ_STAT_AN, &dataObjInp,
+		  NULL);
+		if (status == USER_REQ_PIPELINE_FULL) {
+		    /* complete the oldest one first */
+		    break;
+		} else if (status < 0) {
+		    fprintf (stderr, "rcSubmitApiRequest error, status = %d\n",
+		      status);
+		    rcDisconnect (conn);
+		    exit (2);
+		}
+		reqId[numSubmitted % depth] = status;
+		numSubmitted++;
+	    }
+	    rodsObjStatOut = NULL;
+	    status = rcCompleteApiRequest (conn, reqId[numCompleted % depth],
+	      (void **) &rodsObjStatOut, NULL);
+	    if (status < 0) {
+		errCnt++;
+	    }
+	    if (rodsObjStatOut != NULL) freeRodsObjStat (rodsObjStatOut);
+	    numCompleted++;
+	}
+    }
+    (void) gettimeofday (&endTime, (struct timezone *) 0);
+
+    rcDisconnect (conn);
+
+    elapsed = (endTime.tv_sec - startTime.tv_sec) +
+      (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+    if (elapsed <= 0) elapsed = 0.000001;
+
+    printf ("depth %d: %d ops, %d errors in %.3f sec, %.1f ops/sec, %.3f ms/op\n",
+      depth, numOps, errCnt, elapsed, numOps / elapsed,
+      elapsed * 1000.0 / numOps);
+
+    exit (errCnt > 0 ? 2 : 0);
+}
@@ -199,6 +199,55 @@ $postgresBinDir  = File::Spec->catdir( $POSTGRES_HOME, "bin" );
 # not desirable. 
 # $reServerOption="-cD /a/b/c/myLogDir";
 
+# irodsReServerResyncTime - The irodsReServer keeps the delayed rules in
+# an in memory queue. Newly submitted rules are added as soon as they are
+# submitted and the whole queue is reloaded from the ICAT every
+# irodsReServerResyncTime seconds (default 300). The number of workers is
+# set with acSetReServerNumProc in core.re. The queue depth and lag are
+# written to the file reServerStats in the log dir every minute.
+# $irodsReServerResyncTime=300;
+
+# irodsReServerWorkerMaxJobs - The number of jobs an irodsReServer worker
+# runs before it is replaced by a new one (default 1000).
+# $irodsReServerWorkerMaxJobs=1000;
+
+# agentPoolMin and agentPoolMax - Pre-fork a pool of irodsAgents which
+# load the server config, the rule base and the ICAT connection once and
+# are then reused for many client connections. agentPoolMin agents are
+# kept running and the pool grows up to agentPoolMax under load. An agent
+# retires after serving agentPoolMaxReuse connections (default 1000).
+# The pool is off by default.
+# $agentPoolMin=8;
+# $agentPoolMax=32;
+# $agentPoolMaxReuse=1000;
+
+# irodsNoZeroCopy - On Linux, parallel transfers to and from unix file
+# system resources use sendfile/splice to move the data between the
+# socket and the file without copying it through the agent. Set this
+# to turn that off and always use the transfer buffer.
+# $irodsNoZeroCopy=1;
+
+# irodsAdaptiveXfer - Set this to the max number of threads (up to 32) to
+# let the server pick the number of threads and the socket window size
+# of a parallel transfer from the rates seen with the same client host
+# before, instead of acSetNumThreads alone. The history is kept in the
+# file xferHist in the log dir and each choice and result is logged.
+# Transfers where the client gives the number of threads are not changed.
+# $irodsAdaptiveXfer=16;
+
+# irodsChksumByRead - The chksum asked for with a put (iput -k or -K) is
+# normally taken while the data stream in. Set this to always read the
+# file again after the transfer to chksum it instead.
+# $irodsChksumByRead=1;
+
+# irodsCompositeChksum - A put done with more than one thread can only be
+# chksummed while it streams as a composite chksum of the thread
+# segments, registered as "md5c:<numThreads>:<md5>". Set this to allow
+# registering such chksums. Without it, parallel puts read the file
+# again to get the plain md5. Clients that do not know the composite
+# form (older iget -K) check them by reading the local file.
+# $irodsCompositeChksum=1;
+
 # irodsConnTimeout - Specifies whether the agent accept a client request
 # to timeout and terminate corrent connection and create a reconnect
 # socket/port for reconnection in case the client server connection is
@@ -259,7 +308,16 @@ if ($SVR_PORT_RANGE_END)	{ $ENV{'svrPortRangeEnd'}     = $SVR_PORT_RANGE_END; }
 if ($svrPortRangeStart)		{ $ENV{'svrPortRangeStart'}   = $svrPortRangeStart; }
 if ($svrPortRangeEnd)		{ $ENV{'svrPortRangeEnd'}     = $svrPortRangeEnd; }
 if ($reServerOption)		{ $ENV{'reServerOption'}      = $reServerOption; }
+if ($irodsReServerResyncTime)	{ $ENV{'irodsReServerResyncTime'} = $irodsReServerResyncTime; }
+if ($irodsReServerWorkerMaxJobs)	{ $ENV{'irodsReServerWorkerMaxJobs'} = $irodsReServerWorkerMaxJobs; }
 if ($irodsReconnect)		{ $ENV{'irodsReconnect'}    = $irodsReconnect; }
+if ($agentPoolMin)		{ $ENV{'agentPoolMin'}        = $agentPoolMin; }
+if ($agentPoolMax)		{ $ENV{'agentPoolMax'}        = $agentPoolMax; }
+if ($agentPoolMaxReuse)		{ $ENV{'agentPoolMaxReuse'}   = $agentPoolMaxReuse; }
+if ($irodsNoZeroCopy)		{ $ENV{'irodsNoZeroCopy'}     = $irodsNoZeroCopy; }
+if ($irodsAdaptiveXfer)		{ $ENV{'irodsAdaptiveXfer'}   = $irodsAdaptiveXfer; }
+if ($irodsChksumByRead)		{ $ENV{'irodsChksumByRead'}   = $irodsChksumByRead; }
+if ($irodsCompositeChksum)	{ $ENV{'irodsCompositeChksum'} = $irodsCompositeChksum; }
 if ($RETESTFLAG)		{ $ENV{'RETESTFLAG'}          = $RETESTFLAG; }
 if ($GLOBALALLRULEEXECFLAG)    { $ENV{'GLOBALALLRULEEXECFLAG'} = $GLOBALALLRULEEXECFLAG; }
 if ($PREPOSTPROCFORGENQUERYFLAG)    { $ENV{'PREPOSTPROCFORGENQUERYFLAG'} = $PREPOSTPROCFORGENQUERYFLAG; }
@@ -0,0 +1,126 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* See bulkAVUMetadata.h for a description of this API call.*/
+
+#include "bulkAVUMetadata.h"
+#include "reGlobalsExtern.h"
+#include "icatHighLevelRoutines.h"
+
+int
+rsBulkAVUMetadata (rsComm_t *rsComm, bulkAVUMetadataInp_t *bulkAVUMetadataInp)
+{
+    rodsServerHost_t *rodsServerHost;
+    int status;
+    char *myHint;
+
+    if (bulkAVUMetadataInp->numOps > 0) {
+	myHint = bulkAVUMetadataInp->objName[0];
+    } else {
+	/* assume local */
+	myHint = NULL;
+    }
+ 
+    status = getAndConnRcatHost(rsComm, MASTER_RCAT, myHint, &rodsServerHost);
+    if (status < 0) {
+       return(status);
+    }
+
+    if (rodsServerHost->localFlag == LOCAL_HOST) {
+#ifdef RODS_CAT
+       status = _rsBulkAVUMetadata (rsComm, bulkAVUMetadataInp);
+#else
+       status = SYS_NO_RCAT_SERVER_ERR;
+#endif
+    }
+    else {
+       status = rcBulkAVUMetadata(rodsServerHost->conn,
+			       bulkAVUMetadataInp);
+    }
+
+    if (status < 0) { 
+       rodsLog (LOG_NOTICE,
+		"rsBulkAVUMetadata: rcBulkAVUMetadata failed");
+    }
+    return (status);
+}
+
+#ifdef RODS_CAT
+/* The same policy points as for modAVUMetadata, once per operation */
+static int
+applyBulkAVURule (char *ruleName, bulkAVUMetadataInp_t *bulkAVUMetadataInp,
+int inx, ruleExecInfo_t *rei2)
+{
+    char *args[MAX_NUM_OF_ARGS_IN_ACTION];
+    int status;
+
+    if (strcmp (bulkAVUMetadataInp->op[inx], "add") == 0 &&
+      (bulkAVUMetadataInp->options & BULK_AVU_ADMIN_MODE) != 0) {
+	args[0] = "adda";
+    } else {
+	args[0] = bulkAVUMetadataInp->op[inx];
+    }
+    args[1] = bulkAVUMetadataInp->objType[inx];
+    args[2] = bulkAVUMetadataInp->objName[inx];
+    args[3] = bulkAVUMetadataInp->attribute[inx];
+    args[4] = bulkAVUMetadataInp->value[inx];
+    args[5] = bulkAVUMetadataInp->units[inx];
+    if (args[5] == NULL) args[5] = "";
+
+    status = applyRuleArg (ruleName, args, 6, rei2, NO_SAVE_REI);
+    if (status < 0) {
+	if (rei2->status < 0) {
+	    status = rei2->status;
+	}
+	rodsLog (LOG_ERROR,
+	  "rsBulkAVUMetadata:%s error for %s of type %s and option %s,stat=%d",
+	  ruleName, args[2], args[1], args[0], status);
+    }
+    return (status);
+}
+
+int
+_rsBulkAVUMetadata (rsComm_t *rsComm, bulkAVUMetadataInp_t *bulkAVUMetadataInp)
+{
+    int status, status2;
+    int i, adminMode;
+    ruleExecInfo_t rei2;
+
+    memset ((char*)&rei2, 0, sizeof (ruleExecInfo_t));
+    rei2.rsComm = rsComm;
+    if (rsComm != NULL) {
+      rei2.uoic = &rsComm->clientUser;
+      rei2.uoip = &rsComm->proxyUser;
+    }
+
+    if (bulkAVUMetadataInp->numOps < 0 || 
+      bulkAVUMetadataInp->numOps > MAX_BULK_AVU_OPS) {
+	return (CAT_INVALID_ARGUMENT);
+    }
+    for (i = 0; i < bulkAVUMetadataInp->numOps; i++) {
+	if (bulkAVUMetadataInp->op[i] == NULL ||
+	  bulkAVUMetadataInp->objType[i] == NULL ||
+	  bulkAVUMetadataInp->objName[i] == NULL) {
+	    return (CAT_INVALID_ARGUMENT);
+	}
+	status2 = applyBulkAVURule ("acPreProcForModifyAVUMetadata",
+	  bulkAVUMetadataInp, i, &rei2);
+	if (status2 < 0) return (status2);
+    }
+
+    adminMode = (bulkAVUMetadataInp->options & BULK_AVU_ADMIN_MODE) ? 1 : 0;
+    status = chlBulkAVUMetadata (rsComm, adminMode, 
+      bulkAVUMetadataInp->numOps, bulkAVUMetadataInp->op,
+      bulkAVUMetadataInp->objType, bulkAVUMetadataInp->objName,
+      bulkAVUMetadataInp->attribute, bulkAVUMetadataInp->value,
+      bulkAVUMetadataInp->units);
+
+    if (status >= 0) {
+	for (i = 0; i < bulkAVUMetadataInp->numOps; i++) {
+	    status2 = applyBulkAVURule ("acPostProcForModifyAVUMetadata",
+	      bulkAVUMetadataInp, i, &rei2);
+	    if (status2 < 0) return (status2);
+	}
+    }
+    return(status);
+} 
+#endif
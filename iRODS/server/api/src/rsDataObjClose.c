@@ -83,8 +83,12 @@ dataObjInfo_t **outDataObjInfo)
 	      L1desc[l1descInx].lockFd);
 	    L1desc[l1descInx].lockFd = -1;
 	}
-        if (status >= 0 && L1desc[l1descInx].oprStatus >= 0) {
-	    /* note : this may overlap with acPostProcForPut or 
+        if (status >= 0 && L1desc[l1descInx].oprStatus >= 0 &&
+	  (L1desc[l1descInx].dataObjInfo == NULL ||
+	  (L1desc[l1descInx].dataObjInfo->flags & NO_COMMIT_FLAG) == 0)) {
+	    /* a registration not committed yet (NO_COMMIT_FLAG) gets its
+	     * post proc from the caller after the commit.
+	     * note : this may overlap with acPostProcForPut or 
 	     * acPostProcForCopy */
 	    if (L1desc[l1descInx].openType == CREATE_TYPE) {
                 initReiWithDataObjInp (&rei, rsComm,
@@ -913,11 +917,11 @@ procChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr)
 #if defined(PREFER_SHA256_FILE_HASH) && PREFER_SHA256_FILE_HASH <= 1
             char *chksumStr2 = strdup(chksum);
             *chksumStr = chksumStr2;
-            status = _dataObjChksum (rsComm, dataObjInfo, chksumStr);
+            status = dataObjChksumForClose (rsComm, l1descInx, chksumStr);
             free(chksumStr2);
             if (status < 0)  return (status);
 #else    
-            status = _dataObjChksum (rsComm, dataObjInfo, chksumStr);
+            status = dataObjChksumForClose (rsComm, l1descInx, chksumStr);
             if (status < 0)  return (status);
             if((status = verifyHashUse(chksum)) < 0) {
                 rodsLog (LOG_NOTICE, "procChksumForClose: mismach chksum for %s.inp=%s,compute %s", dataObjInfo->objPath, chksum, *chksumStr);
@@ -940,6 +944,10 @@ procChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr)
                 free (*chksumStr);
                 *chksumStr = NULL;
             }
+        } else if (oprType == PUT_OPR && chksumKwWithNoValue (l1descInx)) {
+            /* the client chksums its own copy and compares after the
+             * close. Register the chksum for it */
+            return (dataObjChksumForClose (rsComm, l1descInx, chksumStr));
        } else if (oprType == REPLICATE_DEST) {
             if (strlen (dataObjInfo->chksum) > 0) {
                 /* for replication, the chksum in dataObjInfo was duplicated */
@@ -1027,11 +1035,11 @@ procChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr)
 #if defined(PREFER_SHA256_FILE_HASH) && PREFER_SHA256_FILE_HASH <= 1
             char *chksumStr2 = strdup(chksum);
             *chksumStr = chksumStr2;
-            status = _dataObjChksum (rsComm, dataObjInfo, chksumStr);
+            status = dataObjChksumForClose (rsComm, l1descInx, chksumStr);
             free(chksumStr2);
             if (status < 0)  return (status);
 #else    
-            status = _dataObjChksum (rsComm, dataObjInfo, chksumStr);
+            status = dataObjChksumForClose (rsComm, l1descInx, chksumStr);
             if (status < 0)  return (status);
             if((status = verifyHashUse(chksum)) < 0) {
                 rodsLog (LOG_NOTICE, "procChksumForClose: mismach chksum for %s.inp=%s,compute %s", dataObjInfo->objPath, chksum, *chksumStr);
@@ -1046,6 +1054,9 @@ procChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr)
                 *chksumStr = NULL;
             }
             return (0);
+        } else if (oprType == PUT_OPR && chksumKwWithNoValue (l1descInx)) {
+            /* the client wants it registered but did not send it */
+            return (dataObjChksumForClose (rsComm, l1descInx, chksumStr));
         } else if (oprType == COPY_DEST) {
             /* created through copy */
             srcL1descInx = L1desc[l1descInx].srcL1descInx;
@@ -1090,3 +1101,18 @@ rsDataObjClose201 (rsComm_t *rsComm, dataObjCloseInp_t *dataObjCloseInp)
 }
 #endif
 
+/* chksumKwWithNoValue - returns 1 if the client gave REG_CHKSUM_KW or
+ * VERIFY_CHKSUM_KW without a value for the put on l1descInx. Such a
+ * client chksums the data while sending them and has the server
+ * register its own chksum */
+int
+chksumKwWithNoValue (int l1descInx)
+{
+    dataObjInp_t *dataObjInp = L1desc[l1descInx].dataObjInp;
+    char *value;
+
+    if (dataObjInp == NULL) return (0);
+    if ((value = getValByKey (&dataObjInp->condInput, REG_CHKSUM_KW)) == NULL)
+        value = getValByKey (&dataObjInp->condInput, VERIFY_CHKSUM_KW);
+    return (value != NULL && strlen (value) == 0);
+}
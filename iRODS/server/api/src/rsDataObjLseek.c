@@ -10,6 +10,8 @@
 #include "subStructFileLseek.h"
 #include "objMetaOpr.h"
 #include "subStructFileUnlink.h"
+#include "physPath.h"
+#include "md5Checksum.h"
 
 
 int
@@ -70,6 +72,12 @@ fileLseekOut_t **dataObjLseekOut)
 
         if ((*dataObjLseekOut)->offset >= 0) {
 	    status = 0;
+	    if (L1desc[l1descInx].inlineChksum != NULL &&
+	      L1desc[l1descInx].inlineChksum->segCtx[0].offset !=
+	      (*dataObjLseekOut)->offset) {
+		/* not sequential. chksum by reading the file on close */
+		freeInlineChksum (l1descInx);
+	    }
         } else {
 	    status = (*dataObjLseekOut)->offset;
         }
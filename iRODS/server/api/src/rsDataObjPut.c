@@ -231,6 +231,16 @@ portalOprOut_t **portalOprOut)
     if (status >= 0) {
         (*portalOprOut)->l1descInx = l1descInx;
 	L1desc[l1descInx].bytesWritten = dataOprInp.dataSize;
+        /* chksum the data as they come in. Through the portal of this
+         * agent, or through rsDataObjWrite when there is no portal */
+        if ((*portalOprOut)->numThreads == 0) {
+            startInlineChksum (l1descInx, 1, dataOprInp.dataSize);
+        } else if (rsComm->portalOpr != NULL &&
+          getUdpPortFromPortList (&rsComm->portalOpr->portList) == 0) {
+            startInlineChksum (l1descInx, (*portalOprOut)->numThreads,
+              dataOprInp.dataSize);
+            rsComm->portalOpr->inlineChksum = L1desc[l1descInx].inlineChksum;
+        }
     }
     clearKeyVal (&dataOprInp.condInput);
     return (status);
@@ -355,6 +365,11 @@ bytesBuf_t *dataObjInpBBuf)
     bytesWritten = l3FilePutSingleBuf (rsComm, l1descInx, dataObjInpBBuf);
 
     if (bytesWritten >= 0) {
+        startInlineChksum (l1descInx, 1, bytesWritten);
+        if (L1desc[l1descInx].inlineChksum != NULL) {
+            updateInlineChksum (L1desc[l1descInx].inlineChksum, 0,
+              (unsigned char *) dataObjInpBBuf->buf, bytesWritten);
+        }
 	if (L1desc[l1descInx].replStatus == NEWLY_CREATED_COPY && 
 	  myDataObjInfo->specColl == NULL && 
 	  L1desc[l1descInx].remoteZoneHost == NULL) {
@@ -26,6 +26,23 @@
 #include "dataObjTrim.h"
 #include "dataObjLock.h"
 #include "miscServerFunct.h"
+#include "dataObjRead.h"
+#include "dataObjUnlink.h"
+#include "endTransaction.h"
+#include "regReplica.h"
+#include "modDataObjMeta.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
+
+/* the input of a fan-out writer. One per host */
+typedef struct {
+    rsComm_t *rsComm;
+    replFanOutDest_t *fanOutDest;
+    int numDest;
+    int hostInx;
+    bytesBuf_t *dataBBuf;
+} fanOutWriteInp_t;
 
 int
 rsDataObjRepl250 (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
@@ -360,6 +377,12 @@ transferStat_t *transStat, dataObjInfo_t *oldDataObjInfo)
     }
 
     transStat->bytesWritten = srcDataObjInfoHead->dataSize;
+    if (allFlag == 1 && chkReplFanOut (dataObjInp, srcDataObjInfoHead,
+      NULL, destDataObjInfoHead) > 0) {
+	/* read the src once for all the copies */
+	return _rsDataObjReplFanOut (rsComm, dataObjInp, srcDataObjInfoHead,
+	  NULL, destDataObjInfoHead, transStat, NULL);
+    }
     destDataObjInfo = destDataObjInfoHead;
     while (destDataObjInfo != NULL) {
         if (destDataObjInfo->dataId == 0) {
@@ -446,6 +469,17 @@ dataObjInfo_t *outDataObjInfo)
           compRescInfo, &cacheRescInfo);
     }
     transStat->bytesWritten = srcDataObjInfoHead->dataSize;
+    if (allFlag == 1 && chkReplFanOut (dataObjInp, srcDataObjInfoHead,
+      destRescGrpInfo, NULL) > 0) {
+	/* read the src once for all the new copies */
+	status = _rsDataObjReplFanOut (rsComm, dataObjInp, srcDataObjInfoHead,
+	  destRescGrpInfo, NULL, transStat, outDataObjInfo);
+	if (status == 0 && destRescGrpInfo->status < 0) {
+	    /* resource down or quoto overrun */
+	    return destRescGrpInfo->status;
+	}
+	return status;
+    }
     tmpRescGrpInfo = destRescGrpInfo;
     while (tmpRescGrpInfo != NULL) {
         tmpRescInfo = tmpRescGrpInfo->rescInfo;
@@ -498,6 +532,555 @@ dataObjInfo_t *outDataObjInfo)
     }
 }
 
+/* chkReplFanOut - Check whether the repl to the resources in destRescGrpInfo
+ * (new copies) or to the copies in destDataObjInfoHead (updates) can be
+ * done with _rsDataObjReplFanOut. Only large objects going to more than
+ * one non COMPOUND_CL resource qualify.
+ * Returns the number of dests if it can be done, 0 otherwise.
+ */
+int
+chkReplFanOut (dataObjInp_t *dataObjInp, dataObjInfo_t *srcDataObjInfoHead,
+rescGrpInfo_t *destRescGrpInfo, dataObjInfo_t *destDataObjInfoHead)
+{
+    rescGrpInfo_t *tmpRescGrpInfo;
+    dataObjInfo_t *tmpDataObjInfo;
+    char *policy;
+    int numDest = 0;
+
+    policy = getValByKey (&dataObjInp->condInput, REPL_FAN_OUT_KW);
+    if (policy != NULL && strcmp (policy, REPL_FAN_OUT_OFF) == 0) {
+	return 0;
+    }
+    if (getValByKey (&dataObjInp->condInput, ALL_KW) == NULL ||
+      getValByKey (&dataObjInp->condInput, NO_CHK_COPY_LEN_KW) != NULL ||
+      dataObjInp->oprType == PHYMV_OPR) {
+	return 0;
+    }
+
+    /* smaller objects are copied with l3DataCopySingleBuf */
+    if (srcDataObjInfoHead == NULL ||
+      srcDataObjInfoHead->dataSize <= MAX_SZ_FOR_SINGLE_BUF) {
+	return 0;
+    }
+    if (nextFanOutSrc (srcDataObjInfoHead) != srcDataObjInfoHead) {
+	return 0;
+    }
+
+    /* COMPOUND_CL dests are staged with l3DataStageSync */
+    tmpRescGrpInfo = destRescGrpInfo;
+    while (tmpRescGrpInfo != NULL) {
+	if (getRescClass (tmpRescGrpInfo->rescInfo) == COMPOUND_CL) {
+	    return 0;
+	}
+	numDest++;
+	tmpRescGrpInfo = tmpRescGrpInfo->next;
+    }
+    tmpDataObjInfo = destDataObjInfoHead;
+    while (tmpDataObjInfo != NULL) {
+	if (tmpDataObjInfo->dataId != 0) {
+	    if (tmpDataObjInfo->specColl != NULL ||
+	      getRescClass (tmpDataObjInfo->rescInfo) == COMPOUND_CL) {
+		return 0;
+	    }
+	    numDest++;
+	}
+	tmpDataObjInfo = tmpDataObjInfo->next;
+    }
+
+    if (numDest < 2 || numDest > MAX_REPL_FAN_OUT) {
+	return 0;
+    }
+    return numDest;
+}
+
+/* _rsDataObjReplFanOut - Replicate srcDataObjInfo to all the resources in
+ * destRescGrpInfo (new copies) or to all the copies in destDataObjInfoHead
+ * (updates). The src is read once and each block is written to all the
+ * dests by l3DataCopyFanOut. The copies are then registered in one
+ * transaction. The REPL_FAN_OUT_KW policy in dataObjInp decides what a
+ * failed dest does to the others. With REPL_FAN_OUT_ABORT, a failed copy
+ * or registration discards all the copies. Otherwise only the failed
+ * dest is dropped and the copies registered before a failed registration
+ * are registered again. acPostProcForRepl is applied to the copies kept
+ * after the commit. If srcDataObjInfo cannot be read, the next src in
+ * the list that can be fanned out is tried, as the per-copy repl does.
+ */
+int
+_rsDataObjReplFanOut (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+dataObjInfo_t *srcDataObjInfo, rescGrpInfo_t *destRescGrpInfo,
+dataObjInfo_t *destDataObjInfoHead, transferStat_t *transStat,
+dataObjInfo_t *outDataObjInfo)
+{
+    replFanOutDest_t fanOutDest[MAX_REPL_FAN_OUT];
+    dataObjInfo_t *regDataObjInfo[MAX_REPL_FAN_OUT];
+    int regUpdate[MAX_REPL_FAN_OUT];
+    int regDestInx[MAX_REPL_FAN_OUT];
+    dataObjInfo_t *myDestDataObjInfo;
+    rescGrpInfo_t *tmpRescGrpInfo;
+    dataObjInfo_t *tmpDataObjInfo;
+    dataObjInfo_t *nextSrcDataObjInfo;
+    openedDataObjInp_t dataObjCloseInp;
+    endTransactionInp_t endTransactionInp;
+    ruleExecInfo_t rei;
+    char *policy;
+    int abortFlag;
+    int numDest = 0;
+    int numReg = 0;
+    int outInx = -1;
+    int l1descInx;
+    int status, i, j;
+    int savedStatus = 0;
+    int srcStatus = 0;
+
+    policy = getValByKey (&dataObjInp->condInput, REPL_FAN_OUT_KW);
+    if (policy != NULL && strcmp (policy, REPL_FAN_OUT_ABORT) == 0) {
+	abortFlag = 1;
+    } else {
+	abortFlag = 0;
+    }
+
+    /* open the dests. Each gets its own src L1 desc from
+     * dataObjOpenForRepl so that the close is the same as for a single
+     * copy, but only one src is read */
+    memset (fanOutDest, 0, sizeof (fanOutDest));
+    tmpRescGrpInfo = destRescGrpInfo;
+    while (tmpRescGrpInfo != NULL && numDest < MAX_REPL_FAN_OUT) {
+	fanOutDest[numDest].l1descInx = dataObjOpenForRepl (rsComm,
+	  dataObjInp, srcDataObjInfo, tmpRescGrpInfo->rescInfo,
+	  tmpRescGrpInfo->rescGroupName, outDataObjInfo, 0);
+	if (fanOutDest[numDest].l1descInx >= 0) {
+	    outInx = numDest;
+	}
+	numDest++;
+	tmpRescGrpInfo = tmpRescGrpInfo->next;
+    }
+    tmpDataObjInfo = destDataObjInfoHead;
+    while (tmpDataObjInfo != NULL && numDest < MAX_REPL_FAN_OUT) {
+	if (tmpDataObjInfo->dataId != 0) {
+	    fanOutDest[numDest].l1descInx = dataObjOpenForRepl (rsComm,
+	      dataObjInp, srcDataObjInfo, NULL, "", tmpDataObjInfo, 1);
+	    fanOutDest[numDest].destDataObjInfo = tmpDataObjInfo;
+	    numDest++;
+	}
+	tmpDataObjInfo = tmpDataObjInfo->next;
+    }
+
+    for (i = 0; i < numDest; i++) {
+	if (fanOutDest[i].l1descInx < 0) {
+	    fanOutDest[i].status = fanOutDest[i].l1descInx;
+            rodsLog (LOG_NOTICE,
+              "_rsDataObjReplFanOut: dataObjOpenForRepl of %s error, stat=%d",
+              srcDataObjInfo->objPath, fanOutDest[i].status);
+	    if (abortFlag == 1) {
+		for (j = 0; j < numDest; j++) {
+		    if (fanOutDest[j].status >= 0) {
+			fanOutDest[j].status = fanOutDest[i].status;
+		    }
+		}
+	    }
+	}
+    }
+
+    status = l3DataCopyFanOut (rsComm, fanOutDest, numDest, abortFlag);
+    if (status < 0) {
+	/* the src could not be read. All the dests have failed */
+	savedStatus = srcStatus = status;
+    }
+
+    transStat->bytesWritten = 0;
+    /* close the dests. The registrations are not committed until all
+     * the dests are closed */
+    for (i = 0; i < numDest; i++) {
+	l1descInx = fanOutDest[i].l1descInx;
+	if (l1descInx < 0) {
+	    savedStatus = fanOutDest[i].status;
+	    continue;
+	}
+	L1desc[l1descInx].oprStatus = fanOutDest[i].status;
+	if (fanOutDest[i].status >= 0) {
+	    L1desc[l1descInx].bytesWritten =
+	      L1desc[l1descInx].dataObjInfo->dataSize;
+	    L1desc[l1descInx].dataObjInfo->flags |= NO_COMMIT_FLAG;
+	}
+	memset (&dataObjCloseInp, 0, sizeof (dataObjCloseInp));
+	dataObjCloseInp.l1descInx = l1descInx;
+	status = irsDataObjClose (rsComm, &dataObjCloseInp,
+	  &myDestDataObjInfo);
+	if (fanOutDest[i].status < 0) {
+	    savedStatus = fanOutDest[i].status;
+	    freeDataObjInfo (myDestDataObjInfo);
+	    continue;
+	}
+	if (status < 0) {
+	    /* the failed registration has rolled back the ones not yet
+	     * committed. With the abort policy, all the copies go. Otherwise
+	     * the copies closed so far are registered again */
+	    fanOutDest[i].status = savedStatus = status;
+	    freeDataObjInfo (myDestDataObjInfo);
+	    endTransactionInp.arg0 = "rollback";
+	    endTransactionInp.arg1 = "";
+	    rsEndTransaction (rsComm, &endTransactionInp);
+	    if (abortFlag == 0) {
+		status = 0;
+		for (j = 0; j < numReg; j++) {
+		    status = regFanOutCopy (rsComm, dataObjInp, 
+		      srcDataObjInfo, regDataObjInfo[j], regUpdate[j]);
+		    if (status < 0) break;
+		}
+		if (status >= 0) continue;
+                rodsLog (LOG_ERROR,
+                  "_rsDataObjReplFanOut: reg again of %s failed, stat=%d",
+                  srcDataObjInfo->objPath, status);
+		rsEndTransaction (rsComm, &endTransactionInp);
+	    } else {
+		for (j = i + 1; j < numDest; j++) {
+		    if (fanOutDest[j].status >= 0) 
+		        fanOutDest[j].status = savedStatus;
+		}
+	    }
+	    for (j = 0; j < numReg; j++) {
+		if (regUpdate[j] == 0) l3Unlink (rsComm, regDataObjInfo[j]);
+		freeDataObjInfo (regDataObjInfo[j]);
+	    }
+	    numReg = 0;
+	    continue;
+	}
+	if (fanOutDest[i].destDataObjInfo != NULL) {
+	    /* the size could change */
+	    fanOutDest[i].destDataObjInfo->dataSize =
+	      myDestDataObjInfo->dataSize;
+	    regUpdate[numReg] = 1;
+	} else {
+	    regUpdate[numReg] = 0;
+	}
+	/* kept to register it again or to unlink the new copy if the
+	 * transaction is rolled back */
+	regDestInx[numReg] = i;
+	regDataObjInfo[numReg] = myDestDataObjInfo;
+	numReg++;
+    }
+
+    endTransactionInp.arg0 = "commit";
+    endTransactionInp.arg1 = "";
+    status = rsEndTransaction (rsComm, &endTransactionInp);
+    if (status < 0) {
+	rodsLog (LOG_ERROR,
+	  "_rsDataObjReplFanOut: commit of the copies of %s failed, stat=%d",
+	  srcDataObjInfo->objPath, status);
+	savedStatus = status;
+	for (j = 0; j < numReg; j++) {
+	    if (regUpdate[j] == 0) l3Unlink (rsComm, regDataObjInfo[j]);
+	}
+    } else {
+	/* the size of one copy, as for the repl of a single copy */
+	if (numReg > 0) transStat->bytesWritten = regDataObjInfo[0]->dataSize;
+	for (j = 0; j < numReg && outDataObjInfo != NULL; j++) {
+	    if (regDestInx[j] == outInx) {
+		outDataObjInfo->dataId = regDataObjInfo[j]->dataId;
+		outDataObjInfo->replNum = regDataObjInfo[j]->replNum;
+	    }
+	}
+	/* irsDataObjClose skipped the post proc of the uncommitted copies */
+	for (j = 0; j < numReg; j++) {
+	    regDataObjInfo[j]->flags &= ~NO_COMMIT_FLAG;
+	    initReiWithDataObjInp (&rei, rsComm, dataObjInp);
+	    rei.doi = regDataObjInfo[j];
+	    rei.status = 0;
+	    rei.status = applyRule ("acPostProcForRepl", NULL, &rei,
+	      NO_SAVE_REI);
+	    /* doi might have changed */
+	    regDataObjInfo[j] = rei.doi;
+	}
+    }
+    for (j = 0; j < numReg; j++) {
+	freeDataObjInfo (regDataObjInfo[j]);
+    }
+
+    if (srcStatus < 0 && numReg == 0) {
+	nextSrcDataObjInfo = nextFanOutSrc (srcDataObjInfo->next);
+	if (nextSrcDataObjInfo != NULL) {
+            rodsLog (LOG_NOTICE,
+              "_rsDataObjReplFanOut: read of %s in %s failed, stat=%d. trying %s",
+              srcDataObjInfo->objPath, srcDataObjInfo->rescName, srcStatus,
+	      nextSrcDataObjInfo->rescName);
+	    return _rsDataObjReplFanOut (rsComm, dataObjInp, 
+	      nextSrcDataObjInfo, destRescGrpInfo, destDataObjInfoHead, 
+	      transStat, outDataObjInfo);
+	}
+    }
+
+    transStat->numThreads = 1;
+    return savedStatus;
+}
+
+/* nextFanOutSrc - Returns the first src in srcDataObjInfo that
+ * _rsDataObjReplFanOut can read from, NULL if none can */
+dataObjInfo_t *
+nextFanOutSrc (dataObjInfo_t *srcDataObjInfo)
+{
+    int srcRescClass;
+
+    while (srcDataObjInfo != NULL) {
+	srcRescClass = getRescClass (srcDataObjInfo->rescInfo);
+	if (srcDataObjInfo->specColl == NULL && srcRescClass != COMPOUND_CL &&
+	  srcRescClass != BUNDLE_CL &&
+	  srcDataObjInfo->rescInfo->rescStatus != INT_RESC_STATUS_DOWN) {
+	    break;
+	}
+	srcDataObjInfo = srcDataObjInfo->next;
+    }
+    return srcDataObjInfo;
+}
+
+/* regFanOutCopy - register again a copy closed by _rsDataObjReplFanOut
+ * after its registration was rolled back. updateFlag is set if the copy
+ * existed. The registration is not committed */
+int
+regFanOutCopy (rsComm_t *rsComm, dataObjInp_t *dataObjInp,
+dataObjInfo_t *srcDataObjInfo, dataObjInfo_t *destDataObjInfo, 
+int updateFlag)
+{
+    regReplica_t regReplicaInp;
+    modDataObjMeta_t modDataObjMetaInp;
+    keyValPair_t regParam;
+    char tmpStr[MAX_NAME_LEN];
+    int status;
+
+    destDataObjInfo->flags |= NO_COMMIT_FLAG;
+    if (updateFlag == 0) {
+	memset (&regReplicaInp, 0, sizeof (regReplicaInp));
+	regReplicaInp.srcDataObjInfo = srcDataObjInfo;
+	regReplicaInp.destDataObjInfo = destDataObjInfo;
+	if (getValByKey (&dataObjInp->condInput, SU_CLIENT_USER_KW) != NULL) {
+	    addKeyVal (&regReplicaInp.condInput, SU_CLIENT_USER_KW, "");
+	    addKeyVal (&regReplicaInp.condInput, IRODS_ADMIN_KW, "");
+	} else if (getValByKey (&dataObjInp->condInput, IRODS_ADMIN_KW) != 
+	  NULL) {
+	    addKeyVal (&regReplicaInp.condInput, IRODS_ADMIN_KW, "");
+	}
+	status = rsRegReplica (rsComm, &regReplicaInp);
+	clearKeyVal (&regReplicaInp.condInput);
+    } else {
+	memset (&regParam, 0, sizeof (regParam));
+	snprintf (tmpStr, MAX_NAME_LEN, "%d", srcDataObjInfo->replStatus);
+	addKeyVal (&regParam, REPL_STATUS_KW, tmpStr);
+	snprintf (tmpStr, MAX_NAME_LEN, "%lld", destDataObjInfo->dataSize);
+	addKeyVal (&regParam, DATA_SIZE_KW, tmpStr);
+	snprintf (tmpStr, MAX_NAME_LEN, "%d", (int) time (NULL));
+	addKeyVal (&regParam, DATA_MODIFY_KW, tmpStr);
+	if (strlen (srcDataObjInfo->chksum) > 0) {
+	    addKeyVal (&regParam, CHKSUM_KW, srcDataObjInfo->chksum);
+	}
+	addKeyVal (&regParam, FILE_PATH_KW, destDataObjInfo->filePath);
+	if (getValByKey (&dataObjInp->condInput, IRODS_ADMIN_KW) != NULL) {
+	    addKeyVal (&regParam, IRODS_ADMIN_KW, "");
+	}
+	modDataObjMetaInp.dataObjInfo = destDataObjInfo;
+	modDataObjMetaInp.regParam = &regParam;
+	status = rsModDataObjMeta (rsComm, &modDataObjMetaInp);
+	clearKeyVal (&regParam);
+    }
+    destDataObjInfo->flags &= ~NO_COMMIT_FLAG;
+    return status;
+}
+
+static void
+fanOutWrite (fanOutWriteInp_t *myInput)
+{
+    replFanOutDest_t *fanOutDest = myInput->fanOutDest;
+    int len = myInput->dataBBuf->len;
+    int bytesWritten;
+    int i;
+
+    for (i = 0; i < myInput->numDest; i++) {
+	if (fanOutDest[i].hostInx != myInput->hostInx ||
+	  fanOutDest[i].status < 0) {
+	    continue;
+	}
+	bytesWritten = l3Write (myInput->rsComm, fanOutDest[i].l1descInx,
+	  len, myInput->dataBBuf);
+	if (bytesWritten != len) {
+            rodsLog (LOG_NOTICE,
+              "fanOutWrite: l3Write error, towrite %d, written %d",
+              len, bytesWritten);
+	    fanOutDest[i].status = bytesWritten < 0 ?
+	      bytesWritten : SYS_COPY_LEN_ERR;
+	}
+    }
+}
+
+/* chkFanOutDest - Returns the number of dests not failed. If abortFlag is
+ * set and one has failed, fail them all. */
+static int
+chkFanOutDest (replFanOutDest_t *fanOutDest, int numDest, int abortFlag)
+{
+    int status = 0;
+    int numLive = 0;
+    int i;
+
+    for (i = 0; i < numDest; i++) {
+	if (fanOutDest[i].status < 0) {
+	    status = fanOutDest[i].status;
+	} else {
+	    numLive++;
+	}
+    }
+    if (abortFlag == 1 && numLive < numDest) {
+	for (i = 0; i < numDest; i++) {
+	    if (fanOutDest[i].status >= 0) fanOutDest[i].status = status;
+	}
+	numLive = 0;
+    }
+    return numLive;
+}
+
+/* l3DataCopyFanOut - Read the src of the dests in fanOutDest once and write
+ * each block to all the dests. The dests are grouped by host. With PARA_OPR,
+ * the hosts are written in parallel, one thread each, while the next
+ * block is read, unless the src shares a conn with one of them.
+ * A failed dest gets its status set and is dropped. If abortFlag is set,
+ * all the dests are failed with it.
+ * Returns 0, or the error if the src could not be read.
+ */
+int
+l3DataCopyFanOut (rsComm_t *rsComm, replFanOutDest_t *fanOutDest,
+int numDest, int abortFlag)
+{
+    rodsServerHost_t *hostList[MAX_REPL_FAN_OUT];
+    fanOutWriteInp_t writeInp[MAX_REPL_FAN_OUT];
+#ifdef PARA_OPR
+    pthread_t tid[MAX_REPL_FAN_OUT];
+    int tidOk[MAX_REPL_FAN_OUT];
+#endif
+    bytesBuf_t dataBBuf[2];
+    rodsServerHost_t *srcServerHost;
+    rodsServerHost_t *destServerHost;
+    rodsLong_t bytesLeft;
+    int srcL1descInx = -1;
+    int numHost = 0;
+    int overlapFlag = 1;
+    int writeFlag = 0;
+    int curBuf = 0;
+    int bytesRead = 0;
+    int status = 0;
+    int i, j;
+
+    /* group the dests by host */
+    for (i = 0; i < numDest; i++) {
+	if (fanOutDest[i].status < 0) continue;
+	if (srcL1descInx < 0) {
+	    srcL1descInx = L1desc[fanOutDest[i].l1descInx].srcL1descInx;
+	}
+	destServerHost =
+	  FileDesc[L1desc[fanOutDest[i].l1descInx].l3descInx].rodsServerHost;
+	for (j = 0; j < numHost; j++) {
+	    if (hostList[j] == destServerHost) break;
+	}
+	if (j == numHost) {
+	    hostList[numHost] = destServerHost;
+	    numHost++;
+	}
+	fanOutDest[i].hostInx = j;
+    }
+    if (srcL1descInx < 0) {
+	/* no dest is left */
+	return 0;
+    }
+
+    srcServerHost = FileDesc[L1desc[srcL1descInx].l3descInx].rodsServerHost;
+    if (srcServerHost->localFlag != LOCAL_HOST) {
+	for (j = 0; j < numHost; j++) {
+	    if (hostList[j] == srcServerHost) overlapFlag = 0;
+	}
+    }
+
+    memset (dataBBuf, 0, sizeof (dataBBuf));
+    dataBBuf[0].buf = malloc (TRANS_BUF_SZ);
+    dataBBuf[1].buf = malloc (TRANS_BUF_SZ);
+    for (j = 0; j < numHost; j++) {
+	writeInp[j].rsComm = rsComm;
+	writeInp[j].fanOutDest = fanOutDest;
+	writeInp[j].numDest = numDest;
+	writeInp[j].hostInx = j;
+    }
+
+    bytesLeft = L1desc[srcL1descInx].dataSize;
+    while (bytesLeft > 0 || writeFlag == 1) {
+#ifdef PARA_OPR
+	if (writeFlag == 1 && overlapFlag == 0) {
+	    for (j = 0; j < numHost; j++) {
+		if (tidOk[j]) pthread_join (tid[j], NULL);
+	    }
+	    writeFlag = 0;
+	}
+#endif
+	if (bytesLeft > 0) {
+	    dataBBuf[curBuf].len = bytesLeft > TRANS_BUF_SZ ?
+	      TRANS_BUF_SZ : (int) bytesLeft;
+	    bytesRead = l3Read (rsComm, srcL1descInx, dataBBuf[curBuf].len,
+	      &dataBBuf[curBuf]);
+	}
+#ifdef PARA_OPR
+	if (writeFlag == 1) {
+	    for (j = 0; j < numHost; j++) {
+		if (tidOk[j]) pthread_join (tid[j], NULL);
+	    }
+	}
+#endif
+	writeFlag = 0;
+
+	if (bytesLeft > 0 && bytesRead <= 0) {
+	    status = bytesRead < 0 ? bytesRead : SYS_COPY_LEN_ERR;
+            rodsLog (LOG_NOTICE,
+              "l3DataCopyFanOut: l3Read error for %s, status = %d",
+              L1desc[srcL1descInx].dataObjInfo->objPath, status);
+	    for (i = 0; i < numDest; i++) {
+		if (fanOutDest[i].status >= 0) fanOutDest[i].status = status;
+	    }
+	    break;
+	}
+
+	if (chkFanOutDest (fanOutDest, numDest, abortFlag) == 0 ||
+	  bytesLeft <= 0) {
+	    break;
+	}
+
+	bytesLeft -= bytesRead;
+	dataBBuf[curBuf].len = bytesRead;
+	for (j = 0; j < numHost; j++) {
+	    writeInp[j].dataBBuf = &dataBBuf[curBuf];
+#ifdef PARA_OPR
+	    tidOk[j] = (pthread_create (&tid[j], NULL,
+	      (void *(*)(void *)) fanOutWrite, (void *) &writeInp[j]) == 0);
+	    if (!tidOk[j]) {
+		/* no thread, no write. fail the dests of this host */
+                rodsLog (LOG_NOTICE,
+                  "l3DataCopyFanOut: pthread_create for host %d failed", j);
+		for (i = 0; i < numDest; i++) {
+		    if (fanOutDest[i].hostInx == j && 
+		      fanOutDest[i].status >= 0) {
+			fanOutDest[i].status = SYS_THREAD_CREATE_ERR;
+		    }
+		}
+	    }
+#else
+	    fanOutWrite (&writeInp[j]);
+#endif
+	}
+#ifdef PARA_OPR
+	writeFlag = 1;
+#endif
+	curBuf = 1 - curBuf;
+    }
+
+    /* the writes of the last block */
+    chkFanOutDest (fanOutDest, numDest, abortFlag);
+
+    free (dataBBuf[0].buf);
+    free (dataBBuf[1].buf);
+    return status;
+}
+
 /* _rsDataObjReplS - replicate a single obj 
  *   dataObjInfo_t *srcDataObjInfo - the src to be replicated. 
  *   rescInfo_t *destRescInfo - The dest resource info
@@ -11,6 +11,7 @@
 #include "rcGlobalExtern.h"
 #include "subStructFileRead.h"  /* XXXXX can be taken out when structFile api done */
 #include "reGlobalsExtern.h"
+#include "md5Checksum.h"
 
 int
 applyRuleForPostProcForWrite(rsComm_t *rsComm, bytesBuf_t *dataObjWriteInpBBuf, char *objPath)
@@ -92,6 +93,12 @@ bytesBuf_t *dataObjWriteInpBBuf)
 	/** RAJA ADDED Dec 1 2010 for pre-post processing rule hooks **/
 	bytesWritten = l3Write (rsComm, l1descInx, dataObjWriteInp->len,
 			      dataObjWriteInpBBuf);
+	if (bytesWritten > 0 && L1desc[l1descInx].inlineChksum != NULL) {
+	    /* sequential unless rsDataObjLseek says otherwise */
+	    updateInlineChksum (L1desc[l1descInx].inlineChksum,
+	      L1desc[l1descInx].inlineChksum->segCtx[0].offset,
+	      (unsigned char *) dataObjWriteInpBBuf->buf, bytesWritten);
+	}
     }
 
     return (bytesWritten);
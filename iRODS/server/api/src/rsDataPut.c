@@ -106,6 +106,7 @@ portalOprOut_t **portalOprOut)
         myPortalOpr = rsComm->portalOpr =
           (portalOpr_t *) malloc (sizeof (portalOpr_t));
         myPortalOpr->oprType = PUT_OPR;
+        myPortalOpr->adaptiveFlag = 0;
         myPortalOpr->portList = myDataObjPutOut->portList;
 	myPortalOpr->dataOprInp = *dataOprInp;
 	memset (&dataOprInp->condInput, 0, sizeof (dataOprInp->condInput));
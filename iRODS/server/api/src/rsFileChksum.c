@@ -104,8 +104,14 @@ char **chksumStr)
 
     *chksumStr = (char*)malloc (CHKSUM_LEN);
 
-    status = fileChksum (fileChksumInp->fileType, rsComm, 
-      fileChksumInp->fileName, *chksumStr, useSha256);
+    if (fileChksumInp->flag > 1) {
+        /* the reference is the composite chksum of a parallel transfer */
+        status = fileCompositeChksum (fileChksumInp->fileType, rsComm,
+          fileChksumInp->fileName, fileChksumInp->flag, *chksumStr);
+    } else {
+        status = fileChksum (fileChksumInp->fileType, rsComm, 
+          fileChksumInp->fileName, *chksumStr, useSha256);
+    }
 
     if (status < 0) {
         rodsLog (LOG_NOTICE, 
@@ -200,3 +206,51 @@ fileChksum (int fileType, rsComm_t *rsComm, char *fileName, char *chksumStr, int
 
 }
 
+/* fileCompositeChksum - the composite chksum of fileName as if it was
+ * transferred with numSeg threads. See COMPOSITE_CHKSUM_PREFIX.
+ */
+int
+fileCompositeChksum (int fileType, rsComm_t *rsComm, char *fileName,
+int numSeg, char *chksumStr)
+{
+    int fd, len, status;
+    struct stat statbuf;
+    unsigned char *buffer;
+    rodsLong_t offset = 0;
+    inlineChksum_t inlineChksum;
+
+    status = fileStat ((fileDriverType_t)fileType, rsComm, fileName, &statbuf);
+    if (status < 0) {
+        rodsLog (LOG_NOTICE,
+        "fileCompositeChksum: fileStat failed for %s. status = %d",
+          fileName, status);
+        return (status);
+    }
+    status = initInlineChksum (&inlineChksum, numSeg, statbuf.st_size, 0);
+    if (status < 0) return (status);
+
+    if ((fd = fileOpen ((fileDriverType_t)fileType, rsComm, fileName,
+      O_RDONLY, 0, NULL)) < 0) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLog (LOG_NOTICE,
+        "fileCompositeChksum: fileOpen failed for %s. status = %d",
+          fileName, status);
+        return (status);
+    }
+    buffer = (unsigned char *) malloc (SVR_MD5_BUF_SZ);
+    while ((len = fileRead ((fileDriverType_t)fileType, rsComm, fd, buffer,
+      SVR_MD5_BUF_SZ)) > 0) {
+        updateInlineChksum (&inlineChksum, offset, buffer, len);
+        offset += len;
+    }
+    free (buffer);
+    fileClose ((fileDriverType_t)fileType, rsComm, fd);
+
+    status = finalInlineChksum (&inlineChksum, offset, chksumStr);
+    if (status < 0) {
+        rodsLog (LOG_NOTICE,
+        "fileCompositeChksum: %s changed size while read. status = %d",
+          fileName, status);
+    }
+    return (status);
+}
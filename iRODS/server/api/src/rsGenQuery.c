@@ -47,15 +47,27 @@ genQueryOut_t **genQueryOut)
 }
 
 #ifdef RODS_CAT
+/* acAclPolicy is run once per client connection */
+static int ruleExecuted=0;
+static int ruleResult=0;
+
+/* resetGenQueryAclPolicy - run acAclPolicy again for the next client of
+ * a pool agent */
+int
+resetGenQueryAclPolicy ()
+{
+    ruleExecuted = 0;
+    ruleResult = 0;
+    return (0);
+}
+
 int
 _rsGenQuery (rsComm_t *rsComm, genQueryInp_t *genQueryInp,
 	     genQueryOut_t **genQueryOut)
 {
     int status;
 
-    static int ruleExecuted=0;
     ruleExecInfo_t rei;
-    static int ruleResult=0;
 
 
     static int PrePostProcForGenQueryFlag = -2;    
@@ -0,0 +1,158 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* See genQueryStream.h for a description of this API call.*/
+
+#include "genQueryStream.h"
+#include "genQuery.h"
+#include "rsApiHandler.h"
+#include "miscUtil.h"
+
+static int
+genQueryStreamPage (rsComm_t *rsComm, rodsServerHost_t *rodsServerHost,
+genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut);
+static int
+readGenQueryStreamAck (rsComm_t *rsComm);
+
+/* rsGenQueryStream - run the query a MAX_SQL_ROWS page at a time, as
+ * rsGenQuery does, but send the rows to the client in batches as they
+ * come instead of waiting for the client to ask for each page. The
+ * batches are sent as SYS_SVR_TO_CLI_GEN_QUERY_BATCH replies; the last
+ * rows are returned in genQueryBatchBBuf with the final reply. The
+ * client acks each batch, and at most GEN_QUERY_STREAM_WINDOW batches
+ * are sent ahead of the acks. A SYS_CLI_TO_SVR_GEN_QUERY_CANCEL ack
+ * stops the query.
+ */
+
+int
+rsGenQueryStream (rsComm_t *rsComm, genQueryInp_t *genQueryInp,
+bytesBuf_t *genQueryBatchBBuf)
+{
+    rodsServerHost_t *rodsServerHost;
+    genQueryOut_t *genQueryOut = NULL;
+    int status;
+    int ack;
+    char *zoneHint;
+    int batchCap = 0;
+    int numUnacked = 0;
+    int cancelled = 0;
+    int rowCnt = 0;
+    int sendStatus = 0;
+
+    zoneHint = getZoneHintForGenQuery (genQueryInp);
+
+    status = getAndConnRcatHost(rsComm, SLAVE_RCAT, zoneHint,
+				&rodsServerHost);
+    if (status < 0) {
+       return(status);
+    }
+
+    genQueryInp->maxRows = MAX_SQL_ROWS;
+    genQueryInp->continueInx = 0;
+
+    while (1) {
+	status = genQueryStreamPage (rsComm, rodsServerHost, genQueryInp,
+	  &genQueryOut);
+	if (status < 0) break;
+
+	status = appendGenQueryBatch (genQueryBatchBBuf, &batchCap,
+	  genQueryOut);
+	rowCnt += genQueryOut->rowCnt;
+	genQueryInp->continueInx = genQueryOut->continueInx;
+	freeGenQueryOut (&genQueryOut);
+	if (status < 0 || genQueryInp->continueInx == 0) break;
+
+	if (genQueryBatchBBuf->len < GEN_QUERY_STREAM_BATCH_SZ) continue;
+
+	if (numUnacked >= GEN_QUERY_STREAM_WINDOW) {
+	    ack = readGenQueryStreamAck (rsComm);
+	    numUnacked--;
+	    if (ack != SYS_CLI_TO_SVR_GEN_QUERY_ACK) {
+		cancelled = 1;
+		break;
+	    }
+	}
+	status = sendApiReply (rsComm, rsComm->apiInx,
+	  SYS_SVR_TO_CLI_GEN_QUERY_BATCH, NULL, genQueryBatchBBuf);
+	if (status < 0) {
+            rodsLogError (LOG_ERROR, status,
+              "rsGenQueryStream: sendApiReply failed. status = %d", status);
+	    sendStatus = status;
+	    break;
+	}
+	numUnacked++;
+	genQueryBatchBBuf->len = 0;
+    }
+
+    if (genQueryInp->continueInx > 0) {
+	/* cancelled or failed. close out the statement */
+	genQueryInp->maxRows = 0;
+	genQueryStreamPage (rsComm, rodsServerHost, genQueryInp, &genQueryOut);
+	freeGenQueryOut (&genQueryOut);
+    }
+
+    if (sendStatus < 0) {
+	/* the connection is gone */
+	clearBBuf (genQueryBatchBBuf);
+	return sendStatus;
+    }
+
+    while (numUnacked > 0) {
+	ack = readGenQueryStreamAck (rsComm);
+	numUnacked--;
+	if (ack < 0) {
+	    clearBBuf (genQueryBatchBBuf);
+	    return ack;
+	}
+    }
+
+    if (cancelled != 0) {
+	clearBBuf (genQueryBatchBBuf);
+	return 0;
+    }
+
+    if (status == CAT_NO_ROWS_FOUND && rowCnt > 0) status = 0;
+    if (status < 0) {
+	clearBBuf (genQueryBatchBBuf);
+	if (status != CAT_NO_ROWS_FOUND) {
+            rodsLog (LOG_NOTICE,
+	      "rsGenQueryStream: genQuery failed after %d rows, status = %d",
+	      rowCnt, status);
+	}
+    }
+    return (status);
+}
+
+static int
+genQueryStreamPage (rsComm_t *rsComm, rodsServerHost_t *rodsServerHost,
+genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut)
+{
+    if (rodsServerHost->localFlag == LOCAL_HOST) {
+#ifdef RODS_CAT
+	return (_rsGenQuery (rsComm, genQueryInp, genQueryOut));
+#else
+	rodsLog(LOG_NOTICE,
+	  "rsGenQueryStream error. RCAT is not configured on this host");
+	return (SYS_NO_RCAT_SERVER_ERR);
+#endif
+    } else {
+	return (rcGenQuery (rodsServerHost->conn, genQueryInp, genQueryOut));
+    }
+}
+
+static int
+readGenQueryStreamAck (rsComm_t *rsComm)
+{
+    int myBuf;
+    int status;
+
+    /* read 4 bytes */
+    status = myRead (rsComm->sock, &myBuf, sizeof (myBuf), SOCK_TYPE, NULL,
+      NULL);
+    if (status < 0) {
+        rodsLogError (LOG_ERROR, status,
+          "readGenQueryStreamAck: read ack failed. status = %d", status);
+	return status;
+    }
+    return (ntohl (myBuf));
+}
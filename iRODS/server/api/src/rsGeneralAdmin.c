@@ -6,6 +6,7 @@
 #include "generalAdmin.h"
 #include "reGlobalsExtern.h"
 #include "icatHighLevelRoutines.h"
+#include "rescCache.h"
 
 int
 rsGeneralAdmin (rsComm_t *rsComm, generalAdminInp_t *generalAdminInp )
@@ -37,6 +38,11 @@ rsGeneralAdmin (rsComm_t *rsComm, generalAdminInp_t *generalAdminInp )
     if (status < 0) { 
        rodsLog (LOG_NOTICE,
 		"rsGeneralAdmin: rcGeneralAdmin error %d", status);
+    } else if (generalAdminInp->arg1 != NULL &&
+      strncmp (generalAdminInp->arg1, "resource", 8) == 0) {
+       /* resource, resourcegroup and resourcedatapaths. have the 
+	* irodsServer refresh the resource cache */
+       invalidateRescCache ();
     }
     return (status);
 }
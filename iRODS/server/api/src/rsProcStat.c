@@ -136,8 +136,14 @@ genQueryOut_t **procStatOut)
 		if (*procStatOut == NULL) {
 		    *procStatOut = singleProcStatOut;
 		} else {
-		    catGenQueryOut (*procStatOut, singleProcStatOut,
+		    status = catGenQueryOut (*procStatOut, singleProcStatOut,
 		      MAX_PROC_STAT_CNT);
+		    if (status < 0) {
+			rodsLogError (LOG_ERROR, status,
+			  "_rsProcStatAll: catGenQueryOut error for %s",
+			  myProcStatInp.addr);
+			savedStatus = status;
+		    }
 		    freeGenQueryOut (&singleProcStatOut);
 		}
 		singleProcStatOut = NULL;
@@ -278,6 +284,10 @@ genQueryOut_t **procStatOut, rodsServerHost_t *rodsServerHost)
     if (status >= 0) {
         status = rcProcStat (rodsServerHost->conn, procStatInp, procStatOut);
     }
+    if (status >= 0) {
+	/* an older server returns fewer columns */
+	status = normProcStatOut (procStatOut);
+    }
     if (status < 0 && *procStatOut == NULL) {
 	/* add an empty entry */
         initProcStatOut (procStatOut, 1);
@@ -301,7 +311,7 @@ initProcStatOut (genQueryOut_t **procStatOut, int numProc)
 
     myProcStatOut->continueInx = -1;
 
-    myProcStatOut->attriCnt = 9;
+    myProcStatOut->attriCnt = PROC_STAT_ATTRI_CNT;
 
     myProcStatOut->sqlResult[0].attriInx = PID_INX;
     myProcStatOut->sqlResult[0].len = NAME_LEN;
@@ -357,6 +367,18 @@ initProcStatOut (genQueryOut_t **procStatOut, int numProc)
       (char*)malloc (NAME_LEN * numProc);
     bzero (myProcStatOut->sqlResult[8].value, NAME_LEN * numProc);
 
+    myProcStatOut->sqlResult[9].attriInx = L1DESC_HWM_INX;
+    myProcStatOut->sqlResult[9].len = NAME_LEN;
+    myProcStatOut->sqlResult[9].value =
+      (char*)malloc (NAME_LEN * numProc);
+    bzero (myProcStatOut->sqlResult[9].value, NAME_LEN * numProc);
+
+    myProcStatOut->sqlResult[10].attriInx = L3DESC_HWM_INX;
+    myProcStatOut->sqlResult[10].len = NAME_LEN;
+    myProcStatOut->sqlResult[10].value =
+      (char*)malloc (NAME_LEN * numProc);
+    bzero (myProcStatOut->sqlResult[10].value, NAME_LEN * numProc);
+
 
     return 0;    
 }
@@ -387,9 +409,49 @@ addProcToProcStatOut (procLog_t *procLog, genQueryOut_t *procStatOut)
       procLog->serverAddr, NAME_LEN);
     rstrcpy (&procStatOut->sqlResult[8].value[NAME_LEN * rowCnt],
       procLog->progName, NAME_LEN);
+    snprintf (&procStatOut->sqlResult[9].value[NAME_LEN * rowCnt],
+      NAME_LEN, "%d", procLog->l1descHwm);
+    snprintf (&procStatOut->sqlResult[10].value[NAME_LEN * rowCnt],
+      NAME_LEN, "%d", procLog->l3descHwm);
 
     procStatOut->rowCnt++;
 
     return 0;
 }
 
+/* normProcStatOut - convert the procStatOut returned by a server to the
+ * columns made by initProcStatOut so that the results of all servers can
+ * be put together with catGenQueryOut. Columns the server does not know
+ * about are left empty */
+
+int
+normProcStatOut (genQueryOut_t **procStatOut)
+{
+    genQueryOut_t *oldProcStatOut, *newProcStatOut = NULL;
+    sqlResult_t *oldSqlResult, *newSqlResult;
+    int i, j, rowCnt, status;
+
+    if (procStatOut == NULL || *procStatOut == NULL) return 0;
+    oldProcStatOut = *procStatOut;
+    if (oldProcStatOut->attriCnt == PROC_STAT_ATTRI_CNT) return 0;
+
+    rowCnt = oldProcStatOut->rowCnt;
+    status = initProcStatOut (&newProcStatOut, rowCnt > 0 ? rowCnt : 1);
+    if (status < 0) return status;
+
+    for (i = 0; i < PROC_STAT_ATTRI_CNT; i++) {
+	newSqlResult = &newProcStatOut->sqlResult[i];
+	oldSqlResult = getSqlResultByInx (oldProcStatOut, 
+	  newSqlResult->attriInx);
+	if (oldSqlResult == NULL || oldSqlResult->value == NULL) continue;
+	for (j = 0; j < rowCnt; j++) {
+	    rstrcpy (&newSqlResult->value[NAME_LEN * j],
+	      &oldSqlResult->value[oldSqlResult->len * j], NAME_LEN);
+	}
+    }
+    newProcStatOut->rowCnt = rowCnt;
+
+    freeGenQueryOut (procStatOut);
+    *procStatOut = newProcStatOut;
+    return 0;
+}
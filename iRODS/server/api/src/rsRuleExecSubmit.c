@@ -114,6 +114,9 @@ _rsRuleExecSubmit (rsComm_t *rsComm, ruleExecSubmitInp_t *ruleExecSubmitInp)
     if (status < 0) {
         rodsLog(LOG_ERROR,
          "_rsRuleExecSubmit: chlRegRuleExec error. status = %d", status);
+    } else {
+        /* the irodsReServer runs on this host. Don't wait for its poll */
+        notifyReServer ();
     }
     return (status);
 #else
@@ -14,7 +14,11 @@
 #include "fileDriver.h"
 #include "chkNVPathPerm.h"
 
-#define NUM_FILE_DESC	1026 	/* number of FileDesc */
+/* FileDesc is reserved at MAX_NUM_FILE_DESC entries and grows the same
+ * way as L1desc */
+#define DEF_NUM_FILE_DESC	1026 	/* initial number of FileDesc */
+#define MAX_NUM_FILE_DESC	(64 * DEF_NUM_FILE_DESC)
+#define NUM_FILE_DESC	NumFileDesc 	/* current number of FileDesc */
 
 /* definition for inuseFlag */
 
@@ -46,6 +50,8 @@ fileDriverType_t fileType, int fd, int mode);
 
 int
 freeFileDesc (int fileInx);
+int
+getFileDescHwm ();
 
 int
 getServerHostByFileInx (int fileInx, rodsServerHost_t **rodsServerHost);
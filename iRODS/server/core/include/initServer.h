@@ -195,6 +195,8 @@ initAgent (int processType, rsComm_t *rsComm);
 int
 initAgent (rsComm_t *rsComm);
 #endif
+int
+initPoolAgent (rsComm_t *rsComm);
 void cleanupAndExit (int status);
 #ifdef  __cplusplus
 void signalExit ( int );
@@ -276,6 +278,8 @@ readProcLog (int pid, procLog_t *procLog);
 int
 rmProcLog (int pid);
 int
+logAgentDescHwm ();
+int
 getXmsgHost (rodsServerHost_t **rodsServerHost);
 int
 setRsCommFromRodsEnv (rsComm_t *rsComm);
@@ -19,12 +19,20 @@
 #include "getRodsEnv.h"
 #include "rcConnect.h"
 #include "initServer.h"
+#include "reServerLib.h"
 
 #define RE_SERVER_SLEEP_TIME    30
 #define RE_SERVER_EXEC_TIME     120
 
 uint CoreIrbTimeStamp = 0;
 
+/* a job sent to a worker of the pool. The worker replies with the
+ * int status of the job */
+typedef struct {
+    char ruleExecId[NAME_LEN];
+    int jobType;
+} reJobMsg_t;
+
 /* definition for flagval flags */
 
 #define v_FLAG  0x1
@@ -32,7 +40,29 @@ uint CoreIrbTimeStamp = 0;
 void
 reServerMain (rsComm_t *rsComm, char *logDir);
 int
-reSvrSleep (rsComm_t *rsComm);
+waitReEvent (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int waitTime);
+int
+dispatchReJob (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int thrInx, reQueueEntry_t *reQueueEntry);
+int
+finishReJob (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int thrInx, int status);
+int
+endReWorker (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int thrInx, int waitStatus);
+int
+reapReWorkers (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue);
+int
+startReWorker (rsComm_t *rsComm, reExec_t *reExec, int thrInx);
+int
+reWorkerMain (rsComm_t *rsComm, int jobFd);
+int
+readReWorkerMsg (int fd, void *buf, int len);
+int
+writeReWorkerMsg (int fd, void *buf, int len);
+int
+reSvrReconnRcat (rsComm_t *rsComm);
 int
 chkAndResetRule (rsComm_t *rsComm);
 #endif	/* IRODS_RE_SERVER_H */
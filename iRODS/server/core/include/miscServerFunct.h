@@ -43,6 +43,9 @@ typedef struct PortalTransferInp {
     rodsLong_t size;
     rodsLong_t offset;
     rodsLong_t bytesWritten;
+    rodsLong_t zeroCopyBytes;	/* moved with sendfile/splice */
+    rodsLong_t bufferedBytes;	/* moved through the transfer buffer */
+    struct InlineChksum *inlineChksum;	/* chksum the put data into this */
     int flags;
     int status;
     dataOprInp_t *dataOprInp;
@@ -67,6 +70,8 @@ partialDataPut (portalTransferInp_t *myInput);
 void
 partialDataGet (portalTransferInp_t *myInput);
 int
+getZeroCopyFd (int rescTypeInx, int l3descInx);
+int
 fillPortalTransferInp (portalTransferInp_t *myInput, rsComm_t *rsComm,
 int srcFd, int destFd, int destRescTypeInx, int srcRescTypeInx,
 int threadNum, rodsLong_t size, rodsLong_t offset, int flags);
@@ -137,6 +142,14 @@ setupSrvPortalForParaOpr (rsComm_t *rsComm, dataOprInp_t *dataOprInp,
 int oprType, portalOprOut_t **portalOprOut);
 int
 readStartupPack (int sock, startupPack_t **startupPack, struct timeval *tv);
+#ifndef windows_platform
+int
+sendPoolConnReq (int poolSock, int sock, startupPack_t *startupPack);
+int
+recvPoolConnReq (int poolSock, int *sock, startupPack_t *startupPack);
+int
+sendPoolAgentStatus (int poolSock, int agentStatus);
+#endif
 #ifdef RUN_SERVER_AS_ROOT
 int 
 initServiceUser ();
@@ -22,7 +22,12 @@
 #include "ncGetAggInfo.h"
 #endif
 
-#define NUM_L1_DESC	1026 	/* number of L1Desc */
+/* L1desc is reserved at MAX_NUM_L1_DESC entries so it never moves, but
+ * only the first NUM_L1_DESC are in use. NUM_L1_DESC starts at
+ * DEF_NUM_L1_DESC and doubles when the free list runs out. */
+#define DEF_NUM_L1_DESC	1026 	/* initial number of L1Desc */
+#define MAX_NUM_L1_DESC	(64 * DEF_NUM_L1_DESC)
+#define NUM_L1_DESC	NumL1desc 	/* current number of L1Desc */
 
 #define CHK_ORPHAN_CNT_LIMIT  20  /* number of failed check before stopping */
 /* definition for getNumThreads */
@@ -65,6 +70,8 @@ typedef struct l1desc {
     dataObjInfo_t *replDataObjInfo; /* if non NULL, repl to this dataObjInfo
 				     * on close */
     rodsServerHost_t *remoteZoneHost;
+    struct InlineChksum *inlineChksum; /* if non NULL, the chksum of the
+					* data as they are written */
 } l1desc_t;
 
 #ifdef  __cplusplus
@@ -102,6 +109,10 @@ freeL1desc (int l1descInx);
 int
 closeAllL1desc (rsComm_t *rsComm);
 int
+nextL1descInuse (int l1descInx);
+int
+getL1descHwm ();
+int
 initSpecCollDesc ();
 int
 allocSpecCollDesc ();
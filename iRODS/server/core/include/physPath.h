@@ -25,6 +25,13 @@
 #define LOCK_FILE_DIR	"lockFileDir"
 #define LOCK_FILE_TRAILER	"LOCK_FILE"	/* added to end of lock file */ 
 
+/* env variables for the chksum taken while the data streams in. With
+ * CHKSUM_BY_READ_KW set, the file is always read again to chksum it.
+ * With COMPOSITE_CHKSUM_KW set, a parallel put may register the composite
+ * chksum (see COMPOSITE_CHKSUM_PREFIX) instead of reading the file again */
+#define CHKSUM_BY_READ_KW	"irodsChksumByRead"
+#define COMPOSITE_CHKSUM_KW	"irodsCompositeChksum"
+
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -63,6 +70,12 @@ _dataObjChksum (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, char **chksumStr);
 rodsLong_t 
 getSizeInVault (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo);
 int
+startInlineChksum (int l1descInx, int numSeg, rodsLong_t dataSize);
+int
+freeInlineChksum (int l1descInx);
+int
+dataObjChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr);
+int
 dataObjChksumAndReg (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
 char **chksumStr);
 int
@@ -17,11 +17,21 @@
 #include "rsGlobalExtern.h"
 #include "reIn2p3SysRule.h"
 
-#define MAX_RE_PROCS	4
+#define MAX_RE_PROCS	64
 #define DEF_NUM_RE_PROCS	1
 #define RESC_UPDATE_TIME        60
 #define RE_EXE	"irodsReServer"
 
+/* the delayed rule queue */
+#define RE_WAKEUP_FIFO_NAME	"reServerWakeup"	/* in the state dir */
+#define RE_STATS_FILE_NAME	"reServerStats"		/* in the log dir */
+#define RE_QUEUE_RESYNC_TIME_KW	"irodsReServerResyncTime"
+#define RE_WORKER_MAX_JOBS_KW	"irodsReServerWorkerMaxJobs"
+#define DEF_RE_QUEUE_RESYNC_TIME	300	/* full reload of the queue */
+#define DEF_RE_WORKER_MAX_JOBS	1000	/* jobs before a worker is recycled */
+#define RE_STATS_INTERVAL	60
+#define RE_FAILED_RETRY_TIME	30	/* wait before rerunning failed jobs */
+
 typedef enum {
     RE_PROC_IDLE,
     RE_PROC_RUNNING,
@@ -34,6 +44,9 @@ typedef struct {
     int status;
     int jobType;	/* 0 or RE_FAILED_STATUS */
     pid_t pid;
+    int jobFd;		/* socket to the worker of the pool. -1 if none */
+    int jobCnt;		/* jobs run by the worker */
+    time_t startTime;	/* of the running job */
 } reExecProc_t;
 
 typedef struct {
@@ -43,6 +56,33 @@ typedef struct {
     reExecProc_t reExecProc[MAX_RE_PROCS];
 } reExec_t;
 
+/* an entry of the in memory queue of delayed rules */
+typedef struct {
+    rodsLong_t exeTime;
+    rodsLong_t ruleExecId;
+    int jobType;	/* 0 or RE_FAILED_STATUS */
+} reQueueEntry_t;
+
+/* the delayed rules queue, a min heap ordered by exeTime. maxRuleExecId
+ * is the largest id loaded so far, so only newer jobs need to be queried
+ * when the server is woken up */
+typedef struct {
+    reQueueEntry_t *entries;
+    int numEntries;
+    int maxEntries;
+    rodsLong_t maxRuleExecId;
+    time_t nextResync;		/* time of the next full load */
+    time_t lastLoad;		/* time of the last load of any kind */
+    int resyncTime;
+    /* for the stats */
+    rodsLong_t jobsRun;
+    rodsLong_t jobsFailed;
+    rodsLong_t lagCnt;
+    double totalLag;
+    int maxLag;
+    time_t lastStats;
+} reQueue_t;
+
 int
 getReInfo (rsComm_t *rsComm, genQueryOut_t **genQueryOut);
 int
@@ -86,4 +126,26 @@ char *userName, char *exeAddress, char *exeFrequency, char *priority,
 char *estimateExeTime, char *notificationAddr);
 int
 reServerSingleExec (rsComm_t *rsComm, char *ruleExecId, int jobType);
+int
+postProcReThr (rsComm_t *rsComm, reExec_t *reExec, int thrInx);
+int
+initReQueue (reQueue_t *reQueue);
+int
+pushReQueue (reQueue_t *reQueue, rodsLong_t ruleExecId, rodsLong_t exeTime,
+int jobType);
+int
+popReQueue (reQueue_t *reQueue, reQueueEntry_t *outEntry);
+int
+loadReQueue (rsComm_t *rsComm, reQueue_t *reQueue, reExec_t *reExec,
+int fullFlag);
+int
+requeueRuleExec (rsComm_t *rsComm, reQueue_t *reQueue, char *ruleExecId);
+int
+openReWakeup (int *wakeupFd, int *dummyFd);
+int
+drainReWakeup (int wakeupFd);
+int
+notifyReServer ();
+int
+writeReStats (reQueue_t *reQueue, reExec_t *reExec);
 #endif	/* RE_SERVER_LIB_H */
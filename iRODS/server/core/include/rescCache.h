@@ -0,0 +1,62 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* rescCache.h - header file for rescCache.c
+ */
+
+
+
+#ifndef RESC_CACHE_H
+#define RESC_CACHE_H
+
+#include "rods.h"
+
+#define RESC_CACHE_FILE_NAME	"rescCache"	/* in the log dir */
+#define RESC_CACHE_SZ		(4*1024*1024)
+#define RESC_CACHE_REFRESH_TIME	60	/* the irodsServer refresh interval */
+#define RESC_CACHE_POLL_TIME	5	/* check for invalidation this often */
+#define RESC_CACHE_MAX_AGE	300	/* agents ignore an older snapshot */
+
+/* the tables in the snapshot. Each holds the result of one of the
+ * catalog queries done by the agents in resource.c */
+#define RESC_CACHE_RESC_TBL	0	/* the resources, for initResc */
+#define RESC_CACHE_GRP_TBL	1	/* resc group members, for initRescGrp */
+#define RESC_CACHE_LOAD_TBL	2	/* the load, for sortRescByLoad */
+#define RESC_CACHE_HOST_TBL	3	/* resc host addr and its canonical name */
+#define NUM_RESC_CACHE_TBL	4
+
+/* the header at the start of the snapshot. version is bumped on every
+ * refresh and every invalidation so that an agent can tell whether what
+ * it built its resource list from is still current. */
+typedef struct {
+    unsigned int version;
+    unsigned int refreshTime;
+    int invalid;	/* set on admin changes until the next refresh */
+    int tblOffset[NUM_RESC_CACHE_TBL];	/* 0 if the table is not there */
+} rescCacheHeader_t;
+
+/* a table is a compacted genQueryOut_t. The values of each column
+ * (rowCnt * len[i] bytes) follow the rescCacheTbl_t, column by column */
+typedef struct {
+    int attriCnt;
+    int rowCnt;
+    int attriInx[MAX_SQL_ATTR];
+    int len[MAX_SQL_ATTR];
+} rescCacheTbl_t;
+
+int
+refreshRescCache (rsComm_t *rsComm);
+void
+rescCacheWorkerTask ();
+int
+invalidateRescCache ();
+int
+getRescCacheQueryOut (int tblInx, genQueryOut_t **genQueryOut);
+int
+genQueryByRescCache (rsComm_t *rsComm, int tblInx,
+genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut);
+int
+getRescCacheHostName (char *hostAddr, char *hostName);
+int
+rescCacheChanged ();
+#endif	/* RESC_CACHE_H */
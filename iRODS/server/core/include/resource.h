@@ -100,6 +100,8 @@ initResc (rsComm_t *rsComm);
 int
 getHostStatusByRescInfo (rodsServerHost_t *rodsServerHost);
 int
+setRescQueryInp (int tblInx, genQueryInp_t *genQueryInp);
+int
 procAndQueRescResult (genQueryOut_t *genQueryOut);
 int
 printLocalResc ();
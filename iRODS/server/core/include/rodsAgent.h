@@ -24,5 +24,10 @@
 #define READ_RETRY_SLEEP_TIME	1	
 
 int agentMain (rsComm_t *rsComm);
+#ifndef windows_platform
+int poolAgentMain (int poolSock, rsComm_t *rsComm);
+int poolAgentConn (rsComm_t *rsComm, startupPack_t *startupPack);
+int resetPoolAgentConn (rsComm_t *rsComm);
+#endif
 
 #endif	/* RODS_AGENT_H */
@@ -50,6 +50,35 @@ extern int optind, opterr, optopt;
 
 #define AGENT_QUE_CHK_INT	600	/* check the agent queue every 600 sec
 					 * for consistence */
+
+/* Pre-forked agent pool. The pool is off unless agentPoolMin is set in
+ * the env (see irodsctl). An idle pool agent has already loaded the server
+ * config, the rule base and the ICAT connection and is handed the client 
+ * socket with SCM_RIGHTS instead of fork/execv of a fresh irodsAgent */
+
+#define AGENT_POOL_MIN_KW	"agentPoolMin"	/* num of agents kept warm */
+#define AGENT_POOL_MAX_KW	"agentPoolMax"	/* max num of pool agents */
+#define AGENT_POOL_MAX_REUSE_KW	"agentPoolMaxReuse" /* connections served
+						     * before an agent retires */
+#define DEF_AGENT_POOL_MAX_REUSE	1000
+
+/* definition for poolAgent_t state */
+#define POOL_AGENT_STARTING	0	/* forked, loading config and rules */
+#define POOL_AGENT_IDLE		1	/* waiting for a connection */
+#define POOL_AGENT_BUSY		2	/* serving a client */
+#define POOL_AGENT_DEAD		3	/* pool sock closed, waiting for reap */
+
+/* the status a pool agent sends back on the pool sock */
+#define POOL_AGENT_READY	0
+
+typedef struct poolAgent {
+    int pid;
+    int poolSock;	/* server end of the socketpair */
+    int state;
+    int connCnt;	/* num of connections handed to this agent */
+    struct poolAgent *next;
+} poolAgent_t;
+
 int serverize (char *logDir);
 int serverMain (char *logDir);
 int
@@ -105,4 +134,20 @@ int
 procBadReq ();
 void
 purgeLockFileWorkerTask ();
+int
+closeQueuedConnSock ();
+int
+initAgentPool ();
+int
+startPoolAgent ();
+int
+replenishAgentPool ();
+int
+procPoolAgentMsg ();
+int
+dispatchToPoolAgent (agentProc_t *connReq, agentProc_t **agentProcHead);
+int
+rmPoolAgentByPid (int childPid);
+int
+getPoolAgentCnt ();
 #endif	/* RODS_SERVER_H */
@@ -40,6 +40,10 @@ rsApiHandler (rsComm_t *rsComm, int apiNumber, bytesBuf_t *inputStructBBuf,
 bytesBuf_t *bsBBuf);
 int
 chkApiVersion (rsComm_t *rsComm, int apiInx);
+char *
+getApiReplyType (rsComm_t *rsComm, char *replyType);
+int
+setReqPipeCork (rsComm_t *rsComm);
 int
 chkApiPermission (rsComm_t *rsComm, int apiInx);
 int
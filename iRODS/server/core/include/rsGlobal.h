@@ -33,8 +33,10 @@ int RescGrpInit = 0;	/* whether initRescGrp has been called */
 
 /* global fileDesc */
 
-fileDesc_t FileDesc[NUM_FILE_DESC];
-l1desc_t L1desc[NUM_L1_DESC];
+fileDesc_t *FileDesc = NULL;	/* allocated by initFileDesc */
+int NumFileDesc = 0;
+l1desc_t *L1desc = NULL;	/* allocated by initL1desc */
+int NumL1desc = 0;
 specCollDesc_t SpecCollDesc[NUM_SPEC_COLL_DESC];
 collHandle_t CollHandle[NUM_COLL_HANDLE];
 
@@ -51,6 +53,8 @@ char KerberosName[MAX_NAME_LEN];
 
 int InitialState = INITIAL_NOT_DONE;
 rsComm_t *ThisComm = NULL;
+int ServerInfoState = INITIAL_NOT_DONE;	/* initServerInfo done. a pool 
+						 * agent does it only once */
 
 #ifdef RODS_CAT
 int IcatConnState = INITIAL_NOT_DONE;
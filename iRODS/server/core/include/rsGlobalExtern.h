@@ -34,8 +34,10 @@ extern zoneInfo_t *ZoneInfoHead;
 extern rescGrpInfo_t *RescGrpInfo;
 extern rescGrpInfo_t *CachedRescGrpInfo;
 extern int RescGrpInit;
-extern fileDesc_t FileDesc[];
-extern l1desc_t L1desc[];
+extern fileDesc_t *FileDesc;
+extern int NumFileDesc;
+extern l1desc_t *L1desc;
+extern int NumL1desc;
 extern specCollDesc_t SpecCollDesc[];
 extern collHandle_t CollHandle[];
 
@@ -50,6 +52,7 @@ extern char KerberosName[];
 
 extern int InitialState;
 extern rsComm_t *ThisComm;
+extern int ServerInfoState;
 
 #ifdef RODS_CAT
 extern int IcatConnState;
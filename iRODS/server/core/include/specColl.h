@@ -30,6 +30,8 @@ int
 queueSpecCollCache (rsComm_t *rsComm, genQueryOut_t *genQueryOut, char *objPath);
 int
 queueSpecCollCacheWithObjStat (rodsObjStat_t *rodsObjStatOut);
+int
+freeSpecCollCache ();
 specCollCache_t *
 matchSpecCollCache (char *objPath);
 int
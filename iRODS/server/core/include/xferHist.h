@@ -0,0 +1,46 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* xferHist.h - header file for xferHist.c
+ */
+
+
+
+#ifndef XFER_HIST_H
+#define XFER_HIST_H
+
+#include "rods.h"
+
+/* the env variable that turns on the adaptive transfer mode. Its value is
+ * the max number of threads the adaptive mode may use */
+#define ADAPTIVE_XFER_KW		"irodsAdaptiveXfer"
+
+#define XFER_HIST_FILE_NAME	"xferHist"	/* in the log dir */
+#define NUM_XFER_HIST_HOST	256
+#define NUM_XFER_HIST_BUCKET	6	/* 1, 2, 4, 8, 16 and 32 threads */
+#define XFER_HIST_MAX_AGE	(24 * 3600)	/* forget older history */
+#define XFER_HIST_MIN_SAMPLES	2	/* before probing the next bucket */
+#define ADAPTIVE_MIN_SZ_PER_THR	(8*1024*1024)	/* min bytes per stream */
+#define WAN_RTT_USEC		20000	/* rtt above this is a long link */
+
+/* the history kept for each peer host. bucketRate[i] is the smoothed
+ * aggregate rate in bytes/sec of transfers done with 1 << i threads */
+typedef struct {
+    char hostAddr[NAME_LEN];
+    unsigned int lastUpdate;
+    int rttUsec;
+    int bucketCnt[NUM_XFER_HIST_BUCKET];
+    double bucketRate[NUM_XFER_HIST_BUCKET];
+} xferHist_t;
+
+int
+getAdaptiveXferMaxThr ();
+int
+getSockRtt (int sock);
+int
+chooseAdaptiveXfer (rsComm_t *rsComm, rodsLong_t dataSize, int numThreads,
+int *windowSize, int *rttUsec);
+int
+recordAdaptiveXfer (rsComm_t *rsComm, int numThreads, int windowSize,
+int rttUsec, rodsLong_t bytesTransferred, float elapsed);
+#endif	/* XFER_HIST_H */
@@ -10,10 +10,55 @@
 #include "rcGlobalExtern.h"
 #include "collection.h"
 
+/* free FileDesc are kept on a stack, the same way as L1desc */
+
+static int *FileDescFreeList = NULL;
+static int FileDescFreeCnt = 0;
+static int FileDescInuseCnt = 0;
+static int FileDescHwm = 0;	/* max FileDescInuseCnt for this agent */
+
+/* growFileDesc - make FileDesc up to newNumFileDesc available and put the
+ * new ones on the free list. Returns the number added. */
+
+static int
+growFileDesc (int newNumFileDesc)
+{
+    int i, startInx;
+
+    if (newNumFileDesc > MAX_NUM_FILE_DESC) newNumFileDesc = MAX_NUM_FILE_DESC;
+    startInx = NumFileDesc < 3 ? 3 : NumFileDesc;
+    if (newNumFileDesc <= startInx) return 0;
+
+    for (i = newNumFileDesc - 1; i >= startInx; i--) {
+        FileDescFreeList[FileDescFreeCnt++] = i;
+    }
+    NumFileDesc = newNumFileDesc;
+
+    return (newNumFileDesc - startInx);
+}
+
 int
 initFileDesc ()
 {
-    memset (FileDesc, 0, sizeof (fileDesc_t) * NUM_FILE_DESC);
+    if (FileDesc == NULL) {
+        /* reserved at the max size. FileDesc are used by the portal
+         * threads and must not move */
+        FileDesc = (fileDesc_t *) calloc (MAX_NUM_FILE_DESC, 
+          sizeof (fileDesc_t));
+        FileDescFreeList = (int *) malloc (MAX_NUM_FILE_DESC * sizeof (int));
+        if (FileDesc == NULL || FileDescFreeList == NULL) {
+            rodsLog (LOG_ERROR,
+              "initFileDesc: malloc of %d FileDesc failed", MAX_NUM_FILE_DESC);
+            return (SYS_MALLOC_ERR);
+        }
+    } else {
+        memset (FileDesc, 0, sizeof (fileDesc_t) * NumFileDesc);
+    }
+    NumFileDesc = 0;
+    FileDescFreeCnt = 0;
+    FileDescInuseCnt = 0;
+    growFileDesc (DEF_NUM_FILE_DESC);
+
     return (0);
 }
 
@@ -22,17 +67,30 @@ allocFileDesc ()
 {
     int i;
 
-    for (i = 3; i < NUM_FILE_DESC; i++) {
-	if (FileDesc[i].inuseFlag == FD_FREE) {
-	    FileDesc[i].inuseFlag = FD_INUSE;
-	    return (i);
-	};
+    if (FileDesc == NULL && (i = initFileDesc ()) < 0) {
+        return (i);
     }
 
-    rodsLog (LOG_NOTICE,
-     "allocFileDesc: out of FileDesc");
+    if (FileDescFreeCnt <= 0 && growFileDesc (2 * NumFileDesc) <= 0) {
+        rodsLog (LOG_NOTICE,
+         "allocFileDesc: out of FileDesc");
+        return (SYS_OUT_OF_FILE_DESC);
+    }
 
-    return (SYS_OUT_OF_FILE_DESC);
+    i = FileDescFreeList[--FileDescFreeCnt];
+    FileDesc[i].inuseFlag = FD_INUSE;
+    FileDescInuseCnt++;
+    if (FileDescInuseCnt > FileDescHwm) {
+        FileDescHwm = FileDescInuseCnt;
+    }
+
+    return (i);
+}
+
+int
+getFileDescHwm ()
+{
+    return (FileDescHwm);
 }
 
 int
@@ -58,6 +116,8 @@ fileDriverType_t fileType, int fd, int mode)
 int
 freeFileDesc (int fileInx)
 {
+    int inuseFlag;
+
     if (fileInx < 3 || fileInx >= NUM_FILE_DESC) {
 	rodsLog (LOG_NOTICE,
 	 "freeFileDesc: fileInx %d out of range", fileInx); 
@@ -70,8 +130,14 @@ freeFileDesc (int fileInx)
 
     /* don't free driverDep (dirPtr is not malloced */
 
+    inuseFlag = FileDesc[fileInx].inuseFlag;
     memset (&FileDesc[fileInx], 0, sizeof (fileDesc_t));
 
+    if (inuseFlag == FD_INUSE) {
+        FileDescInuseCnt--;
+        FileDescFreeList[FileDescFreeCnt++] = fileInx;
+    }
+
     return (0);
 } 
 
@@ -13,6 +13,7 @@
 
 #include "initServer.h"
 #include "resource.h"
+#include "rescCache.h"
 #include "rsGlobalExtern.h"
 #include "rcGlobalExtern.h"
 #include "genQuery.h"
@@ -20,6 +21,7 @@
 #include "miscServerFunct.h"
 #include "reGlobalsExtern.h"
 #include "reDefines.h"
+#include "reconstants.h"
 #include "getRemoteZoneResc.h"
 #include "getRescQuota.h"
 #include "physPath.h"
@@ -169,6 +171,7 @@ rodsServerHost_t *
 mkServerHost (char *myHostAddr, char *zoneName)
 {
     rodsServerHost_t *tmpRodsServerHost;
+    char canonName[NAME_LEN];
     int status;
 
     tmpRodsServerHost = (rodsServerHost_t*)malloc (sizeof (rodsServerHost_t));
@@ -190,7 +193,13 @@ mkServerHost (char *myHostAddr, char *zoneName)
 
     tmpRodsServerHost->localFlag = UNKNOWN_HOST_LOC;
 
-    status = queAddr (tmpRodsServerHost, myHostAddr);
+    /* the irodsServer has done the gethostbyname of resource hosts */
+    if (getRescCacheHostName (myHostAddr, canonName) >= 0) {
+	if (strcasecmp (myHostAddr, canonName) != 0) 
+	    queHostName (tmpRodsServerHost, canonName, 0);
+    } else {
+        status = queAddr (tmpRodsServerHost, myHostAddr);
+    }
 
     status = matchHostConfig (tmpRodsServerHost);
 
@@ -1347,17 +1356,34 @@ initAgent (rsComm_t *rsComm)
     rsComm_t myComm;
     ruleExecInfo_t rei;
 
-    initProcLog ();
+    if (ServerInfoState != INITIAL_DONE) {
+        initProcLog ();
 
-    status = initServerInfo (rsComm);
+        status = initServerInfo (rsComm);
+        if (status < 0) {
+            rodsLog (LOG_ERROR,
+              "initAgent: initServerInfo error, status = %d",
+              status);
+            return (status);
+        }
+        ServerInfoState = INITIAL_DONE;
+    } else if (rescCacheChanged () != 0) {
+	/* a pool agent. pick up the resource changes made since it was
+	 * warmed up, or reload if the cache cannot tell */
+	status = updateResc (rsComm);
+	if (status < 0 && status != CAT_NO_ROWS_FOUND) {
+            rodsLog (LOG_NOTICE,
+              "initAgent: updateResc error, status = %d", status);
+	}
+    }
+
+    status = initL1desc ();
     if (status < 0) {
         rodsLog (LOG_ERROR,
-          "initAgent: initServerInfo error, status = %d",
+          "initAgent: initL1desc error, status = %d",
           status);
         return (status);
     }
-
-    initL1desc ();
     initSpecCollDesc ();
     initCollHandle ();
     status = initFileDesc ();
@@ -1455,6 +1481,41 @@ initAgent (rsComm_t *rsComm)
     return (status);
 }
 
+/* initPoolAgent - the part of initAgent that does not depend on the
+ * client connection. A pre-forked pool agent calls this once before it
+ * is handed any connection so the server config, the ICAT connection and
+ * the rule base are already loaded when a client arrives.
+ */
+
+int
+initPoolAgent (rsComm_t *rsComm)
+{
+    int status;
+
+    initProcLog ();
+
+    status = initServerInfo (rsComm);
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "initPoolAgent: initServerInfo error, status = %d",
+          status);
+        return (status);
+    }
+    ServerInfoState = INITIAL_DONE;
+
+#ifdef RULE_ENGINE_N
+    status = initRuleEngine(RULE_ENGINE_TRY_CACHE, rsComm, reRuleStr, 
+      reFuncMapStr, reVariableMapStr);
+#else
+    status = initRuleEngine(rsComm, reRuleStr, reFuncMapStr, reVariableMapStr);
+#endif
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "initPoolAgent: initRuleEngine error, status = %d", status);
+    }
+    return (status);
+}
+
 void
 cleanupAndExit (int status)
 {
@@ -1928,6 +1989,13 @@ initRsCommWithStartupPack (rsComm_t *rsComm, startupPack_t *startupPack)
 #endif
         
     }
+    /* the client may ask for the pipelined request mode. Strip it from 
+     * the option since the option is logged as the program name */
+    if ((tmpStr = strstr (rsComm->option, REQ_PIPELINE_OPT)) != NULL) {
+	*tmpStr = '\0';
+	if (rsComm->reconnFlag != RECONN_TIMEOUT) rsComm->reqPipeline = 1;
+    }
+
     if (rsComm->sock != 0) { /* added by RAJA Nov 16 2010 to remove error 
                               * messages from xmsLog */
         setLocalAddr (rsComm->sock, &rsComm->localAddr);
@@ -2463,6 +2531,13 @@ initProcLog ()
     return 0;
 }
 
+/* the descriptor high water marks are on a fixed width line following
+ * the one written by logAgentProc, so logAgentDescHwm can update them in
+ * place */
+static long ProcLogHwmOffset = -1;
+static int LoggedL1descHwm = 0;
+static int LoggedFileDescHwm = 0;
+
 int
 logAgentProc (rsComm_t *rsComm)
 {
@@ -2516,12 +2591,49 @@ logAgentProc (rsComm_t *rsComm)
       rsComm->proxyUser.userName, clientZone,
       rsComm->clientUser.userName, proxyZone,
       progName, remoteAddr, (unsigned int) time (0));
+    ProcLogHwmOffset = ftell (fptr);
+    LoggedL1descHwm = getL1descHwm ();
+    LoggedFileDescHwm = getFileDescHwm ();
+    fprintf (fptr, "%10d %10d\n", LoggedL1descHwm, LoggedFileDescHwm);
 
     rsComm->procLogFlag = PROC_LOG_DONE;
     fclose (fptr);
     return 0;
 }
 
+/* logAgentDescHwm - rewrite the L1desc and FileDesc high water marks in
+ * the proc log file of this agent if they went up since last logged */
+
+int
+logAgentDescHwm ()
+{
+    FILE *fptr;
+    char procPath[MAX_NAME_LEN];
+
+    if (ProcLogHwmOffset < 0 || (getL1descHwm () == LoggedL1descHwm &&
+      getFileDescHwm () == LoggedFileDescHwm)) {
+        return 0;
+    }
+
+    snprintf (procPath, MAX_NAME_LEN, "%s/%-d", ProcLogDir, getpid ());
+
+    fptr = fopen (procPath, "r+");
+
+    if (fptr == NULL) {
+        rodsLog (LOG_ERROR,
+          "logAgentDescHwm: Cannot open input file %s. ernro = %d",
+          procPath, errno);
+        return (UNIX_FILE_OPEN_ERR - errno);
+    }
+
+    LoggedL1descHwm = getL1descHwm ();
+    LoggedFileDescHwm = getFileDescHwm ();
+    fseek (fptr, ProcLogHwmOffset, SEEK_SET);
+    fprintf (fptr, "%10d %10d\n", LoggedL1descHwm, LoggedFileDescHwm);
+    fclose (fptr);
+    return 0;
+}
+
 int
 rmProcLog (int pid)
 {
@@ -2529,6 +2641,9 @@ rmProcLog (int pid)
 
     snprintf (procPath, MAX_NAME_LEN, "%s/%-d", ProcLogDir, pid);
     unlink (procPath);
+    if (pid == getpid ()) {
+        ProcLogHwmOffset = -1;
+    }
     return 0;
 }
 
@@ -2561,6 +2676,11 @@ readProcLog (int pid, procLog_t *procLog)
 
     if (status == 7) {	/* 7 parameters */
 	status = 0;
+	/* the descriptor high water marks, not there in older proc logs */
+	if (fscanf (fptr, "%d %d", &procLog->l1descHwm, 
+	  &procLog->l3descHwm) != 2) {
+	    procLog->l1descHwm = procLog->l3descHwm = 0;
+	}
     } else {
         rodsLog (LOG_ERROR,
           "readProcLog: error fscanf file %s. Number of param read = %d",
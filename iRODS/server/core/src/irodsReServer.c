@@ -7,6 +7,11 @@
  *-------------------------------------------------------------------------
  */
 
+#ifndef windows_platform
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#endif
 #include "irodsReServer.h"
 #include "reServerLib.h"
 #include "rsApiHandler.h"
@@ -19,6 +24,10 @@ extern int msiAdmClearAppRuleStruct(ruleExecInfo_t *rei);
 
 int usage (char *prog);
 
+static int ReWakeupFd = -1;	/* read end of the wakeup fifo */
+static int ReDummyFd = -1;	/* write end kept open */
+static int ReWorkerMaxJobs = DEF_RE_WORKER_MAX_JOBS;
+
 int
 main(int argc, char **argv)
 {
@@ -112,6 +121,11 @@ main(int argc, char **argv)
         }
     }
 
+    if ((tmpStr = getenv (RE_WORKER_MAX_JOBS_KW)) != NULL &&
+      atoi (tmpStr) > 0) {
+        ReWorkerMaxJobs = atoi (tmpStr);
+    }
+
     status = initRsComm (&rsComm);
 
     if (status < 0) {
@@ -158,18 +172,37 @@ int usage (char *prog)
     return 0;
 }
 
+/* reServerMain - the delayed rules are kept in an in memory queue
+ * ordered by exeTime (reQueue). The queue is loaded in full at start and
+ * every resyncTime sec. In between, only the newly submitted jobs are
+ * loaded, when rsRuleExecSubmit writes to the wakeup fifo (or every
+ * RE_SERVER_SLEEP_TIME sec without it). The due jobs are handed to a pool
+ * of reExec.maxRunCnt worker processes which keep their catalog
+ * connection from job to job.
+ */
+
 void
 reServerMain (rsComm_t *rsComm, char* logDir)
 {
     int status = 0;
-    genQueryOut_t *genQueryOut = NULL;
-    time_t endTime;
-    int runCnt;
-    reExec_t reExec;
-    int repeatedQueryErrorCount=0;
-   
+    static reExec_t reExec;
+    reQueue_t reQueue;
+    reQueueEntry_t reQueueEntry;
+    time_t now, endTime;
+    int thrInx, waitTime;
+
     initReExec (rsComm, &reExec);
+    initReQueue (&reQueue);
     LastRescUpdateTime = time (NULL);
+    if (openReWakeup (&ReWakeupFd, &ReDummyFd) < 0) {
+        rodsLog (LOG_NOTICE,
+          "reServerMain: no wakeup fifo. Polling every %d sec",
+          RE_SERVER_SLEEP_TIME);
+    }
+    rodsLog (LOG_NOTICE,
+      "reServerMain: %d workers, full reload every %d sec",
+      reExec.maxRunCnt, reQueue.resyncTime);
+
     while (1) {
 #ifndef windows_platform
 #ifndef IRODS_SYSLOG
@@ -177,68 +210,429 @@ reServerMain (rsComm_t *rsComm, char* logDir)
 #endif
 #endif
 	chkAndResetRule (rsComm);
-        rodsLog (LOG_NOTICE,
-          "reServerMain: checking the queue for jobs");
-        status = getReInfo (rsComm, &genQueryOut);
-        if (status < 0) {
-            if (status != CAT_NO_ROWS_FOUND) {
-                rodsLog (LOG_ERROR,
-                  "reServerMain: getReInfo error. status = %d", status);
-#ifdef ORA_ICAT
-                /* For Oracle, since we don't disconnect (to avoid a
-                   memory leak in the OCI library), we do want to
-                   disconnect when there are repeated errors so we can
-                   reconnect and possibly recover from an Oracle
-                   outage. */
-                if (repeatedQueryErrorCount>3) {
-                   disconnectRcat (rsComm);
-                   repeatedQueryErrorCount=0;
-                }
-#endif
-            }
-            else {
-               repeatedQueryErrorCount++;
-            }
-            reSvrSleep (rsComm);
-            continue;
-        }
-        else {
-           repeatedQueryErrorCount=0;
-        }
+	chkAndUpdateResc (rsComm);
+	reapReWorkers (rsComm, &reExec, &reQueue);
+
+	now = time (NULL);
+	if (now >= reQueue.nextResync) {
+	    status = loadReQueue (rsComm, &reQueue, &reExec, 1);
+	} else if (now >= reQueue.lastLoad + RE_SERVER_SLEEP_TIME) {
+	    /* in case a wakeup was missed */
+	    status = loadReQueue (rsComm, &reQueue, &reExec, 0);
+	}
+	if (status < 0) {
+	    /* the catalog connection may be bad */
+	    reSvrReconnRcat (rsComm);
+	    reQueue.nextResync = now + RE_SERVER_SLEEP_TIME;
+	    reQueue.lastLoad = now;
+	    status = 0;
+	}
+
+	/* start the due jobs */
+	endTime = now + RE_SERVER_EXEC_TIME;
+	while (reQueue.numEntries > 0 && 
+	  reQueue.entries[0].exeTime <= time (NULL) &&
+	  time (NULL) <= endTime &&
+	  (thrInx = allocReThr (rsComm, &reExec)) >= 0) {
+	    popReQueue (&reQueue, &reQueueEntry);
+	    dispatchReJob (rsComm, &reExec, &reQueue, thrInx, &reQueueEntry);
+	}
 
-        endTime = time (NULL) + RE_SERVER_EXEC_TIME;
-	runCnt = runQueuedRuleExec (rsComm, &reExec, &genQueryOut, endTime, 0);
-	if (runCnt > 0 || 
-	  (genQueryOut != NULL && genQueryOut->continueInx > 0)) {
-	    /* need to refresh */
-	    svrCloseQueryOut (rsComm, genQueryOut);
-            freeGenQueryOut (&genQueryOut);
-            status = getReInfo (rsComm, &genQueryOut);
-            if (status < 0) {
-		reSvrSleep (rsComm);
-                continue;
+	now = time (NULL);
+	if (now >= reQueue.lastStats + RE_STATS_INTERVAL)
+	    writeReStats (&reQueue, &reExec);
+
+	/* wait for a new job, a done job or the next due job */
+	waitTime = RE_SERVER_SLEEP_TIME;
+	if (reQueue.numEntries > 0 && reExec.runCnt < reExec.maxRunCnt) {
+	    if (reQueue.entries[0].exeTime <= now) {
+		waitTime = 0;
+	    } else if (reQueue.entries[0].exeTime - now < waitTime) {
+		waitTime = reQueue.entries[0].exeTime - now;
 	    }
-        }
+	}
+	if (waitReEvent (rsComm, &reExec, &reQueue, waitTime) > 0) {
+	    /* woken up by rsRuleExecSubmit */
+	    status = loadReQueue (rsComm, &reQueue, &reExec, 0);
+	}
+    }
+}
 
-	/* run the failed job */
+/* waitReEvent - wait up to waitTime sec for the wakeup fifo or the
+ * workers. The results of the workers are processed here. Returns 1 if
+ * woken up through the fifo, 0 otherwise */
 
-	runCnt = 
-	  runQueuedRuleExec (rsComm, &reExec, &genQueryOut, endTime, 
-	  RE_FAILED_STATUS);
-	svrCloseQueryOut (rsComm, genQueryOut);
-        freeGenQueryOut (&genQueryOut);
-	if (runCnt > 0 ||
-	  (genQueryOut != NULL && genQueryOut->continueInx > 0)) {
+int
+waitReEvent (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int waitTime)
+{
+#ifndef windows_platform
+    fd_set readFds;
+    struct timeval tv;
+    int i, nSockets, status;
+    int maxFd = -1;
+    int wakeFlag = 0;
+    reExecProc_t *reExecProc;
+
+    FD_ZERO (&readFds);
+    if (ReWakeupFd >= 0) {
+	FD_SET (ReWakeupFd, &readFds);
+	maxFd = ReWakeupFd;
+    }
+    for (i = 0; i < reExec->maxRunCnt; i++) {
+	if (reExec->reExecProc[i].jobFd >= 0) {
+	    FD_SET (reExec->reExecProc[i].jobFd, &readFds);
+	    if (reExec->reExecProc[i].jobFd > maxFd)
+		maxFd = reExec->reExecProc[i].jobFd;
+	}
+    }
+#ifdef RE_EXEC_PROC
+    /* the jobs are processes of their own. Poll for them to exit */
+    if (reExec->doFork == 1 && reExec->runCnt > 0 && waitTime > 1)
+	waitTime = 1;
+#endif
+    tv.tv_sec = waitTime;
+    tv.tv_usec = 0;
+
+    nSockets = select (maxFd + 1, &readFds, NULL, NULL, &tv);
+    if (nSockets <= 0) return 0;
+
+    if (ReWakeupFd >= 0 && FD_ISSET (ReWakeupFd, &readFds)) {
+	drainReWakeup (ReWakeupFd);
+	wakeFlag = 1;
+    }
+    for (i = 0; i < reExec->maxRunCnt; i++) {
+	reExecProc = &reExec->reExecProc[i];
+	if (reExecProc->jobFd < 0 || !FD_ISSET (reExecProc->jobFd, &readFds))
+	    continue;
+	if (readReWorkerMsg (reExecProc->jobFd, &status, sizeof (status)) !=
+	  sizeof (status)) {
+	    /* the worker is gone */
+	    int waitStatus = 0;
+	    if (reExecProc->pid > 0) waitpid (reExecProc->pid, &waitStatus, 0);
+	    endReWorker (rsComm, reExec, reQueue, i, waitStatus);
 	    continue;
-	} else {
-	    /* nothing got run */
-	    reSvrSleep (rsComm);
 	}
+	if (reExecProc->procExecState == RE_PROC_RUNNING) {
+	    reExecProc->jobCnt++;
+	    finishReJob (rsComm, reExec, reQueue, i, status);
+	}
+	if (reExecProc->jobCnt >= ReWorkerMaxJobs) {
+	    /* recycle it. Closing the socket makes it exit */
+	    close (reExecProc->jobFd);
+	    reExecProc->jobFd = -1;
+	    if (reExecProc->pid > 0) waitpid (reExecProc->pid, NULL, 0);
+	    reExecProc->pid = 0;
+	}
+    }
+    return (wakeFlag);
+#else
+    rodsSleep (waitTime, 0);
+    return 0;
+#endif
+}
+
+/* dispatchReJob - run the job reQueueEntry with the reExec slot thrInx */
+
+int
+dispatchReJob (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int thrInx, reQueueEntry_t *reQueueEntry)
+{
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+    char ruleExecId[NAME_LEN];
+    int lag, status;
+
+    snprintf (ruleExecId, NAME_LEN, "%lld", reQueueEntry->ruleExecId);
+    if (reExec->doFork == 1 &&
+      matchRuleExecId (reExec, ruleExecId, RE_PROC_RUNNING)) {
+	/* already running. It will be requeued when done */
+	freeReThr (reExec, thrInx);
+	return 0;
+    }
+
+    /* mark running */
+    status = regExeStatus (rsComm, ruleExecId, RE_RUNNING);
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "dispatchReJob: regExeStatus of id %s failed,stat = %d",
+          ruleExecId, status);
+	freeReThr (reExec, thrInx);
+	return status;
+    }
+
+    rstrcpy (reExecProc->ruleExecSubmitInp.ruleExecId, ruleExecId, NAME_LEN);
+    reExecProc->jobType = reQueueEntry->jobType;
+    reExecProc->startTime = time (NULL);
+    lag = reExecProc->startTime - reQueueEntry->exeTime;
+    if (lag < 0) lag = 0;
+    reQueue->totalLag += lag;
+    reQueue->lagCnt++;
+    if (lag > reQueue->maxLag) reQueue->maxLag = lag;
+
+    if (reExec->doFork == 0) {
+	/* single proc. Just run it */
+	status = reServerSingleExec (rsComm, ruleExecId, reExecProc->jobType);
+	return (finishReJob (rsComm, reExec, reQueue, thrInx, status));
+    }
+
+#ifdef RE_EXEC_PROC
+    if ((reExecProc->pid = fork ()) == 0) {
+        /* child. need to disconnect Rcat */
+        if (resetRcatHost (rsComm, MASTER_RCAT, rsComm->myEnv.rodsZone) == 
+	  LOCAL_HOST) {
+#ifdef RODS_CAT
+            resetRcat (rsComm);
+#endif
+        }
+	/* this call doesn't come back */
+	execRuleExec (reExecProc);
+	exit (1);
+    } else if (reExecProc->pid < 0) {
+	status = SYS_FORK_ERROR - errno;
+    }
+#else
+    if (reExecProc->jobFd < 0) {
+	status = startReWorker (rsComm, reExec, thrInx);
+    }
+    if (status >= 0) {
+	reJobMsg_t reJobMsg;
+
+	bzero (&reJobMsg, sizeof (reJobMsg));
+	rstrcpy (reJobMsg.ruleExecId, ruleExecId, NAME_LEN);
+	reJobMsg.jobType = reExecProc->jobType;
+	if (writeReWorkerMsg (reExecProc->jobFd, &reJobMsg, 
+	  sizeof (reJobMsg)) != sizeof (reJobMsg)) {
+	    status = SYS_PIPE_ERROR - errno;
+	    close (reExecProc->jobFd);
+	    reExecProc->jobFd = -1;
+	    if (reExecProc->pid > 0) waitpid (reExecProc->pid, NULL, 0);
+	    reExecProc->pid = 0;
+	}
+    }
+#endif
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "dispatchReJob: unable to start job %s, status = %d",
+          ruleExecId, status);
+	/* try again later */
+	pushReQueue (reQueue, reQueueEntry->ruleExecId,
+	  time (NULL) + RE_FAILED_RETRY_TIME, reQueueEntry->jobType);
+	freeReThr (reExec, thrInx);
+	return status;
+    }
+#ifdef RE_SERVER_DEBUG
+    rodsLog (LOG_NOTICE,
+      "dispatchReJob: started job %s, thrInx %d, pid %d",
+      ruleExecId, thrInx, reExecProc->pid); 
+#endif
+    return 0;
+}
+
+/* finishReJob - the job of thrInx is done with status. Requeue it if it
+ * is still in the catalog and free the slot */
+
+int
+finishReJob (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int thrInx, int status)
+{
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+
+    reQueue->jobsRun++;
+    if (status < 0) reQueue->jobsFailed++;
+    requeueRuleExec (rsComm, reQueue, reExecProc->ruleExecSubmitInp.ruleExecId);
+    freeReThr (reExec, thrInx);
+
+    return 0;
+}
+
+/* endReWorker - the process of thrInx has exited with waitStatus. If it
+ * had a job, check whether the job got cleaned up */
+
+int
+endReWorker (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue,
+int thrInx, int waitStatus)
+{
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+    int status = 0;
+
+    if (reExecProc->jobFd >= 0) {
+	close (reExecProc->jobFd);
+	reExecProc->jobFd = -1;
+    }
+    reExecProc->pid = 0;
+    if (reExecProc->procExecState != RE_PROC_RUNNING) return 0;
+
+#ifdef RE_EXEC_PROC
+    /* the job was a process of its own */
+    if (!WIFEXITED (waitStatus) || WEXITSTATUS (waitStatus) != 0)
+	status = SYS_FORK_ERROR;
+#else
+    /* a worker only exits in the middle of a job if it crashed */
+    rodsLog (LOG_ERROR,
+      "endReWorker: worker %d died while running job %s",
+      thrInx, reExecProc->ruleExecSubmitInp.ruleExecId);
+    status = SYS_FORK_ERROR;
+#endif
+    postProcReThr (rsComm, reExec, thrInx);
+    return (finishReJob (rsComm, reExec, reQueue, thrInx, status));
+}
+
+/* reapReWorkers - collect the worker processes that have exited */
+
+int
+reapReWorkers (rsComm_t *rsComm, reExec_t *reExec, reQueue_t *reQueue)
+{
+#ifndef windows_platform
+    pid_t childPid;
+    int waitStatus;
+    int thrInx;
+    int reapCnt = 0;
+
+    while ((childPid = waitpid (-1, &waitStatus, WNOHANG)) > 0) {
+	thrInx = matchPidInReExec (reExec, childPid);
+	if (thrInx < 0) continue;
+	endReWorker (rsComm, reExec, reQueue, thrInx, waitStatus);
+	reapCnt++;
+    }
+    return (reapCnt);
+#else
+    return 0;
+#endif
+}
+
+/* startReWorker - fork a worker process for the slot thrInx */
+
+int
+startReWorker (rsComm_t *rsComm, reExec_t *reExec, int thrInx)
+{
+#ifndef windows_platform
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+    int sv[2];
+    int i, status;
+    pid_t pid;
+
+    if (socketpair (AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+	status = SYS_PIPE_ERROR - errno;
+        rodsLog (LOG_ERROR,
+          "startReWorker: socketpair error, status = %d", status);
+	return (status);
+    }
+
+    if ((pid = fork ()) == 0) {
+	/* child */
+	close (sv[0]);
+	if (ReWakeupFd >= 0) close (ReWakeupFd);
+	if (ReDummyFd >= 0) close (ReDummyFd);
+	for (i = 0; i < reExec->maxRunCnt; i++) {
+	    if (reExec->reExecProc[i].jobFd >= 0)
+		close (reExec->reExecProc[i].jobFd);
+	}
+	status = reWorkerMain (rsComm, sv[1]);
+	exit (status >= 0 ? 0 : 1);
+    } else if (pid < 0) {
+	status = SYS_FORK_ERROR - errno;
+        rodsLog (LOG_ERROR,
+          "startReWorker: fork error, status = %d", status);
+	close (sv[0]);
+	close (sv[1]);
+	return (status);
     }
+
+    close (sv[1]);
+    reExecProc->jobFd = sv[0];
+    reExecProc->pid = pid;
+    reExecProc->jobCnt = 0;
+#ifdef RE_SERVER_DEBUG
+    rodsLog (LOG_NOTICE,
+      "startReWorker: started worker %d, pid %d", thrInx, pid);
+#endif
+    return (0);
+#else
+    return (SYS_NOT_SUPPORTED);
+#endif
 }
 
+/* reWorkerMain - the main loop of a worker. It gets its own catalog
+ * connection and then runs the jobs sent by reServerMain through jobFd
+ * until it is closed */
+
 int
-reSvrSleep (rsComm_t *rsComm)
+reWorkerMain (rsComm_t *rsComm, int jobFd)
+{
+    rodsServerHost_t *rodsServerHost = NULL;
+    reJobMsg_t reJobMsg;
+    int status;
+
+    /* the catalog connection of the parent can't be shared */
+    if (resetRcatHost (rsComm, MASTER_RCAT, rsComm->myEnv.rodsZone) == 
+      LOCAL_HOST) {
+#ifdef RODS_CAT
+        resetRcat (rsComm);
+#endif
+    }
+    if ((status = getAndConnRcatHost (rsComm, MASTER_RCAT,
+     rsComm->myEnv.rodsZone, &rodsServerHost)) == LOCAL_HOST) {
+#ifdef RODS_CAT
+        status = connectRcat (rsComm);
+        if (status < 0) {
+            rodsLog (LOG_ERROR,
+              "reWorkerMain: connectRcat error. status=%d", status);
+	    return (status);
+        }
+#endif
+    }
+
+    while (readReWorkerMsg (jobFd, &reJobMsg, sizeof (reJobMsg)) == 
+      sizeof (reJobMsg)) {
+	chkAndResetRule (rsComm);
+	chkAndUpdateResc (rsComm);
+	status = reServerSingleExec (rsComm, reJobMsg.ruleExecId, 
+	  reJobMsg.jobType);
+	if (writeReWorkerMsg (jobFd, &status, sizeof (status)) != 
+	  sizeof (status)) break;
+    }
+#ifdef RE_SERVER_DEBUG
+    rodsLog (LOG_NOTICE, "reWorkerMain: process %d exiting", getpid ());
+#endif
+    return (0);
+}
+
+int
+readReWorkerMsg (int fd, void *buf, int len)
+{
+    int nbytes, toRead = len;
+    char *bufPtr = (char *) buf;
+
+    while (toRead > 0) {
+	nbytes = read (fd, bufPtr, toRead);
+	if (nbytes < 0 && errno == EINTR) continue;
+	if (nbytes <= 0) break;
+	toRead -= nbytes;
+	bufPtr += nbytes;
+    }
+    return (len - toRead);
+}
+
+int
+writeReWorkerMsg (int fd, void *buf, int len)
+{
+    int nbytes, toWrite = len;
+    char *bufPtr = (char *) buf;
+
+    while (toWrite > 0) {
+	nbytes = write (fd, bufPtr, toWrite);
+	if (nbytes < 0 && errno == EINTR) continue;
+	if (nbytes <= 0) break;
+	toWrite -= nbytes;
+	bufPtr += nbytes;
+    }
+    return (len - toWrite);
+}
+
+/* reSvrReconnRcat - drop and redo the catalog connection after an error */
+
+int
+reSvrReconnRcat (rsComm_t *rsComm)
 {
     int status;
     rodsServerHost_t *rodsServerHost = NULL;
@@ -246,18 +640,13 @@ reSvrSleep (rsComm_t *rsComm)
     if ((status = disconnRcatHost (rsComm, MASTER_RCAT, 
       rsComm->myEnv.rodsZone)) == LOCAL_HOST) {
 #ifdef RODS_CAT
-#ifndef ORA_ICAT
-       /* For Oracle, we don't disconnect.  This is to avoid a 
-          memory leak in the OCI library */
-        disconnectRcat (rsComm);
+        status = disconnectRcat (rsComm);
         if (status < 0) {
             rodsLog (LOG_ERROR,
-              "reSvrSleep: disconnectRcat error. status = %d", status);
+              "reSvrReconnRcat: disconnectRcat error. status = %d", status);
         }
-#endif
 #endif
     }
-    rodsSleep (RE_SERVER_SLEEP_TIME, 0);
 
     if ((status = getAndConnRcatHost (rsComm, MASTER_RCAT, 
       rsComm->myEnv.rodsZone, &rodsServerHost)) == LOCAL_HOST) {
@@ -265,7 +654,7 @@ reSvrSleep (rsComm_t *rsComm)
         status = connectRcat (rsComm);
         if (status < 0) {
             rodsLog (LOG_ERROR,
-              "reSvrSleep: connectRcat error. status = %d", status);
+              "reSvrReconnRcat: connectRcat error. status = %d", status);
 	}
 #endif
     }
@@ -7,6 +7,8 @@
 
 #ifndef windows_platform
 #include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 
@@ -19,6 +21,8 @@
 #include "dataObjRead.h"
 #include "rcPortalOpr.h"
 #include "initServer.h"
+#include "xferHist.h"
+#include "md5Checksum.h"
 #ifdef PARA_OPR
 #ifdef USE_BOOST
 #include <boost/thread/thread.hpp>
@@ -115,6 +119,9 @@ int oprType, portalOprOut_t **portalOprOut)
     portalOprOut_t *myDataObjPutOut;
     int portalSock;
     int proto;
+    int adaptiveFlag = 0;
+    int windowSize = 0;
+    int rttUsec = -1;
 
 #ifdef RBUDP_TRANSFER
     if (getValByKey (&dataOprInp->condInput, RBUDP_TRANSFER_KW) != NULL) {
@@ -140,6 +147,16 @@ int oprType, portalOprOut_t **portalOprOut)
            dataOprInp->dataSize, dataOprInp->numThreads,
            &dataOprInp->condInput, 
            getValByKey (&dataOprInp->condInput, RESC_NAME_KW), NULL);
+        /* let the transfer history of the client host pick the number
+         * of threads and the window unless the client asked for them */
+        if (myDataObjPutOut->numThreads > 0 && dataOprInp->numThreads == 0 &&
+          getValByKey (&dataOprInp->condInput, NO_PARA_OP_KW) == NULL &&
+          getAdaptiveXferMaxThr () > 0) {
+            myDataObjPutOut->numThreads = chooseAdaptiveXfer (rsComm,
+              dataOprInp->dataSize, myDataObjPutOut->numThreads,
+              &windowSize, &rttUsec);
+            adaptiveFlag = 1;
+        }
     }
 
     if (myDataObjPutOut->numThreads == 0) {
@@ -157,9 +174,16 @@ int oprType, portalOprOut_t **portalOprOut)
               myDataObjPutOut->status = portalSock;
               return portalSock;
         }
+        if (adaptiveFlag > 0 && windowSize > 0) {
+            /* the client sets the window of its end from the portList */
+            myDataObjPutOut->portList.windowSize = windowSize;
+        }
         myPortalOpr = rsComm->portalOpr =
           (portalOpr_t *) malloc (sizeof (portalOpr_t));
         myPortalOpr->oprType = oprType;
+        myPortalOpr->adaptiveFlag = adaptiveFlag;
+        myPortalOpr->rttUsec = rttUsec;
+        myPortalOpr->inlineChksum = NULL;
         myPortalOpr->portList = myDataObjPutOut->portList;
         myPortalOpr->dataOprInp = *dataOprInp;
         memset (&dataOprInp->condInput, 0, sizeof (dataOprInp->condInput));
@@ -273,7 +297,7 @@ acceptSrvPortal (rsComm_t *rsComm, portList_t *thisPortList)
           errno);
         return SYS_SOCK_ACCEPT_ERR - errno;
     } else {
-	rodsSetSockOpt (myFd, rsComm->windowSize);
+	rodsSetSockOpt (myFd, thisPortList->windowSize);
     }
 #ifdef _WIN32
     nbytes = recv (myFd,&myCookie,sizeof(myCookie),0);
@@ -353,6 +377,8 @@ svrPortalPutGet (rsComm_t *rsComm)
     int oprType;
     int flags = 0;
     int retVal = 0;
+    struct timeval startTime, endTime;
+    rodsLong_t bytesTransferred = 0;
     
     myPortalOpr = rsComm->portalOpr;
 
@@ -414,12 +440,14 @@ svrPortalPutGet (rsComm_t *rsComm)
 
         return (portalFd);
     }
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
     applyRuleForSvrPortal(portalFd, oprType, 0, size0, rsComm);
 
     if (oprType == PUT_OPR) {
         fillPortalTransferInp (&myInput[0], rsComm,
          portalFd, dataOprInp->destL3descInx, 0, dataOprInp->destRescTypeInx,
           0, size0, offset0, flags);
+        myInput[0].inlineChksum = myPortalOpr->inlineChksum;
     } else {
         fillPortalTransferInp (&myInput[0], rsComm,
          dataOprInp->srcL3descInx, portalFd, dataOprInp->srcRescTypeInx, 0,
@@ -433,6 +461,14 @@ svrPortalPutGet (rsComm_t *rsComm)
             partialDataGet (&myInput[0]);
 	}
         CLOSE_SOCK (lsock);
+        if (myPortalOpr->adaptiveFlag > 0 && myInput[0].status >= 0) {
+            (void) gettimeofday (&endTime, (struct timezone *) 0);
+            recordAdaptiveXfer (rsComm, 1, thisPortList->windowSize,
+              myPortalOpr->rttUsec,
+              myInput[0].zeroCopyBytes + myInput[0].bufferedBytes,
+              (endTime.tv_sec - startTime.tv_sec) +
+              (endTime.tv_usec - startTime.tv_usec) / 1000000.0);
+        }
 
 	return (myInput[0].status);
     } else {
@@ -468,6 +504,7 @@ svrPortalPutGet (rsComm_t *rsComm)
     	        fillPortalTransferInp (&myInput[i], rsComm,
 		 portalFd, l3descInx, 0, dataOprInp->destRescTypeInx,
 	          i, mySize, myOffset, flags);
+		myInput[i].inlineChksum = myPortalOpr->inlineChksum;
 		#ifdef USE_BOOST
 		tid[i] = new boost::thread( partialDataPut, &myInput[i] );
 		#else
@@ -518,9 +555,18 @@ svrPortalPutGet (rsComm_t *rsComm)
             if (myInput[i].status < 0) {
                 retVal = myInput[i].status;
             }
+            bytesTransferred += myInput[i].zeroCopyBytes +
+              myInput[i].bufferedBytes;
         }
 
         CLOSE_SOCK (lsock);
+        if (myPortalOpr->adaptiveFlag > 0 && retVal >= 0) {
+            (void) gettimeofday (&endTime, (struct timezone *) 0);
+            recordAdaptiveXfer (rsComm, numThreads, thisPortList->windowSize,
+              myPortalOpr->rttUsec, bytesTransferred,
+              (endTime.tv_sec - startTime.tv_sec) +
+              (endTime.tv_usec - startTime.tv_usec) / 1000000.0);
+        }
 	return (retVal);
 
 #else	/* PARA_OPR */
@@ -553,12 +599,35 @@ int threadNum, rodsLong_t size, rodsLong_t offset, int flags)
 }
 
 
+/* getZeroCopyFd - return the local file descriptor of the L3 descriptor
+ * l3descInx if the portal workers can sendfile/splice to it directly,
+ * i.e. a unix file system resource on this host. Otherwise returns -1
+ * and the data go through _l3Read/_l3Write.
+ */
+int
+getZeroCopyFd (int rescTypeInx, int l3descInx)
+{
+    if (zeroCopyEnabled () == 0)
+        return (-1);
+    if (RescTypeDef[rescTypeInx].rescCat != FILE_CAT)
+        return (-1);
+    if (l3descInx < 3 || l3descInx >= NUM_FILE_DESC ||
+      FileDesc[l3descInx].inuseFlag == 0)
+        return (-1);
+    if (FileDesc[l3descInx].fileType != UNIX_FILE_TYPE ||
+      FileDesc[l3descInx].rodsServerHost == NULL ||
+      FileDesc[l3descInx].rodsServerHost->localFlag != LOCAL_HOST)
+        return (-1);
+    return (FileDesc[l3descInx].fd);
+}
+
 void
 partialDataPut (portalTransferInp_t *myInput)
 {
     int destL3descInx, srcFd, destRescTypeInx;
     char *buf;
     int bytesWritten;
+    int zeroCopyFd;
     rodsLong_t bytesToGet;
     rodsLong_t myOffset = 0;
 
@@ -592,7 +661,14 @@ partialDataPut (portalTransferInp_t *myInput)
             return;
         }
     }
-    buf = (char*)malloc (TRANS_BUF_SZ);
+    /* the buffer is only needed if splice can't be used. The data must
+     * pass through it to be chksummed */
+    buf = NULL;
+    if (myInput->inlineChksum != NULL) {
+        zeroCopyFd = -1;
+    } else {
+        zeroCopyFd = getZeroCopyFd (destRescTypeInx, destL3descInx);
+    }
 
 #ifdef PARA_TIMING
     afterSeek=time(0);
@@ -626,7 +702,7 @@ partialDataPut (portalTransferInp_t *myInput)
 	    if (myInput->threadNum > 0)
                 _l3Close (myInput->rsComm, destRescTypeInx, destL3descInx);
             CLOSE_SOCK (srcFd);
-	    free (buf);
+	    if (buf != NULL) free (buf);
 	    return;
 	} 
 
@@ -638,6 +714,35 @@ partialDataPut (portalTransferInp_t *myInput)
 	    } else {
 		toread1 = toread0;
 	    }
+	    if (zeroCopyFd >= 0) {
+		bytesWritten = mySpliceToFile (srcFd, zeroCopyFd, toread1, 
+		  NULL);
+		if (bytesWritten == SYS_NOT_SUPPORTED) {
+		    /* fall back to myRead/_l3Write for the rest */
+		    zeroCopyFd = -1;
+		    continue;
+		}
+		if (bytesWritten != toread1) {
+		    rodsLog (LOG_NOTICE,
+                     "_partialDataPut: toread %d bytes, %d bytes spliced",
+                      toread1, bytesWritten);
+                    if (bytesWritten < 0) {
+                        myInput->status = bytesWritten;
+                    } else {
+                        myInput->status = SYS_COPY_LEN_ERR;
+                    }
+                    break;
+		}
+		FileDesc[destL3descInx].writtenFlag = 1;
+		myInput->zeroCopyBytes += bytesWritten;
+                bytesToGet -= bytesWritten;
+		toread0 -= bytesWritten;
+                myOffset += bytesWritten;
+		continue;
+	    }
+	    if (buf == NULL) {
+		buf = (char*)malloc (TRANS_BUF_SZ);
+	    }
             bytesRead = myRead (srcFd, buf, toread1, SOCK_TYPE, NULL, NULL);
 
 #ifdef PARA_TIMING
@@ -657,6 +762,9 @@ partialDataPut (portalTransferInp_t *myInput)
                     }
                     break;
                 }
+                updateInlineChksum (myInput->inlineChksum, myOffset,
+                  (unsigned char *) buf, bytesWritten);
+                myInput->bufferedBytes += bytesWritten;
                 bytesToGet -= bytesWritten;
 		toread0 -= bytesWritten;
                 myOffset += bytesWritten;
@@ -684,7 +792,12 @@ partialDataPut (portalTransferInp_t *myInput)
 #ifdef PARA_TIMING
     afterTransfer=time(0);
 #endif
-    free (buf);
+    if (buf != NULL) free (buf);
+    if (myInput->zeroCopyBytes > 0) {
+        rodsLog (LOG_DEBUG,
+          "partialDataPut: thread %d zeroCopy %lld buffered %lld bytes",
+          myInput->threadNum, myInput->zeroCopyBytes, myInput->bufferedBytes);
+    }
     applyRuleForSvrPortal(srcFd, PUT_OPR, 1, myOffset - myInput->offset, myInput->rsComm);
     sendTranHeader (srcFd, DONE_OPR, 0, 0, 0);
     if (myInput->threadNum > 0)
@@ -707,6 +820,7 @@ partialDataGet (portalTransferInp_t *myInput)
     int srcL3descInx, destFd, srcRescTypeInx;
     char *buf;
     int bytesWritten;
+    int zeroCopyFd;
     rodsLong_t bytesToGet;
     rodsLong_t myOffset = 0;
 
@@ -740,7 +854,9 @@ partialDataGet (portalTransferInp_t *myInput)
             return;
         }
     }
-    buf = (char*)malloc (TRANS_BUF_SZ);
+    /* the buffer is only needed if sendfile can't be used */
+    buf = NULL;
+    zeroCopyFd = getZeroCopyFd (srcRescTypeInx, srcL3descInx);
 
 #ifdef PARA_TIMING
     afterSeek=time(0);
@@ -774,7 +890,7 @@ partialDataGet (portalTransferInp_t *myInput)
             if (myInput->threadNum > 0)
                 _l3Close (myInput->rsComm, srcRescTypeInx, srcL3descInx);
             CLOSE_SOCK (destFd);
-            free (buf);
+            if (buf != NULL) free (buf);
             return;
         }
 
@@ -786,6 +902,33 @@ partialDataGet (portalTransferInp_t *myInput)
             } else {
                 toread1 = toread0;
             }
+            if (zeroCopyFd >= 0) {
+                bytesWritten = mySendfile (destFd, zeroCopyFd, toread1, NULL);
+                if (bytesWritten == SYS_NOT_SUPPORTED) {
+                    /* fall back to _l3Read/myWrite for the rest */
+                    zeroCopyFd = -1;
+                    continue;
+                }
+                if (bytesWritten != toread1) {
+                    rodsLog (LOG_NOTICE,
+                     "_partialDataGet: toread %d bytes, %d bytes sent",
+                      toread1, bytesWritten);
+                    if (bytesWritten < 0) {
+                        myInput->status = bytesWritten;
+                    } else {
+                        myInput->status = SYS_COPY_LEN_ERR;
+                    }
+                    break;
+                }
+                myInput->zeroCopyBytes += bytesWritten;
+                bytesToGet -= bytesWritten;
+                toread0 -= bytesWritten;
+                myOffset += bytesWritten;
+                continue;
+            }
+            if (buf == NULL) {
+                buf = (char*)malloc (TRANS_BUF_SZ);
+            }
 	    bytesRead = _l3Read (myInput->rsComm, srcRescTypeInx,
              srcL3descInx, buf, toread1);
 
@@ -807,6 +950,7 @@ partialDataGet (portalTransferInp_t *myInput)
                     }
                     break;
                 }
+                myInput->bufferedBytes += bytesWritten;
                 bytesToGet -= bytesWritten;
                 toread0 -= bytesWritten;
                 myOffset += bytesWritten;
@@ -834,7 +978,12 @@ partialDataGet (portalTransferInp_t *myInput)
 #ifdef PARA_TIMING
     afterTransfer=time(0);
 #endif
-    free (buf);
+    if (buf != NULL) free (buf);
+    if (myInput->zeroCopyBytes > 0) {
+        rodsLog (LOG_DEBUG,
+          "partialDataGet: thread %d zeroCopy %lld buffered %lld bytes",
+          myInput->threadNum, myInput->zeroCopyBytes, myInput->bufferedBytes);
+    }
     applyRuleForSvrPortal(destFd, GET_OPR, 1, myOffset - myInput->offset, myInput->rsComm);
     sendTranHeader (destFd, DONE_OPR, 0, 0, 0);
     if (myInput->threadNum > 0)
@@ -2535,6 +2684,112 @@ readStartupPack (int sock, startupPack_t **startupPack, struct timeval *tv)
     return (status);
 }
 
+#ifndef windows_platform
+/* sendPoolConnReq - hand an accepted client socket and its startup pack
+ * to a pre-forked agent over the UNIX domain socket poolSock. The socket
+ * is passed with SCM_RIGHTS so the caller can close its copy afterward.
+ */
+
+int
+sendPoolConnReq (int poolSock, int sock, startupPack_t *startupPack)
+{
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    char cmsgBuf[CMSG_SPACE (sizeof (int))];
+    int status;
+
+    if (startupPack == NULL) return SYS_INTERNAL_NULL_INPUT_ERR;
+
+    memset (&msg, 0, sizeof (msg));
+    memset (cmsgBuf, 0, sizeof (cmsgBuf));
+    iov.iov_base = (void *) startupPack;
+    iov.iov_len = sizeof (startupPack_t);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsgBuf;
+    msg.msg_controllen = sizeof (cmsgBuf);
+
+    cmsg = CMSG_FIRSTHDR (&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+    memcpy (CMSG_DATA (cmsg), &sock, sizeof (int));
+
+    while ((status = sendmsg (poolSock, &msg, 0)) < 0 && errno == EINTR);
+    if (status != (int) sizeof (startupPack_t)) {
+        rodsLog (LOG_NOTICE,
+          "sendPoolConnReq: sendmsg to pool sock %d failed, errno = %d",
+          poolSock, errno);
+        return (SYS_SOCK_OPEN_ERR - errno);
+    }
+    return (0);
+}
+
+/* recvPoolConnReq - the pre-forked agent side of sendPoolConnReq. Block
+ * until the server hands over a client socket. Returns SYS_SOCK_READ_ERR
+ * when the server end is closed (server shutdown).
+ */
+
+int
+recvPoolConnReq (int poolSock, int *sock, startupPack_t *startupPack)
+{
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    char cmsgBuf[CMSG_SPACE (sizeof (int))];
+    int status;
+
+    if (sock == NULL || startupPack == NULL) 
+	return SYS_INTERNAL_NULL_INPUT_ERR;
+
+    memset (&msg, 0, sizeof (msg));
+    iov.iov_base = (void *) startupPack;
+    iov.iov_len = sizeof (startupPack_t);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsgBuf;
+    msg.msg_controllen = sizeof (cmsgBuf);
+
+    while ((status = recvmsg (poolSock, &msg, 0)) < 0 && errno == EINTR);
+    if (status == 0) {
+	/* the server is gone */
+	return SYS_SOCK_READ_ERR;
+    } else if (status != (int) sizeof (startupPack_t)) {
+        rodsLog (LOG_NOTICE,
+          "recvPoolConnReq: recvmsg error, status = %d, errno = %d",
+          status, errno);
+        return (SYS_SOCK_READ_ERR - errno);
+    }
+
+    cmsg = CMSG_FIRSTHDR (&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS) {
+        rodsLog (LOG_NOTICE,
+          "recvPoolConnReq: no socket passed with the startup pack");
+        return (SYS_SOCK_READ_ERR);
+    }
+    memcpy (sock, CMSG_DATA (cmsg), sizeof (int));
+    return (0);
+}
+
+/* sendPoolAgentStatus - tell the server that this pre-forked agent
+ * is ready for a new connection.
+ */
+
+int
+sendPoolAgentStatus (int poolSock, int agentStatus)
+{
+    int status;
+
+    while ((status = write (poolSock, &agentStatus, sizeof (int))) < 0 &&
+      errno == EINTR);
+    if (status != (int) sizeof (int)) {
+        return (SYS_SOCK_OPEN_ERR - errno);
+    }
+    return (0);
+}
+#endif	/* windows_platform */
 
 #ifdef RUN_SERVER_AS_ROOT
 
@@ -25,10 +25,65 @@
 #include <sys/time.h>
 #endif
 
+/* The free L1desc are kept on a stack so that allocL1desc and freeL1desc
+ * do not have to scan the table. L1descInuseMap has a bit set for each
+ * L1desc in use and is used by nextL1descInuse to skip over free ones. */
+
+#define L1DESC_MAP_BITS		(8 * sizeof (unsigned int))
+
+static int *L1descFreeList = NULL;
+static int L1descFreeCnt = 0;
+static unsigned int *L1descInuseMap = NULL;
+static int L1descInuseCnt = 0;
+static int L1descHwm = 0;	/* max L1descInuseCnt for this agent */
+
+/* growL1desc - make L1desc up to newNumL1desc available and put the new
+ * ones on the free list. Returns the number added. */
+
+static int
+growL1desc (int newNumL1desc)
+{
+    int i, startInx;
+
+    if (newNumL1desc > MAX_NUM_L1_DESC) newNumL1desc = MAX_NUM_L1_DESC;
+    startInx = NumL1desc < 3 ? 3 : NumL1desc;
+    if (newNumL1desc <= startInx) return 0;
+
+    /* push the highest first so that the lowest is allocated first */
+    for (i = newNumL1desc - 1; i >= startInx; i--) {
+        L1descFreeList[L1descFreeCnt++] = i;
+    }
+    NumL1desc = newNumL1desc;
+
+    return (newNumL1desc - startInx);
+}
+
 int
 initL1desc ()
 {
-    memset (L1desc, 0, sizeof (l1desc_t) * NUM_L1_DESC);
+    if (L1desc == NULL) {
+        /* reserved at the max size so pointers into L1desc stay valid
+         * when it grows. Pages beyond NumL1desc are never touched. */
+        L1desc = (l1desc_t *) calloc (MAX_NUM_L1_DESC, sizeof (l1desc_t));
+        L1descFreeList = (int *) malloc (MAX_NUM_L1_DESC * sizeof (int));
+        L1descInuseMap = (unsigned int *) calloc (
+          MAX_NUM_L1_DESC / L1DESC_MAP_BITS + 1, sizeof (unsigned int));
+        if (L1desc == NULL || L1descFreeList == NULL || 
+          L1descInuseMap == NULL) {
+            rodsLog (LOG_ERROR,
+              "initL1desc: malloc of %d L1desc failed", MAX_NUM_L1_DESC);
+            return (SYS_MALLOC_ERR);
+        }
+    } else {
+        memset (L1desc, 0, sizeof (l1desc_t) * NumL1desc);
+        memset (L1descInuseMap, 0, 
+          (NumL1desc / L1DESC_MAP_BITS + 1) * sizeof (unsigned int));
+    }
+    NumL1desc = 0;
+    L1descFreeCnt = 0;
+    L1descInuseCnt = 0;
+    growL1desc (DEF_NUM_L1_DESC);
+
     return (0);
 }
 
@@ -37,30 +92,63 @@ allocL1desc ()
 {
     int i;
 
-    for (i = 3; i < NUM_L1_DESC; i++) {
-        if (L1desc[i].inuseFlag <= FD_FREE) {
-            L1desc[i].inuseFlag = FD_INUSE;
-            return (i);
-        };
+    if (L1desc == NULL && (i = initL1desc ()) < 0) {
+        return (i);
     }
 
-    rodsLog (LOG_NOTICE,
-     "allocL1desc: out of L1desc");
+    if (L1descFreeCnt <= 0 && growL1desc (2 * NumL1desc) <= 0) {
+        rodsLog (LOG_NOTICE,
+         "allocL1desc: out of L1desc");
+        return (SYS_OUT_OF_FILE_DESC);
+    }
 
-    return (SYS_OUT_OF_FILE_DESC);
+    i = L1descFreeList[--L1descFreeCnt];
+    L1desc[i].inuseFlag = FD_INUSE;
+    L1descInuseMap[i / L1DESC_MAP_BITS] |= 1U << (i % L1DESC_MAP_BITS);
+    L1descInuseCnt++;
+    if (L1descInuseCnt > L1descHwm) {
+        L1descHwm = L1descInuseCnt;
+    }
+
+    return (i);
 }
 
 int
 isL1descInuse ()
 {
-    int i;
+    return (L1descInuseCnt > 0);
+}
 
-    for (i = 3; i < NUM_L1_DESC; i++) {
-        if (L1desc[i].inuseFlag == FD_INUSE) {
-	    return 1;
-        };
+/* nextL1descInuse - return the first L1desc in use after l1descInx, or -1
+ * if there is none. Start with l1descInx = 2 to get the first one. */
+
+int
+nextL1descInuse (int l1descInx)
+{
+    int i;
+    unsigned int bits;
+
+    i = l1descInx < 3 ? 3 : l1descInx + 1;
+    while (i < NumL1desc) {
+        bits = L1descInuseMap[i / L1DESC_MAP_BITS] >> (i % L1DESC_MAP_BITS);
+        if (bits == 0) {
+            /* nothing in use in the rest of this word */
+            i = (i / L1DESC_MAP_BITS + 1) * L1DESC_MAP_BITS;
+            continue;
+        }
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            i++;
+        }
+        return (i < NumL1desc ? i : -1);
     }
-    return 0;
+    return (-1);
+}
+
+int
+getL1descHwm ()
+{
+    return (L1descHwm);
 }
 
 int
@@ -114,9 +202,8 @@ closeAllL1desc (rsComm_t *rsComm)
     if (rsComm == NULL) {
 	return 0;
     }
-    for (i = 3; i < NUM_L1_DESC; i++) {
-        if (L1desc[i].inuseFlag == FD_INUSE && 
-	  L1desc[i].l3descInx > 2) {
+    for (i = nextL1descInuse (2); i >= 0; i = nextL1descInuse (i)) {
+        if (L1desc[i].l3descInx > 2) {
 	    l3Close (rsComm, i);
 	}
     }
@@ -126,6 +213,8 @@ closeAllL1desc (rsComm_t *rsComm)
 int
 freeL1desc (int l1descInx)
 {
+    int inuseFlag;
+
     if (l1descInx < 3 || l1descInx >= NUM_L1_DESC) {
         rodsLog (LOG_NOTICE,
          "freeL1desc: l1descInx %d out of range", l1descInx);
@@ -156,13 +245,26 @@ freeL1desc (int l1descInx)
         freeDataObjInfo (L1desc[l1descInx].replDataObjInfo);
     }
 
+    if (L1desc[l1descInx].inlineChksum != NULL) {
+        free (L1desc[l1descInx].inlineChksum);
+    }
+
     if (L1desc[l1descInx].dataObjInpReplFlag == 1 &&
       L1desc[l1descInx].dataObjInp != NULL) {
 	clearDataObjInp (L1desc[l1descInx].dataObjInp);
 	free (L1desc[l1descInx].dataObjInp);
     }
+    inuseFlag = L1desc[l1descInx].inuseFlag;
     memset (&L1desc[l1descInx], 0, sizeof (l1desc_t));
 
+    /* a free L1desc is already on the free list */
+    if (inuseFlag == FD_INUSE) {
+        L1descInuseMap[l1descInx / L1DESC_MAP_BITS] &= 
+          ~(1U << (l1descInx % L1DESC_MAP_BITS));
+        L1descInuseCnt--;
+        L1descFreeList[L1descFreeCnt++] = l1descInx;
+    }
+
     return (0);
 }
 
@@ -23,6 +23,7 @@
 #include "reSysDataObjOpr.h"
 #include "genQuery.h"
 #include "rodsClient.h"
+#include "md5Checksum.h"
 
 int
 getFileMode (dataObjInp_t *dataObjInp)
@@ -543,6 +544,9 @@ char **chksumStr)
     switch (RescTypeDef[rescTypeInx].rescCat) {
       case FILE_CAT:
         memset (&fileChksumInp, 0, sizeof (fileChksumInp));
+        /* a composite chksum can only be checked with another one */
+        fileChksumInp.flag = getCompositeNumSeg (*chksumStr != NULL ?
+          *chksumStr : inpDataObjInfo->chksum);
         fileChksumInp.fileType = (fileDriverType_t)RescTypeDef[rescTypeInx].driverType;
         rstrcpy (fileChksumInp.addr.hostAddr, rescInfo->rescLoc,
           NAME_LEN);
@@ -563,6 +567,107 @@ char **chksumStr)
     return (status);
 }
 
+/* startInlineChksum - start chksumming the data of a put on l1descInx as
+ * they are written in numSeg segments, if a chksum will be registered on
+ * close. No inline chksum is not an error. The file is read again then.
+ * A VERIFY_CHKSUM always reads the file again, so it gets none.
+ */
+int
+startInlineChksum (int l1descInx, int numSeg, rodsLong_t dataSize)
+{
+    char *refChksum = L1desc[l1descInx].chksum;
+    inlineChksum_t *inlineChksum;
+    int use_sha256;
+
+    freeInlineChksum (l1descInx);
+    if (L1desc[l1descInx].chksumFlag != REG_CHKSUM ||
+      strlen (L1desc[l1descInx].dataObjInfo->chksum) > 0) {
+        /* nobody will ask or the close will verify the file */
+        return (0);
+    }
+    if (getenv (CHKSUM_BY_READ_KW) != NULL) return (0);
+
+    if (numSeg > 1) {
+        /* only the composite chksum can be taken in parallel */
+        if (strlen (refChksum) > 0) {
+            if (getCompositeNumSeg (refChksum) != numSeg) return (0);
+        } else if (getenv (COMPOSITE_CHKSUM_KW) == NULL) {
+            return (0);
+        }
+        use_sha256 = 0;
+    } else if (strlen (refChksum) > 0) {
+        use_sha256 = extractHashFunction2 (refChksum);
+        if (use_sha256 < 0) return (0);
+    } else if (L1desc[l1descInx].dataObjInp != NULL) {
+        use_sha256 = extractHashFunction (
+          &L1desc[l1descInx].dataObjInp->condInput);
+    } else {
+        use_sha256 = 0;
+    }
+
+    inlineChksum = (inlineChksum_t *) malloc (sizeof (inlineChksum_t));
+    if (initInlineChksum (inlineChksum, numSeg, dataSize, use_sha256) < 0) {
+        free (inlineChksum);
+        return (0);
+    }
+    L1desc[l1descInx].inlineChksum = inlineChksum;
+    return (0);
+}
+
+int
+freeInlineChksum (int l1descInx)
+{
+    if (L1desc[l1descInx].inlineChksum != NULL) {
+        free (L1desc[l1descInx].inlineChksum);
+        L1desc[l1descInx].inlineChksum = NULL;
+    }
+    return (0);
+}
+
+/* dataObjChksumForClose - the chksum of the data written through
+ * l1descInx. For a REG_CHKSUM, it is the one taken while the data were
+ * written if that covers the whole file and can be compared with the
+ * input chksum. A VERIFY_CHKSUM must check what is in the vault, so the
+ * file is always read again with _dataObjChksum, as it is otherwise.
+ */
+int
+dataObjChksumForClose (rsComm_t *rsComm, int l1descInx, char **chksumStr)
+{
+    dataObjInfo_t *dataObjInfo = L1desc[l1descInx].dataObjInfo;
+    inlineChksum_t *inlineChksum = L1desc[l1descInx].inlineChksum;
+    char *refChksum = L1desc[l1descInx].chksum;
+    char myChksum[CHKSUM_LEN];
+    char *hint = NULL;
+    rodsLong_t vaultSize;
+    int status;
+
+    if (inlineChksum != NULL && L1desc[l1descInx].chksumFlag == REG_CHKSUM &&
+      (strlen (refChksum) == 0 ||
+      matchInlineChksum (inlineChksum, refChksum) > 0)) {
+        vaultSize = getSizeInVault (rsComm, dataObjInfo);
+        if (vaultSize >= 0 &&
+          finalInlineChksum (inlineChksum, vaultSize, myChksum) >= 0) {
+            *chksumStr = strdup (myChksum);
+            return (0);
+        }
+        rodsLog (LOG_DEBUG,
+          "dataObjChksumForClose: inline chksum of %s incomplete, reread",
+          dataObjInfo->objPath);
+    }
+
+    if (*chksumStr == NULL && strlen (refChksum) > 0) {
+        /* tell _dataObjChksum what the chksum is compared with */
+        hint = strdup (refChksum);
+        *chksumStr = hint;
+    }
+    status = _dataObjChksum (rsComm, dataObjInfo, chksumStr);
+    if (hint != NULL) {
+        if (*chksumStr == hint) *chksumStr = NULL;
+        free (hint);
+    }
+    return (status);
+}
+
 int
 dataObjChksumAndReg (rsComm_t *rsComm, dataObjInfo_t *dataObjInfo, 
 char **chksumStr) 
@@ -23,6 +23,7 @@
 #include "rodsClient.h"
 #include "rsIcatOpr.h"
 #include "resource.h"
+#include "rescCache.h"
 
 int 
 getReInfo (rsComm_t *rsComm, genQueryOut_t **genQueryOut)
@@ -612,6 +613,7 @@ initReExec (rsComm_t *rsComm, reExec_t *reExec)
     }
     for (i = 0; i < reExec->maxRunCnt; i++) {
 	reExec->reExecProc[i].procExecState = RE_PROC_IDLE;
+	reExec->reExecProc[i].jobFd = -1;
         reExec->reExecProc[i].ruleExecSubmitInp.packedReiAndArgBBuf =
           (bytesBuf_t *) malloc (sizeof (bytesBuf_t));
         reExec->reExecProc[i].ruleExecSubmitInp.packedReiAndArgBBuf->buf = 
@@ -680,59 +682,73 @@ waitAndFreeReThr (rsComm_t *rsComm, reExec_t *reExec)
     } else {
         thrInx = matchPidInReExec (reExec, childPid);
         if (thrInx >= 0) {
-	    genQueryOut_t *genQueryOut = NULL;
-	    int status1;
-	    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
-	    char *ruleExecId = reExecProc->ruleExecSubmitInp.ruleExecId;
-	    
-	    status1 = getReInfoById (rsComm, ruleExecId, &genQueryOut);
-	    if (status1 >= 0) {
-	    	sqlResult_t *exeFrequency, *exeStatus;
-	        if ((exeFrequency = getSqlResultByInx (genQueryOut,
-	         COL_RULE_EXEC_FREQUENCY)) == NULL) {
-	            rodsLog (LOG_NOTICE,
-	             "waitAndFreeReThr:getResultByInx for RULE_EXEC_FREQUENCY failed");
-	        }
-	        if ((exeStatus = getSqlResultByInx (genQueryOut,
-	         COL_RULE_EXEC_STATUS)) == NULL) {
-	            rodsLog (LOG_NOTICE,
-	             "waitAndFreeReThr:getResultByInx for RULE_EXEC_STATUS failed");
-	        }
+	    postProcReThr (rsComm, reExec, thrInx);
+	    freeReThr (reExec, thrInx);
+	}
+    }
+    return thrInx;
+}
+#endif
+
+/* postProcReThr - check the job of thrInx after its process is done.
+ * The job should have been deleted or rescheduled by postProcRunRuleExec.
+ * If it is still there and not rescheduled, the process probably
+ * crashed. Mark it RE_FAILED the first time and delete it the second */
+
+int
+postProcReThr (rsComm_t *rsComm, reExec_t *reExec, int thrInx)
+{
+    int status = 0;
+    genQueryOut_t *genQueryOut = NULL;
+    int status1;
+    reExecProc_t *reExecProc = &reExec->reExecProc[thrInx];
+    char *ruleExecId = reExecProc->ruleExecSubmitInp.ruleExecId;
+
+    status1 = getReInfoById (rsComm, ruleExecId, &genQueryOut);
+    if (status1 >= 0) {
+        sqlResult_t *exeFrequency, *exeStatus;
+        if ((exeFrequency = getSqlResultByInx (genQueryOut,
+         COL_RULE_EXEC_FREQUENCY)) == NULL) {
+            rodsLog (LOG_NOTICE,
+             "postProcReThr:getResultByInx for RULE_EXEC_FREQUENCY failed");
+        }
+        if ((exeStatus = getSqlResultByInx (genQueryOut,
+         COL_RULE_EXEC_STATUS)) == NULL) {
+            rodsLog (LOG_NOTICE,
+             "postProcReThr:getResultByInx for RULE_EXEC_STATUS failed");
+        }
+
+        if (exeFrequency == NULL || strlen (exeFrequency->value) == 0 ||
+          (exeStatus != NULL && strcmp (exeStatus->value, RE_RUNNING) == 0)) {
+            int i;
+            int overlap = 0;
+            for (i = 0; i < reExec->maxRunCnt; i++) {
+                if (i != thrInx && strcmp (reExec->reExecProc[i].
+                  ruleExecSubmitInp.ruleExecId, ruleExecId) == 0) {
+                    overlap++;
+                }
+            }
 
-	        if(exeFrequency == NULL || strlen(exeFrequency->value) == 0 || strcmp(exeStatus->value, RE_RUNNING) == 0) {
-
-			int i;
-			int overlap = 0;
-			for(i =0;i<reExec->maxRunCnt;i++) {
-				if(i != thrInx && strcmp(reExec->reExecProc[i].ruleExecSubmitInp.ruleExecId, ruleExecId)==0) {
-				    overlap++;
-				}
-			}
-				        
-			if(overlap == 0) {
-		/* something wrong since the entry is not deleted. could
-		 * be core dump */
+            if (overlap == 0) {
+                /* something wrong since the entry is not deleted. could
+                 * be core dump */
                 if ((reExecProc->jobType & RE_FAILED_STATUS) == 0) {
                     /* first time. just mark it RE_FAILED */
                     regExeStatus (rsComm, ruleExecId, RE_FAILED);
                 } else {
-		    ruleExecDelInp_t ruleExecDelInp;
-		    rodsLog (LOG_ERROR,
-		      "waitAndFreeReThr: %s executed but still in iCat. Job deleted",
-		      ruleExecId);
-		    rstrcpy (ruleExecDelInp.ruleExecId, ruleExecId, NAME_LEN);
+                    ruleExecDelInp_t ruleExecDelInp;
+                    rodsLog (LOG_ERROR,
+                      "postProcReThr: %s executed but still in iCat. Job deleted",
+                      ruleExecId);
+                    rstrcpy (ruleExecDelInp.ruleExecId, ruleExecId, NAME_LEN);
                     status = rsRuleExecDel (rsComm, &ruleExecDelInp);
-			}
-		}
-	        }
-			freeGenQueryOut (&genQueryOut);
-	    }
-	    freeReThr (reExec, thrInx);
-	}
+                }
+            }
+        }
+        freeGenQueryOut (&genQueryOut);
     }
-    return thrInx;
+    return status;
 }
-#endif
 
 int
 matchPidInReExec (reExec_t *reExec, pid_t pid)
@@ -766,7 +782,9 @@ freeReThr (reExec_t *reExec, int thrInx)
     reExec->reExecProc[thrInx].procExecState = RE_PROC_IDLE;
     reExec->reExecProc[thrInx].status = 0;
     reExec->reExecProc[thrInx].jobType = 0;
-    reExec->reExecProc[thrInx].pid = 0;
+    /* a worker of the pool stays around for the next job */
+    if (reExec->reExecProc[thrInx].jobFd < 0)
+        reExec->reExecProc[thrInx].pid = 0;
     /* save the packedReiAndArgBBuf */
     packedReiAndArgBBuf = 
     reExec->reExecProc[thrInx].ruleExecSubmitInp.packedReiAndArgBBuf;
@@ -910,6 +928,11 @@ chkAndUpdateResc (rsComm_t *rsComm)
     }
 
     if (curTime >= LastRescUpdateTime + RESC_UPDATE_TIME) {
+	if (rescCacheChanged () == 0) {
+	    /* the resource cache says nothing has changed */
+	    LastRescUpdateTime = curTime;
+	    return 0;
+	}
 	status = updateResc (rsComm);
 	LastRescUpdateTime = curTime;
 	return status;
@@ -1011,15 +1034,6 @@ reServerSingleExec (rsComm_t *rsComm, char *ruleExecId, int jobType)
       *estimateExeTime, *notificationAddr;
     genQueryOut_t *genQueryOut = NULL;
 
-    bzero (&reExecProc, sizeof (reExecProc));
-    /* init reComm */
-    reExecProc.reComm.proxyUser = rsComm->proxyUser;
-    reExecProc.reComm.myEnv = rsComm->myEnv;
-    reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf =
-      (bytesBuf_t *) calloc (1, sizeof (bytesBuf_t));
-    reExecProc.procExecState = RE_PROC_RUNNING;
-    reExecProc.jobType = jobType;
-
     status = getReInfoById (rsComm, ruleExecId, &genQueryOut);
     if (status < 0) {
         rodsLog (LOG_ERROR,
@@ -1109,11 +1123,427 @@ reServerSingleExec (rsComm_t *rsComm, char *ruleExecId, int jobType)
       ruleName->value, userName->value, exeAddress->value, exeFrequency->value,
       priority->value, estimateExeTime->value, notificationAddr->value);
 
-    if (status < 0) return status;
-    seedRandom ();
-    status = runRuleExec (&reExecProc);
-    postProcRunRuleExec (rsComm, &reExecProc);
     freeGenQueryOut (&genQueryOut);
-    return (reExecProc.status);
+    if (status >= 0) {
+        seedRandom ();
+        status = runRuleExec (&reExecProc);
+        postProcRunRuleExec (rsComm, &reExecProc);
+        status = reExecProc.status;
+    }
+    /* the workers of the pool run many jobs. Don't leak */
+    if (reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf->buf != NULL)
+        free (reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf->buf);
+    free (reExecProc.ruleExecSubmitInp.packedReiAndArgBBuf);
+    return (status);
+}
+
+
+/* initReQueue - init the in memory queue of delayed rules */
+
+int
+initReQueue (reQueue_t *reQueue)
+{
+    char *tmpStr;
+
+    if (reQueue == NULL) return SYS_INTERNAL_NULL_INPUT_ERR;
+
+    bzero (reQueue, sizeof (reQueue_t));
+    if ((tmpStr = getenv (RE_QUEUE_RESYNC_TIME_KW)) != NULL &&
+      atoi (tmpStr) > 0) {
+        reQueue->resyncTime = atoi (tmpStr);
+    } else {
+        reQueue->resyncTime = DEF_RE_QUEUE_RESYNC_TIME;
+    }
+    reQueue->lastStats = time (NULL);
+
+    return 0;
+}
+
+static int
+cmpReQueueEntry (reQueueEntry_t *entry1, reQueueEntry_t *entry2)
+{
+    if (entry1->exeTime != entry2->exeTime)
+        return (entry1->exeTime < entry2->exeTime ? -1 : 1);
+    if (entry1->ruleExecId != entry2->ruleExecId)
+        return (entry1->ruleExecId < entry2->ruleExecId ? -1 : 1);
+    return 0;
+}
+
+int
+pushReQueue (reQueue_t *reQueue, rodsLong_t ruleExecId, rodsLong_t exeTime,
+int jobType)
+{
+    reQueueEntry_t *entries = reQueue->entries;
+    reQueueEntry_t myEntry;
+    int inx, parent;
+
+    if (reQueue->numEntries >= reQueue->maxEntries) {
+        int newMax = reQueue->maxEntries > 0 ? 2 * reQueue->maxEntries :
+          MAX_SQL_ROWS * 16;
+        entries = (reQueueEntry_t *) realloc (reQueue->entries,
+          newMax * sizeof (reQueueEntry_t));
+        if (entries == NULL) {
+            rodsLog (LOG_ERROR,
+              "pushReQueue: realloc of %d entries failed", newMax);
+            return (SYS_MALLOC_ERR);
+        }
+        reQueue->entries = entries;
+        reQueue->maxEntries = newMax;
+    }
+
+    myEntry.ruleExecId = ruleExecId;
+    myEntry.exeTime = exeTime;
+    myEntry.jobType = jobType;
+
+    /* sift up */
+    inx = reQueue->numEntries++;
+    while (inx > 0) {
+        parent = (inx - 1) / 2;
+        if (cmpReQueueEntry (&entries[parent], &myEntry) <= 0) break;
+        entries[inx] = entries[parent];
+        inx = parent;
+    }
+    entries[inx] = myEntry;
+
+    return 0;
 }
 
+/* popReQueue - take the entry with the earliest exeTime off the queue.
+ * Returns 0 or -1 if the queue is empty */
+
+int
+popReQueue (reQueue_t *reQueue, reQueueEntry_t *outEntry)
+{
+    reQueueEntry_t *entries = reQueue->entries;
+    reQueueEntry_t *last;
+    int inx, child;
+
+    if (reQueue->numEntries <= 0) return (-1);
+
+    *outEntry = entries[0];
+    reQueue->numEntries--;
+    if (reQueue->numEntries == 0) return 0;
+
+    /* sift the last entry down from the top */
+    last = &entries[reQueue->numEntries];
+    inx = 0;
+    while ((child = 2 * inx + 1) < reQueue->numEntries) {
+        if (child + 1 < reQueue->numEntries &&
+          cmpReQueueEntry (&entries[child + 1], &entries[child]) < 0)
+            child++;
+        if (cmpReQueueEntry (last, &entries[child]) <= 0) break;
+        entries[inx] = entries[child];
+        inx = child;
+    }
+    entries[inx] = *last;
+
+    return 0;
+}
+
+/* loadReQueue - load the delayed rules from the catalog into reQueue.
+ * If fullFlag is set, all the jobs are loaded and the queue is rebuilt.
+ * Otherwise only the jobs submitted since the last load (ruleExecId
+ * larger than maxRuleExecId) are added. Jobs that are running in reExec
+ * are skipped. Only id, time and status are queried; the rest of the
+ * job is fetched by reServerSingleExec when it runs.
+ * Returns the number of jobs loaded */
+
+int
+loadReQueue (rsComm_t *rsComm, reQueue_t *reQueue, reExec_t *reExec,
+int fullFlag)
+{
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *ruleExecId, *exeTime, *exeStatus;
+    char condStr[NAME_LEN];
+    rodsLong_t maxRuleExecId = reQueue->maxRuleExecId;
+    int status, i;
+    int loadCnt = 0;
+    int firstPage = 1;
+
+    memset (&genQueryInp, 0, sizeof (genQueryInp_t));
+    addInxIval (&genQueryInp.selectInp, COL_RULE_EXEC_ID, 1);
+    addInxIval (&genQueryInp.selectInp, COL_RULE_EXEC_TIME, 1);
+    addInxIval (&genQueryInp.selectInp, COL_RULE_EXEC_STATUS, 1);
+    if (fullFlag == 0) {
+        snprintf (condStr, NAME_LEN, "> '%lld'", reQueue->maxRuleExecId);
+        addInxVal (&genQueryInp.sqlCondInp, COL_RULE_EXEC_ID, condStr);
+    }
+    genQueryInp.maxRows = MAX_SQL_ROWS;
+
+    status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    while (status >= 0 && genQueryOut != NULL) {
+        if (firstPage) {
+            /* rebuild only once the query works */
+            if (fullFlag) reQueue->numEntries = 0;
+            firstPage = 0;
+        }
+        ruleExecId = getSqlResultByInx (genQueryOut, COL_RULE_EXEC_ID);
+        exeTime = getSqlResultByInx (genQueryOut, COL_RULE_EXEC_TIME);
+        exeStatus = getSqlResultByInx (genQueryOut, COL_RULE_EXEC_STATUS);
+        if (ruleExecId == NULL || exeTime == NULL || exeStatus == NULL) {
+            rodsLog (LOG_NOTICE,
+              "loadReQueue: getSqlResultByInx failed");
+            status = UNMATCHED_KEY_OR_INDEX;
+            break;
+        }
+        for (i = 0; i < genQueryOut->rowCnt; i++) {
+            char *ruleExecIdStr = &ruleExecId->value[ruleExecId->len * i];
+            char *exeStatusStr = &exeStatus->value[exeStatus->len * i];
+            rodsLong_t myId = strtoll (ruleExecIdStr, 0, 0);
+
+            if (myId > maxRuleExecId) maxRuleExecId = myId;
+            if (reExec->doFork == 1 &&
+              matchRuleExecId (reExec, ruleExecIdStr, RE_PROC_RUNNING)) {
+                /* it will be requeued when done */
+                continue;
+            }
+            status = pushReQueue (reQueue, myId,
+              strtoll (&exeTime->value[exeTime->len * i], 0, 0),
+              strcmp (exeStatusStr, RE_FAILED) == 0 ? RE_FAILED_STATUS : 0);
+            if (status < 0) break;
+            loadCnt++;
+        }
+        if (status < 0 || genQueryOut->continueInx <= 0) break;
+        genQueryInp.continueInx = genQueryOut->continueInx;
+        freeGenQueryOut (&genQueryOut);
+        status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    }
+
+    if (genQueryOut != NULL) {
+        if (status < 0 && genQueryOut->continueInx > 0)
+            svrCloseQueryOut (rsComm, genQueryOut);
+        freeGenQueryOut (&genQueryOut);
+    }
+    clearGenQueryInp (&genQueryInp);
+
+    if (status == CAT_NO_ROWS_FOUND) {
+        if (fullFlag && firstPage) reQueue->numEntries = 0;
+        status = 0;
+    }
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "loadReQueue: query of the rule exec queue failed, status = %d",
+          status);
+        return (status);
+    }
+
+    reQueue->maxRuleExecId = maxRuleExecId;
+    reQueue->lastLoad = time (NULL);
+    if (fullFlag) {
+        reQueue->nextResync = reQueue->lastLoad + reQueue->resyncTime;
+        rodsLog (LOG_NOTICE,
+          "loadReQueue: loaded %d jobs, max id %lld", loadCnt, maxRuleExecId);
+    }
+
+    return (loadCnt);
+}
+
+/* requeueRuleExec - put ruleExecId back on the queue after it ran if it
+ * is still in the catalog, i.e., rescheduled or failed the first time */
+
+int
+requeueRuleExec (rsComm_t *rsComm, reQueue_t *reQueue, char *ruleExecId)
+{
+    genQueryOut_t *genQueryOut = NULL;
+    sqlResult_t *exeTime, *exeStatus;
+    rodsLong_t myExeTime;
+    int jobType = 0;
+    int status;
+
+    status = getReInfoById (rsComm, ruleExecId, &genQueryOut);
+    if (status < 0) {
+        if (genQueryOut != NULL) freeGenQueryOut (&genQueryOut);
+        /* gone. the normal case */
+        return (status == CAT_NO_ROWS_FOUND ? 0 : status);
+    }
+
+    exeTime = getSqlResultByInx (genQueryOut, COL_RULE_EXEC_TIME);
+    exeStatus = getSqlResultByInx (genQueryOut, COL_RULE_EXEC_STATUS);
+    if (exeTime == NULL || exeStatus == NULL) {
+        freeGenQueryOut (&genQueryOut);
+        return (UNMATCHED_KEY_OR_INDEX);
+    }
+
+    if (strcmp (exeStatus->value, RE_RUNNING) == 0) {
+        /* could not be updated. The next full load will pick it up */
+        freeGenQueryOut (&genQueryOut);
+        return 0;
+    }
+
+    myExeTime = strtoll (exeTime->value, 0, 0);
+    if (strcmp (exeStatus->value, RE_FAILED) == 0) {
+        /* don't rerun a failed job right away */
+        jobType = RE_FAILED_STATUS;
+        if (myExeTime < time (NULL) + RE_FAILED_RETRY_TIME)
+            myExeTime = time (NULL) + RE_FAILED_RETRY_TIME;
+    }
+    freeGenQueryOut (&genQueryOut);
+
+    return (pushReQueue (reQueue, strtoll (ruleExecId, 0, 0), myExeTime,
+      jobType));
+}
+
+#ifndef windows_platform
+/* openReWakeup - open the fifo rsRuleExecSubmit writes to when a job is
+ * queued. dummyFd is a write end kept open so that the fifo never shows
+ * end of file when no agent has it open */
+
+int
+openReWakeup (int *wakeupFd, int *dummyFd)
+{
+    char fifoPath[MAX_NAME_LEN];
+    struct stat statbuf;
+    int status;
+
+    *wakeupFd = *dummyFd = -1;
+    snprintf (fifoPath, MAX_NAME_LEN, "%s/%s", getStateDir (),
+      RE_WAKEUP_FIFO_NAME);
+
+    if (lstat (fifoPath, &statbuf) == 0 && !S_ISFIFO (statbuf.st_mode))
+        unlink (fifoPath);
+    if (mkfifo (fifoPath, 0600) < 0 && errno != EEXIST) {
+        status = UNIX_FILE_CREATE_ERR - errno;
+        rodsLog (LOG_ERROR,
+          "openReWakeup: mkfifo of %s error, status = %d", fifoPath, status);
+        return (status);
+    }
+
+    if ((*wakeupFd = open (fifoPath, O_RDONLY | O_NONBLOCK)) < 0 ||
+      (*dummyFd = open (fifoPath, O_WRONLY | O_NONBLOCK)) < 0) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLog (LOG_ERROR,
+          "openReWakeup: open of %s error, status = %d", fifoPath, status);
+        if (*wakeupFd >= 0) close (*wakeupFd);
+        *wakeupFd = -1;
+        return (status);
+    }
+
+    return 0;
+}
+
+/* drainReWakeup - empty the wakeup fifo. Many submissions in a row only
+ * need one load of the queue */
+
+int
+drainReWakeup (int wakeupFd)
+{
+    char buf[NAME_LEN];
+    int total = 0;
+    int nbytes;
+
+    while ((nbytes = read (wakeupFd, buf, sizeof (buf))) > 0 ||
+      (nbytes < 0 && errno == EINTR)) {
+        if (nbytes > 0) total += nbytes;
+    }
+    return (total);
+}
+
+/* notifyReServer - wake up the irodsReServer after a job is queued. It is
+ * not an error if no irodsReServer is listening; it will pick the job up
+ * when it polls */
+
+int
+notifyReServer ()
+{
+    char fifoPath[MAX_NAME_LEN];
+    int fd;
+
+    snprintf (fifoPath, MAX_NAME_LEN, "%s/%s", getStateDir (),
+      RE_WAKEUP_FIFO_NAME);
+    if ((fd = open (fifoPath, O_WRONLY | O_NONBLOCK)) < 0) return 0;
+    /* EAGAIN means the fifo is full and the server is awake anyway */
+    if (write (fd, "1", 1) < 0 && errno != EAGAIN) {
+        rodsLog (LOG_DEBUG,
+          "notifyReServer: write to %s error, errno = %d", fifoPath, errno);
+    }
+    close (fd);
+
+    return 0;
+}
+#else
+int
+openReWakeup (int *wakeupFd, int *dummyFd)
+{
+    *wakeupFd = *dummyFd = -1;
+    return (SYS_NOT_SUPPORTED);
+}
+
+int
+drainReWakeup (int wakeupFd)
+{
+    return 0;
+}
+
+int
+notifyReServer ()
+{
+    return 0;
+}
+#endif
+
+/* writeReStats - write the queue depth and lag of the delayed rules to
+ * RE_STATS_FILE_NAME in the log dir and log them. The lag is how late a
+ * job started compared to its exeTime. avgLagSec and maxLagSec are for
+ * the jobs started since the last call */
+
+int
+writeReStats (reQueue_t *reQueue, reExec_t *reExec)
+{
+    char statsPath[MAX_NAME_LEN], tmpPath[MAX_NAME_LEN];
+    time_t now = time (NULL);
+    int dueJobs = 0;
+    int oldestDue = 0;
+    double avgLag;
+    FILE *fptr;
+    int i;
+
+    for (i = 0; i < reQueue->numEntries; i++) {
+        if (reQueue->entries[i].exeTime <= now) dueJobs++;
+    }
+    if (reQueue->numEntries > 0 && reQueue->entries[0].exeTime <= now)
+        oldestDue = now - reQueue->entries[0].exeTime;
+    avgLag = reQueue->lagCnt > 0 ? reQueue->totalLag / reQueue->lagCnt : 0.0;
+
+    rodsLog (LOG_NOTICE,
+      "writeReStats: queue %d, due %d, oldest due %d sec, running %d of %d, run %lld, failed %lld, lag avg %.1f max %d sec",
+      reQueue->numEntries, dueJobs, oldestDue, reExec->runCnt,
+      reExec->maxRunCnt, reQueue->jobsRun, reQueue->jobsFailed, avgLag,
+      reQueue->maxLag);
+
+    if (snprintf (statsPath, MAX_NAME_LEN, "%s/%s", getLogDir (),
+      RE_STATS_FILE_NAME) >= MAX_NAME_LEN ||
+      snprintf (tmpPath, MAX_NAME_LEN, "%s.tmp", statsPath) >= MAX_NAME_LEN) {
+        rodsLog (LOG_ERROR,
+          "writeReStats: stats file path in %s too long", getLogDir ());
+        return (USER_PATH_EXCEEDS_MAX);
+    }
+    if ((fptr = fopen (tmpPath, "w")) == NULL) {
+        rodsLog (LOG_ERROR,
+          "writeReStats: fopen of %s error, errno = %d", tmpPath, errno);
+        return (UNIX_FILE_OPEN_ERR - errno);
+    }
+    fprintf (fptr, "queueDepth=%d\n", reQueue->numEntries);
+    fprintf (fptr, "dueJobs=%d\n", dueJobs);
+    fprintf (fptr, "oldestDueSec=%d\n", oldestDue);
+    fprintf (fptr, "running=%d\n", reExec->runCnt);
+    fprintf (fptr, "maxRunning=%d\n", reExec->maxRunCnt);
+    fprintf (fptr, "jobsRun=%lld\n", reQueue->jobsRun);
+    fprintf (fptr, "jobsFailed=%lld\n", reQueue->jobsFailed);
+    fprintf (fptr, "avgLagSec=%.1f\n", avgLag);
+    fprintf (fptr, "maxLagSec=%d\n", reQueue->maxLag);
+    fprintf (fptr, "lastUpdate=%d\n", (int) now);
+    fclose (fptr);
+    if (rename (tmpPath, statsPath) < 0) {
+        rodsLog (LOG_ERROR,
+          "writeReStats: rename to %s error, errno = %d", statsPath, errno);
+        return (UNIX_FILE_RENAME_ERR - errno);
+    }
+
+    reQueue->lagCnt = 0;
+    reQueue->totalLag = 0.0;
+    reQueue->maxLag = 0;
+    reQueue->lastStats = now;
+
+    return 0;
+}
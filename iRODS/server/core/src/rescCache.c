@@ -0,0 +1,591 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* rescCache.c - the server wide snapshot of the resource, resource group,
+ * resource host and load info. The snapshot is the file
+ * RESC_CACHE_FILE_NAME in the log dir. The irodsServer runs the catalog
+ * queries done by initResc, initRescGrp and sortRescByLoad every
+ * RESC_CACHE_REFRESH_TIME sec (or soon after an admin change invalidates
+ * the snapshot) and writes the results there. The agents mmap it read
+ * only and build their resource lists from it instead of querying the
+ * catalog. The version in the header is bumped on every change so that
+ * a long lived agent can tell whether its lists are current without a
+ * query. Access is serialized with a fcntl lock on the file.
+ */
+
+#ifndef windows_platform
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <netdb.h>
+#endif
+#include "rescCache.h"
+#include "resource.h"
+#include "genQuery.h"
+#include "rsIcatOpr.h"
+#include "rsGlobalExtern.h"
+#include "rcGlobalExtern.h"
+
+/* keep the tables 8 byte aligned in the snapshot */
+#define RESC_CACHE_ALIGN(len)	(((len) + 7) & ~7)
+
+#ifndef windows_platform
+static char *RescCache = NULL;
+static int RescCacheFd = -1;
+/* the version of the snapshot this process built RescGrpInfo from */
+static unsigned int RescCacheVersion = 0;
+
+static void
+getRescCachePath (char *cachePath)
+{
+    snprintf (cachePath, MAX_NAME_LEN, "%s/%s", getLogDir (),
+      RESC_CACHE_FILE_NAME);
+}
+
+static int
+lockRescCache (int fd, int lockType)
+{
+    struct flock myLock;
+
+    memset (&myLock, 0, sizeof (myLock));
+    myLock.l_type = lockType;
+    myLock.l_whence = SEEK_SET;
+    while (fcntl (fd, F_SETLKW, &myLock) < 0) {
+        if (errno != EINTR) {
+            return (SYS_FS_LOCK_ERR - errno);
+        }
+    }
+    return (0);
+}
+
+/* openRescCache - map the snapshot. The irodsServer (writeFlag set)
+ * creates it and marks it invalid until its first refresh. The agents
+ * map an existing one read only. */
+
+static int
+openRescCache (int writeFlag)
+{
+    char cachePath[MAX_NAME_LEN];
+    struct stat statbuf;
+    rescCacheHeader_t *header;
+    void *addr;
+
+    if (RescCache != NULL) return (0);
+
+    getRescCachePath (cachePath);
+    if (writeFlag > 0) {
+        RescCacheFd = open (cachePath, O_RDWR | O_CREAT, 0600);
+    } else {
+        RescCacheFd = open (cachePath, O_RDONLY, 0);
+    }
+    if (RescCacheFd < 0) {
+        if (writeFlag > 0) {
+            rodsLog (LOG_ERROR,
+              "openRescCache: open of %s error, errno = %d", cachePath, errno);
+            return (UNIX_FILE_OPEN_ERR - errno);
+        }
+        /* the irodsServer has not made one */
+        return (SYS_RESC_CACHE_STALE);
+    }
+
+    if (writeFlag > 0) {
+        lockRescCache (RescCacheFd, F_WRLCK);
+        if (fstat (RescCacheFd, &statbuf) < 0 ||
+          statbuf.st_size != RESC_CACHE_SZ) {
+            if (ftruncate (RescCacheFd, 0) < 0 ||
+              ftruncate (RescCacheFd, RESC_CACHE_SZ) < 0) {
+                rodsLog (LOG_ERROR,
+                  "openRescCache: ftruncate of %s error, errno = %d",
+                  cachePath, errno);
+                lockRescCache (RescCacheFd, F_UNLCK);
+                close (RescCacheFd);
+                RescCacheFd = -1;
+                return (UNIX_FILE_TRUNCATE_ERR - errno);
+            }
+        }
+        lockRescCache (RescCacheFd, F_UNLCK);
+        addr = mmap (NULL, RESC_CACHE_SZ, PROT_READ | PROT_WRITE, MAP_SHARED,
+          RescCacheFd, 0);
+    } else {
+        if (fstat (RescCacheFd, &statbuf) < 0 ||
+          statbuf.st_size != RESC_CACHE_SZ) {
+            close (RescCacheFd);
+            RescCacheFd = -1;
+            return (SYS_RESC_CACHE_STALE);
+        }
+        addr = mmap (NULL, RESC_CACHE_SZ, PROT_READ, MAP_SHARED,
+          RescCacheFd, 0);
+    }
+    if (addr == MAP_FAILED) {
+        rodsLog (LOG_ERROR,
+          "openRescCache: mmap of %s error, errno = %d", cachePath, errno);
+        close (RescCacheFd);
+        RescCacheFd = -1;
+        return (SYS_MALLOC_ERR - errno);
+    }
+    RescCache = (char *) addr;
+
+    if (writeFlag > 0) {
+        /* whatever is there is from an earlier run */
+        header = (rescCacheHeader_t *) RescCache;
+        lockRescCache (RescCacheFd, F_WRLCK);
+        if (++header->version == 0) header->version = 1;
+        header->invalid = 1;
+        lockRescCache (RescCacheFd, F_UNLCK);
+    }
+    return (0);
+}
+
+/* isRescCacheUsable - must be called with the snapshot locked */
+
+static int
+isRescCacheUsable (rescCacheHeader_t *header)
+{
+    unsigned int now = (unsigned int) time (0);
+
+    if (header->version == 0 || header->invalid != 0) return (0);
+    if (now < header->refreshTime ||
+      now - header->refreshTime > RESC_CACHE_MAX_AGE) {
+        /* the irodsServer is not refreshing it */
+        return (0);
+    }
+    return (1);
+}
+
+/* packRescCacheTbl - pack genQueryOut into buf as a rescCacheTbl_t,
+ * shrinking each column to its longest value. Returns the number of
+ * bytes used or SYS_RESC_CACHE_STALE if it does not fit in bufLen. */
+
+static int
+packRescCacheTbl (genQueryOut_t *genQueryOut, char *buf, int bufLen)
+{
+    rescCacheTbl_t *tbl;
+    char *valuePtr, *tmpStr;
+    int i, j, len, totalLen;
+
+    totalLen = RESC_CACHE_ALIGN (sizeof (rescCacheTbl_t));
+    if (totalLen > bufLen) return (SYS_RESC_CACHE_STALE);
+    tbl = (rescCacheTbl_t *) buf;
+    memset (tbl, 0, sizeof (rescCacheTbl_t));
+    if (genQueryOut == NULL) return (totalLen);    /* no rows */
+
+    tbl->attriCnt = genQueryOut->attriCnt;
+    tbl->rowCnt = genQueryOut->rowCnt;
+    for (i = 0; i < genQueryOut->attriCnt; i++) {
+        tbl->attriInx[i] = genQueryOut->sqlResult[i].attriInx;
+        len = 1;
+        for (j = 0; j < genQueryOut->rowCnt; j++) {
+            tmpStr = &genQueryOut->sqlResult[i].value[
+              genQueryOut->sqlResult[i].len * j];
+            if ((int) strlen (tmpStr) + 1 > len) len = strlen (tmpStr) + 1;
+        }
+        tbl->len[i] = len;
+        if (totalLen + len * genQueryOut->rowCnt > bufLen)
+            return (SYS_RESC_CACHE_STALE);
+        valuePtr = buf + totalLen;
+        for (j = 0; j < genQueryOut->rowCnt; j++) {
+            rstrcpy (valuePtr + len * j, &genQueryOut->sqlResult[i].value[
+              genQueryOut->sqlResult[i].len * j], len);
+        }
+        totalLen += len * genQueryOut->rowCnt;
+    }
+    return (RESC_CACHE_ALIGN (totalLen));
+}
+
+/* unpackRescCacheTbl - the reverse of packRescCacheTbl. Like rsGenQuery,
+ * returns CAT_NO_ROWS_FOUND with no genQueryOut for an empty table */
+
+static int
+unpackRescCacheTbl (char *buf, genQueryOut_t **genQueryOut)
+{
+    rescCacheTbl_t *tbl = (rescCacheTbl_t *) buf;
+    genQueryOut_t *myGenQueryOut;
+    char *valuePtr;
+    int i;
+
+    *genQueryOut = NULL;
+    if (tbl->rowCnt <= 0) return (CAT_NO_ROWS_FOUND);
+
+    myGenQueryOut = (genQueryOut_t *) malloc (sizeof (genQueryOut_t));
+    memset (myGenQueryOut, 0, sizeof (genQueryOut_t));
+    myGenQueryOut->attriCnt = tbl->attriCnt;
+    myGenQueryOut->rowCnt = tbl->rowCnt;
+    myGenQueryOut->totalRowCount = tbl->rowCnt;
+    valuePtr = buf + RESC_CACHE_ALIGN (sizeof (rescCacheTbl_t));
+    for (i = 0; i < tbl->attriCnt; i++) {
+        myGenQueryOut->sqlResult[i].attriInx = tbl->attriInx[i];
+        myGenQueryOut->sqlResult[i].len = tbl->len[i];
+        myGenQueryOut->sqlResult[i].value =
+          (char *) malloc (tbl->len[i] * tbl->rowCnt);
+        memcpy (myGenQueryOut->sqlResult[i].value, valuePtr,
+          tbl->len[i] * tbl->rowCnt);
+        valuePtr += tbl->len[i] * tbl->rowCnt;
+    }
+    *genQueryOut = myGenQueryOut;
+    return (0);
+}
+
+/* mkRescCacheHostOut - resolve the hosts in the COL_R_LOC column of the
+ * resource query and put them in a genQueryOut_t with two columns, the
+ * host addr as given and its canonical name. This is what mkServerHost
+ * would get from gethostbyname for a resource host not in the host
+ * config. */
+
+static int
+mkRescCacheHostOut (genQueryOut_t *rescOut, genQueryOut_t **hostOut)
+{
+    sqlResult_t *rescLoc;
+    genQueryOut_t *myHostOut;
+    struct hostent *hostEnt;
+    char *locStr, *addrStr, *nextStr;
+    char locBuf[LONG_NAME_LEN];
+    int i, j, maxHost;
+
+    *hostOut = NULL;
+    if (rescOut == NULL ||
+      (rescLoc = getSqlResultByInx (rescOut, COL_R_LOC)) == NULL) {
+        return (0);
+    }
+
+    /* a location can be a comma separated list of hosts */
+    maxHost = 0;
+    for (i = 0; i < rescOut->rowCnt; i++) {
+        maxHost++;
+        for (locStr = &rescLoc->value[rescLoc->len * i]; *locStr != '\0';
+          locStr++) {
+            if (*locStr == ',') maxHost++;
+        }
+    }
+    myHostOut = (genQueryOut_t *) malloc (sizeof (genQueryOut_t));
+    memset (myHostOut, 0, sizeof (genQueryOut_t));
+    myHostOut->attriCnt = 2;
+    for (j = 0; j < 2; j++) {
+        myHostOut->sqlResult[j].attriInx = j;
+        myHostOut->sqlResult[j].len = NAME_LEN;
+        myHostOut->sqlResult[j].value = (char *) malloc (NAME_LEN * maxHost);
+    }
+
+    for (i = 0; i < rescOut->rowCnt; i++) {
+        rstrcpy (locBuf, &rescLoc->value[rescLoc->len * i], LONG_NAME_LEN);
+        for (addrStr = locBuf; addrStr != NULL; addrStr = nextStr) {
+            if ((nextStr = strchr (addrStr, ',')) != NULL) *nextStr++ = '\0';
+            if (*addrStr == '\0') continue;
+            for (j = 0; j < myHostOut->rowCnt; j++) {
+                if (strcasecmp (&myHostOut->sqlResult[0].value[NAME_LEN * j],
+                  addrStr) == 0) break;
+            }
+            if (j < myHostOut->rowCnt) continue;	/* got it already */
+            if ((hostEnt = gethostbyname (addrStr)) == NULL) continue;
+            j = myHostOut->rowCnt;
+            rstrcpy (&myHostOut->sqlResult[0].value[NAME_LEN * j], addrStr,
+              NAME_LEN);
+            rstrcpy (&myHostOut->sqlResult[1].value[NAME_LEN * j],
+              hostEnt->h_name, NAME_LEN);
+            myHostOut->rowCnt++;
+        }
+    }
+    *hostOut = myHostOut;
+    return (0);
+}
+#endif	/* windows_platform */
+
+/* refreshRescCache - run the resource queries and publish the results in
+ * the snapshot. Called by the irodsServer with the catalog connected */
+
+int
+refreshRescCache (rsComm_t *rsComm)
+{
+#ifndef windows_platform
+    genQueryInp_t genQueryInp;
+    genQueryOut_t *genQueryOut[NUM_RESC_CACHE_TBL];
+    rescCacheHeader_t *header, newHeader;
+    char *buf;
+    int tblInx, len, offset;
+    int status;
+
+    if ((status = openRescCache (1)) < 0) return (status);
+    header = (rescCacheHeader_t *) RescCache;
+
+    memset (&newHeader, 0, sizeof (newHeader));
+    lockRescCache (RescCacheFd, F_RDLCK);
+    newHeader.version = header->version;
+    lockRescCache (RescCacheFd, F_UNLCK);
+
+    memset (genQueryOut, 0, sizeof (genQueryOut));
+    for (tblInx = 0; tblInx < RESC_CACHE_HOST_TBL; tblInx++) {
+        memset (&genQueryInp, 0, sizeof (genQueryInp));
+        setRescQueryInp (tblInx, &genQueryInp);
+        genQueryInp.maxRows = MAX_SQL_ROWS * 10;
+        status = rsGenQuery (rsComm, &genQueryInp, &genQueryOut[tblInx]);
+        if (status >= 0 && genQueryOut[tblInx]->continueInx > 0) {
+            /* too many rows to cache. close the query and let the
+             * agents do it in pieces */
+            rodsLog (LOG_NOTICE,
+              "refreshRescCache: too many rows for table %d", tblInx);
+            genQueryInp.continueInx = genQueryOut[tblInx]->continueInx;
+            genQueryInp.maxRows = 0;
+            freeGenQueryOut (&genQueryOut[tblInx]);
+            rsGenQuery (rsComm, &genQueryInp, &genQueryOut[tblInx]);
+            status = SYS_RESC_CACHE_STALE;
+        }
+        clearGenQueryInp (&genQueryInp);
+        if (status < 0 && status != CAT_NO_ROWS_FOUND) break;
+        status = 0;
+    }
+    if (status >= 0) {
+        status = mkRescCacheHostOut (genQueryOut[RESC_CACHE_RESC_TBL],
+          &genQueryOut[RESC_CACHE_HOST_TBL]);
+    }
+
+    buf = (char *) malloc (RESC_CACHE_SZ);
+    offset = RESC_CACHE_ALIGN (sizeof (rescCacheHeader_t));
+    for (tblInx = 0; status >= 0 && tblInx < NUM_RESC_CACHE_TBL; tblInx++) {
+        len = packRescCacheTbl (genQueryOut[tblInx], buf + offset,
+          RESC_CACHE_SZ - offset);
+        if (len < 0) {
+            rodsLog (LOG_NOTICE,
+              "refreshRescCache: table %d does not fit in the cache", tblInx);
+            status = len;
+        } else {
+            newHeader.tblOffset[tblInx] = offset;
+            offset += len;
+        }
+    }
+    for (tblInx = 0; tblInx < NUM_RESC_CACHE_TBL; tblInx++) {
+        if (genQueryOut[tblInx] != NULL) freeGenQueryOut (&genQueryOut[tblInx]);
+    }
+
+    if (status >= 0) {
+        lockRescCache (RescCacheFd, F_WRLCK);
+        if (header->version != newHeader.version) {
+            /* invalidated while we were querying. the next round will
+             * pick up the change */
+            status = SYS_RESC_CACHE_STALE;
+        } else {
+            len = RESC_CACHE_ALIGN (sizeof (rescCacheHeader_t));
+            memcpy (RescCache + len, buf + len, offset - len);
+            newHeader.refreshTime = (unsigned int) time (0);
+            if (++newHeader.version == 0) newHeader.version = 1;
+            *header = newHeader;
+        }
+        lockRescCache (RescCacheFd, F_UNLCK);
+    }
+    free (buf);
+    return (status);
+#else
+    return (SYS_RESC_CACHE_STALE);
+#endif
+}
+
+/* rescCacheWorkerTask - the irodsServer thread that keeps the snapshot
+ * current */
+
+void
+rescCacheWorkerTask ()
+{
+#ifndef windows_platform
+    rsComm_t rsComm;
+    rodsServerHost_t *rodsServerHost = NULL;
+    rescCacheHeader_t *header;
+    time_t lastRefresh = 0;
+    int invalid;
+    int status;
+
+    memset (&rsComm, 0, sizeof (rsComm));
+    status = getRodsEnv (&rsComm.myEnv);
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "rescCacheWorkerTask: getRodsEnv error, status = %d", status);
+        return;
+    }
+    setRsCommFromRodsEnv (&rsComm);
+
+    while (1) {
+        invalid = 0;
+        if (RescCache != NULL) {
+            header = (rescCacheHeader_t *) RescCache;
+            lockRescCache (RescCacheFd, F_RDLCK);
+            invalid = header->invalid;
+            lockRescCache (RescCacheFd, F_UNLCK);
+        }
+        if (RescCache == NULL || invalid != 0 ||
+          time (0) - lastRefresh >= RESC_CACHE_REFRESH_TIME) {
+#ifdef RODS_CAT
+            connectRcat (&rsComm);
+#endif
+            status = refreshRescCache (&rsComm);
+            if (status < 0 && status != SYS_RESC_CACHE_STALE) {
+                rodsLogError (LOG_ERROR, status,
+                  "rescCacheWorkerTask: refreshRescCache failed");
+            }
+            /* don't hold on to the catalog. same as initServer */
+            if (getRcatHost (MASTER_RCAT, NULL, &rodsServerHost) >= 0) {
+                if (rodsServerHost->localFlag == LOCAL_HOST) {
+#ifdef RODS_CAT
+                    disconnectRcat (&rsComm);
+#endif
+                } else if (rodsServerHost->conn != NULL) {
+                    rcDisconnect (rodsServerHost->conn);
+                    rodsServerHost->conn = NULL;
+                }
+            }
+            if (status >= 0 || lastRefresh == 0 ||
+              time (0) - lastRefresh >= RESC_CACHE_REFRESH_TIME) {
+                /* on error, retry at the next refresh time and not at
+                 * every poll */
+                lastRefresh = time (0);
+            }
+        }
+        rodsSleep (RESC_CACHE_POLL_TIME, 0);
+    }
+#endif
+}
+
+/* invalidateRescCache - called by an agent after an admin change to the
+ * resources. The agents stop using the snapshot until the irodsServer
+ * refreshes it. */
+
+int
+invalidateRescCache ()
+{
+#ifndef windows_platform
+    char cachePath[MAX_NAME_LEN];
+    rescCacheHeader_t header;
+    int fd;
+
+    getRescCachePath (cachePath);
+    if ((fd = open (cachePath, O_RDWR, 0)) < 0) return (0);
+
+    lockRescCache (fd, F_WRLCK);
+    if (pread (fd, &header, sizeof (header), 0) == sizeof (header)) {
+        if (++header.version == 0) header.version = 1;
+        header.invalid = 1;
+        if (pwrite (fd, &header, sizeof (header), 0) != sizeof (header)) {
+            rodsLog (LOG_NOTICE,
+              "invalidateRescCache: write of %s error, errno = %d",
+              cachePath, errno);
+        }
+    }
+    lockRescCache (fd, F_UNLCK);
+    close (fd);
+#endif
+    return (0);
+}
+
+/* getRescCacheQueryOut - get the table tblInx from the snapshot as a
+ * genQueryOut_t. Returns SYS_RESC_CACHE_STALE if the snapshot is
+ * missing or stale, in which case the caller should query the catalog */
+
+int
+getRescCacheQueryOut (int tblInx, genQueryOut_t **genQueryOut)
+{
+#ifndef windows_platform
+    rescCacheHeader_t *header;
+    int status;
+
+    if (tblInx < 0 || tblInx >= NUM_RESC_CACHE_TBL) return (SYS_RESC_CACHE_STALE);
+    if (openRescCache (0) < 0) return (SYS_RESC_CACHE_STALE);
+    header = (rescCacheHeader_t *) RescCache;
+
+    lockRescCache (RescCacheFd, F_RDLCK);
+    if (tblInx == RESC_CACHE_RESC_TBL) {
+        /* RescGrpInfo is about to be built, from the snapshot or not */
+        RescCacheVersion = header->version;
+    }
+    if (isRescCacheUsable (header) == 0 || header->tblOffset[tblInx] <= 0) {
+        status = SYS_RESC_CACHE_STALE;
+    } else {
+        status = unpackRescCacheTbl (RescCache + header->tblOffset[tblInx],
+          genQueryOut);
+    }
+    lockRescCache (RescCacheFd, F_UNLCK);
+    return (status);
+#else
+    return (SYS_RESC_CACHE_STALE);
+#endif
+}
+
+/* genQueryByRescCache - do the resource query genQueryInp, which is the
+ * one for table tblInx, from the snapshot if possible. The irodsServer
+ * itself always goes to the catalog */
+
+int
+genQueryByRescCache (rsComm_t *rsComm, int tblInx,
+genQueryInp_t *genQueryInp, genQueryOut_t **genQueryOut)
+{
+    int status;
+
+    if (ProcessType != SERVER_PT && genQueryInp->continueInx == 0) {
+        status = getRescCacheQueryOut (tblInx, genQueryOut);
+        if (status != SYS_RESC_CACHE_STALE) return (status);
+    }
+    return (rsGenQuery (rsComm, genQueryInp, genQueryOut));
+}
+
+/* getRescCacheHostName - get the canonical name of the resource host
+ * hostAddr as resolved by the irodsServer. hostName must be at least
+ * NAME_LEN long */
+
+int
+getRescCacheHostName (char *hostAddr, char *hostName)
+{
+#ifndef windows_platform
+    rescCacheHeader_t *header;
+    rescCacheTbl_t *tbl;
+    char *addrPtr, *namePtr;
+    int i;
+    int status = SYS_RESC_CACHE_STALE;
+
+    if (ProcessType == SERVER_PT) return (SYS_RESC_CACHE_STALE);
+    if (openRescCache (0) < 0) return (SYS_RESC_CACHE_STALE);
+    header = (rescCacheHeader_t *) RescCache;
+
+    lockRescCache (RescCacheFd, F_RDLCK);
+    if (isRescCacheUsable (header) > 0 &&
+      header->tblOffset[RESC_CACHE_HOST_TBL] > 0) {
+        tbl = (rescCacheTbl_t *) (RescCache +
+          header->tblOffset[RESC_CACHE_HOST_TBL]);
+        addrPtr = (char *) tbl + RESC_CACHE_ALIGN (sizeof (rescCacheTbl_t));
+        namePtr = addrPtr + tbl->len[0] * tbl->rowCnt;
+        for (i = 0; i < tbl->rowCnt && tbl->attriCnt == 2; i++) {
+            if (strcasecmp (addrPtr + tbl->len[0] * i, hostAddr) == 0) {
+                rstrcpy (hostName, namePtr + tbl->len[1] * i, NAME_LEN);
+                status = 0;
+                break;
+            }
+        }
+    }
+    lockRescCache (RescCacheFd, F_UNLCK);
+    return (status);
+#else
+    return (SYS_RESC_CACHE_STALE);
+#endif
+}
+
+/* rescCacheChanged - returns 1 if the snapshot has changed since this
+ * process built RescGrpInfo, 0 if not, or SYS_RESC_CACHE_STALE if the
+ * snapshot can't be used (the caller can't tell without a query) */
+
+int
+rescCacheChanged ()
+{
+#ifndef windows_platform
+    rescCacheHeader_t *header;
+    int status;
+
+    if (openRescCache (0) < 0) return (SYS_RESC_CACHE_STALE);
+    header = (rescCacheHeader_t *) RescCache;
+
+    lockRescCache (RescCacheFd, F_RDLCK);
+    if (isRescCacheUsable (header) == 0) {
+        status = SYS_RESC_CACHE_STALE;
+    } else if (header->version != RescCacheVersion) {
+        status = 1;
+    } else {
+        status = 0;
+    }
+    lockRescCache (RescCacheFd, F_UNLCK);
+    return (status);
+#else
+    return (SYS_RESC_CACHE_STALE);
+#endif
+}
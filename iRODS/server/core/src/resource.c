@@ -5,6 +5,7 @@
 #include "resource.h"
 #include "genQuery.h"
 #include "rodsClient.h"
+#include "rescCache.h"
 
 /* getRescInfo - Given the rescName or rescgrpName in condInput keyvalue
  * pair or defaultResc, return the rescGrpInfo containing the info on
@@ -436,15 +437,14 @@ sortRescByLoad (rsComm_t *rsComm, rescGrpInfo_t **rescGrpInfo)
     genQueryOut_t *genQueryOut = NULL;
     time_t timenow;
 
-    /* query the database in order to retrieve the information on the 
-     * resources' load */
+    /* query the database (or the resource cache) in order to retrieve 
+     * the information on the resources' load */
     memset(&genQueryInp, 0, sizeof (genQueryInp));
-    addInxIval(&genQueryInp.selectInp, COL_SLD_RESC_NAME, 1);
-    addInxIval(&genQueryInp.selectInp, COL_SLD_LOAD_FACTOR, 1);
-    addInxIval(&genQueryInp.selectInp, COL_SLD_CREATE_TIME, SELECT_MAX);
+    setRescQueryInp (RESC_CACHE_LOAD_TBL, &genQueryInp);
     /* XXXXX a tmp fix to increase no. of resource to 2560 */
     genQueryInp.maxRows = MAX_SQL_ROWS * 10;
-    status =  rsGenQuery(rsComm, &genQueryInp, &genQueryOut);
+    status = genQueryByRescCache (rsComm, RESC_CACHE_LOAD_TBL, &genQueryInp,
+      &genQueryOut);
     if ( status == 0 ) {
         nresc = genQueryOut->rowCnt;
         for (i=0; i<genQueryOut->attriCnt; i++) {
@@ -841,13 +841,13 @@ initRescGrp (rsComm_t *rsComm)
     /* query all resource groups */
     memset (&genQueryInp, 0, sizeof (genQueryInp_t));
 
-    addInxIval (&genQueryInp.selectInp, COL_R_RESC_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_RESC_GROUP_NAME, ORDER_BY);
+    setRescQueryInp (RESC_CACHE_GRP_TBL, &genQueryInp);
 
     /* increased to 2560 */
     genQueryInp.maxRows = MAX_SQL_ROWS * 10;
 
-    status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+    status = genQueryByRescCache (rsComm, RESC_CACHE_GRP_TBL, &genQueryInp,
+      &genQueryOut);
 
     clearGenQueryInp (&genQueryInp);
 
@@ -1123,19 +1123,7 @@ initResc (rsComm_t *rsComm)
 
     memset (&genQueryInp, 0, sizeof (genQueryInp));
 
-    addInxIval (&genQueryInp.selectInp, COL_R_RESC_ID, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_RESC_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_ZONE_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_TYPE_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_CLASS_NAME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_LOC, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_VAULT_PATH, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_FREE_SPACE, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_RESC_INFO, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_RESC_COMMENT, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_CREATE_TIME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_MODIFY_TIME, 1);
-    addInxIval (&genQueryInp.selectInp, COL_R_RESC_STATUS, 1);
+    setRescQueryInp (RESC_CACHE_RESC_TBL, &genQueryInp);
 
     genQueryInp.maxRows = MAX_SQL_ROWS;
 
@@ -1147,7 +1135,8 @@ initResc (rsComm_t *rsComm)
 
     continueInx = 1;	/* a fake one so it will do the first query */
     while (continueInx > 0) {
-        status =  rsGenQuery (rsComm, &genQueryInp, &genQueryOut);
+        status = genQueryByRescCache (rsComm, RESC_CACHE_RESC_TBL, 
+	  &genQueryInp, &genQueryOut);
 
         if (status < 0) {
             if (status !=CAT_NO_ROWS_FOUND) {
@@ -1180,6 +1169,48 @@ initResc (rsComm_t *rsComm)
     return (status);
 }
 
+/* setRescQueryInp - set up the catalog query for the resource info
+ * kept in the resource cache table tblInx. These are the queries done by
+ * initResc, initRescGrp and sortRescByLoad, and by the irodsServer 
+ * when it refreshes the cache.
+ */
+
+int
+setRescQueryInp (int tblInx, genQueryInp_t *genQueryInp)
+{
+    switch (tblInx) {
+      case RESC_CACHE_RESC_TBL:
+        addInxIval (&genQueryInp->selectInp, COL_R_RESC_ID, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_RESC_NAME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_ZONE_NAME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_TYPE_NAME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_CLASS_NAME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_LOC, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_VAULT_PATH, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_FREE_SPACE, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_RESC_INFO, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_RESC_COMMENT, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_CREATE_TIME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_MODIFY_TIME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_R_RESC_STATUS, 1);
+        break;
+      case RESC_CACHE_GRP_TBL:
+        addInxIval (&genQueryInp->selectInp, COL_R_RESC_NAME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_RESC_GROUP_NAME, ORDER_BY);
+        break;
+      case RESC_CACHE_LOAD_TBL:
+        addInxIval (&genQueryInp->selectInp, COL_SLD_RESC_NAME, 1);
+        addInxIval (&genQueryInp->selectInp, COL_SLD_LOAD_FACTOR, 1);
+        addInxIval (&genQueryInp->selectInp, COL_SLD_CREATE_TIME, SELECT_MAX);
+        break;
+      default:
+        rodsLog (LOG_ERROR,
+          "setRescQueryInp: unknown tblInx %d", tblInx);
+        return (SYS_INVALID_INPUT_PARAM);
+    }
+    return (0);
+}
+
 /* procAndQueRescResult - Process the query results from initResc ().
  * Queue the results in the global resource link list RescGrpInfo.
  */
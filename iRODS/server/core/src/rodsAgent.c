@@ -6,10 +6,14 @@
 
 #include <syslog.h>
 #include "rodsAgent.h"
+#include "rodsServer.h"	/* for the agent pool definitions */
+#include "objDesc.h"
 #include "reconstants.h"
 #include "rsApiHandler.h"
 #include "icatHighLevelRoutines.h"
 #include "miscServerFunct.h"
+#include "specColl.h"
+#include "genQuery.h"
 #ifdef windows_platform
 #include "rsLog.h"
 static void NtAgentSetEnvsFromArgs(int ac, char **av);
@@ -62,13 +66,6 @@ main(int argc, char *argv[])
 
     memset (&rsComm, 0, sizeof (rsComm));
 
-    status = initRsCommWithStartupPack (&rsComm, NULL);
-
-    if (status < 0) {
-	sendVersion (rsComm.sock, status, 0, NULL, 0);
-        cleanupAndExit (status);
-    }
-
     /* Handle option to log sql commands */
     tmpStr = getenv (SP_LOG_SQL);
     if (tmpStr != NULL) {
@@ -99,6 +96,23 @@ main(int argc, char *argv[])
 #endif
 #endif
 
+#ifndef windows_platform
+    /* a pre-forked agent gets its connections from the server over
+     * the pool sock instead of the env */
+    tmpStr = getenv (SP_AGENT_POOL_SOCK);
+    if (tmpStr != NULL) {
+	status = poolAgentMain (atoi (tmpStr), &rsComm);
+	cleanupAndExit (status);
+    }
+#endif
+
+    status = initRsCommWithStartupPack (&rsComm, NULL);
+
+    if (status < 0) {
+	sendVersion (rsComm.sock, status, 0, NULL, 0);
+        cleanupAndExit (status);
+    }
+
     status = getRodsEnv (&rsComm.myEnv);
 
     if (status < 0) {
@@ -143,6 +157,7 @@ main(int argc, char *argv[])
     /* send the server version and atatus as part of the protocol. Put
      * rsComm.reconnPort as the status */
 
+    if (rsComm.reqPipeline > 0) status |= VERSION_REQ_PIPELINE;
     status = sendVersion (rsComm.sock, status, rsComm.reconnPort,
       rsComm.reconnAddr, rsComm.cookie);
 
@@ -211,3 +226,171 @@ agentMain (rsComm_t *rsComm)
     return (status);
 }
 
+
+#ifndef windows_platform
+/* poolAgentMain - main loop of a pre-forked agent. Warm up once with 
+ * initPoolAgent, then serve one client connection at a time as handed 
+ * over by the server on poolSock, going back to the pool after the client
+ * disconnects.
+ */
+
+int
+poolAgentMain (int poolSock, rsComm_t *rsComm)
+{
+    int status;
+    int newSock;
+    int connCnt = 0;
+    int maxReuse = DEF_AGENT_POOL_MAX_REUSE;
+    char *tmpStr;
+    rodsEnv myEnv;
+    startupPack_t startupPack;
+
+    if ((tmpStr = getenv (AGENT_POOL_MAX_REUSE_KW)) != NULL) {
+	maxReuse = atoi (tmpStr);
+    }
+
+    status = getRodsEnv (&myEnv);
+    if (status < 0) {
+        rodsLog (LOG_ERROR, "poolAgentMain: getRodsEnv error, status = %d",
+	  status);
+	return (status);
+    }
+#if RODS_CAT
+    if (strstr(myEnv.rodsDebug, "CAT") != NULL) {
+       chlDebug(myEnv.rodsDebug);
+    }
+#endif
+
+    rsComm->myEnv = myEnv;
+    setRsCommFromRodsEnv (rsComm);
+    status = initPoolAgent (rsComm);
+    if (status < 0) {
+	return (status);
+    }
+
+    while (1) {
+	status = sendPoolAgentStatus (poolSock, POOL_AGENT_READY);
+	if (status < 0) break;
+
+	status = recvPoolConnReq (poolSock, &newSock, &startupPack);
+	if (status < 0) {
+	    /* the server has exited */
+	    status = 0;
+	    break;
+	}
+
+	memset (rsComm, 0, sizeof (rsComm_t));
+	rsComm->myEnv = myEnv;
+	rsComm->sock = newSock;
+	status = poolAgentConn (rsComm, &startupPack);
+	connCnt++;
+
+	/* the reconnect thread and ssl state are not reset. don't reuse */
+	if (rsComm->reconnSock > 0) break;
+#ifdef USE_SSL
+	if (rsComm->ssl != NULL) break;
+#endif
+	resetPoolAgentConn (rsComm);
+
+	if (maxReuse > 0 && connCnt >= maxReuse) {
+            rodsLog (LOG_NOTICE, 
+	      "poolAgentMain: retiring after %d connections", connCnt);
+	    break;
+	}
+    }
+    close (poolSock);
+    return (status);
+}
+
+/* poolAgentConn - serve one client connection handed over by the server.
+ * This follows the per connection part of main().
+ */
+
+int
+poolAgentConn (rsComm_t *rsComm, startupPack_t *startupPack)
+{
+    int status;
+
+    status = initRsCommWithStartupPack (rsComm, startupPack);
+    if (status < 0) {
+	sendVersion (rsComm->sock, status, 0, NULL, 0);
+	return (status);
+    }
+    /* same as the count passed thru SP_CONNECT_CNT */
+    rsComm->connectCnt = startupPack->connectCnt + 1;
+
+#ifdef RULE_ENGINE_N
+    status = initAgent (RULE_ENGINE_TRY_CACHE, rsComm);
+#else
+    status = initAgent (rsComm);
+#endif
+    if (status < 0) {
+	sendVersion (rsComm->sock, SYS_AGENT_INIT_ERR, 0, NULL, 0);
+	return (status);
+    }
+
+    initConnectControl ();
+
+    if (rsComm->clientUser.userName[0] != '\0') {
+        status = chkAllowedUser (rsComm->clientUser.userName,
+         rsComm->clientUser.rodsZone);
+
+        if (status < 0) {
+            sendVersion (rsComm->sock, status, 0, NULL, 0);
+	    return (status);
+	}
+    }
+
+    if (rsComm->reqPipeline > 0) status |= VERSION_REQ_PIPELINE;
+    status = sendVersion (rsComm->sock, status, rsComm->reconnPort,
+      rsComm->reconnAddr, rsComm->cookie);
+    if (status < 0) {
+	sendVersion (rsComm->sock, SYS_AGENT_INIT_ERR, 0, NULL, 0);
+	return (status);
+    }
+
+    logAgentProc (rsComm);
+
+    status = agentMain (rsComm);
+
+    return (status);
+}
+
+/* resetPoolAgentConn - release what the last client left behind so the
+ * agent can go back to the pool. The ICAT connection and the rule base
+ * are kept. Everything that depends on who the client was (the session
+ * ticket, the acl policy, cached special collections, open collection
+ * handles) is dropped here; initAgent sets up the rest for the next
+ * client. */
+
+int
+resetPoolAgentConn (rsComm_t *rsComm)
+{
+    int i;
+
+    if (InitialState == INITIAL_DONE) {
+	closeAllL1desc (rsComm);
+	disconnectAllSvrToSvrConn ();
+    }
+    InitialState = INITIAL_NOT_DONE;
+    for (i = 0; i < NUM_COLL_HANDLE; i++) {
+	if (CollHandle[i].inuseFlag == FD_INUSE) freeCollHandle (i);
+    }
+    freeSpecCollCache ();
+#ifdef RODS_CAT
+    chlResetSession (rsComm);
+    resetGenQueryAclPolicy ();
+#endif
+    GlobalQuotaLimit = RESC_QUOTA_UNINIT;
+    GlobalQuotaOverrun = 0;
+    RescQuotaPolicy = RESC_QUOTA_UNINIT;
+    ThisComm = NULL;
+    freeRErrorContent (&rsComm->rError);
+    if (rsComm->sock > 0) {
+	close (rsComm->sock);
+	rsComm->sock = -1;
+    }
+    rmProcLog (getpid ());
+    return (0);
+}
+#endif	/* windows_platform */
@@ -3,6 +3,7 @@
 
 #include "rodsServer.h"
 #include "resource.h"
+#include "rescCache.h"
 #include "miscServerFunct.h"
 
 #include <syslog.h>
@@ -28,6 +29,10 @@ agentProc_t *ConnReqHead = NULL;
 agentProc_t *SpawnReqHead = NULL;
 agentProc_t *BadReqHead = NULL;
 
+poolAgent_t *PoolAgentHead = NULL;
+int AgentPoolMin = 0;		/* 0 means the agent pool is off */
+int AgentPoolMax = 0;
+
 #if 0	/* defined in config.mk */
 #define USE_BOOST 
 #define USE_BOOST_COND
@@ -40,15 +45,19 @@ agentProc_t *BadReqHead = NULL;
 	#include <boost/thread/condition.hpp>
 	boost::mutex		  ConnectedAgentMutex;
 	boost::mutex		  BadReqMutex;
+	boost::mutex		  PoolAgentMutex;
 	boost::thread*		  ReadWorkerThread[NUM_READ_WORKER_THR];
 	boost::thread*		  SpawnManagerThread;
 	boost::thread*		  PurgeLockFileThread;
+	boost::thread*		  RescCacheThread;
 	#else
 	pthread_mutex_t ConnectedAgentMutex;
 	pthread_mutex_t BadReqMutex;
+	pthread_mutex_t PoolAgentMutex;
 	pthread_t       ReadWorkerThread[NUM_READ_WORKER_THR];
 	pthread_t       SpawnManagerThread;
 	pthread_t	PurgeLockFileThread;
+	pthread_t	RescCacheThread;
 	#endif
 #endif
 
@@ -285,10 +294,25 @@ serverMain (char *logDir)
     }
 #endif	/* USE_BOOST */
 #endif	/* RODS_CAT */
+#ifndef windows_platform
+#ifdef USE_BOOST
+    RescCacheThread = new boost::thread( rescCacheWorkerTask );
+#else
+    status = pthread_create(&RescCacheThread, NULL,
+          (void *(*)(void *)) rescCacheWorkerTask, (void *) NULL);
+    if (status < 0) {
+        rodsLog (LOG_ERROR,
+          "pthread_create of RescCacheThread failed, errno = %d", errno);
+    }
+#endif	/* USE_BOOST */
+#endif	/* windows_platform */
 #endif	/* SINGLE_SVR_THR */
     FD_ZERO(&sockMask);
 
     SvrSock = svrComm.sock;
+#ifndef windows_platform
+    initAgentPool ();
+#endif
     while (1) {		/* infinite loop */
         FD_SET(svrComm.sock, &sockMask);
         while ((numSock = select (svrComm.sock + 1, &sockMask, 
@@ -306,6 +330,11 @@ serverMain (char *logDir)
 	}
 
 	procChildren (&ConnectedAgentHead);
+#ifndef windows_platform
+	/* take the pool agents done with their clients off
+	 * ConnectedAgentHead before chkAgentProcCnt counts it */
+	procPoolAgentMsg ();
+#endif
 #ifdef SYS_TIMING
 	initSysTiming ("irodsServer", "recv connection", 0);
 #endif
@@ -412,7 +441,9 @@ procChildren (agentProc_t **agentProcHead)
 	      childPid, status); 
 	}
 	rmProcLog (childPid);
+	rmPoolAgentByPid (childPid);
     }
+    replenishAgentPool ();
 #endif
 
     return (0);
@@ -470,37 +501,28 @@ spawnAgent (agentProc_t *connReq, agentProc_t **agentProcHead)
     startupPack = &connReq->startupPack;
 
 #ifndef windows_platform
+    /* try an idle pre-forked agent first */
+    childPid = dispatchToPoolAgent (connReq, agentProcHead);
+    if (childPid > 0) {
+#ifdef SYS_TIMING
+	printSysTiming ("irodsServer", "dispatch to pool agent", 0);
+#endif
+	return (childPid);
+    }
+
     childPid = fork ();	/* use fork instead of vfork because of multi-thread
 			 * env */
 
     if (childPid < 0) {
 	return SYS_FORK_ERROR -errno;
     } else if (childPid == 0) {	/* child */
-	agentProc_t *tmpAgentProc;
 	close (SvrSock);
 #ifdef SYS_TIMING
         printSysTiming ("irodsAent", "after fork", 0);
         initSysTiming ("irodsAent", "after fork", 1);
 #endif
 	/* close any socket still in the queue */
-#ifndef SINGLE_SVR_THR
-	/* These queues may be inconsistent because of the multi-threading 
-         * of the parent. set sock to -1 if it has been closed */
-	tmpAgentProc = ConnReqHead;
-	while (tmpAgentProc != NULL) {
-	    if (tmpAgentProc->sock == -1) break;
-	    close (tmpAgentProc->sock);
-	    tmpAgentProc->sock = -1;
-	    tmpAgentProc = tmpAgentProc->next;
-	}
-        tmpAgentProc = SpawnReqHead;
-        while (tmpAgentProc != NULL) {
-	    if (tmpAgentProc->sock == -1) break;
-            close (tmpAgentProc->sock);
-	    tmpAgentProc->sock = -1;
-            tmpAgentProc = tmpAgentProc->next;
-        }
-#endif
+	closeQueuedConnSock ();
 	execAgent (newSock, startupPack);
     } else {			/* parent */
 #ifdef SYS_TIMING
@@ -516,6 +538,35 @@ spawnAgent (agentProc_t *connReq, agentProc_t **agentProcHead)
     return (childPid);
 }
 
+/* closeQueuedConnSock - called by a forked child of the server to close 
+ * any client socket still in the queue */
+
+int
+closeQueuedConnSock ()
+{
+#ifndef SINGLE_SVR_THR
+    agentProc_t *tmpAgentProc;
+
+    /* These queues may be inconsistent because of the multi-threading 
+     * of the parent. set sock to -1 if it has been closed */
+    tmpAgentProc = ConnReqHead;
+    while (tmpAgentProc != NULL) {
+	if (tmpAgentProc->sock == -1) break;
+	close (tmpAgentProc->sock);
+	tmpAgentProc->sock = -1;
+	tmpAgentProc = tmpAgentProc->next;
+    }
+    tmpAgentProc = SpawnReqHead;
+    while (tmpAgentProc != NULL) {
+	if (tmpAgentProc->sock == -1) break;
+        close (tmpAgentProc->sock);
+	tmpAgentProc->sock = -1;
+        tmpAgentProc = tmpAgentProc->next;
+    }
+#endif
+    return (0);
+}
+
 int
 execAgent (int newSock, startupPack_t *startupPack)
 {
@@ -995,6 +1046,7 @@ initConnThreadEnv ()
     pthread_mutex_init (&ConnectedAgentMutex, NULL);
     pthread_mutex_init (&SpawnReqCondMutex, NULL);
     pthread_mutex_init (&BadReqMutex, NULL);
+    pthread_mutex_init (&PoolAgentMutex, NULL);
     pthread_cond_init (&ReadReqCond, NULL);
     pthread_cond_init (&SpawnReqCond, NULL);
     #endif
@@ -1340,3 +1392,341 @@ purgeLockFileWorkerTask ()
     }
 }
 
+
+/* initAgentPool - read the pool size from the env and pre-fork
+ * AgentPoolMin agents */
+
+int
+initAgentPool ()
+{
+    char *tmpStr;
+    int i;
+
+    if ((tmpStr = getenv (AGENT_POOL_MIN_KW)) != NULL) {
+	AgentPoolMin = atoi (tmpStr);
+    }
+    if (AgentPoolMin <= 0) {
+	AgentPoolMin = 0;
+	return (0);
+    }
+    if ((tmpStr = getenv (AGENT_POOL_MAX_KW)) != NULL) {
+	AgentPoolMax = atoi (tmpStr);
+    }
+    if (AgentPoolMax < AgentPoolMin) AgentPoolMax = AgentPoolMin;
+
+    rodsLog (LOG_NOTICE, 
+      "initAgentPool: agent pool enabled, min = %d, max = %d",
+      AgentPoolMin, AgentPoolMax);
+
+    for (i = 0; i < AgentPoolMin; i++) {
+	if (startPoolAgent () < 0) break;
+    }
+    return (0);
+}
+
+/* startPoolAgent - fork and exec an agent which warms up and then waits
+ * for connections on its end of a socketpair */
+
+int
+startPoolAgent ()
+{
+    int childPid;
+    int sv[2];
+    poolAgent_t *poolAgent;
+    char buf[NAME_LEN];
+    char *myArgv[2];
+
+    if (socketpair (AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        rodsLog (LOG_ERROR, "startPoolAgent: socketpair error, errno = %d",
+	  errno);
+	return (SYS_SOCK_OPEN_ERR - errno);
+    }
+    /* don't leak the server end into other agents */
+    fcntl (sv[0], F_SETFD, FD_CLOEXEC);
+
+    childPid = fork ();
+    if (childPid < 0) {
+	close (sv[0]);
+	close (sv[1]);
+        rodsLog (LOG_ERROR, "startPoolAgent: fork error, errno = %d", errno);
+	return SYS_FORK_ERROR - errno;
+    } else if (childPid == 0) {	/* child */
+	close (SvrSock);
+	closeQueuedConnSock ();
+	mySetenvInt (SP_AGENT_POOL_SOCK, sv[1]);
+	mySetenvInt (SERVER_BOOT_TIME, ServerBootTime);
+	rstrcpy (buf, AGENT_EXE, NAME_LEN);
+	myArgv[0] = buf;
+	myArgv[1] = NULL;
+	execv (myArgv[0], myArgv);
+        rodsLog (LOG_ERROR, "startPoolAgent: execv error errno=%d", errno);
+	exit (1);
+    }
+
+    close (sv[1]);
+    poolAgent = (poolAgent_t *) calloc (1, sizeof (poolAgent_t));
+    poolAgent->pid = childPid;
+    poolAgent->poolSock = sv[0];
+    poolAgent->state = POOL_AGENT_STARTING;
+
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    boost::unique_lock< boost::mutex > pool_agent_lock( PoolAgentMutex );
+    #else
+    pthread_mutex_lock (&PoolAgentMutex);
+    #endif
+#endif
+    poolAgent->next = PoolAgentHead;
+    PoolAgentHead = poolAgent;
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    pool_agent_lock.unlock();
+    #else
+    pthread_mutex_unlock (&PoolAgentMutex);
+    #endif
+#endif
+    rodsLog (LOG_DEBUG, "startPoolAgent: pool agent %d started", childPid);
+
+    return (childPid);
+}
+
+/* replenishAgentPool - bring the pool back up to AgentPoolMin after 
+ * agents have exited or retired */
+
+int
+replenishAgentPool ()
+{
+    int cnt;
+
+    if (AgentPoolMin <= 0) return (0);
+
+    cnt = getPoolAgentCnt ();
+    while (cnt < AgentPoolMin) {
+	if (startPoolAgent () < 0) break;
+	cnt++;
+    }
+    return (0);
+}
+
+int
+getPoolAgentCnt ()
+{
+    poolAgent_t *tmpPoolAgent;
+    int count = 0;
+
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    boost::unique_lock< boost::mutex > pool_agent_lock( PoolAgentMutex );
+    #else
+    pthread_mutex_lock (&PoolAgentMutex);
+    #endif
+#endif
+    tmpPoolAgent = PoolAgentHead;
+    while (tmpPoolAgent != NULL) {
+	count++;
+	tmpPoolAgent = tmpPoolAgent->next;
+    }
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    pool_agent_lock.unlock();
+    #else
+    pthread_mutex_unlock (&PoolAgentMutex);
+    #endif
+#endif
+    return count;
+}
+
+/* _procPoolAgentMsg - collect the ready messages from the pool agents. 
+ * A busy agent that reports ready has finished with its client (rcDisconnect)
+ * and is taken off the ConnectedAgentHead queue. PoolAgentMutex must be
+ * held by the caller. */
+
+static int
+_procPoolAgentMsg ()
+{
+    poolAgent_t *tmpPoolAgent;
+    agentProc_t *tmpAgentProc;
+    fd_set poolMask;
+    struct timeval tv;
+    int maxSock = -1;
+    int agentStatus;
+    int status;
+
+    FD_ZERO (&poolMask);
+    tmpPoolAgent = PoolAgentHead;
+    while (tmpPoolAgent != NULL) {
+	if (tmpPoolAgent->state == POOL_AGENT_STARTING ||
+	  tmpPoolAgent->state == POOL_AGENT_BUSY) {
+	    FD_SET (tmpPoolAgent->poolSock, &poolMask);
+	    if (tmpPoolAgent->poolSock > maxSock) 
+		maxSock = tmpPoolAgent->poolSock;
+	}
+	tmpPoolAgent = tmpPoolAgent->next;
+    }
+    if (maxSock < 0) return (0);
+
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    status = select (maxSock + 1, &poolMask, NULL, NULL, &tv);
+    if (status <= 0) return (0);
+
+    tmpPoolAgent = PoolAgentHead;
+    while (tmpPoolAgent != NULL) {
+	if (tmpPoolAgent->state != POOL_AGENT_DEAD && 
+	  FD_ISSET (tmpPoolAgent->poolSock, &poolMask)) {
+	    status = read (tmpPoolAgent->poolSock, &agentStatus, sizeof (int));
+	    if (tmpPoolAgent->state == POOL_AGENT_BUSY) {
+		/* done with the client either way */
+		tmpAgentProc = getAgentProcByPid (tmpPoolAgent->pid, 
+		  &ConnectedAgentHead);
+		if (tmpAgentProc != NULL) free (tmpAgentProc);
+	    }
+	    if (status == (int) sizeof (int) && 
+	      agentStatus == POOL_AGENT_READY) {
+		tmpPoolAgent->state = POOL_AGENT_IDLE;
+	    } else {
+		/* retired or died. procChildren will reap it */
+		close (tmpPoolAgent->poolSock);
+		tmpPoolAgent->poolSock = -1;
+		tmpPoolAgent->state = POOL_AGENT_DEAD;
+	    }
+	}
+	tmpPoolAgent = tmpPoolAgent->next;
+    }
+    return (0);
+}
+
+int
+procPoolAgentMsg ()
+{
+    int status;
+
+    if (AgentPoolMin <= 0) return (0);
+
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    boost::unique_lock< boost::mutex > pool_agent_lock( PoolAgentMutex );
+    #else
+    pthread_mutex_lock (&PoolAgentMutex);
+    #endif
+#endif
+    status = _procPoolAgentMsg ();
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    pool_agent_lock.unlock();
+    #else
+    pthread_mutex_unlock (&PoolAgentMutex);
+    #endif
+#endif
+    return (status);
+}
+
+/* dispatchToPoolAgent - hand connReq to an idle pool agent.
+ * Returns the pid of the agent, or 0 if no agent is idle, in which case
+ * the caller should fork a new agent the old way. The pool is grown 
+ * (up to AgentPoolMax) for the next request. connReq is queued in
+ * agentProcHead before the agent gets the socket and while 
+ * PoolAgentMutex is held, so that _procPoolAgentMsg always finds it when
+ * the agent reports ready. */
+
+int
+dispatchToPoolAgent (agentProc_t *connReq, agentProc_t **agentProcHead)
+{
+    poolAgent_t *tmpPoolAgent;
+    int poolCnt = 0;
+    int childPid = 0;
+    int status;
+
+    if (AgentPoolMin <= 0 || connReq == NULL) return (0);
+
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    boost::unique_lock< boost::mutex > pool_agent_lock( PoolAgentMutex );
+    #else
+    pthread_mutex_lock (&PoolAgentMutex);
+    #endif
+#endif
+    _procPoolAgentMsg ();
+
+    tmpPoolAgent = PoolAgentHead;
+    while (tmpPoolAgent != NULL) {
+	poolCnt++;
+	if (childPid == 0 && tmpPoolAgent->state == POOL_AGENT_IDLE) {
+	    queConnectedAgentProc (tmpPoolAgent->pid, connReq, agentProcHead);
+	    status = sendPoolConnReq (tmpPoolAgent->poolSock, connReq->sock,
+	      &connReq->startupPack);
+	    if (status < 0) {
+		/* take it off again, the caller will fork an agent for it */
+		getAgentProcByPid (tmpPoolAgent->pid, agentProcHead);
+		connReq->pid = 0;
+		close (tmpPoolAgent->poolSock);
+		tmpPoolAgent->poolSock = -1;
+		tmpPoolAgent->state = POOL_AGENT_DEAD;
+	    } else {
+		tmpPoolAgent->state = POOL_AGENT_BUSY;
+		tmpPoolAgent->connCnt++;
+		childPid = tmpPoolAgent->pid;
+	    }
+	}
+	tmpPoolAgent = tmpPoolAgent->next;
+    }
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    pool_agent_lock.unlock();
+    #else
+    pthread_mutex_unlock (&PoolAgentMutex);
+    #endif
+#endif
+
+    if (childPid == 0 && poolCnt < AgentPoolMax) {
+	startPoolAgent ();
+    }
+    return (childPid);
+}
+
+/* rmPoolAgentByPid - remove an exited agent from the pool. Returns 1
+ * if childPid was a pool agent */
+
+int
+rmPoolAgentByPid (int childPid)
+{
+    poolAgent_t *tmpPoolAgent, *prevPoolAgent = NULL;
+
+    if (AgentPoolMin <= 0) return (0);
+
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    boost::unique_lock< boost::mutex > pool_agent_lock( PoolAgentMutex );
+    #else
+    pthread_mutex_lock (&PoolAgentMutex);
+    #endif
+#endif
+    tmpPoolAgent = PoolAgentHead;
+    while (tmpPoolAgent != NULL) {
+	if (tmpPoolAgent->pid == childPid) {
+	    if (prevPoolAgent == NULL) {
+		PoolAgentHead = tmpPoolAgent->next;
+	    } else {
+		prevPoolAgent->next = tmpPoolAgent->next;
+	    }
+	    break;
+	}
+	prevPoolAgent = tmpPoolAgent;
+	tmpPoolAgent = tmpPoolAgent->next;
+    }
+#ifndef SINGLE_SVR_THR
+    #ifdef USE_BOOST
+    pool_agent_lock.unlock();
+    #else
+    pthread_mutex_unlock (&PoolAgentMutex);
+    #endif
+#endif
+
+    if (tmpPoolAgent == NULL) return (0);
+
+    rodsLog (LOG_NOTICE, "Pool agent %d exited after %d connections",
+      childPid, tmpPoolAgent->connCnt);
+    if (tmpPoolAgent->poolSock >= 0) close (tmpPoolAgent->poolSock);
+    free (tmpPoolAgent);
+    return (1);
+}
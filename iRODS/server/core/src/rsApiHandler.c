@@ -12,6 +12,7 @@
 #include "regReplica.h"
 #include "unregDataObj.h"
 #include "modAVUMetadata.h"
+#include "bulkAVUMetadata.h"
 
 #ifdef USE_BOOST
 #include <boost/thread.hpp>
@@ -45,6 +46,7 @@ bytesBuf_t *bsBBuf)
     int retVal = 0;
     int numArg = 0;
     void *myArgv[4];
+    char replyType[HEADER_TYPE_LEN];
     
     memset (&myOutBsBBuf, 0, sizeof (bytesBuf_t));
     memset (&rsComm->rError, 0, sizeof (rError_t));
@@ -54,13 +56,14 @@ bytesBuf_t *bsBBuf)
 	rodsLog (LOG_ERROR,
 	  "rsApiHandler: apiTableLookup of apiNumber %d failed", apiNumber);
 	/* cannot use sendApiReply because it does not know apiInx */
+	getApiReplyType (rsComm, replyType);
 #ifdef USE_SSL
         if (rsComm->ssl_on)
-            sslSendRodsMsg (rsComm->sock, RODS_API_REPLY_T, NULL, NULL, NULL,
+            sslSendRodsMsg (rsComm->sock, replyType, NULL, NULL, NULL,
                             apiInx, rsComm->irodsProt, rsComm->ssl);
         else
 #endif
-            sendRodsMsg (rsComm->sock, RODS_API_REPLY_T, NULL, NULL, NULL,
+            sendRodsMsg (rsComm->sock, replyType, NULL, NULL, NULL,
                          apiInx, rsComm->irodsProt);
 	return (apiInx);
     }
@@ -193,6 +196,9 @@ bytesBuf_t *bsBBuf)
         } else if (strcmp (RsApiTable[apiInx].inPackInstruct,
 	  "ModAVUMetadataInp_PI")  == 0) {
 	    clearModAVUMetadataInp ((modAVUMetadataInp_t *) myInStruct);
+        } else if (strcmp (RsApiTable[apiInx].inPackInstruct,
+	  "BulkAVUMetadataInp_PI")  == 0) {
+	    clearBulkAVUMetadataInp ((bulkAVUMetadataInp_t *) myInStruct);
         } else if (strcmp (RsApiTable[apiInx].inPackInstruct, 
  	     "authResponseInp_PI")  == 0) {
             /* Added by RAJA Nov 22 2010 */
@@ -220,6 +226,7 @@ bytesBuf_t *bsBBuf)
         status = sendAndProcApiReply 
 	  (rsComm, apiInx, retVal, myOutStruct, &myOutBsBBuf);
     }
+    logAgentDescHwm ();
 
     if (retVal >= 0 && status < 0) {
 	return (status);
@@ -263,11 +270,14 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
     bytesBuf_t *myOutStructBBuf;
     bytesBuf_t *rErrorBBuf = NULL;
     bytesBuf_t *myRErrorBBuf;
+    char replyType[HEADER_TYPE_LEN];
 
 //#ifndef windows_platform
     svrChkReconnAtSendStart (rsComm);
 //#endif
 
+    getApiReplyType (rsComm, replyType);
+
     if (retVal == SYS_HANDLER_DONE_NO_ERROR) {
 	/* not actually an error */
 	retVal = 0;
@@ -284,11 +294,11 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
              "sendApiReply: packStruct error, status = %d", status);
 #ifdef USE_SSL
             if (rsComm->ssl_on) 
-                sslSendRodsMsg (rsComm->sock, RODS_API_REPLY_T, NULL,
+                sslSendRodsMsg (rsComm->sock, replyType, NULL,
                              NULL, NULL, status, rsComm->irodsProt, rsComm->ssl);
             else
 #endif
-                sendRodsMsg (rsComm->sock, RODS_API_REPLY_T, NULL,
+                sendRodsMsg (rsComm->sock, replyType, NULL,
                              NULL, NULL, status, rsComm->irodsProt);
 //#ifndef windows_platform
             svrChkReconnAtSendEnd (rsComm);
@@ -314,11 +324,11 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
              "sendApiReply: packStruct error, status = %d", status);
 #ifdef USE_SSL
             if (rsComm->ssl_on) 
-                sslSendRodsMsg (rsComm->sock, RODS_API_REPLY_T, NULL,
+                sslSendRodsMsg (rsComm->sock, replyType, NULL,
                              NULL, NULL, status, rsComm->irodsProt, rsComm->ssl);
             else
 #endif
-                sendRodsMsg (rsComm->sock, RODS_API_REPLY_T, NULL,
+                sendRodsMsg (rsComm->sock, replyType, NULL,
                              NULL, NULL, status, rsComm->irodsProt);
 //#ifndef windows_platform
             svrChkReconnAtSendEnd (rsComm);
@@ -333,11 +343,11 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
 
 #ifdef USE_SSL
     if (rsComm->ssl_on) 
-        status = sslSendRodsMsg (rsComm->sock, RODS_API_REPLY_T, myOutStructBBuf,
+        status = sslSendRodsMsg (rsComm->sock, replyType, myOutStructBBuf,
                               myOutBsBBuf, myRErrorBBuf, retVal, rsComm->irodsProt, rsComm->ssl);
     else
 #endif
-        status = sendRodsMsg (rsComm->sock, RODS_API_REPLY_T, myOutStructBBuf,
+        status = sendRodsMsg (rsComm->sock, replyType, myOutStructBBuf,
                               myOutBsBBuf, myRErrorBBuf, retVal, rsComm->irodsProt);
 	
     if (status < 0) {
@@ -368,12 +378,12 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
                   "sendApiReply: Switch connection and retry sendRodsMsg");
 #ifdef USE_SSL
                 if (rsComm->ssl_on) 
-                    status = sslSendRodsMsg (rsComm->sock, RODS_API_REPLY_T, 
+                    status = sslSendRodsMsg (rsComm->sock, replyType, 
                                           myOutStructBBuf, myOutBsBBuf, myRErrorBBuf, retVal, 
                                           rsComm->irodsProt, rsComm->ssl);
                 else
 #endif
-                    status = sendRodsMsg (rsComm->sock, RODS_API_REPLY_T, 
+                    status = sendRodsMsg (rsComm->sock, replyType, 
                                           myOutStructBBuf, myOutBsBBuf, myRErrorBBuf, retVal, 
                                           rsComm->irodsProt);
 	        if (status >= 0) {
@@ -397,6 +407,61 @@ void *myOutStruct, bytesBuf_t *myOutBsBBuf)
     return (status);
 }
 
+/* getApiReplyType - put the msg type of the reply to the current request
+ * in replyType, which is HEADER_TYPE_LEN long. The reply to a pipelined
+ * request is tagged with its request ID.
+ */
+char *
+getApiReplyType (rsComm_t *rsComm, char *replyType)
+{
+    if (rsComm->reqPipeline > 0 && rsComm->curReqId >= 0) {
+	setReqPipeMsgType (replyType, RODS_API_PREPLY_T, rsComm->curReqId);
+    } else {
+	rstrcpy (replyType, RODS_API_REPLY_T, HEADER_TYPE_LEN);
+    }
+    return (replyType);
+}
+
+/* setReqPipeCork - in the pipelined mode, hold back the replies with 
+ * TCP_CORK while more requests are already waiting to be read so that
+ * they go out in full packets, and let them go as soon as there are none.
+ */
+int
+setReqPipeCork (rsComm_t *rsComm)
+{
+#ifdef TCP_CORK
+    fd_set readFds;
+    struct timeval tv;
+    int morePending;
+    int status;
+
+    if (rsComm->reqPipeline <= 0 || rsComm->reqPipeNoCork > 0) return (0);
+#ifdef USE_SSL
+    /* the data may be buffered by ssl. Don't bother */
+    if (rsComm->ssl_on) return (0);
+#endif
+
+    FD_ZERO (&readFds);
+    FD_SET (rsComm->sock, &readFds);
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    morePending = select (rsComm->sock + 1, &readFds, NULL, NULL, &tv) > 0;
+
+    if (morePending != rsComm->reqPipeCorked) {
+        status = setsockopt (rsComm->sock, IPPROTO_TCP, TCP_CORK,
+	  &morePending, sizeof (morePending));
+	if (status < 0) {
+	    /* just stop corking. The replies are still tagged since the
+	     * client was told the pipelined mode is on */
+	    rsComm->reqPipeNoCork = 1;
+	    return (0);
+	}
+	rsComm->reqPipeCorked = morePending;
+    }
+#endif
+    return (0);
+}
+
 int
 chkApiVersion (rsComm_t *rsComm, int apiInx)
 {
@@ -489,6 +554,7 @@ int
 readAndProcClientMsg (rsComm_t *rsComm, int flags)
 {
     int status = 0;
+    int reqId;
     msgHeader_t myHeader;
     bytesBuf_t inputStructBBuf, bsBBuf, errorBBuf;
 
@@ -640,6 +706,15 @@ readAndProcClientMsg (rsComm_t *rsComm, int flags)
     /* handler switch by msg type */
 
     if (strcmp (myHeader.type, RODS_API_REQ_T) == 0) {
+	rsComm->curReqId = -1;
+    } else if (rsComm->reqPipeline > 0 &&
+      (reqId = getReqPipeMsgId (myHeader.type, RODS_API_PREQ_T)) >= 0) {
+	rsComm->curReqId = reqId;
+	rstrcpy (myHeader.type, RODS_API_REQ_T, HEADER_TYPE_LEN);
+    }
+
+    if (strcmp (myHeader.type, RODS_API_REQ_T) == 0) {
+	setReqPipeCork (rsComm);
         status = rsApiHandler (rsComm, myHeader.intInfo, &inputStructBBuf,
           &bsBBuf);
 #ifdef SYS_TIMING
@@ -213,6 +213,23 @@ queueSpecCollCacheWithObjStat (rodsObjStat_t *rodsObjStatOut)
 
 }
 
+/* freeSpecCollCache - free the special collections cached for the
+ * current client. Called before a pool agent serves another client */
+int
+freeSpecCollCache ()
+{
+    specCollCache_t *tmpSpecCollCache;
+
+    while (SpecCollCacheHead != NULL) {
+	tmpSpecCollCache = SpecCollCacheHead;
+	SpecCollCacheHead = tmpSpecCollCache->next;
+	free (tmpSpecCollCache);
+    }
+    HaveFailedSpecCollPath = 0;
+    *FailedSpecCollPath = '\0';
+    return 0;
+}
+
 specCollCache_t *
 matchSpecCollCache (char *objPath)
 {
@@ -0,0 +1,329 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* xferHist.c - the per host transfer history used by the adaptive
+ * transfer mode. The history is a fixed size table of xferHist_t in the
+ * file XFER_HIST_FILE_NAME in the log dir. It is mmap'ed by each agent
+ * and updated under a fcntl lock so that all agents on this server share
+ * it.
+ */
+
+#ifndef windows_platform
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <netinet/tcp.h>
+#endif
+#include "xferHist.h"
+#include "sockComm.h"
+#include "rsGlobalExtern.h"
+
+#ifndef windows_platform
+static xferHist_t *XferHist = NULL;
+static int XferHistFd = -1;
+
+static int
+lockXferHist (int lockType)
+{
+    struct flock myLock;
+
+    memset (&myLock, 0, sizeof (myLock));
+    myLock.l_type = lockType;
+    myLock.l_whence = SEEK_SET;
+    while (fcntl (XferHistFd, F_SETLKW, &myLock) < 0) {
+        if (errno != EINTR) {
+            return (SYS_FS_LOCK_ERR - errno);
+        }
+    }
+    return (0);
+}
+
+static int
+openXferHist ()
+{
+    char histPath[MAX_NAME_LEN];
+    struct stat statbuf;
+    off_t histSize = NUM_XFER_HIST_HOST * sizeof (xferHist_t);
+    void *addr;
+
+    if (XferHist != NULL) return (0);
+
+    snprintf (histPath, MAX_NAME_LEN, "%s/%s", getLogDir (),
+      XFER_HIST_FILE_NAME);
+    XferHistFd = open (histPath, O_RDWR | O_CREAT, 0600);
+    if (XferHistFd < 0) {
+        rodsLog (LOG_ERROR,
+          "openXferHist: open of %s error, errno = %d", histPath, errno);
+        return (UNIX_FILE_OPEN_ERR - errno);
+    }
+
+    lockXferHist (F_WRLCK);
+    if (fstat (XferHistFd, &statbuf) < 0 || statbuf.st_size != histSize) {
+        /* new, or written with a different xferHist_t. start over */
+        if (ftruncate (XferHistFd, 0) < 0 ||
+          ftruncate (XferHistFd, histSize) < 0) {
+            rodsLog (LOG_ERROR,
+              "openXferHist: ftruncate of %s error, errno = %d",
+              histPath, errno);
+            lockXferHist (F_UNLCK);
+            close (XferHistFd);
+            XferHistFd = -1;
+            return (UNIX_FILE_TRUNCATE_ERR - errno);
+        }
+    }
+    lockXferHist (F_UNLCK);
+
+    addr = mmap (NULL, histSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+      XferHistFd, 0);
+    if (addr == MAP_FAILED) {
+        rodsLog (LOG_ERROR,
+          "openXferHist: mmap of %s error, errno = %d", histPath, errno);
+        close (XferHistFd);
+        XferHistFd = -1;
+        return (SYS_MALLOC_ERR - errno);
+    }
+    XferHist = (xferHist_t *) addr;
+
+    return (0);
+}
+
+/* findXferHist - find the history of hostAddr. If it is not there (or
+ * too old) and createFlag is set, take over the least recently updated
+ * entry. Must be called with the history locked, for write if createFlag
+ * is set. */
+
+static xferHist_t *
+findXferHist (char *hostAddr, int createFlag)
+{
+    int i;
+    xferHist_t *oldest = NULL;
+    unsigned int now = (unsigned int) time (0);
+
+    for (i = 0; i < NUM_XFER_HIST_HOST; i++) {
+        if (strcmp (XferHist[i].hostAddr, hostAddr) == 0) {
+            if (now - XferHist[i].lastUpdate > XFER_HIST_MAX_AGE) {
+                /* too old to go by */
+                if (createFlag == 0) return (NULL);
+                memset (&XferHist[i], 0, sizeof (xferHist_t));
+                rstrcpy (XferHist[i].hostAddr, hostAddr, NAME_LEN);
+                XferHist[i].lastUpdate = now;
+            }
+            return (&XferHist[i]);
+        }
+        if (oldest == NULL || XferHist[i].lastUpdate < oldest->lastUpdate) {
+            oldest = &XferHist[i];
+        }
+    }
+    if (createFlag == 0) return (NULL);
+
+    memset (oldest, 0, sizeof (xferHist_t));
+    rstrcpy (oldest->hostAddr, hostAddr, NAME_LEN);
+    oldest->lastUpdate = now;
+    return (oldest);
+}
+
+static int
+getXferHistBucket (int numThreads)
+{
+    int bucket = 0;
+
+    while (numThreads > 1 && bucket < NUM_XFER_HIST_BUCKET - 1) {
+        numThreads >>= 1;
+        bucket++;
+    }
+    return (bucket);
+}
+#endif	/* windows_platform */
+
+/* getAdaptiveXferMaxThr - returns the max number of threads for the
+ * adaptive transfer mode, or 0 if the mode is off */
+
+int
+getAdaptiveXferMaxThr ()
+{
+    char *tmpStr;
+    int maxThr;
+
+#ifdef windows_platform
+    return (0);
+#else
+    if ((tmpStr = getenv (ADAPTIVE_XFER_KW)) == NULL) return (0);
+    maxThr = atoi (tmpStr);
+    if (maxThr <= 0) return (0);
+    if (maxThr > MAX_NUM_CONFIG_TRAN_THR) maxThr = MAX_NUM_CONFIG_TRAN_THR;
+    return (maxThr);
+#endif
+}
+
+/* getSockRtt - returns the smoothed rtt of a connected tcp socket in
+ * usec, or -1 if it cannot be had */
+
+int
+getSockRtt (int sock)
+{
+#if defined(linux_platform) && defined(TCP_INFO)
+    struct tcp_info tcpInfo;
+    socklen_t len = sizeof (tcpInfo);
+
+    if (sock < 0 ||
+      getsockopt (sock, IPPROTO_TCP, TCP_INFO, &tcpInfo, &len) < 0) {
+        return (-1);
+    }
+    return ((int) tcpInfo.tcpi_rtt);
+#else
+    return (-1);
+#endif
+}
+
+/* chooseAdaptiveXfer - choose the number of threads and the socket window
+ * size for a transfer of dataSize bytes with the client of rsComm.
+ * numThreads is what acSetNumThreads gave. The thread count with the best
+ * rate so far for the host is used, except that the next larger (or
+ * smaller) count is tried once the best has enough samples and the
+ * neighbor none. The window is set to twice the bandwidth-delay product
+ * of one stream. Returns the number of threads. */
+
+int
+chooseAdaptiveXfer (rsComm_t *rsComm, rodsLong_t dataSize, int numThreads,
+int *windowSize, int *rttUsec)
+{
+#ifdef windows_platform
+    return (numThreads);
+#else
+    int maxThr, sizeThr, myThr, bucket;
+    int best = -1;
+    double expectRate = 0.0;
+    char *hostAddr;
+    xferHist_t *xferHist;
+    xferHist_t myHist;
+
+    *windowSize = rsComm->windowSize;
+    *rttUsec = getSockRtt (rsComm->sock);
+
+    if ((maxThr = getAdaptiveXferMaxThr ()) <= 0 || numThreads <= 0)
+        return (numThreads);
+
+    /* small files get fewer streams */
+    sizeThr = dataSize / ADAPTIVE_MIN_SZ_PER_THR;
+    if (sizeThr < 1) sizeThr = 1;
+    if (maxThr > sizeThr) maxThr = sizeThr;
+
+    hostAddr = rods_inet_ntoa (rsComm->remoteAddr.sin_addr);
+    if (openXferHist () < 0 || hostAddr == NULL) {
+        return (numThreads < maxThr ? numThreads : maxThr);
+    }
+
+    lockXferHist (F_RDLCK);
+    if ((xferHist = findXferHist (hostAddr, 0)) != NULL) {
+        myHist = *xferHist;
+    } else {
+        memset (&myHist, 0, sizeof (myHist));
+    }
+    lockXferHist (F_UNLCK);
+
+    if (*rttUsec < 0) *rttUsec = myHist.rttUsec;
+
+    for (bucket = 0; bucket < NUM_XFER_HIST_BUCKET; bucket++) {
+        if ((1 << bucket) > maxThr) break;
+        if (myHist.bucketCnt[bucket] > 0 && (best < 0 ||
+          myHist.bucketRate[bucket] > myHist.bucketRate[best])) {
+            best = bucket;
+        }
+    }
+
+    if (best < 0) {
+        /* nothing to go by. start wide on a long link */
+        if (*rttUsec >= WAN_RTT_USEC) {
+            myThr = maxThr;
+            *windowSize = MAX_SOCK_WINDOW_SIZE;
+        } else {
+            myThr = numThreads < maxThr ? numThreads : maxThr;
+        }
+    } else {
+        myThr = 1 << best;
+        expectRate = myHist.bucketRate[best];
+        if (*rttUsec > 0) {
+            double bdp = expectRate / myThr * *rttUsec / 1000000.0;
+            if (2 * bdp > MAX_SOCK_WINDOW_SIZE) {
+                *windowSize = MAX_SOCK_WINDOW_SIZE;
+            } else if (2 * bdp > SOCK_WINDOW_SIZE) {
+                *windowSize = (int) (2 * bdp);
+            } else {
+                *windowSize = SOCK_WINDOW_SIZE;
+            }
+        }
+        if (myHist.bucketCnt[best] >= XFER_HIST_MIN_SAMPLES) {
+            /* probe a neighbor that has not been tried */
+            if (best + 1 < NUM_XFER_HIST_BUCKET &&
+              (1 << (best + 1)) <= maxThr &&
+              myHist.bucketCnt[best + 1] == 0) {
+                myThr = 1 << (best + 1);
+            } else if (best > 0 && myHist.bucketCnt[best - 1] == 0) {
+                myThr = 1 << (best - 1);
+            }
+        }
+    }
+
+    rodsLog (LOG_NOTICE,
+      "chooseAdaptiveXfer: host %s, rtt %d us, size %lld, %d threads (policy %d), window %d, expected %.1f MB/s",
+      hostAddr, *rttUsec, dataSize, myThr, numThreads, *windowSize,
+      expectRate / (1024 * 1024));
+
+    return (myThr);
+#endif
+}
+
+/* recordAdaptiveXfer - add the rate of a finished transfer to the history
+ * of the client of rsComm */
+
+int
+recordAdaptiveXfer (rsComm_t *rsComm, int numThreads, int windowSize,
+int rttUsec, rodsLong_t bytesTransferred, float elapsed)
+{
+#ifdef windows_platform
+    return (0);
+#else
+    char *hostAddr;
+    xferHist_t *xferHist;
+    int bucket, status;
+    double rate;
+
+    if (numThreads <= 0 || elapsed <= 0.0 ||
+      bytesTransferred < ADAPTIVE_MIN_SZ_PER_THR) {
+        /* too small to say much about the link */
+        return (0);
+    }
+
+    hostAddr = rods_inet_ntoa (rsComm->remoteAddr.sin_addr);
+    if (hostAddr == NULL) return (0);
+    if ((status = openXferHist ()) < 0) return (status);
+
+    rate = bytesTransferred / elapsed;
+    bucket = getXferHistBucket (numThreads);
+
+    lockXferHist (F_WRLCK);
+    xferHist = findXferHist (hostAddr, 1);
+    if (xferHist->bucketCnt[bucket] == 0) {
+        xferHist->bucketRate[bucket] = rate;
+    } else {
+        xferHist->bucketRate[bucket] =
+          0.75 * xferHist->bucketRate[bucket] + 0.25 * rate;
+    }
+    xferHist->bucketCnt[bucket]++;
+    if (rttUsec > 0) {
+        if (xferHist->rttUsec <= 0) {
+            xferHist->rttUsec = rttUsec;
+        } else {
+            xferHist->rttUsec = (3 * xferHist->rttUsec + rttUsec) / 4;
+        }
+    }
+    xferHist->lastUpdate = (unsigned int) time (0);
+    lockXferHist (F_UNLCK);
+
+    rodsLog (LOG_NOTICE,
+      "recordAdaptiveXfer: host %s, %d threads, window %d, %lld bytes in %.3f sec, %.1f MB/s",
+      hostAddr, numThreads, windowSize, bytesTransferred, elapsed,
+      rate / (1024 * 1024));
+
+    return (0);
+#endif
+}
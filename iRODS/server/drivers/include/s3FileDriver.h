@@ -52,9 +52,41 @@
 #include "rcConnect.h"
 #include "msParam.h"
 #include "libs3.h"
+#ifdef PARA_OPR
+#include <pthread.h>
+#endif
 
 #define S3_AUTH_FILE "s3Auth"
 
+/* libs3 1.4 (libs3_3_1_4) has no multipart API. With libs3 2.0, files
+ * larger than the part size are moved in parts by a pool of threads */
+#ifndef libs3_3_1_4
+#define S3_MULTIPART
+#endif
+
+#define S3_DEF_MPU_CHUNK_SZ	(64*1024*1024)	/* the part size */
+#define S3_MIN_MPU_CHUNK_SZ	(5*1024*1024)	/* the S3 min, except the last */
+#define S3_MAX_MPU_CHUNK_SZ	(1024*1024*1024) /* the part length is an int */
+#define S3_MAX_MPU_PARTS	10000		/* the S3 max */
+#define S3_DEF_MPU_THREADS	8
+#define S3_MAX_MPU_THREADS	32
+#define S3_DEF_RETRY_CNT	3	/* retries of a failed part */
+#define S3_RETRY_WAIT_SEC	1	/* doubled after each retry */
+
+/* env variables overriding the defaults. S3_DEFAULT_HOSTNAME and
+ * S3_PROTOCOL point the driver at an S3 compatible server other than
+ * Amazon, e.g. a local stand-in for testing */
+#define S3_MPU_CHUNK_ENV	"S3_MPU_CHUNK"		/* part size in MB */
+#define S3_MPU_THREADS_ENV	"S3_MPU_THREADS"
+#define S3_RETRY_COUNT_ENV	"S3_RETRY_COUNT"
+#define S3_HOSTNAME_ENV		"S3_DEFAULT_HOSTNAME"
+#define S3_PROTOCOL_ENV		"S3_PROTOCOL"		/* http or https */
+
+/* the oprType of a multipart transfer */
+#define S3_MPU_PUT	0	/* multipart upload of a file */
+#define S3_MPU_GET	1	/* ranged GETs into a file */
+#define S3_MPU_COPY	2	/* multipart copy between objects */
+
 typedef struct S3Auth {
   char accessKeyId[MAX_NAME_LEN];
   char secretAccessKey[MAX_NAME_LEN];
@@ -79,6 +111,52 @@ typedef struct callback_data
     int status;
 } callback_data_t;
 
+typedef struct s3Config {
+    rodsLong_t mpuChunkSize;
+    int mpuThreads;
+    int retryCnt;
+    S3Protocol protocol;
+    char hostName[MAX_NAME_LEN];
+} s3Config_t;
+
+/* one part of a multipart transfer */
+typedef struct s3Part {
+    int partNum;		/* starts from 1 */
+    rodsLong_t offset;
+    rodsLong_t size;
+    char eTag[NAME_LEN];	/* returned by the upload of the part */
+    int status;
+} s3Part_t;
+
+/* a multipart transfer. The parts are taken in turn by the threads */
+typedef struct s3Mpu {
+    int oprType;
+    int fd;			/* the local file, -1 for S3_MPU_COPY */
+    char bucket[MAX_NAME_LEN];
+    char key[MAX_NAME_LEN];
+    char srcBucket[MAX_NAME_LEN];	/* S3_MPU_COPY only */
+    char srcKey[MAX_NAME_LEN];
+    char uploadId[MAX_NAME_LEN];
+    s3Part_t *parts;
+    int numParts;
+    int nextPart;		/* the next part to be taken */
+    int status;			/* the first error */
+    char *commitXml;		/* the body of the complete request */
+#ifdef PARA_OPR
+    pthread_mutex_t lock;
+#endif
+} s3Mpu_t;
+
+/* the callbackData of the requests of a multipart transfer */
+typedef struct s3MpuCallback {
+    s3Mpu_t *mpu;
+    s3Part_t *part;		/* NULL if not a part request */
+    rodsLong_t offset;		/* of the next byte of the part */
+    rodsLong_t bytesLeft;
+    char *xml;			/* the unsent commitXml */
+    int status;			/* the S3Status of the request */
+} s3MpuCallback_t;
+
 int
 s3FileUnlink (rsComm_t *rsComm, char *filename);
 int
@@ -134,4 +212,17 @@ S3Status
 getObjectDataCallback(int bufferSize, const char *buffer, void *callbackData);
 int
 copyS3Obj (char *srcObj, char *destObj);
+int
+readS3Config (void);
+void
+initS3BucketContext (S3BucketContext *bucketContext, const char *bucket);
+#ifdef S3_MULTIPART
+int
+s3MultipartTransfer (int oprType, char *fileName, char *s3ObjName,
+char *srcObjName, rodsLong_t size);
+int
+s3TransferPart (s3Mpu_t *mpu, s3Part_t *part);
+void *
+s3MpuWorker (void *arg);
+#endif
 #endif	/* S3_FILE_DRIVER_H */
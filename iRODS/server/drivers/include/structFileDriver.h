@@ -13,6 +13,7 @@
 #include "rcConnect.h"
 #include "objInfo.h"
 #include "structFileSync.h"
+#include "tarIndex.h"
 
 typedef struct {
     structFileType_t type;
@@ -45,6 +46,7 @@ typedef struct structFileDesc {
     rescInfo_t *rescInfo;
     int openCnt;
     char dataType[NAME_LEN];
+    tarIndex_t *tarIndex;	/* the member index of a tar file, if loaded */
 } structFileDesc_t;
 
 #define NUM_STRUCT_FILE_DESC 16
@@ -0,0 +1,94 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* tarIndex.h - header file for tarIndex.c
+ */
+
+
+
+#ifndef TAR_INDEX_H
+#define TAR_INDEX_H
+
+#include "rods.h"
+
+#define TAR_BLOCK_SIZE		512
+#define TAR_INDEX_DIR		"tarIndexDir"	/* index files dir in getStateDir() */
+#define TAR_INDEX_SUFFIX	".tarIndex"
+#define TAR_INDEX_MAGIC		"iRODS tarIndex 1"
+#define TAR_INDEX_ROOT		-1	/* parentInx of top level members */
+#define TAR_PAX_BUF_SIZE	(64 * 1024)	/* max pax header read */
+
+/* the tar header types the index knows about */
+#define TAR_REG_TYPE		'0'
+#define TAR_AREG_TYPE		'\0'
+#define TAR_LNK_TYPE		'1'
+#define TAR_SYM_TYPE		'2'
+#define TAR_DIR_TYPE		'5'
+#define TAR_CONT_TYPE		'7'
+#define TAR_GNU_LONGNAME_TYPE	'L'
+#define TAR_GNU_LONGLINK_TYPE	'K'
+#define TAR_PAX_HDR_TYPE	'x'
+#define TAR_PAX_GLOBAL_TYPE	'g'
+
+typedef struct tarIndexEntry {
+    rodsLong_t hdrOffset;	/* offset of the first header of the member */
+    rodsLong_t offset;		/* offset of the member data in the tar file */
+    rodsLong_t size;
+    unsigned int mode;
+    unsigned int mtime;
+    int nameOffset;		/* of the member name in names */
+    int parentInx;		/* inx of the parent dir or TAR_INDEX_ROOT */
+} tarIndexEntry_t;
+
+/* the header of the index file. The entries and then the names follow it.
+ * tarSize and tarMtime are those of the tar file when the index was made
+ * and endOffset is where the end of archive blocks start */
+typedef struct tarIndexHeader {
+    char magic[NAME_LEN];
+    int entrySize;		/* sizeof (tarIndexEntry_t) */
+    int numEntries;
+    int nameLen;
+    unsigned int tarMtime;
+    rodsLong_t tarSize;
+    rodsLong_t endOffset;
+} tarIndexHeader_t;
+
+typedef struct TarIndex {
+    tarIndexHeader_t hdr;
+    tarIndexEntry_t *entries;	/* sorted by name */
+    char *names;
+    int maxEntries;
+    int maxNameLen;
+} tarIndex_t;
+
+/* read len bytes at offset of the tar file. Returns the bytes read */
+typedef int (*tarReadFunc_t) (void *readCtx, rodsLong_t offset, char *buf,
+int len);
+
+tarIndex_t *
+newTarIndex ();
+int
+freeTarIndex (tarIndex_t *tarIndex);
+int
+scanTarFile (tarIndex_t *tarIndex, rodsLong_t startOffset,
+tarReadFunc_t readFunc, void *readCtx);
+int
+sortTarIndex (tarIndex_t *tarIndex);
+int
+verifyTarIndexTail (tarIndex_t *tarIndex, tarReadFunc_t readFunc,
+void *readCtx);
+int
+findTarIndexEntry (tarIndex_t *tarIndex, char *name);
+int
+nextTarIndexChild (tarIndex_t *tarIndex, int parentInx, int startInx);
+char *
+getTarIndexName (tarIndex_t *tarIndex, int inx);
+char *
+getTarIndexBaseName (tarIndex_t *tarIndex, int inx);
+int
+packTarIndex (tarIndex_t *tarIndex, char **outBuf, int *outLen);
+int
+unpackTarIndexHeader (char *buf, int len, tarIndexHeader_t *hdr);
+int
+unpackTarIndex (char *buf, int len, tarIndex_t **outTarIndex);
+#endif	/* TAR_INDEX_H */
@@ -18,10 +18,23 @@ typedef struct tarSubFileDesc {
     int fd;                         /* the fd of the opened cached subFile */
     char cacheFilePath[MAX_NAME_LEN];   /* the phy path name of the cached
                                          * subFile */
+    int indexFlag;                  /* read straight from the tar file using
+                                     * the tarIndex. fd is that of the tar
+                                     * file */
+    int tarIndexInx;                /* the member (or dir) in the tarIndex */
+    tarIndexEntry_t member;         /* a copy of the tarIndex entry */
+    rodsLong_t offset;              /* current offset in the member or the
+                                     * next tarIndex inx for readdir */
 } tarSubFileDesc_t;
 
 #define NUM_TAR_SUB_FILE_DESC 20
 
+/* the readCtx of readTarPhyFile */
+typedef struct tarPhyFileCtx {
+    rsComm_t *rsComm;
+    int l3descInx;
+} tarPhyFileCtx_t;
+
 int
 tarSubStructFileCreate (rsComm_t *rsComm, subFile_t *subFile);
 int 
@@ -59,6 +72,33 @@ tarSubStructFileTruncate (rsComm_t *rsComm, subFile_t *subFile);
 int
 rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl);
 int
+_rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl, int stageFlag);
+int
+rsTarStructFileOpenForRead (rsComm_t *rsComm, specColl_t *specColl,
+int *indexFlag);
+int
+loadTarIndex (int structFileInx);
+int
+getTarIndexPath (int structFileInx, char *indexPath, int mkFlag);
+int
+readTarIndexFile (int structFileInx, tarIndex_t **outTarIndex);
+int
+writeTarIndexFile (int structFileInx, tarIndex_t *tarIndex);
+int
+unlinkTarIndexFile (int structFileInx);
+int
+openTarPhyFile (int structFileInx, char *fileName, int flags, int mode);
+int
+readTarPhyFile (void *readCtx, rodsLong_t offset, char *buf, int len);
+int
+getSubStructFileMember (specColl_t *specColl, char *subFilePath,
+char *memberName);
+int
+tarIndexEntryToStat (tarIndexEntry_t *member, rodsStat_t **statOut);
+int
+openIndexedSubFile (rsComm_t *rsComm, int structFileInx, subFile_t *subFile,
+int dirFlag);
+int
 stageTarStructFile (int structFileInx);
 int
 mkTarCacheDir (int structFileInx);
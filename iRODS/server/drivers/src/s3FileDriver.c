@@ -10,6 +10,7 @@
 
 static int S3Initialized = 0;
 s3Auth_t S3Auth;
+s3Config_t S3Config;
 
 
 
@@ -28,14 +29,7 @@ s3FileUnlink (rsComm_t *rsComm, char *s3ObjName)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {myBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
+    initS3BucketContext (&bucketContext, myBucket);
 
     S3ResponseHandler responseHandler = {
         0, &responseCompleteCallback
@@ -309,6 +303,14 @@ putFileIntoS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = parseS3Path (s3ObjName, myBucket, key)) < 0) return status;
 
+#ifdef S3_MULTIPART
+    if ((status = myS3Init ()) != S3StatusOK) return (status);
+    if (fileSize > S3Config.mpuChunkSize) {
+        return s3MultipartTransfer (S3_MPU_PUT, fileName, s3ObjName, NULL,
+          fileSize);
+    }
+#endif
+
     data.fd = fopen (fileName, "r");
     if (data.fd == NULL) {
         status = UNIX_FILE_OPEN_ERR - errno;
@@ -322,20 +324,7 @@ putFileIntoS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {myBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId, 
-	S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = myBucket;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+    initS3BucketContext (&bucketContext, myBucket);
 
     S3PutObjectHandler putObjectHandler = {
       { &responsePropertiesCallback, &responseCompleteCallback },
@@ -363,10 +352,14 @@ myS3Init (void)
 
     S3Initialized = 1;
 
+    readS3Config ();
+
 #ifdef libs3_3_1_4
     if ((status = S3_initialize ("s3", S3_INIT_ALL)) != S3StatusOK) {
 #else
-    if ((status = S3_initialize ("s3", S3_INIT_ALL, NULL)) != S3StatusOK) {
+    if ((status = S3_initialize ("s3", S3_INIT_ALL, 
+      S3Config.hostName[0] != '\0' ? S3Config.hostName : NULL)) != 
+      S3StatusOK) {
 #endif
         status = myS3Error (status, S3_INIT_ERROR);
     }
@@ -390,6 +383,66 @@ myS3Init (void)
     return status;
 }
 
+/* readS3Config - set the transfer parameters of the driver from the
+ * defaults and the S3_* env variables */
+
+int
+readS3Config (void)
+{
+    char *tmpPtr;
+    int tmpInt;
+
+    bzero (&S3Config, sizeof (S3Config));
+    S3Config.mpuChunkSize = S3_DEF_MPU_CHUNK_SZ;
+    S3Config.mpuThreads = S3_DEF_MPU_THREADS;
+    S3Config.retryCnt = S3_DEF_RETRY_CNT;
+    S3Config.protocol = S3ProtocolHTTPS;
+
+    if ((tmpPtr = getenv (S3_MPU_CHUNK_ENV)) != NULL && 
+      (tmpInt = atoi (tmpPtr)) > 0) {
+        S3Config.mpuChunkSize = (rodsLong_t) tmpInt * 1024 * 1024;
+        if (S3Config.mpuChunkSize < S3_MIN_MPU_CHUNK_SZ) {
+            S3Config.mpuChunkSize = S3_MIN_MPU_CHUNK_SZ;
+        } else if (S3Config.mpuChunkSize > S3_MAX_MPU_CHUNK_SZ) {
+            S3Config.mpuChunkSize = S3_MAX_MPU_CHUNK_SZ;
+        }
+    }
+    if ((tmpPtr = getenv (S3_MPU_THREADS_ENV)) != NULL && 
+      (tmpInt = atoi (tmpPtr)) > 0) {
+        if (tmpInt > S3_MAX_MPU_THREADS) tmpInt = S3_MAX_MPU_THREADS;
+        S3Config.mpuThreads = tmpInt;
+    }
+    if ((tmpPtr = getenv (S3_RETRY_COUNT_ENV)) != NULL && 
+      (tmpInt = atoi (tmpPtr)) >= 0) {
+        S3Config.retryCnt = tmpInt;
+    }
+    if ((tmpPtr = getenv (S3_HOSTNAME_ENV)) != NULL) {
+        rstrcpy (S3Config.hostName, tmpPtr, MAX_NAME_LEN);
+    }
+    if ((tmpPtr = getenv (S3_PROTOCOL_ENV)) != NULL && 
+      strcasecmp (tmpPtr, "http") == 0) {
+        S3Config.protocol = S3ProtocolHTTP;
+    }
+    return 0;
+}
+
+/* initS3BucketContext - set up the bucketContext of a request to bucket.
+ * The context is not initialized in the declaration because the
+ * hostName element added in 3-2.0 broke the positional initializer.
+ * XXXXX using S3UriStyleVirtualHost causes operation containing
+ * the sub-string "S3" to fail. use S3UriStylePath instead */
+
+void
+initS3BucketContext (S3BucketContext *bucketContext, const char *bucket)
+{
+    bzero (bucketContext, sizeof (S3BucketContext));
+    bucketContext->bucketName = bucket;
+    bucketContext->protocol = S3Config.protocol;
+    bucketContext->uriStyle = S3UriStylePath;
+    bucketContext->accessKeyId = S3Auth.accessKeyId;
+    bucketContext->secretAccessKey = S3Auth.secretAccessKey;
+}
+
 int
 readS3AuthInfo (void)
 {
@@ -482,20 +535,7 @@ const char *delimiter, int maxkeys, int allDetails, s3Stat_t *s3Stat)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {bucketName,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = bucketName;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+    initS3BucketContext (&bucketContext, bucketName);
 
     S3ListBucketHandler listBucketHandler = {
         { &responsePropertiesCallback, &responseCompleteCallback },
@@ -566,6 +606,14 @@ getFileFromS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = parseS3Path (s3ObjName, myBucket, key)) < 0) return status;
 
+#ifdef S3_MULTIPART
+    if ((status = myS3Init ()) != S3StatusOK) return (status);
+    if (fileSize > S3Config.mpuChunkSize) {
+        return s3MultipartTransfer (S3_MPU_GET, fileName, s3ObjName, NULL,
+          fileSize);
+    }
+#endif
+
     data.fd = fopen (fileName, "w+");
     if (data.fd == NULL) {
         status = UNIX_FILE_OPEN_ERR - errno;
@@ -579,20 +627,7 @@ getFileFromS3 (char *fileName, char *s3ObjName, rodsLong_t fileSize)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName
-       * element
-      S3BucketContext bucketContext =
-      {myBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = myBucket;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
+    initS3BucketContext (&bucketContext, myBucket);
 
     S3GetObjectHandler getObjectHandler = {
       { &responsePropertiesCallback, &responseCompleteCallback },
@@ -636,6 +671,9 @@ copyS3Obj (char *srcObj, char *destObj)
     int64_t lastModified;
     char eTag[256];
     S3BucketContext bucketContext;
+#ifdef S3_MULTIPART
+    s3Stat_t s3Stat;
+#endif
 
 
 
@@ -647,21 +685,17 @@ copyS3Obj (char *srcObj, char *destObj)
 
     if ((status = myS3Init ()) != S3StatusOK) return (status);
 
-      /* {myBucket,  1, 0, S3Auth.accessKeyId, S3Auth.secretAccessKey}; */
-      /* XXXXX using S3UriStyleVirtualHost causes operation containing
-       * the sub-string "S3" to fail. use S3UriStylePath instead */
-      /* this initialization failed for 3-2.0 because of the hostName 
-       * element 
-      S3BucketContext bucketContext =
-      {srcBucket,  S3ProtocolHTTPS, S3UriStylePath, S3Auth.accessKeyId,
-        S3Auth.secretAccessKey}; */
-    bzero (&bucketContext, sizeof (bucketContext));
-    bucketContext.bucketName = srcBucket;
-    bucketContext.protocol = S3ProtocolHTTPS;
-    bucketContext.uriStyle = S3UriStylePath;
-    bucketContext.accessKeyId = S3Auth.accessKeyId;
-    bucketContext.secretAccessKey = S3Auth.secretAccessKey;
-   
+#ifdef S3_MULTIPART
+    /* a single copy request is limited to 5 GB by S3 */
+    status = list_bucket (srcBucket, srcKey, NULL, NULL, 1, 1, &s3Stat);
+    if (status < 0) return status;
+    if (s3Stat.size > S3Config.mpuChunkSize) {
+        return s3MultipartTransfer (S3_MPU_COPY, NULL, destObj, srcObj,
+          s3Stat.size);
+    }
+#endif
+
+    initS3BucketContext (&bucketContext, srcBucket);
 
     S3ResponseHandler responseHandler = {
         &responsePropertiesCallback,
@@ -679,3 +713,401 @@ copyS3Obj (char *srcObj, char *destObj)
     return (status);
 }
 
+#ifdef S3_MULTIPART
+/* the callbacks of the multipart requests. The abort request is made
+ * with a NULL callbackData */
+
+static S3Status
+s3MpuPropertiesCallback (const S3ResponseProperties *properties,
+void *callbackData)
+{
+    s3MpuCallback_t *cb = (s3MpuCallback_t *) callbackData;
+
+    if (cb != NULL && cb->part != NULL && properties->eTag != NULL) {
+        rstrcpy (cb->part->eTag, (char *) properties->eTag, NAME_LEN);
+    }
+    return S3StatusOK;
+}
+
+static void
+s3MpuCompleteCallback (S3Status status, const S3ErrorDetails *error,
+void *callbackData)
+{
+    s3MpuCallback_t *cb = (s3MpuCallback_t *) callbackData;
+
+    if (cb != NULL) cb->status = status;
+
+    if (error != NULL && error->message != NULL) {
+        rodsLog (LOG_NOTICE,
+         "s3MpuCompleteCallback: Message: %s", error->message);
+    }
+}
+
+static S3Status
+s3MpuInitialCallback (const char *uploadId, void *callbackData)
+{
+    s3MpuCallback_t *cb = (s3MpuCallback_t *) callbackData;
+
+    rstrcpy (cb->mpu->uploadId, (char *) uploadId, MAX_NAME_LEN);
+    return S3StatusOK;
+}
+
+static int
+s3MpuPutDataCallback (int bufferSize, char *buffer, void *callbackData)
+{
+    s3MpuCallback_t *cb = (s3MpuCallback_t *) callbackData;
+    int len;
+
+    if (cb->bytesLeft <= 0) return 0;
+    len = cb->bytesLeft > bufferSize ? bufferSize : (int) cb->bytesLeft;
+    len = pread (cb->mpu->fd, buffer, len, cb->offset);
+    if (len <= 0) return -1;	/* abort the request */
+    cb->offset += len;
+    cb->bytesLeft -= len;
+    return len;
+}
+
+static S3Status
+s3MpuGetDataCallback (int bufferSize, const char *buffer, void *callbackData)
+{
+    s3MpuCallback_t *cb = (s3MpuCallback_t *) callbackData;
+
+    if (bufferSize > cb->bytesLeft || 
+      pwrite (cb->mpu->fd, buffer, bufferSize, cb->offset) != bufferSize) {
+        return S3StatusAbortedByCallback;
+    }
+    cb->offset += bufferSize;
+    cb->bytesLeft -= bufferSize;
+    return S3StatusOK;
+}
+
+static int
+s3MpuCommitDataCallback (int bufferSize, char *buffer, void *callbackData)
+{
+    s3MpuCallback_t *cb = (s3MpuCallback_t *) callbackData;
+    int len;
+
+    if (cb->bytesLeft <= 0) return 0;
+    len = cb->bytesLeft > bufferSize ? bufferSize : (int) cb->bytesLeft;
+    memcpy (buffer, cb->xml, len);
+    cb->xml += len;
+    cb->bytesLeft -= len;
+    return len;
+}
+
+static S3Status
+s3MpuCommitCallback (const char *location, const char *eTag,
+void *callbackData)
+{
+    return S3StatusOK;
+}
+
+static int
+s3MpuErrCode (int oprType)
+{
+    if (oprType == S3_MPU_PUT) {
+        return S3_PUT_ERROR;
+    } else if (oprType == S3_MPU_GET) {
+        return S3_GET_ERROR;
+    } else {
+        return S3_FILE_COPY_ERR;
+    }
+}
+
+/* s3CompleteMpu - commit the uploaded parts of mpu as the object */
+
+static int
+s3CompleteMpu (s3Mpu_t *mpu, S3BucketContext *bucketContext)
+{
+    s3MpuCallback_t cb;
+    int xmlLen, len, i;
+
+    xmlLen = mpu->numParts * (NAME_LEN + 64) + 64;
+    mpu->commitXml = (char *) malloc (xmlLen);
+    len = snprintf (mpu->commitXml, xmlLen, "<CompleteMultipartUpload>");
+    for (i = 0; i < mpu->numParts; i++) {
+        len += snprintf (mpu->commitXml + len, xmlLen - len,
+          "<Part><PartNumber>%d</PartNumber><ETag>%s</ETag></Part>",
+          mpu->parts[i].partNum, mpu->parts[i].eTag);
+    }
+    len += snprintf (mpu->commitXml + len, xmlLen - len,
+      "</CompleteMultipartUpload>");
+
+    S3MultipartCommitHandler commitHandler = {
+      { &s3MpuPropertiesCallback, &s3MpuCompleteCallback },
+      &s3MpuCommitDataCallback,
+      &s3MpuCommitCallback
+    };
+
+    bzero (&cb, sizeof (cb));
+    cb.mpu = mpu;
+    cb.xml = mpu->commitXml;
+    cb.bytesLeft = len;
+    S3_complete_multipart_upload (bucketContext, mpu->key, &commitHandler,
+      mpu->uploadId, len, NULL, &cb);
+
+    free (mpu->commitXml);
+    mpu->commitXml = NULL;
+
+    if (cb.status != S3StatusOK) {
+        return myS3Error (cb.status, s3MpuErrCode (mpu->oprType));
+    }
+    return 0;
+}
+
+/* s3MultipartTransfer - move an object of size bytes in parts, 
+ * S3Config.mpuThreads parts at a time. oprType is S3_MPU_PUT (fileName
+ * to s3ObjName), S3_MPU_GET (s3ObjName to fileName) or S3_MPU_COPY 
+ * (srcObjName to s3ObjName). A failed part is retried S3Config.retryCnt
+ * times and the upload is aborted if it still fails, so that no
+ * partial object is left behind.
+ */
+
+int
+s3MultipartTransfer (int oprType, char *fileName, char *s3ObjName,
+char *srcObjName, rodsLong_t size)
+{
+    int status, i;
+    int numThreads;
+    rodsLong_t partSize, offset;
+    s3Mpu_t mpu;
+    s3MpuCallback_t cb;
+    S3BucketContext bucketContext;
+#ifdef PARA_OPR
+    pthread_t tid[S3_MAX_MPU_THREADS];
+#endif
+
+    bzero (&mpu, sizeof (mpu));
+    mpu.oprType = oprType;
+    mpu.fd = -1;
+
+    if ((status = parseS3Path (s3ObjName, mpu.bucket, mpu.key)) < 0) 
+        return status;
+    if (oprType == S3_MPU_COPY && 
+      (status = parseS3Path (srcObjName, mpu.srcBucket, mpu.srcKey)) < 0)
+        return status;
+
+    if ((status = myS3Init ()) != S3StatusOK) return (status);
+
+    if (oprType == S3_MPU_PUT) {
+        mpu.fd = open (fileName, O_RDONLY, 0);
+    } else if (oprType == S3_MPU_GET) {
+        mpu.fd = open (fileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+    if (oprType != S3_MPU_COPY && mpu.fd < 0) {
+        status = UNIX_FILE_OPEN_ERR - errno;
+        rodsLog (LOG_ERROR,
+         "s3MultipartTransfer: open error for fileName %s, status = %d",
+         fileName, status);
+        return status;
+    }
+    if (oprType == S3_MPU_GET && ftruncate (mpu.fd, size) < 0) {
+        status = UNIX_FILE_TRUNCATE_ERR - errno;
+        rodsLog (LOG_ERROR,
+         "s3MultipartTransfer: ftruncate error for fileName %s, status = %d",
+         fileName, status);
+        close (mpu.fd);
+        return status;
+    }
+
+    partSize = S3Config.mpuChunkSize;
+    if ((size + partSize - 1) / partSize > S3_MAX_MPU_PARTS) {
+        partSize = (size + S3_MAX_MPU_PARTS - 1) / S3_MAX_MPU_PARTS;
+    }
+    mpu.numParts = (int) ((size + partSize - 1) / partSize);
+    mpu.parts = (s3Part_t *) calloc (mpu.numParts, sizeof (s3Part_t));
+    for (i = 0, offset = 0; i < mpu.numParts; i++, offset += partSize) {
+        mpu.parts[i].partNum = i + 1;
+        mpu.parts[i].offset = offset;
+        mpu.parts[i].size = 
+          size - offset > partSize ? partSize : size - offset;
+    }
+
+    initS3BucketContext (&bucketContext, mpu.bucket);
+
+    if (oprType != S3_MPU_GET) {
+        S3MultipartInitialHandler initialHandler = {
+          { &s3MpuPropertiesCallback, &s3MpuCompleteCallback },
+          &s3MpuInitialCallback
+        };
+
+        bzero (&cb, sizeof (cb));
+        cb.mpu = &mpu;
+        S3_initiate_multipart (&bucketContext, mpu.key, NULL, 
+          &initialHandler, NULL, &cb);
+        if (cb.status != S3StatusOK || mpu.uploadId[0] == '\0') {
+            status = myS3Error (cb.status, s3MpuErrCode (oprType));
+            if (mpu.fd >= 0) close (mpu.fd);
+            free (mpu.parts);
+            return status;
+        }
+    }
+
+    numThreads = S3Config.mpuThreads < mpu.numParts ? 
+      S3Config.mpuThreads : mpu.numParts;
+#ifdef PARA_OPR
+    pthread_mutex_init (&mpu.lock, NULL);
+    for (i = 0; i < numThreads; i++) {
+        if (pthread_create (&tid[i], NULL, 
+          (void *(*)(void *)) s3MpuWorker, (void *) &mpu) != 0) {
+            rodsLog (LOG_NOTICE,
+              "s3MultipartTransfer: pthread_create error, errno = %d", errno);
+            break;
+        }
+    }
+    numThreads = i;
+    if (numThreads == 0) {
+        s3MpuWorker ((void *) &mpu);
+    } else {
+        for (i = 0; i < numThreads; i++) {
+            pthread_join (tid[i], NULL);
+        }
+    }
+    pthread_mutex_destroy (&mpu.lock);
+#else
+    numThreads = 1;
+    s3MpuWorker ((void *) &mpu);
+#endif
+    status = mpu.status;
+
+    if (oprType != S3_MPU_GET) {
+        if (status >= 0) status = s3CompleteMpu (&mpu, &bucketContext);
+        if (status < 0) {
+            S3AbortMultipartUploadHandler abortHandler = {
+              { &s3MpuPropertiesCallback, &s3MpuCompleteCallback }
+            };
+            S3_abort_multipart_upload (&bucketContext, mpu.key, 
+              mpu.uploadId, &abortHandler);
+        }
+    }
+
+    if (status >= 0) {
+        rodsLog (LOG_DEBUG,
+          "s3MultipartTransfer: %s of %s, %lld bytes in %d parts, %d threads",
+          oprType == S3_MPU_PUT ? "put" : 
+          oprType == S3_MPU_GET ? "get" : "copy",
+          s3ObjName, size, mpu.numParts, numThreads);
+    }
+
+    if (mpu.fd >= 0) close (mpu.fd);
+    free (mpu.parts);
+    return status;
+}
+
+/* s3MpuWorker - take the parts of the arg s3Mpu_t in turn until all
+ * are done or one has failed */
+
+void *
+s3MpuWorker (void *arg)
+{
+    s3Mpu_t *mpu = (s3Mpu_t *) arg;
+    s3Part_t *part;
+    int status;
+
+    while (1) {
+#ifdef PARA_OPR
+        pthread_mutex_lock (&mpu->lock);
+#endif
+        if (mpu->status < 0 || mpu->nextPart >= mpu->numParts) {
+            part = NULL;
+        } else {
+            part = &mpu->parts[mpu->nextPart];
+            mpu->nextPart++;
+        }
+#ifdef PARA_OPR
+        pthread_mutex_unlock (&mpu->lock);
+#endif
+        if (part == NULL) break;
+
+        status = s3TransferPart (mpu, part);
+        if (status < 0) {
+#ifdef PARA_OPR
+            pthread_mutex_lock (&mpu->lock);
+#endif
+            if (mpu->status >= 0) mpu->status = status;
+#ifdef PARA_OPR
+            pthread_mutex_unlock (&mpu->lock);
+#endif
+        }
+    }
+    return NULL;
+}
+
+/* s3TransferPart - move one part. Failures that S3 considers retryable
+ * (timeouts, dropped connections, 5xx) are retried with a backoff */
+
+int
+s3TransferPart (s3Mpu_t *mpu, s3Part_t *part)
+{
+    s3MpuCallback_t cb;
+    S3BucketContext bucketContext, srcBucketContext;
+    int64_t lastModified;
+    int retryCnt = 0;
+    int waitSec = S3_RETRY_WAIT_SEC;
+
+    initS3BucketContext (&bucketContext, mpu->bucket);
+    initS3BucketContext (&srcBucketContext, mpu->srcBucket);
+
+    S3PutObjectHandler putHandler = {
+      { &s3MpuPropertiesCallback, &s3MpuCompleteCallback },
+      &s3MpuPutDataCallback
+    };
+    S3GetObjectHandler getHandler = {
+      { &s3MpuPropertiesCallback, &s3MpuCompleteCallback },
+      &s3MpuGetDataCallback
+    };
+    S3ResponseHandler responseHandler = {
+        &s3MpuPropertiesCallback,
+        &s3MpuCompleteCallback
+    };
+
+    while (1) {
+        bzero (&cb, sizeof (cb));
+        cb.mpu = mpu;
+        cb.part = part;
+        cb.offset = part->offset;
+        cb.bytesLeft = part->size;
+
+        if (mpu->oprType == S3_MPU_PUT) {
+            S3_upload_part (&bucketContext, mpu->key, NULL, &putHandler,
+              part->partNum, mpu->uploadId, (int) part->size, NULL, &cb);
+        } else if (mpu->oprType == S3_MPU_GET) {
+            S3_get_object (&bucketContext, mpu->key, NULL, part->offset,
+              part->size, NULL, &getHandler, &cb);
+        } else {
+            S3_copy_object_range (&srcBucketContext, mpu->srcKey, 
+              mpu->bucket, mpu->key, part->partNum, mpu->uploadId,
+              part->offset, part->size, NULL, &lastModified, NAME_LEN,
+              part->eTag, NULL, &responseHandler, &cb);
+        }
+
+        if (cb.status == S3StatusOK) break;
+
+        if (!S3_status_is_retryable ((S3Status) cb.status) || 
+          retryCnt >= S3Config.retryCnt) {
+            rodsLog (LOG_ERROR,
+              "s3TransferPart: part %d of %s/%s failed after %d retries",
+              part->partNum, mpu->bucket, mpu->key, retryCnt);
+            part->status = myS3Error (cb.status, s3MpuErrCode (mpu->oprType));
+            return part->status;
+        }
+        retryCnt++;
+        rodsLog (LOG_NOTICE,
+          "s3TransferPart: part %d of %s/%s error %s, retry %d in %d sec",
+          part->partNum, mpu->bucket, mpu->key,
+          S3_get_status_name ((S3Status) cb.status), retryCnt, waitSec);
+        sleep (waitSec);
+        waitSec *= 2;
+    }
+
+    if (mpu->oprType == S3_MPU_GET && cb.bytesLeft > 0) {
+        rodsLog (LOG_ERROR,
+          "s3TransferPart: part %d of %s/%s is %lld bytes short",
+          part->partNum, mpu->bucket, mpu->key, cb.bytesLeft);
+        part->status = SYS_COPY_LEN_ERR;
+        return part->status;
+    }
+    part->status = 0;
+    return 0;
+}
+#endif	/* S3_MULTIPART */
@@ -358,6 +358,7 @@ freeStructFileDesc (int structFileInx)
         return (SYS_FILE_DESC_OUT_OF_RANGE);
     }
 
+    freeTarIndex (StructFileDesc[structFileInx].tarIndex);
     memset (&StructFileDesc[structFileInx], 0, sizeof (structFileDesc_t));
 
     return (0);
@@ -0,0 +1,595 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+
+/* tarIndex.c - the member index of a tar file. The index gives the offset,
+ * size, mode and mtime of every member so that a member can be read
+ * straight from the tar file without extracting the tar file first.
+ *
+ * The index is made by scanning the 512 byte headers of the tar file.
+ * ustar, v7 and GNU tar files are understood, including the GNU long name
+ * and the pax path and size extensions. Compressed tar files are not.
+ * The tar file is read through a tarReadFunc_t so that the scan can be
+ * done with the server file drivers or with plain pread.
+ */
+
+#include "tarIndex.h"
+
+static char *SortNames = NULL;	/* the names of the index being sorted */
+
+static rodsLong_t
+parseTarNum (char *field, int len)
+{
+    rodsLong_t value = 0;
+    int i = 0;
+
+    if ((field[0] & 0x80) != 0) {
+	/* GNU base-256 for sizes too big for the octal field */
+	value = field[0] & 0x3f;
+	for (i = 1; i < len; i++) {
+	    value = (value << 8) | (field[i] & 0xff);
+	}
+	return (value);
+    }
+    while (i < len && field[i] == ' ') i++;
+    while (i < len && field[i] >= '0' && field[i] <= '7') {
+	value = (value << 3) + (field[i] - '0');
+	i++;
+    }
+    return (value);
+}
+
+/* checkTarHeader - returns 1 if hdr is a tar header with a good checksum,
+ * 0 if it is a zero block (end of archive) and -1 otherwise */
+
+static int
+checkTarHeader (char *hdr)
+{
+    unsigned int uSum = 0;
+    int sSum = 0;
+    int i, zeroFlag = 1;
+    rodsLong_t chksum;
+
+    for (i = 0; i < TAR_BLOCK_SIZE; i++) {
+	if (hdr[i] != 0) zeroFlag = 0;
+	if (i >= 148 && i < 156) {
+	    /* the chksum field counts as spaces */
+	    uSum += ' ';
+	    sSum += ' ';
+	} else {
+	    uSum += (unsigned char) hdr[i];
+	    sSum += (signed char) hdr[i];
+	}
+    }
+    if (zeroFlag) return (0);
+    chksum = parseTarNum (&hdr[148], 8);
+    if (chksum == uSum || chksum == sSum) return (1);
+    return (-1);
+}
+
+tarIndex_t *
+newTarIndex ()
+{
+    tarIndex_t *tarIndex;
+
+    tarIndex = (tarIndex_t *) calloc (1, sizeof (tarIndex_t));
+    if (tarIndex == NULL) return (NULL);
+    rstrcpy (tarIndex->hdr.magic, TAR_INDEX_MAGIC, NAME_LEN);
+    tarIndex->hdr.entrySize = sizeof (tarIndexEntry_t);
+    return (tarIndex);
+}
+
+int
+freeTarIndex (tarIndex_t *tarIndex)
+{
+    if (tarIndex == NULL) return (0);
+    if (tarIndex->entries != NULL) free (tarIndex->entries);
+    if (tarIndex->names != NULL) free (tarIndex->names);
+    free (tarIndex);
+    return (0);
+}
+
+static int
+addTarIndexEntry (tarIndex_t *tarIndex, char *name, rodsLong_t hdrOffset,
+rodsLong_t offset, rodsLong_t size, unsigned int mode, unsigned int mtime)
+{
+    tarIndexEntry_t *entry;
+    int len = strlen (name) + 1;
+
+    if (tarIndex->hdr.numEntries >= tarIndex->maxEntries) {
+	int maxEntries = tarIndex->maxEntries > 0 ?
+	  2 * tarIndex->maxEntries : 256;
+	entry = (tarIndexEntry_t *) realloc (tarIndex->entries,
+	  maxEntries * sizeof (tarIndexEntry_t));
+	if (entry == NULL) return (SYS_MALLOC_ERR);
+	tarIndex->entries = entry;
+	tarIndex->maxEntries = maxEntries;
+    }
+    if (tarIndex->hdr.nameLen + len > tarIndex->maxNameLen) {
+	char *names;
+	int maxNameLen = tarIndex->maxNameLen > 0 ?
+	  2 * tarIndex->maxNameLen : 16 * 1024;
+	while (maxNameLen < tarIndex->hdr.nameLen + len) maxNameLen *= 2;
+	names = (char *) realloc (tarIndex->names, maxNameLen);
+	if (names == NULL) return (SYS_MALLOC_ERR);
+	tarIndex->names = names;
+	tarIndex->maxNameLen = maxNameLen;
+    }
+    entry = &tarIndex->entries[tarIndex->hdr.numEntries];
+    memset (entry, 0, sizeof (tarIndexEntry_t));
+    entry->hdrOffset = hdrOffset;
+    entry->offset = offset;
+    entry->size = size;
+    entry->mode = mode;
+    entry->mtime = mtime;
+    entry->nameOffset = tarIndex->hdr.nameLen;
+    entry->parentInx = TAR_INDEX_ROOT;
+    memcpy (tarIndex->names + tarIndex->hdr.nameLen, name, len);
+    tarIndex->hdr.nameLen += len;
+    return (tarIndex->hdr.numEntries++);
+}
+
+/* normTarName - strip the leading "/" and "./" and the trailing "/" */
+
+static char *
+normTarName (char *name)
+{
+    int len;
+
+    while (1) {
+	if (*name == '/') {
+	    name++;
+	} else if (name[0] == '.' && (name[1] == '/' || name[1] == '\0')) {
+	    name++;
+	} else {
+	    break;
+	}
+    }
+    len = strlen (name);
+    while (len > 0 && name[len - 1] == '/') name[--len] = '\0';
+    return (name);
+}
+
+/* readTarData - read the data of a long name or pax header member into
+ * buf, null terminated */
+
+static int
+readTarData (tarReadFunc_t readFunc, void *readCtx, rodsLong_t offset,
+rodsLong_t size, char *buf, int bufLen)
+{
+    int len = size < bufLen - 1 ? (int) size : bufLen - 1;
+
+    if (readFunc (readCtx, offset, buf, len) != len) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    buf[len] = '\0';
+    return (len);
+}
+
+/* parsePaxHeader - pick the path and size out of the "len key=value\n"
+ * records of a pax extended header */
+
+static void
+parsePaxHeader (char *buf, int len, char *paxPath, rodsLong_t *paxSize)
+{
+    char *ptr = buf;
+    char *key, *value, *recEnd;
+    int recLen;
+
+    while (ptr < buf + len) {
+	recLen = atoi (ptr);
+	if (recLen <= 0 || ptr + recLen > buf + len) break;
+	recEnd = ptr + recLen;
+	if ((key = strchr (ptr, ' ')) == NULL || key >= recEnd) break;
+	key++;
+	if ((value = strchr (key, '=')) == NULL || value >= recEnd) break;
+	value++;
+	if (strncmp (key, "path=", 5) == 0) {
+	    int vLen = recEnd - value - 1;	/* minus the '\n' */
+	    if (vLen >= MAX_NAME_LEN) vLen = MAX_NAME_LEN - 1;
+	    memcpy (paxPath, value, vLen);
+	    paxPath[vLen] = '\0';
+	} else if (strncmp (key, "size=", 5) == 0) {
+	    *paxSize = strtoll (value, NULL, 10);
+	}
+	ptr = recEnd;
+    }
+}
+
+/* scanTarFile - add the members of the tar file starting with the header
+ * at startOffset to tarIndex. The entries are added unsorted; call
+ * sortTarIndex when done. hdr.endOffset is set to the offset of the end
+ * of archive blocks.
+ */
+
+int
+scanTarFile (tarIndex_t *tarIndex, rodsLong_t startOffset,
+tarReadFunc_t readFunc, void *readCtx)
+{
+    char hdr[TAR_BLOCK_SIZE];
+    char nameBuf[MAX_NAME_LEN];
+    char longName[MAX_NAME_LEN];
+    char paxPath[MAX_NAME_LEN];
+    char *paxBuf = NULL;
+    char *name;
+    rodsLong_t offset = startOffset;
+    rodsLong_t memberOffset = -1;
+    rodsLong_t size, paxSize = -1;
+    unsigned int mode;
+    int status = 0;
+    int len, dirFlag;
+    char type;
+
+    longName[0] = paxPath[0] = '\0';
+    while (1) {
+	len = readFunc (readCtx, offset, hdr, TAR_BLOCK_SIZE);
+	if (len == 0) break;		/* no end of archive blocks */
+	if (len != TAR_BLOCK_SIZE) {
+	    status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+	    break;
+	}
+	if ((status = checkTarHeader (hdr)) <= 0) {
+	    if (status < 0) {
+		rodsLog (LOG_DEBUG,
+		  "scanTarFile: bad tar header at offset %lld", offset);
+		status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+	    }
+	    break;
+	}
+	if (memberOffset < 0) memberOffset = offset;
+	type = hdr[156];
+	size = parseTarNum (&hdr[124], 12);
+
+	if (type == TAR_GNU_LONGNAME_TYPE || type == TAR_PAX_HDR_TYPE) {
+	    if (type == TAR_GNU_LONGNAME_TYPE) {
+		status = readTarData (readFunc, readCtx,
+		  offset + TAR_BLOCK_SIZE, size, longName, MAX_NAME_LEN);
+	    } else {
+		if (paxBuf == NULL &&
+		  (paxBuf = (char *) malloc (TAR_PAX_BUF_SIZE)) == NULL) {
+		    status = SYS_MALLOC_ERR;
+		    break;
+		}
+		status = readTarData (readFunc, readCtx,
+		  offset + TAR_BLOCK_SIZE, size, paxBuf, TAR_PAX_BUF_SIZE);
+		if (status >= 0) parsePaxHeader (paxBuf, status, paxPath,
+		  &paxSize);
+	    }
+	    if (status < 0) break;
+	    offset += TAR_BLOCK_SIZE +
+	      (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+	    continue;
+	}
+	if (paxSize >= 0) size = paxSize;
+	if (type == TAR_GNU_LONGLINK_TYPE || type == TAR_PAX_GLOBAL_TYPE) {
+	    memberOffset = -1;
+	    offset += TAR_BLOCK_SIZE +
+	      (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+	    continue;
+	}
+	if (type == TAR_SYM_TYPE) {
+	    status = SYMLINKED_BUNFILE_NOT_ALLOWED;
+	    break;
+	}
+	if (type == TAR_LNK_TYPE) {
+	    /* the data is in another member. Leave it to the extraction */
+	    status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+	    break;
+	}
+
+	if (longName[0] != '\0') {
+	    rstrcpy (nameBuf, longName, MAX_NAME_LEN);
+	} else if (paxPath[0] != '\0') {
+	    rstrcpy (nameBuf, paxPath, MAX_NAME_LEN);
+	} else if (strncmp (&hdr[257], "ustar", 5) == 0 && hdr[345] != '\0') {
+	    snprintf (nameBuf, MAX_NAME_LEN, "%.155s/%.100s", &hdr[345], hdr);
+	} else {
+	    snprintf (nameBuf, MAX_NAME_LEN, "%.100s", hdr);
+	}
+	len = strlen (nameBuf);
+	dirFlag = type == TAR_DIR_TYPE ||
+	  (type == TAR_AREG_TYPE && len > 0 && nameBuf[len - 1] == '/');
+	name = normTarName (nameBuf);
+
+	if (*name != '\0' && (dirFlag || type == TAR_REG_TYPE ||
+	  type == TAR_AREG_TYPE || type == TAR_CONT_TYPE)) {
+	    /* devices and fifos are skipped like the extraction does */
+	    mode = (unsigned int) parseTarNum (&hdr[100], 8) & 07777;
+	    mode |= dirFlag ? S_IFDIR : S_IFREG;
+	    status = addTarIndexEntry (tarIndex, name, memberOffset,
+	      offset + TAR_BLOCK_SIZE, dirFlag ? 0 : size, mode,
+	      (unsigned int) parseTarNum (&hdr[136], 12));
+	    if (status < 0) break;
+	}
+	if (dirFlag) size = 0;
+	longName[0] = paxPath[0] = '\0';
+	paxSize = -1;
+	memberOffset = -1;
+	offset += TAR_BLOCK_SIZE +
+	  (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+    }
+    if (paxBuf != NULL) free (paxBuf);
+    if (status < 0) return (status);
+
+    tarIndex->hdr.endOffset = offset;
+    return (0);
+}
+
+static int
+cmpTarIndexEntry (const void *a, const void *b)
+{
+    const tarIndexEntry_t *ea = (const tarIndexEntry_t *) a;
+    const tarIndexEntry_t *eb = (const tarIndexEntry_t *) b;
+    int status;
+
+    status = strcmp (SortNames + ea->nameOffset, SortNames + eb->nameOffset);
+    if (status != 0) return (status);
+    /* a later member of the same name replaces the earlier one */
+    if (ea->hdrOffset < eb->hdrOffset) return (-1);
+    if (ea->hdrOffset > eb->hdrOffset) return (1);
+    return (0);
+}
+
+static int
+lookupTarIndex (tarIndex_t *tarIndex, char *name, int numEntries)
+{
+    int low = 0, high = numEntries - 1, mid, status;
+
+    while (low <= high) {
+	mid = (low + high) / 2;
+	status = strcmp (name,
+	  tarIndex->names + tarIndex->entries[mid].nameOffset);
+	if (status == 0) return (mid);
+	if (status < 0) {
+	    high = mid - 1;
+	} else {
+	    low = mid + 1;
+	}
+    }
+    return (-(low + 1));
+}
+
+/* sortAndDedupTarIndex - sort the entries by name and keep only the last
+ * member of a name */
+
+static void
+sortAndDedupTarIndex (tarIndex_t *tarIndex)
+{
+    int i, j = 0;
+    tarIndexEntry_t *entries = tarIndex->entries;
+
+    SortNames = tarIndex->names;
+    qsort (entries, tarIndex->hdr.numEntries, sizeof (tarIndexEntry_t),
+      cmpTarIndexEntry);
+    SortNames = NULL;
+
+    for (i = 0; i < tarIndex->hdr.numEntries; i++) {
+	if (i + 1 < tarIndex->hdr.numEntries &&
+	  strcmp (tarIndex->names + entries[i].nameOffset,
+	  tarIndex->names + entries[i + 1].nameOffset) == 0) {
+	    continue;
+	}
+	if (j != i) entries[j] = entries[i];
+	j++;
+    }
+    tarIndex->hdr.numEntries = j;
+}
+
+/* sortTarIndex - sort the entries, add the parent dirs that are not in
+ * the tar file and link each entry to its parent */
+
+int
+sortTarIndex (tarIndex_t *tarIndex)
+{
+    int i, numSorted, status;
+    char name[MAX_NAME_LEN];
+    char lastAdded[MAX_NAME_LEN];
+    char *ptr;
+    tarIndexEntry_t *entry;
+
+    if (tarIndex->hdr.numEntries == 0) return (0);
+    sortAndDedupTarIndex (tarIndex);
+
+    numSorted = tarIndex->hdr.numEntries;
+    lastAdded[0] = '\0';
+    for (i = 0; i < numSorted; i++) {
+	entry = &tarIndex->entries[i];
+	rstrcpy (name, tarIndex->names + entry->nameOffset, MAX_NAME_LEN);
+	while ((ptr = strrchr (name, '/')) != NULL) {
+	    *ptr = '\0';
+	    if (strcmp (name, lastAdded) == 0 ||
+	      lookupTarIndex (tarIndex, name, numSorted) >= 0) break;
+	    status = addTarIndexEntry (tarIndex, name, -1,
+	      tarIndex->entries[i].offset, 0, S_IFDIR | 0755,
+	      tarIndex->entries[i].mtime);
+	    if (status < 0) return (status);
+	    rstrcpy (lastAdded, name, MAX_NAME_LEN);
+	}
+    }
+    if (tarIndex->hdr.numEntries > numSorted) sortAndDedupTarIndex (tarIndex);
+
+    for (i = 0; i < tarIndex->hdr.numEntries; i++) {
+	entry = &tarIndex->entries[i];
+	rstrcpy (name, tarIndex->names + entry->nameOffset, MAX_NAME_LEN);
+	if ((ptr = strrchr (name, '/')) == NULL) {
+	    entry->parentInx = TAR_INDEX_ROOT;
+	} else {
+	    *ptr = '\0';
+	    entry->parentInx = lookupTarIndex (tarIndex, name, i);
+	}
+    }
+    return (0);
+}
+
+/* verifyTarIndexTail - check that the tar file still has the last member
+ * of the index where the index says. Used to tell a tar file that was
+ * only appended to (tar -r) from one that was rewritten. */
+
+int
+verifyTarIndexTail (tarIndex_t *tarIndex, tarReadFunc_t readFunc,
+void *readCtx)
+{
+    char hdr[TAR_BLOCK_SIZE];
+    tarIndexEntry_t *last = NULL;
+    int i;
+
+    for (i = 0; i < tarIndex->hdr.numEntries; i++) {
+	if (tarIndex->entries[i].hdrOffset >= 0 && (last == NULL ||
+	  tarIndex->entries[i].hdrOffset > last->hdrOffset)) {
+	    last = &tarIndex->entries[i];
+	}
+    }
+    if (last == NULL) return (0);
+
+    if (readFunc (readCtx, last->offset - TAR_BLOCK_SIZE, hdr,
+      TAR_BLOCK_SIZE) != TAR_BLOCK_SIZE || checkTarHeader (hdr) <= 0) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    if (last->hdrOffset == last->offset - TAR_BLOCK_SIZE &&
+      !S_ISDIR (last->mode) && parseTarNum (&hdr[124], 12) != last->size) {
+	/* no pax header in front, so the size must match */
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    if ((unsigned int) parseTarNum (&hdr[136], 12) != last->mtime) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    return (0);
+}
+
+/* findTarIndexEntry - returns the inx of the member name, TAR_INDEX_ROOT
+ * for the top of the tar file or a negative error if there is no such
+ * member */
+
+int
+findTarIndexEntry (tarIndex_t *tarIndex, char *name)
+{
+    char myName[MAX_NAME_LEN];
+    char *ptr;
+    int inx;
+
+    rstrcpy (myName, name, MAX_NAME_LEN);
+    ptr = normTarName (myName);
+    if (*ptr == '\0') return (TAR_INDEX_ROOT);
+    inx = lookupTarIndex (tarIndex, ptr, tarIndex->hdr.numEntries);
+    if (inx < 0) return (UNIX_FILE_STAT_ERR - ENOENT);
+    return (inx);
+}
+
+/* nextTarIndexChild - returns the inx of the first member at or after
+ * startInx in the dir parentInx, or -1 if there is none. The members of
+ * a dir "a" are all within the names starting with "a/" */
+
+int
+nextTarIndexChild (tarIndex_t *tarIndex, int parentInx, int startInx)
+{
+    char prefix[MAX_NAME_LEN];
+    int i, prefixLen = 0;
+
+    if (parentInx != TAR_INDEX_ROOT) {
+	snprintf (prefix, MAX_NAME_LEN, "%s/",
+	  getTarIndexName (tarIndex, parentInx));
+	prefixLen = strlen (prefix);
+	if (startInx <= parentInx) {
+	    i = lookupTarIndex (tarIndex, prefix, tarIndex->hdr.numEntries);
+	    startInx = i >= 0 ? i : -(i + 1);
+	}
+    }
+    for (i = startInx < 0 ? 0 : startInx; i < tarIndex->hdr.numEntries; i++) {
+	if (prefixLen > 0 && strncmp (getTarIndexName (tarIndex, i), prefix,
+	  prefixLen) != 0) break;
+	if (tarIndex->entries[i].parentInx == parentInx) return (i);
+    }
+    return (-1);
+}
+
+char *
+getTarIndexName (tarIndex_t *tarIndex, int inx)
+{
+    return (tarIndex->names + tarIndex->entries[inx].nameOffset);
+}
+
+char *
+getTarIndexBaseName (tarIndex_t *tarIndex, int inx)
+{
+    char *name = getTarIndexName (tarIndex, inx);
+    char *ptr;
+
+    if ((ptr = strrchr (name, '/')) != NULL) return (ptr + 1);
+    return (name);
+}
+
+/* packTarIndex - lay out the index as it is stored in the index file, the
+ * header followed by the entries and the names. The index file is only
+ * read on the host that wrote it, so it is kept in native byte order and
+ * entrySize guards against a change of tarIndexEntry_t. */
+
+int
+packTarIndex (tarIndex_t *tarIndex, char **outBuf, int *outLen)
+{
+    int entryLen = tarIndex->hdr.numEntries * sizeof (tarIndexEntry_t);
+    char *buf;
+
+    *outLen = sizeof (tarIndexHeader_t) + entryLen + tarIndex->hdr.nameLen;
+    if ((buf = (char *) malloc (*outLen)) == NULL) return (SYS_MALLOC_ERR);
+    memcpy (buf, &tarIndex->hdr, sizeof (tarIndexHeader_t));
+    memcpy (buf + sizeof (tarIndexHeader_t), tarIndex->entries, entryLen);
+    memcpy (buf + sizeof (tarIndexHeader_t) + entryLen, tarIndex->names,
+      tarIndex->hdr.nameLen);
+    *outBuf = buf;
+    return (0);
+}
+
+int
+unpackTarIndexHeader (char *buf, int len, tarIndexHeader_t *hdr)
+{
+    if (len < (int) sizeof (tarIndexHeader_t)) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    memcpy (hdr, buf, sizeof (tarIndexHeader_t));
+    if (strncmp (hdr->magic, TAR_INDEX_MAGIC, NAME_LEN) != 0 ||
+      hdr->entrySize != (int) sizeof (tarIndexEntry_t) ||
+      hdr->numEntries < 0 || hdr->nameLen < 0) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    return (0);
+}
+
+int
+unpackTarIndex (char *buf, int len, tarIndex_t **outTarIndex)
+{
+    tarIndex_t *tarIndex;
+    tarIndexHeader_t hdr;
+    int entryLen, i, status;
+
+    *outTarIndex = NULL;
+    if ((status = unpackTarIndexHeader (buf, len, &hdr)) < 0) return (status);
+    entryLen = hdr.numEntries * sizeof (tarIndexEntry_t);
+    if (len != (int) sizeof (tarIndexHeader_t) + entryLen + hdr.nameLen ||
+      (hdr.nameLen > 0 && buf[len - 1] != '\0')) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+
+    if ((tarIndex = newTarIndex ()) == NULL) return (SYS_MALLOC_ERR);
+    tarIndex->hdr = hdr;
+    tarIndex->maxEntries = hdr.numEntries;
+    tarIndex->maxNameLen = hdr.nameLen;
+    tarIndex->entries = (tarIndexEntry_t *) malloc (entryLen + 1);
+    tarIndex->names = (char *) malloc (hdr.nameLen + 1);
+    if (tarIndex->entries == NULL || tarIndex->names == NULL) {
+	freeTarIndex (tarIndex);
+	return (SYS_MALLOC_ERR);
+    }
+    memcpy (tarIndex->entries, buf + sizeof (tarIndexHeader_t), entryLen);
+    memcpy (tarIndex->names, buf + sizeof (tarIndexHeader_t) + entryLen,
+      hdr.nameLen);
+    for (i = 0; i < hdr.numEntries; i++) {
+	if (tarIndex->entries[i].nameOffset < 0 ||
+	  tarIndex->entries[i].nameOffset >= hdr.nameLen ||
+	  tarIndex->entries[i].parentInx < TAR_INDEX_ROOT ||
+	  tarIndex->entries[i].parentInx >= hdr.numEntries) {
+	    freeTarIndex (tarIndex);
+	    return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+	}
+    }
+    *outTarIndex = tarIndex;
+    return (0);
+}
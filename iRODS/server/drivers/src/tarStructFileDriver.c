@@ -107,10 +107,17 @@ tarSubStructFileOpen (rsComm_t *rsComm, subFile_t *subFile)
     int subInx;
     int rescTypeInx;
     int status;
+    int indexFlag = 0;
     fileOpenInp_t fileOpenInp;
 
     specColl = subFile->specColl;
-    structFileInx = rsTarStructFileOpen (rsComm, specColl);
+    if ((subFile->flags & O_ACCMODE) == O_RDONLY) {
+	/* no need to stage if it can be read with the tarIndex */
+        structFileInx = rsTarStructFileOpenForRead (rsComm, specColl, 
+	  &indexFlag);
+    } else {
+        structFileInx = rsTarStructFileOpen (rsComm, specColl);
+    }
 
     if (structFileInx < 0) {
         rodsLog (LOG_NOTICE,
@@ -119,6 +126,10 @@ tarSubStructFileOpen (rsComm_t *rsComm, subFile_t *subFile)
         return (structFileInx);
     }
 
+    if (indexFlag > 0) {
+	return (openIndexedSubFile (rsComm, structFileInx, subFile, 0));
+    }
+
     /* use the cached specColl. specColl may have changed */
     specColl = StructFileDesc[structFileInx].specColl;
 
@@ -168,6 +179,22 @@ tarSubStructFileRead (rsComm_t *rsComm, int subInx, void *buf, int len)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].indexFlag > 0) {
+	/* read the member straight from the tar file */
+	tarPhyFileCtx_t readCtx;
+	rodsLong_t toRead = TarSubFileDesc[subInx].member.size -
+	  TarSubFileDesc[subInx].offset;
+
+	if (toRead <= 0) return (0);
+	if (len > toRead) len = (int) toRead;
+	readCtx.rsComm = rsComm;
+	readCtx.l3descInx = TarSubFileDesc[subInx].fd;
+	status = readTarPhyFile (&readCtx, TarSubFileDesc[subInx].member.offset
+	  + TarSubFileDesc[subInx].offset, (char *) buf, len);
+	if (status > 0) TarSubFileDesc[subInx].offset += status;
+	return (status);
+    }
+
     memset (&fileReadInp, 0, sizeof (fileReadInp));
     memset (&fileReadOutBBuf, 0, sizeof (fileReadOutBBuf));
     fileReadInp.fileInx = TarSubFileDesc[subInx].fd;
@@ -192,6 +219,11 @@ tarSubStructFileWrite (rsComm_t *rsComm, int subInx, void *buf, int len)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].indexFlag > 0) {
+	/* opened O_RDONLY */
+	return (UNIX_FILE_WRITE_ERR - EBADF);
+    }
+
     memset (&fileWriteInp, 0, sizeof (fileWriteInp));
     memset (&fileWriteOutBBuf, 0, sizeof (fileWriteOutBBuf));
     fileWriteInp.fileInx = TarSubFileDesc[subInx].fd;
@@ -233,7 +265,8 @@ tarSubStructFileClose (rsComm_t *rsComm, int subInx)
     status = rsFileClose (rsComm, &fileCloseInp);
 
     structFileInx = TarSubFileDesc[subInx].structFileInx;
-    StructFileDesc[structFileInx].openCnt++;
+    if (TarSubFileDesc[subInx].indexFlag == 0) 
+        StructFileDesc[structFileInx].openCnt++;
     freeTarSubFileDesc (subInx);
 
     return (status);
@@ -296,10 +329,11 @@ rodsStat_t **subStructFileStatOut)
     int structFileInx;
     int rescTypeInx;
     int status; 
+    int indexFlag = 0;
     fileStatInp_t fileStatInp;
 
     specColl = subFile->specColl;
-    structFileInx = rsTarStructFileOpen (rsComm, specColl);
+    structFileInx = rsTarStructFileOpenForRead (rsComm, specColl, &indexFlag);
 
     if (structFileInx < 0) {
         rodsLog (LOG_NOTICE,
@@ -311,6 +345,27 @@ rodsStat_t **subStructFileStatOut)
     /* use the cached specColl. specColl may have changed */
     specColl = StructFileDesc[structFileInx].specColl;
 
+    if (indexFlag > 0) {
+	tarIndex_t *tarIndex = StructFileDesc[structFileInx].tarIndex;
+	tarIndexEntry_t rootEntry;
+	char memberName[MAX_NAME_LEN];
+	int inx;
+
+        status = getSubStructFileMember (specColl, subFile->subFilePath,
+	  memberName);
+	if (status < 0) return status;
+	inx = findTarIndexEntry (tarIndex, memberName);
+	if (inx < TAR_INDEX_ROOT) return (UNIX_FILE_STAT_ERR - ENOENT);
+	if (inx == TAR_INDEX_ROOT) {
+	    memset (&rootEntry, 0, sizeof (rootEntry));
+	    rootEntry.mode = S_IFDIR | 0755;
+	    rootEntry.mtime = tarIndex->hdr.tarMtime;
+	    return (tarIndexEntryToStat (&rootEntry, subStructFileStatOut));
+	}
+	return (tarIndexEntryToStat (&tarIndex->entries[inx], 
+	  subStructFileStatOut));
+    }
+
     memset (&fileStatInp, 0, sizeof (fileStatInp));
 
     status = getSubStructFilePhyPath (fileStatInp.fileName, specColl, 
@@ -341,6 +396,11 @@ rodsStat_t **subStructFileStatOut)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].indexFlag > 0) {
+	return (tarIndexEntryToStat (&TarSubFileDesc[subInx].member,
+	  subStructFileStatOut));
+    }
+
     memset (&fileFstatInp, 0, sizeof (fileFstatInp));
     fileFstatInp.fileInx = TarSubFileDesc[subInx].fd;
     status = rsFileFstat (rsComm, &fileFstatInp, subStructFileStatOut);
@@ -363,6 +423,21 @@ int whence)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
 
+    if (TarSubFileDesc[subInx].indexFlag > 0) {
+	rodsLong_t newOffset;
+
+	if (whence == SEEK_CUR) {
+	    newOffset = TarSubFileDesc[subInx].offset + offset;
+	} else if (whence == SEEK_END) {
+	    newOffset = TarSubFileDesc[subInx].member.size + offset;
+	} else {
+	    newOffset = offset;
+	}
+	if (newOffset < 0) return (UNIX_FILE_LSEEK_ERR - EINVAL);
+	TarSubFileDesc[subInx].offset = newOffset;
+	return (newOffset);
+    }
+
     memset (&fileLseekInp, 0, sizeof (fileLseekInp));
     fileLseekInp.fileInx = TarSubFileDesc[subInx].fd;
     fileLseekInp.offset = offset;
@@ -531,10 +606,11 @@ tarSubStructFileOpendir (rsComm_t *rsComm, subFile_t *subFile)
     int subInx;
     int rescTypeInx;
     int status;
+    int indexFlag = 0;
     fileOpendirInp_t fileOpendirInp;
 
     specColl = subFile->specColl;
-    structFileInx = rsTarStructFileOpen (rsComm, specColl);
+    structFileInx = rsTarStructFileOpenForRead (rsComm, specColl, &indexFlag);
 
     if (structFileInx < 0) {
         rodsLog (LOG_NOTICE,
@@ -543,6 +619,10 @@ tarSubStructFileOpendir (rsComm_t *rsComm, subFile_t *subFile)
         return (structFileInx);
     }
 
+    if (indexFlag > 0) {
+	return (openIndexedSubFile (rsComm, structFileInx, subFile, 1));
+    }
+
     /* use the cached specColl. specColl may have changed */
     specColl = StructFileDesc[structFileInx].specColl;
 
@@ -590,6 +670,27 @@ rodsDirent_t **rodsDirent)
 	return (SYS_STRUCT_FILE_DESC_ERR);
     }
        
+    if (TarSubFileDesc[subInx].indexFlag > 0) {
+	tarIndex_t *tarIndex = 
+	  StructFileDesc[TarSubFileDesc[subInx].structFileInx].tarIndex;
+	int inx;
+
+	if (tarIndex == NULL) return (SYS_STRUCT_FILE_DESC_ERR);
+	inx = nextTarIndexChild (tarIndex, TarSubFileDesc[subInx].tarIndexInx,
+	  (int) TarSubFileDesc[subInx].offset);
+	if (inx < 0) return (-1);	/* end of dir like rsFileReaddir */
+	*rodsDirent = (rodsDirent_t *) calloc (1, sizeof (rodsDirent_t));
+	if (*rodsDirent == NULL) return (SYS_MALLOC_ERR);
+	rstrcpy ((*rodsDirent)->d_name, getTarIndexBaseName (tarIndex, inx),
+	  DIR_LEN);
+	(*rodsDirent)->d_ino = inx + 1;
+	(*rodsDirent)->d_offset = inx + 1;
+	(*rodsDirent)->d_namlen = strlen ((*rodsDirent)->d_name);
+	(*rodsDirent)->d_reclen = sizeof (rodsDirent_t);
+	TarSubFileDesc[subInx].offset = inx + 1;
+	return (0);
+    }
+
     fileReaddirInp.fileInx = TarSubFileDesc[subInx].fd;
     status = rsFileReaddir (rsComm, &fileReaddirInp, rodsDirent);
 
@@ -611,6 +712,11 @@ tarSubStructFileClosedir (rsComm_t *rsComm, int subInx)
         return (SYS_STRUCT_FILE_DESC_ERR);
     }
     
+    if (TarSubFileDesc[subInx].indexFlag > 0) {
+	freeTarSubFileDesc (subInx);
+	return (0);
+    }
+
     fileClosedirInp.fileInx = TarSubFileDesc[subInx].fd;
     status = rsFileClosedir (rsComm, &fileClosedirInp);
     
@@ -725,6 +831,7 @@ tarStructFileSync (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
     specColl = StructFileDesc[structFileInx].specColl;
     if ((structFileOprInp->oprType & DELETE_STRUCT_FILE) != 0) {
 	/* remove cache and the struct file */
+	unlinkTarIndexFile (structFileInx);
 	freeStructFileDesc (structFileInx);
 	return (status);
     }
@@ -737,6 +844,10 @@ tarStructFileSync (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
 	    /* write the tar file and register no dirty */
 	    status = syncCacheDirToTarfile (structFileInx, 
 	      structFileOprInp->oprType);
+	    if ((structFileOprInp->oprType & ADD_TO_TAR_OPR) == 0) {
+		/* rewritten. An append is picked up by loadTarIndex */
+		unlinkTarIndexFile (structFileInx);
+	    }
             if (status < 0) {
                 rodsLog (LOG_ERROR,
                   "tarPhyStructFileSync:syncCacheDirToTarfile %s error,stat=%d",
@@ -839,6 +950,15 @@ tarStructFileExtract (rsComm_t *rsComm, structFileOprInp_t *structFileOprInp)
 
 int
 rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
+{
+    return (_rsTarStructFileOpen (rsComm, specColl, 1));
+}
+
+/* _rsTarStructFileOpen - get a StructFileDesc for specColl. The tar file
+ * is staged into the cacheDir if stageFlag is set. */
+
+int
+_rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl, int stageFlag)
 {
     int structFileInx;
     int status;
@@ -854,7 +974,14 @@ rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
 
     structFileInx = matchStructFileDesc (specColl);
 
-    if (structFileInx > 0) return structFileInx;
+    if (structFileInx > 0) {
+	/* may have been opened with the tarIndex only */
+	if (stageFlag > 0) {
+	    status = stageTarStructFile (structFileInx);
+	    if (status < 0) return status;
+	}
+	return structFileInx;
+    }
  
     if ((structFileInx = allocStructFileDesc ()) < 0) {
         return (structFileInx);
@@ -892,14 +1019,462 @@ rsTarStructFileOpen (rsComm_t *rsComm, specColl_t *specColl)
 
     /* XXXXX need to deal with remote open here */
 
-    status = stageTarStructFile (structFileInx);
+    if (stageFlag > 0) {
+        status = stageTarStructFile (structFileInx);
+
+        if (status < 0) {
+	    freeStructFileDesc (structFileInx);
+	    return status;
+        }
+    }
+
+    return (structFileInx);
+}
 
+/* rsTarStructFileOpenForRead - rsTarStructFileOpen for read only access.
+ * If the tar file has no cacheDir and can be indexed, it is not staged and
+ * *indexFlag is set so that the members are read straight from the tar
+ * file. Otherwise it is staged as usual.
+ */
+
+int
+rsTarStructFileOpenForRead (rsComm_t *rsComm, specColl_t *specColl,
+int *indexFlag)
+{
+    int structFileInx;
+    int status;
+
+    *indexFlag = 0;
+    structFileInx = _rsTarStructFileOpen (rsComm, specColl, 0);
+    if (structFileInx < 0) return structFileInx;
+
+    if (strlen (StructFileDesc[structFileInx].specColl->cacheDir) == 0 &&
+      loadTarIndex (structFileInx) >= 0) {
+	*indexFlag = 1;
+	return structFileInx;
+    }
+
+    status = stageTarStructFile (structFileInx);
     if (status < 0) {
-	freeStructFileDesc (structFileInx);
+	if (StructFileDesc[structFileInx].openCnt <= 0) 
+	    freeStructFileDesc (structFileInx);
 	return status;
     }
+    return structFileInx;
+}
 
-    return (structFileInx);
+/* loadTarIndex - load the member index of the tar file into
+ * StructFileDesc[structFileInx].tarIndex. The saved index file (see
+ * getTarIndexPath) is used if it was made for the current size and mtime
+ * of the tar file. If the tar file has grown and still has the last member
+ * of the index where it was (tar -r), only the new members are scanned.
+ * Otherwise the whole tar file is scanned. Compressed tar files cannot be indexed.
+ */
+
+int
+loadTarIndex (int structFileInx)
+{
+    int status;
+    int rescTypeInx;
+    tarIndex_t *tarIndex = NULL;
+    specColl_t *specColl = StructFileDesc[structFileInx].specColl;
+    rsComm_t *rsComm = StructFileDesc[structFileInx].rsComm;
+    char *dataType = StructFileDesc[structFileInx].dataType;
+    fileStatInp_t fileStatInp;
+    rodsStat_t *fileStatOut = NULL;
+    fileCloseInp_t fileCloseInp;
+    rodsLong_t tarSize;
+    unsigned int tarMtime;
+    tarPhyFileCtx_t readCtx;
+
+    if (StructFileDesc[structFileInx].tarIndex != NULL) return (0);
+
+    if (strstr (dataType, GZIP_TAR_DT_STR) != NULL ||
+      strstr (dataType, BZIP2_TAR_DT_STR) != NULL ||
+      strstr (dataType, ZIP_DT_STR) != NULL) {
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+
+    memset (&fileStatInp, 0, sizeof (fileStatInp));
+    rstrcpy (fileStatInp.fileName, specColl->phyPath, MAX_NAME_LEN);
+    rescTypeInx = StructFileDesc[structFileInx].rescInfo->rescTypeInx;
+    fileStatInp.fileType = 
+      (fileDriverType_t)RescTypeDef[rescTypeInx].driverType;
+    rstrcpy (fileStatInp.addr.hostAddr,
+      StructFileDesc[structFileInx].rescInfo->rescLoc, NAME_LEN);
+    status = rsFileStat (rsComm, &fileStatInp, &fileStatOut);
+    if (status < 0 || fileStatOut == NULL) {
+	return (status < 0 ? status : SYS_INTERNAL_NULL_INPUT_ERR);
+    }
+    tarSize = fileStatOut->st_size;
+    tarMtime = fileStatOut->st_mtim;
+    free (fileStatOut);
+
+    if (readTarIndexFile (structFileInx, &tarIndex) >= 0 &&
+      tarIndex->hdr.tarSize == tarSize && tarIndex->hdr.tarMtime == tarMtime) {
+	StructFileDesc[structFileInx].tarIndex = tarIndex;
+	return (0);
+    }
+
+    readCtx.rsComm = rsComm;
+    readCtx.l3descInx = openTarPhyFile (structFileInx, specColl->phyPath,
+      O_RDONLY, 0);
+    if (readCtx.l3descInx < 0) {
+	freeTarIndex (tarIndex);
+	return (readCtx.l3descInx);
+    }
+
+    if (tarIndex != NULL && tarIndex->hdr.tarSize < tarSize &&
+      verifyTarIndexTail (tarIndex, readTarPhyFile, &readCtx) >= 0) {
+	/* appended to. scan the new members only */
+	status = scanTarFile (tarIndex, tarIndex->hdr.endOffset,
+	  readTarPhyFile, &readCtx);
+    } else {
+	freeTarIndex (tarIndex);
+	if ((tarIndex = newTarIndex ()) == NULL) {
+	    status = SYS_MALLOC_ERR;
+	} else {
+	    status = scanTarFile (tarIndex, 0, readTarPhyFile, &readCtx);
+	}
+    }
+    if (status >= 0) status = sortTarIndex (tarIndex);
+
+    fileCloseInp.fileInx = readCtx.l3descInx;
+    rsFileClose (rsComm, &fileCloseInp);
+
+    if (status < 0) {
+	rodsLog (LOG_DEBUG,
+	  "loadTarIndex: cannot index %s, status = %d", specColl->phyPath,
+	  status);
+	freeTarIndex (tarIndex);
+	return (status);
+    }
+
+    tarIndex->hdr.tarSize = tarSize;
+    tarIndex->hdr.tarMtime = tarMtime;
+    /* the index file is only a cache. Don't fail if it cannot be written */
+    writeTarIndexFile (structFileInx, tarIndex);
+    StructFileDesc[structFileInx].tarIndex = tarIndex;
+    return (0);
+}
+
+/* getTarIndexPath - the path of the index file of the tar file. Index files
+ * are a server-private cache kept in getStateDir()/TAR_INDEX_DIR of the
+ * resource server, named by the md5 of the resource name and the phyPath
+ * of the tar file, so they never show up in (or clobber files in) the
+ * vault. If mkFlag is set, the dir is made if it does not exist */
+
+int
+getTarIndexPath (int structFileInx, char *indexPath, int mkFlag)
+{
+    MD5_CTX context;
+    unsigned char digest[16];
+    char digestStr[2 * 16 + 1];
+    char indexDir[MAX_NAME_LEN];
+    specColl_t *specColl = StructFileDesc[structFileInx].specColl;
+    rescInfo_t *rescInfo = StructFileDesc[structFileInx].rescInfo;
+    int i;
+
+    if (snprintf (indexDir, MAX_NAME_LEN, "%s/%s", getStateDir (),
+      TAR_INDEX_DIR) >= MAX_NAME_LEN) {
+	rodsLog (LOG_ERROR,
+	  "getTarIndexPath: index dir path for %s too long", specColl->phyPath);
+	return (USER_PATH_EXCEEDS_MAX);
+    }
+    if (mkFlag && mkdir (indexDir, DEFAULT_DIR_MODE) < 0 && errno != EEXIST) {
+	return (UNIX_FILE_MKDIR_ERR - errno);
+    }
+
+    MD5Init (&context);
+    MD5Update (&context, (unsigned char *) rescInfo->rescName,
+      strlen (rescInfo->rescName) + 1);
+    MD5Update (&context, (unsigned char *) specColl->phyPath,
+      strlen (specColl->phyPath));
+    MD5Final (digest, &context);
+    for (i = 0; i < 16; i++) {
+	sprintf (&digestStr[2 * i], "%02x", digest[i]);
+    }
+
+    if (snprintf (indexPath, MAX_NAME_LEN, "%s/%s%s", indexDir, digestStr,
+      TAR_INDEX_SUFFIX) >= MAX_NAME_LEN) {
+	rodsLog (LOG_ERROR,
+	  "getTarIndexPath: index file path for %s too long", specColl->phyPath);
+	return (USER_PATH_EXCEEDS_MAX);
+    }
+    return (0);
+}
+
+int
+readTarIndexFile (int structFileInx, tarIndex_t **outTarIndex)
+{
+    int status;
+    int fd;
+    struct stat statbuf;
+    char indexPath[MAX_NAME_LEN];
+    char *buf;
+    int len;
+
+    *outTarIndex = NULL;
+    if ((status = getTarIndexPath (structFileInx, indexPath, 0)) < 0) {
+	return (status);
+    }
+    if ((fd = open (indexPath, O_RDONLY, 0)) < 0) {
+	return (UNIX_FILE_OPEN_ERR - errno);
+    }
+    if (fstat (fd, &statbuf) < 0) {
+	status = UNIX_FILE_STAT_ERR - errno;
+	close (fd);
+	return (status);
+    }
+    len = (int) statbuf.st_size;
+    if (len < (int) sizeof (tarIndexHeader_t)) {
+	close (fd);
+	return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+
+    if ((buf = (char *) malloc (len)) == NULL) {
+	status = SYS_MALLOC_ERR;
+    } else if (myRead (fd, buf, len, FILE_DESC_TYPE, NULL, NULL) != len) {
+	status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+    } else {
+	status = unpackTarIndex (buf, len, outTarIndex);
+    }
+    if (buf != NULL) free (buf);
+    close (fd);
+
+    return (status);
+}
+
+/* writeTarIndexFile - write the index file. It is written to a temp file
+ * first and renamed so that other agents never read a partial index */
+
+int
+writeTarIndexFile (int structFileInx, tarIndex_t *tarIndex)
+{
+    int status;
+    int fd;
+    char *buf = NULL;
+    int len;
+    char indexPath[MAX_NAME_LEN];
+    char tmpPath[MAX_NAME_LEN];
+
+    if ((status = getTarIndexPath (structFileInx, indexPath, 1)) < 0) {
+	rodsLog (LOG_DEBUG,
+	  "writeTarIndexFile: no index dir for %s, status = %d",
+	  StructFileDesc[structFileInx].specColl->phyPath, status);
+	return (status);
+    }
+    if (snprintf (tmpPath, MAX_NAME_LEN, "%s.%d", indexPath, getpid ()) >=
+      MAX_NAME_LEN) {
+	return (USER_PATH_EXCEEDS_MAX);
+    }
+
+    if ((status = packTarIndex (tarIndex, &buf, &len)) < 0) return (status);
+
+    fd = open (tmpPath, O_WRONLY | O_CREAT | O_TRUNC, DEFAULT_FILE_MODE);
+    if (fd < 0) {
+	status = UNIX_FILE_CREATE_ERR - errno;
+	rodsLog (LOG_DEBUG,
+	  "writeTarIndexFile: cannot create %s, status = %d", tmpPath, status);
+	free (buf);
+	return (status);
+    }
+
+    status = myWrite (fd, buf, len, FILE_DESC_TYPE, NULL);
+    free (buf);
+    if (close (fd) < 0 && status >= 0) {
+	status = UNIX_FILE_CLOSE_ERR - errno;
+    }
+
+    if (status == len) {
+	if (rename (tmpPath, indexPath) < 0) {
+	    status = UNIX_FILE_RENAME_ERR - errno;
+	}
+    } else if (status >= 0) {
+	status = SYS_COPY_LEN_ERR;
+    }
+
+    if (status < 0) {
+	rodsLog (LOG_NOTICE,
+	  "writeTarIndexFile: write of %s error, status = %d",
+	  indexPath, status);
+	unlink (tmpPath);
+	return (status);
+    }
+    return (0);
+}
+
+/* unlinkTarIndexFile - remove the index file of a tar file that is
+ * rewritten or removed */
+
+int
+unlinkTarIndexFile (int structFileInx)
+{
+    int status;
+    char indexPath[MAX_NAME_LEN];
+
+    freeTarIndex (StructFileDesc[structFileInx].tarIndex);
+    StructFileDesc[structFileInx].tarIndex = NULL;
+
+    if ((status = getTarIndexPath (structFileInx, indexPath, 0)) < 0) {
+	return (status);
+    }
+    if (unlink (indexPath) < 0 && errno != ENOENT) {
+	return (UNIX_FILE_UNLINK_ERR - errno);
+    }
+    return (0);
+}
+
+/* openTarPhyFile - open the tar file with the driver of the resource.
+ * Returns the l3descInx */
+
+int
+openTarPhyFile (int structFileInx, char *fileName, int flags, int mode)
+{
+    int rescTypeInx;
+    fileOpenInp_t fileOpenInp;
+    rescInfo_t *rescInfo = StructFileDesc[structFileInx].rescInfo;
+
+    memset (&fileOpenInp, 0, sizeof (fileOpenInp));
+    rescTypeInx = rescInfo->rescTypeInx;
+    fileOpenInp.fileType = 
+      (fileDriverType_t)RescTypeDef[rescTypeInx].driverType;
+    rstrcpy (fileOpenInp.addr.hostAddr,  rescInfo->rescLoc, NAME_LEN);
+    rstrcpy (fileOpenInp.fileName, fileName, MAX_NAME_LEN);
+    fileOpenInp.mode = mode;
+    fileOpenInp.flags = flags;
+    if ((flags & O_CREAT) != 0) {
+	return (rsFileCreate (StructFileDesc[structFileInx].rsComm,
+	  &fileOpenInp));
+    }
+    return (rsFileOpen (StructFileDesc[structFileInx].rsComm, &fileOpenInp));
+}
+
+/* readTarPhyFile - the tarReadFunc_t of the server. readCtx is a
+ * tarPhyFileCtx_t */
+
+int
+readTarPhyFile (void *readCtx, rodsLong_t offset, char *buf, int len)
+{
+    tarPhyFileCtx_t *ctx = (tarPhyFileCtx_t *) readCtx;
+    fileLseekInp_t fileLseekInp;
+    fileLseekOut_t *fileLseekOut = NULL;
+    fileReadInp_t fileReadInp;
+    bytesBuf_t fileReadOutBBuf;
+    int status;
+    int bytesRead = 0;
+
+    memset (&fileLseekInp, 0, sizeof (fileLseekInp));
+    fileLseekInp.fileInx = ctx->l3descInx;
+    fileLseekInp.offset = offset;
+    fileLseekInp.whence = SEEK_SET;
+    status = rsFileLseek (ctx->rsComm, &fileLseekInp, &fileLseekOut);
+    if (fileLseekOut != NULL) free (fileLseekOut);
+    if (status < 0) return (status);
+
+    while (bytesRead < len) {
+	memset (&fileReadInp, 0, sizeof (fileReadInp));
+	fileReadInp.fileInx = ctx->l3descInx;
+	fileReadInp.len = len - bytesRead;
+	fileReadOutBBuf.buf = buf + bytesRead;
+	fileReadOutBBuf.len = 0;
+	status = rsFileRead (ctx->rsComm, &fileReadInp, &fileReadOutBBuf);
+	if (status < 0) return (status);
+	if (status == 0) break;
+	bytesRead += status;
+    }
+    return (bytesRead);
+}
+
+/* getSubStructFileMember - the member name of subFilePath in the tar
+ * file */
+
+int
+getSubStructFileMember (specColl_t *specColl, char *subFilePath,
+char *memberName)
+{
+    int len;
+
+    len = strlen (specColl->collection);
+    if (strncmp (specColl->collection, subFilePath, len) != 0) {
+        rodsLog (LOG_NOTICE,
+         "getSubStructFileMember: collection %s subFilePath %s mismatch",
+          specColl->collection, subFilePath);
+        return (SYS_STRUCT_FILE_PATH_ERR);
+    }
+    rstrcpy (memberName, subFilePath + len, MAX_NAME_LEN);
+    return (0);
+}
+
+int
+tarIndexEntryToStat (tarIndexEntry_t *member, rodsStat_t **statOut)
+{
+    rodsStat_t *myStat;
+
+    myStat = (rodsStat_t *) calloc (1, sizeof (rodsStat_t));
+    if (myStat == NULL) return (SYS_MALLOC_ERR);
+    myStat->st_size = member->size;
+    myStat->st_mode = member->mode;
+    myStat->st_nlink = 1;
+    myStat->st_atim = myStat->st_mtim = myStat->st_ctim = member->mtime;
+    myStat->st_blksize = TAR_BLOCK_SIZE;
+    myStat->st_blocks = (member->size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE;
+    *statOut = myStat;
+    return (0);
+}
+
+/* openIndexedSubFile - open a member (or a dir if dirFlag is set) of an
+ * indexed tar file. Returns the subInx. */
+
+int
+openIndexedSubFile (rsComm_t *rsComm, int structFileInx, subFile_t *subFile,
+int dirFlag)
+{
+    int status;
+    int subInx;
+    int inx;
+    char memberName[MAX_NAME_LEN];
+    tarIndex_t *tarIndex = StructFileDesc[structFileInx].tarIndex;
+    specColl_t *specColl = StructFileDesc[structFileInx].specColl;
+
+    status = getSubStructFileMember (specColl, subFile->subFilePath,
+      memberName);
+    if (status < 0) return status;
+
+    inx = findTarIndexEntry (tarIndex, memberName);
+    if (inx < TAR_INDEX_ROOT) return (dirFlag ?
+      UNIX_FILE_OPENDIR_ERR - ENOENT : UNIX_FILE_OPEN_ERR - ENOENT);
+    if (dirFlag) {
+	if (inx != TAR_INDEX_ROOT && 
+	  !S_ISDIR (tarIndex->entries[inx].mode)) {
+	    return (UNIX_FILE_OPENDIR_ERR - ENOTDIR);
+	}
+    } else if (inx == TAR_INDEX_ROOT ||
+      S_ISDIR (tarIndex->entries[inx].mode)) {
+	return (UNIX_FILE_OPEN_ERR - EISDIR);
+    }
+
+    subInx = allocTarSubFileDesc ();
+    if (subInx < 0) return subInx;
+
+    TarSubFileDesc[subInx].structFileInx = structFileInx;
+    TarSubFileDesc[subInx].indexFlag = 1;
+    TarSubFileDesc[subInx].tarIndexInx = inx;
+    TarSubFileDesc[subInx].offset = 0;
+    if (dirFlag) return (subInx);
+
+    TarSubFileDesc[subInx].member = tarIndex->entries[inx];
+    TarSubFileDesc[subInx].fd = openTarPhyFile (structFileInx,
+      specColl->phyPath, O_RDONLY, 0);
+    if (TarSubFileDesc[subInx].fd < 0) {
+	status = TarSubFileDesc[subInx].fd;
+	rodsLog (LOG_ERROR,
+	  "openIndexedSubFile: open of %s error, status = %d",
+	  specColl->phyPath, status);
+	freeTarSubFileDesc (subInx);
+	return (status);
+    }
+    return (subInx);
 }
 
 int
@@ -981,8 +1556,13 @@ mkTarCacheDir (int structFileInx)
     rstrcpy (fileMkdirInp.addr.hostAddr,  rescInfo->rescLoc, NAME_LEN);
 
     while (1) {
-        snprintf (fileMkdirInp.dirName, MAX_NAME_LEN, "%s.%s%d",
-          specColl->phyPath, CACHE_DIR_STR, i);
+        if (snprintf (fileMkdirInp.dirName, MAX_NAME_LEN, "%s.%s%d",
+          specColl->phyPath, CACHE_DIR_STR, i) >= MAX_NAME_LEN) {
+            rodsLog (LOG_ERROR, 
+              "mkTarCacheDir: cacheDir path for %s too long", 
+              specColl->phyPath);
+            return (USER_PATH_EXCEEDS_MAX);
+        }
         status = rsFileMkdir (rsComm, &fileMkdirInp);
         if (status >= 0) {
 	    break;
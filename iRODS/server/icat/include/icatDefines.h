@@ -12,12 +12,15 @@
 
 #define   MAX_NUM_OF_SELECT_ITEMS                  30
 #define   MAX_NUM_OF_CONCURRENT_STMTS              50
+#define   MAX_NUM_OF_PREPARED_STMTS                32  /* per session cache */
 #define   MAX_NUM_OF_COLS_IN_TABLE                 50
 #define   MAX_SQL_SIZE  4000
 #define   MAX_SQL_SIZE_GENERAL_QUERY  12000
 
 #define MAX_INTEGER_SIZE 40  /* ??, for now */
 
+#define BULK_AVU_ITEMS_PER_SQL  100  /* bind variables of a lookup */
+
 #define DB_USERNAME_LEN       64
 #define DB_PASSWORD_LEN       64
 #define DB_TYPENAME_LEN       64
@@ -20,6 +20,7 @@
 int chlOpen(char *DBUser, char *DBpasswd);
 int chlClose();
 int chlIsConnected();
+int chlResetSession(rsComm_t *rsComm);
 int chlModDataObjMeta(rsComm_t *rsComm, dataObjInfo_t *dataObjInfo,
     keyValPair_t *regParam);
 int chlRegDataObj(rsComm_t *rsComm, dataObjInfo_t *dataObjInfo);
@@ -46,6 +47,9 @@ int chlGenQuery(genQueryInp_t genQueryInp, genQueryOut_t *result);
 int chlGenQueryAccessControlSetup(char *user, char *zone, char *host, 
 				  int priv, int controlFlag);
 int chlGenQueryTicketSetup(char *ticket, char *clientAddr);
+int chlGenQueryResetSession();
+int chlGenQuerySqlCache(int mode);
+int chlGenQueryShapeStats(int logLevel);
 int chlSpecificQuery(specificQueryInp_t specificQueryInp,
                      genQueryOut_t *genQueryOut);
 
@@ -75,6 +79,9 @@ int chlAddAVUMetadata(rsComm_t *rsComm, int adminMode, char *type,
     char *name, char *attribute, char *value,  char *units);
 int chlAddAVUMetadataWild(rsComm_t *rsComm, int adminMode, char *type, 
     char *name, char *attribute, char *value,  char *units);
+int chlBulkAVUMetadata(rsComm_t *rsComm, int adminMode, int numOps,
+    char *op[], char *type[], char *name[], char *attribute[], char *value[],
+    char *units[]);
 int chlDeleteAVUMetadata(rsComm_t *rsComm, int option, char *type, 
     char *name, char *attribute, char *value,  char *units, int noCommit);
 int chlSetAVUMetadata(rsComm_t *rsComm, char *type, 
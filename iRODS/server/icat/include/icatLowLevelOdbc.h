@@ -26,6 +26,7 @@
 #include "icatMidLevelRoutines.h"
 
 #define MAX_BIND_VARS  120
+#define MAX_BIND_ARRAY_ROWS  500  /* rows per cllExecSqlNoResultArray call */
 
 extern int cllBindVarCount;
 extern char *cllBindVars[MAX_BIND_VARS];
@@ -60,5 +61,8 @@ int cllCurrentValueString(char *itemName, char *outString, int maxSize);
 int cllGetRowCount(icatSessionStruct *icss, int statementNumber);
 int cllCheckPending(char *sql, int option, int dbType);
 int cllGetLastErrorMessage(char *msg, int maxChars);
+int cllFreeStmtCache(icatSessionStruct *icss);
+int cllExecSqlNoResultArray(icatSessionStruct *icss, char *sql, int numVars,
+			    int numRows, char **values);
 
 #endif	/* CLL_PSQ_H */
@@ -39,4 +39,6 @@ int cllGetRowCount(icatSessionStruct *icss, int statementNumber);
 int cllConnectRda(icatSessionStruct *icss);
 int cllConnectDbr(icatSessionStruct *icss, char *unused);
 int cllGetLastErrorMessage(char *msg, int maxChars);
+int cllExecSqlNoResultArray(icatSessionStruct *icss, char *sql, int numVars,
+			    int numRows, char **values);
 #endif	/* CLL_ORA_H */
@@ -19,6 +19,9 @@ int cmlClose( icatSessionStruct *icss);
 int cmlExecuteNoAnswerSql( char *sql, 
 			   icatSessionStruct *icss);
 
+int cmlExecuteNoAnswerSqlArray( char *sql, int numVars, int numRows,
+				char **values, icatSessionStruct *icss);
+
 int cmlGetRowFromSql (char *sql, 
 		   char *cVal[], 
 		   int cValSize[], 
@@ -20,8 +20,28 @@ typedef struct
   int     selectColIds[MAX_NUM_OF_SELECT_ITEMS];  /* rods-id to column in the
                                                      result (unused, so far) */
   char    *resultValue[MAX_NUM_OF_SELECT_ITEMS];  /* pointer to data area */
+  int     preparedInx;        /* slot in the prepared statement cache, or
+                                 -1 if stmtPtr is owned by this struct */
 } icatStmtStrct;
 
+/* A prepared statement kept for reuse, keyed by its sql text */
+typedef struct
+{
+  void*   stmtPtr;            /* prepared db statement handle, 0 if free */
+  char    *sql;               /* the sql text it was prepared from */
+  int     inUse;              /* 1 while a result set is open on it */
+  unsigned int lastUsed;      /* LRU clock value of the last use */
+} icatPreparedStmt;
+
+typedef struct
+{
+  int     disabled;           /* 1 to prepare/execute each time as before */
+  unsigned int clock;         /* incremented on each lookup */
+  int     hits;
+  int     misses;
+  icatPreparedStmt stmt[MAX_NUM_OF_PREPARED_STMTS];
+} icatStmtCache;
+
 
 
 typedef struct {
@@ -32,6 +52,7 @@ typedef struct {
   char databaseUsername[DB_USERNAME_LEN];  /* username for accessing the db */
   char databasePassword[DB_PASSWORD_LEN];  /* password for accessing the db */
   int         databaseType;     /* DB type, DB_TYPE_POSTGRES, etc */
+  icatStmtCache stmtCache;      /* prepared statements (ODBC only) */
 }icatSessionStruct;
 
 
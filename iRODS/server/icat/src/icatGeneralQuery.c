@@ -23,6 +23,7 @@
  be called when the tables change to make sure there are no cycles.
 
  */
+#include <sys/time.h>
 #include "rodsClient.h"
 #include "icatHighLevelRoutines.h"
 #include "icatMidLevelRoutines.h"
@@ -107,6 +108,37 @@ char tableAbbrevs;
 int debug=0;
 int debug2=0;
 
+/*
+ The SELECT/FROM/GROUP BY skeleton and the table-linking part of the
+ WHERE clause only depend on the select columns, the condition columns
+ and the distinct option, so they are kept per query 'shape' in this
+ small cache instead of being regenerated (via setTable and tScan) on
+ each call.  The conditions themselves are still added each time, so
+ their values are bound per call as before.  Per shape, the time spent
+ generating SQL and executing it in the DBMS is also accumulated (see
+ chlGenQueryShapeStats).
+ */
+#define GQ_SQL_CACHE_SIZE 64
+#define GQ_SIG_LEN 2048
+
+struct genQuerySqlCache {
+   char *sig;            /* shape signature, NULL if the slot is free */
+   char *selectSQL;
+   char *fromSQL;
+   char *groupBySQL;
+   char *joinSQL;        /* appended to whereSQL after the conditions */
+   int mightNeedGroupBy;
+   unsigned int lastUsed;
+   int calls;
+   int hits;
+   rodsLong_t genUsec;   /* time spent in generateSQL */
+   rodsLong_t execUsec;  /* time spent executing the first fetch */
+} GenQuerySqlCache[GQ_SQL_CACHE_SIZE];
+
+int genQuerySqlCacheOff=0;
+unsigned int genQuerySqlCacheClock=0;
+int genQueryShapeIx=-1;  /* cache slot of the last generated query */
+
 /*
  Used by fklink (below) to find an existing name and return the
  value.  Once the table is set up, the code can use the integer
@@ -1513,6 +1545,114 @@ generateSpecialQuery(genQueryInp_t genQueryInp, char *resultingSQL) {
    return (0);
 }
 
+/*
+ Build the shape signature of a query: the distinct option, the select
+ columns with their select options and the condition columns.  Returns
+ -1 if it does not fit (the query is then not cached).
+ */
+int
+genQuerySignature(genQueryInp_t genQueryInp, char *sig, int maxLen) {
+   int i, len;
+
+   len = snprintf(sig, maxLen, "%d|", 
+		  (genQueryInp.options & NO_DISTINCT) ? 1 : 0);
+   for (i=0;i<genQueryInp.selectInp.len && len < maxLen;i++) {
+      len += snprintf(sig+len, maxLen-len, "%d:%d,", 
+		      genQueryInp.selectInp.inx[i],
+		      genQueryInp.selectInp.value[i]&0xf);
+   }
+   if (len < maxLen) len += snprintf(sig+len, maxLen-len, "|");
+   for (i=0;i<genQueryInp.sqlCondInp.len && len < maxLen;i++) {
+      len += snprintf(sig+len, maxLen-len, "%d,", 
+		      genQueryInp.sqlCondInp.inx[i]);
+   }
+   if (len >= maxLen) return(-1);
+   return(0);
+}
+
+/* Return the cache slot of a query shape, or -1 */
+int
+findGenQuerySqlCache(char *sig) {
+   int i;
+
+   for (i=0;i<GQ_SQL_CACHE_SIZE;i++) {
+      if (GenQuerySqlCache[i].sig != NULL &&
+	  strcmp(GenQuerySqlCache[i].sig, sig)==0) {
+	 GenQuerySqlCache[i].lastUsed = ++genQuerySqlCacheClock;
+	 return(i);
+      }
+   }
+   return(-1);
+}
+
+/* Save the current skeleton in the cache, replacing the least
+   recently used shape if needed.  Returns the slot. */
+int
+addGenQuerySqlCache(char *sig, char *joinSQL) {
+   int i, ix;
+   struct genQuerySqlCache *entry;
+
+   ix=0;
+   for (i=0;i<GQ_SQL_CACHE_SIZE;i++) {
+      if (GenQuerySqlCache[i].sig == NULL) {
+	 ix=i;
+	 break;
+      }
+      if (GenQuerySqlCache[i].lastUsed < GenQuerySqlCache[ix].lastUsed) {
+	 ix=i;
+      }
+   }
+   entry = &GenQuerySqlCache[ix];
+   if (entry->sig != NULL) {
+      free(entry->sig);
+      free(entry->selectSQL);
+      free(entry->fromSQL);
+      free(entry->groupBySQL);
+      free(entry->joinSQL);
+   }
+   memset(entry, 0, sizeof(struct genQuerySqlCache));
+   entry->sig = strdup(sig);
+   entry->selectSQL = strdup(selectSQL);
+   entry->fromSQL = strdup(fromSQL);
+   entry->groupBySQL = strdup(groupBySQL);
+   entry->joinSQL = strdup(joinSQL);
+   entry->mightNeedGroupBy = mightNeedGroupBy;
+   entry->lastUsed = ++genQuerySqlCacheClock;
+   return(ix);
+}
+
+/*
+ Turn the generated SQL cache on (1) or off (0), returning the
+ previous setting.  Mainly for testing and benchmarking.
+ */
+int
+chlGenQuerySqlCache(int mode) {
+   int prev;
+   prev = genQuerySqlCacheOff ? 0 : 1;
+   genQuerySqlCacheOff = mode ? 0 : 1;
+   return(prev);
+}
+
+/*
+ Log, per query shape, the number of calls and cache hits and the
+ average time spent generating the SQL and executing it in the DBMS.
+ */
+int
+chlGenQueryShapeStats(int logLevel) {
+   int i;
+   struct genQuerySqlCache *entry;
+
+   for (i=0;i<GQ_SQL_CACHE_SIZE;i++) {
+      entry = &GenQuerySqlCache[i];
+      if (entry->sig == NULL || entry->calls == 0) continue;
+      rodsLog(logLevel,
+	      "genQuery shape %s: calls=%d hits=%d avg gen=%lld usec avg exec=%lld usec",
+	      entry->sig, entry->calls, entry->hits,
+	      entry->genUsec/entry->calls, entry->execUsec/entry->calls);
+   }
+   return(0);
+}
+
 /* 
 Called by chlGenQuery to generate the SQL.
 */
@@ -1529,6 +1669,8 @@ generateSQL(genQueryInp_t genQueryInp, char *resultingSQL,
    int N_col_meta_user_attr_name=0;
    int N_col_meta_resc_attr_name=0;
    int N_col_meta_resc_group_attr_name=0;
+   int cacheIx, haveSig, joinStart;
+   char sig[GQ_SIG_LEN];
 
    char combinedSQL[MAX_SQL_SIZE_GQ];
 #if ORA_ICAT
@@ -1570,24 +1712,54 @@ generateSQL(genQueryInp_t genQueryInp, char *resultingSQL,
 
    tableAbbrevs='a'; /* reset */
 
-   for (i=0;i<genQueryInp.selectInp.len;i++) {
-      table = setTable(genQueryInp.selectInp.inx[i], 1, 
-		       genQueryInp.selectInp.value[i]&0xf, 0);
-      if (table < 0) {
-	 rodsLog(LOG_ERROR,"Table for column %d not found\n",
-		genQueryInp.selectInp.inx[i]);
-	 return(CAT_UNKNOWN_TABLE);
-      }
+   cacheIx=-1;
+   haveSig=0;
+   genQueryShapeIx=-1;
+   if (genQuerySqlCacheOff==0 &&
+       genQuerySignature(genQueryInp, sig, GQ_SIG_LEN)==0) {
+      haveSig=1;
+      cacheIx = findGenQuerySqlCache(sig);
+   }
+
+   if (cacheIx >= 0) {
+      /* Same shape as before, reuse the select/from/group by SQL */
 #ifdef LIMIT_AUDIT_ACCESS
-      if (genQueryInp.selectInp.inx[i] >= COL_AUDIT_RANGE_START &&
-	  genQueryInp.selectInp.inx[i] <= COL_AUDIT_RANGE_END) {
-	 if (accessControlPriv != LOCAL_PRIV_USER_AUTH) {
-	    return(CAT_NO_ACCESS_PERMISSION);
+      for (i=0;i<genQueryInp.selectInp.len;i++) {
+	 if (genQueryInp.selectInp.inx[i] >= COL_AUDIT_RANGE_START &&
+	     genQueryInp.selectInp.inx[i] <= COL_AUDIT_RANGE_END) {
+	    if (accessControlPriv != LOCAL_PRIV_USER_AUTH) {
+	       return(CAT_NO_ACCESS_PERMISSION);
+	    }
 	 }
       }
 #endif
-      if (Tables[table].cycler<1 || startingTable==0) {
-	 startingTable = table;  /* start with a non-cycler, if possible */
+      rstrcpy(selectSQL, GenQuerySqlCache[cacheIx].selectSQL, 
+	      MAX_SQL_SIZE_GQ);
+      rstrcpy(fromSQL, GenQuerySqlCache[cacheIx].fromSQL, MAX_SQL_SIZE_GQ);
+      rstrcpy(groupBySQL, GenQuerySqlCache[cacheIx].groupBySQL, 
+	      MAX_SQL_SIZE_GQ);
+      mightNeedGroupBy = GenQuerySqlCache[cacheIx].mightNeedGroupBy;
+   }
+   else {
+      for (i=0;i<genQueryInp.selectInp.len;i++) {
+	 table = setTable(genQueryInp.selectInp.inx[i], 1, 
+			  genQueryInp.selectInp.value[i]&0xf, 0);
+	 if (table < 0) {
+	    rodsLog(LOG_ERROR,"Table for column %d not found\n",
+		    genQueryInp.selectInp.inx[i]);
+	    return(CAT_UNKNOWN_TABLE);
+	 }
+#ifdef LIMIT_AUDIT_ACCESS
+	 if (genQueryInp.selectInp.inx[i] >= COL_AUDIT_RANGE_START &&
+	     genQueryInp.selectInp.inx[i] <= COL_AUDIT_RANGE_END) {
+	    if (accessControlPriv != LOCAL_PRIV_USER_AUTH) {
+	       return(CAT_NO_ACCESS_PERMISSION);
+	    }
+	 }
+#endif
+	 if (Tables[table].cycler<1 || startingTable==0) {
+	    startingTable = table;  /* start with a non-cycler, if possible */
+	 }
       }
    }
 
@@ -1656,14 +1828,31 @@ generateSQL(genQueryInp_t genQueryInp, char *resultingSQL,
 #endif
    }
 
-   keepVal = tScan(startingTable, -1);
-   if (keepVal!=1 || nToFind!=0) {
-      rodsLog(LOG_ERROR,"error failed to link tables\n");
-      return(CAT_FAILED_TO_LINK_TABLES);
+   if (cacheIx >= 0) {
+      /* the links between the tables are also the same */
+      rstrcat(whereSQL, GenQuerySqlCache[cacheIx].joinSQL, MAX_SQL_SIZE_GQ);
+      GenQuerySqlCache[cacheIx].hits++;
    }
    else {
-      if (debug>1) printf("SUCCESS linking tables\n");
+      joinStart = strlen(whereSQL);
+      keepVal = tScan(startingTable, -1);
+      if (keepVal!=1 || nToFind!=0) {
+	 rodsLog(LOG_ERROR,"error failed to link tables\n");
+	 return(CAT_FAILED_TO_LINK_TABLES);
+      }
+      else {
+	 if (debug>1) printf("SUCCESS linking tables\n");
+      }
+      /* Multi-AVU queries rewrite the SQL below, so those aren't cached */
+      if (haveSig && N_col_meta_data_attr_name <= 1 && 
+	  N_col_meta_coll_attr_name <= 1 &&
+	  N_col_meta_user_attr_name <= 1 &&
+	  N_col_meta_resc_attr_name <= 1 &&
+	  N_col_meta_resc_group_attr_name <= 1) {
+	 cacheIx = addGenQuerySqlCache(sig, whereSQL+joinStart);
+      }
    }
+   genQueryShapeIx = cacheIx;
 
    if (N_col_meta_data_attr_name > 1) {
       /* Make some special changes & additions for multi AVU query - data */
@@ -1908,6 +2097,19 @@ chlGenQueryTicketSetup(char *ticket, char *clientAddr) {
    return(0);
 }
 
+/* Clear the access control and ticket settings of the last client,
+   for a pool agent about to serve another one. */
+int
+chlGenQueryResetSession() {
+   accessControlUserName[0]='\0';
+   accessControlZone[0]='\0';
+   accessControlPriv=0;
+   accessControlControlFlag=0;
+   sessionTicket[0]='\0';
+   sessionClientAddr[0]='\0';
+   return(0);
+}
+
 /* General Query */
 int
 chlGenQuery(genQueryInp_t genQueryInp, genQueryOut_t *result) {
@@ -1925,6 +2127,8 @@ chlGenQuery(genQueryInp_t genQueryInp, genQueryOut_t *result) {
    int currentMaxColSize;
    char *tResult, *tResult2;
    static int recursiveCall=0;
+   int shapeIx=-1;
+   struct timeval startTime, genTime, execTime;
 
    if (logSQLGenQuery) rodsLog(LOG_SQL, "chlGenQuery");
 
@@ -1950,7 +2154,10 @@ chlGenQuery(genQueryInp_t genQueryInp, genQueryOut_t *result) {
 	 status = generateSpecialQuery(genQueryInp, combinedSQL);
       }
       else {
+	 (void)gettimeofday(&startTime, (struct timezone *)0);
 	 status = generateSQL(genQueryInp, combinedSQL, countSQL);
+	 (void)gettimeofday(&genTime, (struct timezone *)0);
+	 if (status == 0) shapeIx = genQueryShapeIx;
       }
       if (status != 0) return(status);
       if (logSQLGenQuery) {
@@ -1992,6 +2199,16 @@ chlGenQuery(genQueryInp_t genQueryInp, genQueryOut_t *result) {
 
       status = cmlGetFirstRowFromSql(combinedSQL, &statementNum, 
                                      genQueryInp.rowOffset, icss);
+      if (shapeIx >= 0) {
+	 (void)gettimeofday(&execTime, (struct timezone *)0);
+	 GenQuerySqlCache[shapeIx].calls++;
+	 GenQuerySqlCache[shapeIx].genUsec += 
+	    (genTime.tv_sec - startTime.tv_sec) * 1000000 +
+	    (genTime.tv_usec - startTime.tv_usec);
+	 GenQuerySqlCache[shapeIx].execUsec += 
+	    (execTime.tv_sec - genTime.tv_sec) * 1000000 +
+	    (execTime.tv_usec - genTime.tv_usec);
+      }
       if (status < 0) {
 	 if (status != CAT_NO_ROWS_FOUND) {
 	    rodsLog(LOG_NOTICE,
@@ -21,6 +21,7 @@
 #include "icatMidLevelHelpers.h"
 #include "icatHighLevelRoutines.h"
 #include "icatLowLevel.h"
+#include "bulkAVUMetadata.h"
 
 extern int get64RandomBytes(char *buf);
 extern int icatApplyRule(rsComm_t *rsComm, char *ruleName, char *arg1);
@@ -219,11 +220,32 @@ int chlOpen(char *DBUser, char *DBpasswd) {
 int chlClose() {
    int i;
 
+   chlGenQueryShapeStats(LOG_DEBUG);
    i = cmlClose(&icss);
    if (i == 0) icss.status=0;
    return(i);
 }
 
+/*
+ Reset the per-client session state (session ticket, group-admin user
+ creation, auth challenge) and roll back what the last client left
+ uncommitted, so that a pool agent can serve another client.  The
+ database connection is kept.
+ */
+int chlResetSession(rsComm_t *rsComm) {
+   int status = 0;
+
+   mySessionTicket[0]='\0';
+   mySessionClientAddr[0]='\0';
+   creatingUserByGroupAdmin=0;
+   memset(prevChalSig, 0, sizeof(prevChalSig));
+   chlGenQueryResetSession();
+   if (icss.status == 1) {
+      status = chlRollback(rsComm);
+   }
+   return(status);
+}
+
 int chlIsConnected() {
    if (logSQL!=0) rodsLog(LOG_SQL, "chlIsConnected");
    return(icss.status);
@@ -985,12 +1007,14 @@ int chlRegReplica(rsComm_t *rsComm, dataObjInfo_t *srcDataObjInfo,
       return(status);
    }
 
-   status =  cmlExecuteNoAnswerSql("commit", &icss);
-   if (status != 0) {
-      rodsLog(LOG_NOTICE,
-	      "chlRegReplica cmlExecuteNoAnswerSql commit failure %d",
-	      status);
-      return(status);
+   if ( !(dstDataObjInfo->flags & NO_COMMIT_FLAG) ) {
+      status =  cmlExecuteNoAnswerSql("commit", &icss);
+      if (status != 0) {
+	 rodsLog(LOG_NOTICE,
+		 "chlRegReplica cmlExecuteNoAnswerSql commit failure %d",
+		 status);
+	 return(status);
+      }
    }
 
    return(0);
@@ -6537,53 +6561,21 @@ chlAddAVUMetadataWild(rsComm_t *rsComm, int adminMode, char *type,
 }
 
 
-/* Add an Attribute-Value [Units] pair/triple metadata item to an object */
-int chlAddAVUMetadata(rsComm_t *rsComm, int adminMode, char *type, 
-		  char *name, char *attribute, char *value,  char *units) {
-   int itype;
-   char myTime[50];
+/*
+ Get the ID of the object (of type itype, see convertTypeOption) that
+ AVUs are to be added to, checking that the user may do that.
+ Return code is error or the object ID.
+*/
+static rodsLong_t
+getAVUObjectId(rsComm_t *rsComm, int adminMode, int itype, char *name) {
    char logicalEndName[MAX_NAME_LEN];
    char logicalParentDirName[MAX_NAME_LEN];
-   rodsLong_t seqNum, iVal;
+   rodsLong_t iVal;
    rodsLong_t objId, status;
-   char objIdStr[MAX_NAME_LEN];
-   char seqNumStr[MAX_NAME_LEN];
    char userName[NAME_LEN];
    char userZone[NAME_LEN];
 
-   if (logSQL!=0) rodsLog(LOG_SQL, "chlAddAVUMetadata");
-
-   if (!icss.status) {
-      return(CATALOG_NOT_CONNECTED);
-   }
-
-   if (type == NULL || *type=='\0') {
-      return (CAT_INVALID_ARGUMENT);
-   }
-
-   if (name == NULL || *name=='\0') {
-      return (CAT_INVALID_ARGUMENT);
-   }
-
-   if (attribute == NULL || *attribute=='\0') {
-      return (CAT_INVALID_ARGUMENT);
-   }
-
-   if (value == NULL || *value=='\0') {
-      return (CAT_INVALID_ARGUMENT);
-   }
-
-   if (adminMode==1) {
-      if (rsComm->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
-	 return(CAT_INSUFFICIENT_PRIVILEGE_LEVEL);
-      }
-   }
-
-   if (units == NULL) units="";
-
-   itype = convertTypeOption(type);
-   if (itype==0) return(CAT_INVALID_ARGUMENT);
-
+   objId=0;
    if (itype==1) {
       status = splitPathByKey(name,
 			   logicalParentDirName, logicalEndName, '/');
@@ -6709,6 +6701,55 @@ int chlAddAVUMetadata(rsComm_t *rsComm, int adminMode, char *type,
       }
    }
    
+   return(objId);
+}
+
+/* Add an Attribute-Value [Units] pair/triple metadata item to an object */
+int chlAddAVUMetadata(rsComm_t *rsComm, int adminMode, char *type, 
+		  char *name, char *attribute, char *value,  char *units) {
+   int itype;
+   char myTime[50];
+   rodsLong_t seqNum;
+   rodsLong_t objId, status;
+   char objIdStr[MAX_NAME_LEN];
+   char seqNumStr[MAX_NAME_LEN];
+
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlAddAVUMetadata");
+
+   if (!icss.status) {
+      return(CATALOG_NOT_CONNECTED);
+   }
+
+   if (type == NULL || *type=='\0') {
+      return (CAT_INVALID_ARGUMENT);
+   }
+
+   if (name == NULL || *name=='\0') {
+      return (CAT_INVALID_ARGUMENT);
+   }
+
+   if (attribute == NULL || *attribute=='\0') {
+      return (CAT_INVALID_ARGUMENT);
+   }
+
+   if (value == NULL || *value=='\0') {
+      return (CAT_INVALID_ARGUMENT);
+   }
+
+   if (adminMode==1) {
+      if (rsComm->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
+	 return(CAT_INSUFFICIENT_PRIVILEGE_LEVEL);
+      }
+   }
+
+   if (units == NULL) units="";
+
+   itype = convertTypeOption(type);
+   if (itype==0) return(CAT_INVALID_ARGUMENT);
+
+   objId = getAVUObjectId(rsComm, adminMode, itype, name);
+   if (objId < 0) return(objId);
+
    status = findOrInsertAVU(attribute, value, units);
    if (status<0) {
       rodsLog(LOG_NOTICE,
@@ -6764,6 +6805,571 @@ int chlAddAVUMetadata(rsComm_t *rsComm, int adminMode, char *type,
    return(status);
 }
 
+/* A distinct object of a chlBulkAVUMetadata call */
+typedef struct {
+   int itype;
+   char *type;
+   char *name;
+   int dirLen;         /* length of the collection part of a dataObj path */
+   rodsLong_t id;
+} bulkAVUObj_t;
+
+/* A distinct AVU of a chlBulkAVUMetadata call */
+typedef struct {
+   char *attribute;
+   char *value;
+   char *units;
+   rodsLong_t id;
+} bulkAVUMeta_t;
+
+/* An object-AVU link to be added */
+typedef struct {
+   rodsLong_t objId;
+   rodsLong_t metaId;
+   int objInx;
+   int exists;         /* already in R_OBJT_METAMAP */
+} bulkAVULink_t;
+
+static int
+cmpBulkAVUObj(const void *p1, const void *p2) {
+   const bulkAVUObj_t *obj1 = p1, *obj2 = p2;
+   if (obj1->itype != obj2->itype) return(obj1->itype - obj2->itype);
+   return(strcmp(obj1->name, obj2->name));
+}
+
+/* by collection, then data name */
+static int
+cmpBulkAVUDataObj(const void *p1, const void *p2) {
+   const bulkAVUObj_t *obj1 = *(bulkAVUObj_t **)p1;
+   const bulkAVUObj_t *obj2 = *(bulkAVUObj_t **)p2;
+   int len, i;
+   len = obj1->dirLen < obj2->dirLen ? obj1->dirLen : obj2->dirLen;
+   i = strncmp(obj1->name, obj2->name, len);
+   if (i != 0) return(i);
+   if (obj1->dirLen != obj2->dirLen) return(obj1->dirLen - obj2->dirLen);
+   return(strcmp(obj1->name+obj1->dirLen, obj2->name+obj2->dirLen));
+}
+
+static int
+cmpBulkAVUMeta(const void *p1, const void *p2) {
+   const bulkAVUMeta_t *meta1 = p1, *meta2 = p2;
+   int i;
+   i = strcmp(meta1->attribute, meta2->attribute);
+   if (i != 0) return(i);
+   i = strcmp(meta1->value, meta2->value);
+   if (i != 0) return(i);
+   return(strcmp(meta1->units, meta2->units));
+}
+
+static int
+cmpBulkAVULink(const void *p1, const void *p2) {
+   const bulkAVULink_t *link1 = p1, *link2 = p2;
+   if (link1->objId != link2->objId) {
+      return(link1->objId < link2->objId ? -1 : 1);
+   }
+   if (link1->metaId != link2->metaId) {
+      return(link1->metaId < link2->metaId ? -1 : 1);
+   }
+   return(0);
+}
+
+/* Sort an array and drop the duplicates; returns the new count */
+static int
+sortUniqueBulkAVU(void *base, int num, size_t size,
+		  int (*cmp)(const void *, const void *)) {
+   char *elems = base;
+   int i, k;
+
+   if (num <= 1) return(num);
+   qsort(base, num, size, cmp);
+   for (i=1,k=1;i<num;i++) {
+      if (cmp(elems+(k-1)*size, elems+i*size) != 0) {
+	 if (k != i) memcpy(elems+k*size, elems+i*size, size);
+	 k++;
+      }
+   }
+   return(k);
+}
+
+/*
+ Get the IDs of up to BULK_AVU_ITEMS_PER_SQL dataObjs in the same
+ collection, that the user can add metadata to, with one query.  The
+ ones not found are left with id 0.
+*/
+static int
+getBulkAVUDataIds(rsComm_t *rsComm, int adminMode, bulkAVUObj_t **dataObjs,
+		  int numDataObjs) {
+   char sql[MAX_SQL_SIZE];
+   char inList[BULK_AVU_ITEMS_PER_SQL*2+10];
+   char collName[MAX_NAME_LEN];
+   int i, k, status, stmtNum, dirLen;
+   char *dataName;
+
+   dirLen = dataObjs[0]->dirLen;
+   rstrcpy(collName, dataObjs[0]->name, dirLen+1);
+
+   inList[0]='\0';
+   for (i=0;i<numDataObjs;i++) {
+      strcat(inList, i==0 ? "?" : ",?");
+   }
+
+   cllBindVars[cllBindVarCount++]=collName;
+   for (i=0;i<numDataObjs;i++) {
+      cllBindVars[cllBindVarCount++]=dataObjs[i]->name+dirLen+1;
+   }
+   if (adminMode==1) {
+      snprintf(sql, sizeof sql,
+	       "select DM.data_id, DM.data_name from R_DATA_MAIN DM, R_COLL_MAIN CM where CM.coll_name=? and DM.coll_id=CM.coll_id and DM.data_name in (%s)",
+	       inList);
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata SQL 1");
+   }
+   else {
+      cllBindVars[cllBindVarCount++]=rsComm->clientUser.userName;
+      cllBindVars[cllBindVarCount++]=rsComm->clientUser.rodsZone;
+      cllBindVars[cllBindVarCount++]=ACCESS_CREATE_METADATA;
+      snprintf(sql, sizeof sql,
+	       "select DM.data_id, DM.data_name from R_DATA_MAIN DM, R_OBJT_ACCESS OA, R_USER_GROUP UG, R_USER_MAIN UM, R_TOKN_MAIN TM, R_COLL_MAIN CM where CM.coll_name=? and DM.coll_id=CM.coll_id and DM.data_name in (%s) and UM.user_name=? and UM.zone_name=? and UM.user_type_name!='rodsgroup' and UM.user_id = UG.user_id and OA.object_id = DM.data_id and UG.group_user_id = OA.user_id and OA.access_type_id >= TM.token_id and  TM.token_namespace ='access_type' and TM.token_name = ?",
+	       inList);
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata SQL 2");
+   }
+
+   for (i=0;;i++) {
+      if (i==0) {
+	 status = cmlGetFirstRowFromSql(sql, &stmtNum, 0, &icss);
+      }
+      else {
+	 status = cmlGetNextRowFromStatement(stmtNum, &icss);
+      }
+      if (status != 0) break;
+      dataName = icss.stmtPtr[stmtNum]->resultValue[1];
+      for (k=0;k<numDataObjs;k++) {
+	 if (strcmp(dataObjs[k]->name+dirLen+1, dataName)==0) {
+	    dataObjs[k]->id = strtoll(icss.stmtPtr[stmtNum]->resultValue[0],
+				      NULL, 0);
+	    break;
+	 }
+      }
+   }
+   if (status == CAT_NO_ROWS_FOUND) status=0;
+   return(status);
+}
+
+/*
+ Get the IDs of the objects of a chlBulkAVUMetadata call.  DataObjs
+ are looked up a collection at a time; the rest (and any dataObj
+ that isn't found that way, to get the right error) one by one.
+*/
+static int
+getBulkAVUObjectIds(rsComm_t *rsComm, int adminMode, bulkAVUObj_t *objs,
+		    int numObjs) {
+   bulkAVUObj_t **dataObjs;
+   int numDataObjs, i, j, status;
+   char *cp;
+   char errMsg[MAX_NAME_LEN+100];
+
+   dataObjs = (bulkAVUObj_t **)malloc(numObjs * sizeof(bulkAVUObj_t *));
+   if (dataObjs == NULL) return(SYS_MALLOC_ERR);
+   numDataObjs=0;
+   for (i=0;i<numObjs;i++) {
+      if (objs[i].itype != 1) continue;
+      cp = strrchr(objs[i].name, '/');
+      if (cp == NULL || cp == objs[i].name || *(cp+1)=='\0') continue;
+      objs[i].dirLen = cp - objs[i].name;
+      dataObjs[numDataObjs++] = &objs[i];
+   }
+   qsort(dataObjs, numDataObjs, sizeof(bulkAVUObj_t *), cmpBulkAVUDataObj);
+
+   status=0;
+   for (i=0;i<numDataObjs && status>=0;i=j) {
+      for (j=i+1;j<numDataObjs && j-i<BULK_AVU_ITEMS_PER_SQL;j++) {
+	 if (dataObjs[j]->dirLen != dataObjs[i]->dirLen ||
+	     strncmp(dataObjs[j]->name, dataObjs[i]->name, 
+		     dataObjs[i]->dirLen) != 0) break;
+      }
+      status = getBulkAVUDataIds(rsComm, adminMode, &dataObjs[i], j-i);
+   }
+   free(dataObjs);
+   if (status < 0) return(status);
+
+   for (i=0;i<numObjs;i++) {
+      if (objs[i].id > 0) continue;
+      objs[i].id = getAVUObjectId(rsComm, adminMode, objs[i].itype, 
+				  objs[i].name);
+      if (objs[i].id < 0) {
+	 snprintf(errMsg, sizeof errMsg, 
+		  "chlBulkAVUMetadata: can not add metadata to %s %s", 
+		  objs[i].type, objs[i].name);
+	 addRErrorMsg (&rsComm->rError, 0, errMsg);
+	 return(objs[i].id);
+      }
+   }
+   return(0);
+}
+
+/*
+ Fill in the IDs of the AVUs that are in R_META_MAIN, looking up
+ BULK_AVU_ITEMS_PER_SQL/2 at a time.
+*/
+static int
+findBulkAVUMetas(bulkAVUMeta_t *metas, int numMetas) {
+   char sql[MAX_SQL_SIZE];
+   bulkAVUMeta_t key, *meta;
+   int i, j, n, status, stmtNum;
+
+   for (i=0;i<numMetas;i=j) {
+      snprintf(sql, sizeof sql, 
+	       "select meta_id, meta_attr_name, meta_attr_value, meta_attr_unit from R_META_MAIN where ");
+      for (j=i,n=0;j<numMetas && n<BULK_AVU_ITEMS_PER_SQL/2;j++) {
+	 if (metas[j].id > 0) continue;
+	 if (n>0) rstrcat(sql, " or ", sizeof sql);
+	 rstrcat(sql, "(meta_attr_name=? and meta_attr_value=?)", sizeof sql);
+	 cllBindVars[cllBindVarCount++]=metas[j].attribute;
+	 cllBindVars[cllBindVarCount++]=metas[j].value;
+	 n++;
+      }
+      if (n==0) continue;
+
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata SQL 3");
+      for (n=0;;n++) {
+	 if (n==0) {
+	    status = cmlGetFirstRowFromSql(sql, &stmtNum, 0, &icss);
+	 }
+	 else {
+	    status = cmlGetNextRowFromStatement(stmtNum, &icss);
+	 }
+	 if (status != 0) break;
+	 /* a NULL unit is the same as an empty one */
+	 key.attribute = icss.stmtPtr[stmtNum]->resultValue[1];
+	 key.value = icss.stmtPtr[stmtNum]->resultValue[2];
+	 key.units = icss.stmtPtr[stmtNum]->resultValue[3];
+	 meta = (bulkAVUMeta_t *)bsearch(&key, metas, numMetas, 
+					 sizeof(bulkAVUMeta_t), cmpBulkAVUMeta);
+	 if (meta != NULL && meta->id == 0) {
+	    meta->id = strtoll(icss.stmtPtr[stmtNum]->resultValue[0], 
+			       NULL, 0);
+	 }
+      }
+      if (status != CAT_NO_ROWS_FOUND) return(status);
+   }
+   return(0);
+}
+
+/*
+ Get the IDs of the AVUs of a chlBulkAVUMetadata call, inserting the
+ new ones into R_META_MAIN in one array insert.
+*/
+static int
+getBulkAVUMetaIds(bulkAVUMeta_t *metas, int numMetas, char *myTime) {
+   char sql[MAX_SQL_SIZE];
+   char nextStr[MAX_NAME_LEN];
+   char **values;
+   int i, numNew, status;
+
+   status = findBulkAVUMetas(metas, numMetas);
+   if (status < 0) return(status);
+
+   values = (char **)malloc(numMetas * 5 * sizeof(char *));
+   if (values == NULL) return(SYS_MALLOC_ERR);
+   numNew=0;
+   for (i=0;i<numMetas;i++) {
+      if (metas[i].id > 0) continue;
+      values[numNew*5]=metas[i].attribute;
+      values[numNew*5+1]=metas[i].value;
+      values[numNew*5+2]=metas[i].units;
+      values[numNew*5+3]=myTime;
+      values[numNew*5+4]=myTime;
+      numNew++;
+   }
+   if (numNew > 0) {
+      /* the sequence value is taken in the insert, and the IDs read
+         back below, instead of a query per AVU for the next value */
+      cllNextValueString("R_ObjectID", nextStr, sizeof nextStr);
+      snprintf(sql, sizeof sql, 
+	       "insert into R_META_MAIN (meta_id, meta_attr_name, meta_attr_value, meta_attr_unit, create_ts, modify_ts) values (%s, ?, ?, ?, ?, ?)",
+	       nextStr);
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata SQL 4");
+      status = cmlExecuteNoAnswerSqlArray(sql, 5, numNew, values, &icss);
+   }
+   free(values);
+   if (status < 0 || numNew == 0) return(status);
+
+   status = findBulkAVUMetas(metas, numMetas);
+   if (status < 0) return(status);
+   for (i=0;i<numMetas;i++) {
+      if (metas[i].id <= 0) {
+	 rodsLog(LOG_NOTICE, 
+		 "chlBulkAVUMetadata: inserted AVU %s %s %s not found",
+		 metas[i].attribute, metas[i].value, metas[i].units);
+	 return(CAT_SQL_ERR);
+      }
+   }
+   return(0);
+}
+
+/*
+ Flag the links that are already in R_OBJT_METAMAP (adding them again
+ would violate its unique index), BULK_AVU_ITEMS_PER_SQL/2 at a time.
+*/
+static int
+findBulkAVULinks(bulkAVULink_t *links, int numLinks) {
+   char sql[MAX_SQL_SIZE];
+   char idStr[BULK_AVU_ITEMS_PER_SQL][MAX_INTEGER_SIZE];
+   bulkAVULink_t key, *link;
+   int i, j, n, status, stmtNum;
+
+   for (i=0;i<numLinks;i=j) {
+      snprintf(sql, sizeof sql, 
+	       "select object_id, meta_id from R_OBJT_METAMAP where ");
+      for (j=i,n=0;j<numLinks && n<BULK_AVU_ITEMS_PER_SQL;j++,n+=2) {
+	 if (n>0) rstrcat(sql, " or ", sizeof sql);
+	 rstrcat(sql, "(object_id=? and meta_id=?)", sizeof sql);
+	 snprintf(idStr[n], MAX_INTEGER_SIZE, "%lld", links[j].objId);
+	 snprintf(idStr[n+1], MAX_INTEGER_SIZE, "%lld", links[j].metaId);
+	 cllBindVars[cllBindVarCount++]=idStr[n];
+	 cllBindVars[cllBindVarCount++]=idStr[n+1];
+      }
+
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata SQL 5");
+      for (n=0;;n++) {
+	 if (n==0) {
+	    status = cmlGetFirstRowFromSql(sql, &stmtNum, 0, &icss);
+	 }
+	 else {
+	    status = cmlGetNextRowFromStatement(stmtNum, &icss);
+	 }
+	 if (status != 0) break;
+	 key.objId = strtoll(icss.stmtPtr[stmtNum]->resultValue[0], NULL, 0);
+	 key.metaId = strtoll(icss.stmtPtr[stmtNum]->resultValue[1], NULL, 0);
+	 link = (bulkAVULink_t *)bsearch(&key, links, numLinks, 
+					 sizeof(bulkAVULink_t), cmpBulkAVULink);
+	 if (link != NULL) link->exists=1;
+      }
+      if (status != CAT_NO_ROWS_FOUND) return(status);
+   }
+   return(0);
+}
+
+static int 
+_chlDeleteAVUMetadata(rsComm_t *rsComm, int adminMode, int option, 
+		      char *type, char *name, char *attribute, char *value,  
+		      char *units, int noCommit );
+
+static int
+_chlBulkAVUMetadata(rsComm_t *rsComm, int adminMode, int numOps, 
+		    char *op[], char *type[], char *name[], 
+		    char *attribute[], char *value[], char *units[],
+		    bulkAVUObj_t *objs, bulkAVUMeta_t *metas, 
+		    bulkAVULink_t *links) {
+   int numObjs, numMetas, numLinks, numAdded;
+   int i, status;
+   bulkAVUObj_t objKey, *obj;
+   bulkAVUMeta_t metaKey, *meta;
+   char myTime[50];
+   char **values;
+   char *idStrs;
+   char errMsg[MAX_NAME_LEN+100];
+
+   /* Removals first, in the order given */
+   for (i=0;i<numOps;i++) {
+      if (strcmp(op[i], "rm") != 0) continue;
+      status = _chlDeleteAVUMetadata(rsComm, adminMode, 0, type[i], name[i], 
+				     attribute[i], value[i], 
+				     units[i] != NULL ? units[i] : "", 1);
+      if (status < 0) {
+	 snprintf(errMsg, sizeof errMsg, 
+		  "chlBulkAVUMetadata: operation %d (rm %s %s %s) failed",
+		  i, type[i], name[i], attribute[i]);
+	 addRErrorMsg (&rsComm->rError, 0, errMsg);
+	 return(status);
+      }
+   }
+
+   /* The distinct objects and AVUs to be linked */
+   numObjs=0;
+   numMetas=0;
+   for (i=0;i<numOps;i++) {
+      if (strcmp(op[i], "add") != 0) continue;
+      objs[numObjs].itype = convertTypeOption(type[i]);
+      objs[numObjs].type = type[i];
+      objs[numObjs].name = name[i];
+      numObjs++;
+      metas[numMetas].attribute = attribute[i];
+      metas[numMetas].value = value[i];
+      metas[numMetas].units = units[i] != NULL ? units[i] : "";
+      numMetas++;
+   }
+   if (numObjs == 0) return(0);
+   numObjs = sortUniqueBulkAVU(objs, numObjs, sizeof(bulkAVUObj_t),
+			       cmpBulkAVUObj);
+   numMetas = sortUniqueBulkAVU(metas, numMetas, sizeof(bulkAVUMeta_t),
+				cmpBulkAVUMeta);
+
+   status = getBulkAVUObjectIds(rsComm, adminMode, objs, numObjs);
+   if (status < 0) return(status);
+
+   getNowStr(myTime);
+   status = getBulkAVUMetaIds(metas, numMetas, myTime);
+   if (status < 0) return(status);
+
+   numLinks=0;
+   for (i=0;i<numOps;i++) {
+      if (strcmp(op[i], "add") != 0) continue;
+      objKey.itype = convertTypeOption(type[i]);
+      objKey.name = name[i];
+      obj = (bulkAVUObj_t *)bsearch(&objKey, objs, numObjs,
+				    sizeof(bulkAVUObj_t), cmpBulkAVUObj);
+      metaKey.attribute = attribute[i];
+      metaKey.value = value[i];
+      metaKey.units = units[i] != NULL ? units[i] : "";
+      meta = (bulkAVUMeta_t *)bsearch(&metaKey, metas, numMetas,
+				      sizeof(bulkAVUMeta_t), cmpBulkAVUMeta);
+      if (obj == NULL || meta == NULL) return(SYS_INTERNAL_NULL_INPUT_ERR);
+      links[numLinks].objId = obj->id;
+      links[numLinks].metaId = meta->id;
+      links[numLinks].objInx = obj - objs;
+      links[numLinks].exists = 0;
+      numLinks++;
+   }
+   numLinks = sortUniqueBulkAVU(links, numLinks, sizeof(bulkAVULink_t),
+				cmpBulkAVULink);
+   status = findBulkAVULinks(links, numLinks);
+   if (status < 0) return(status);
+
+   values = (char **)malloc(numLinks * 4 * sizeof(char *));
+   idStrs = (char *)malloc(numLinks * 2 * MAX_INTEGER_SIZE);
+   if (values == NULL || idStrs == NULL) {
+      if (values != NULL) free(values);
+      if (idStrs != NULL) free(idStrs);
+      return(SYS_MALLOC_ERR);
+   }
+   numAdded=0;
+   for (i=0;i<numLinks;i++) {
+      if (links[i].exists) continue;
+      values[numAdded*4] = idStrs + numAdded*2*MAX_INTEGER_SIZE;
+      values[numAdded*4+1] = values[numAdded*4] + MAX_INTEGER_SIZE;
+      snprintf(values[numAdded*4], MAX_INTEGER_SIZE, "%lld", 
+	       links[i].objId);
+      snprintf(values[numAdded*4+1], MAX_INTEGER_SIZE, "%lld", 
+	       links[i].metaId);
+      values[numAdded*4+2] = myTime;
+      values[numAdded*4+3] = myTime;
+      numAdded++;
+   }
+   status=0;
+   if (numAdded > 0) {
+      if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata SQL 6");
+      status = cmlExecuteNoAnswerSqlArray(
+                 "insert into R_OBJT_METAMAP (object_id, meta_id, create_ts, modify_ts) values (?, ?, ?, ?)",
+		 4, numAdded, values, &icss);
+      if (status != 0) {
+	 rodsLog(LOG_NOTICE,
+		 "chlBulkAVUMetadata cmlExecuteNoAnswerSqlArray insert failure %d",
+		 status);
+      }
+   }
+
+   /* Audit */
+   for (i=0,numAdded=0;i<numLinks && status==0;i++) {
+      if (links[i].exists) continue;
+      status = cmlAudit3(AU_ADD_AVU_METADATA,  
+			 values[numAdded*4],
+			 rsComm->clientUser.userName,
+			 rsComm->clientUser.rodsZone,
+			 objs[links[i].objInx].type,
+			 &icss);
+      if (status != 0) {
+	 rodsLog(LOG_NOTICE,
+		 "chlBulkAVUMetadata cmlAudit3 failure %d",
+		 status);
+      }
+      numAdded++;
+   }
+   free(values);
+   free(idStrs);
+   if (status != 0) return(status);
+   return(numAdded);
+}
+
+/*
+ Add and remove many Attribute-Value [Units] metadata items in one
+ transaction.  op[i] is "add" or "rm", and type[i], name[i],
+ attribute[i], value[i] and units[i] are as for chlAddAVUMetadata
+ and chlDeleteAVUMetadata.  The removals are done first.  The
+ objects and AVUs are looked up in batches, the new AVUs and the
+ object-AVU links are inserted with array inserts, and links that
+ already exist are skipped.  Return code is error or the number of
+ links added.
+*/
+int chlBulkAVUMetadata(rsComm_t *rsComm, int adminMode, int numOps,
+		       char *op[], char *type[], char *name[], 
+		       char *attribute[], char *value[], char *units[]) {
+   bulkAVUObj_t *objs;
+   bulkAVUMeta_t *metas;
+   bulkAVULink_t *links;
+   char errMsg[100];
+   int i, status;
+
+   if (logSQL!=0) rodsLog(LOG_SQL, "chlBulkAVUMetadata");
+
+   if (!icss.status) {
+      return(CATALOG_NOT_CONNECTED);
+   }
+
+   if (numOps < 0 || numOps > MAX_BULK_AVU_OPS) {
+      return (CAT_INVALID_ARGUMENT);
+   }
+   if (numOps == 0) return(0);
+
+   if (adminMode==1) {
+      if (rsComm->clientUser.authInfo.authFlag < LOCAL_PRIV_USER_AUTH) {
+	 return(CAT_INSUFFICIENT_PRIVILEGE_LEVEL);
+      }
+   }
+
+   for (i=0;i<numOps;i++) {
+      if (op[i] == NULL || 
+	  (strcmp(op[i], "add") != 0 && strcmp(op[i], "rm") != 0) ||
+	  type[i] == NULL || convertTypeOption(type[i]) == 0 ||
+	  name[i] == NULL || *name[i] == '\0' ||
+	  attribute[i] == NULL || *attribute[i] == '\0' ||
+	  value[i] == NULL || *value[i] == '\0') {
+	 snprintf(errMsg, sizeof errMsg,
+		  "chlBulkAVUMetadata: operation %d is invalid", i);
+	 addRErrorMsg (&rsComm->rError, 0, errMsg);
+	 return (CAT_INVALID_ARGUMENT);
+      }
+   }
+
+   objs = (bulkAVUObj_t *)calloc(numOps, sizeof(bulkAVUObj_t));
+   metas = (bulkAVUMeta_t *)calloc(numOps, sizeof(bulkAVUMeta_t));
+   links = (bulkAVULink_t *)calloc(numOps, sizeof(bulkAVULink_t));
+   if (objs == NULL || metas == NULL || links == NULL) {
+      status = SYS_MALLOC_ERR;
+   }
+   else {
+      status = _chlBulkAVUMetadata(rsComm, adminMode, numOps, op, type, 
+				   name, attribute, value, units, 
+				   objs, metas, links);
+   }
+   if (objs != NULL) free(objs);
+   if (metas != NULL) free(metas);
+   if (links != NULL) free(links);
+
+   if (status < 0) {
+      _rollback("chlBulkAVUMetadata");
+      return(status);
+   }
+
+   i =  cmlExecuteNoAnswerSql("commit", &icss);
+   if (i != 0) {
+      rodsLog(LOG_NOTICE,
+	      "chlBulkAVUMetadata cmlExecuteNoAnswerSql commit failure %d",
+	      i);
+      return(i);
+   }
+   return(status);
+}
+
 /*
  check a chlModAVUMetadata argument; returning the type.
  */
@@ -6865,7 +7471,19 @@ int chlModAVUMetadata(rsComm_t *rsComm, char *type,
 int chlDeleteAVUMetadata(rsComm_t *rsComm, int option, char *type, 
 			 char *name, char *attribute, char *value,  
 			 char *units, int noCommit ) {
+   return(_chlDeleteAVUMetadata(rsComm, 0, option, type, name, attribute,
+				value, units, noCommit));
+}
+
+/* As chlDeleteAVUMetadata; with adminMode 1, the access of the user to
+   the data object or collection is not checked (the caller has checked
+   that the user is an admin) */
+static int 
+_chlDeleteAVUMetadata(rsComm_t *rsComm, int adminMode, int option, 
+		      char *type, char *name, char *attribute, char *value,  
+		      char *units, int noCommit ) {
    int itype;
+   rodsLong_t iVal;
    char logicalEndName[MAX_NAME_LEN];
    char logicalParentDirName[MAX_NAME_LEN];
    rodsLong_t status;
@@ -6911,11 +7529,20 @@ int chlDeleteAVUMetadata(rsComm_t *rsComm, int option, char *type,
 	 strcpy(logicalParentDirName, "/");
 	 strcpy(logicalEndName, name);
       }
-      if (logSQL!=0) rodsLog(LOG_SQL, "chlDeleteAVUMetadata SQL 1 ");
-      status = cmlCheckDataObjOnly(logicalParentDirName, logicalEndName,
+      if (adminMode==1) {
+	 if (logSQL!=0) rodsLog(LOG_SQL, "chlDeleteAVUMetadata SQL 1a ");
+	 status = cmlGetIntegerValueFromSql(
+	       "select data_id from R_DATA_MAIN DM, R_COLL_MAIN CM where DM.data_name=? and DM.coll_id=CM.coll_id and CM.coll_name=?",
+	       &iVal, logicalEndName, logicalParentDirName, 0, 0, 0, &icss);
+	 if (status==0) status=iVal; /*like cmlCheckDataObjOnly, status is objid */
+      }
+      else {
+	 if (logSQL!=0) rodsLog(LOG_SQL, "chlDeleteAVUMetadata SQL 1 ");
+	 status = cmlCheckDataObjOnly(logicalParentDirName, logicalEndName,
 				   rsComm->clientUser.userName, 
 				   rsComm->clientUser.rodsZone, 
 				   ACCESS_DELETE_METADATA, &icss);
+      }
       if (status < 0) {
 	 if (noCommit != 1) {
 	    _rollback("chlDeleteAVUMetadata");
@@ -6928,11 +7555,20 @@ int chlDeleteAVUMetadata(rsComm_t *rsComm, int option, char *type,
    if (itype==2) {
    /* Check that the collection exists and user has delete_metadata permission,
       and get the collectionID */
-      if (logSQL!=0) rodsLog(LOG_SQL, "chlDeleteAVUMetadata SQL 2");
-      status = cmlCheckDir(name,
+      if (adminMode==1) {
+	 if (logSQL!=0) rodsLog(LOG_SQL, "chlDeleteAVUMetadata SQL 2a");
+	 status = cmlGetIntegerValueFromSql(
+            "select coll_id from R_COLL_MAIN where coll_name=?",
+            &iVal, name, 0, 0, 0, 0, &icss);
+	 if (status==0) status=iVal;/*like cmlCheckDir, status is objid*/
+      }
+      else {
+	 if (logSQL!=0) rodsLog(LOG_SQL, "chlDeleteAVUMetadata SQL 2");
+	 status = cmlCheckDir(name,
 			   rsComm->clientUser.userName, 
 			   rsComm->clientUser.rodsZone,
 			   ACCESS_DELETE_METADATA, &icss);
+      }
       if (status < 0) {
 	 int i;
 	 char errMsg[105];
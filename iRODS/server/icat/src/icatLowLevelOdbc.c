@@ -462,6 +462,8 @@ cllDisconnect(icatSessionStruct *icss) {
       /* Nothing to do if it fails */
    }
 
+   cllFreeStmtCache(icss);
+
    stat = SQLDisconnect(myHdbc);
    if (stat != SQL_SUCCESS) {
       rodsLog(LOG_ERROR, "cllDisconnect: SQLDisconnect failed: %d", stat);
@@ -560,6 +562,179 @@ bindTheVariables(HSTMT myHstmt, char *sql) {
    return(0);
 }
 
+/*
+ Bind variables from the global array to a statement already prepared
+ by getPreparedStmt.
+ */
+static int
+bindPreparedVariables(HSTMT myHstmt) {
+   int myBindVarCount;
+   RETCODE stat;
+   int i;
+   char tmpStr[TMP_STR_LEN+2];
+
+   myBindVarCount = cllBindVarCount;
+   cllBindVarCountPrev=cllBindVarCount; /* save in case we need to log error */
+   cllBindVarCount = 0; /* reset for next call */
+
+   for (i=0;i<myBindVarCount;i++) {
+      stat = SQLBindParameter(myHstmt, i+1, SQL_PARAM_INPUT, SQL_C_CHAR,
+			      SQL_C_CHAR, 0, 0, cllBindVars[i], 0, 0);
+      snprintf(tmpStr, TMP_STR_LEN, "bindVar[%d]=%s", i+1, cllBindVars[i]);
+      rodsLogSql(tmpStr);
+      if (stat != SQL_SUCCESS) {
+	 rodsLog(LOG_ERROR, 
+		 "bindPreparedVariables: SQLBindParameter failed: %d", stat);
+	 return(-1);
+      }
+   }
+   return(0);
+}
+
+/*
+ Free a prepared statement cache slot and its statement handle.
+ */
+static void
+dropPreparedStmt(icatSessionStruct *icss, int cacheInx) {
+   icatPreparedStmt *entry;
+   RETCODE stat;
+
+   entry = &icss->stmtCache.stmt[cacheInx];
+   stat = SQLFreeStmt(entry->stmtPtr, SQL_DROP);
+   if (stat != SQL_SUCCESS) {
+      rodsLog(LOG_ERROR, "dropPreparedStmt: SQLFreeStmt error: %d", stat);
+   }
+   free(entry->sql);
+   memset(entry, 0, sizeof(icatPreparedStmt));
+}
+
+/*
+ Remove a statement from the cache without freeing the handle, which
+ then belongs to the caller.  Used after an execute error, since the
+ statement may no longer be valid.
+ */
+static void
+detachPreparedStmt(icatSessionStruct *icss, int cacheInx) {
+   icatPreparedStmt *entry;
+
+   entry = &icss->stmtCache.stmt[cacheInx];
+   free(entry->sql);
+   memset(entry, 0, sizeof(icatPreparedStmt));
+}
+
+/*
+ Done with a cached statement: close the cursor and drop the column
+ and parameter bindings (the buffers are about to be freed), and make
+ it available for the next execution of the same sql.
+ */
+static void
+releasePreparedStmt(icatSessionStruct *icss, int cacheInx) {
+   icatPreparedStmt *entry;
+
+   entry = &icss->stmtCache.stmt[cacheInx];
+   SQLFreeStmt(entry->stmtPtr, SQL_CLOSE);
+   SQLFreeStmt(entry->stmtPtr, SQL_UNBIND);
+   SQLFreeStmt(entry->stmtPtr, SQL_RESET_PARAMS);
+   entry->inUse=0;
+}
+
+/*
+ Get a prepared statement for sql from the session's statement cache.
+ On a miss, a new statement is allocated and prepared, replacing the
+ least recently used idle one if the cache is full.  Returns the cache
+ slot (marked in use) and the handle in hstmt; or -1 if the statement
+ can not be cached right now (cache disabled, all slots busy, or the
+ same sql has a result set open) and the caller should allocate its
+ own handle as before; or -2 on an ODBC error.
+ */
+static int
+getPreparedStmt(icatSessionStruct *icss, char *sql, HSTMT *hstmt) {
+   icatStmtCache *cache;
+   icatPreparedStmt *entry;
+   HSTMT newHstmt;
+   RETCODE stat;
+   int i, freeInx, lruInx;
+
+   cache = &icss->stmtCache;
+   if (cache->disabled) return(-1);
+
+   cache->clock++;
+   freeInx=-1;
+   lruInx=-1;
+   for (i=0;i<MAX_NUM_OF_PREPARED_STMTS;i++) {
+      entry = &cache->stmt[i];
+      if (entry->stmtPtr==0) {
+	 if (freeInx<0) freeInx=i;
+	 continue;
+      }
+      if (strcmp(entry->sql, sql)==0) {
+	 if (entry->inUse) return(-1);
+	 entry->inUse=1;
+	 entry->lastUsed=cache->clock;
+	 cache->hits++;
+	 *hstmt = entry->stmtPtr;
+	 return(i);
+      }
+      if (entry->inUse==0 && 
+	  (lruInx<0 || entry->lastUsed < cache->stmt[lruInx].lastUsed)) {
+	 lruInx=i;
+      }
+   }
+
+   cache->misses++;
+   if (freeInx<0) {
+      if (lruInx<0) return(-1);
+      dropPreparedStmt(icss, lruInx);
+      freeInx=lruInx;
+   }
+
+   stat = SQLAllocStmt(icss->connectPtr, &newHstmt); 
+   if (stat != SQL_SUCCESS) {
+      rodsLog(LOG_ERROR, "getPreparedStmt: SQLAllocStmt failed: %d", stat);
+      return(-2);
+   }
+   rodsLogSql("SQLPrepare");
+   stat = SQLPrepare(newHstmt, (unsigned char *)sql, SQL_NTS);
+   if (stat != SQL_SUCCESS) {
+      rodsLog(LOG_ERROR, "getPreparedStmt: SQLPrepare failed: %d", stat);
+      SQLFreeStmt(newHstmt, SQL_DROP);
+      return(-2);
+   }
+
+   entry = &cache->stmt[freeInx];
+   entry->stmtPtr=newHstmt;
+   entry->sql=strdup(sql);
+   entry->inUse=1;
+   entry->lastUsed=cache->clock;
+   *hstmt = newHstmt;
+   return(freeInx);
+}
+
+/*
+ Free all the statements in the prepared statement cache.  Statements
+ with a result set open are left to cllFreeStatement.
+ */
+int
+cllFreeStmtCache(icatSessionStruct *icss) {
+   int i;
+
+   if (icss->stmtCache.hits > 0 || icss->stmtCache.misses > 0) {
+      rodsLog(LOG_DEBUG, 
+	      "cllFreeStmtCache: prepared statement cache hits=%d misses=%d",
+	      icss->stmtCache.hits, icss->stmtCache.misses);
+   }
+   for (i=0;i<MAX_NUM_OF_PREPARED_STMTS;i++) {
+      if (icss->stmtCache.stmt[i].stmtPtr==0) continue;
+      if (icss->stmtCache.stmt[i].inUse) {
+	 detachPreparedStmt(icss, i);
+      }
+      else {
+	 dropPreparedStmt(icss, i);
+      }
+   }
+   return(0);
+}
+
 /*
    Case-insensitive string comparison, first string can be any case and
    contain leading and trailing spaces, second string must be lowercase, 
@@ -598,6 +773,7 @@ _cllExecSqlNoResult(icatSessionStruct *icss, char *sql,
    int result;
    char *status;
    SQL_INT_OR_LEN rowCount;
+   int cacheInx;
 #ifdef NEW_ODBC
    int i;
 #endif
@@ -606,10 +782,22 @@ _cllExecSqlNoResult(icatSessionStruct *icss, char *sql,
 
    myHdbc = icss->connectPtr;
    rodsLog(LOG_DEBUG1, sql);
-   stat = SQLAllocStmt(myHdbc, &myHstmt); 
-   if (stat != SQL_SUCCESS) {
-      rodsLog(LOG_ERROR, "_cllExecSqlNoResult: SQLAllocStmt failed: %d", stat);
-      return(-1);
+
+   /* Only statements with bind variables are cached; the others
+      (begin, commit, sql with literal values) differ each time */
+   cacheInx=-1;
+   if (option==0 && cllBindVarCount > 0) {
+      cacheInx = getPreparedStmt(icss, sql, &myHstmt);
+      if (cacheInx < -1) return(-1);
+   }
+
+   if (cacheInx < 0) {
+      stat = SQLAllocStmt(myHdbc, &myHstmt); 
+      if (stat != SQL_SUCCESS) {
+	 rodsLog(LOG_ERROR, "_cllExecSqlNoResult: SQLAllocStmt failed: %d",
+		 stat);
+	 return(-1);
+      }
    }
 
 #if 0
@@ -624,13 +812,23 @@ _cllExecSqlNoResult(icatSessionStruct *icss, char *sql,
    }
 #endif
 
-   if (option==0) {
-      if (bindTheVariables(myHstmt, sql) != 0) return(-1);
+   if (cacheInx >= 0) {
+      if (bindPreparedVariables(myHstmt) != 0) {
+	 releasePreparedStmt(icss, cacheInx);
+	 return(-1);
+      }
+      rodsLogSql(sql);
+      stat = SQLExecute(myHstmt);
    }
+   else {
+      if (option==0) {
+	 if (bindTheVariables(myHstmt, sql) != 0) return(-1);
+      }
 
-   rodsLogSql(sql);
+      rodsLogSql(sql);
 
-   stat = SQLExecDirect(myHstmt, (unsigned char *)sql, SQL_NTS);
+      stat = SQLExecDirect(myHstmt, (unsigned char *)sql, SQL_NTS);
+   }
    status = "UNKNOWN";
    if (stat == SQL_SUCCESS) status= "SUCCESS";
    if (stat == SQL_SUCCESS_WITH_INFO) status="SUCCESS_WITH_INFO";
@@ -670,17 +868,197 @@ _cllExecSqlNoResult(icatSessionStruct *icss, char *sql,
 	      stat, sql);
       result = logPsgError(LOG_NOTICE, icss->environPtr, myHdbc, myHstmt,
 			   icss->databaseType);
+      if (cacheInx >= 0) {
+	 /* don't reuse it, it is freed below */
+	 detachPreparedStmt(icss, cacheInx);
+	 cacheInx=-1;
+      }
    }
 
-   stat = SQLFreeStmt(myHstmt, SQL_DROP);
-   if (stat != SQL_SUCCESS) {
-      rodsLog(LOG_ERROR, "_cllExecSqlNoResult: SQLFreeStmt error: %d", stat);
+   if (cacheInx >= 0) {
+      releasePreparedStmt(icss, cacheInx);
+   }
+   else {
+      stat = SQLFreeStmt(myHstmt, SQL_DROP);
+      if (stat != SQL_SUCCESS) {
+	 rodsLog(LOG_ERROR, "_cllExecSqlNoResult: SQLFreeStmt error: %d", 
+		 stat);
+      }
    }
 
    noResultRowCount = rowCount;
    return(result);
 }
 
+/*
+ Execute a SQL command with no resulting table (an insert, for
+ example) for numRows rows of bind variables in one call to the
+ database, binding each variable as an array.  values holds the
+ numVars variables of the first row, then those of the second, etc.
+ Returns 1 if the driver does not support parameter arrays, so the
+ caller can do it row by row.
+ */
+static int
+_cllExecSqlNoResultArray(icatSessionStruct *icss, char *sql, int numVars,
+			 int numRows, char **values) {
+   RETCODE stat;
+   HSTMT myHstmt;
+   int result;
+   int i, j, len;
+   int maxLen[MAX_BIND_VARS];
+   char *varBuf[MAX_BIND_VARS];
+   SQL_INT_OR_LEN *indBuf;
+   char tmpStr[TMP_STR_LEN+2];
+
+   stat = SQLAllocStmt(icss->connectPtr, &myHstmt);
+   if (stat != SQL_SUCCESS) {
+      rodsLog(LOG_ERROR, "_cllExecSqlNoResultArray: SQLAllocStmt failed: %d",
+	      stat);
+      return(-1);
+   }
+
+   stat = SQLSetStmtAttr(myHstmt, SQL_ATTR_PARAM_BIND_TYPE,
+			 (SQLPOINTER) SQL_PARAM_BIND_BY_COLUMN, 0);
+   if (stat == SQL_SUCCESS) {
+      stat = SQLSetStmtAttr(myHstmt, SQL_ATTR_PARAMSET_SIZE, 
+			    (SQLPOINTER) (SQL_UINT_OR_ULEN) numRows, 0);
+   }
+   if (stat != SQL_SUCCESS) {
+      SQLFreeStmt(myHstmt, SQL_DROP);
+      return(1);
+   }
+
+   rodsLogSql("SQLPrepare");
+   stat = SQLPrepare(myHstmt, (unsigned char *)sql, SQL_NTS);
+   if (stat != SQL_SUCCESS) {
+      rodsLog(LOG_ERROR, "_cllExecSqlNoResultArray: SQLPrepare failed: %d",
+	      stat);
+      SQLFreeStmt(myHstmt, SQL_DROP);
+      return(-1);
+   }
+
+   /* one buffer of fixed size strings per variable */
+   memset(varBuf, 0, sizeof(varBuf));
+   indBuf = (SQL_INT_OR_LEN *)malloc(numRows * sizeof(SQL_INT_OR_LEN));
+   result=0;
+   for (j=0;j<numVars && indBuf!=NULL;j++) {
+      maxLen[j]=1;
+      for (i=0;i<numRows;i++) {
+	 len = strlen(values[i*numVars+j]) + 1;
+	 if (len > maxLen[j]) maxLen[j]=len;
+      }
+      varBuf[j] = (char *)malloc(numRows * maxLen[j]);
+      if (varBuf[j]==NULL) {
+	 result = SYS_MALLOC_ERR;
+	 break;
+      }
+      for (i=0;i<numRows;i++) {
+	 strcpy(varBuf[j] + i*maxLen[j], values[i*numVars+j]);
+      }
+   }
+   if (indBuf==NULL) result = SYS_MALLOC_ERR;
+
+   if (result==0) {
+      for (i=0;i<numRows;i++) indBuf[i]=SQL_NTS;
+      for (j=0;j<numVars;j++) {
+	 stat = SQLBindParameter(myHstmt, j+1, SQL_PARAM_INPUT, SQL_C_CHAR,
+				 SQL_C_CHAR, maxLen[j], 0, varBuf[j], 
+				 maxLen[j], indBuf);
+	 if (stat != SQL_SUCCESS) {
+	    rodsLog(LOG_ERROR, 
+		    "_cllExecSqlNoResultArray: SQLBindParameter failed: %d", 
+		    stat);
+	    result = -1;
+	    break;
+	 }
+      }
+   }
+
+   if (result==0) {
+      snprintf(tmpStr, TMP_STR_LEN, "%s (%d rows)", sql, numRows);
+      rodsLogSql(tmpStr);
+      stat = SQLExecute(myHstmt);
+      if (stat == SQL_SUCCESS || stat == SQL_SUCCESS_WITH_INFO) {
+	 rodsLogSqlResult("SUCCESS");
+	 cllCheckPending(sql, 0, icss->databaseType);
+      }
+      else {
+	 rodsLogSqlResult("SQL_ERROR");
+	 rodsLog(LOG_NOTICE,
+		 "_cllExecSqlNoResultArray: SQLExecute error: %d sql:%s",
+		 stat, sql);
+	 result = logPsgError(LOG_NOTICE, icss->environPtr, icss->connectPtr,
+			      myHstmt, icss->databaseType);
+	 if (result==0) result = -1;
+      }
+   }
+
+   stat = SQLFreeStmt(myHstmt, SQL_DROP);
+   if (stat != SQL_SUCCESS) {
+      rodsLog(LOG_ERROR, "_cllExecSqlNoResultArray: SQLFreeStmt error: %d", 
+	      stat);
+   }
+   for (j=0;j<numVars;j++) {
+      if (varBuf[j]!=NULL) free(varBuf[j]);
+   }
+   if (indBuf!=NULL) free(indBuf);
+   return(result);
+}
+
+/*
+ Execute a SQL command with no resulting table for each of numRows
+ rows of numVars bind variables (row after row in values).  The rows
+ are sent MAX_BIND_ARRAY_ROWS at a time as parameter arrays, or one by
+ one if the driver can't do that.
+ Insert a 'begin' statement, if necessary.
+ */
+int
+cllExecSqlNoResultArray(icatSessionStruct *icss, char *sql, int numVars,
+			int numRows, char **values) {
+   int status;
+   int row, rowsNow, i;
+   static int arrayNotSupported=0;
+
+   if (numVars <= 0 || numVars > MAX_BIND_VARS || numRows < 0) {
+      return(CAT_INVALID_ARGUMENT);
+   }
+   if (numRows == 0) return(0);
+
+   if (didBegin==0) {
+      status = _cllExecSqlNoResult(icss, "begin", 1);
+      if (status != SQL_SUCCESS) return(status);
+   }
+   didBegin=1;
+
+   for (row=0;row<numRows;row+=rowsNow) {
+      rowsNow = numRows - row;
+      if (rowsNow > MAX_BIND_ARRAY_ROWS) rowsNow = MAX_BIND_ARRAY_ROWS;
+      if (arrayNotSupported==0 && rowsNow > 1) {
+	 status = _cllExecSqlNoResultArray(icss, sql, numVars, rowsNow,
+					   &values[row*numVars]);
+	 if (status == 1) {
+	    rodsLog(LOG_NOTICE, 
+		    "cllExecSqlNoResultArray: no parameter arrays in the ODBC driver, executing row by row");
+	    arrayNotSupported=1;
+	 }
+	 else {
+	    if (status != 0) return(status);
+	    continue;
+	 }
+      }
+      for (i=0;i<rowsNow;i++) {
+	 memcpy(cllBindVars, &values[(row+i)*numVars], 
+		numVars * sizeof(char *));
+	 cllBindVarCount=numVars;
+	 status = _cllExecSqlNoResult(icss, sql, 0);
+	 if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+	    return(status);
+	 }
+      }
+   }
+   return(0);
+}
+
 /* 
   Execute a SQL command that returns a result table, and
   and bind the default row.
@@ -708,6 +1086,7 @@ cllExecSqlWithResult(icatSessionStruct *icss, int *stmtNum, char *sql) {
 
    int i;
    int statementNumber;
+   int cacheInx;
    char *status;
 
 /* In 2.2 and some versions before, this would call
@@ -719,11 +1098,20 @@ cllExecSqlWithResult(icatSessionStruct *icss, int *stmtNum, char *sql) {
 
    myHdbc = icss->connectPtr;
    rodsLog(LOG_DEBUG1, sql);
-   stat = SQLAllocStmt(myHdbc, &hstmt); 
-   if (stat != SQL_SUCCESS) {
-      rodsLog(LOG_ERROR, "cllExecSqlWithResult: SQLAllocStmt failed: %d",
-	      stat);
-      return(-1);
+
+   cacheInx=-1;
+   if (cllBindVarCount > 0) {
+      cacheInx = getPreparedStmt(icss, sql, &hstmt);
+      if (cacheInx < -1) return(-1);
+   }
+
+   if (cacheInx < 0) {
+      stat = SQLAllocStmt(myHdbc, &hstmt); 
+      if (stat != SQL_SUCCESS) {
+	 rodsLog(LOG_ERROR, "cllExecSqlWithResult: SQLAllocStmt failed: %d",
+		 stat);
+	 return(-1);
+      }
    }
 
    statementNumber=-1;
@@ -735,6 +1123,7 @@ cllExecSqlWithResult(icatSessionStruct *icss, int *stmtNum, char *sql) {
    if (statementNumber<0) {
       rodsLog(LOG_ERROR, 
 	      "cllExecSqlWithResult: too many concurrent statements");
+      if (cacheInx >= 0) releasePreparedStmt(icss, cacheInx);
       return(-2);
    }
 
@@ -742,12 +1131,24 @@ cllExecSqlWithResult(icatSessionStruct *icss, int *stmtNum, char *sql) {
    icss->stmtPtr[statementNumber]=myStatement;
 
    myStatement->stmtPtr=hstmt;
+   myStatement->preparedInx=cacheInx;
 
-   if (bindTheVariables(hstmt, sql) != 0) return(-1);
+   if (cacheInx >= 0) {
+      if (bindPreparedVariables(hstmt) != 0) {
+	 detachPreparedStmt(icss, cacheInx);
+	 myStatement->preparedInx=-1;
+	 return(-1);
+      }
+      rodsLogSql(sql);
+      stat = SQLExecute(hstmt);
+   }
+   else {
+      if (bindTheVariables(hstmt, sql) != 0) return(-1);
 
-   rodsLogSql(sql);
+      rodsLogSql(sql);
 
-   stat = SQLExecDirect(hstmt, (unsigned char *)sql, SQL_NTS);
+      stat = SQLExecDirect(hstmt, (unsigned char *)sql, SQL_NTS);
+   }
    status = "UNKNOWN";
    if (stat == SQL_SUCCESS) status= "SUCCESS";
    if (stat == SQL_SUCCESS_WITH_INFO) status="SUCCESS_WITH_INFO";
@@ -767,6 +1168,10 @@ cllExecSqlWithResult(icatSessionStruct *icss, int *stmtNum, char *sql) {
 	      stat, sql);
       logPsgError(LOG_NOTICE, icss->environPtr, myHdbc, hstmt,
 		  icss->databaseType);
+      if (cacheInx >= 0) {
+	 detachPreparedStmt(icss, cacheInx);
+	 myStatement->preparedInx=-1;
+      }
       return(-1);
    }
 
@@ -893,16 +1298,32 @@ cllExecSqlWithResultBV(icatSessionStruct *icss, int *stmtNum, char *sql,
 
    int i;
    int statementNumber;
+   int cacheInx;
+   int haveBindVars;
    char *status;
    char tmpStr[TMP_STR_LEN+2];
 
    myHdbc = icss->connectPtr;
    rodsLog(LOG_DEBUG1, sql);
-   stat = SQLAllocStmt(myHdbc, &hstmt); 
-   if (stat != SQL_SUCCESS) {
-      rodsLog(LOG_ERROR, "cllExecSqlWithResultBV: SQLAllocStmt failed: %d",
-	      stat);
-      return(-1);
+
+   haveBindVars = ((bindVar1 != 0 && *bindVar1 != '\0')  ||
+		   (bindVar2 != 0 && *bindVar2 != '\0')  ||
+		   (bindVar3 != 0 && *bindVar3 != '\0')  ||
+		   (bindVar4 != 0 && *bindVar4 != '\0'));
+
+   cacheInx=-1;
+   if (haveBindVars) {
+      cacheInx = getPreparedStmt(icss, sql, &hstmt);
+      if (cacheInx < -1) return(-1);
+   }
+
+   if (cacheInx < 0) {
+      stat = SQLAllocStmt(myHdbc, &hstmt); 
+      if (stat != SQL_SUCCESS) {
+	 rodsLog(LOG_ERROR, 
+		 "cllExecSqlWithResultBV: SQLAllocStmt failed: %d", stat);
+	 return(-1);
+      }
    }
 
    statementNumber=-1;
@@ -914,6 +1335,7 @@ cllExecSqlWithResultBV(icatSessionStruct *icss, int *stmtNum, char *sql,
    if (statementNumber<0) {
       rodsLog(LOG_ERROR, 
 	      "cllExecSqlWithResultBV: too many concurrent statements");
+      if (cacheInx >= 0) releasePreparedStmt(icss, cacheInx);
       return(-2);
    }
 
@@ -921,18 +1343,18 @@ cllExecSqlWithResultBV(icatSessionStruct *icss, int *stmtNum, char *sql,
    icss->stmtPtr[statementNumber]=myStatement;
 
    myStatement->stmtPtr=hstmt;
+   myStatement->preparedInx=cacheInx;
 
-   if ((bindVar1 != 0 && *bindVar1 != '\0')  ||
-       (bindVar2 != 0 && *bindVar2 != '\0')  ||
-       (bindVar3 != 0 && *bindVar3 != '\0')  ||
-       (bindVar4 != 0 && *bindVar4 != '\0')) {
+   if (haveBindVars) {
 
-      rodsLogSql("SQLPrepare");
-      stat = SQLPrepare(hstmt,  (unsigned char *)sql, SQL_NTS);
-      if (stat != SQL_SUCCESS) {
-	 rodsLog(LOG_ERROR, "cllExecSqlWithResultBV: SQLPrepare failed: %d",
-		 stat);
-	 return(-1);
+      if (cacheInx < 0) {
+	 rodsLogSql("SQLPrepare");
+	 stat = SQLPrepare(hstmt,  (unsigned char *)sql, SQL_NTS);
+	 if (stat != SQL_SUCCESS) {
+	    rodsLog(LOG_ERROR, 
+		    "cllExecSqlWithResultBV: SQLPrepare failed: %d", stat);
+	    return(-1);
+	 }
       }
 
       if (bindVar1 != 0 && *bindVar1 != '\0') {
@@ -1023,6 +1445,10 @@ cllExecSqlWithResultBV(icatSessionStruct *icss, int *stmtNum, char *sql,
 	      stat, sql);
       logPsgError(LOG_NOTICE, icss->environPtr, myHdbc, hstmt,
 		  icss->databaseType);
+      if (cacheInx >= 0) {
+	 detachPreparedStmt(icss, cacheInx);
+	 myStatement->preparedInx=-1;
+      }
       return(-1);
    }
 
@@ -1210,9 +1636,16 @@ cllFreeStatement(icatSessionStruct *icss, int statementNumber) {
       free(myStatement->resultColName[i]);
    }
 
-   stat = SQLFreeStmt(hstmt, SQL_DROP);
-   if (stat != SQL_SUCCESS) {
-      rodsLog(LOG_ERROR, "cllFreeStatement SQLFreeStmt error: %d", stat);
+   if (myStatement->preparedInx >= 0 &&
+       icss->stmtCache.stmt[myStatement->preparedInx].stmtPtr == hstmt) {
+      /* keep it prepared for the next call with the same sql */
+      releasePreparedStmt(icss, myStatement->preparedInx);
+   }
+   else {
+      stat = SQLFreeStmt(hstmt, SQL_DROP);
+      if (stat != SQL_SUCCESS) {
+	 rodsLog(LOG_ERROR, "cllFreeStatement SQLFreeStmt error: %d", stat);
+      }
    }
 
    free(myStatement);
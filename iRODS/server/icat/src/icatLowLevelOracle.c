@@ -633,6 +633,31 @@ cllExecSqlNoResult(icatSessionStruct *icss, char *sqlInput)
 
 }
 
+/*
+ Execute a SQL command which has no resulting table for each of
+ numRows rows of numVars bind variables (row after row in values).
+ This version executes the rows one by one.
+ */
+int
+cllExecSqlNoResultArray(icatSessionStruct *icss, char *sql, int numVars,
+			int numRows, char **values) {
+   int status;
+   int i;
+
+   if (numVars <= 0 || numVars > MAX_BIND_VARS || numRows < 0) {
+      return(CAT_INVALID_ARGUMENT);
+   }
+   for (i=0;i<numRows;i++) {
+      memcpy(cllBindVars, &values[i*numVars], numVars * sizeof(char *));
+      cllBindVarCount=numVars;
+      status = cllExecSqlNoResult(icss, sql);
+      if (status != 0 && status != CAT_SUCCESS_BUT_WITH_NO_INFO) {
+	 return(status);
+      }
+   }
+   return(0);
+}
+
 
 /*
   Return a row from a previous cllExecSqlWithResult call.
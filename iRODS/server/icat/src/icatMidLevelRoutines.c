@@ -116,6 +116,21 @@ int cmlExecuteNoAnswerSql( char *sql,
 
 }
 
+/* Execute sql for each of numRows rows of numVars bind variables
+   (the variables of the first row, then the second, ...) */
+int cmlExecuteNoAnswerSqlArray( char *sql, int numVars, int numRows,
+				char **values, icatSessionStruct *icss)
+{
+  int i;
+
+  i = cllExecSqlNoResultArray(icss, sql, numVars, numRows, values);
+  if (i) { 
+     if (i <= CAT_ENV_ERR) return(i); /* already an iRODS error code */
+     return(CAT_SQL_ERR);
+  }
+  return(0);
+}
+
 int cmlGetOneRowFromSqlBV (char *sql, 
 		   char *cVal[], 
 		   int cValSize[], 
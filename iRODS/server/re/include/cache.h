@@ -12,8 +12,24 @@
 #include "restruct.templates.h"
 #include "end.instance.h"
 
+/* The header of the shared memory cache. version is bumped once a new image is complete,
+ * the active image is version % 2. Readers do not lock, they check that the version has not
+ * changed while they attached the image. */
+typedef struct cacheHeader {
+	volatile unsigned int version;
+	volatile int published; /* set once the first image is complete */
+	time_type updateTS;
+} CacheHeader;
+
+#if defined(__GNUC__)
+#define CACHE_MEMORY_BARRIER() __sync_synchronize()
+#else
+#define CACHE_MEMORY_BARRIER()
+#endif
+
 Cache *copyCache(unsigned char **buf, size_t size, Cache *c);
 Cache *restoreCache(unsigned char *buf);
+void releaseRestoredCache(Cache *cache);
 void applyDiff(unsigned char *pointers, long pointersSize, long diff, long pointerDiff);
 void applyDiffToPointers(unsigned char *pointers, long pointersSize, long pointerDiff);
 int updateCache(unsigned char *shared, size_t size, Cache *cache, int processType);
@@ -25,8 +25,8 @@ typedef enum ruleEngineStatus {
     UNINITIALIZED,
     INITIALIZED,
     COMPRESSED,
-    /*SHARED,
-    LOCAL,
+    SHARED, /* mapped from the shared memory cache image, not allocated */
+    /*LOCAL,
     DISABLED*/
 } RuleEngineStatus;
 
@@ -135,6 +135,7 @@ typedef struct cache {
 extern RuleEngineStatus _ruleEngineStatus;
 extern int isServer;
 extern Cache ruleEngineConfig;
+extern unsigned int RuleBaseVersion;
 
 RuleEngineStatus getRuleEngineStatus();
 int unlinkFuncDescIndex();
@@ -8,6 +8,12 @@
 #include <setjmp.h>
 
 #define DEFAULT_BLOCK_SIZE 1024
+/* the blocks of a region double in size, from DEFAULT_BLOCK_SIZE up to
+ * MAX_POOLED_BLOCK_SIZE. Freed blocks of these sizes are kept in a per
+ * process pool, one free list per size, up to REGION_POOL_SIZE bytes */
+#define MAX_POOLED_BLOCK_SIZE (64*1024)
+#define NUM_BLOCK_CLASSES 7
+#define REGION_POOL_SIZE (2*1024*1024)
 /* the alignment in the region in bytes */
 #define REGION_ALIGNMENT 8
 #define roundToAlignment(x) ((x)%REGION_ALIGNMENT == 0?(x):(((x)/REGION_ALIGNMENT)+1)*REGION_ALIGNMENT)
@@ -38,6 +44,7 @@ struct region_node {
 	unsigned char *block; /* pointer to memory block */
 	size_t size; /* size of the memory block in bytes */
 	size_t used; /* used bytes of the memory block */
+	int blockClass; /* the pool free list of the block, -1 if not pooled */
 	struct region_node *next; /* pointer to the next region */
 
 };
@@ -70,4 +77,17 @@ void *region_alloc(Region *r, size_t s);
 /* free region r */
 void region_free(Region *r);
 size_t region_size(Region *r);
+
+/* allocation statistics of the process */
+typedef struct region_stats {
+	unsigned long regions; /* regions made */
+	unsigned long blocks; /* blocks added to regions */
+	unsigned long poolHits; /* blocks taken from the pool */
+	size_t poolSize; /* bytes in the pool now */
+	size_t maxRegionSize; /* the highest high water of a freed region */
+	/* freed regions by high water: up to DEFAULT_BLOCK_SIZE << i bytes,
+	 * the last one for larger regions */
+	unsigned long regionSizes[NUM_BLOCK_CLASSES + 1];
+} RegionStats;
+void region_stats(RegionStats *stats);
 #endif
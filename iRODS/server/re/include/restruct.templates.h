@@ -19,6 +19,7 @@ RE_STRUCT_BEGIN(Node)
 	MK_PTR(RuleIndexList, ruleIndexList)
 	MK_TRANSIENT_PTR(SmsiFuncType, func)
 	MK_PTR(msParam_t, param)
+	MK_VAL(int, msIndex)
 /*      printf("inserting %s\n", key); */
 /*
           printf("tvar %s is added to shared objects\n", tvarNameBuf);
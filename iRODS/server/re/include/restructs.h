@@ -254,6 +254,7 @@ struct node {
     RuleIndexList *ruleIndexList;
     SmsiFuncTypePtr func;
 	msParam_t *param;
+	int msIndex; /* MicrosTable index + 1 of the micro service last applied at this node, 0 if not resolved */
 };
 
 typedef enum ruleType {
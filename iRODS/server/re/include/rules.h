@@ -26,6 +26,7 @@ extern microsdef_t MicrosTable[];
 #define GET_FUNC_PTR(ms_entry) ((ms_entry).callAction_)
 #define GET_NUM_ARGS(ms_entry) ((ms_entry).numberOfStringArgs_)
 #define LOOKUP_ACTION_TABLE(ms_entry, action) (actionTableLookUp3((ms_entry), (action)))
+#define LOOKUP_ACTION_TABLE_NODE(ms_entry, action, node) (actionTableLookUp3((ms_entry), (action)))
 int actionTableLookUp3 (MS_DEF_TYPE& microsdef, char *action);
 
 #else
@@ -33,10 +34,21 @@ int actionTableLookUp3 (MS_DEF_TYPE& microsdef, char *action);
 #define GET_FUNC_PTR(ms_entry) ((ms_entry)->callAction)
 #define GET_NUM_ARGS(ms_entry) ((ms_entry)->numberOfStringArgs)
 #define LOOKUP_ACTION_TABLE(ms_entry, action) (actionTableLookUp3(&(ms_entry), (action)))
+#define LOOKUP_ACTION_TABLE_NODE(ms_entry, action, node) (actionTableLookUpNode(&(ms_entry), (action), (node)))
 int actionTableLookUp3 (MS_DEF_TYPE* microsdef, char *action);
+int actionTableLookUpNode (MS_DEF_TYPE* microsdef, char *action, Node *node);
+void addMicroServiceStat (int actionInx, rodsLong_t usec);
+void logMicroServiceStats (int logLevel);
 
 #endif // ifdef USE_EIRODS
 
+#define PARSED_ACTION_CACHE_SIZE 256	/* texts parsed before the cache is reset */
+#define MAX_PARSED_ACTION_LEN 1024	/* longer texts are not cached */
+
+Node *getParsedAction(char *expr);
+void addPolicyHookStat (char *action, rodsLong_t usec);
+void logPolicyHookStats (int logLevel);
+
 int setLocalVarValue(char* varName, ruleExecInfo_t *rei, Res* res, char* errmsg, Region *r);
 int readRuleSetFromFile(char *ruleBaseName, RuleSet *ruleSet, Env *funcDesc, int* errloc, rError_t *errmsg, Region *r);
 int readRuleSetFromLocalFile(char *ruleBaseName, char *fileName, RuleSet *ruleSet, Env *funcDesc, int *errloc, rError_t *errmsg, Region *r);
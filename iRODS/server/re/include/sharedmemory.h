@@ -22,8 +22,17 @@
 #define SHMMAX 30000000
 #define SHM_BASE_ADDR ((void *)0x80000000)
 #define shm_rname "SHM"
+/* The shared memory object named shm_rname only holds a small header
+ * with the version of the active cache image. The images themselves are
+ * kept in two objects, shm_image_rname followed by 0 or 1, so that a new
+ * image can be built while agents keep using the active one. */
+#define SHM_HEADER_SIZE 4096
+#define shm_image_rname "SHM_IMG"
 unsigned char *prepareServerSharedMemory();
 void detachSharedMemory();
 int removeSharedMemory();
 unsigned char *prepareNonServerSharedMemory();
+unsigned char *createSharedImage(int inx);
+unsigned char *attachSharedImage(int inx);
+void detachSharedImage(unsigned char *image);
 #endif /* SHAREDMEMORY_H */
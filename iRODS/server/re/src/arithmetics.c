@@ -1,6 +1,7 @@
 /* For copyright information please refer to files in the COPYRIGHT directory
  */
 
+#include <sys/time.h>
 #include "utils.h"
 #include "restructs.h"
 #include "parser.h"
@@ -798,7 +799,7 @@ Res* execAction3(char *actionName, Res** args, unsigned int nargs, int applyAllR
 //rodsLog( LOG_NOTICE, "calling pluggable MSVC from arithmetics.c:execAction3" );
 #endif
 	MS_DEF_TYPE microsdef;
-	int actionInx = LOOKUP_ACTION_TABLE(microsdef, action);
+	int actionInx = LOOKUP_ACTION_TABLE_NODE(microsdef, action, node);
 	if (actionInx < 0) { /* rule */
 		/* no action (microservice) found, try to lookup a rule */
 		Res *actionRet = execRule(actionName, args, nargs, applyAllRule, env, rei, reiSaveFlag, errmsg, r);
@@ -835,7 +836,7 @@ Res* execMicroService3 (char *msName, Res **args, unsigned int nargs, Node *node
 #endif
 	/* look up the micro service */
 	MS_DEF_TYPE microsdef;
-	actionInx = LOOKUP_ACTION_TABLE(microsdef, msName);
+	actionInx = LOOKUP_ACTION_TABLE_NODE(microsdef, msName, node);
 
 	char errbuf[ERR_MSG_LEN];
 	if (actionInx < 0) {
@@ -907,6 +908,10 @@ Res* execMicroService3 (char *msName, Res **args, unsigned int nargs, Node *node
 		reDebug(EXEC_MICRO_SERVICE_BEGIN, -4, &param, node, env,rei);
 	}
 
+#ifndef USE_EIRODS
+	struct timeval startTime, endTime;
+	(void) gettimeofday(&startTime, (struct timezone *) 0);
+#endif
 	if (numOfStrArgs == 0)
 		ii = (*(int (*)(ruleExecInfo_t *))myFunc) (rei) ;
 	else if (numOfStrArgs == 1)
@@ -930,6 +935,11 @@ Res* execMicroService3 (char *msName, Res **args, unsigned int nargs, Node *node
 	else if (numOfStrArgs == 10)
 		ii = (*(int (*)(msParam_t *, msParam_t *, msParam_t *, msParam_t *, msParam_t *, msParam_t *, msParam_t *, msParam_t *, msParam_t *, msParam_t *, ruleExecInfo_t *))myFunc) (myArgv[0],myArgv[1],myArgv[2],myArgv[3],myArgv[4],myArgv[5],myArgv[6],myArgv[7],
 		                myArgv[8],myArgv [9],rei);
+#ifndef USE_EIRODS
+	(void) gettimeofday(&endTime, (struct timezone *) 0);
+	addMicroServiceStat(actionInx, (endTime.tv_sec - startTime.tv_sec) * 1000000LL +
+		(endTime.tv_usec - startTime.tv_usec));
+#endif
 
     /* move errmsgs from rei to errmsg */
 	if(rei->rsComm != NULL) {
@@ -74,87 +74,98 @@ Cache *copyCache(unsigned char **p, size_t size, Cache *ptr) {
 }
 
 /*
- * Restore a Cache struct from buf into a malloc'd buffer.
- * This function returns NULL if failed to acquire or release the mutex.
- * It first create a local copy of buf's data section and pointer pointers section. This part needs synchronization.
- * Then it works on its local copy, which does not need synchronization.
+ * Make a malloc'd copy of a cache image that is not mapped at the address it was built for,
+ * and offset all its pointers to the copy.
  */
-Cache *restoreCache(unsigned char *buf) {
-	mutex_type *mutex;
+static Cache *copyCacheImage(unsigned char *buf) {
     Cache *cache = (Cache *) buf;
     unsigned char *bufCopy;
     unsigned char *pointers;
     size_t pointersSize;
     unsigned char *bufMapped;
-
-    unsigned char *pointersCopy;
     unsigned char *pointersMapped;
     size_t dataSize;
-    unsigned int version, version2;
-    int success = 0;
-    do {
-		if(lockMutex(&mutex) != 0) {
-			break;
-		}
-    	version = cache->version;
-        unlockMutex(&mutex);
-    	dataSize = cache->dataSize;
-    	pointersMapped = cache->pointers;
-    	bufMapped = cache->address;
-    	if(pointersMapped<bufMapped || pointersMapped -bufMapped > SHMMAX || dataSize > SHMMAX) {
-    		sleep(1);
-    		continue;
-    	}
-    	bufCopy = (unsigned char *)malloc(dataSize);
-    	if(bufCopy == NULL) {
-			return NULL;
-		}
-		memcpy(bufCopy, buf, cache->dataSize);
-    	pointersSize = bufMapped + SHMMAX - pointersMapped;
-		pointersCopy = (unsigned char *)malloc(pointersSize);
-    	if(pointersCopy == NULL) {
-    		free(bufCopy);
-			return NULL;
-		}
-		memcpy(pointersCopy, pointersMapped+(buf - bufMapped), pointersSize);
-		if(lockMutex(&mutex)!=0) {
-			free(bufCopy);
-			free(pointersCopy);
-			break;
-		}
-    	version2 = cache->version;
-        unlockMutex(&mutex);
-		if(version2 != version) {
-			free(bufCopy);
-			free(pointersCopy);
-			sleep(1);
-		} else {
-			success = 1;
-		}
-    } while(!success);
-
-    if(!success) {
-    	return NULL;
-    }
-    pointers = pointersCopy;
 
-/*    bufCopy = (unsigned char *)malloc(cache->dataSize);
-
-    if(bufCopy == NULL) {
-        return NULL;
-    }
-    memcpy(bufCopy, buf, cache->dataSize);
-
-    bufMapped = cache->address;
+	dataSize = cache->dataSize;
+	pointersMapped = cache->pointers;
+	bufMapped = cache->address;
+	if(pointersMapped<bufMapped || pointersMapped -bufMapped > SHMMAX || dataSize > SHMMAX) {
+		return NULL;
+	}
+	bufCopy = (unsigned char *)malloc(dataSize);
+	if(bufCopy == NULL) {
+		return NULL;
+	}
+	memcpy(bufCopy, buf, dataSize);
+	pointersSize = bufMapped + SHMMAX - pointersMapped;
+	pointers = (unsigned char *)malloc(pointersSize);
+	if(pointers == NULL) {
+		free(bufCopy);
+		return NULL;
+	}
+	memcpy(pointers, pointersMapped+(buf - bufMapped), pointersSize);
 
-    long diffBuf = buf - bufMapped;
-    pointers = cache->pointers + diffBuf;
-    pointersSize = pointers - buf; */
     long diff = bufCopy - bufMapped;
     long pointerDiff = diff;
     applyDiff(pointers, pointersSize, diff, pointerDiff);
-    free(pointersCopy);
+    free(pointers);
     cache = (Cache *) bufCopy;
+    cache->address = bufCopy;
+    cache->cacheStatus = INITIALIZED;
+    return cache;
+}
+
+/*
+ * Restore a Cache struct from the shared memory whose header is buf.
+ * This function returns NULL if no cache has been published yet or the image cannot be mapped.
+ * The active image is mapped copy on write. If it is mapped at the address it was built for,
+ * it is used in place without copying and its cacheStatus is set to SHARED. Otherwise a
+ * malloc'd copy is made and the image is detached.
+ * No mutex is needed: the image is never modified once published, a new one is built in the
+ * other image, and the version is checked again after attaching to detect a concurrent update.
+ */
+Cache *restoreCache(unsigned char *buf) {
+    CacheHeader *header = (CacheHeader *) buf;
+    Cache *cache;
+    unsigned char *image;
+    unsigned int version, version2;
+
+    for(;;) {
+    	if(!header->published) {
+    		return NULL;
+    	}
+    	version = header->version;
+    	CACHE_MEMORY_BARRIER();
+    	image = attachSharedImage(version % 2);
+    	CACHE_MEMORY_BARRIER();
+    	version2 = header->version;
+    	if(version2 != version) {
+    		/* updated while attaching, try the new image */
+    		if(image != NULL) {
+    			detachSharedImage(image);
+    		}
+    		continue;
+    	}
+    	if(image == NULL) {
+    		return NULL;
+    	}
+    	cache = (Cache *) image;
+    	if(cache->version != version) {
+    		detachSharedImage(image);
+    		return NULL;
+    	}
+    	break;
+    }
+
+    if(cache->address == image) {
+    	cache->cacheStatus = SHARED;
+    } else {
+    	cache = copyCacheImage(image);
+    	detachSharedImage(image);
+    	if(cache == NULL) {
+    		return NULL;
+    	}
+    }
 
 #ifdef RE_CACHE_CHECK
     Hashtable *objectMap = newHashTable(100);
@@ -163,6 +174,16 @@ Cache *restoreCache(unsigned char *buf) {
 #endif
     return cache;
 }
+
+/* Release a cache returned by restoreCache */
+void releaseRestoredCache(Cache *cache) {
+	if(cache->cacheStatus == SHARED) {
+		detachSharedImage(cache->address);
+	} else {
+		free(cache->address);
+	}
+}
+
 void applyDiff(unsigned char *pointers, long pointersSize, long diff, long pointerDiff) {
     unsigned char *p;
 #ifdef DEBUG_VERBOSE
@@ -205,70 +226,50 @@ void applyDiffToPointers(unsigned char *pointers, long pointersSize, long pointe
  * 		   else return.
  * 	   except when the processType is RULE_ENGINE_INIT_CACHE, which means that the share caches has not been initialized.
  * 		   or when the processType is RULE_ENGINE_REFRESH_CACHE, which means that we want to refresh the cache with the new cache.
- * It prepares the data in the new cache for copying into the shared cache.
- * It checks the timestamp again and does the actually copying.
+ * The new cache is copied directly into the inactive image, which is then published by bumping the version
+ * in the header. The mutex only serializes updaters, readers do not use it.
  */
 int updateCache(unsigned char *shared, size_t size, Cache *cache, int processType) {
 	mutex_type *mutex;
 	time_type timestamp;
+	CacheHeader *header = (CacheHeader *) shared;
 	time_type_set(timestamp, cache->timestamp);
 
 	if(lockMutex(&mutex) != 0) {
 		rodsLog(LOG_ERROR, "Failed to update cache, lock mutex 1.");
 		return -1;
 	}
-	if(processType == RULE_ENGINE_INIT_CACHE || processType == RULE_ENGINE_REFRESH_CACHE || time_type_gt(timestamp, ((Cache *)shared)->updateTS)) {
-		time_type_set(((Cache *)shared)->updateTS, timestamp);
-		unlockMutex(&mutex);
+	if(processType == RULE_ENGINE_INIT_CACHE || processType == RULE_ENGINE_REFRESH_CACHE || time_type_gt(timestamp, header->updateTS)) {
+		int ret;
+		/* the version wraps around at UINT_MAX + 1, keeping the image index alternating */
+		unsigned int version = header->published ? header->version + 1 : 0;
+		time_type_set(header->updateTS, timestamp);
 
-		unsigned char *buf = (unsigned char *) malloc(size);
-		if(buf != NULL) {
-			int ret;
-			unsigned char *cacheBuf = buf;
-			Cache *cacheCopy = copyCache(&cacheBuf, size, cache);
-			if(cacheCopy != NULL) {
+		unsigned char *image = createSharedImage(version % 2);
+		if(image == NULL) {
+			unlockMutex(&mutex);
+			rodsLog(LOG_ERROR, "Cannot update cache because the shared memory image cannot be created.");
+			return -1;
+		}
+		unsigned char *cacheBuf = image;
+		Cache *cacheCopy = copyCache(&cacheBuf, size, cache);
+		if(cacheCopy != NULL) {
 #ifdef DEBUG
-				printf("Buffer usage: %fM\n", ((double)(cacheCopy->dataSize))/(1024*1024));
+			printf("Buffer usage: %fM\n", ((double)(cacheCopy->dataSize))/(1024*1024));
 #endif
-				size_t pointersSize = (cacheCopy->address + cacheCopy->cacheSize) - cacheCopy->pointers;
-				long diff = shared - cacheCopy->address;
-				unsigned char *pointers = cacheCopy->pointers;
-
-				applyDiff(pointers, pointersSize, diff, 0);
-				applyDiffToPointers(pointers, pointersSize, diff);
-
-				if(lockMutex(&mutex) != 0) {
-					rodsLog(LOG_ERROR, "Failed to update cache, lock mutex 2.");
-					free(buf);
-					return -1;
-				}
-				if(processType == RULE_ENGINE_INIT_CACHE || processType == RULE_ENGINE_REFRESH_CACHE || !time_type_gt(((Cache *)shared)->updateTS, timestamp)) {
-
-					switch(processType) {
-					case RULE_ENGINE_INIT_CACHE:
-						cacheCopy->version = 0;
-						break;
-					default:
-						cacheCopy->version = ((Cache *)shared)->version;
-						INC_MOD(cacheCopy->version, UINT_MAX);
-					}
-					/* copy data */
-					memcpy(shared, buf, cacheCopy->dataSize);
-					/* copy pointers */
-					memcpy(cacheCopy->pointers, pointers, pointersSize);
-				}
-				unlockMutex(&mutex);
-				ret = 0;
-			} else {
-				rodsLog(LOG_ERROR, "Error updating cache.");
-				ret = -1;
-			}
-			free(buf);
-			return ret;
+			cacheCopy->version = version;
+			CACHE_MEMORY_BARRIER();
+			/* publish */
+			header->version = version;
+			header->published = 1;
+			ret = 0;
 		} else {
-			rodsLog(LOG_ERROR, "Cannot update cache because of out of memory error, let some other process update it later when memory is available.");
-			return -1;
+			rodsLog(LOG_ERROR, "Error updating cache.");
+			ret = -1;
 		}
+		detachSharedImage(image);
+		unlockMutex(&mutex);
+		return ret;
 	} else {
 		unlockMutex(&mutex);
 		rodsLog(LOG_DEBUG, "Cache has been updated by some other process.");
@@ -277,5 +278,3 @@ int updateCache(unsigned char *shared, size_t size, Cache *cache, int processTyp
 
 }
 
-
-
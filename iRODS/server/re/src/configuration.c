@@ -54,6 +54,11 @@ Cache ruleEngineConfig = {
     "", /* char ruleBase[RULE_SET_DEF_LENGTH] */
 };
 
+/* bumped whenever the rule sets or the function tables of this process
+ * may have changed. Kept out of Cache since that is restored from the
+ * shared memory image */
+unsigned int RuleBaseVersion = 1;
+
 void removeRuleFromExtIndex(char *ruleName, int i) {
 	if(isComponentInitialized(ruleEngineConfig.extFuncDescIndexStatus)) {
 		FunctionDesc *fd = (FunctionDesc *)lookupFromHashTable(ruleEngineConfig.extFuncDescIndex->current, ruleName);
@@ -109,6 +114,7 @@ int checkPointExtRuleSet(Region *r) {
 }*/
 void prependAppRule(RuleDesc *rd, Region *r) {
 	int i = ruleEngineConfig.appRuleSet->len++;
+	RuleBaseVersion++;
 	ruleEngineConfig.appRuleSet->rules[i] = rd;
 	prependRuleIntoAppIndex(rd, i, r);
 }
@@ -138,6 +144,7 @@ void setRuleEngineMemStatus(RuleEngineStatus s) {
 	_ruleEngineMemStatus = s;
 } */
 int clearResources(int resources) {
+	RuleBaseVersion++;
 	clearFuncDescIndex(APP, app);
 	clearFuncDescIndex(SYS, sys);
 	clearFuncDescIndex(CORE, core);
@@ -154,6 +161,10 @@ int clearResources(int resources) {
 		free(ruleEngineConfig.address);
 		ruleEngineConfig.address = NULL;
 		ruleEngineConfig.cacheStatus = UNINITIALIZED;
+	} else if((resources & RESC_CACHE) && ruleEngineConfig.cacheStatus == SHARED) {
+		detachSharedImage(ruleEngineConfig.address);
+		ruleEngineConfig.address = NULL;
+		ruleEngineConfig.cacheStatus = UNINITIALIZED;
 	}
 	return 0;
 }
@@ -161,8 +172,10 @@ List hashtablesToClear = {0, NULL, NULL};
 List envToClear = {0, NULL, NULL};
 List regionsToClear = {0, NULL, NULL};
 List memoryToFree = {0, NULL, NULL};
+List imagesToDetach = {0, NULL, NULL};
 
 void delayClearResources(int resources) {
+	RuleBaseVersion++;
 	/*if((resources & RESC_RULE_INDEX) && ruleEngineConfig.ruleIndexStatus == INITIALIZED) {
 		listAppendNoRegion(hashtablesToClear, ruleEngineConfig.ruleIndex);
 		ruleEngineConfig.ruleIndexStatus = UNINITIALIZED;
@@ -186,6 +199,11 @@ void delayClearResources(int resources) {
 	if((resources & RESC_CACHE) && ruleEngineConfig.cacheStatus == INITIALIZED) {
 		listAppendNoRegion(&memoryToFree, ruleEngineConfig.address);
 		ruleEngineConfig.cacheStatus = UNINITIALIZED;
+	} else if((resources & RESC_CACHE) && ruleEngineConfig.cacheStatus == SHARED) {
+		/* rules still running may point into the shared image, detach it in clearDelayed */
+		listAppendNoRegion(&imagesToDetach, ruleEngineConfig.address);
+		ruleEngineConfig.address = NULL;
+		ruleEngineConfig.cacheStatus = UNINITIALIZED;
 	}
 }
 
@@ -214,6 +232,12 @@ void clearDelayed() {
 				listRemoveNoRegion(&memoryToFree, n);
 				n = memoryToFree.head;
 			}
+		n = imagesToDetach.head;
+			while(n!=NULL) {
+				detachSharedImage((unsigned char *) n->value);
+				listRemoveNoRegion(&imagesToDetach, n);
+				n = imagesToDetach.head;
+			}
 }
 
 void setCacheAddress(unsigned char *addr, RuleEngineStatus status, long size) {
@@ -227,6 +251,8 @@ int generateLocalCache() {
     unsigned char *buf = NULL;
 	if(ruleEngineConfig.cacheStatus == INITIALIZED) {
 		free(ruleEngineConfig.address);
+	} else if(ruleEngineConfig.cacheStatus == SHARED) {
+		detachSharedImage(ruleEngineConfig.address);
 	}
 	buf = (unsigned char *)malloc(SHMMAX);
 	if(buf == NULL) {
@@ -328,12 +354,20 @@ int loadRuleFromCacheOrFile(int processType, char *irbSet, ruleStruct_t *inRuleS
 
 	Cache *cache;
     int update = 0;
+    int reuse = 0;
     unsigned char *buf = NULL;
 	/* try to find shared memory cache */
     if(processType == RULE_ENGINE_TRY_CACHE && inRuleStruct == &coreRuleStrct) {
     	buf = prepareNonServerSharedMemory();
     	if(buf != NULL) {
-            cache = restoreCache(buf);
+    		CacheHeader *header = (CacheHeader *) buf;
+    		if(ruleEngineConfig.cacheStatus == SHARED && header->published && header->version == ruleEngineConfig.version) {
+    			/* the image mapped by a previous call is still the active one, e.g. in a pooled agent */
+    			cache = (Cache *) ruleEngineConfig.address;
+    			reuse = 1;
+    		} else {
+    			cache = restoreCache(buf);
+    		}
 	        detachSharedMemory();
 
 	        if(cache == NULL) {
@@ -346,12 +380,18 @@ int loadRuleFromCacheOrFile(int processType, char *irbSet, ruleStruct_t *inRuleS
 
 	        	if(diffIrbSet || time_type_gt(timestamp, cache->timestamp)) {
 					 update = 1;
-					 free(cache->address);
+					 if(!reuse) {
+						 releaseRestoredCache(cache);
+					 }
 					 rodsLog(LOG_DEBUG, "Rule base set or rule files modified, force refresh.");
 				} else {
 
-					cache->cacheStatus = INITIALIZED;
+					/* cacheStatus is SHARED if the image is used in place, INITIALIZED if it was copied */
 					ruleEngineConfig = *cache;
+					if(!reuse) {
+						/* a copy of the image, at a new address */
+						RuleBaseVersion++;
+					}
 					/* generate extRuleSet */
 					generateRegions();
 					generateRuleSets();
@@ -400,6 +440,7 @@ int loadRuleFromCacheOrFile(int processType, char *irbSet, ruleStruct_t *inRuleS
 	}
 
 	createRuleIndex(inRuleStruct);
+	RuleBaseVersion++;
 	/* set max timestamp */
 	time_type_set(ruleEngineConfig.timestamp, timestamp);
 	rstrcpy(ruleEngineConfig.ruleBase, irbSet, RULE_SET_DEF_LENGTH);
@@ -2,6 +2,7 @@
  *** For more information please refer to files in the COPYRIGHT directory ***/
 /* #define RE_LOG_RULES_TMP */
 #define HAS_MICROSDEF_T
+#include <sys/time.h>
 #include "reGlobals.h"
 #include "initServer.h"
 #include "reHelpers1.h"
@@ -476,6 +477,8 @@ applyRuleBase(char *inAction, msParamArray_t *inMsParamArray, int updateInMsPara
 
     int ret;
     Res *res;
+    struct timeval startTime, endTime;
+    (void) gettimeofday(&startTime, (struct timezone *) 0);
     if(inAction[strlen(inAction)-1]=='|') {
     	char *inActionCopy = strdup(inAction);
     	inActionCopy[strlen(inAction) - 1] = '\0';
@@ -489,6 +492,9 @@ applyRuleBase(char *inAction, msParamArray_t *inMsParamArray, int updateInMsPara
 	}
 	ret = processReturnRes(res);
     region_free(r);
+    (void) gettimeofday(&endTime, (struct timezone *) 0);
+    addPolicyHookStat(inAction, (endTime.tv_sec - startTime.tv_sec) * 1000000LL +
+        (endTime.tv_usec - startTime.tv_usec));
     if (GlobalREAuditFlag > 0) {
   	  RuleEngineEventParam param;
   	  param.actionName = inAction;
@@ -1835,9 +1841,20 @@ writeMSrvcsIntoFile(char * inFileName, msrvcStruct_t *myMsrvcStruct,
 int
 finalzeRuleEngine(rsComm_t *rsComm)
 {
+  RegionStats regionStats;
+
   if ( GlobalREDebugFlag > 5 ) {
     _writeXMsg(GlobalREDebugFlag, "idbug", "PROCESS END");
   }
+#ifndef USE_EIRODS
+  logMicroServiceStats(LOG_DEBUG);
+#endif
+  logPolicyHookStats(LOG_DEBUG);
+  region_stats(&regionStats);
+  rodsLog(LOG_DEBUG,
+    "rule engine regions: %lu made, %lu blocks, %lu from the pool, max size %lld",
+    regionStats.regions, regionStats.blocks, regionStats.poolHits,
+    (rodsLong_t) regionStats.maxRegionSize);
   return(0);
 }
 
@@ -2,6 +2,9 @@
  */
 #include "region.h"
 #include <string.h>
+#ifndef windows_platform
+#include <pthread.h>
+#endif
 #ifdef REGION_MALLOC
 
 Region *make_region(size_t is, jmp_buf *label) {
@@ -57,16 +60,70 @@ size_t region_size(Region *r) {
 	}
 	return s;
 }
+void region_stats(RegionStats *stats) {
+	memset(stats, 0, sizeof(RegionStats));
+}
+#else
+/*
+ * The block pool. Regions are made and freed for every rule, expression and
+ * env copy, so the blocks are recycled instead of going back to malloc.
+ * The pool is per process. It and Stats are guarded by PoolMutex, rules
+ * also run in the portal threads of a parallel transfer (applyRuleForSvrPortal)
+ * and in the irodsFs threads.
+ */
+static struct region_node *BlockPool[NUM_BLOCK_CLASSES];
+static RegionStats Stats;
+#ifndef windows_platform
+static pthread_mutex_t PoolMutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_POOL()	pthread_mutex_lock (&PoolMutex)
+#define UNLOCK_POOL()	pthread_mutex_unlock (&PoolMutex)
 #else
+#define LOCK_POOL()
+#define UNLOCK_POOL()
+#endif
+
+/* the smallest block class that holds s bytes, -1 if none does */
+static int block_class(size_t s) {
+	int i;
+	for(i = 0; i < NUM_BLOCK_CLASSES; i++) {
+		if(s <= ((size_t) DEFAULT_BLOCK_SIZE << i)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
 /* utility function */
+/* the block is not zeroed here, region_alloc_nodesc zeroes what it hands out */
 struct region_node *make_region_node(size_t is) {
-	struct region_node *node = (struct region_node *)malloc(sizeof(Region));
+	struct region_node *node;
+	int blockClass = block_class(is);
+
+	LOCK_POOL();
+	Stats.blocks++;
+	if(blockClass >= 0 && BlockPool[blockClass] != NULL) {
+		node = BlockPool[blockClass];
+		BlockPool[blockClass] = node->next;
+		Stats.poolSize -= node->size;
+		Stats.poolHits++;
+		UNLOCK_POOL();
+		node->used = 0;
+		node->next = NULL;
+		return node;
+	}
+	UNLOCK_POOL();
+
+	node = (struct region_node *)malloc(sizeof(struct region_node));
 	if(node == NULL) {
 		return NULL;
 	}
 
+	if(blockClass >= 0) {
+		is = (size_t) DEFAULT_BLOCK_SIZE << blockClass;
+	} else {
+		is = roundToAlignment(is);
+	}
 	node->block = (unsigned char *)malloc(is);
-        memset(node->block, 0, is);
 	if(node->block == NULL) {
 		free(node);
 		return NULL;
@@ -74,10 +131,25 @@ struct region_node *make_region_node(size_t is) {
 
 	node->size = is;
 	node->used = 0;
+	node->blockClass = blockClass;
 	node->next = NULL;
 
 	return node;
 }
+/* return the node to the pool, or to malloc if it is not pooled or the pool is full */
+void free_region_node(struct region_node *node) {
+	LOCK_POOL();
+	if(node->blockClass >= 0 && Stats.poolSize + node->size <= REGION_POOL_SIZE) {
+		node->next = BlockPool[node->blockClass];
+		BlockPool[node->blockClass] = node;
+		Stats.poolSize += node->size;
+		UNLOCK_POOL();
+	} else {
+		UNLOCK_POOL();
+		free(node->block);
+		free(node);
+	}
+}
 Region *make_region(size_t is, jmp_buf *label) {
 	Region *r = (Region *)malloc(sizeof(Region));
 	if(r == NULL)
@@ -94,16 +166,21 @@ Region *make_region(size_t is, jmp_buf *label) {
 	r->head = r->active = node;
         r->label = label;
         r->error.code = 0; /* set no error */
+	LOCK_POOL();
+	Stats.regions++;
+	UNLOCK_POOL();
 	return r;
 }
 unsigned char *region_alloc_nodesc(Region *r, size_t s, size_t *alloc_size) {
-	if(s > r->active->size - r->active->used) {
-            int blocksize;
-            if(s > DEFAULT_BLOCK_SIZE) {
-                blocksize=s;
-
-            } else {
-                blocksize= DEFAULT_BLOCK_SIZE;
+	*alloc_size = roundToAlignment(s);
+	if(*alloc_size > r->active->size - r->active->used) {
+            /* each new block is twice the size of the last one, up to MAX_POOLED_BLOCK_SIZE */
+            size_t blocksize = r->active->size * 2;
+            if(blocksize > MAX_POOLED_BLOCK_SIZE) {
+                blocksize = MAX_POOLED_BLOCK_SIZE;
+            }
+            if(*alloc_size > blocksize) {
+                blocksize = *alloc_size;
             }
             struct region_node *next = make_region_node(blocksize);
             if(next == NULL) {
@@ -118,30 +195,39 @@ unsigned char *region_alloc_nodesc(Region *r, size_t s, size_t *alloc_size) {
 
 	}
 
-	*alloc_size =
-                s>DEFAULT_BLOCK_SIZE?
-                    s:
-                    roundToAlignment(s);
 	unsigned char *pointer = r->active->block + r->active->used;
 	r->active->used+=*alloc_size;
+	/* callers expect zeroed memory. Only the bytes handed out are zeroed,
+	 * not the whole block when it is made or recycled */
+	memset(pointer, 0, *alloc_size);
 	return pointer;
 
 }
 void *region_alloc(Region *r, size_t size) {
 	size_t allocSize;
     unsigned char *mem = region_alloc_nodesc(r, size + CACHE_SIZE(RegionDesc, 1), &allocSize);
+    if(mem == NULL) {
+        return NULL;
+    }
     ((RegionDesc *)mem)->region = r;
     ((RegionDesc *)mem)->size = allocSize;
     ((RegionDesc *)mem)->del = 0;
     return mem + CACHE_SIZE(RegionDesc, 1);
 }
 void region_free(Region *r) {
+	size_t highWater = region_size(r);
+	int sizeClass = block_class(highWater);
+
+	LOCK_POOL();
+	Stats.regionSizes[sizeClass < 0 ? NUM_BLOCK_CLASSES : sizeClass]++;
+	if(highWater > Stats.maxRegionSize) {
+		Stats.maxRegionSize = highWater;
+	}
+	UNLOCK_POOL();
 	while(r->head!=NULL) {
 		struct region_node *node = r->head;
 		r->head = node->next;
-		/* memset(node->block, 0, node->size); */
-		free(node->block);
-		free(node);
+		free_region_node(node);
 	}
 	free(r->label);
 	free(r);
@@ -155,6 +241,11 @@ size_t region_size(Region *r) {
 	}
 	return s;
 }
+void region_stats(RegionStats *stats) {
+	LOCK_POOL();
+	*stats = Stats;
+	UNLOCK_POOL();
+}
 #endif
 
 /* tests */
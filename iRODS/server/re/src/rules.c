@@ -532,6 +532,96 @@ Res* computeNode(Node *node, Node *reco, Env *env, ruleExecInfo_t *rei, int reiS
     return res;
 }
 
+/*
+ * The parsed action cache. The policy hooks are applied with the same short
+ * action texts on every data operation. The typed AST of such a text is kept
+ * in ParsedActionRegion so that it is parsed and typed once per rule base
+ * version. The nodes are typed against the function tables of the rule base,
+ * so the cache is dropped when RuleBaseVersion changes and is not used while
+ * an ext rule set is pushed. Only the texts that parse and type cleanly are
+ * cached; the others take the normal path, which reports the error.
+ */
+static Region *ParsedActionRegion = NULL;
+static Hashtable *ParsedActionCache = NULL;
+static unsigned int ParsedActionVersion = 0;
+static int ParsedActionParseCnt = 0;
+static unsigned int ParsedActionHitCnt = 0;
+static unsigned int ParsedActionMissCnt = 0;
+
+static Node *parseActionForCache(char *expr, Region *r) {
+    rError_t errmsgBuf;
+    Node *node, *errnode;
+    Token *token;
+    int rulegen;
+
+    errmsgBuf.errMsg = NULL;
+    errmsgBuf.len = 0;
+    Pointer *e = newPointer2(expr);
+    if(e == NULL) {
+        return NULL;
+    }
+    ParserContext *pc = newParserContext(&errmsgBuf, r);
+    rulegen = isRuleGenSyntax(expr);
+    if(rulegen) {
+    	node = parseTermRuleGen(e, rulegen, pc);
+    } else {
+    	node = parseActionsRuleGen(e, rulegen, 1, pc);
+    }
+    if(node != NULL && getNodeType(node) != N_ERROR) {
+        token = nextTokenRuleGen(e, pc, 0, 0);
+        if(strcmp(token->text, "|")==0) {
+            /* the recovery actions are not computed, see computeNode */
+            Node *recoNode = parseActionsRuleGen(e, rulegen, 1, pc);
+            token = recoNode == NULL || getNodeType(recoNode) == N_ERROR ? NULL : nextTokenRuleGen(e, pc, 0, 0);
+        }
+        if(token == NULL || token->type != TK_EOS ||
+            typeNode(node, newHashTable2(10, r), &errmsgBuf, &errnode, r) != 0) {
+            node = NULL;
+        }
+    } else {
+        node = NULL;
+    }
+    deleteParserContext(pc);
+    deletePointer(e);
+    freeRErrorContent(&errmsgBuf);
+    return node;
+}
+
+Node *getParsedAction(char *expr) {
+    Node *node;
+
+    if(ruleEngineConfig.extRuleSet != NULL && ruleEngineConfig.extRuleSet->len > 0) {
+        return NULL;
+    }
+    if(strlen(expr) > MAX_PARSED_ACTION_LEN) {
+        return NULL;
+    }
+    if(ParsedActionRegion != NULL && (ParsedActionVersion != RuleBaseVersion ||
+        ParsedActionParseCnt >= PARSED_ACTION_CACHE_SIZE)) {
+        /* stale, or full of one off texts */
+        region_free(ParsedActionRegion);
+        ParsedActionRegion = NULL;
+    }
+    if(ParsedActionRegion == NULL) {
+        ParsedActionRegion = make_region(0, NULL);
+        ParsedActionCache = newHashTable2(PARSED_ACTION_CACHE_SIZE, ParsedActionRegion);
+        ParsedActionVersion = RuleBaseVersion;
+        ParsedActionParseCnt = 0;
+    }
+    node = (Node *) lookupFromHashTable(ParsedActionCache, expr);
+    if(node != NULL) {
+        ParsedActionHitCnt++;
+        return node;
+    }
+    ParsedActionMissCnt++;
+    ParsedActionParseCnt++;
+    node = parseActionForCache(expr, ParsedActionRegion);
+    if(node != NULL) {
+        insertIntoHashTable(ParsedActionCache, expr, node);
+    }
+    return node;
+}
+
 /* parse and compute an expression
  *
  */
@@ -549,6 +639,9 @@ Res *parseAndComputeExpression(char *expr, Env *env, ruleExecInfo_t *rei, int re
             addRErrorMsg(errmsg, RE_BUFFER_OVERFLOW, "error: potential buffer overflow");
             return newErrorRes(r, RE_BUFFER_OVERFLOW);
     }
+    if((node = getParsedAction(expr)) != NULL) {
+        return computeNode(node, NULL, env, rei, reiSaveFlag, errmsg, r);
+    }
     Pointer *e = newPointer2(expr);
     ParserContext *pc = newParserContext(errmsg, r);
     if(e == NULL) {
@@ -672,10 +765,25 @@ int actionTableLookUp3 (MS_DEF_TYPE& microsdef, char *action)
 	return 0;
 } // actionTableLookUp
 #else
+typedef struct {
+	unsigned int calls;
+	rodsLong_t usec;
+} microServiceStat_t;
+
+static microServiceStat_t *MicroServiceStats = NULL;
+static unsigned int ActionLookUpCnt = 0;
+static unsigned int ActionLookUpNodeHitCnt = 0;
+
 int actionTableLookUp (char *action)
 {
 	int i;
 
+	ActionLookUpCnt++;
+	/* MicrosTable is static, so the index is built once per process */
+	if (microsTableIndex != NULL || createMacorsIndex()) {
+		return actionTableLookUp2(action);
+	}
+
 	for (i = 0; i < NumOfAction; i++) {
 		if (!strcmp(MicrosTable[i].action,action)) {
 			return (i);
@@ -688,12 +796,135 @@ int actionTableLookUp (char *action)
 int actionTableLookUp3 (MS_DEF_TYPE* microsdef, char *action)
 {
 	int i = actionTableLookUp(action);
-	*microsdef = &(MicrosTable[i]);
+	if (i >= 0) {
+		*microsdef = &(MicrosTable[i]);
+	}
+	return i;
+}
+
+/*
+ * look up action using the index cached on the node that applies it. The
+ * cached index is checked against the action name, as the name can change
+ * with the function map.
+ */
+int actionTableLookUpNode (MS_DEF_TYPE* microsdef, char *action, Node *node)
+{
+	int i;
+
+	if (node != NULL && node->msIndex > 0 && node->msIndex <= NumOfAction &&
+		strcmp(MicrosTable[node->msIndex - 1].action, action) == 0) {
+		ActionLookUpNodeHitCnt++;
+		i = node->msIndex - 1;
+	} else {
+		i = actionTableLookUp(action);
+		if (i >= 0 && node != NULL) {
+			node->msIndex = i + 1;
+		}
+	}
+	if (i >= 0) {
+		*microsdef = &(MicrosTable[i]);
+	}
 	return i;
 }
+
+void addMicroServiceStat (int actionInx, rodsLong_t usec)
+{
+	if (actionInx < 0 || actionInx >= NumOfAction) {
+		return;
+	}
+	if (MicroServiceStats == NULL) {
+		MicroServiceStats = (microServiceStat_t *) calloc(NumOfAction, sizeof(microServiceStat_t));
+		if (MicroServiceStats == NULL) {
+			return;
+		}
+	}
+	MicroServiceStats[actionInx].calls++;
+	MicroServiceStats[actionInx].usec += usec;
+}
+
+void logMicroServiceStats (int logLevel)
+{
+	int i;
+
+	rodsLog(logLevel, "micro service table: %u lookups, %u resolved from node",
+		ActionLookUpCnt, ActionLookUpNodeHitCnt);
+	if (MicroServiceStats == NULL) {
+		return;
+	}
+	for (i = 0; i < NumOfAction; i++) {
+		if (MicroServiceStats[i].calls > 0) {
+			rodsLog(logLevel, "micro service %s: %u calls, %lld usec, %lld usec/call",
+				MicrosTable[i].action, MicroServiceStats[i].calls,
+				MicroServiceStats[i].usec,
+				MicroServiceStats[i].usec / MicroServiceStats[i].calls);
+		}
+	}
+}
 #endif
 
+/*
+ * The time spent in each policy hook applied with applyRule, keyed by the
+ * action name. Logged with the micro service stats when the agent ends.
+ */
+typedef struct {
+	unsigned int calls;
+	rodsLong_t usec;
+} policyHookStat_t;
+
+static Hashtable *PolicyHookStats = NULL;
+
+void addPolicyHookStat (char *action, rodsLong_t usec)
+{
+	char name[NAME_LEN];
+	policyHookStat_t *stat;
+	int i = 0;
+
+	while (*action == '{' || *action == ' ' || *action == '\t') {
+		action++;
+	}
+	while (i < NAME_LEN - 1 && action[i] != '\0' && action[i] != '(' &&
+		action[i] != ' ' && action[i] != '\t' && action[i] != '|') {
+		name[i] = action[i];
+		i++;
+	}
+	name[i] = '\0';
+	if (PolicyHookStats == NULL) {
+		PolicyHookStats = newHashTable(100);
+		if (PolicyHookStats == NULL) {
+			return;
+		}
+	}
+	stat = (policyHookStat_t *) lookupFromHashTable(PolicyHookStats, name);
+	if (stat == NULL) {
+		stat = (policyHookStat_t *) calloc(1, sizeof(policyHookStat_t));
+		if (stat == NULL) {
+			return;
+		}
+		insertIntoHashTable(PolicyHookStats, name, stat);
+	}
+	stat->calls++;
+	stat->usec += usec;
+}
+
+void logPolicyHookStats (int logLevel)
+{
+	struct bucket *b;
+	policyHookStat_t *stat;
+	int i;
 
+	rodsLog(logLevel, "parsed action cache: %u hits, %u misses",
+		ParsedActionHitCnt, ParsedActionMissCnt);
+	if (PolicyHookStats == NULL) {
+		return;
+	}
+	for (i = 0; i < PolicyHookStats->size; i++) {
+		for (b = PolicyHookStats->buckets[i]; b != NULL; b = b->next) {
+			stat = (policyHookStat_t *) b->value;
+			rodsLog(logLevel, "policy hook %s: %u calls, %lld usec, %lld usec/call",
+				b->key, stat->calls, stat->usec, stat->usec / stat->calls);
+		}
+	}
+}
 
 /*
  * Set retOutParam to 1 if you need to retrieve the output parameters from inMsParamArray and 0 if not
@@ -2,6 +2,7 @@
  */
 
 #include <fcntl.h>
+#include <sys/stat.h>
 #include "sharedmemory.h"
 #include "utils.h"
 #include "filesystem.h"
@@ -10,19 +11,26 @@
 #ifdef USE_BOOST
 static boost::interprocess::shared_memory_object *shm_obj = NULL;
 static boost::interprocess::mapped_region *mapped = NULL;
+static boost::interprocess::mapped_region *imageMapped = NULL;
 #else
 int shmid = - 1;
 void *shmBuf = NULL;
 #endif
 
+static void getImageName(char shm_name[1024], int inx) {
+	char rname[100];
+	snprintf(rname, sizeof(rname), "%s%d", shm_image_rname, inx);
+	getResourceName(shm_name, rname);
+}
+
 unsigned char *prepareServerSharedMemory() {
 	char shm_name[1024];
 	getResourceName(shm_name, shm_rname);
 #ifdef USE_BOOST
 	shm_obj = new boost::interprocess::shared_memory_object(boost::interprocess::open_or_create, shm_name, boost::interprocess::read_write);
 	boost::interprocess::offset_t size;
-	if(shm_obj->get_size(size) && size==0) {
-		shm_obj->truncate(SHMMAX);
+	if(shm_obj->get_size(size) && size!=SHM_HEADER_SIZE) {
+		shm_obj->truncate(SHM_HEADER_SIZE);
 	}
 	mapped = new boost::interprocess::mapped_region(*shm_obj, boost::interprocess::read_write);
 	unsigned char *shmBuf = (unsigned char *) mapped->get_address();
@@ -30,12 +38,12 @@ unsigned char *prepareServerSharedMemory() {
 #else
 		shmid = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
 		if(shmid!= -1) {
-			if(ftruncate(shmid, SHMMAX) == -1) {
+			if(ftruncate(shmid, SHM_HEADER_SIZE) == -1) {
 				close(shmid);
 				shm_unlink(shm_name);
 				return NULL;
 			}
-			shmBuf = mmap(SHM_BASE_ADDR, SHMMAX, PROT_READ | PROT_WRITE, MAP_SHARED, shmid , 0);
+			shmBuf = mmap(NULL, SHM_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, shmid , 0);
 			if(shmBuf == MAP_FAILED) {
 				close(shmid);
 				shm_unlink(shm_name);
@@ -52,14 +60,25 @@ void detachSharedMemory() {
 #ifdef USE_BOOST
 	delete mapped;
 	delete shm_obj;
+	mapped = NULL;
+	shm_obj = NULL;
 #else
-	munmap(shmBuf, SHMMAX);
+	munmap(shmBuf, SHM_HEADER_SIZE);
 	close(shmid);
 #endif
 }
 
 int removeSharedMemory() {
 	char shm_name[1024];
+	int i;
+	for(i = 0; i < 2; i++) {
+		getImageName(shm_name, i);
+#ifdef USE_BOOST
+		boost::interprocess::shared_memory_object::remove(shm_name);
+#else
+		shm_unlink(shm_name);
+#endif
+	}
 	getResourceName(shm_name, shm_rname);
 #ifdef USE_BOOST
 	if(!boost::interprocess::shared_memory_object::remove(shm_name)) {
@@ -90,7 +109,7 @@ unsigned char *prepareNonServerSharedMemory() {
 #else
 	shmid = shm_open(shm_name, O_RDONLY, 0400);
 	if(shmid!= -1) {
-		shmBuf = mmap(SHM_BASE_ADDR, SHMMAX, PROT_READ, MAP_SHARED, shmid, 0);
+		shmBuf = mmap(NULL, SHM_HEADER_SIZE, PROT_READ, MAP_SHARED, shmid, 0);
 		if(shmBuf == MAP_FAILED) { /* not server process and shm is successfully allocated */
 			close(shmid);
 			return NULL;
@@ -101,3 +120,102 @@ unsigned char *prepareNonServerSharedMemory() {
 	}
 #endif
 }
+
+/*
+ * Create a new, empty cache image inx and map it read-write, preferably at SHM_BASE_ADDR.
+ * The old object is unlinked first rather than overwritten so that processes which still
+ * have it mapped keep a consistent copy.
+ */
+unsigned char *createSharedImage(int inx) {
+	char shm_name[1024];
+	getImageName(shm_name, inx);
+#ifdef USE_BOOST
+	boost::interprocess::shared_memory_object::remove(shm_name);
+	try {
+		boost::interprocess::shared_memory_object image(boost::interprocess::create_only, shm_name, boost::interprocess::read_write);
+		image.truncate(SHMMAX);
+		try {
+			imageMapped = new boost::interprocess::mapped_region(image, boost::interprocess::read_write, 0, SHMMAX, SHM_BASE_ADDR);
+		} catch(boost::interprocess::interprocess_exception e) {
+			imageMapped = new boost::interprocess::mapped_region(image, boost::interprocess::read_write, 0, SHMMAX);
+		}
+		return (unsigned char *) imageMapped->get_address();
+	} catch(boost::interprocess::interprocess_exception e) {
+		return NULL;
+	}
+#else
+	int fd;
+	void *image;
+	shm_unlink(shm_name);
+	fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(fd == -1) {
+		return NULL;
+	}
+	if(ftruncate(fd, SHMMAX) == -1) {
+		close(fd);
+		shm_unlink(shm_name);
+		return NULL;
+	}
+	image = mmap(SHM_BASE_ADDR, SHMMAX, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(image == MAP_FAILED) {
+		shm_unlink(shm_name);
+		return NULL;
+	}
+	return (unsigned char *) image;
+#endif
+}
+
+/*
+ * Map cache image inx, preferably at SHM_BASE_ADDR. The mapping is private (copy on write):
+ * the pages are shared with the other agents until this process writes to them, and such
+ * writes never reach the shared image.
+ */
+unsigned char *attachSharedImage(int inx) {
+	char shm_name[1024];
+	getImageName(shm_name, inx);
+#ifdef USE_BOOST
+	try {
+		boost::interprocess::shared_memory_object image(boost::interprocess::open_only, shm_name, boost::interprocess::read_only);
+		boost::interprocess::offset_t size;
+		if(!image.get_size(size) || size < SHMMAX) { /* still being created */
+			return NULL;
+		}
+		try {
+			imageMapped = new boost::interprocess::mapped_region(image, boost::interprocess::copy_on_write, 0, SHMMAX, SHM_BASE_ADDR);
+		} catch(boost::interprocess::interprocess_exception e) {
+			imageMapped = new boost::interprocess::mapped_region(image, boost::interprocess::copy_on_write, 0, SHMMAX);
+		}
+		return (unsigned char *) imageMapped->get_address();
+	} catch(boost::interprocess::interprocess_exception e) {
+		return NULL;
+	}
+#else
+	int fd;
+	void *image;
+	struct stat statbuf;
+	fd = shm_open(shm_name, O_RDONLY, 0400);
+	if(fd == -1) {
+		return NULL;
+	}
+	if(fstat(fd, &statbuf) == -1 || statbuf.st_size < SHMMAX) { /* still being created */
+		close(fd);
+		return NULL;
+	}
+	image = mmap(SHM_BASE_ADDR, SHMMAX, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(image == MAP_FAILED) {
+		return NULL;
+	}
+	return (unsigned char *) image;
+#endif
+}
+
+void detachSharedImage(unsigned char *image) {
+#ifdef USE_BOOST
+	delete imageMapped;
+	imageMapped = NULL;
+#else
+	munmap(image, SHMMAX);
+#endif
+}
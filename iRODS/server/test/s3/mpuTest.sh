@@ -0,0 +1,41 @@
+#!/bin/bash
+#
+# This script exercises the multipart transfers of the S3 driver. It
+# puts a file into the cache resource of an S3 compound resource,
+# replicates it to the S3 archive, trims the cache copy and gets the
+# file back, which stages it from S3. The rename in between copies the
+# S3 object. The irodsServer must have been
+# started with the environment below, e.g. against a local S3
+# compatible server such as minio, and the driver built with libs3 2.0.
+#
+#   export S3_DEFAULT_HOSTNAME=localhost:9000
+#   export S3_PROTOCOL=http
+#   export S3_MPU_CHUNK=5	(part size in MB)
+#   export S3_MPU_THREADS=4
+#
+# usage: mpuTest.sh cacheResc s3Resc [sizeInMB]
+#
+
+CACHE_RESC=${1:?usage: mpuTest.sh cacheResc s3Resc [sizeInMB]}
+S3_RESC=${2:?usage: mpuTest.sh cacheResc s3Resc [sizeInMB]}
+SIZE_MB=${3:-64}
+SRC_FILE=/tmp/mpuTest.$$
+GET_FILE=/tmp/mpuTest.get.$$
+
+set -e
+trap "rm -f $SRC_FILE $GET_FILE; irm -f mpuTest.$$.mv 2> /dev/null" EXIT
+
+dd if=/dev/urandom of=$SRC_FILE bs=1M count=$SIZE_MB 2> /dev/null
+
+iput -R $CACHE_RESC $SRC_FILE mpuTest.$$
+time irepl -R $S3_RESC mpuTest.$$
+# the rename of the S3 copy is a multipart copy and a delete
+time imv mpuTest.$$ mpuTest.$$.mv
+itrim -S $CACHE_RESC -N 1 mpuTest.$$.mv
+time iget mpuTest.$$.mv $GET_FILE
+
+if [ "$(md5sum < $SRC_FILE)" != "$(md5sum < $GET_FILE)" ]; then
+    echo "mpuTest: checksum mismatch"
+    exit 1
+fi
+echo "mpuTest: $SIZE_MB MB file round trip through $S3_RESC OK"
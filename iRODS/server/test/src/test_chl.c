@@ -14,6 +14,7 @@
 #include "icatMidLevelRoutines.h"
 
 #include <string.h>
+#include <sys/time.h>
 
 extern icatSessionStruct *chlGetRcs();
 
@@ -450,6 +451,62 @@ int testRegDataMulti(rsComm_t *rsComm, char *count,
    return(status);
 }
 
+/*
+ Compare data registration throughput with the ODBC prepared statement
+ cache disabled and enabled.  count objects are registered in each
+ pass, named nameBase.nocache.N and nameBase.cache.N, so use a test
+ collection that can be removed afterwards.
+
+Example:
+bin/test_chl regbench 1000 /newZone/home/rods/ws2/f1 generic /tmp/vault/f1
+ */
+int testRegDataBench(rsComm_t *rsComm, char *count, 
+		     char *nameBase,  char *dataType, char *filePath) {
+   int status;
+   int myCount;
+   int i, pass;
+   char myName[MAX_NAME_LEN];
+   icatSessionStruct *icss;
+   struct timeval startTime, endTime;
+   float elapsed[2];
+
+   myCount = atoi(count);
+   if (myCount <=0) {
+      printf("Invalid input: count\n");
+      return(USER_INPUT_OPTION_ERR);
+   }
+
+   icss = chlGetRcs();
+   if (icss==NULL) return(CAT_NOT_OPEN);
+
+   rodsLogSqlReq(0);
+   for (pass=0;pass<2;pass++) {
+      icss->stmtCache.disabled = (pass==0);
+      (void) gettimeofday(&startTime, (struct timezone *)0);
+      for (i=0;i<myCount;i++) {
+	 snprintf (myName, sizeof myName, "%s.%s.%d", nameBase, 
+		   pass==0 ? "nocache" : "cache", i);
+	 status = testRegDataObj(rsComm, myName, dataType, filePath);
+	 if (status) return(status);
+      }
+      status = chlCommit(rsComm);
+      if (status) return(status);
+      (void) gettimeofday(&endTime, (struct timezone *)0);
+      elapsed[pass] = (endTime.tv_sec - startTime.tv_sec) +
+	 (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+      if (elapsed[pass] <= 0) elapsed[pass] = 0.000001;
+   }
+   icss->stmtCache.disabled = 0;
+
+   printf("uncached: %d registrations in %.3f sec, %.1f/sec\n", 
+	  myCount, elapsed[0], myCount/elapsed[0]);
+   printf("cached:   %d registrations in %.3f sec, %.1f/sec\n", 
+	  myCount, elapsed[1], myCount/elapsed[1]);
+   printf("prepared statement cache hits=%d misses=%d\n",
+	  icss->stmtCache.hits, icss->stmtCache.misses);
+   return(0);
+}
+
 int testModDataObjMeta(rsComm_t *rsComm, char *name, 
 		       char *dataType, char *filePath) {
    dataObjInfo_t dataObjInfo;
@@ -948,6 +1005,10 @@ main(int argc, char **argv) {
       didOne=1;
    }
 
+   if (strcmp(argv[1],"regbench")==0) {
+      status = testRegDataBench(Comm, argv[2], argv[3], argv[4], argv[5]);
+      didOne=1;
+   }
    if (strcmp(argv[1],"mod")==0) {
       status = testModDataObjMeta(Comm, argv[2], argv[3], argv[4]);
       didOne=1;
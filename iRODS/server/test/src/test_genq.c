@@ -8,6 +8,11 @@
 #include "readServerConfig.h"
 
 #include "icatHighLevelRoutines.h"
+#include "icatMidLevelRoutines.h"
+
+#include <sys/time.h>
+
+extern icatSessionStruct *chlGetRcs();
 
 int sTest(int i1, int i2);
 int sTest2(int i1, int i2, int i3);
@@ -806,6 +811,75 @@ doTest15(char *testString, char *testString2, char *testString3) {
 }
 
 
+/*
+ Compare GeneralQuery throughput with the ODBC prepared statement cache
+ and the generated SQL cache disabled and enabled, by listing the
+ data-objects in collection repCount times in each mode.
+ Example: bin/test_genq bench 1000 /newZone/home/rods
+ */
+int doBench(char *repCount, char *collection) {
+   genQueryInp_t genQueryInp;
+   genQueryOut_t genQueryOut;
+   char condStr[MAX_NAME_LEN];
+   int iRepCount, i, pass, status=0;
+   icatSessionStruct *icss;
+   struct timeval startTime, endTime;
+   float elapsed[3];
+
+   rodsLogSqlReq(0);
+   iRepCount = atoi(repCount);
+   if (iRepCount <= 0) {
+      printf("Invalid input: repCount\n");
+      return(USER_INPUT_OPTION_ERR);
+   }
+   icss = chlGetRcs();
+   if (icss==NULL) return(CAT_NOT_OPEN);
+
+   memset (&genQueryInp, 0, sizeof (genQueryInp));
+   snprintf (condStr, MAX_NAME_LEN, "='%s'", collection);
+   addInxVal (&genQueryInp.sqlCondInp, COL_COLL_NAME, condStr);
+   addInxIval (&genQueryInp.selectInp, COL_DATA_NAME, 1);
+   addInxIval (&genQueryInp.selectInp, COL_D_DATA_ID, 1);
+
+   for (pass=0;pass<3;pass++) {
+      icss->stmtCache.disabled = (pass==0);
+      chlGenQuerySqlCache(pass==2);
+      (void) gettimeofday(&startTime, (struct timezone *)0);
+      for (i=0;i<iRepCount;i++) {
+	 genQueryInp.maxRows=10;
+	 genQueryInp.continueInx=0;
+	 memset (&genQueryOut, 0, sizeof (genQueryOut));
+	 status = chlGenQuery(genQueryInp, &genQueryOut);
+	 if (status < 0 && status != CAT_NO_ROWS_FOUND) return(status);
+	 clearGenQueryOut(&genQueryOut);
+	 if (genQueryOut.continueInx>0) {
+	    /* close out the statement */
+	    genQueryInp.maxRows=-1;
+	    genQueryInp.continueInx = genQueryOut.continueInx;
+	    chlGenQuery(genQueryInp, &genQueryOut);
+	 }
+      }
+      (void) gettimeofday(&endTime, (struct timezone *)0);
+      elapsed[pass] = (endTime.tv_sec - startTime.tv_sec) +
+	 (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+      if (elapsed[pass] <= 0) elapsed[pass] = 0.000001;
+   }
+   icss->stmtCache.disabled = 0;
+
+   printf("uncached:      %d queries in %.3f sec, %.1f/sec\n", 
+	  iRepCount, elapsed[0], iRepCount/elapsed[0]);
+   printf("stmt cached:   %d queries in %.3f sec, %.1f/sec\n", 
+	  iRepCount, elapsed[1], iRepCount/elapsed[1]);
+   printf("stmt+SQL cached: %d queries in %.3f sec, %.1f/sec\n", 
+	  iRepCount, elapsed[2], iRepCount/elapsed[2]);
+   printf("prepared statement cache hits=%d misses=%d\n",
+	  icss->stmtCache.hits, icss->stmtCache.misses);
+   rodsLogLevel(LOG_NOTICE);
+   chlGenQueryShapeStats(LOG_NOTICE);
+   rodsLogLevel(LOG_ERROR);
+   return(0);
+}
+
 int
 main(int argc, char **argv) {
    int i1, i2, i3, i;
@@ -846,6 +920,7 @@ main(int argc, char **argv) {
       if (strcmp(argv[1],"gen13")==0) mode=14;
       if (strcmp(argv[1],"lsr")==0) mode=15;
       if (strcmp(argv[1],"gen15")==0) mode=16;
+      if (strcmp(argv[1],"bench")==0) mode=17;
    }
 
    if (argc ==3 && mode==0) {
@@ -1034,6 +1109,11 @@ main(int argc, char **argv) {
 	 if (status <0) exit(2);
 	 exit(0);
       }
+      if (mode==17) {
+	 status = doBench(argv[2], argv[3]);
+	 if (status <0) exit(2);
+	 exit(0);
+      }
 
       genQueryInp.maxRows=2;
       i = chlGenQuery(genQueryInp, &result);
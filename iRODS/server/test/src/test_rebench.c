@@ -0,0 +1,192 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* test_rebench.c - measure the rule engine start up cost of a freshly
+ * forked agent with and without the shared memory rule cache.
+ *
+ * A server process is simulated by a child that loads the rule base with
+ * RULE_ENGINE_INIT_CACHE and publishes it in shared memory. Then
+ * numAgents children are forked one after another for each of
+ * RULE_ENGINE_TRY_CACHE and RULE_ENGINE_NO_CACHE, and each reports the
+ * time taken by initRuleEngine back through a pipe.
+ *
+ * With -g numRules, a synthetic rule base rebench.re of numRules rules
+ * is written to $irodsConfigDir/reConfigs and used instead of ruleSet.
+ */
+
+#include <sys/time.h>
+#include <sys/wait.h>
+#include "rodsServer.h"
+#include "reGlobalsExtern.h"
+#include "reDefines.h"
+#include "configuration.h"
+#include "filesystem.h"
+#include "sharedmemory.h"
+
+#define DEF_NUM_AGENTS	20
+#define BENCH_RULE_SET	"rebench"
+
+int
+genBenchRuleBase (int numRules);
+int
+runInit (int processType, char *ruleSet, double *elapsed);
+int
+runAgents (int processType, char *ruleSet, int numAgents, double *total,
+double *maxTime);
+
+void
+rebench_usage (char *prog)
+{
+    printf ("Usage: %s [-n numAgents] [-g numRules] [ruleSet]\n", prog);
+}
+
+int
+main (int argc, char **argv)
+{
+    int c, status;
+    int numAgents = DEF_NUM_AGENTS;
+    int numRules = 0;
+    char ruleSet[RULE_SET_DEF_LENGTH];
+    double initTime, cacheTotal, cacheMax, noCacheTotal, noCacheMax;
+
+    rstrcpy (ruleSet, "core", RULE_SET_DEF_LENGTH);
+    while ((c = getopt (argc, argv, "n:g:h")) != EOF) {
+        switch (c) {
+            case 'n':
+                numAgents = atoi (optarg);
+                if (numAgents <= 0) numAgents = DEF_NUM_AGENTS;
+                break;
+            case 'g':
+                numRules = atoi (optarg);
+                break;
+            default:
+                rebench_usage (argv[0]);
+                exit (1);
+        }
+    }
+    if (optind < argc) {
+        rstrcpy (ruleSet, argv[optind], RULE_SET_DEF_LENGTH);
+    }
+    if (numRules > 0) {
+        if ((status = genBenchRuleBase (numRules)) < 0) {
+            exit (1);
+        }
+        rstrcpy (ruleSet, BENCH_RULE_SET, RULE_SET_DEF_LENGTH);
+    }
+
+    /* the server, publishes the cache */
+    status = runInit (RULE_ENGINE_INIT_CACHE, ruleSet, &initTime);
+    if (status < 0) {
+        fprintf (stderr, "server initRuleEngine of %s failed, status = %d\n",
+          ruleSet, status);
+        exit (2);
+    }
+    status = runAgents (RULE_ENGINE_TRY_CACHE, ruleSet, numAgents,
+      &cacheTotal, &cacheMax);
+    if (status >= 0) {
+        status = runAgents (RULE_ENGINE_NO_CACHE, ruleSet, numAgents,
+          &noCacheTotal, &noCacheMax);
+    }
+    removeSharedMemory ();
+    if (status < 0) {
+        fprintf (stderr, "agent initRuleEngine of %s failed, status = %d\n",
+          ruleSet, status);
+        exit (2);
+    }
+
+    printf ("rule set %s, %d agents, server init %.3f ms\n", ruleSet,
+      numAgents, initTime * 1000);
+    printf ("%-10s %12s %12s\n", "mode", "avg ms", "max ms");
+    printf ("%-10s %12.3f %12.3f\n", "cache", cacheTotal * 1000 / numAgents,
+      cacheMax * 1000);
+    printf ("%-10s %12.3f %12.3f\n", "no cache",
+      noCacheTotal * 1000 / numAgents, noCacheMax * 1000);
+    if (cacheTotal > 0) {
+        printf ("speedup %.2fx\n", noCacheTotal / cacheTotal);
+    }
+    exit (0);
+}
+
+int
+genBenchRuleBase (int numRules)
+{
+    int i;
+    char fn[MAX_NAME_LEN];
+    FILE *fptr;
+
+    getRuleBasePath (BENCH_RULE_SET, fn);
+    if ((fptr = fopen (fn, "w")) == NULL) {
+        fprintf (stderr, "cannot create %s, errno = %d\n", fn, errno);
+        return (UNIX_FILE_OPEN_ERR - errno);
+    }
+    for (i = 0; i < numRules; i++) {
+        fprintf (fptr, "benchRule%d(*A, *B) {\n", i);
+        fprintf (fptr, "  ON(*A == \"%d\") {\n", i);
+        fprintf (fptr, "    *B = \"benchRule%d\" ++ *A;\n", i);
+        fprintf (fptr, "    writeLine(\"serverLog\", *B);\n");
+        fprintf (fptr, "  }\n}\n");
+    }
+    fclose (fptr);
+    return (0);
+}
+
+/* runInit - fork a child that calls initRuleEngine with processType and
+ * sends back the elapsed time. Returns the child's status.
+ */
+int
+runInit (int processType, char *ruleSet, double *elapsed)
+{
+    int fd[2];
+    int status, childStatus;
+    pid_t pid;
+    struct timeval startTime, endTime;
+    double result[2];
+
+    *elapsed = 0;
+    if (pipe (fd) < 0) {
+        return (SYS_PIPE_ERROR - errno);
+    }
+    if ((pid = fork ()) < 0) {
+        close (fd[0]);
+        close (fd[1]);
+        return (SYS_FORK_ERROR - errno);
+    } else if (pid == 0) {
+        close (fd[0]);
+        (void) gettimeofday (&startTime, (struct timezone *) 0);
+        status = initRuleEngine (processType, NULL, ruleSet, "core", "core");
+        (void) gettimeofday (&endTime, (struct timezone *) 0);
+        result[0] = status;
+        result[1] = (endTime.tv_sec - startTime.tv_sec) +
+          (endTime.tv_usec - startTime.tv_usec) / 1000000.0;
+        if (write (fd[1], result, sizeof (result)) != sizeof (result)) {
+            _exit (1);
+        }
+        _exit (0);
+    }
+    close (fd[1]);
+    if (read (fd[0], result, sizeof (result)) != sizeof (result)) {
+        result[0] = SYS_PIPE_ERROR;
+    }
+    close (fd[0]);
+    waitpid (pid, &childStatus, 0);
+    *elapsed = result[1];
+    return ((int) result[0]);
+}
+
+int
+runAgents (int processType, char *ruleSet, int numAgents, double *total,
+double *maxTime)
+{
+    int i, status;
+    double elapsed;
+
+    *total = *maxTime = 0;
+    for (i = 0; i < numAgents; i++) {
+        status = runInit (processType, ruleSet, &elapsed);
+        if (status < 0) {
+            return (status);
+        }
+        *total += elapsed;
+        if (elapsed > *maxTime) *maxTime = elapsed;
+    }
+    return (0);
+}
@@ -0,0 +1,423 @@
+/*** Copyright (c), The Regents of the University of California            ***
+ *** For more information please refer to files in the COPYRIGHT directory ***/
+/* test_tarbench.c - measure random member reads of a tar structured file
+ * with and without the tarIndex.
+ *
+ * A synthetic tar file of numMembers members of memberSize bytes in
+ * numDirs subdirs is written to workDir. numReads random members are
+ * then read
+ *   - after extracting the whole tar file with TAR_EXEC_PATH into a cache
+ *     dir, which is what the tar driver does without an index,
+ *   - straight from the tar file after scanning it for a new index and
+ *   - straight from the tar file after loading a saved index.
+ * Every member read is checked against the generated content.
+ */
+
+#include <sys/time.h>
+#include <sys/wait.h>
+#include "tarIndex.h"
+
+#define DEF_NUM_MEMBERS	10000
+#define DEF_MEMBER_SIZE	4096
+#define DEF_NUM_READS	1000
+#define DEF_NUM_DIRS	100
+
+typedef struct {
+    int fd;
+} benchReadCtx_t;
+
+int
+genBenchTar (char *tarPath, int numMembers, int memberSize, int numDirs);
+int
+benchExtract (char *tarPath, char *cacheDir, int numMembers, int memberSize,
+int numDirs, int numReads, double *setupTime, double *readTime);
+int
+benchIndex (char *tarPath, int loadFlag, int numMembers, int memberSize,
+int numDirs, int numReads, double *setupTime, double *readTime);
+int
+benchPread (void *readCtx, rodsLong_t offset, char *buf, int len);
+
+void
+tarbench_usage (char *prog)
+{
+    printf (
+      "Usage: %s [-n numMembers] [-s memberSize] [-r numReads] [-d numDirs] [workDir]\n",
+      prog);
+}
+
+static double
+elapsedSec (struct timeval *startTime)
+{
+    struct timeval endTime;
+
+    (void) gettimeofday (&endTime, (struct timezone *) 0);
+    return ((endTime.tv_sec - startTime->tv_sec) +
+      (endTime.tv_usec - startTime->tv_usec) / 1000000.0);
+}
+
+static void
+fillMember (char *buf, int memberSize, int memberNum)
+{
+    int i;
+
+    for (i = 0; i < memberSize; i++) {
+	buf[i] = (char) ('a' + (memberNum + i) % 26);
+    }
+}
+
+static void
+memberName (char *name, int memberNum, int numDirs)
+{
+    snprintf (name, MAX_NAME_LEN, "dir%03d/member%07d", memberNum % numDirs,
+      memberNum);
+}
+
+int
+main (int argc, char **argv)
+{
+    int c, status;
+    int numMembers = DEF_NUM_MEMBERS;
+    int memberSize = DEF_MEMBER_SIZE;
+    int numReads = DEF_NUM_READS;
+    int numDirs = DEF_NUM_DIRS;
+    char *workDir = "/tmp";
+    char tarPath[MAX_NAME_LEN], indexPath[MAX_NAME_LEN];
+    char cacheDir[MAX_NAME_LEN];
+    double extSetup = 0, extRead = 0, scanSetup, scanRead, loadSetup, loadRead;
+    struct stat statbuf;
+
+    while ((c = getopt (argc, argv, "n:s:r:d:h")) != EOF) {
+        switch (c) {
+            case 'n':
+                numMembers = atoi (optarg);
+                if (numMembers <= 0) numMembers = DEF_NUM_MEMBERS;
+                break;
+            case 's':
+                memberSize = atoi (optarg);
+                if (memberSize < 0) memberSize = DEF_MEMBER_SIZE;
+                break;
+            case 'r':
+                numReads = atoi (optarg);
+                if (numReads <= 0) numReads = DEF_NUM_READS;
+                break;
+            case 'd':
+                numDirs = atoi (optarg);
+                if (numDirs <= 0) numDirs = DEF_NUM_DIRS;
+                break;
+            default:
+                tarbench_usage (argv[0]);
+                exit (1);
+        }
+    }
+    if (optind < argc) workDir = argv[optind];
+
+    if (snprintf (tarPath, MAX_NAME_LEN, "%s/tarbench.%d.tar", workDir,
+      getpid ()) >= MAX_NAME_LEN ||
+      snprintf (indexPath, MAX_NAME_LEN, "%s%s", tarPath, TAR_INDEX_SUFFIX) >=
+      MAX_NAME_LEN ||
+      snprintf (cacheDir, MAX_NAME_LEN, "%s.cacheDir0", tarPath) >=
+      MAX_NAME_LEN) {
+        fprintf (stderr, "workDir %s is too long\n", workDir);
+        exit (1);
+    }
+
+    if ((status = genBenchTar (tarPath, numMembers, memberSize, numDirs)) < 0) {
+        fprintf (stderr, "genBenchTar of %s failed, status = %d\n", tarPath,
+          status);
+        exit (2);
+    }
+    stat (tarPath, &statbuf);
+
+    srandom (1);
+    status = benchExtract (tarPath, cacheDir, numMembers, memberSize, numDirs,
+      numReads, &extSetup, &extRead);
+    if (status >= 0) {
+        srandom (1);
+        status = benchIndex (tarPath, 0, numMembers, memberSize, numDirs,
+          numReads, &scanSetup, &scanRead);
+    }
+    if (status >= 0) {
+        srandom (1);
+        status = benchIndex (tarPath, 1, numMembers, memberSize, numDirs,
+          numReads, &loadSetup, &loadRead);
+    }
+    unlink (tarPath);
+    unlink (indexPath);
+    if (status < 0) {
+        fprintf (stderr, "benchmark failed, status = %d\n", status);
+        exit (2);
+    }
+
+    printf ("%d members of %d bytes in %d dirs, tar %.1f MB, %d random reads\n",
+      numMembers, memberSize, numDirs,
+      (double) statbuf.st_size / (1024 * 1024), numReads);
+    printf ("%-14s %12s %12s %12s\n", "mode", "setup ms", "read ms",
+      "total ms");
+    if (extSetup > 0) {
+        printf ("%-14s %12.3f %12.3f %12.3f\n", "extract", extSetup * 1000,
+          extRead * 1000, (extSetup + extRead) * 1000);
+    }
+    printf ("%-14s %12.3f %12.3f %12.3f\n", "index scan", scanSetup * 1000,
+      scanRead * 1000, (scanSetup + scanRead) * 1000);
+    printf ("%-14s %12.3f %12.3f %12.3f\n", "index load", loadSetup * 1000,
+      loadRead * 1000, (loadSetup + loadRead) * 1000);
+    if (extSetup > 0) {
+        printf ("speedup %.2fx (scan), %.2fx (load)\n",
+          (extSetup + extRead) / (scanSetup + scanRead),
+          (extSetup + extRead) / (loadSetup + loadRead));
+    }
+    exit (0);
+}
+
+/* genBenchTar - write a ustar file with the dirs followed by the members */
+
+static int
+writeTarHeader (FILE *fptr, char *name, int size, char type)
+{
+    char hdr[TAR_BLOCK_SIZE];
+    unsigned int sum = 0;
+    int i;
+
+    memset (hdr, 0, TAR_BLOCK_SIZE);
+    rstrcpy (hdr, name, 100);
+    snprintf (&hdr[100], 8, "%07o", type == TAR_DIR_TYPE ? 0755 : 0644);
+    snprintf (&hdr[108], 8, "%07o", 0);
+    snprintf (&hdr[116], 8, "%07o", 0);
+    snprintf (&hdr[124], 12, "%011o", size);
+    snprintf (&hdr[136], 12, "%011o", (unsigned int) time (0));
+    memset (&hdr[148], ' ', 8);
+    hdr[156] = type;
+    memcpy (&hdr[257], "ustar", 6);
+    memcpy (&hdr[263], "00", 2);
+    for (i = 0; i < TAR_BLOCK_SIZE; i++) sum += (unsigned char) hdr[i];
+    snprintf (&hdr[148], 8, "%06o", sum);
+    if (fwrite (hdr, 1, TAR_BLOCK_SIZE, fptr) != TAR_BLOCK_SIZE) {
+        return (UNIX_FILE_WRITE_ERR - errno);
+    }
+    return (0);
+}
+
+int
+genBenchTar (char *tarPath, int numMembers, int memberSize, int numDirs)
+{
+    FILE *fptr;
+    char name[MAX_NAME_LEN];
+    char *buf;
+    int i, status = 0;
+    int padLen = (TAR_BLOCK_SIZE - memberSize % TAR_BLOCK_SIZE) %
+      TAR_BLOCK_SIZE;
+
+    if ((fptr = fopen (tarPath, "w")) == NULL) {
+        fprintf (stderr, "cannot create %s, errno = %d\n", tarPath, errno);
+        return (UNIX_FILE_OPEN_ERR - errno);
+    }
+    buf = (char *) calloc (1, memberSize + 2 * TAR_BLOCK_SIZE);
+    for (i = 0; i < numDirs && status >= 0; i++) {
+        snprintf (name, MAX_NAME_LEN, "dir%03d/", i);
+        status = writeTarHeader (fptr, name, 0, TAR_DIR_TYPE);
+    }
+    for (i = 0; i < numMembers && status >= 0; i++) {
+        memberName (name, i, numDirs);
+        status = writeTarHeader (fptr, name, memberSize, TAR_REG_TYPE);
+        if (status < 0) break;
+        fillMember (buf, memberSize, i);
+        memset (buf + memberSize, 0, padLen);
+        if (fwrite (buf, 1, memberSize + padLen, fptr) !=
+          (size_t) (memberSize + padLen)) {
+            status = UNIX_FILE_WRITE_ERR - errno;
+        }
+    }
+    if (status >= 0) {
+        /* the end of archive blocks */
+        memset (buf, 0, 2 * TAR_BLOCK_SIZE);
+        if (fwrite (buf, 1, 2 * TAR_BLOCK_SIZE, fptr) != 2 * TAR_BLOCK_SIZE)
+            status = UNIX_FILE_WRITE_ERR - errno;
+    }
+    free (buf);
+    fclose (fptr);
+    return (status);
+}
+
+static int
+checkMember (char *buf, int len, int memberSize, int memberNum)
+{
+    char *expected;
+    int status = 0;
+
+    if (len != memberSize) return (SYS_COPY_LEN_ERR);
+    expected = (char *) malloc (memberSize + 1);
+    fillMember (expected, memberSize, memberNum);
+    if (memcmp (buf, expected, memberSize) != 0) status = SYS_COPY_LEN_ERR;
+    free (expected);
+    return (status);
+}
+
+/* benchExtract - extract the tar file into cacheDir and read the members
+ * from the cache. Does nothing without TAR_EXEC_PATH */
+
+int
+benchExtract (char *tarPath, char *cacheDir, int numMembers, int memberSize,
+int numDirs, int numReads, double *setupTime, double *readTime)
+{
+#ifdef TAR_EXEC_PATH
+    struct timeval startTime;
+    char name[MAX_NAME_LEN], path[MAX_NAME_LEN];
+    char *buf;
+    int i, fd, len, memberNum, status = 0;
+    pid_t pid;
+    int childStatus;
+
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    if (mkdir (cacheDir, 0750) < 0) {
+        fprintf (stderr, "cannot mkdir %s, errno = %d\n", cacheDir, errno);
+        return (UNIX_FILE_MKDIR_ERR - errno);
+    }
+    if ((pid = fork ()) == 0) {
+        execl (TAR_EXEC_PATH, TAR_EXEC_PATH, "-xf", tarPath, "-C", cacheDir,
+          (char *) NULL);
+        _exit (1);
+    } else if (pid < 0) {
+        return (SYS_FORK_ERROR - errno);
+    }
+    waitpid (pid, &childStatus, 0);
+    if (childStatus != 0) {
+        fprintf (stderr, "%s -xf %s failed\n", TAR_EXEC_PATH, tarPath);
+        return (SYS_TAR_STRUCT_FILE_EXTRACT_ERR);
+    }
+    *setupTime = elapsedSec (&startTime);
+
+    buf = (char *) malloc (memberSize + 1);
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    for (i = 0; i < numReads && status >= 0; i++) {
+        memberNum = random () % numMembers;
+        memberName (name, memberNum, numDirs);
+        if (snprintf (path, MAX_NAME_LEN, "%s/%s", cacheDir, name) >=
+          MAX_NAME_LEN) {
+            status = USER_PATH_EXCEEDS_MAX;
+            break;
+        }
+        if ((fd = open (path, O_RDONLY, 0)) < 0) {
+            status = UNIX_FILE_OPEN_ERR - errno;
+            break;
+        }
+        len = read (fd, buf, memberSize + 1);
+        close (fd);
+        status = checkMember (buf, len, memberSize, memberNum);
+    }
+    *readTime = elapsedSec (&startTime);
+    free (buf);
+
+    if (snprintf (path, MAX_NAME_LEN, "rm -rf %s", cacheDir) >= MAX_NAME_LEN ||
+      system (path) != 0) {
+        fprintf (stderr, "cannot remove %s\n", cacheDir);
+    }
+    return (status);
+#else
+    *setupTime = *readTime = 0;
+    return (0);
+#endif
+}
+
+int
+benchPread (void *readCtx, rodsLong_t offset, char *buf, int len)
+{
+    benchReadCtx_t *ctx = (benchReadCtx_t *) readCtx;
+    int status, bytesRead = 0;
+
+    while (bytesRead < len) {
+        status = pread (ctx->fd, buf + bytesRead, len - bytesRead,
+          offset + bytesRead);
+        if (status < 0) return (UNIX_FILE_READ_ERR - errno);
+        if (status == 0) break;
+        bytesRead += status;
+    }
+    return (bytesRead);
+}
+
+/* benchIndex - index the tar file and read the members straight from it.
+ * With loadFlag, the index is loaded from the index file written by the
+ * previous run instead of scanning the tar file */
+
+int
+benchIndex (char *tarPath, int loadFlag, int numMembers, int memberSize,
+int numDirs, int numReads, double *setupTime, double *readTime)
+{
+    struct timeval startTime;
+    char indexPath[MAX_NAME_LEN], name[MAX_NAME_LEN];
+    char *buf;
+    tarIndex_t *tarIndex = NULL;
+    benchReadCtx_t readCtx;
+    struct stat statbuf;
+    int i, inx, fd, len, memberNum, status = 0;
+    FILE *fptr;
+
+    if (snprintf (indexPath, MAX_NAME_LEN, "%s%s", tarPath, TAR_INDEX_SUFFIX) >=
+      MAX_NAME_LEN) {
+        return (USER_PATH_EXCEEDS_MAX);
+    }
+    if ((readCtx.fd = open (tarPath, O_RDONLY, 0)) < 0) {
+        return (UNIX_FILE_OPEN_ERR - errno);
+    }
+
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    if (loadFlag) {
+        if ((fd = open (indexPath, O_RDONLY, 0)) < 0 ||
+          fstat (fd, &statbuf) < 0) {
+            close (readCtx.fd);
+            return (UNIX_FILE_OPEN_ERR - errno);
+        }
+        buf = (char *) malloc (statbuf.st_size);
+        len = read (fd, buf, statbuf.st_size);
+        close (fd);
+        status = unpackTarIndex (buf, len, &tarIndex);
+        free (buf);
+    } else {
+        tarIndex = newTarIndex ();
+        status = scanTarFile (tarIndex, 0, benchPread, &readCtx);
+        if (status >= 0) status = sortTarIndex (tarIndex);
+    }
+    *setupTime = elapsedSec (&startTime);
+    if (status < 0) {
+        fprintf (stderr, "%s of the index failed, status = %d\n",
+          loadFlag ? "load" : "scan", status);
+        freeTarIndex (tarIndex);
+        close (readCtx.fd);
+        return (status);
+    }
+    if (tarIndex->hdr.numEntries != numMembers + numDirs) {
+        fprintf (stderr, "index has %d entries, expected %d\n",
+          tarIndex->hdr.numEntries, numMembers + numDirs);
+        status = SYS_TAR_STRUCT_FILE_EXTRACT_ERR;
+    }
+
+    buf = (char *) malloc (memberSize + 1);
+    (void) gettimeofday (&startTime, (struct timezone *) 0);
+    for (i = 0; i < numReads && status >= 0; i++) {
+        memberNum = random () % numMembers;
+        memberName (name, memberNum, numDirs);
+        if ((inx = findTarIndexEntry (tarIndex, name)) < 0) {
+            fprintf (stderr, "%s is not in the index\n", name);
+            status = UNIX_FILE_OPEN_ERR - ENOENT;
+            break;
+        }
+        len = benchPread (&readCtx, tarIndex->entries[inx].offset, buf,
+          (int) tarIndex->entries[inx].size);
+        status = checkMember (buf, len, memberSize, memberNum);
+    }
+    *readTime = elapsedSec (&startTime);
+    free (buf);
+    close (readCtx.fd);
+
+    if (status >= 0 && loadFlag == 0) {
+        /* save it for the load run */
+        if (packTarIndex (tarIndex, &buf, &len) >= 0) {
+            if ((fptr = fopen (indexPath, "w")) != NULL) {
+                fwrite (buf, 1, len, fptr);
+                fclose (fptr);
+            }
+            free (buf);
+        }
+    }
+    freeTarIndex (tarIndex);
+    return (status);
+}